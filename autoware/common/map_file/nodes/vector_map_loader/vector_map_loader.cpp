@@ -21,6 +21,12 @@
 #include <map_file/get_file.h>
 #include <sys/stat.h>
 
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
 using vector_map::VectorMap;
 using vector_map::Category;
 using vector_map::Color;
@@ -119,25 +125,28 @@ bool isDownloaded(const std::string& local_path)
   return stat(local_path.c_str(), &st) == 0;
 }
 
+using PublishFunction = std::function<vector_map::category_t()>;
+
+// Parse a csv file on the calling thread and return a function publishing it, to be called on the main thread.
 template <class T, class U>
-vector_map::category_t registerVectormapPortion(
+PublishFunction parseVectormapPortion(
   const std::string& file_path, ros::Publisher *publisher,
   const std::string topic_name, const vector_map::category_t category,
-  ros::NodeHandle *nh)
+  ros::NodeHandle *nh, bool use_cache)
 {
-  U obj_array;
-  obj_array.header.frame_id = "map";
-  obj_array.data = vector_map::parse<T>(file_path);
-  if (!obj_array.data.empty())
+  std::shared_ptr<U> obj_array = std::make_shared<U>();
+  obj_array->header.frame_id = "map";
+  obj_array->data = vector_map::parse<T>(file_path, use_cache);
+  return [=]() -> vector_map::category_t
   {
+    if (obj_array->data.empty())
+    {
+      return Category::NONE;
+    }
     *publisher = nh->advertise<U>(topic_name, 1, true);
-    publisher->publish(obj_array);
+    publisher->publish(*obj_array);
     return category;
-  }
-  else
-  {
-    return Category::NONE;
-  }
+  };
 }
 
 visualization_msgs::Marker createLinkedLineMarker(const std::string& ns, int id, Color color, const VectorMap& vmap,
@@ -1129,145 +1138,166 @@ int main(int argc, char **argv)
     }
   }
 
-  vector_map::category_t category = Category::NONE;
-  for (const auto& file_path : file_paths)
+  // Binary cache next to the csv files, reparsed when a csv file is modified
+  bool use_cache;
+  pnh.param<bool>("use_cache", use_cache, true);
+
+  auto parse_file = [&](const std::string& file_path) -> PublishFunction
   {
     std::string file_name(basename(file_path.c_str()));
     if (file_name == "idx.csv")
     {
-      ; // XXX: This version of Autoware don't support index csv file now.
+      return PublishFunction(); // XXX: This version of Autoware don't support index csv file now.
     }
     else if (file_name == "point.csv")
     {
-      category |= registerVectormapPortion<Point, PointArray>(file_path, &point_pub, "vector_map_info/point", Category::POINT, &nh);
+      return parseVectormapPortion<Point, PointArray>(file_path, &point_pub, "vector_map_info/point", Category::POINT, &nh, use_cache);
     }
     else if (file_name == "vector.csv")
     {
-      category |= registerVectormapPortion<Vector, VectorArray>(file_path, &vector_pub, "vector_map_info/vector", Category::VECTOR, &nh);
+      return parseVectormapPortion<Vector, VectorArray>(file_path, &vector_pub, "vector_map_info/vector", Category::VECTOR, &nh, use_cache);
     }
     else if (file_name == "line.csv")
     {
-      category |= registerVectormapPortion<Line, LineArray>(file_path, &line_pub, "vector_map_info/line", Category::LINE, &nh);
+      return parseVectormapPortion<Line, LineArray>(file_path, &line_pub, "vector_map_info/line", Category::LINE, &nh, use_cache);
     }
     else if (file_name == "area.csv")
     {
-      category |= registerVectormapPortion<Area, AreaArray>(file_path, &area_pub, "vector_map_info/area", Category::AREA, &nh);
+      return parseVectormapPortion<Area, AreaArray>(file_path, &area_pub, "vector_map_info/area", Category::AREA, &nh, use_cache);
     }
     else if (file_name == "pole.csv")
     {
-      category |= registerVectormapPortion<Pole, PoleArray>(file_path, &pole_pub, "vector_map_info/pole", Category::POLE, &nh);
+      return parseVectormapPortion<Pole, PoleArray>(file_path, &pole_pub, "vector_map_info/pole", Category::POLE, &nh, use_cache);
     }
     else if (file_name == "box.csv")
     {
-      category |= registerVectormapPortion<Box, BoxArray>(file_path, &box_pub, "vector_map_info/box", Category::BOX, &nh);
+      return parseVectormapPortion<Box, BoxArray>(file_path, &box_pub, "vector_map_info/box", Category::BOX, &nh, use_cache);
     }
     else if (file_name == "dtlane.csv")
     {
-      category |= registerVectormapPortion<DTLane, DTLaneArray>(file_path, &dtlane_pub, "vector_map_info/dtlane", Category::DTLANE, &nh);
+      return parseVectormapPortion<DTLane, DTLaneArray>(file_path, &dtlane_pub, "vector_map_info/dtlane", Category::DTLANE, &nh, use_cache);
     }
     else if (file_name == "node.csv")
     {
-      category |= registerVectormapPortion<Node, NodeArray>(file_path, &node_pub, "vector_map_info/node", Category::NODE, &nh);
+      return parseVectormapPortion<Node, NodeArray>(file_path, &node_pub, "vector_map_info/node", Category::NODE, &nh, use_cache);
     }
     else if (file_name == "lane.csv")
     {
-      category |= registerVectormapPortion<Lane, LaneArray>(file_path, &lane_pub, "vector_map_info/lane", Category::LANE, &nh);
+      return parseVectormapPortion<Lane, LaneArray>(file_path, &lane_pub, "vector_map_info/lane", Category::LANE, &nh, use_cache);
     }
     else if (file_name == "wayarea.csv")
     {
-      category |= registerVectormapPortion<WayArea, WayAreaArray>(file_path, &way_area_pub, "vector_map_info/way_area", Category::WAY_AREA, &nh);
+      return parseVectormapPortion<WayArea, WayAreaArray>(file_path, &way_area_pub, "vector_map_info/way_area", Category::WAY_AREA, &nh, use_cache);
     }
     else if (file_name == "roadedge.csv")
     {
-      category |= registerVectormapPortion<RoadEdge, RoadEdgeArray>(file_path, &road_edge_pub, "vector_map_info/road_edge", Category::ROAD_EDGE, &nh);
+      return parseVectormapPortion<RoadEdge, RoadEdgeArray>(file_path, &road_edge_pub, "vector_map_info/road_edge", Category::ROAD_EDGE, &nh, use_cache);
     }
     else if (file_name == "gutter.csv")
     {
-      category |= registerVectormapPortion<Gutter, GutterArray>(file_path, &gutter_pub, "vector_map_info/gutter", Category::GUTTER, &nh);
+      return parseVectormapPortion<Gutter, GutterArray>(file_path, &gutter_pub, "vector_map_info/gutter", Category::GUTTER, &nh, use_cache);
     }
     else if (file_name == "curb.csv")
     {
-      category |= registerVectormapPortion<Curb, CurbArray>(file_path, &curb_pub, "vector_map_info/curb", Category::CURB, &nh);
+      return parseVectormapPortion<Curb, CurbArray>(file_path, &curb_pub, "vector_map_info/curb", Category::CURB, &nh, use_cache);
     }
     else if (file_name == "whiteline.csv")
     {
-      category |= registerVectormapPortion<WhiteLine, WhiteLineArray>(file_path, &white_line_pub, "vector_map_info/white_line", Category::WHITE_LINE, &nh);
+      return parseVectormapPortion<WhiteLine, WhiteLineArray>(file_path, &white_line_pub, "vector_map_info/white_line", Category::WHITE_LINE, &nh, use_cache);
     }
     else if (file_name == "stopline.csv")
     {
-      category |= registerVectormapPortion<StopLine, StopLineArray>(file_path, &stop_line_pub, "vector_map_info/stop_line", Category::STOP_LINE, &nh);
+      return parseVectormapPortion<StopLine, StopLineArray>(file_path, &stop_line_pub, "vector_map_info/stop_line", Category::STOP_LINE, &nh, use_cache);
     }
     else if (file_name == "zebrazone.csv")
     {
-      category |= registerVectormapPortion<ZebraZone, ZebraZoneArray>(file_path, &zebra_zone_pub, "vector_map_info/zebra_zone", Category::ZEBRA_ZONE, &nh);
+      return parseVectormapPortion<ZebraZone, ZebraZoneArray>(file_path, &zebra_zone_pub, "vector_map_info/zebra_zone", Category::ZEBRA_ZONE, &nh, use_cache);
     }
     else if (file_name == "crosswalk.csv")
     {
-      category |= registerVectormapPortion<CrossWalk, CrossWalkArray>(file_path, &cross_walk_pub, "vector_map_info/cross_walk", Category::CROSS_WALK, &nh);
+      return parseVectormapPortion<CrossWalk, CrossWalkArray>(file_path, &cross_walk_pub, "vector_map_info/cross_walk", Category::CROSS_WALK, &nh, use_cache);
     }
     else if (file_name == "road_surface_mark.csv")
     {
-      category |= registerVectormapPortion<RoadMark, RoadMarkArray>(file_path, &road_mark_pub, "vector_map_info/road_mark", Category::ROAD_MARK, &nh);
+      return parseVectormapPortion<RoadMark, RoadMarkArray>(file_path, &road_mark_pub, "vector_map_info/road_mark", Category::ROAD_MARK, &nh, use_cache);
     }
     else if (file_name == "poledata.csv")
     {
-      category |= registerVectormapPortion<RoadPole, RoadPoleArray>(file_path, &road_pole_pub, "vector_map_info/road_pole", Category::ROAD_POLE, &nh);
+      return parseVectormapPortion<RoadPole, RoadPoleArray>(file_path, &road_pole_pub, "vector_map_info/road_pole", Category::ROAD_POLE, &nh, use_cache);
     }
     else if (file_name == "roadsign.csv")
     {
-      category |= registerVectormapPortion<RoadSign, RoadSignArray>(file_path, &road_sign_pub, "vector_map_info/road_sign", Category::ROAD_SIGN, &nh);
+      return parseVectormapPortion<RoadSign, RoadSignArray>(file_path, &road_sign_pub, "vector_map_info/road_sign", Category::ROAD_SIGN, &nh, use_cache);
     }
     else if (file_name == "signaldata.csv")
     {
-      category |= registerVectormapPortion<Signal, SignalArray>(file_path, &signal_pub, "vector_map_info/signal", Category::SIGNAL, &nh);
+      return parseVectormapPortion<Signal, SignalArray>(file_path, &signal_pub, "vector_map_info/signal", Category::SIGNAL, &nh, use_cache);
     }
     else if (file_name == "streetlight.csv")
     {
-      category |= registerVectormapPortion<StreetLight, StreetLightArray>(file_path, &street_light_pub, "vector_map_info/street_light", Category::STREET_LIGHT, &nh);
+      return parseVectormapPortion<StreetLight, StreetLightArray>(file_path, &street_light_pub, "vector_map_info/street_light", Category::STREET_LIGHT, &nh, use_cache);
     }
     else if (file_name == "utilitypole.csv")
     {
-      category |= registerVectormapPortion<UtilityPole, UtilityPoleArray>(file_path, &utility_pole_pub, "vector_map_info/utility_pole", Category::UTILITY_POLE, &nh);
+      return parseVectormapPortion<UtilityPole, UtilityPoleArray>(file_path, &utility_pole_pub, "vector_map_info/utility_pole", Category::UTILITY_POLE, &nh, use_cache);
     }
     else if (file_name == "guardrail.csv")
     {
-      category |= registerVectormapPortion<GuardRail, GuardRailArray>(file_path, &guard_rail_pub, "vector_map_info/guard_rail", Category::GUARD_RAIL, &nh);
+      return parseVectormapPortion<GuardRail, GuardRailArray>(file_path, &guard_rail_pub, "vector_map_info/guard_rail", Category::GUARD_RAIL, &nh, use_cache);
     }
     else if (file_name == "sidewalk.csv")
     {
-      category |= registerVectormapPortion<SideWalk, SideWalkArray>(file_path, &side_walk_pub, "vector_map_info/side_walk", Category::SIDE_WALK, &nh);
+      return parseVectormapPortion<SideWalk, SideWalkArray>(file_path, &side_walk_pub, "vector_map_info/side_walk", Category::SIDE_WALK, &nh, use_cache);
     }
     else if (file_name == "driveon_portion.csv")
     {
-      category |= registerVectormapPortion<DriveOnPortion, DriveOnPortionArray>(file_path, &drive_on_portion_pub, "vector_map_info/drive_on_portion", Category::DRIVE_ON_PORTION, &nh);
+      return parseVectormapPortion<DriveOnPortion, DriveOnPortionArray>(file_path, &drive_on_portion_pub, "vector_map_info/drive_on_portion", Category::DRIVE_ON_PORTION, &nh, use_cache);
     }
     else if (file_name == "intersection.csv")
     {
-      category |= registerVectormapPortion<CrossRoad, CrossRoadArray>(file_path, &cross_road_pub, "vector_map_info/cross_road", Category::CROSS_ROAD, &nh);
+      return parseVectormapPortion<CrossRoad, CrossRoadArray>(file_path, &cross_road_pub, "vector_map_info/cross_road", Category::CROSS_ROAD, &nh, use_cache);
     }
     else if (file_name == "sidestrip.csv")
     {
-      category |= registerVectormapPortion<SideStrip, SideStripArray>(file_path, &side_strip_pub, "vector_map_info/side_strip", Category::SIDE_STRIP, &nh);
+      return parseVectormapPortion<SideStrip, SideStripArray>(file_path, &side_strip_pub, "vector_map_info/side_strip", Category::SIDE_STRIP, &nh, use_cache);
     }
     else if (file_name == "curvemirror.csv")
     {
-      category |= registerVectormapPortion<CurveMirror, CurveMirrorArray>(file_path, &curve_mirror_pub, "vector_map_info/curve_mirror", Category::CURVE_MIRROR, &nh);
+      return parseVectormapPortion<CurveMirror, CurveMirrorArray>(file_path, &curve_mirror_pub, "vector_map_info/curve_mirror", Category::CURVE_MIRROR, &nh, use_cache);
     }
     else if (file_name == "wall.csv")
     {
-      category |= registerVectormapPortion<Wall, WallArray>(file_path, &wall_pub, "vector_map_info/wall", Category::WALL, &nh);
+      return parseVectormapPortion<Wall, WallArray>(file_path, &wall_pub, "vector_map_info/wall", Category::WALL, &nh, use_cache);
     }
     else if (file_name == "fence.csv")
     {
-      category |= registerVectormapPortion<Fence, FenceArray>(file_path, &fence_pub, "vector_map_info/fence", Category::FENCE, &nh);
+      return parseVectormapPortion<Fence, FenceArray>(file_path, &fence_pub, "vector_map_info/fence", Category::FENCE, &nh, use_cache);
     }
     else if (file_name == "railroad_crossing.csv")
     {
-      category |= registerVectormapPortion<RailCrossing, RailCrossingArray>(file_path, &rail_crossing_pub, "vector_map_info/rail_crossing", Category::RAIL_CROSSING, &nh);
+      return parseVectormapPortion<RailCrossing, RailCrossingArray>(file_path, &rail_crossing_pub, "vector_map_info/rail_crossing", Category::RAIL_CROSSING, &nh, use_cache);
     }
     else
     {
       ROS_ERROR_STREAM("unknown csv file: " << file_path);
+      return PublishFunction();
+    }
+  };
+
+  // Parse all csv files in parallel, then advertise and publish them in file order on this thread.
+  std::vector<std::future<PublishFunction>> parsed_files;
+  for (const auto& file_path : file_paths)
+  {
+    parsed_files.push_back(std::async(std::launch::async, parse_file, file_path));
+  }
+
+  vector_map::category_t category = Category::NONE;
+  for (auto& parsed_file : parsed_files)
+  {
+    PublishFunction publish = parsed_file.get();
+    if (publish)
+    {
+      category |= publish();
     }
   }
 
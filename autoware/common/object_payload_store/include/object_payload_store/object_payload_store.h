@@ -0,0 +1,121 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef OBJECT_PAYLOAD_STORE_OBJECT_PAYLOAD_STORE_H
+#define OBJECT_PAYLOAD_STORE_OBJECT_PAYLOAD_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+
+#include <autoware_msgs/DetectedObject.h>
+#include <autoware_msgs/DetectedObjectArray.h>
+
+namespace object_payload_store
+{
+// One entry of the slot table. A reference (payload_id, payload_generation) is valid while the generation of slot
+// payload_id - 1 is unchanged, so a reused slot is detected instead of returning the payload of another object.
+struct PayloadSlot
+{
+  uint32_t generation;
+  boost::interprocess::managed_shared_memory::handle_t handle;
+  uint64_t size;
+  bool used;
+};
+
+struct PayloadTable
+{
+  boost::interprocess::interprocess_mutex mutex;
+  uint32_t next_slot;
+};
+
+// Shared memory store for the heavy fields of autoware_msgs/DetectedObject (pointcloud, roi_image and
+// candidate_trajectories). In lean mode a producer moves those fields into the store and publishes only a reference,
+// nodes which need the payload resolve it, and all other nodes copy a few bytes per object instead of the whole cloud.
+//
+// Slots are reused as a ring, so a reference stays resolvable until num_slots newer payloads have been stored. When
+// the segment is full the oldest payloads are evicted first.
+class PayloadStore
+{
+public:
+  static constexpr const char* DEFAULT_NAME = "SHM_DetectedObjectPayload";
+  static constexpr size_t DEFAULT_SIZE = 128 * 1024 * 1024;
+  static constexpr uint32_t DEFAULT_NUM_SLOTS = 4096;
+
+  // Open the segment, or create it if this is the first process using it.
+  explicit PayloadStore(const std::string& name = DEFAULT_NAME, size_t size = DEFAULT_SIZE,
+                        uint32_t num_slots = DEFAULT_NUM_SLOTS);
+  PayloadStore(const PayloadStore&) = delete;
+  PayloadStore& operator=(const PayloadStore&) = delete;
+
+  bool isOpen() const
+  {
+    return table_ != nullptr;
+  }
+
+  // Move the payload of object into the store and set its reference. Objects without payload are left as they are.
+  // Return false and keep the payload inline if it could not be stored.
+  bool store(autoware_msgs::DetectedObject& object);
+  void store(autoware_msgs::DetectedObjectArray& objects);
+
+  // Fill the payload of object back from its reference. Objects without reference are left as they are.
+  // Return false if the reference is stale, in which case the payload fields stay empty.
+  bool resolve(autoware_msgs::DetectedObject& object) const;
+  bool resolve(autoware_msgs::DetectedObjectArray& objects) const;
+
+  // Clear the payload fields of an object which has a reference, so it is republished lean after being resolved.
+  static void strip(autoware_msgs::DetectedObject& object);
+
+  // Remove the segment from the system, e.g. before a new session.
+  static bool remove(const std::string& name = DEFAULT_NAME);
+
+private:
+  std::string name_;
+  std::unique_ptr<boost::interprocess::managed_shared_memory> segment_;
+  PayloadTable* table_;
+  PayloadSlot* slots_;
+  uint32_t num_slots_;
+
+  void releaseSlot(PayloadSlot& slot);
+  void* allocate(size_t size, uint32_t protected_slot);
+};
+
+// Whether object carries a payload store reference instead of its payload.
+inline bool hasPayloadReference(const autoware_msgs::DetectedObject& object)
+{
+  return object.payload_id != 0;
+}
+
+// Whether any of the payload fields of object is filled.
+inline bool hasPayload(const autoware_msgs::DetectedObject& object)
+{
+  return !object.pointcloud.data.empty() || !object.roi_image.data.empty() ||
+         !object.candidate_trajectories.lanes.empty();
+}
+
+// Payload fields of object in the serialized format of the store.
+size_t payloadLength(const autoware_msgs::DetectedObject& object);
+void serializePayload(const autoware_msgs::DetectedObject& object, uint8_t* data, size_t size);
+bool deserializePayload(const uint8_t* data, size_t size, autoware_msgs::DetectedObject& object);
+}  // namespace object_payload_store
+
+#endif  // OBJECT_PAYLOAD_STORE_OBJECT_PAYLOAD_STORE_H
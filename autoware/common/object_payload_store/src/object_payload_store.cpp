@@ -0,0 +1,208 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <ros/console.h>
+#include <ros/serialization.h>
+
+#include <object_payload_store/object_payload_store.h>
+
+using boost::interprocess::managed_shared_memory;
+using boost::interprocess::open_or_create;
+using boost::interprocess::scoped_lock;
+using boost::interprocess::interprocess_mutex;
+using boost::interprocess::interprocess_exception;
+
+namespace ser = ros::serialization;
+
+namespace object_payload_store
+{
+constexpr const char* PayloadStore::DEFAULT_NAME;
+constexpr size_t PayloadStore::DEFAULT_SIZE;
+constexpr uint32_t PayloadStore::DEFAULT_NUM_SLOTS;
+
+size_t payloadLength(const autoware_msgs::DetectedObject& object)
+{
+  return ser::serializationLength(object.pointcloud) + ser::serializationLength(object.roi_image) +
+         ser::serializationLength(object.candidate_trajectories);
+}
+
+void serializePayload(const autoware_msgs::DetectedObject& object, uint8_t* data, size_t size)
+{
+  ser::OStream stream(data, static_cast<uint32_t>(size));
+  ser::serialize(stream, object.pointcloud);
+  ser::serialize(stream, object.roi_image);
+  ser::serialize(stream, object.candidate_trajectories);
+}
+
+bool deserializePayload(const uint8_t* data, size_t size, autoware_msgs::DetectedObject& object)
+{
+  try
+  {
+    ser::IStream stream(const_cast<uint8_t*>(data), static_cast<uint32_t>(size));
+    ser::deserialize(stream, object.pointcloud);
+    ser::deserialize(stream, object.roi_image);
+    ser::deserialize(stream, object.candidate_trajectories);
+  }
+  catch (ser::StreamOverrunException& ex)
+  {
+    ROS_ERROR("deserializePayload: %s", ex.what());
+    return false;
+  }
+  return true;
+}
+
+PayloadStore::PayloadStore(const std::string& name, size_t size, uint32_t num_slots)
+  : name_(name), table_(nullptr), slots_(nullptr), num_slots_(0)
+{
+  try
+  {
+    segment_.reset(new managed_shared_memory(open_or_create, name_.c_str(), size));
+    PayloadTable* table = segment_->find_or_construct<PayloadTable>("PayloadTable")();
+    segment_->find_or_construct<PayloadSlot>("PayloadSlots")[num_slots]();
+    // the segment may have been created by another process with a different number of slots
+    auto slots = segment_->find<PayloadSlot>("PayloadSlots");
+    slots_ = slots.first;
+    num_slots_ = static_cast<uint32_t>(slots.second);
+    table_ = (slots_ != nullptr && num_slots_ > 0) ? table : nullptr;
+  }
+  catch (interprocess_exception& ex)
+  {
+    ROS_ERROR("PayloadStore: failed to open %s: %s", name_.c_str(), ex.what());
+    segment_.reset();
+  }
+}
+
+void PayloadStore::releaseSlot(PayloadSlot& slot)
+{
+  if (!slot.used)
+    return;
+  segment_->deallocate(segment_->get_address_from_handle(slot.handle));
+  slot.used = false;
+  slot.size = 0;
+  // invalidate the references to the released payload
+  slot.generation++;
+}
+
+void* PayloadStore::allocate(size_t size, uint32_t protected_slot)
+{
+  void* data = segment_->allocate(size, std::nothrow);
+  // evict in ring order, the slot after the one being written holds the oldest payload
+  for (uint32_t i = 1; data == nullptr && i < num_slots_; ++i)
+  {
+    PayloadSlot& slot = slots_[(protected_slot + i) % num_slots_];
+    if (!slot.used)
+      continue;
+    releaseSlot(slot);
+    data = segment_->allocate(size, std::nothrow);
+  }
+  return data;
+}
+
+bool PayloadStore::store(autoware_msgs::DetectedObject& object)
+{
+  if (hasPayloadReference(object) || !hasPayload(object))
+    return true;
+  if (!isOpen())
+    return false;
+
+  const size_t size = payloadLength(object);
+  if (size >= segment_->get_size())
+    return false;
+  {
+    scoped_lock<interprocess_mutex> lock(table_->mutex);
+    const uint32_t index = table_->next_slot % num_slots_;
+    table_->next_slot = (index + 1) % num_slots_;
+
+    PayloadSlot& slot = slots_[index];
+    releaseSlot(slot);
+    void* data = allocate(size, index);
+    if (data == nullptr)
+    {
+      ROS_WARN_THROTTLE(1, "PayloadStore: %s is full, payload of %zu bytes kept inline", name_.c_str(), size);
+      return false;
+    }
+    serializePayload(object, static_cast<uint8_t*>(data), size);
+
+    slot.handle = segment_->get_handle_from_address(data);
+    slot.size = size;
+    slot.used = true;
+    // 0 is never a valid generation, so a default constructed reference can not match
+    if (++slot.generation == 0)
+      slot.generation = 1;
+
+    object.payload_id = index + 1;
+    object.payload_generation = slot.generation;
+  }
+  strip(object);
+  return true;
+}
+
+void PayloadStore::store(autoware_msgs::DetectedObjectArray& objects)
+{
+  for (auto& object : objects.objects)
+    store(object);
+}
+
+bool PayloadStore::resolve(autoware_msgs::DetectedObject& object) const
+{
+  if (!hasPayloadReference(object))
+    return true;
+  if (!isOpen() || object.payload_id > num_slots_)
+    return false;
+
+  // copy out under the lock, so the slot can be reused while the payload is deserialized
+  thread_local std::vector<uint8_t> buffer;
+  {
+    scoped_lock<interprocess_mutex> lock(table_->mutex);
+    const PayloadSlot& slot = slots_[object.payload_id - 1];
+    if (!slot.used || slot.generation != object.payload_generation)
+      return false;
+    const uint8_t* data = static_cast<const uint8_t*>(segment_->get_address_from_handle(slot.handle));
+    buffer.assign(data, data + slot.size);
+  }
+  return deserializePayload(buffer.data(), buffer.size(), object);
+}
+
+bool PayloadStore::resolve(autoware_msgs::DetectedObjectArray& objects) const
+{
+  bool all_resolved = true;
+  for (auto& object : objects.objects)
+    all_resolved &= resolve(object);
+  return all_resolved;
+}
+
+void PayloadStore::strip(autoware_msgs::DetectedObject& object)
+{
+  if (!hasPayloadReference(object))
+    return;
+  object.pointcloud = sensor_msgs::PointCloud2();
+  object.roi_image = sensor_msgs::Image();
+  object.candidate_trajectories = autoware_msgs::LaneArray();
+}
+
+bool PayloadStore::remove(const std::string& name)
+{
+  return boost::interprocess::shared_memory_object::remove(name.c_str());
+}
+}  // namespace object_payload_store
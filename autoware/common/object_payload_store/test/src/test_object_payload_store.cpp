@@ -0,0 +1,141 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <object_payload_store/object_payload_store.h>
+
+using object_payload_store::PayloadStore;
+using object_payload_store::hasPayload;
+using object_payload_store::hasPayloadReference;
+
+class TestPayloadStore : public ::testing::Test
+{
+protected:
+  const std::string name_ = "SHM_TestDetectedObjectPayload";
+
+  void SetUp() override
+  {
+    PayloadStore::remove(name_);
+  }
+
+  void TearDown() override
+  {
+    PayloadStore::remove(name_);
+  }
+
+  static autoware_msgs::DetectedObject makeObject(uint32_t id, size_t cloud_bytes)
+  {
+    autoware_msgs::DetectedObject object;
+    object.id = id;
+    object.pointcloud.header.frame_id = "velodyne";
+    object.pointcloud.width = static_cast<uint32_t>(cloud_bytes / 16);
+    object.pointcloud.height = 1;
+    object.pointcloud.point_step = 16;
+    object.pointcloud.data.resize(cloud_bytes);
+    for (size_t i = 0; i < cloud_bytes; ++i)
+      object.pointcloud.data[i] = static_cast<uint8_t>(i * 7 + id);
+    object.roi_image.encoding = "bgr8";
+    object.roi_image.data.assign(12, static_cast<uint8_t>(id));
+    autoware_msgs::Lane lane;
+    lane.cost = id;
+    object.candidate_trajectories.lanes.push_back(lane);
+    return object;
+  }
+};
+
+TEST_F(TestPayloadStore, StoreAndResolve)
+{
+  PayloadStore producer(name_, 1024 * 1024, 16);
+  PayloadStore consumer(name_);  // attaches to the segment created by the producer
+  ASSERT_TRUE(producer.isOpen());
+  ASSERT_TRUE(consumer.isOpen());
+
+  const auto original = makeObject(3, 4096);
+  auto object = original;
+  ASSERT_TRUE(producer.store(object));
+  ASSERT_TRUE(hasPayloadReference(object));
+  ASSERT_FALSE(hasPayload(object));
+  ASSERT_EQ(object.id, original.id);
+
+  ASSERT_TRUE(consumer.resolve(object));
+  ASSERT_EQ(object.pointcloud.data, original.pointcloud.data);
+  ASSERT_EQ(object.pointcloud.header.frame_id, "velodyne");
+  ASSERT_EQ(object.roi_image.data, original.roi_image.data);
+  ASSERT_EQ(object.candidate_trajectories.lanes.size(), 1u);
+  ASSERT_EQ(object.candidate_trajectories.lanes[0].cost, 3);
+
+  // resolving again and storing a resolved object both keep the same reference
+  const uint32_t payload_id = object.payload_id;
+  PayloadStore::strip(object);
+  ASSERT_FALSE(hasPayload(object));
+  ASSERT_TRUE(consumer.resolve(object));
+  ASSERT_TRUE(producer.store(object));
+  ASSERT_EQ(object.payload_id, payload_id);
+
+  // objects without payload are passed through
+  autoware_msgs::DetectedObject empty;
+  ASSERT_TRUE(producer.store(empty));
+  ASSERT_FALSE(hasPayloadReference(empty));
+  ASSERT_TRUE(consumer.resolve(empty));
+}
+
+TEST_F(TestPayloadStore, StaleReferenceAfterSlotReuse)
+{
+  PayloadStore store(name_, 1024 * 1024, 4);
+  auto first = makeObject(1, 256);
+  ASSERT_TRUE(store.store(first));
+
+  // a full ring of newer payloads reuses the slot of the first one
+  for (uint32_t i = 0; i < 4; ++i)
+  {
+    auto object = makeObject(10 + i, 256);
+    ASSERT_TRUE(store.store(object));
+  }
+  ASSERT_FALSE(store.resolve(first));
+  ASSERT_FALSE(hasPayload(first));
+}
+
+TEST_F(TestPayloadStore, EvictOldestWhenFull)
+{
+  PayloadStore store(name_, 256 * 1024, 64);
+
+  autoware_msgs::DetectedObjectArray objects;
+  for (uint32_t i = 0; i < 8; ++i)
+    objects.objects.push_back(makeObject(i, 48 * 1024));
+  store.store(objects);
+
+  // the newest payloads are resolvable, the first ones were evicted to make room
+  auto newest = objects.objects.back();
+  ASSERT_TRUE(store.resolve(newest));
+  ASSERT_EQ(newest.pointcloud.data.size(), 48u * 1024u);
+  auto oldest = objects.objects.front();
+  ASSERT_FALSE(store.resolve(oldest));
+
+  // a payload larger than the segment stays inline
+  auto huge = makeObject(100, 512 * 1024);
+  ASSERT_FALSE(store.store(huge));
+  ASSERT_FALSE(hasPayloadReference(huge));
+  ASSERT_EQ(huge.pointcloud.data.size(), 512u * 1024u);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
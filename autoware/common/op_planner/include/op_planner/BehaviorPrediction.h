@@ -8,6 +8,7 @@
 #ifndef BEHAVIORPREDICTION_H_
 #define BEHAVIORPREDICTION_H_
 
+#include <algorithm>
 #include <boost/random.hpp>
 #include <boost/math/distributions/normal.hpp>
 
@@ -55,6 +56,44 @@ typedef boost::mt19937 ENG;
 typedef boost::normal_distribution<double> NormalDIST;
 typedef boost::variate_generator<ENG, NormalDIST> VariatGEN;
 
+/// Counter based random numbers, the n-th number of a stream only depends on the seed, the stream and n.
+/// Each object samples its particles from its own stream, so the results do not depend on the thread scheduling.
+class CounterRNG
+{
+public:
+  CounterRNG(const uint64_t& seed, const uint64_t& stream)
+  {
+    m_Key = Mix(seed ^ Mix(stream + 0x9E3779B97F4A7C15ULL));
+    m_Counter = 0;
+  }
+
+  /// uniform in (0, 1)
+  double Uniform()
+  {
+    m_Counter++;
+    return ((Mix(m_Key + m_Counter * 0x9E3779B97F4A7C15ULL) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+  }
+
+  double Normal(const double& mean, const double& sigma)
+  {
+    double u1 = Uniform();
+    double u2 = Uniform();
+    return mean + sigma * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+  }
+
+private:
+  uint64_t m_Key;
+  uint64_t m_Counter;
+
+  // splitmix64 finalizer
+  static uint64_t Mix(uint64_t z)
+  {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+};
+
 class TrajectoryTracker;
 
 class Particle
@@ -143,8 +182,12 @@ public:
 
   PassiveDecisionMaker m_SinglePathDecisionMaker;
 
+  // recommended speed of the trajectory is generated once after each path update
+  bool bRecommendedSpeed;
+
   TrajectoryTracker()
   {
+    bRecommendedSpeed = false;
     beh = BEH_STOPPING_STATE;
     rms_error = 0;
     index = 0;
@@ -181,6 +224,7 @@ public:
   {
 
     rms_error = 0;
+    bRecommendedSpeed = obj.bRecommendedSpeed;
     ids = obj.ids;
     path_ids = obj.path_ids;
     path_last_pose = obj.path_last_pose;
@@ -227,6 +271,7 @@ public:
 
     index = _index;
     trajectory = path;
+    bRecommendedSpeed = false;
     int prev_id = -10;
     int curr_id = -10;
     ids.clear();
@@ -269,6 +314,7 @@ public:
     beh = _path.at(0).beh_state;
     index = _index;
     trajectory = _path;
+    bRecommendedSpeed = false;
     int prev_id = -10;
     int curr_id = -10;
     ids.clear();
@@ -399,33 +445,42 @@ public:
     }
   }
 
-  void DeleteParticle(const Particle& p, const int& _i)
+  /// Marks the particle for removal, while keeping at least BEH_MIN_PARTICLE_NUM alive particles for its behavior.
+  /// Marked particles are erased by RemoveDeletedParticles.
+  bool DeleteParticle(Particle& p)
   {
+    if(p.bDeleted)
+      return false;
+
     if(p.beh == PlannerHNS::BEH_STOPPING_STATE && nAliveStop > BEH_MIN_PARTICLE_NUM)
-    {
-      m_StopPart.erase(m_StopPart.begin()+_i);
       nAliveStop--;
-    }
     else if(p.beh == PlannerHNS::BEH_YIELDING_STATE && nAliveYield > BEH_MIN_PARTICLE_NUM)
-    {
-      m_YieldPart.erase(m_YieldPart.begin()+_i);
       nAliveYield--;
-    }
     else if(p.beh == PlannerHNS::BEH_FORWARD_STATE && nAliveForward > BEH_MIN_PARTICLE_NUM)
-    {
-      m_ForwardPart.erase(m_ForwardPart.begin()+_i);
       nAliveForward--;
-    }
     else if(p.beh == PlannerHNS::BEH_BRANCH_LEFT_STATE && nAliveLeft > BEH_MIN_PARTICLE_NUM)
-    {
-      m_LeftPart.erase(m_LeftPart.begin()+_i);
       nAliveLeft--;
-    }
     else if(p.beh == PlannerHNS::BEH_BRANCH_RIGHT_STATE && nAliveRight > BEH_MIN_PARTICLE_NUM)
-    {
-      m_RightPart.erase(m_RightPart.begin()+_i);
       nAliveRight--;
-    }
+    else
+      return false;
+
+    p.bDeleted = true;
+    return true;
+  }
+
+  void RemoveDeletedParticles()
+  {
+    RemoveDeleted(m_StopPart);
+    RemoveDeleted(m_YieldPart);
+    RemoveDeleted(m_ForwardPart);
+    RemoveDeleted(m_LeftPart);
+    RemoveDeleted(m_RightPart);
+  }
+
+  static void RemoveDeleted(std::vector<Particle>& parts)
+  {
+    parts.erase(std::remove_if(parts.begin(), parts.end(), [](const Particle& p){ return p.bDeleted; }), parts.end());
   }
 
   void CalcAverages()
@@ -512,6 +567,116 @@ public:
   }
 };
 
+/// Forward and stop particles of one object in contiguous arrays. They are gathered from the trajectory trackers
+/// before moving and weighting them, and written back to the trackers when the weak ones are removed.
+class ParticleSet
+{
+public:
+  std::vector<Particle*> pSource;
+  std::vector<TrajectoryTracker*> pTraj;
+  std::vector<int> beh;
+
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> a;
+  std::vector<double> pose_v;
+
+  std::vector<double> vel;
+  std::vector<double> vel_prev_big;
+  std::vector<double> prev_time_diff;
+  std::vector<double> acc_raw;
+  std::vector<int> acc;
+  std::vector<int> indicator;
+
+  std::vector<double> w;
+  std::vector<double> w_raw;
+  std::vector<double> pose_w;
+  std::vector<double> dir_w;
+  std::vector<double> vel_w;
+  std::vector<double> acl_w;
+  std::vector<double> ind_w;
+
+  unsigned int size() const
+  {
+    return pSource.size();
+  }
+
+  void clear()
+  {
+    resize(0);
+  }
+
+  void resize(const unsigned int& n)
+  {
+    pSource.resize(n);
+    pTraj.resize(n);
+    beh.resize(n);
+    x.resize(n);
+    y.resize(n);
+    a.resize(n);
+    pose_v.resize(n);
+    vel.resize(n);
+    vel_prev_big.resize(n);
+    prev_time_diff.resize(n);
+    acc_raw.resize(n);
+    acc.resize(n);
+    indicator.resize(n);
+    w.resize(n);
+    w_raw.resize(n);
+    pose_w.resize(n);
+    dir_w.resize(n);
+    vel_w.resize(n);
+    acl_w.resize(n);
+    ind_w.resize(n);
+  }
+
+  void Gather(const unsigned int& i, Particle& p)
+  {
+    pSource.at(i) = &p;
+    pTraj.at(i) = p.pTraj;
+    beh.at(i) = p.beh;
+    x.at(i) = p.pose.pos.x;
+    y.at(i) = p.pose.pos.y;
+    a.at(i) = p.pose.pos.a;
+    pose_v.at(i) = p.pose.v;
+    vel.at(i) = p.vel;
+    vel_prev_big.at(i) = p.vel_prev_big;
+    prev_time_diff.at(i) = p.prev_time_diff;
+    acc_raw.at(i) = p.acc_raw;
+    acc.at(i) = p.acc;
+    indicator.at(i) = p.indicator;
+    w.at(i) = p.w;
+    w_raw.at(i) = p.w_raw;
+    pose_w.at(i) = p.pose_w;
+    dir_w.at(i) = p.dir_w;
+    vel_w.at(i) = p.vel_w;
+    acl_w.at(i) = p.acl_w;
+    ind_w.at(i) = p.ind_w;
+  }
+
+  void Scatter(const unsigned int& i) const
+  {
+    Particle& p = *pSource.at(i);
+    p.pose.pos.x = x.at(i);
+    p.pose.pos.y = y.at(i);
+    p.pose.pos.a = a.at(i);
+    p.pose.v = pose_v.at(i);
+    p.vel = vel.at(i);
+    p.vel_prev_big = vel_prev_big.at(i);
+    p.prev_time_diff = prev_time_diff.at(i);
+    p.acc_raw = acc_raw.at(i);
+    p.acc = acc.at(i);
+    p.indicator = indicator.at(i);
+    p.w = w.at(i);
+    p.w_raw = w_raw.at(i);
+    p.pose_w = pose_w.at(i);
+    p.dir_w = dir_w.at(i);
+    p.vel_w = vel_w.at(i);
+    p.acl_w = acl_w.at(i);
+    p.ind_w = ind_w.at(i);
+  }
+};
+
 class ObjParticles
 {
 public:
@@ -519,7 +684,8 @@ public:
   std::vector<TrajectoryTracker*> m_TrajectoryTracker;
   std::vector<TrajectoryTracker*> m_TrajectoryTracker_temp;
 
-  std::vector<Particle*> m_AllParticles;
+  ParticleSet m_Particles;
+  bool m_bCanDecide;
 
   TrajectoryTracker* best_beh_track;
   int i_best_track;
@@ -570,6 +736,7 @@ public:
   ObjParticles()
   {
     m_PredictionTime = 0;
+    m_bCanDecide = true;
     best_beh_track = nullptr;
     i_best_track = -1;
     all_w = 0;
@@ -794,6 +961,8 @@ public:
   bool m_bUseFixedPrediction;
   bool m_bStepByStep;
   bool m_bParticleFilter;
+  // seed of the particle sampling, the same seed and inputs give the same predictions
+  uint64_t m_RandomSeed;
   //std::vector<DetectedObject> m_PredictedObjects;
   //std::vector<DetectedObject*> m_PredictedObjectsII;
 
@@ -806,9 +975,9 @@ public:
   struct timespec m_GenerationTimer;
   timespec m_ResamplingTimer;
 
-  bool m_bCanDecide;
   bool m_bFirstMove;
   bool m_bDebugOut;
+  uint64_t m_nFilterSteps;
 
 
 protected:
@@ -827,11 +996,11 @@ protected:
   void ParticleFilterSteps(std::vector<ObjParticles*>& part_info);
 
   void SamplesFreshParticles(ObjParticles* pParts);
-  void MoveParticles(ObjParticles* parts);
+  void MoveParticles(ObjParticles* parts, const double& dt);
   void CalculateWeights(ObjParticles* pParts);
 
-  void CalOnePartWeight(ObjParticles* pParts,Particle& p);
-  void NormalizeOnePartWeight(ObjParticles* pParts,Particle& p);
+  void CalOnePartWeight(ObjParticles* pParts, const unsigned int& i);
+  void NormalizeOnePartWeight(ObjParticles* pParts, const unsigned int& i);
 
   void CollectParticles(ObjParticles* pParts);
 
@@ -839,11 +1008,6 @@ protected:
   void FindBest(ObjParticles* pParts);
   void CalculateAveragesAndProbabilities(ObjParticles* pParts);
 
-  static bool sort_weights(const Particle* p1, const Particle* p2)
-  {
-    return p1->w > p2->w;
-  }
-
   static bool sort_trajectories(const std::pair<int, double>& p1, const std::pair<int, double>& p2)
   {
     return p1.second > p2.second;
@@ -0,0 +1,147 @@
+
+/// \file  LaneGraph.h
+/// \brief Compact lane graph (integer node ids, CSR adjacency) and heap based Dijkstra/A* search for global planning
+/// \date Oct 18, 2026
+
+
+#ifndef LANEGRAPH_H_
+#define LANEGRAPH_H_
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+enum LANE_GRAPH_EDGE_TYPE {GRAPH_EDGE_FRONT = 0, GRAPH_EDGE_LEFT = 1, GRAPH_EDGE_RIGHT = 2};
+
+/**
+ * Lane graph compiled once from the RoadNetwork waypoints.
+ * Nodes are the map waypoints, edges are pFronts (forward) and pLeft/pRight (lane change).
+ * Edge cost is the edge length plus the actionCost of the target waypoint, same as BuildPlanningSearchTreeV2.
+ */
+class LaneGraph
+{
+public:
+  std::vector<WayPoint*> m_Nodes;
+  std::vector<int> m_EdgeStart; // CSR offsets, size nNodes+1
+  std::vector<int> m_EdgeTarget;
+  std::vector<unsigned char> m_EdgeType;
+  std::vector<double> m_EdgeLength;
+  std::vector<double> m_EdgeCost;
+
+  /**
+   * Landmark distances for the ALT heuristic, computed on edge lengths only so they stay admissible
+   * when actionCost is updated at run time (e.g. UpdateMapWithOccupancyGrid).
+   */
+  std::vector<std::vector<float> > m_LandmarkFrom; // d(landmark, node)
+  std::vector<std::vector<float> > m_LandmarkTo;   // d(node, landmark)
+
+  LaneGraph();
+  virtual ~LaneGraph();
+
+  void BuildGraph(RoadNetwork& map);
+  void BuildGraph(const std::vector<WayPoint*>& seeds);
+  bool IsBuiltFor(const RoadNetwork& map) const;
+  void Clear();
+
+  /**
+   * Reload edge costs from the current actionCost of the waypoints, O(edges).
+   */
+  void UpdateEdgeCosts();
+
+  void BuildLandmarks(const int& nLandmarks);
+
+  int GetNodeId(const WayPoint* p) const;
+  int nNodes() const { return m_Nodes.size(); }
+  bool IsEuclideanAdmissible() const { return m_bEuclideanAdmissible; }
+
+  /**
+   * Admissible lower bound of the path cost from node to goal (ALT landmarks), 0 if there are no landmarks.
+   */
+  double LandmarkHeuristic(const int& node, const int& goal) const;
+
+private:
+  std::unordered_map<const WayPoint*, int> m_NodeIds;
+  std::vector<int> m_ReverseEdgeStart;
+  std::vector<int> m_ReverseEdgeSource;
+  std::vector<double> m_ReverseEdgeLength;
+  bool m_bEuclideanAdmissible;
+
+  const RoadNetwork* m_pMap;
+  size_t m_MapSignature;
+
+  static size_t CalcMapSignature(const RoadNetwork& map);
+  void BuildReverseEdges();
+  void CalcShortestLengths(const int& source, const bool& bReverse, std::vector<float>& dist) const;
+};
+
+/**
+ * Binary min-heap over integer node ids with decrease-key.
+ * Positions are invalidated by a generation counter so Reset() does not touch every node.
+ */
+class IndexedMinHeap
+{
+public:
+  IndexedMinHeap();
+  void Reset(const int& capacity);
+  bool Empty() const { return m_Heap.empty(); }
+  void PushOrDecrease(const int& id, const double& key);
+  int Pop();
+
+private:
+  std::vector<int> m_Heap;
+  std::vector<double> m_Keys;
+  std::vector<int> m_Pos;
+  std::vector<unsigned int> m_PosStamp;
+  unsigned int m_Generation;
+
+  void SiftUp(int i);
+  void SiftDown(int i);
+  void Swap(const int& i, const int& j);
+};
+
+/**
+ * Route search on LaneGraph, drop-in replacement of PlanningHelpers::BuildPlanningSearchTreeV2.
+ * Search state lives in preallocated arrays reused between plans; only the waypoints of the resulting
+ * route are allocated and appended to all_cells_to_delete (pBacks/pLeft/pRight link them from goal to start).
+ */
+class LaneGraphSearch
+{
+public:
+  LaneGraphSearch();
+  virtual ~LaneGraphSearch();
+
+  WayPoint* BuildPlanningSearchTree(const LaneGraph& graph,
+      WayPoint* pStart,
+      const WayPoint& goalPos,
+      const std::vector<int>& globalPath,
+      const double& DistanceLimit,
+      const bool& bEnableLaneChange,
+      std::vector<WayPoint*>& all_cells_to_delete,
+      double fallback_min_goal_distance_th = 0.0,
+      const bool& bUseHeuristic = true);
+
+  int m_nExpandedNodes;
+
+private:
+  IndexedMinHeap m_Heap;
+  std::vector<double> m_Cost;
+  std::vector<double> m_DistSinceLaneChange;
+  std::vector<int> m_Parent;
+  std::vector<unsigned char> m_ParentEdge;
+  std::vector<unsigned int> m_Stamp;
+  std::vector<uint64_t> m_Visited;
+  unsigned int m_Generation;
+
+  void Reset(const int& nNodes);
+  bool IsVisited(const int& id) const { return (m_Visited[id >> 6] >> (id & 63)) & 1; }
+  void SetVisited(const int& id) { m_Visited[id >> 6] |= (uint64_t(1) << (id & 63)); }
+  WayPoint* ExtractRoute(const LaneGraph& graph, const int& goal, std::vector<WayPoint*>& all_cells_to_delete);
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* LANEGRAPH_H_ */
@@ -10,6 +10,7 @@
 #define LANE_CHANGE_SMOOTH_FACTOR_DISTANCE 8 // meters
 
 #include "RoadNetwork.h"
+#include "LaneGraph.h"
 
 namespace PlannerHNS
 {
@@ -50,6 +51,18 @@ public:
   double PredictTrajectoriesUsingDP(const WayPoint& startPose, std::vector<WayPoint*> closestWPs, const double& maxPlanningDistance, std::vector<std::vector<WayPoint> >& paths, const bool& bFindBranches = true, const bool bDirectionBased = false, const bool pathDensity = 1.0);
 
   void DeleteWaypoints(std::vector<WayPoint*>& wps);
+
+  /**
+   * Select the global route search used by PlanUsingDP. When enabled the map is compiled once into a LaneGraph
+   * and searched with an indexed heap (A* with euclidean + optional ALT landmarks), otherwise (default) BuildPlanningSearchTreeV2 is used.
+   */
+  void SetLaneGraphSearch(const bool& bEnable, const int& nLandmarks = 0);
+
+private:
+  bool m_bEnableLaneGraphSearch;
+  int m_nLaneGraphLandmarks;
+  LaneGraph m_LaneGraph;
+  LaneGraphSearch m_LaneGraphSearch;
 };
 
 }
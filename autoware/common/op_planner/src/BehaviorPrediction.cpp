@@ -22,8 +22,9 @@ BehaviorPrediction::BehaviorPrediction()
   m_bGenerateBranches = false;
   m_bUseFixedPrediction = true;
   m_bStepByStep = false;
-  m_bCanDecide = true;
   m_bParticleFilter = false;
+  m_RandomSeed = 0;
+  m_nFilterSteps = 0;
   UtilityHNS::UtilityH::GetTickCount(m_GenerationTimer);
   UtilityHNS::UtilityH::GetTickCount(m_ResamplingTimer);
   m_bFirstMove = true;
@@ -212,16 +213,38 @@ void BehaviorPrediction::PredictCurrentTrajectory(RoadNetwork& map, ObjParticles
 
 void BehaviorPrediction::ParticleFilterSteps(std::vector<ObjParticles*>& part_info)
 {
+  // one time step for all objects, so every object moves by the same dt
+  double dt = 0.08;
+  bool bMove = true;
+  if(!m_bStepByStep)
+  {
+    dt = UtilityHNS::UtilityH::GetTimeDiffNow(m_ResamplingTimer);
+    UtilityHNS::UtilityH::GetTickCount(m_ResamplingTimer);
+    if(m_bFirstMove)
+    {
+      m_bFirstMove = false;
+      bMove = false;
+    }
+  }
+
+  if(UtilityHNS::UtilityH::GetTimeDiffNow(m_GenerationTimer) > 2)
+    UtilityHNS::UtilityH::GetTickCount(m_GenerationTimer);
+
+  // objects are independent, the debug output is kept in order
+#pragma omp parallel for schedule(dynamic) if(!m_bDebugOut)
   for(unsigned int i=0; i < part_info.size(); i++)
   {
     SamplesFreshParticles(part_info.at(i));
     CollectParticles(part_info.at(i));
-    MoveParticles(part_info.at(i));
+    if(bMove)
+      MoveParticles(part_info.at(i), dt);
     CalculateWeights(part_info.at(i));
     RemoveWeakParticles(part_info.at(i));
     CalculateAveragesAndProbabilities(part_info.at(i));
     FindBest(part_info.at(i));
   }
+
+  m_nFilterSteps++;
 }
 
 int BehaviorPrediction::FromIndicatorToNumber(const PlannerHNS::LIGHT_INDICATOR& indi)
@@ -270,62 +293,59 @@ double BehaviorPrediction::CalcAccelerationWeight(int p_acl, int obj_acl)
     return 0.01;
 }
 
-void BehaviorPrediction::CalOnePartWeight(ObjParticles* pParts,Particle& p)
+void BehaviorPrediction::CalOnePartWeight(ObjParticles* pParts, const unsigned int& i)
 {
-  if(p.bDeleted) return;
-
-  //p.pose_w = exp(-(0.5*pow((p.pose.pos.x - pParts->obj.center.pos.x),2)/(2*MEASURE_POSE_ERROR*MEASURE_POSE_ERROR)+ pow((p.pose.pos.y - pParts->obj.center.pos.y),2)/(2*MEASURE_POSE_ERROR*MEASURE_POSE_ERROR)));
-  p.pose_w = 1.0/hypot(0.5*(p.pose.pos.y - pParts->obj.center.pos.y), 0.5*(p.pose.pos.x - pParts->obj.center.pos.x));
-  //p.dir_w  = exp(-(pow(fabs(UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(p.pose.pos.a,  pParts->obj.center.pos.a)),2)/(2*MEASURE_ANGLE_ERROR*MEASURE_ANGLE_ERROR)));
-  p.dir_w  = M_PI_2 - fabs(UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(p.pose.pos.a,  pParts->obj.center.pos.a));
-  p.vel_w  = exp(-(pow((p.vel - pParts->obj.center.v),2)/(2*MEASURE_VEL_ERROR*MEASURE_VEL_ERROR)));
-  //p.vel_w = fabs(p.vel - pParts->obj.center.v);
-  p.ind_w  = CalcIndicatorWeight(FromNumbertoIndicator(p.indicator), pParts->obj.indicator_state);
-  p.ind_w  -= p.ind_w*MEASURE_IND_ERROR;
-  p.acl_w = CalcAccelerationWeight(p.acc, pParts->obj.acceleration_desc);
-
-  //std::cout << p.beh << "|" << p.vel_w <<"|" <<p.vel << "|" << pParts->obj.center.v;
-
-  pParts->pose_w_t += p.pose_w;
-  pParts->dir_w_t += p.dir_w;
-  pParts->vel_w_t += p.vel_w;
-  pParts->ind_w_t += p.ind_w;
-  pParts->acl_w_t += p.acl_w;
-
-  if(p.pose_w > pParts->pose_w_max)
-    pParts->pose_w_max = p.pose_w;
-  if(p.dir_w > pParts->dir_w_max)
-    pParts->dir_w_max = p.dir_w;
-  if(p.vel_w > pParts->vel_w_max)
-    pParts->vel_w_max = p.vel_w;
-  if(p.ind_w > pParts->ind_w_max)
-    pParts->ind_w_max = p.ind_w;
-  if(p.acl_w > pParts->acl_w_max)
-    pParts->acl_w_max = p.acl_w;
-
-  if(p.pose_w < pParts->pose_w_min)
-    pParts->pose_w_min = p.pose_w;
-  if(p.dir_w < pParts->dir_w_min)
-    pParts->dir_w_min = p.dir_w;
-  if(p.vel_w < pParts->vel_w_min)
-    pParts->vel_w_min = p.vel_w;
-  if(p.ind_w < pParts->ind_w_min)
-    pParts->ind_w_min = p.ind_w;
-  if(p.acl_w < pParts->acl_w_min)
-    pParts->acl_w_min = p.acl_w;
-
-  p.w_raw = p.pose_w*POSE_FACTOR + p.dir_w*DIRECTION_FACTOR + p.vel_w*VELOCITY_FACTOR + p.ind_w*INDICATOR_FACTOR + p.acl_w*ACCELERATE_FACTOR;
-
-  if(p.w_raw >= pParts->max_w_raw)
-    pParts->max_w_raw = p.w_raw;
-
-  if(p.w_raw <= pParts->min_w_raw)
-    pParts->min_w_raw = p.w_raw;
+  ParticleSet& ps = pParts->m_Particles;
+
+  //ps.pose_w[i] = exp(-(0.5*pow((ps.x[i] - pParts->obj.center.pos.x),2)/(2*MEASURE_POSE_ERROR*MEASURE_POSE_ERROR)+ pow((ps.y[i] - pParts->obj.center.pos.y),2)/(2*MEASURE_POSE_ERROR*MEASURE_POSE_ERROR)));
+  ps.pose_w[i] = 1.0/hypot(0.5*(ps.y[i] - pParts->obj.center.pos.y), 0.5*(ps.x[i] - pParts->obj.center.pos.x));
+  //ps.dir_w[i]  = exp(-(pow(fabs(UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(ps.a[i],  pParts->obj.center.pos.a)),2)/(2*MEASURE_ANGLE_ERROR*MEASURE_ANGLE_ERROR)));
+  ps.dir_w[i]  = M_PI_2 - fabs(UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(ps.a[i],  pParts->obj.center.pos.a));
+  ps.vel_w[i]  = exp(-(pow((ps.vel[i] - pParts->obj.center.v),2)/(2*MEASURE_VEL_ERROR*MEASURE_VEL_ERROR)));
+  ps.ind_w[i]  = CalcIndicatorWeight(FromNumbertoIndicator(ps.indicator[i]), pParts->obj.indicator_state);
+  ps.ind_w[i]  -= ps.ind_w[i]*MEASURE_IND_ERROR;
+  ps.acl_w[i] = CalcAccelerationWeight(ps.acc[i], pParts->obj.acceleration_desc);
+
+  pParts->pose_w_t += ps.pose_w[i];
+  pParts->dir_w_t += ps.dir_w[i];
+  pParts->vel_w_t += ps.vel_w[i];
+  pParts->ind_w_t += ps.ind_w[i];
+  pParts->acl_w_t += ps.acl_w[i];
+
+  if(ps.pose_w[i] > pParts->pose_w_max)
+    pParts->pose_w_max = ps.pose_w[i];
+  if(ps.dir_w[i] > pParts->dir_w_max)
+    pParts->dir_w_max = ps.dir_w[i];
+  if(ps.vel_w[i] > pParts->vel_w_max)
+    pParts->vel_w_max = ps.vel_w[i];
+  if(ps.ind_w[i] > pParts->ind_w_max)
+    pParts->ind_w_max = ps.ind_w[i];
+  if(ps.acl_w[i] > pParts->acl_w_max)
+    pParts->acl_w_max = ps.acl_w[i];
+
+  if(ps.pose_w[i] < pParts->pose_w_min)
+    pParts->pose_w_min = ps.pose_w[i];
+  if(ps.dir_w[i] < pParts->dir_w_min)
+    pParts->dir_w_min = ps.dir_w[i];
+  if(ps.vel_w[i] < pParts->vel_w_min)
+    pParts->vel_w_min = ps.vel_w[i];
+  if(ps.ind_w[i] < pParts->ind_w_min)
+    pParts->ind_w_min = ps.ind_w[i];
+  if(ps.acl_w[i] < pParts->acl_w_min)
+    pParts->acl_w_min = ps.acl_w[i];
+
+  ps.w_raw[i] = ps.pose_w[i]*POSE_FACTOR + ps.dir_w[i]*DIRECTION_FACTOR + ps.vel_w[i]*VELOCITY_FACTOR + ps.ind_w[i]*INDICATOR_FACTOR + ps.acl_w[i]*ACCELERATE_FACTOR;
+
+  if(ps.w_raw[i] >= pParts->max_w_raw)
+    pParts->max_w_raw = ps.w_raw[i];
+
+  if(ps.w_raw[i] <= pParts->min_w_raw)
+    pParts->min_w_raw = ps.w_raw[i];
 }
 
-void BehaviorPrediction::NormalizeOnePartWeight(ObjParticles* pParts,Particle& p)
+void BehaviorPrediction::NormalizeOnePartWeight(ObjParticles* pParts, const unsigned int& i)
 {
-  if(p.bDeleted) return;
+  ParticleSet& ps = pParts->m_Particles;
 
   double pose_diff  = pParts->pose_w_max-pParts->pose_w_min;
   double dir_diff = pParts->dir_w_max-pParts->dir_w_min;
@@ -336,50 +356,49 @@ void BehaviorPrediction::NormalizeOnePartWeight(ObjParticles* pParts,Particle& p
   double epsilon = 0.05;
 
   if(fabs(pose_diff) > epsilon)
-    p.pose_w = p.pose_w/pose_diff;
+    ps.pose_w[i] = ps.pose_w[i]/pose_diff;
   else
-    p.pose_w = 0;
+    ps.pose_w[i] = 0;
 
-  if(p.pose_w > 1.0 ) p.pose_w = 1.0;
+  if(ps.pose_w[i] > 1.0 ) ps.pose_w[i] = 1.0;
 
   if(fabs(dir_diff) > epsilon)
-    p.dir_w = (p.dir_w - pParts->dir_w_min)/dir_diff;
+    ps.dir_w[i] = (ps.dir_w[i] - pParts->dir_w_min)/dir_diff;
   else
-    p.dir_w = 0;
+    ps.dir_w[i] = 0;
 
-  if(p.dir_w > 1.0 ) p.dir_w = 1.0;
+  if(ps.dir_w[i] > 1.0 ) ps.dir_w[i] = 1.0;
 
   if(fabs(vel_diff) > epsilon)
-    p.vel_w = (p.vel_w-pParts->vel_w_min)/vel_diff;
+    ps.vel_w[i] = (ps.vel_w[i]-pParts->vel_w_min)/vel_diff;
   else
-    p.vel_w = 0;
+    ps.vel_w[i] = 0;
 
-  if(p.vel_w > 1.0) p.vel_w = 1.0;
+  if(ps.vel_w[i] > 1.0) ps.vel_w[i] = 1.0;
 
   if(fabs(ind_diff) > epsilon)
-    p.ind_w = (p.ind_w - pParts->ind_w_min)/ind_diff;
+    ps.ind_w[i] = (ps.ind_w[i] - pParts->ind_w_min)/ind_diff;
   else
-    p.ind_w = 0;
+    ps.ind_w[i] = 0;
 
-  if(p.ind_w > 1.0) p.ind_w = 1.0;
+  if(ps.ind_w[i] > 1.0) ps.ind_w[i] = 1.0;
 
   if(fabs(acl_diff) > epsilon)
-    p.acl_w = (p.acl_w - pParts->acl_w_min)/acl_diff;
+    ps.acl_w[i] = (ps.acl_w[i] - pParts->acl_w_min)/acl_diff;
   else
-    p.acl_w = 0;
+    ps.acl_w[i] = 0;
 
-  if(p.acl_w > 1.0) p.acl_w = 1.0;
+  if(ps.acl_w[i] > 1.0) ps.acl_w[i] = 1.0;
 
-  p.w = p.pose_w*POSE_FACTOR + p.dir_w*DIRECTION_FACTOR + p.vel_w*VELOCITY_FACTOR + p.ind_w*INDICATOR_FACTOR + p.acl_w*ACCELERATE_FACTOR;
-  //p.w = p.pose_w*0.1 + p.vel_w*0.2 + p.dir_w * 0.2 + p.ind_w + 0.5;
+  ps.w[i] = ps.pose_w[i]*POSE_FACTOR + ps.dir_w[i]*DIRECTION_FACTOR + ps.vel_w[i]*VELOCITY_FACTOR + ps.ind_w[i]*INDICATOR_FACTOR + ps.acl_w[i]*ACCELERATE_FACTOR;
 
-  if(p.w >= pParts->max_w)
-    pParts->max_w = p.w;
+  if(ps.w[i] >= pParts->max_w)
+    pParts->max_w = ps.w[i];
 
-  if(p.w <= pParts->min_w)
-    pParts->min_w = p.w;
+  if(ps.w[i] <= pParts->min_w)
+    pParts->min_w = ps.w[i];
 
-    pParts->all_w += p.w;
+  pParts->all_w += ps.w[i];
 }
 
 void BehaviorPrediction::CalculateWeights(ObjParticles* pParts)
@@ -403,31 +422,25 @@ void BehaviorPrediction::CalculateWeights(ObjParticles* pParts)
   pParts->max_w_raw = DBL_MIN;
   pParts->min_w_raw = DBL_MAX;
 
-  //std::cout << "Acceleration Diff: ";
-  for(unsigned int i = 0 ; i < pParts->m_AllParticles.size(); i++)
+  for(unsigned int i = 0 ; i < pParts->m_Particles.size(); i++)
   {
-    //  std::cout << "(" << pParts->m_AllParticles.at(i)->pTraj->index <<",";
-      CalOnePartWeight(pParts, *pParts->m_AllParticles.at(i));
-      //std::cout << ")";
+    CalOnePartWeight(pParts, i);
   }
 
-  //std::cout << "Befor Normalize: Max: " <<  pParts->acl_w_max << ", Min: " << pParts->acl_w_min << std::endl;
-  //std::cout << std::endl;
-
   //if((pParts->m_TrajectoryTracker.size() > 1 && pParts->min_w_raw < 0.5) || pParts->max_w_raw == 0 || fabs(pParts->max_w_raw - pParts->min_w_raw) < 0.1 )
   if((pParts->max_w_raw == 0 || fabs(pParts->max_w_raw - pParts->min_w_raw) < 0.1 || pParts->min_w_raw > 0.5) && pParts->m_TrajectoryTracker.size() > 1)
-    m_bCanDecide = false;
+    pParts->m_bCanDecide = false;
   else
-    m_bCanDecide = true;
+    pParts->m_bCanDecide = true;
 
   //Normalize
   pParts->max_w = -9999999;
   pParts->min_w = 9999999;
   pParts->all_w = 0;
 
-  for(unsigned int i = 0 ; i < pParts->m_AllParticles.size(); i++)
+  for(unsigned int i = 0 ; i < pParts->m_Particles.size(); i++)
   {
-    NormalizeOnePartWeight(pParts, *pParts->m_AllParticles.at(i));
+    NormalizeOnePartWeight(pParts, i);
   }
 }
 
@@ -442,29 +455,26 @@ void BehaviorPrediction::CalculateAveragesAndProbabilities(ObjParticles* pParts)
 
 void BehaviorPrediction::RemoveWeakParticles(ObjParticles* pParts)
 {
-
+  ParticleSet& ps = pParts->m_Particles;
   double critical_val = pParts->min_w + (pParts->max_w - pParts->min_w)*KEEP_PERCENTAGE;
-//  std::cout << "Behavior Weights ------------------------------------------------ " << std::endl;
-//  std::cout << "Max Raw: " << pParts->max_w_raw << ", Min Raw: " << pParts->min_w_raw << std::endl;
-//  std::cout << "Keep Percent Value: " << critical_val <<  std::endl;
-//
-//  if(pParts->obj.acceleration > 0 )
-//    std::cout << "Accelerate vrooom vroom : " << std::endl;
-//  else if(pParts->obj.acceleration  < 0 )
-//    std::cout << "Brake Eeeeee Eeeeeeee: " << std::endl;
-
-  for(int i =0 ; i < pParts->m_AllParticles.size(); i++)
-  {
-    //also delete far particle
-    double d = hypot(pParts->obj.center.pos.y - pParts->m_AllParticles.at(i)->pose.pos.y, pParts->obj.center.pos.x - pParts->m_AllParticles.at(i)->pose.pos.x);
 
-    if(pParts->m_AllParticles.at(i)->w < critical_val || d > m_PredictionDistance)
+  // write the moved and weighted particles back, then erase the weak and the far ones in one pass per tracker
+  for(unsigned int i = 0; i < ps.size(); i++)
+  {
+    ps.Scatter(i);
+    double d = hypot(pParts->obj.center.pos.y - ps.y[i], pParts->obj.center.pos.x - ps.x[i]);
+    if(ps.w[i] < critical_val || d > m_PredictionDistance)
     {
-      pParts->m_AllParticles.at(i)->pTraj->DeleteParticle(*(pParts->m_AllParticles.at(i)), pParts->m_AllParticles.at(i)->original_index);
-      pParts->m_AllParticles.erase(pParts->m_AllParticles.begin()+i);
-      i--;
+      ps.pTraj[i]->DeleteParticle(*ps.pSource[i]);
     }
   }
+
+  ps.clear();
+
+  for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
+  {
+    pParts->m_TrajectoryTracker.at(t)->RemoveDeletedParticles();
+  }
 }
 
 void BehaviorPrediction::FindBest(ObjParticles* pParts)
@@ -500,7 +510,7 @@ void BehaviorPrediction::FindBest(ObjParticles* pParts)
     }
   }
 
-  if(m_bCanDecide && pParts->best_beh_track != nullptr)
+  if(pParts->m_bCanDecide && pParts->best_beh_track != nullptr)
   {
     std::string str_beh = "Unknown";
     if(pParts->best_beh_track->best_beh == BEH_STOPPING_STATE)
@@ -537,38 +547,14 @@ void BehaviorPrediction::FindBest(ObjParticles* pParts)
 
 void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
 {
-  timespec _time;
-  UtilityHNS::UtilityH::GetTickCount(_time);
-  srand(_time.tv_nsec);
-
-  ENG eng(_time.tv_nsec);
-  NormalDIST dist_x(0, MOTION_POSE_ERROR);
-  VariatGEN gen_x(eng, dist_x);
-  NormalDIST vel(MOTION_VEL_ERROR, MOTION_VEL_ERROR);
-  VariatGEN gen_v(eng, vel);
-  NormalDIST ang(0, MOTION_ANGLE_ERROR);
-  VariatGEN gen_a(eng, ang);
-//  NormalDIST acl(0, MEASURE_ACL_ERROR);
-//  VariatGEN gen_acl(eng, acl);
+  // stream per object and time step, the samples do not depend on the other objects or on the thread
+  CounterRNG rng(m_RandomSeed, ((uint64_t)(uint32_t)pParts->obj.id << 32) | (m_nFilterSteps & 0xFFFFFFFF));
 
   Particle p;
   p.pose = pParts->obj.center;
   p.vel = 0;
   p.acc = 0;
   p.indicator = 0;
-  bool bRegenerate = true;
-
-  if(UtilityHNS::UtilityH::GetTimeDiffNow(m_GenerationTimer) > 2)
-  {
-    UtilityHNS::UtilityH::GetTickCount(m_GenerationTimer);
-    bRegenerate = true;
-  }
-
-//  for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
-//  {
-//    PlanningHelpers::FixPathDensity(pParts->m_TrajectoryTracker.at(t)->trajectory, 0.5);
-//    PlanningHelpers::CalcAngleAndCost(pParts->m_TrajectoryTracker.at(t)->trajectory);
-//  }
 
   for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
   {
@@ -585,10 +571,10 @@ void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
       for(unsigned int i=0; i < nPs; i++)
       {
         Particle p_new = p;
-        p_new.pose.pos.x += gen_x();
-        p_new.pose.pos.y += gen_x();
-        p_new.pose.pos.a += gen_a();
-        p_new.vel = pParts->obj.center.v + fabs(gen_v());
+        p_new.pose.pos.x += rng.Normal(0, MOTION_POSE_ERROR);
+        p_new.pose.pos.y += rng.Normal(0, MOTION_POSE_ERROR);
+        p_new.pose.pos.a += rng.Normal(0, MOTION_ANGLE_ERROR);
+        p_new.vel = pParts->obj.center.v + fabs(rng.Normal(MOTION_VEL_ERROR, MOTION_VEL_ERROR));
         p_new.pose.v = p_new.vel;
         pParts->m_TrajectoryTracker.at(t)->InsertNewParticle(p_new);
       }
@@ -602,11 +588,11 @@ void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
       for(unsigned int i=0; i < nPs; i++)
       {
         Particle p_new = p;
-        p_new.pose.pos.x += gen_x();
-        p_new.pose.pos.y += gen_x();
-        p_new.pose.pos.a += gen_a();
+        p_new.pose.pos.x += rng.Normal(0, MOTION_POSE_ERROR);
+        p_new.pose.pos.y += rng.Normal(0, MOTION_POSE_ERROR);
+        p_new.pose.pos.a += rng.Normal(0, MOTION_ANGLE_ERROR);
         p_new.vel = 0;
-        p_new.pose.v = pParts->obj.center.v + fabs(gen_v());
+        p_new.pose.v = pParts->obj.center.v + fabs(rng.Normal(MOTION_VEL_ERROR, MOTION_VEL_ERROR));
         pParts->m_TrajectoryTracker.at(t)->InsertNewParticle(p_new);
       }
     }
@@ -615,44 +601,37 @@ void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
 
 void BehaviorPrediction::CollectParticles(ObjParticles* pParts)
 {
-  pParts->m_AllParticles.clear();
+  unsigned int n = 0;
+  for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
+  {
+    n += pParts->m_TrajectoryTracker.at(t)->m_ForwardPart.size() + pParts->m_TrajectoryTracker.at(t)->m_StopPart.size();
+  }
+
+  // the arrays keep their capacity between the steps
+  ParticleSet& ps = pParts->m_Particles;
+  ps.resize(n);
+  n = 0;
   for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
   {
-    for(unsigned int i=0; i < pParts->m_TrajectoryTracker.at(t)->m_ForwardPart.size(); i++)
+    TrajectoryTracker* pTrack = pParts->m_TrajectoryTracker.at(t);
+    for(unsigned int i=0; i < pTrack->m_ForwardPart.size(); i++)
     {
-      pParts->m_TrajectoryTracker.at(t)->m_ForwardPart.at(i).original_index = i;
-      pParts->m_AllParticles.push_back(&pParts->m_TrajectoryTracker.at(t)->m_ForwardPart.at(i));
+      pTrack->m_ForwardPart.at(i).original_index = i;
+      ps.Gather(n++, pTrack->m_ForwardPart.at(i));
     }
 
-    for(unsigned int i=0; i < pParts->m_TrajectoryTracker.at(t)->m_StopPart.size(); i++)
+    for(unsigned int i=0; i < pTrack->m_StopPart.size(); i++)
     {
-      pParts->m_TrajectoryTracker.at(t)->m_StopPart.at(i).original_index = i;
-      pParts->m_AllParticles.push_back(&pParts->m_TrajectoryTracker.at(t)->m_StopPart.at(i));
+      pTrack->m_StopPart.at(i).original_index = i;
+      ps.Gather(n++, pTrack->m_StopPart.at(i));
     }
   }
 }
 
-void BehaviorPrediction::MoveParticles(ObjParticles* pParts)
+void BehaviorPrediction::MoveParticles(ObjParticles* pParts, const double& dt)
 {
-  double dt = 0.01;
-  if(m_bStepByStep)
-  {
-    dt = 0.08;
-  }
-  else
-  {
-    dt = UtilityHNS::UtilityH::GetTimeDiffNow(m_ResamplingTimer);
-    UtilityHNS::UtilityH::GetTickCount(m_ResamplingTimer);
-    if(m_bFirstMove)
-    {
-      m_bFirstMove  = false;
-      return;
-    }
-  }
-
   PlannerHNS::BehaviorState curr_behavior;
   PlannerHNS::ParticleInfo curr_part_info;
-  PlannerHNS::VehicleState control_u;
   PassiveDecisionMaker decision_make;
   PlannerHNS::CAR_BASIC_INFO carInfo;
   carInfo.width = pParts->obj.w;
@@ -666,97 +645,86 @@ void BehaviorPrediction::MoveParticles(ObjParticles* pParts)
   carInfo.turning_radius = 7.2;
   carInfo.wheel_base = carInfo.length*0.75;
 
+  // the speed profile only changes with the trajectory
   for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
   {
-    PlanningHelpers::GenerateRecommendedSpeed(pParts->m_TrajectoryTracker.at(t)->trajectory, carInfo.max_speed_forward, 1.0);
+    TrajectoryTracker* pTrack = pParts->m_TrajectoryTracker.at(t);
+    if(!pTrack->bRecommendedSpeed)
+    {
+      PlanningHelpers::GenerateRecommendedSpeed(pTrack->trajectory, carInfo.max_speed_forward, 1.0);
+      pTrack->bRecommendedSpeed = true;
+    }
   }
 
-//  std::cout << "Motion Status------ " << std::endl;
-//  if(pParts->obj.acceleration_desc == 1)
-//    std::cout << "Acceleration: " << pParts->obj.acceleration_raw << ", Accelerate: " << pParts->obj.acceleration_desc << std::endl;
-//  else if(pParts->obj.acceleration_desc == -1)
-//    std::cout << "Acceleration: " << pParts->obj.acceleration_raw << ", Braking   : " << pParts->obj.acceleration_desc << std::endl;
-//  else
-//    std::cout << "Acceleration: " << pParts->obj.acceleration_raw << ", Cruising  : " << pParts->obj.acceleration_desc << std::endl;
-
-  for(unsigned int i=0; i < pParts->m_AllParticles.size(); i++)
+  // the motion models only use the position and the speed of the pose
+  ParticleSet& ps = pParts->m_Particles;
+  WayPoint pose;
+  for(unsigned int i=0; i < ps.size(); i++)
   {
-    Particle* p = pParts->m_AllParticles.at(i);
+    pose.pos.x = ps.x[i];
+    pose.pos.y = ps.y[i];
+    pose.pos.a = ps.a[i];
 
     if(USE_OPEN_PLANNER_MOVE == 0)
+    {
+      pose.v = pParts->obj.center.v;
+      curr_part_info = decision_make.MoveStepSimple(dt, pose, ps.pTraj[i]->trajectory, carInfo);
+      if(ps.prev_time_diff[i] > ACCELERATION_CALC_TIME)
       {
-      p->pose.v = pParts->obj.center.v;
-      curr_part_info = decision_make.MoveStepSimple(dt, p->pose, p->pTraj->trajectory,carInfo);
-      if(p->prev_time_diff > ACCELERATION_CALC_TIME)
-      {
-        p->acc_raw = (curr_part_info.vel - p->vel_prev_big)/p->prev_time_diff;
-        p->vel_prev_big = curr_part_info.vel;
-        p->prev_time_diff = 0;
+        ps.acc_raw[i] = (curr_part_info.vel - ps.vel_prev_big[i])/ps.prev_time_diff[i];
+        ps.vel_prev_big[i] = curr_part_info.vel;
+        ps.prev_time_diff[i] = 0;
       }
       else
       {
-        p->prev_time_diff += dt;
+        ps.prev_time_diff[i] += dt;
       }
 
-      if(fabs(p->acc_raw) < ACCELERATION_DECISION_VALUE)
-        p->acc = 0;
-      else if(p->acc_raw > ACCELERATION_DECISION_VALUE)
-        p->acc = 1;
-      else if(p->acc_raw < -ACCELERATION_DECISION_VALUE)
-        p->acc = -1;
-
-      p->indicator = FromIndicatorToNumber(curr_part_info.indicator);
-
-//      if(curr_behavior.state == PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_YIELDING_STATE)
-//        p->vel += 1;
-//      else if(p->beh == PlannerHNS::BEH_YIELDING_STATE)
-//        p->vel = p->vel/2.0;
-//      else if(curr_behavior.state != PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_STOPPING_STATE)
-//        p->vel += 1;
-//      else if(p->beh == PlannerHNS::BEH_STOPPING_STATE)
-//        p->vel = 0;
-
-//      if(curr_behavior.state != PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_STOPPING_STATE)
-//        p->vel += 1;
-      if(p->beh == PlannerHNS::BEH_STOPPING_STATE)
-      {
-        p->vel = 0;
-        if(p->acc == 0)
-          p->acc = -1;
-        else if(p->acc == 1)
-          p->acc = 0;
-      }
+      if(fabs(ps.acc_raw[i]) < ACCELERATION_DECISION_VALUE)
+        ps.acc[i] = 0;
+      else if(ps.acc_raw[i] > ACCELERATION_DECISION_VALUE)
+        ps.acc[i] = 1;
+      else if(ps.acc_raw[i] < -ACCELERATION_DECISION_VALUE)
+        ps.acc[i] = -1;
 
+      ps.indicator[i] = FromIndicatorToNumber(curr_part_info.indicator);
+
+      if(ps.beh[i] == PlannerHNS::BEH_STOPPING_STATE)
+      {
+        ps.vel[i] = 0;
+        if(ps.acc[i] == 0)
+          ps.acc[i] = -1;
+        else if(ps.acc[i] == 1)
+          ps.acc[i] = 0;
       }
+    }
     else
+    {
+      pose.v = ps.pose_v[i];
+      curr_behavior = decision_make.MoveStep(dt, pose, ps.pTraj[i]->trajectory, carInfo);
+      ps.acc[i] = UtilityHNS::UtilityH::GetSign(curr_behavior.maxVelocity - ps.vel_prev_big[i]);
+      ps.vel[i] = curr_behavior.maxVelocity;
+      if(fabs(ps.vel[i] - ps.vel_prev_big[i]) > 0.5)
+        ps.vel_prev_big[i] = ps.vel[i];
+      ps.indicator[i] = FromIndicatorToNumber(curr_behavior.indicator);
+
+      if(curr_behavior.state == PlannerHNS::STOPPING_STATE && ps.beh[i] == PlannerHNS::BEH_YIELDING_STATE)
+        ps.vel[i] += 1;
+      else if(ps.beh[i] == PlannerHNS::BEH_YIELDING_STATE)
+        ps.vel[i] = ps.vel[i]/2.0;
+      else if(curr_behavior.state != PlannerHNS::STOPPING_STATE && ps.beh[i] == PlannerHNS::BEH_STOPPING_STATE)
+        ps.vel[i] += 1;
+      else if(ps.beh[i] == PlannerHNS::BEH_STOPPING_STATE)
       {
-      curr_behavior = decision_make.MoveStep(dt, p->pose, p->pTraj->trajectory,carInfo);
-      p->acc = UtilityHNS::UtilityH::GetSign(curr_behavior.maxVelocity - p->vel_prev_big);
-      p->vel = curr_behavior.maxVelocity;
-      if(fabs(p->vel - p->vel_prev_big) > 0.5)
-        p->vel_prev_big = p->vel;
-      p->indicator = FromIndicatorToNumber(curr_behavior.indicator);
-//      if(p->indicator == 0)
-//        std::cout << ", Off";
-//      else if(p->indicator == 1)
-//        std::cout << ", Left";
-//      else if(p->indicator == 2)
-//        std::cout << ", Right";
-
-      if(curr_behavior.state == PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_YIELDING_STATE)
-        p->vel += 1;
-      else if(p->beh == PlannerHNS::BEH_YIELDING_STATE)
-        p->vel = p->vel/2.0;
-      else if(curr_behavior.state != PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_STOPPING_STATE)
-        p->vel += 1;
-      else if(p->beh == PlannerHNS::BEH_STOPPING_STATE)
-      {
-        p->vel = 0;
+        ps.vel[i] = 0;
       }
+    }
 
-      }
+    ps.x[i] = pose.pos.x;
+    ps.y[i] = pose.pos.y;
+    ps.a[i] = pose.pos.a;
+    ps.pose_v[i] = pose.v;
   }
-  //std::cout << "End Motion Status ------ " << std::endl;
 }
 
 } /* namespace PlannerHNS */
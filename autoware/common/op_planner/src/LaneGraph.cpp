@@ -0,0 +1,614 @@
+
+/// \file  LaneGraph.cpp
+/// \brief Compact lane graph (integer node ids, CSR adjacency) and heap based Dijkstra/A* search for global planning
+/// \date Oct 18, 2026
+
+#include "op_planner/LaneGraph.h"
+#include "op_planner/PlanningHelpers.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+using namespace std;
+
+namespace PlannerHNS
+{
+
+LaneGraph::LaneGraph()
+{
+  m_bEuclideanAdmissible = true;
+  m_pMap = nullptr;
+  m_MapSignature = 0;
+}
+
+LaneGraph::~LaneGraph()
+{
+}
+
+void LaneGraph::Clear()
+{
+  m_Nodes.clear();
+  m_NodeIds.clear();
+  m_EdgeStart.clear();
+  m_EdgeTarget.clear();
+  m_EdgeType.clear();
+  m_EdgeLength.clear();
+  m_EdgeCost.clear();
+  m_ReverseEdgeStart.clear();
+  m_ReverseEdgeSource.clear();
+  m_ReverseEdgeLength.clear();
+  m_LandmarkFrom.clear();
+  m_LandmarkTo.clear();
+  m_pMap = nullptr;
+  m_MapSignature = 0;
+}
+
+size_t LaneGraph::CalcMapSignature(const RoadNetwork& map)
+{
+  size_t nLanes = 0, nPoints = 0;
+  const WayPoint* pFirst = nullptr;
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+  {
+    for(unsigned int i = 0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+    {
+      const Lane& l = map.roadSegments.at(rs).Lanes.at(i);
+      if(!pFirst && l.points.size() > 0)
+        pFirst = &l.points.at(0);
+      nPoints += l.points.size();
+      nLanes++;
+    }
+  }
+
+  return (nLanes * 1000003) ^ nPoints ^ reinterpret_cast<size_t>(pFirst);
+}
+
+bool LaneGraph::IsBuiltFor(const RoadNetwork& map) const
+{
+  return m_pMap == &map && m_MapSignature == CalcMapSignature(map);
+}
+
+void LaneGraph::BuildGraph(RoadNetwork& map)
+{
+  vector<WayPoint*> seeds;
+  for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+  {
+    for(unsigned int i = 0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+    {
+      Lane& l = map.roadSegments.at(rs).Lanes.at(i);
+      for(unsigned int p = 0; p < l.points.size(); p++)
+        seeds.push_back(&l.points.at(p));
+    }
+  }
+
+  BuildGraph(seeds);
+  m_pMap = &map;
+  m_MapSignature = CalcMapSignature(map);
+}
+
+void LaneGraph::BuildGraph(const vector<WayPoint*>& seeds)
+{
+  Clear();
+
+  //assign integer ids, waypoints reachable from the seeds through fronts or lane changes are included as well
+  vector<WayPoint*> stack;
+  for(unsigned int i = 0; i < seeds.size(); i++)
+  {
+    if(seeds.at(i) && m_NodeIds.insert(make_pair(seeds.at(i), (int)m_Nodes.size())).second)
+    {
+      m_Nodes.push_back(seeds.at(i));
+      stack.push_back(seeds.at(i));
+    }
+  }
+
+  while(stack.size() > 0)
+  {
+    WayPoint* pW = stack.back();
+    stack.pop_back();
+
+    vector<WayPoint*> next = pW->pFronts;
+    next.push_back(pW->pLeft);
+    next.push_back(pW->pRight);
+    for(unsigned int i = 0; i < next.size(); i++)
+    {
+      if(next.at(i) && m_NodeIds.insert(make_pair(next.at(i), (int)m_Nodes.size())).second)
+      {
+        m_Nodes.push_back(next.at(i));
+        stack.push_back(next.at(i));
+      }
+    }
+  }
+
+  //CSR adjacency
+  m_EdgeStart.resize(m_Nodes.size()+1, 0);
+  for(unsigned int n = 0; n < m_Nodes.size(); n++)
+  {
+    WayPoint* pW = m_Nodes.at(n);
+    m_EdgeStart.at(n) = m_EdgeTarget.size();
+
+    for(unsigned int i = 0; i < pW->pFronts.size(); i++)
+    {
+      if(!pW->pFronts.at(i)) continue;
+      m_EdgeTarget.push_back(m_NodeIds.at(pW->pFronts.at(i)));
+      m_EdgeType.push_back(GRAPH_EDGE_FRONT);
+    }
+
+    if(pW->pLeft)
+    {
+      m_EdgeTarget.push_back(m_NodeIds.at(pW->pLeft));
+      m_EdgeType.push_back(GRAPH_EDGE_LEFT);
+    }
+
+    if(pW->pRight)
+    {
+      m_EdgeTarget.push_back(m_NodeIds.at(pW->pRight));
+      m_EdgeType.push_back(GRAPH_EDGE_RIGHT);
+    }
+  }
+  m_EdgeStart.at(m_Nodes.size()) = m_EdgeTarget.size();
+
+  m_EdgeLength.resize(m_EdgeTarget.size());
+  for(unsigned int n = 0; n < m_Nodes.size(); n++)
+  {
+    const WayPoint* pW = m_Nodes.at(n);
+    for(int e = m_EdgeStart.at(n); e < m_EdgeStart.at(n+1); e++)
+    {
+      const WayPoint* pT = m_Nodes.at(m_EdgeTarget.at(e));
+      m_EdgeLength.at(e) = hypot(pT->pos.y - pW->pos.y, pT->pos.x - pW->pos.x);
+    }
+  }
+
+  UpdateEdgeCosts();
+  BuildReverseEdges();
+}
+
+void LaneGraph::UpdateEdgeCosts()
+{
+  m_bEuclideanAdmissible = true;
+  m_EdgeCost.resize(m_EdgeTarget.size());
+  for(unsigned int e = 0; e < m_EdgeTarget.size(); e++)
+  {
+    const WayPoint* pT = m_Nodes.at(m_EdgeTarget.at(e));
+    double d = m_EdgeLength.at(e);
+    for(unsigned int a = 0; a < pT->actionCost.size(); a++)
+      d += pT->actionCost.at(a).second;
+
+    //negative action costs break the distance based lower bounds, heuristics are disabled in that case
+    if(d < m_EdgeLength.at(e))
+      m_bEuclideanAdmissible = false;
+
+    m_EdgeCost.at(e) = d;
+  }
+}
+
+void LaneGraph::BuildReverseEdges()
+{
+  m_ReverseEdgeStart.assign(m_Nodes.size()+1, 0);
+  for(unsigned int e = 0; e < m_EdgeTarget.size(); e++)
+    m_ReverseEdgeStart.at(m_EdgeTarget.at(e)+1)++;
+  for(unsigned int n = 0; n < m_Nodes.size(); n++)
+    m_ReverseEdgeStart.at(n+1) += m_ReverseEdgeStart.at(n);
+
+  vector<int> fill = m_ReverseEdgeStart;
+  m_ReverseEdgeSource.resize(m_EdgeTarget.size());
+  m_ReverseEdgeLength.resize(m_EdgeTarget.size());
+  for(unsigned int n = 0; n < m_Nodes.size(); n++)
+  {
+    for(int e = m_EdgeStart.at(n); e < m_EdgeStart.at(n+1); e++)
+    {
+      int pos = fill.at(m_EdgeTarget.at(e))++;
+      m_ReverseEdgeSource.at(pos) = n;
+      m_ReverseEdgeLength.at(pos) = m_EdgeLength.at(e);
+    }
+  }
+}
+
+void LaneGraph::CalcShortestLengths(const int& source, const bool& bReverse, vector<float>& dist) const
+{
+  const vector<int>& start = bReverse ? m_ReverseEdgeStart : m_EdgeStart;
+  const vector<int>& target = bReverse ? m_ReverseEdgeSource : m_EdgeTarget;
+  const vector<double>& length = bReverse ? m_ReverseEdgeLength : m_EdgeLength;
+
+  vector<double> d(m_Nodes.size(), numeric_limits<double>::infinity());
+  IndexedMinHeap heap;
+  heap.Reset(m_Nodes.size());
+  d.at(source) = 0;
+  heap.PushOrDecrease(source, 0);
+  while(!heap.Empty())
+  {
+    int u = heap.Pop();
+    for(int e = start.at(u); e < start.at(u+1); e++)
+    {
+      int v = target.at(e);
+      double nd = d.at(u) + length.at(e);
+      if(nd < d.at(v))
+      {
+        d.at(v) = nd;
+        heap.PushOrDecrease(v, nd);
+      }
+    }
+  }
+
+  dist.resize(m_Nodes.size());
+  for(unsigned int i = 0; i < d.size(); i++)
+    dist.at(i) = d.at(i);
+}
+
+void LaneGraph::BuildLandmarks(const int& nLandmarks)
+{
+  m_LandmarkFrom.clear();
+  m_LandmarkTo.clear();
+  if(nLandmarks <= 0 || m_Nodes.size() == 0) return;
+
+  //farthest point selection on positions, spreads landmarks over the map borders
+  vector<double> min_dist(m_Nodes.size(), numeric_limits<double>::max());
+  int next = 0;
+  double max_d = -1;
+  for(unsigned int i = 0; i < m_Nodes.size(); i++)
+  {
+    double d = distance2points(m_Nodes.at(0)->pos, m_Nodes.at(i)->pos);
+    if(d > max_d)
+    {
+      max_d = d;
+      next = i;
+    }
+  }
+
+  for(int l = 0; l < nLandmarks && l < (int)m_Nodes.size(); l++)
+  {
+    m_LandmarkFrom.push_back(vector<float>());
+    m_LandmarkTo.push_back(vector<float>());
+    CalcShortestLengths(next, false, m_LandmarkFrom.back());
+    CalcShortestLengths(next, true, m_LandmarkTo.back());
+
+    const GPSPoint& p = m_Nodes.at(next)->pos;
+    max_d = -1;
+    for(unsigned int i = 0; i < m_Nodes.size(); i++)
+    {
+      min_dist.at(i) = min(min_dist.at(i), distance2points(p, m_Nodes.at(i)->pos));
+      if(min_dist.at(i) > max_d)
+      {
+        max_d = min_dist.at(i);
+        next = i;
+      }
+    }
+  }
+}
+
+double LaneGraph::LandmarkHeuristic(const int& node, const int& goal) const
+{
+  double h = 0;
+  for(unsigned int l = 0; l < m_LandmarkFrom.size(); l++)
+  {
+    const float from_goal = m_LandmarkFrom.at(l)[goal];
+    const float from_node = m_LandmarkFrom.at(l)[node];
+    if(from_goal != numeric_limits<float>::infinity() && from_node != numeric_limits<float>::infinity())
+      h = max(h, (double)(from_goal - from_node));
+
+    const float to_node = m_LandmarkTo.at(l)[node];
+    const float to_goal = m_LandmarkTo.at(l)[goal];
+    if(to_node != numeric_limits<float>::infinity() && to_goal != numeric_limits<float>::infinity())
+      h = max(h, (double)(to_node - to_goal));
+  }
+
+  //margin for float rounding of stored distances
+  return h * 0.999;
+}
+
+int LaneGraph::GetNodeId(const WayPoint* p) const
+{
+  unordered_map<const WayPoint*, int>::const_iterator it = m_NodeIds.find(p);
+  if(it == m_NodeIds.end())
+    return -1;
+  return it->second;
+}
+
+IndexedMinHeap::IndexedMinHeap()
+{
+  m_Generation = 0;
+}
+
+void IndexedMinHeap::Reset(const int& capacity)
+{
+  m_Heap.clear();
+  if((int)m_Pos.size() < capacity)
+  {
+    m_Pos.resize(capacity, -1);
+    m_Keys.resize(capacity, 0);
+    m_PosStamp.resize(capacity, 0);
+  }
+
+  m_Generation++;
+  if(m_Generation == 0)
+  {
+    std::fill(m_PosStamp.begin(), m_PosStamp.end(), 0);
+    m_Generation = 1;
+  }
+}
+
+void IndexedMinHeap::PushOrDecrease(const int& id, const double& key)
+{
+  if(m_PosStamp[id] == m_Generation && m_Pos[id] >= 0)
+  {
+    if(key < m_Keys[id])
+    {
+      m_Keys[id] = key;
+      SiftUp(m_Pos[id]);
+    }
+    return;
+  }
+
+  m_PosStamp[id] = m_Generation;
+  m_Keys[id] = key;
+  m_Pos[id] = m_Heap.size();
+  m_Heap.push_back(id);
+  SiftUp(m_Heap.size()-1);
+}
+
+int IndexedMinHeap::Pop()
+{
+  int top = m_Heap.front();
+  Swap(0, m_Heap.size()-1);
+  m_Heap.pop_back();
+  m_Pos[top] = -1;
+  if(m_Heap.size() > 0)
+    SiftDown(0);
+  return top;
+}
+
+void IndexedMinHeap::Swap(const int& i, const int& j)
+{
+  std::swap(m_Heap[i], m_Heap[j]);
+  m_Pos[m_Heap[i]] = i;
+  m_Pos[m_Heap[j]] = j;
+}
+
+void IndexedMinHeap::SiftUp(int i)
+{
+  while(i > 0)
+  {
+    int parent = (i-1)/2;
+    if(m_Keys[m_Heap[i]] >= m_Keys[m_Heap[parent]])
+      break;
+    Swap(i, parent);
+    i = parent;
+  }
+}
+
+void IndexedMinHeap::SiftDown(int i)
+{
+  const int n = m_Heap.size();
+  while(true)
+  {
+    int l = 2*i+1, r = 2*i+2, smallest = i;
+    if(l < n && m_Keys[m_Heap[l]] < m_Keys[m_Heap[smallest]]) smallest = l;
+    if(r < n && m_Keys[m_Heap[r]] < m_Keys[m_Heap[smallest]]) smallest = r;
+    if(smallest == i)
+      break;
+    Swap(i, smallest);
+    i = smallest;
+  }
+}
+
+LaneGraphSearch::LaneGraphSearch()
+{
+  m_Generation = 0;
+  m_nExpandedNodes = 0;
+}
+
+LaneGraphSearch::~LaneGraphSearch()
+{
+}
+
+void LaneGraphSearch::Reset(const int& nNodes)
+{
+  if((int)m_Cost.size() < nNodes)
+  {
+    m_Cost.resize(nNodes);
+    m_DistSinceLaneChange.resize(nNodes);
+    m_Parent.resize(nNodes);
+    m_ParentEdge.resize(nNodes);
+    m_Stamp.resize(nNodes, 0);
+  }
+
+  m_Visited.assign((nNodes+63)/64, 0);
+  m_Heap.Reset(nNodes);
+
+  m_Generation++;
+  if(m_Generation == 0)
+  {
+    std::fill(m_Stamp.begin(), m_Stamp.end(), 0);
+    m_Generation = 1;
+  }
+}
+
+WayPoint* LaneGraphSearch::BuildPlanningSearchTree(const LaneGraph& graph,
+    WayPoint* pStart,
+    const WayPoint& goalPos,
+    const vector<int>& globalPath,
+    const double& DistanceLimit,
+    const bool& bEnableLaneChange,
+    vector<WayPoint*>& all_cells_to_delete,
+    double fallback_min_goal_distance_th,
+    const bool& bUseHeuristic)
+{
+  m_nExpandedNodes = 0;
+  if(!pStart) return nullptr;
+
+  const int start = graph.GetNodeId(pStart);
+  if(start < 0) return nullptr;
+
+  int goal = graph.GetNodeId(&goalPos);
+  if(goal < 0)
+  {
+    for(int i = 0; i < graph.nNodes(); i++)
+    {
+      if(distance2points(graph.m_Nodes.at(i)->pos, goalPos.pos) <= 0.1)
+      {
+        goal = i;
+        break;
+      }
+    }
+  }
+
+  const bool bEuclidean = bUseHeuristic && graph.IsEuclideanAdmissible();
+  const bool bLandmarks = bEuclidean && goal >= 0 && graph.m_LandmarkFrom.size() > 0;
+
+  vector<int> sortedGlobalPath = globalPath;
+  sort(sortedGlobalPath.begin(), sortedGlobalPath.end());
+
+  Reset(graph.nNodes());
+  m_Cost[start] = 0;
+  m_DistSinceLaneChange[start] = 0;
+  m_Parent[start] = -1;
+  m_ParentEdge[start] = GRAPH_EDGE_FRONT;
+  m_Stamp[start] = m_Generation;
+  m_Heap.PushOrDecrease(start, 0);
+
+  int goal_found = -1;
+  int min_goal_distance_node = -1;
+  double min_goal_distance_to_waypoint = numeric_limits<double>::max();
+  //length of the generated waypoints, same limit as the legacy tree search (not the route cost, which includes actionCost)
+  double explored_distance = 0;
+
+  while(!m_Heap.Empty())
+  {
+    const int u = m_Heap.Pop();
+    if(IsVisited(u)) continue;
+    SetVisited(u);
+    m_nExpandedNodes++;
+
+    const WayPoint* pH = graph.m_Nodes.at(u);
+    double distance_to_goal = distance2points(pH->pos, goalPos.pos);
+    double angle_to_goal = UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(UtilityHNS::UtilityH::FixNegativeAngle(pH->pos.a), UtilityHNS::UtilityH::FixNegativeAngle(goalPos.pos.a));
+    if(distance_to_goal <= 0.1 && angle_to_goal < M_PI_4)
+    {
+      cout << "Goal Found, LaneID: " << pH->laneId <<", Distance : " << distance_to_goal << ", Angle: " << angle_to_goal*RAD2DEG << endl;
+      goal_found = u;
+      break;
+    }
+
+    if(distance_to_goal < min_goal_distance_to_waypoint)
+    {
+      min_goal_distance_to_waypoint = distance_to_goal;
+      min_goal_distance_node = u;
+    }
+
+    const bool bFrontAllowed = globalPath.size() == 0 ||
+        (pH->pLane && binary_search(sortedGlobalPath.begin(), sortedGlobalPath.end(), pH->pLane->id));
+    const bool bChangeAllowed = bEnableLaneChange && m_DistSinceLaneChange[u] > LANE_CHANGE_MIN_DISTANCE;
+
+    for(int e = graph.m_EdgeStart[u]; e < graph.m_EdgeStart[u+1]; e++)
+    {
+      const int v = graph.m_EdgeTarget[e];
+      const unsigned char type = graph.m_EdgeType[e];
+      if(IsVisited(v)) continue;
+      if(type == GRAPH_EDGE_FRONT && !bFrontAllowed) continue;
+      if(type != GRAPH_EDGE_FRONT && !bChangeAllowed) continue;
+
+      const double g = m_Cost[u] + graph.m_EdgeCost[e];
+      const double dsl = (type == GRAPH_EDGE_FRONT) ? m_DistSinceLaneChange[u] + graph.m_EdgeLength[e] : -LANE_CHANGE_MIN_DISTANCE*3;
+      if(m_Stamp[v] == m_Generation)
+      {
+        //one label per node (same as the search tree), for equal cost keep the one that allows the next lane change earlier
+        if(g > m_Cost[v] + 1e-9) continue;
+        if(g > m_Cost[v] - 1e-9)
+        {
+          if(dsl > m_DistSinceLaneChange[v])
+          {
+            m_Parent[v] = u;
+            m_ParentEdge[v] = type;
+            m_DistSinceLaneChange[v] = dsl;
+          }
+          continue;
+        }
+      }
+
+      if(m_Stamp[v] != m_Generation)
+        explored_distance += graph.m_EdgeLength[e];
+
+      m_Stamp[v] = m_Generation;
+      m_Cost[v] = g;
+      m_Parent[v] = u;
+      m_ParentEdge[v] = type;
+      m_DistSinceLaneChange[v] = dsl;
+
+      double h = 0;
+      if(bEuclidean)
+        h = distance2points(graph.m_Nodes.at(v)->pos, goalPos.pos);
+      if(bLandmarks)
+        h = max(h, graph.LandmarkHeuristic(v, goal));
+
+      m_Heap.PushOrDecrease(v, g + h);
+    }
+
+    if(explored_distance > DistanceLimit && globalPath.size() == 0)
+    {
+      cout << "Goal Not Found, LaneID: " << pH->laneId <<", Distance : " << explored_distance << endl;
+      goal_found = u;
+      break;
+    }
+  }
+
+  if(goal_found < 0)
+  {
+    if(min_goal_distance_to_waypoint < fallback_min_goal_distance_th && min_goal_distance_node >= 0)
+    {
+      cout << endl << "LaneGraphSearch::BuildPlanningSearchTree goal not found, using closest waypoint, distance: "
+           << min_goal_distance_to_waypoint << endl;
+      goal_found = min_goal_distance_node;
+    }
+    else
+    {
+      cout << endl << "LaneGraphSearch::BuildPlanningSearchTree Unable to "
+           << "find pGoalCell, minimum goal distance waypoint beyond threshold: "
+           << min_goal_distance_to_waypoint << endl;
+      return nullptr;
+    }
+  }
+
+  return ExtractRoute(graph, goal_found, all_cells_to_delete);
+}
+
+WayPoint* LaneGraphSearch::ExtractRoute(const LaneGraph& graph, const int& goal, vector<WayPoint*>& all_cells_to_delete)
+{
+  vector<int> route;
+  for(int n = goal; n >= 0; n = m_Parent[n])
+    route.push_back(n);
+  reverse(route.begin(), route.end());
+
+  WayPoint* pPrev = nullptr;
+  for(unsigned int i = 0; i < route.size(); i++)
+  {
+    const int n = route.at(i);
+    WayPoint* wp = new WayPoint();
+    *wp = *graph.m_Nodes.at(n);
+    wp->cost = m_Cost[n];
+
+    if(pPrev)
+    {
+      //link only to the previous route waypoint, TraversePathTreeBackwards follows pBacks, then pLeft/pRight
+      wp->pBacks.clear();
+      if(m_ParentEdge[n] == GRAPH_EDGE_FRONT)
+      {
+        wp->pBacks.push_back(pPrev);
+      }
+      else if(m_ParentEdge[n] == GRAPH_EDGE_LEFT)
+      {
+        wp->pRight = pPrev;
+        wp->pLeft = 0;
+      }
+      else
+      {
+        wp->pLeft = pPrev;
+        wp->pRight = 0;
+      }
+    }
+
+    all_cells_to_delete.push_back(wp);
+    pPrev = wp;
+  }
+
+  return pPrev;
+}
+
+} /* namespace PlannerHNS */
@@ -13,6 +13,8 @@
 
 #include "math.h"
 #include <fstream>
+#include <functional>
+#include <future>
 
 using namespace UtilityHNS;
 using namespace std;
@@ -572,20 +574,29 @@ void MappingHelpers::ConstructRoadNetworkFromDataFiles(const std::string vectoMa
   vector<AisanDataConnFileReader::DataConn> conn_data;
 
 
-  nodes.ReadAllData(nodes_data);
-  lanes.ReadAllData(lanes_data);
-  points.ReadAllData(points_data);
-  center_lanes.ReadAllData(dt_data);
-  lines.ReadAllData(line_data);
-  stop_line.ReadAllData(stop_line_data);
-  signal.ReadAllData(signal_data);
-  vec.ReadAllData(vector_data);
-  curb.ReadAllData(curb_data);
-  roadedge.ReadAllData(roadedge_data);
-  areas.ReadAllData(area_data);
-  way_area.ReadAllData(way_area_data);
-  cross_walk.ReadAllData(crosswalk_data);
-  conn.ReadAllData(conn_data);
+  //each file has its own reader, parse them in parallel
+  vector<std::function<void()> > read_tasks = {
+    [&](){ nodes.ReadAllData(nodes_data); },
+    [&](){ lanes.ReadAllData(lanes_data); },
+    [&](){ points.ReadAllData(points_data); },
+    [&](){ center_lanes.ReadAllData(dt_data); },
+    [&](){ lines.ReadAllData(line_data); },
+    [&](){ stop_line.ReadAllData(stop_line_data); },
+    [&](){ signal.ReadAllData(signal_data); },
+    [&](){ vec.ReadAllData(vector_data); },
+    [&](){ curb.ReadAllData(curb_data); },
+    [&](){ roadedge.ReadAllData(roadedge_data); },
+    [&](){ areas.ReadAllData(area_data); },
+    [&](){ way_area.ReadAllData(way_area_data); },
+    [&](){ cross_walk.ReadAllData(crosswalk_data); },
+    [&](){ conn.ReadAllData(conn_data); }
+  };
+
+  vector<std::future<void> > read_results;
+  for(unsigned int i = 0; i < read_tasks.size(); i++)
+    read_results.push_back(std::async(std::launch::async, read_tasks.at(i)));
+  for(unsigned int i = 0; i < read_results.size(); i++)
+    read_results.at(i).get();
 
   if(points_data.size() == 0)
   {
@@ -16,6 +16,18 @@ namespace PlannerHNS
 PlannerH::PlannerH()
 {
   //m_Params = params;
+  m_bEnableLaneGraphSearch = false;
+  m_nLaneGraphLandmarks = 0;
+}
+
+void PlannerH::SetLaneGraphSearch(const bool& bEnable, const int& nLandmarks)
+{
+  m_bEnableLaneGraphSearch = bEnable;
+  if(m_nLaneGraphLandmarks != nLandmarks)
+  {
+    m_nLaneGraphLandmarks = nLandmarks;
+    m_LaneGraph.Clear();
+  }
 }
 
 PlannerH::~PlannerH()
@@ -209,15 +221,30 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
   WayPoint* pLaneCell = 0;
   char bPlan = 'A';
 
-  if(all_cell_to_delete)
-    pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeV2(pStart,
+  vector<WayPoint*>& cells_to_delete = all_cell_to_delete ? *all_cell_to_delete : local_cell_to_delete;
+
+  if(m_bEnableLaneGraphSearch)
+  {
+    if(!m_LaneGraph.IsBuiltFor(map))
+    {
+      m_LaneGraph.BuildGraph(map);
+      m_LaneGraph.BuildLandmarks(m_nLaneGraphLandmarks);
+    }
+    else
+    {
+      m_LaneGraph.UpdateEdgeCosts();
+    }
+  }
+
+  if(m_bEnableLaneGraphSearch && m_LaneGraph.GetNodeId(pStart) >= 0)
+    pLaneCell =  m_LaneGraphSearch.BuildPlanningSearchTree(m_LaneGraph, pStart,
                                       *pGoal, globalPath, maxPlanningDistance,
-                                      bEnableLaneChange, *all_cell_to_delete,
+                                      bEnableLaneChange, cells_to_delete,
                                       fallback_min_goal_distance_th);
   else
     pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeV2(pStart,
                                       *pGoal, globalPath, maxPlanningDistance,
-                                      bEnableLaneChange, local_cell_to_delete,
+                                      bEnableLaneChange, cells_to_delete,
                                       fallback_min_goal_distance_th);
 
   if(!pLaneCell)
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/BehaviorPrediction.h"
+#include "op_planner/PlanningHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * Exposes the particle filter step, so it can run on hand made objects without a map.
+ */
+class TestBehaviorPrediction : public BehaviorPrediction
+{
+public:
+  using BehaviorPrediction::ParticleFilterSteps;
+};
+
+/**
+ * State of one particle after the filter steps.
+ */
+struct ParticleState
+{
+  double x, y, a, vel, w;
+  int beh;
+};
+
+class TestParticleFilter:
+  public ::testing::Test
+{
+public:
+  TestParticleFilter() {}
+
+  /**
+   * Objects driving along x, each one with a straight, a left and a right trajectory.
+   */
+  static void MakeObjects(std::vector<ObjParticles*>& objects, const int& nObjects)
+  {
+    for(int o = 0; o < nObjects; o++)
+    {
+      ObjParticles* pObj = new ObjParticles();
+      pObj->obj.id = o + 1;
+      pObj->obj.w = 2;
+      pObj->obj.l = 4;
+      pObj->obj.center.pos.y = o*5;
+      pObj->obj.center.v = 3;
+      for(int t = 0; t < 3; t++)
+      {
+        std::vector<WayPoint> path;
+        double slope = t == 0 ? 0 : (t == 1 ? 0.02 : -0.02);
+        for(int i = 0; i < 200; i++)
+        {
+          WayPoint wp;
+          wp.pos.x = i*0.5;
+          wp.pos.y = o*5 + slope*i;
+          wp.laneId = t;
+          wp.beh_state = BEH_FORWARD_STATE;
+          path.push_back(wp);
+        }
+        PlanningHelpers::CalcAngleAndCost(path);
+        pObj->m_TrajectoryTracker.push_back(new TrajectoryTracker(path, t));
+      }
+      objects.push_back(pObj);
+    }
+  }
+
+  /**
+   * Run nSteps filter steps with nThreads threads and collect the particles of all trackers.
+   */
+  static void RunFilter(const uint64_t& seed, const int& nThreads, std::vector<ParticleState>& states,
+      std::vector<int>& best_tracks)
+  {
+#ifdef _OPENMP
+    omp_set_num_threads(nThreads);
+#endif
+    TestBehaviorPrediction prediction;
+    prediction.m_bStepByStep = true;
+    prediction.m_RandomSeed = seed;
+
+    std::vector<ObjParticles*> objects;
+    MakeObjects(objects, 24);
+    for(int s = 0; s < 20; s++)
+    {
+      for(unsigned int o = 0; o < objects.size(); o++)
+        objects.at(o)->obj.center.pos.x += 0.25;
+      prediction.ParticleFilterSteps(objects);
+    }
+
+    states.clear();
+    best_tracks.clear();
+    for(unsigned int o = 0; o < objects.size(); o++)
+    {
+      best_tracks.push_back(objects.at(o)->i_best_track);
+      for(unsigned int t = 0; t < objects.at(o)->m_TrajectoryTracker.size(); t++)
+      {
+        TrajectoryTracker* pTrack = objects.at(o)->m_TrajectoryTracker.at(t);
+        AppendParticles(pTrack->m_ForwardPart, states);
+        AppendParticles(pTrack->m_StopPart, states);
+      }
+      delete objects.at(o);
+    }
+  }
+
+  static void AppendParticles(const std::vector<Particle>& particles, std::vector<ParticleState>& states)
+  {
+    for(unsigned int i = 0; i < particles.size(); i++)
+    {
+      const Particle& p = particles.at(i);
+      ParticleState state = {p.pose.pos.x, p.pose.pos.y, p.pose.pos.a, p.vel, p.w, p.beh};
+      states.push_back(state);
+    }
+  }
+};
+
+TEST_F(TestParticleFilter, TestSameResultForAnyThreadCount)
+{
+  std::vector<ParticleState> serial, parallel;
+  std::vector<int> serial_best, parallel_best;
+  RunFilter(7, 1, serial, serial_best);
+  RunFilter(7, 4, parallel, parallel_best);
+
+  ASSERT_GT(serial.size(), 0u);
+  ASSERT_EQ(serial.size(), parallel.size());
+  ASSERT_EQ(serial_best, parallel_best);
+  for(unsigned int i = 0; i < serial.size(); i++)
+  {
+    // the same samples in the same order, so the results are identical and not only close
+    ASSERT_EQ(serial.at(i).x, parallel.at(i).x) << i;
+    ASSERT_EQ(serial.at(i).y, parallel.at(i).y) << i;
+    ASSERT_EQ(serial.at(i).a, parallel.at(i).a) << i;
+    ASSERT_EQ(serial.at(i).vel, parallel.at(i).vel) << i;
+    ASSERT_EQ(serial.at(i).w, parallel.at(i).w) << i;
+    ASSERT_EQ(serial.at(i).beh, parallel.at(i).beh) << i;
+  }
+}
+
+TEST_F(TestParticleFilter, TestSeedChangesResult)
+{
+  std::vector<ParticleState> first, second;
+  std::vector<int> first_best, second_best;
+  RunFilter(7, 1, first, first_best);
+  RunFilter(8, 1, second, second_best);
+
+  bool bDifferent = first.size() != second.size();
+  for(unsigned int i = 0; i < first.size() && !bDifferent; i++)
+    bDifferent = first.at(i).x != second.at(i).x || first.at(i).y != second.at(i).y || first.at(i).w != second.at(i).w;
+  ASSERT_TRUE(bDifferent);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
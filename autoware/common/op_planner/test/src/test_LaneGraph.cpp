@@ -0,0 +1,292 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_planner/LaneGraph.h"
+#include "op_planner/PlanningHelpers.h"
+
+using namespace PlannerHNS;
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+class TestLaneGraph:
+  public ::testing::Test
+{
+public:
+  TestLaneGraph() {}
+
+  /**
+   * Chain of waypoints along x axis, connected with pFronts/pBacks.
+   */
+  static void MakeChain(std::vector<WayPoint>& chain, const std::vector<double>& xs, const double& y, const int& first_id)
+  {
+    chain.resize(xs.size());
+    for(unsigned int i = 0; i < xs.size(); i++)
+    {
+      chain.at(i).pos.x = xs.at(i);
+      chain.at(i).pos.y = y;
+      chain.at(i).id = first_id + i;
+      if(i > 0)
+      {
+        chain.at(i-1).pFronts.push_back(&chain.at(i));
+        chain.at(i).pBacks.push_back(&chain.at(i-1));
+      }
+    }
+  }
+
+  /**
+   * Grid road network of nRows parallel lanes, each lane is a chain with lane change links to its neighbours.
+   */
+  static void MakeGrid(std::vector<std::vector<WayPoint> >& grid, const int& nRows, const int& nCols)
+  {
+    grid.resize(nRows);
+    std::vector<double> xs;
+    for(int c = 0; c < nCols; c++)
+      xs.push_back(c*2.0);
+    for(int r = 0; r < nRows; r++)
+      MakeChain(grid.at(r), xs, r*3.5, r*nCols + 1);
+
+    for(int r = 0; r < nRows; r++)
+    {
+      for(int c = 0; c < nCols; c++)
+      {
+        if(r+1 < nRows) grid.at(r).at(c).pLeft = &grid.at(r+1).at(c);
+        if(r > 0) grid.at(r).at(c).pRight = &grid.at(r-1).at(c);
+        //some lane blocked cost so the shortest path is not trivial
+        if((c*7 + r*13) % 11 == 0)
+          grid.at(r).at(c).actionCost.push_back(std::make_pair(FORWARD_ACTION, 4.0));
+      }
+    }
+  }
+};
+
+TEST_F(TestLaneGraph, TestPathFound)
+{
+  std::vector<WayPoint> chain;
+  MakeChain(chain, {0, 10, 20, 34}, 0, 0);
+  WayPoint goal_position = chain.at(3);
+
+  LaneGraph graph;
+  graph.BuildGraph({&chain.at(0)});
+  ASSERT_EQ(graph.nNodes(), 4);
+
+  LaneGraphSearch search;
+  std::vector<WayPoint*> all_cell_to_delete;
+  WayPoint* result = search.BuildPlanningSearchTree(graph, &chain.at(0), goal_position, std::vector<int>(), 34, false,
+      all_cell_to_delete, 0);
+
+  ASSERT_TRUE(result != 0);
+  ASSERT_DOUBLE_EQ(result->pos.x, 34);
+  ASSERT_DOUBLE_EQ(result->cost, 34);
+  // only the route waypoints are allocated
+  ASSERT_EQ(all_cell_to_delete.size(), 4u);
+
+  std::vector<WayPoint> path;
+  std::vector<std::vector<WayPoint> > paths;
+  PlanningHelpers::TraversePathTreeBackwards(result, &chain.at(0), std::vector<int>(), path, paths);
+  ASSERT_EQ(path.size(), 3u);
+  ASSERT_DOUBLE_EQ(path.front().pos.x, 10);
+
+  for(unsigned int i = 0; i < all_cell_to_delete.size(); i++)
+    delete all_cell_to_delete.at(i);
+}
+
+TEST_F(TestLaneGraph, TestNoPathFound)
+{
+  std::vector<WayPoint> chain;
+  MakeChain(chain, {0, 10, 20, 30}, 0, 0);
+  WayPoint goal_position;
+  goal_position.pos.x = 34;
+
+  LaneGraph graph;
+  graph.BuildGraph({&chain.at(0)});
+
+  LaneGraphSearch search;
+  std::vector<WayPoint*> all_cell_to_delete;
+  WayPoint* result = search.BuildPlanningSearchTree(graph, &chain.at(0), goal_position, std::vector<int>(), 34, false,
+      all_cell_to_delete, 0);
+  ASSERT_TRUE(result == 0);
+  ASSERT_EQ(all_cell_to_delete.size(), 0u);
+
+  // close enough fallback
+  result = search.BuildPlanningSearchTree(graph, &chain.at(0), goal_position, std::vector<int>(), 34, false,
+      all_cell_to_delete, 5);
+  ASSERT_TRUE(result != 0);
+  ASSERT_DOUBLE_EQ(result->pos.x, 30);
+
+  for(unsigned int i = 0; i < all_cell_to_delete.size(); i++)
+    delete all_cell_to_delete.at(i);
+}
+
+TEST_F(TestLaneGraph, TestUnreachableGoalStopsAtDistanceLimit)
+{
+  std::vector<std::vector<WayPoint> > grid;
+  MakeGrid(grid, 5, 200);
+  WayPoint goal_position;
+  goal_position.pos.x = 1000;
+  goal_position.pos.y = 1000;
+
+  LaneGraph graph;
+  graph.BuildGraph({&grid.at(0).at(0)});
+  ASSERT_EQ(graph.nNodes(), 1000);
+
+  LaneGraphSearch search;
+  std::vector<WayPoint*> cells_graph, cells_tree;
+  // the limit is on the length of the explored waypoints, not on the route cost, same as the tree search
+  WayPoint* r_graph = search.BuildPlanningSearchTree(graph, &grid.at(0).at(0), goal_position, std::vector<int>(), 50,
+      true, cells_graph, 0);
+  WayPoint* r_tree = PlanningHelpers::BuildPlanningSearchTreeV2(&grid.at(0).at(0), goal_position, std::vector<int>(),
+      50, true, cells_tree, 0);
+
+  ASSERT_TRUE(r_graph != 0);
+  ASSERT_TRUE(r_tree != 0);
+  // each new waypoint adds at least 2 m, the search stops once more than 50 m were generated
+  ASSERT_LE(search.m_nExpandedNodes, 27);
+  ASSERT_LE(r_graph->pos.x, 50);
+  ASSERT_LE(r_tree->pos.x, 50);
+
+  for(unsigned int i = 0; i < cells_graph.size(); i++)
+    delete cells_graph.at(i);
+  for(unsigned int i = 0; i < cells_tree.size(); i++)
+    delete cells_tree.at(i);
+}
+
+TEST_F(TestLaneGraph, TestLaneChange)
+{
+  std::vector<std::vector<WayPoint> > grid;
+  MakeGrid(grid, 2, 20);
+  WayPoint goal_position = grid.at(1).at(19);
+
+  LaneGraph graph;
+  graph.BuildGraph({&grid.at(0).at(0)});
+  ASSERT_EQ(graph.nNodes(), 40);
+
+  LaneGraphSearch search;
+  std::vector<WayPoint*> all_cell_to_delete;
+
+  WayPoint* result = search.BuildPlanningSearchTree(graph, &grid.at(0).at(0), goal_position, std::vector<int>(), 1000,
+      false, all_cell_to_delete, 0);
+  ASSERT_TRUE(result == 0);
+
+  result = search.BuildPlanningSearchTree(graph, &grid.at(0).at(0), goal_position, std::vector<int>(), 1000,
+      true, all_cell_to_delete, 0);
+  ASSERT_TRUE(result != 0);
+  ASSERT_EQ(result->id, goal_position.id);
+
+  std::vector<WayPoint> path;
+  std::vector<std::vector<WayPoint> > paths;
+  PlanningHelpers::TraversePathTreeBackwards(result, &grid.at(0).at(0), std::vector<int>(), path, paths);
+  ASSERT_GT(path.size(), 0u);
+  ASSERT_DOUBLE_EQ(path.back().pos.y, 3.5);
+  // lane change is not allowed before LANE_CHANGE_MIN_DISTANCE
+  for(unsigned int i = 0; i < path.size(); i++)
+  {
+    if(path.at(i).pos.y > 0)
+    {
+      ASSERT_GT(path.at(i).pos.x, LANE_CHANGE_MIN_DISTANCE);
+      break;
+    }
+  }
+
+  for(unsigned int i = 0; i < all_cell_to_delete.size(); i++)
+    delete all_cell_to_delete.at(i);
+}
+
+TEST_F(TestLaneGraph, TestHeuristicsMatchDijkstra)
+{
+  std::vector<std::vector<WayPoint> > grid;
+  MakeGrid(grid, 6, 300);
+  std::vector<WayPoint*> seeds;
+  for(unsigned int r = 0; r < grid.size(); r++)
+    for(unsigned int c = 0; c < grid.at(r).size(); c++)
+      seeds.push_back(&grid.at(r).at(c));
+
+  LaneGraph graph;
+  graph.BuildGraph(seeds);
+  graph.BuildLandmarks(4);
+  ASSERT_EQ(graph.m_LandmarkFrom.size(), 4u);
+
+  LaneGraphSearch search;
+  for(int g = 0; g < 6; g++)
+  {
+    WayPoint* pStart = &grid.at(g % 2).at(g*3);
+    const WayPoint& goal_position = grid.at(5 - g).at(299 - g*7);
+
+    std::vector<WayPoint*> cells_dijkstra, cells_astar;
+    WayPoint* r_dijkstra = search.BuildPlanningSearchTree(graph, pStart, goal_position, std::vector<int>(), 10000, true,
+        cells_dijkstra, 0, false);
+    int n_dijkstra = search.m_nExpandedNodes;
+    WayPoint* r_astar = search.BuildPlanningSearchTree(graph, pStart, goal_position, std::vector<int>(), 10000, true,
+        cells_astar, 0, true);
+    int n_astar = search.m_nExpandedNodes;
+
+    ASSERT_TRUE(r_dijkstra != 0);
+    ASSERT_TRUE(r_astar != 0);
+    ASSERT_NEAR(r_dijkstra->cost, r_astar->cost, 1e-6);
+    ASSERT_LE(n_astar, n_dijkstra);
+
+    for(unsigned int i = 0; i < cells_dijkstra.size(); i++)
+      delete cells_dijkstra.at(i);
+    for(unsigned int i = 0; i < cells_astar.size(); i++)
+      delete cells_astar.at(i);
+  }
+}
+
+TEST_F(TestLaneGraph, TestSpeedComparedToTreeSearch)
+{
+  std::vector<std::vector<WayPoint> > grid;
+  MakeGrid(grid, 2, 400);
+  WayPoint* pStart = &grid.at(0).at(0);
+  const WayPoint& goal_position = grid.at(0).at(399);
+
+  LaneGraph graph;
+  graph.BuildGraph({pStart});
+  graph.BuildLandmarks(2);
+  LaneGraphSearch search;
+
+  std::vector<WayPoint*> cells_graph, cells_tree;
+  auto t0 = std::chrono::steady_clock::now();
+  WayPoint* r_graph = search.BuildPlanningSearchTree(graph, pStart, goal_position, std::vector<int>(), 10000, true,
+      cells_graph, 0);
+  auto t1 = std::chrono::steady_clock::now();
+  WayPoint* r_tree = PlanningHelpers::BuildPlanningSearchTreeV2(pStart, goal_position, std::vector<int>(), 10000,
+      true, cells_tree, 0);
+  auto t2 = std::chrono::steady_clock::now();
+
+  std::cout << "LaneGraphSearch: " << std::chrono::duration<double, std::milli>(t1-t0).count() << " ms, "
+      << cells_graph.size() << " allocated, BuildPlanningSearchTreeV2: "
+      << std::chrono::duration<double, std::milli>(t2-t1).count() << " ms, " << cells_tree.size() << " allocated" << std::endl;
+
+  ASSERT_TRUE(r_graph != 0);
+  ASSERT_TRUE(r_tree != 0);
+  ASSERT_NEAR(r_graph->cost, r_tree->cost, 1e-6);
+  ASSERT_LE(cells_graph.size(), cells_tree.size());
+
+  for(unsigned int i = 0; i < cells_graph.size(); i++)
+    delete cells_graph.at(i);
+  for(unsigned int i = 0; i < cells_tree.size(); i++)
+    delete cells_tree.at(i);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
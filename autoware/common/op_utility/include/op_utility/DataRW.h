@@ -14,6 +14,9 @@
 #include <vector>
 #include <iostream>
 #include <limits>
+#include <cstring>
+#include <typeinfo>
+#include <type_traits>
 
 #include "vector_map_msgs/PointArray.h"
 #include "vector_map_msgs/LaneArray.h"
@@ -30,6 +33,7 @@
 #include "vector_map_msgs/CurbArray.h"
 #include "vector_map_msgs/RoadEdgeArray.h"
 #include "vector_map_msgs/CrossWalkArray.h"
+#include "vector_map/csv_reader.h"
 
 #include "UtilityH.h"
 
@@ -61,7 +65,9 @@ public:
 class SimpleReaderBase
 {
 private:
-  std::ifstream* m_pFile;
+  vector_map::MappedFile m_File; // whole file mapped in memory, rows are tokenized in place
+  vector_map::CsvReader m_Reader;
+  std::string m_FileName;
   std::vector<std::string> m_RawHeaders;
   std::vector<std::string> m_DataTitlesHeader;
   std::vector<std::vector<std::vector<std::string> > > m_AllData;
@@ -74,8 +80,15 @@ private:
 
   void ReadHeaders();
   void ParseDataTitles(const std::string& header);
+  static std::string GetCacheKey(const char* typeName, const size_t& typeSize);
 
 public:
+  /**
+   * Rows read with ReadAllRows are stored in a binary cache next to the file (".<file name>.op_cache")
+   * and reloaded while the file keeps the same size and modification time.
+   */
+  static bool bUseCache;
+
   /**
    *
    * @param fileName log file name
@@ -93,6 +106,40 @@ protected:
   int ReadAllData();
   bool ReadSingleLine(std::vector<std::vector<std::string> >& line);
 
+  /**
+   * Allocation free version of ReadSingleLine for one object per row, columns point into the mapped file.
+   */
+  bool ReadSingleRow(vector_map::CsvRow& row);
+
+  /**
+   * All rows of the file, parsed with reader.ReadNextLine or loaded from the binary cache.
+   */
+  template <class T, class R>
+  void ReadAllRows(R& reader, std::vector<T>& rows)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "rows are cached as raw bytes");
+    rows.clear();
+    const std::string key = GetCacheKey(typeid(T).name(), sizeof(T));
+    std::vector<uint8_t> payload;
+    if(bUseCache && vector_map::readCsvCache(m_FileName, key, payload, "op_cache") && payload.size() % sizeof(T) == 0)
+    {
+      rows.resize(payload.size() / sizeof(T));
+      if(payload.size() > 0)
+        std::memcpy(rows.data(), payload.data(), payload.size());
+      return;
+    }
+
+    T data;
+    while(reader.ReadNextLine(data))
+      rows.push_back(data);
+
+    if(bUseCache && rows.size() > 0)
+    {
+      payload.resize(rows.size() * sizeof(T));
+      std::memcpy(payload.data(), rows.data(), payload.size());
+      vector_map::writeCsvCache(m_FileName, key, payload, "op_cache");
+    }
+  }
 };
 
 class GPSDataReader : public SimpleReaderBase
@@ -6,6 +6,7 @@
 
 #include "op_utility/DataRW.h"
 #include <stdlib.h>
+#include <stdio.h>
 #include <tinyxml.h>
 #include <sys/stat.h>
 #include "op_utility/UtilityH.h"
@@ -215,70 +216,72 @@ SimpleReaderBase::SimpleReaderBase(const string& fileName, const int& nHeaders,c
       const int& iDataTitles, const int& nVariablesForOneObject ,
       const int& nLineHeaders, const string& headerRepeatKey)
 {
-  if(fileName.compare("d") != 0)
-  {
-    m_pFile = new ifstream(fileName.c_str(), ios::in);
-    if(!m_pFile->is_open())
-    {
-      printf("\n Can't Open Map File !, %s", fileName.c_str());
-      return;
-    }
-
   m_nHeders = nHeaders;
   m_iDataTitles = iDataTitles;
   m_nVarPerObj = nVariablesForOneObject;
   m_HeaderRepeatKey = headerRepeatKey;
   m_nLineHeaders = nLineHeaders;
   m_Separator = separator;
-  m_pFile->precision(16);
+  m_FileName = fileName;
+
+  if(fileName.compare("d") != 0)
+  {
+    if(!m_File.open(fileName))
+    {
+      printf("\n Can't Open Map File !, %s", fileName.c_str());
+      return;
+    }
 
-  ReadHeaders();
+    m_Reader = vector_map::CsvReader(m_File.data(), m_File.size());
+    ReadHeaders();
   }
 }
 
 SimpleReaderBase::~SimpleReaderBase()
 {
-  if(m_pFile->is_open())
-    m_pFile->close();
 }
 
-bool SimpleReaderBase::ReadSingleLine(vector<vector<string> >& line)
+bool SimpleReaderBase::ReadSingleRow(vector_map::CsvRow& row)
 {
-  if(!m_pFile->is_open() || m_pFile->eof()) return false;
+  return m_Reader.nextRow(row, m_Separator);
+}
 
-  string strLine, innerToken;
+bool SimpleReaderBase::ReadSingleLine(vector<vector<string> >& line)
+{
+  const char* pBegin = 0;
+  const char* pEnd = 0;
   line.clear();
-  getline(*m_pFile, strLine);
-  istringstream str_stream(strLine);
+  if(!m_Reader.nextLine(pBegin, pEnd)) return false;
+
+  vector_map::CsvRow row;
+  row.split(pBegin, pEnd, m_Separator);
 
   vector<string> header;
   vector<string> obj_part;
 
   if(m_nVarPerObj == 0)
   {
-    while(getline(str_stream, innerToken, m_Separator))
-    {
-      obj_part.push_back(innerToken);
-    }
+    for(unsigned int i = 0; i < row.size(); i++)
+      obj_part.push_back(row.getString(i));
 
     line.push_back(obj_part);
     return true;
   }
   else
   {
-    int iCounter = 0;
-    while(iCounter < m_nLineHeaders && getline(str_stream, innerToken, m_Separator))
+    unsigned int iColumn = 0;
+    while((int)iColumn < m_nLineHeaders && iColumn < row.size())
     {
-      header.push_back(innerToken);
-      iCounter++;
+      header.push_back(row.getString(iColumn));
+      iColumn++;
     }
     obj_part.insert(obj_part.begin(), header.begin(), header.end());
 
-    iCounter = 1;
+    int iCounter = 1;
 
-    while(getline(str_stream, innerToken, m_Separator))
+    for(; iColumn < row.size(); iColumn++)
     {
-      obj_part.push_back(innerToken);
+      obj_part.push_back(row.getString(iColumn));
       if(iCounter == m_nVarPerObj)
       {
         line.push_back(obj_part);
@@ -295,15 +298,29 @@ bool SimpleReaderBase::ReadSingleLine(vector<vector<string> >& line)
   return true;
 }
 
+bool SimpleReaderBase::bUseCache = true;
+
+std::string SimpleReaderBase::GetCacheKey(const char* typeName, const size_t& typeSize)
+{
+  //the row layout is part of the key, a changed struct invalidates the cache
+  uint64_t hash = 14695981039346656037ULL;
+  for(const char* c = typeName; *c != 0; c++)
+    hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ULL;
+  hash = (hash ^ typeSize) * 1099511628211ULL;
+
+  char key[32];
+  snprintf(key, sizeof(key), "op_utility_%016llx", static_cast<unsigned long long>(hash));
+  return key;
+}
+
 int SimpleReaderBase::ReadAllData()
 {
-  if(!m_pFile->is_open()) return 0;
+  if(!m_File.isOpen()) return 0;
 
   m_AllData.clear();
   vector<vector<string> > singleLine;
-  while(!m_pFile->eof())
+  while(ReadSingleLine(singleLine))
   {
-    ReadSingleLine(singleLine);
     m_AllData.push_back(singleLine);
   }
 
@@ -312,14 +329,15 @@ int SimpleReaderBase::ReadAllData()
 
 void SimpleReaderBase::ReadHeaders()
 {
-  if(!m_pFile->is_open()) return;
+  if(!m_File.isOpen()) return;
 
-  string strLine;
+  const char* pBegin = 0;
+  const char* pEnd = 0;
   int iCounter = 0;
   m_RawHeaders.clear();
-  while(!m_pFile->eof() && iCounter < m_nHeders)
+  while(iCounter < m_nHeders && m_Reader.nextLine(pBegin, pEnd))
   {
-    getline(*m_pFile, strLine);
+    string strLine(pBegin, pEnd);
     m_RawHeaders.push_back(strLine);
     if(iCounter == m_iDataTitles)
       ParseDataTitles(strLine);
@@ -343,16 +361,15 @@ void SimpleReaderBase::ParseDataTitles(const string& header)
 
 bool GPSDataReader::ReadNextLine(GPSBasicData& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 5) return false;
+    if(row.size() < 5) return false;
 
-    data.lat = strtod(lineData.at(0).at(2).c_str(), NULL);
-    data.lon = strtod(lineData.at(0).at(3).c_str(), NULL);
-    data.alt = strtod(lineData.at(0).at(4).c_str(), NULL);
-    data.distance = strtod(lineData.at(0).at(5).c_str(), NULL);
+    data.lat = row.getDouble(2);
+    data.lon = row.getDouble(3);
+    data.alt = row.getDouble(4);
+    data.distance = row.getDouble(5);
 
     return true;
 
@@ -376,19 +393,18 @@ int GPSDataReader::ReadAllData(vector<GPSBasicData>& data_list)
 
 bool SimulationFileReader::ReadNextLine(SimulationPoint& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 6) return false;
+    if(row.size() < 6) return false;
 
-    data.x = strtod(lineData.at(0).at(0).c_str(), NULL);
-    data.y = strtod(lineData.at(0).at(1).c_str(), NULL);
-    data.z = strtod(lineData.at(0).at(2).c_str(), NULL);
-    data.a = strtod(lineData.at(0).at(3).c_str(), NULL);
-    data.c = strtod(lineData.at(0).at(4).c_str(), NULL);
-    data.v = strtod(lineData.at(0).at(5).c_str(), NULL);
-    data.name = lineData.at(0).at(6);
+    data.x = row.getDouble(0);
+    data.y = row.getDouble(1);
+    data.z = row.getDouble(2);
+    data.a = row.getDouble(3);
+    data.c = row.getDouble(4);
+    data.v = row.getDouble(5);
+    data.name = row.getString(6);
 
     return true;
 
@@ -420,18 +436,17 @@ int SimulationFileReader::ReadAllData(SimulationData& data_list)
 
 bool LocalizationPathReader::ReadNextLine(LocalizationWayPoint& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 5) return false;
+    if(row.size() < 5) return false;
 
-    //data.t = strtod(lineData.at(0).at(0).c_str(), NULL);
-    data.x = strtod(lineData.at(0).at(0).c_str(), NULL);
-    data.y = strtod(lineData.at(0).at(1).c_str(), NULL);
-    data.z = strtod(lineData.at(0).at(2).c_str(), NULL);
-    data.a = strtod(lineData.at(0).at(3).c_str(), NULL);
-    data.v = strtod(lineData.at(0).at(4).c_str(), NULL);
+    //data.t = row.getDouble(0);
+    data.x = row.getDouble(0);
+    data.y = row.getDouble(1);
+    data.z = row.getDouble(2);
+    data.a = row.getDouble(3);
+    data.v = row.getDouble(4);
 
     return true;
 
@@ -518,14 +533,13 @@ AisanNodesFileReader::AisanNode* AisanNodesFileReader::GetDataRowById(int _nid)
 
 bool AisanNodesFileReader::ReadNextLine(AisanNode& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 2) return false;
+    if(row.size() < 2) return false;
 
-    data.NID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.PID = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
+    data.NID = row.getInt(0);
+    data.PID = row.getInt(1);
 
     return true;
 
@@ -540,8 +554,11 @@ int AisanNodesFileReader::ReadAllData(vector<AisanNode>& data_list)
   AisanNode data;
   //double logTime = 0;
   int max_id = std::numeric_limits<int>::min();
-  while(ReadNextLine(data))
+  vector<AisanNode> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     m_data_list.push_back(data);
     if(data.NID < m_min_id)
       m_min_id = data.NID;
@@ -630,23 +647,22 @@ AisanPointsFileReader::AisanPoints* AisanPointsFileReader::GetDataRowById(int _p
 
 bool AisanPointsFileReader::ReadNextLine(AisanPoints& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 10) return false;
+    if(row.size() < 10) return false;
 
-    data.PID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.B = strtod(lineData.at(0)[1].c_str(), NULL);
-    data.L = strtod(lineData.at(0)[2].c_str(), NULL);
-    data.H = strtod(lineData.at(0)[3].c_str(), NULL);
+    data.PID = row.getInt(0);
+    data.B = row.getDouble(1);
+    data.L = row.getDouble(2);
+    data.H = row.getDouble(3);
 
-    data.Bx = strtod(lineData.at(0)[4].c_str(), NULL);
-    data.Ly = strtod(lineData.at(0)[5].c_str(), NULL);
-    data.Ref = strtol(lineData.at(0).at(6).c_str(), NULL, 10);
-    data.MCODE1 = strtol(lineData.at(0).at(7).c_str(), NULL, 10);
-    data.MCODE2 = strtol(lineData.at(0).at(8).c_str(), NULL, 10);
-    data.MCODE3 = strtol(lineData.at(0).at(9).c_str(), NULL, 10);
+    data.Bx = row.getDouble(4);
+    data.Ly = row.getDouble(5);
+    data.Ref = row.getInt(6);
+    data.MCODE1 = row.getInt(7);
+    data.MCODE2 = row.getInt(8);
+    data.MCODE3 = row.getInt(9);
 
     return true;
 
@@ -661,8 +677,11 @@ int AisanPointsFileReader::ReadAllData(vector<AisanPoints>& data_list)
   AisanPoints data;
   //double logTime = 0;
   int max_id = std::numeric_limits<int>::min();
-  while(ReadNextLine(data))
+  vector<AisanPoints> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     m_data_list.push_back(data);
     if(data.PID < m_min_id)
       m_min_id = data.PID;
@@ -746,17 +765,16 @@ AisanLinesFileReader::AisanLine* AisanLinesFileReader::GetDataRowById(int _lid)
 
 bool AisanLinesFileReader::ReadNextLine(AisanLine& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 5) return false;
+    if(row.size() < 5) return false;
 
-    data.LID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.BPID = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.FPID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.BLID = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-    data.FLID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+    data.LID = row.getInt(0);
+    data.BPID = row.getInt(1);
+    data.FPID = row.getInt(2);
+    data.BLID = row.getInt(3);
+    data.FLID = row.getInt(4);
 
     return true;
   }
@@ -771,8 +789,11 @@ int AisanLinesFileReader::ReadAllData(vector<AisanLine>& data_list)
   //double logTime = 0;
 
   int max_id = std::numeric_limits<int>::min();
-  while(ReadNextLine(data))
+  vector<AisanLine> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     m_data_list.push_back(data);
     if(data.LID < m_min_id)
       m_min_id = data.LID;
@@ -861,23 +882,22 @@ AisanCenterLinesFileReader::AisanCenterLine* AisanCenterLinesFileReader::GetData
 
 bool AisanCenterLinesFileReader::ReadNextLine(AisanCenterLine& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 10) return false;
+    if(row.size() < 10) return false;
 
-    data.DID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.Dist   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.PID   = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+    data.DID   = row.getInt(0);
+    data.Dist   = row.getInt(1);
+    data.PID   = row.getInt(2);
 
-    data.Dir   = strtod(lineData.at(0)[3].c_str(), NULL);
-    data.Apara   = strtod(lineData.at(0)[4].c_str(), NULL);
-    data.r     = strtod(lineData.at(0)[5].c_str(), NULL);
-    data.slope   = strtod(lineData.at(0)[6].c_str(), NULL);
-    data.cant   = strtod(lineData.at(0)[7].c_str(), NULL);
-    data.LW   = strtod(lineData.at(0)[8].c_str(), NULL);
-    data.RW   = strtod(lineData.at(0)[9].c_str(), NULL);
+    data.Dir   = row.getDouble(3);
+    data.Apara   = row.getDouble(4);
+    data.r     = row.getDouble(5);
+    data.slope   = row.getDouble(6);
+    data.cant   = row.getDouble(7);
+    data.LW   = row.getDouble(8);
+    data.RW   = row.getDouble(9);
 
     return true;
   }
@@ -891,8 +911,11 @@ int AisanCenterLinesFileReader::ReadAllData(vector<AisanCenterLine>& data_list)
   AisanCenterLine data;
   //double logTime = 0;
   int count = 0;
-  while(ReadNextLine(data))
+  vector<AisanCenterLine> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     data_list.push_back(data);
     count++;
   }
@@ -988,54 +1011,53 @@ AisanLanesFileReader::AisanLane* AisanLanesFileReader::GetDataRowById(int _lnid)
 
 bool AisanLanesFileReader::ReadNextLine(AisanLane& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
-  {
-    if(lineData.size() == 0) return false;
-    if(lineData.at(0).size() < 17) return false;
-
-    data.LnID    = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.DID    = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.BLID    = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.FLID    = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-    data.BNID     = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
-    data.FNID    = strtol(lineData.at(0).at(5).c_str(), NULL, 10);
-    data.JCT    = strtol(lineData.at(0).at(6).c_str(), NULL, 10);
-    data.BLID2     = strtol(lineData.at(0).at(7).c_str(), NULL, 10);
-    data.BLID3    = strtol(lineData.at(0).at(8).c_str(), NULL, 10);
-    data.BLID4    = strtol(lineData.at(0).at(9).c_str(), NULL, 10);
-    data.FLID2     = strtol(lineData.at(0).at(10).c_str(), NULL, 10);
-    data.FLID3    = strtol(lineData.at(0).at(11).c_str(), NULL, 10);
-    data.FLID4    = strtol(lineData.at(0).at(12).c_str(), NULL, 10);
-    data.ClossID   = strtol(lineData.at(0).at(13).c_str(), NULL, 10);
-    data.Span     = strtod(lineData.at(0).at(14).c_str(), NULL);
-    data.LCnt     = strtol(lineData.at(0).at(15).c_str(), NULL, 10);
-    data.Lno      = strtol(lineData.at(0).at(16).c_str(), NULL, 10);
-
-
-    if(lineData.at(0).size() < 23) return true;
-
-    data.LaneType  = strtol(lineData.at(0).at(17).c_str(), NULL, 10);
-    data.LimitVel  = strtol(lineData.at(0).at(18).c_str(), NULL, 10);
-    data.RefVel     = strtol(lineData.at(0).at(19).c_str(), NULL, 10);
-    data.RoadSecID  = strtol(lineData.at(0).at(20).c_str(), NULL, 10);
-    data.LaneChgFG   = strtol(lineData.at(0).at(21).c_str(), NULL, 10);
-    data.LinkWAID  = strtol(lineData.at(0).at(22).c_str(), NULL, 10);
-
-
-    if(lineData.at(0).size() > 23)
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
+  {
+    if(row.size() < 17) return false;
+
+    data.LnID    = row.getInt(0);
+    data.DID    = row.getInt(1);
+    data.BLID    = row.getInt(2);
+    data.FLID    = row.getInt(3);
+    data.BNID     = row.getInt(4);
+    data.FNID    = row.getInt(5);
+    data.JCT    = row.getInt(6);
+    data.BLID2     = row.getInt(7);
+    data.BLID3    = row.getInt(8);
+    data.BLID4    = row.getInt(9);
+    data.FLID2     = row.getInt(10);
+    data.FLID3    = row.getInt(11);
+    data.FLID4    = row.getInt(12);
+    data.ClossID   = row.getInt(13);
+    data.Span     = row.getDouble(14);
+    data.LCnt     = row.getInt(15);
+    data.Lno      = row.getInt(16);
+
+
+    if(row.size() < 23) return true;
+
+    data.LaneType  = row.getInt(17);
+    data.LimitVel  = row.getInt(18);
+    data.RefVel     = row.getInt(19);
+    data.RoadSecID  = row.getInt(20);
+    data.LaneChgFG   = row.getInt(21);
+    data.LinkWAID  = row.getInt(22);
+
+
+    if(row.size() > 23)
     {
-      string str_dir = lineData.at(0).at(23);
-      if(str_dir.size() > 0)
-        data.LaneDir   = str_dir.at(0);
+      char dir = row.getChar(23);
+      if(dir != '\0')
+        data.LaneDir   = dir;
       else
         data.LaneDir    = 'F';
     }
 
 //    data.LeftLaneId  = 0;
 //    data.RightLaneId = 0;
-//    data.LeftLaneId   = strtol(lineData.at(0).at(24).c_str(), NULL, 10);
-//    data.RightLaneId   = strtol(lineData.at(0).at(25).c_str(), NULL, 10);
+//    data.LeftLaneId   = row.getInt(24);
+//    data.RightLaneId   = row.getInt(25);
 
 
     return true;
@@ -1051,8 +1073,11 @@ int AisanLanesFileReader::ReadAllData(vector<AisanLane>& data_list)
   //double logTime = 0;
   int max_id = std::numeric_limits<int>::min();
 
-  while(ReadNextLine(data))
+  vector<AisanLane> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     m_data_list.push_back(data);
     if(data.LnID < m_min_id)
       m_min_id = data.LnID;
@@ -1135,15 +1160,14 @@ AisanAreasFileReader::AisanArea* AisanAreasFileReader::GetDataRowById(int _aid)
 
 bool AisanAreasFileReader::ReadNextLine(AisanArea& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 3) return false;
+    if(row.size() < 3) return false;
 
-    data.AID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.SLID = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.ELID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+    data.AID = row.getInt(0);
+    data.SLID = row.getInt(1);
+    data.ELID = row.getInt(2);
 
     return true;
 
@@ -1158,8 +1182,11 @@ int AisanAreasFileReader::ReadAllData(vector<AisanArea>& data_list)
   AisanArea data;
   //double logTime = 0;
   int count = 0;
-  while(ReadNextLine(data))
+  vector<AisanArea> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     data_list.push_back(data);
     count++;
   }
@@ -1229,15 +1256,14 @@ AisanIntersectionFileReader::AisanIntersection* AisanIntersectionFileReader::Get
 
 bool AisanIntersectionFileReader::ReadNextLine(AisanIntersection& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 3) return false;
+    if(row.size() < 3) return false;
 
-    data.ID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.AID = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+    data.ID = row.getInt(0);
+    data.AID = row.getInt(1);
+    data.LinkID = row.getInt(2);
 
     return true;
 
@@ -1252,8 +1278,11 @@ int AisanIntersectionFileReader::ReadAllData(vector<AisanIntersection>& data_lis
   AisanIntersection data;
   //double logTime = 0;
   int count = 0;
-  while(ReadNextLine(data))
+  vector<AisanIntersection> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     data_list.push_back(data);
     count++;
   }
@@ -1325,17 +1354,16 @@ AisanStopLineFileReader::AisanStopLine* AisanStopLineFileReader::GetDataRowById(
 
 bool AisanStopLineFileReader::ReadNextLine(AisanStopLine& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 5) return false;
+    if(row.size() < 5) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.LID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.TLID   = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.SignID = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+    data.ID   = row.getInt(0);
+    data.LID   = row.getInt(1);
+    data.TLID   = row.getInt(2);
+    data.SignID = row.getInt(3);
+    data.LinkID = row.getInt(4);
 
     return true;
 
@@ -1350,8 +1378,11 @@ int AisanStopLineFileReader::ReadAllData(vector<AisanStopLine>& data_list)
   AisanStopLine data;
   //double logTime = 0;
   int count = 0;
-  while(ReadNextLine(data))
+  vector<AisanStopLine> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     data_list.push_back(data);
     count++;
   }
@@ -1423,17 +1454,16 @@ AisanRoadSignFileReader::AisanRoadSign* AisanRoadSignFileReader::GetDataRowById(
 
 bool AisanRoadSignFileReader::ReadNextLine(AisanRoadSign& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 5) return false;
+    if(row.size() < 5) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.VID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.PLID   = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.Type   = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+    data.ID   = row.getInt(0);
+    data.VID   = row.getInt(1);
+    data.PLID   = row.getInt(2);
+    data.Type   = row.getInt(3);
+    data.LinkID = row.getInt(4);
 
     return true;
 
@@ -1448,8 +1478,11 @@ int AisanRoadSignFileReader::ReadAllData(vector<AisanRoadSign>& data_list)
   AisanRoadSign data;
   //double logTime = 0;
   int count = 0;
-  while(ReadNextLine(data))
+  vector<AisanRoadSign> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     data_list.push_back(data);
     count++;
   }
@@ -1521,17 +1554,16 @@ AisanSignalFileReader::AisanSignal* AisanSignalFileReader::GetDataRowById(int _i
 
 bool AisanSignalFileReader::ReadNextLine(AisanSignal& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 5) return false;
+    if(row.size() < 5) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.VID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.PLID   = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.Type   = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+    data.ID   = row.getInt(0);
+    data.VID   = row.getInt(1);
+    data.PLID   = row.getInt(2);
+    data.Type   = row.getInt(3);
+    data.LinkID = row.getInt(4);
 
     return true;
 
@@ -1546,8 +1578,11 @@ int AisanSignalFileReader::ReadAllData(vector<AisanSignal>& data_list)
   AisanSignal data;
   //double logTime = 0;
   int count = 0;
-  while(ReadNextLine(data))
+  vector<AisanSignal> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     data_list.push_back(data);
     count++;
   }
@@ -1619,16 +1654,15 @@ AisanVectorFileReader::AisanVector* AisanVectorFileReader::GetDataRowById(int _i
 
 bool AisanVectorFileReader::ReadNextLine(AisanVector& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 4) return false;
+    if(row.size() < 4) return false;
 
-    data.VID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.PID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.Hang   = strtod(lineData.at(0).at(2).c_str(), NULL);
-    data.Vang   = strtod(lineData.at(0).at(3).c_str(), NULL);
+    data.VID   = row.getInt(0);
+    data.PID   = row.getInt(1);
+    data.Hang   = row.getDouble(2);
+    data.Vang   = row.getDouble(3);
 
     return true;
 
@@ -1643,8 +1677,11 @@ int AisanVectorFileReader::ReadAllData(vector<AisanVector>& data_list)
   AisanVector data;
   //double logTime = 0;
   int count = 0;
-  while(ReadNextLine(data))
+  vector<AisanVector> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     data_list.push_back(data);
     count++;
   }
@@ -1717,18 +1754,17 @@ AisanCurbFileReader::AisanCurb* AisanCurbFileReader::GetDataRowById(int _id)
 
 bool AisanCurbFileReader::ReadNextLine(AisanCurb& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 6) return false;
+    if(row.size() < 6) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.LID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.Height = strtod(lineData.at(0).at(2).c_str(), NULL);
-    data.Width   = strtod(lineData.at(0).at(3).c_str(), NULL);
-    data.dir   = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(5).c_str(), NULL, 10);
+    data.ID   = row.getInt(0);
+    data.LID   = row.getInt(1);
+    data.Height = row.getDouble(2);
+    data.Width   = row.getDouble(3);
+    data.dir   = row.getInt(4);
+    data.LinkID = row.getInt(5);
 
     return true;
 
@@ -1743,8 +1779,11 @@ int AisanCurbFileReader::ReadAllData(vector<AisanCurb>& data_list)
   AisanCurb data;
   //double logTime = 0;
   int count = 0;
-  while(ReadNextLine(data))
+  vector<AisanCurb> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     data_list.push_back(data);
     count++;
   }
@@ -1814,15 +1853,14 @@ AisanRoadEdgeFileReader::AisanRoadEdge* AisanRoadEdgeFileReader::GetDataRowById(
 
 bool AisanRoadEdgeFileReader::ReadNextLine(AisanRoadEdge& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 3) return false;
+    if(row.size() < 3) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.LID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+    data.ID   = row.getInt(0);
+    data.LID   = row.getInt(1);
+    data.LinkID = row.getInt(2);
 
     return true;
 
@@ -1837,8 +1875,11 @@ int AisanRoadEdgeFileReader::ReadAllData(vector<AisanRoadEdge>& data_list)
   AisanRoadEdge data;
   //double logTime = 0;
   int count = 0;
-  while(ReadNextLine(data))
+  vector<AisanRoadEdge> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     data_list.push_back(data);
     count++;
   }
@@ -1910,17 +1951,16 @@ AisanCrossWalkFileReader::AisanCrossWalk* AisanCrossWalkFileReader::GetDataRowBy
 
 bool AisanCrossWalkFileReader::ReadNextLine(AisanCrossWalk& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 5) return false;
+    if(row.size() < 5) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.AID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.Type   = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.BdID   = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+    data.ID   = row.getInt(0);
+    data.AID   = row.getInt(1);
+    data.Type   = row.getInt(2);
+    data.BdID   = row.getInt(3);
+    data.LinkID = row.getInt(4);
 
     return true;
 
@@ -1935,8 +1975,11 @@ int AisanCrossWalkFileReader::ReadAllData(vector<AisanCrossWalk>& data_list)
   AisanCrossWalk data;
   //double logTime = 0;
   int count = 0;
-  while(ReadNextLine(data))
+  vector<AisanCrossWalk> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     data_list.push_back(data);
     count++;
   }
@@ -2006,15 +2049,14 @@ AisanWayareaFileReader::AisanWayarea* AisanWayareaFileReader::GetDataRowById(int
 
 bool AisanWayareaFileReader::ReadNextLine(AisanWayarea& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 3) return false;
+    if(row.size() < 3) return false;
 
-    data.ID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.AID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.LinkID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+    data.ID   = row.getInt(0);
+    data.AID   = row.getInt(1);
+    data.LinkID = row.getInt(2);
 
     return true;
 
@@ -2029,8 +2071,11 @@ int AisanWayareaFileReader::ReadAllData(vector<AisanWayarea>& data_list)
   AisanWayarea data;
   //double logTime = 0;
   int count = 0;
-  while(ReadNextLine(data))
+  vector<AisanWayarea> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     data_list.push_back(data);
     count++;
   }
@@ -2040,16 +2085,15 @@ int AisanWayareaFileReader::ReadAllData(vector<AisanWayarea>& data_list)
 //Data Conn
 bool AisanDataConnFileReader::ReadNextLine(DataConn& data)
 {
-  vector<vector<string> > lineData;
-  if(ReadSingleLine(lineData))
+  vector_map::CsvRow row;
+  if(ReadSingleRow(row))
   {
-    if(lineData.size()==0) return false;
-    if(lineData.at(0).size() < 4) return false;
+    if(row.size() < 4) return false;
 
-    data.LID   = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-    data.SLID   = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-    data.SID   = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-    data.SSID   = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
+    data.LID   = row.getInt(0);
+    data.SLID   = row.getInt(1);
+    data.SID   = row.getInt(2);
+    data.SSID   = row.getInt(3);
 
     return true;
 
@@ -2064,8 +2108,11 @@ int AisanDataConnFileReader::ReadAllData(vector<DataConn>& data_list)
   DataConn data;
   //double logTime = 0;
   int count = 0;
-  while(ReadNextLine(data))
+  vector<DataConn> rows;
+  ReadAllRows(*this, rows);
+  for(unsigned int r = 0; r < rows.size(); r++)
   {
+    data = rows.at(r);
     data_list.push_back(data);
     count++;
   }
@@ -18,6 +18,9 @@
  *
  */
 
+#include <sys/types.h>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <boost/interprocess/managed_shared_memory.hpp>
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
@@ -32,6 +35,34 @@ enum class VitalMonitorMode
   CNT_MON
 };
 
+// Mapping of the shared memory segment of ros_observer, opened once and kept between calls.
+// It is checked at most every STALE_CHECK_INTERVAL_MSEC that ros_observer has not created the segment again.
+class ShmSegment
+{
+public:
+  static constexpr unsigned int STALE_CHECK_INTERVAL_MSEC = 1000;
+
+  ShmSegment() : inode_(0) {}
+
+  bool open(void);
+  void close(void);
+  bool is_open(void) const {return shm_ != nullptr;}
+  bool is_stale(void);
+
+  template <class T>
+  T* find(const std::string& name)
+  {
+    return shm_->find<T>(name.c_str()).first;
+  }
+
+protected:
+  std::unique_ptr<boost::interprocess::managed_shared_memory> shm_;
+  ino_t inode_;
+  std::chrono::steady_clock::time_point checked_time_;
+
+  static bool get_inode(ino_t* inode);
+};
+
 class ShmVitalMonitor
 {
 public:
@@ -46,8 +77,11 @@ protected:
   VitalMonitorMode mode_;
   bool is_opened_;
   const unsigned int polling_interval_msec_;
+  ShmSegment segment_;
+  ShmVitalCounter* p_cnt_;
 
   bool attempt_to_open(void);
+  bool map_counter(void);
   void init_vital_counter(void);
   void update_vital_counter(void);
 };
@@ -56,7 +90,8 @@ class ShmDRStopRequest
 {
 public:
   ShmDRStopRequest() :
-  is_opened_(false), name_("DRStopRequest"), shm_name_("SHM_" + name_), mut_name_("MUT_" + name_) {}
+  is_opened_(false), name_("DRStopRequest"), shm_name_("SHM_" + name_), mut_name_("MUT_" + name_),
+  p_stop_request_(nullptr), p_mut_(nullptr) {}
 
   void clear_request(void);
   bool is_request_received(void);
@@ -64,8 +99,12 @@ public:
 protected:
   bool is_opened_;
   std::string name_, shm_name_, mut_name_;
+  ShmSegment segment_;
+  bool* p_stop_request_;
+  boost::interprocess::interprocess_mutex* p_mut_;
 
   bool attempt_to_open(void);
+  bool map_request(void);
 };
 
 #endif  // ROS_OBSERVER_LIB_ROS_OBSERVER_H
@@ -18,6 +18,8 @@
  *
  */
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <functional>
@@ -38,16 +40,51 @@ enum class ModuleStatus
   ErrorDetected
 };
 
+// The counters are shared between processes without a lock, which needs address free atomics
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_BOOL_LOCK_FREE == 2, "shared memory counters must be lock free");
+
 struct ShmVitalCounter
 {
-  ModuleStatus modstatus;
+  std::atomic<ModuleStatus> modstatus;
 
-  bool activated;
-  unsigned int thresh;
-  unsigned int value;
+  // thresh is written before activated is set, so that it is valid once activated is seen
+  std::atomic<bool> activated;
+  std::atomic<unsigned int> thresh;
+  std::atomic<unsigned int> value;
 
   ShmVitalCounter() :
   modstatus(ModuleStatus::Normal), activated(false), thresh(0), value(0) {}
+
+  void activate(unsigned int threshold)
+  {
+    thresh.store(threshold, std::memory_order_relaxed);
+    value.store(0, std::memory_order_relaxed);
+    activated.store(true, std::memory_order_release);
+  }
+
+  // Add interval to the counter, saturating at SHM_COUNTER_MAX, or reset it if it is not activated.
+  // A clear by the monitored side between the load and the store is not overwritten.
+  unsigned int count_up(unsigned int interval)
+  {
+    if (!activated.load(std::memory_order_acquire))
+    {
+      value.store(0, std::memory_order_relaxed);
+      return 0;
+    }
+    unsigned int current = value.load(std::memory_order_relaxed);
+    unsigned int next;
+    do
+    {
+      next = std::min(current + interval, SHM_COUNTER_MAX);
+    }
+    while (!value.compare_exchange_weak(current, next, std::memory_order_relaxed));
+    return next;
+  }
+
+  bool is_timed_out(void) const
+  {
+    return value.load(std::memory_order_relaxed) > thresh.load(std::memory_order_relaxed);
+  }
 };
 
 #endif  // ROS_OBSERVER_ROS_OBSERVER_H
@@ -15,6 +15,7 @@
  *
  */
 
+#include <sys/stat.h>
 #include <string>
 #include <algorithm>
 #include <iostream>
@@ -27,9 +28,70 @@ using boost::interprocess::open_only;
 using boost::interprocess::interprocess_mutex;
 using boost::interprocess::interprocess_exception;
 
+constexpr unsigned int ShmSegment::STALE_CHECK_INTERVAL_MSEC;
+
+bool ShmSegment::get_inode(ino_t* inode)
+{
+  // boost::interprocess creates the segment with shm_open on Linux
+  struct stat st;
+  if (stat((std::string("/dev/shm/") + SHM_NAME).c_str(), &st) != 0)
+  {
+    return false;
+  }
+  *inode = st.st_ino;
+  return true;
+}
+
+bool ShmSegment::open(void)
+{
+  close();
+
+  // The inode is read before mapping, so that a segment created in between is detected as stale later
+  ino_t inode;
+  if (!get_inode(&inode))
+  {
+    return false;
+  }
+
+  try
+  {
+    shm_.reset(new managed_shared_memory(open_only, SHM_NAME));
+  }
+  catch(interprocess_exception &ex)
+  {
+    return false;
+  }
+  inode_ = inode;
+  checked_time_ = std::chrono::steady_clock::now();
+  return true;
+}
+
+void ShmSegment::close(void)
+{
+  shm_.reset();
+}
+
+bool ShmSegment::is_stale(void)
+{
+  if (!is_open())
+  {
+    return true;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  if (now - checked_time_ < std::chrono::milliseconds(STALE_CHECK_INTERVAL_MSEC))
+  {
+    return false;
+  }
+  checked_time_ = now;
+
+  ino_t inode;
+  return !get_inode(&inode) || inode != inode_;
+}
+
 ShmVitalMonitor::ShmVitalMonitor(std::string mod_name, const double loop_rate, VitalMonitorMode mode) :
   is_opened_(false), name_(mod_name), shm_name_("SHM_" + mod_name), mut_name_("MUT_" + mod_name),
-  mode_(mode), polling_interval_msec_(1000.0/loop_rate) {}
+  mode_(mode), polling_interval_msec_(1000.0/loop_rate), p_cnt_(nullptr) {}
 
 void ShmVitalMonitor::run(void)
 {
@@ -44,22 +106,34 @@ void ShmVitalMonitor::run(void)
   }
 }
 
+bool ShmVitalMonitor::map_counter(void)
+{
+  if (p_cnt_ != nullptr && !segment_.is_stale())
+  {
+    return true;
+  }
+
+  p_cnt_ = nullptr;
+  if (segment_.open())
+  {
+    p_cnt_ = segment_.find<ShmVitalCounter>(shm_name_);
+    if (p_cnt_ == nullptr)
+    {
+      segment_.close();
+    }
+  }
+  return p_cnt_ != nullptr;
+}
+
 void ShmVitalMonitor::init_vital_counter(void)
 {
   if (mode_ == VitalMonitorMode::CNT_CLEAR)
   {
-    try
+    if (map_counter())
     {
-      managed_shared_memory shm(open_only, SHM_NAME);
-      ShmVitalCounter* p_cnt = shm.find<ShmVitalCounter>(shm_name_.c_str()).first;
-      interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-      scoped_lock<interprocess_mutex> scpdlock(*p_mut);
-
-      p_cnt->activated = true;
-      p_cnt->thresh = (polling_interval_msec_)*(SHM_TH_COUNTER);
-      p_cnt->value = 0;
+      p_cnt_->activate(polling_interval_msec_ * SHM_TH_COUNTER);
     }
-    catch(interprocess_exception &ex)
+    else
     {
       std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
     }
@@ -68,45 +142,27 @@ void ShmVitalMonitor::init_vital_counter(void)
 
 void ShmVitalMonitor::update_vital_counter(void)
 {
-  try
+  if (!map_counter())
   {
-    managed_shared_memory shm(open_only, SHM_NAME);
-    ShmVitalCounter* p_cnt = shm.find<ShmVitalCounter>(shm_name_.c_str()).first;
-    interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-    scoped_lock<interprocess_mutex> scpdlock(*p_mut);
+    std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
+    return;
+  }
 
-    if (mode_ == VitalMonitorMode::CNT_CLEAR)
-    {
-      p_cnt->value = 0;
-    }
-    else if (mode_ == VitalMonitorMode::CNT_MON)
-    {
-      p_cnt->value = (p_cnt->activated) ? std::min((p_cnt->value + polling_interval_msec_), SHM_COUNTER_MAX) : 0;
-      p_cnt->modstatus = (p_cnt->value > p_cnt->thresh) ? ModuleStatus::ErrorDetected : ModuleStatus::Normal;
-    }
+  if (mode_ == VitalMonitorMode::CNT_CLEAR)
+  {
+    p_cnt_->value.store(0, std::memory_order_relaxed);
   }
-  catch(interprocess_exception &ex)
+  else if (mode_ == VitalMonitorMode::CNT_MON)
   {
-    std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
+    p_cnt_->count_up(polling_interval_msec_);
+    p_cnt_->modstatus.store(p_cnt_->is_timed_out() ? ModuleStatus::ErrorDetected : ModuleStatus::Normal,
+                            std::memory_order_relaxed);
   }
 }
 
 bool ShmVitalMonitor::attempt_to_open(void)
 {
-  bool is_opened = false;
-
-  try
-  {
-    managed_shared_memory shm(open_only, SHM_NAME);
-    ShmVitalCounter* p_cnt = shm.find<ShmVitalCounter>(shm_name_.c_str()).first;
-    interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-    is_opened = true;
-  }
-  catch(interprocess_exception &ex)
-  {
-    is_opened = false;
-  }
-  return is_opened;
+  return map_counter();
 }
 
 bool ShmVitalMonitor::is_error_detected(void)
@@ -117,23 +173,38 @@ bool ShmVitalMonitor::is_error_detected(void)
   {
     is_opened_ = attempt_to_open();
   }
+  else if (map_counter())
+  {
+    is_error_detected = (p_cnt_->modstatus.load(std::memory_order_relaxed) == ModuleStatus::ErrorDetected);
+  }
   else
   {
-    try
-    {
-      managed_shared_memory shm(open_only, SHM_NAME);
-      ShmVitalCounter* p_cnt = shm.find<ShmVitalCounter>(shm_name_.c_str()).first;
-      interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
+    is_error_detected = true;
+  }
+  return is_error_detected;
+}
 
-      scoped_lock<interprocess_mutex> scpdlock(*p_mut);
-      is_error_detected = (p_cnt->modstatus == ModuleStatus::ErrorDetected) ? true : false;
-    }
-    catch(interprocess_exception &ex)
+bool ShmDRStopRequest::map_request(void)
+{
+  if (p_stop_request_ != nullptr && p_mut_ != nullptr && !segment_.is_stale())
+  {
+    return true;
+  }
+
+  p_stop_request_ = nullptr;
+  p_mut_ = nullptr;
+  if (segment_.open())
+  {
+    p_stop_request_ = segment_.find<bool>(shm_name_);
+    p_mut_ = segment_.find<interprocess_mutex>(mut_name_);
+    if (p_stop_request_ == nullptr || p_mut_ == nullptr)
     {
-      is_error_detected = true;
+      p_stop_request_ = nullptr;
+      p_mut_ = nullptr;
+      segment_.close();
     }
   }
-  return is_error_detected;
+  return p_stop_request_ != nullptr;
 }
 
 bool ShmDRStopRequest::is_request_received(void)
@@ -144,22 +215,15 @@ bool ShmDRStopRequest::is_request_received(void)
   {
     is_opened_ = attempt_to_open();
   }
+  else if (map_request())
+  {
+    scoped_lock<interprocess_mutex> scpdlock(*p_mut_);
+    is_request_received = (*p_stop_request_);
+  }
   else
   {
-    try
-    {
-      managed_shared_memory shm(open_only, SHM_NAME);
-      bool* p_stop_request = shm.find<bool>(shm_name_.c_str()).first;
-      interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-
-      scoped_lock<interprocess_mutex> scpdlock(*p_mut);
-      is_request_received = (*p_stop_request);
-    }
-    catch(interprocess_exception &ex)
-    {
-      std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
-      is_request_received = false;
-    }
+    std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
+    is_request_received = false;
   }
   return is_request_received;
 }
@@ -170,38 +234,18 @@ void ShmDRStopRequest::clear_request(void)
   {
     is_opened_ = attempt_to_open();
   }
+  else if (map_request())
+  {
+    scoped_lock<interprocess_mutex> scpdlock(*p_mut_);
+    (*p_stop_request_) = false;
+  }
   else
   {
-    try
-    {
-      managed_shared_memory shm(open_only, SHM_NAME);
-      bool* p_stop_request = shm.find<bool>(shm_name_.c_str()).first;
-      interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-
-      scoped_lock<interprocess_mutex> scpdlock(*p_mut);
-      (*p_stop_request) = false;
-    }
-    catch(interprocess_exception &ex)
-    {
-      std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
-    }
+    std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
   }
 }
 
 bool ShmDRStopRequest::attempt_to_open(void)
 {
-  bool is_opened = false;
-
-  try
-  {
-    managed_shared_memory shm(open_only, SHM_NAME);
-    bool* p_stop_request = shm.find<bool>(shm_name_.c_str()).first;
-    interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-    is_opened = true;
-  }
-  catch(interprocess_exception &ex)
-  {
-    is_opened = false;
-  }
-  return is_opened;
+  return map_request();
 }
@@ -89,73 +89,50 @@ int main(int argc, char* argv[])
   ShmVitalCounter* p_cnt_AS = shm.construct<ShmVitalCounter>("SHM_AS_VehicleDriver")();
   bool* p_stopReq_DR = shm.construct<bool>("SHM_DRStopRequest")();
 
-  interprocess_mutex* p_mut_RO = shm.construct<interprocess_mutex>("MUT_RosObserver")();
-  interprocess_mutex* p_mut_HA = shm.construct<interprocess_mutex>("MUT_HealthAggregator")();
-  interprocess_mutex* p_mut_EH = shm.construct<interprocess_mutex>("MUT_EmergencyHandler")();
-  interprocess_mutex* p_mut_TG = shm.construct<interprocess_mutex>("MUT_TwistGate")();
-  interprocess_mutex* p_mut_YMC = shm.construct<interprocess_mutex>("MUT_YMC_VehicleDriver")();
-  interprocess_mutex* p_mut_AS = shm.construct<interprocess_mutex>("MUT_AS_VehicleDriver")();
   interprocess_mutex* p_mut_DR = shm.construct<interprocess_mutex>("MUT_DRStopRequest")();
 
-  {
-    scoped_lock<interprocess_mutex> scpdlock_RO(*p_mut_RO);
-    p_cnt_RO->activated = true;
-    p_cnt_RO->thresh = (POLLING_INTERVAL_MSEC) * (SHM_TH_COUNTER_RO);
-    p_cnt_RO->value = 0;
-  }
+  p_cnt_RO->activate((POLLING_INTERVAL_MSEC) * (SHM_TH_COUNTER_RO));
 
   while (!terminate_req_rcvd)
   {
     {
-      scoped_lock<interprocess_mutex> scpdlock_RO(*p_mut_RO);
-      scoped_lock<interprocess_mutex> scpdlock_HA(*p_mut_HA);
-      scoped_lock<interprocess_mutex> scpdlock_EH(*p_mut_EH);
-      scoped_lock<interprocess_mutex> scpdlock_TG(*p_mut_TG);
-      scoped_lock<interprocess_mutex> scpdlock_YMC(*p_mut_YMC);
-      scoped_lock<interprocess_mutex> scpdlock_AS(*p_mut_AS);
-      scoped_lock<interprocess_mutex> scpdlock_DR(*p_mut_DR);
-
-      p_cnt_RO->value = 0;
-      p_cnt_HA->value =
-          (p_cnt_HA->activated) ? std::min((p_cnt_HA->value + (POLLING_INTERVAL_MSEC)), SHM_COUNTER_MAX) : 0;
-      p_cnt_EH->value =
-          (p_cnt_EH->activated) ? std::min((p_cnt_EH->value + (POLLING_INTERVAL_MSEC)), SHM_COUNTER_MAX) : 0;
-      p_cnt_TG->value =
-          (p_cnt_TG->activated) ? std::min((p_cnt_TG->value + (POLLING_INTERVAL_MSEC)), SHM_COUNTER_MAX) : 0;
-      p_cnt_YMC->value =
-          (p_cnt_YMC->activated) ? std::min((p_cnt_YMC->value + (POLLING_INTERVAL_MSEC)), SHM_COUNTER_MAX) : 0;
-      p_cnt_AS->value =
-          (p_cnt_AS->activated) ? std::min((p_cnt_AS->value + (POLLING_INTERVAL_MSEC)), SHM_COUNTER_MAX) : 0;
+      // The counters are atomic, only the stop request is locked
+      p_cnt_RO->value.store(0, std::memory_order_relaxed);
+      p_cnt_HA->count_up(POLLING_INTERVAL_MSEC);
+      p_cnt_EH->count_up(POLLING_INTERVAL_MSEC);
+      p_cnt_TG->count_up(POLLING_INTERVAL_MSEC);
+      p_cnt_YMC->count_up(POLLING_INTERVAL_MSEC);
+      p_cnt_AS->count_up(POLLING_INTERVAL_MSEC);
 
       static bool ros_error_detected_prev = false;
       bool ros_error_detected = false;
       std::string error_node;
 
-      if (p_cnt_HA->value > p_cnt_HA->thresh)
+      if (p_cnt_HA->is_timed_out())
       {
         ros_error_detected = true;
         error_node = "Health Aggregator";
       }
 
-      if (p_cnt_EH->value > p_cnt_EH->thresh)
+      if (p_cnt_EH->is_timed_out())
       {
         ros_error_detected = true;
         error_node = "Emergency Handler";
       }
 
-      if (p_cnt_TG->value > p_cnt_TG->thresh)
+      if (p_cnt_TG->is_timed_out())
       {
         ros_error_detected = true;
         error_node = "Twist Gate";
       }
 
-      if (p_cnt_YMC->value > p_cnt_YMC->thresh)
+      if (p_cnt_YMC->is_timed_out())
       {
         ros_error_detected = true;
         error_node = "YMC Vehicle Driver";
       }
 
-      if (p_cnt_AS->value > p_cnt_AS->thresh)
+      if (p_cnt_AS->is_timed_out())
       {
         ros_error_detected = true;
         error_node = "AS Vehicle Driver";
@@ -163,9 +140,10 @@ int main(int argc, char* argv[])
 
       if (ros_error_detected)
       {
-        p_cnt_HA->modstatus = ModuleStatus::ErrorDetected;
+        p_cnt_HA->modstatus.store(ModuleStatus::ErrorDetected, std::memory_order_relaxed);
         if (!ros_error_detected_prev)
         {
+          scoped_lock<interprocess_mutex> scpdlock_DR(*p_mut_DR);
           (*p_stopReq_DR) = true;
         }
 
@@ -177,9 +155,10 @@ int main(int argc, char* argv[])
       }
       else
       {
-        p_cnt_HA->modstatus = ModuleStatus::Normal;
+        p_cnt_HA->modstatus.store(ModuleStatus::Normal, std::memory_order_relaxed);
         if (ros_error_detected_prev)
         {
+          scoped_lock<interprocess_mutex> scpdlock_DR(*p_mut_DR);
           (*p_stopReq_DR) = false;
         }
       }
@@ -0,0 +1,233 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Measures the heartbeats per second ShmVitalMonitor can send, and the latency between the observer
+// counting a module up and seeing the module clear it again. It needs the shared memory segment of
+// ros_observer, so it must not run at the same time.
+//
+// usage: ros_observer_benchmark [modules] [duration_sec] [heartbeat_rate_hz]
+//
+// A heartbeat rate of 0 lets the modules call run() in a busy loop. With more than one allowed CPU the
+// observer is pinned to the first one and busy-waits, and the modules are pinned round-robin to the others,
+// so the latency is the time for a clear to reach the observer. On a single CPU nothing is pinned and the
+// observer yields, so the latency is dominated by the scheduler time slice of the busy modules.
+
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ros_observer/lib_ros_observer.h>
+#include <ros_observer/ros_observer.h>
+
+using boost::interprocess::managed_shared_memory;
+using boost::interprocess::shared_memory_object;
+using boost::interprocess::create_only;
+using boost::interprocess::open_only;
+using boost::interprocess::interprocess_exception;
+
+namespace
+{
+std::vector<int> get_allowed_cpus(void)
+{
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0)
+  {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+      if (CPU_ISSET(cpu, &set))
+      {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+
+bool pin_thread(pthread_t thread, int cpu)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  const int num_modules = (argc > 1) ? std::max(1, std::stoi(argv[1])) : 6;
+  const double duration_sec = (argc > 2) ? std::stod(argv[2]) : 5.0;
+  const double heartbeat_rate = (argc > 3) ? std::max(0.0, std::stod(argv[3])) : 0.0;
+
+  try
+  {
+    managed_shared_memory existing(open_only, SHM_NAME);
+    std::cout << "[ERROR][" << SHM_NAME << " exists, stop ros_observer before running the benchmark]" << std::endl;
+    return 1;
+  }
+  catch (interprocess_exception& ex)
+  {
+  }
+
+  const std::vector<int> cpus = get_allowed_cpus();
+  const bool pinned = cpus.size() > 1;
+  if (pinned && !pin_thread(pthread_self(), cpus[0]))
+  {
+    std::cout << "[ERROR][Failed to pin the observer to CPU " << cpus[0] << "]" << std::endl;
+    return 1;
+  }
+
+  managed_shared_memory shm(create_only, SHM_NAME, SHM_SIZE);
+  std::vector<ShmVitalCounter*> counters;
+  for (int i = 0; i < num_modules; i++)
+  {
+    counters.push_back(shm.construct<ShmVitalCounter>(("SHM_Benchmark" + std::to_string(i)).c_str())());
+  }
+
+  std::atomic<bool> stop(false);
+  std::vector<unsigned long> heartbeats(num_modules, 0);
+  std::vector<std::thread> modules;
+  for (int i = 0; i < num_modules; i++)
+  {
+    modules.emplace_back([i, heartbeat_rate, &stop, &heartbeats]()
+    {
+      ShmVitalMonitor monitor("Benchmark" + std::to_string(i), heartbeat_rate > 0 ? heartbeat_rate : 100.0);
+      const auto period = std::chrono::duration<double>(heartbeat_rate > 0 ? 1.0 / heartbeat_rate : 0.0);
+      auto next_time = std::chrono::steady_clock::now();
+      unsigned long count = 0;
+      while (!stop.load(std::memory_order_relaxed))
+      {
+        monitor.run();
+        count++;
+        if (heartbeat_rate > 0)
+        {
+          next_time += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+          std::this_thread::sleep_until(next_time);
+        }
+      }
+      heartbeats[i] = count;
+    });
+    if (pinned)
+    {
+      pin_thread(modules.back().native_handle(), cpus[1 + i % (cpus.size() - 1)]);
+    }
+  }
+
+  // The modules activate their counter on their first run(), a counter that is not activated is never counted up
+  const auto activate_end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  for (auto p_cnt : counters)
+  {
+    while (!p_cnt->activated.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < activate_end)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  // Count the modules up one at a time and wait until the module has cleared its counter
+  std::vector<double> latencies_usec;
+  unsigned long timeouts = 0;
+  const auto begin = std::chrono::steady_clock::now();
+  const auto end = begin + std::chrono::duration<double>(duration_sec);
+  for (size_t i = 0; std::chrono::steady_clock::now() < end; i = (i + 1) % counters.size())
+  {
+    ShmVitalCounter* p_cnt = counters[i];
+    if (!p_cnt->activated.load(std::memory_order_acquire))
+    {
+      continue;
+    }
+    const auto count_time = std::chrono::steady_clock::now();
+    p_cnt->count_up(1);
+    bool cleared = false;
+    while (!(cleared = (p_cnt->value.load(std::memory_order_relaxed) == 0)) && std::chrono::steady_clock::now() < end)
+    {
+      if (!pinned)
+      {
+        std::this_thread::yield();
+      }
+    }
+    if (cleared)
+    {
+      latencies_usec.push_back(
+          std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - count_time).count());
+    }
+    else
+    {
+      timeouts++;
+    }
+  }
+  stop.store(true);
+  for (auto& module : modules)
+  {
+    module.join();
+  }
+  const double elapsed_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+  unsigned long not_activated = 0;
+  for (auto p_cnt : counters)
+  {
+    not_activated += p_cnt->activated.load() ? 0 : 1;
+  }
+  shared_memory_object::remove(SHM_NAME);
+
+  unsigned long total_heartbeats = 0;
+  for (auto count : heartbeats)
+  {
+    total_heartbeats += count;
+  }
+  std::sort(latencies_usec.begin(), latencies_usec.end());
+  auto percentile = [&latencies_usec](double p)
+  {
+    return latencies_usec.empty() ? 0.0 : latencies_usec[static_cast<size_t>(p * (latencies_usec.size() - 1))];
+  };
+
+  std::cout << "cpus: " << cpus.size() << ", modules: " << num_modules << ", heartbeat: ";
+  if (heartbeat_rate > 0)
+  {
+    std::cout << heartbeat_rate << " Hz";
+  }
+  else
+  {
+    std::cout << "busy loop";
+  }
+  if (pinned)
+  {
+    std::cout << ", observer pinned to CPU " << cpus[0] << " (busy wait), modules pinned to the other "
+              << cpus.size() - 1 << " CPUs";
+  }
+  else
+  {
+    std::cout << ", not pinned, observer and modules share one CPU (observer yields)";
+  }
+  std::cout << std::endl;
+  std::cout << "duration: " << elapsed_sec << " s" << std::endl;
+  std::cout << "heartbeats: " << total_heartbeats / elapsed_sec << " /s ("
+            << total_heartbeats / elapsed_sec / num_modules << " /s per module)" << std::endl;
+  std::cout << "observer latency: p50 " << percentile(0.5) << " us, p99 " << percentile(0.99) << " us, max "
+            << percentile(1.0) << " us (" << latencies_usec.size() << " samples, " << timeouts << " not cleared)"
+            << std::endl;
+  if (not_activated > 0)
+  {
+    std::cout << "[WARN][" << not_activated << " modules never activated their counter]" << std::endl;
+  }
+
+  return 0;
+}
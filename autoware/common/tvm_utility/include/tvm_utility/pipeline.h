@@ -20,7 +20,17 @@
 #include <tvm_vendor/tvm/runtime/module.h>
 #include <tvm_vendor/tvm/runtime/packed_func.h>
 #include <tvm_vendor/tvm/runtime/registry.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -166,6 +176,264 @@ private:
   PostProcessorType post_processor_{};
 };
 
+/**
+ * @brief Latency statistics of one stage of an AsyncPipeline.
+ */
+typedef struct
+{
+  // number of inputs processed by the stage
+  uint64_t count;
+
+  // latency of the stage in milliseconds
+  double last_ms;
+  double total_ms;
+  double max_ms;
+}
+StageStatistics;
+
+/**
+ * @class BoundedQueue
+ * @brief Blocking FIFO queue with a fixed capacity, used to hand over data
+ * between the stages of an AsyncPipeline.
+ *
+ * @tparam T The datatype of the queued elements.
+ */
+template <class T> class BoundedQueue
+{
+public:
+  explicit BoundedQueue(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+  /**
+   * @brief Add an element, wait while the queue is full.
+   *
+   * @return false if the queue has been closed
+   */
+  bool push(T &&value)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return closed_ || queue_.size() < capacity_; });
+    if (closed_)
+      return false;
+    queue_.push_back(std::move(value));
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Remove the oldest element, wait while the queue is empty.
+   *
+   * @return false once the queue has been closed and emptied
+   */
+  bool pop(T *value)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+    if (queue_.empty())
+      return false;
+    *value = std::move(queue_.front());
+    queue_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Refuse further elements. The elements already queued can still be
+   * popped.
+   */
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    not_full_.notify_all();
+    not_empty_.notify_all();
+  }
+
+private:
+  size_t capacity_;
+  bool closed_{false};
+  std::deque<T> queue_;
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+};
+
+/**
+ * @class AsyncPipeline
+ * @brief Inference Pipeline running each of its 3 stages in a worker thread.
+ * The stages are connected by bounded queues, so that pre-processing of an
+ * input overlaps the inference of the previous one and the sustained
+ * throughput is the one of the slowest stage instead of the sum of the stages.
+ *
+ * A stage returning TVMArrayContainerVector must not overwrite its output
+ * while the next stage may still be using it: it should rotate between
+ * bufferSets(queue_depth) sets of buffers, as InferenceEngineTVM does.
+ */
+template <class PreProcessorType, class InferenceEngineType,
+          class PostProcessorType>
+class AsyncPipeline
+{
+  using InputType =
+      decltype(std::declval<PreProcessorType>().input_type_indicator_);
+  using OutputType =
+      decltype(std::declval<PostProcessorType>().output_type_indicator_);
+  using Clock = std::chrono::steady_clock;
+
+  // data travelling through the pipeline with the promise of its result
+  template <class T> struct Job
+  {
+    T data;
+    std::promise<OutputType> result;
+  };
+
+public:
+  enum Stage { PRE_PROCESSOR = 0, INFERENCE_ENGINE, POST_PROCESSOR, STAGE_COUNT };
+
+  /**
+   * @brief Construct a new AsyncPipeline object and start its worker threads
+   *
+   * @param pre_processor a PreProcessor object
+   * @param inference_engine a InferenceEngine object
+   * @param post_processor a PostProcessor object
+   * @param queue_depth number of inputs which can wait in front of each stage
+   */
+  AsyncPipeline(PreProcessorType pre_processor,
+                InferenceEngineType inference_engine,
+                PostProcessorType post_processor, size_t queue_depth = 1)
+      : pre_processor_(pre_processor), inference_engine_(inference_engine),
+        post_processor_(post_processor), input_queue_(queue_depth),
+        pre_processed_queue_(queue_depth), inferred_queue_(queue_depth),
+        statistics_()
+  {
+    workers_.emplace_back([this] {
+      runStage(pre_processor_, input_queue_, pre_processed_queue_, PRE_PROCESSOR);
+    });
+    workers_.emplace_back([this] {
+      runStage(inference_engine_, pre_processed_queue_, inferred_queue_, INFERENCE_ENGINE);
+    });
+    workers_.emplace_back([this] { runPostProcessor(); });
+  }
+
+  /**
+   * @brief Finish the inputs already scheduled and stop the worker threads.
+   */
+  ~AsyncPipeline()
+  {
+    input_queue_.close();
+    for (auto &worker : workers_)
+    {
+      worker.join();
+    }
+  }
+
+  AsyncPipeline(const AsyncPipeline &) = delete;
+  AsyncPipeline &operator=(const AsyncPipeline &) = delete;
+
+  /**
+   * @brief Number of buffer sets a stage returning TVMArrayContainerVector
+   * needs to rotate: the queued outputs, the one used by the next stage and the
+   * one being written.
+   */
+  static size_t bufferSets(size_t queue_depth)
+  {
+    return std::max<size_t>(queue_depth, 1) + 2;
+  }
+
+  /**
+   * @brief push data into the pipeline. Waits while the input queue is full.
+   *
+   * @param input The data to push into the pipeline. Data referenced by the
+   * input must stay valid until it has been pre-processed.
+   * @return The future pipeline output. Exceptions thrown by the stages are
+   * rethrown by its get function.
+   */
+  std::future<OutputType> schedule(const InputType &input)
+  {
+    Job<InputType> job;
+    job.data = input;
+    auto result = job.result.get_future();
+    input_queue_.push(std::move(job));
+    return result;
+  }
+
+  /**
+   * @brief Latency statistics of a stage since the construction of the pipeline
+   */
+  StageStatistics getStatistics(Stage stage) const
+  {
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    return statistics_[stage];
+  }
+
+private:
+  template <class StageType, class StageInputType, class StageOutputType>
+  void runStage(StageType &stage, BoundedQueue<Job<StageInputType>> &input,
+                BoundedQueue<Job<StageOutputType>> &output, Stage index)
+  {
+    Job<StageInputType> job;
+    while (input.pop(&job))
+    {
+      Job<StageOutputType> next;
+      next.result = std::move(job.result);
+      auto start = Clock::now();
+      try
+      {
+        next.data = stage.schedule(job.data);
+      }
+      catch (...)
+      {
+        next.result.set_exception(std::current_exception());
+        continue;
+      }
+      record(index, start);
+      output.push(std::move(next));
+    }
+    output.close();
+  }
+
+  void runPostProcessor()
+  {
+    Job<TVMArrayContainerVector> job;
+    while (inferred_queue_.pop(&job))
+    {
+      auto start = Clock::now();
+      try
+      {
+        OutputType output = post_processor_.schedule(job.data);
+        record(POST_PROCESSOR, start);
+        job.result.set_value(std::move(output));
+      }
+      catch (...)
+      {
+        job.result.set_exception(std::current_exception());
+      }
+    }
+  }
+
+  void record(Stage stage, Clock::time_point start)
+  {
+    double latency_ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    StageStatistics &statistics = statistics_[stage];
+    statistics.count++;
+    statistics.last_ms = latency_ms;
+    statistics.total_ms += latency_ms;
+    statistics.max_ms = std::max(statistics.max_ms, latency_ms);
+  }
+
+  PreProcessorType pre_processor_;
+  InferenceEngineType inference_engine_;
+  PostProcessorType post_processor_;
+
+  BoundedQueue<Job<InputType>> input_queue_;
+  BoundedQueue<Job<TVMArrayContainerVector>> pre_processed_queue_;
+  BoundedQueue<Job<TVMArrayContainerVector>> inferred_queue_;
+  std::vector<std::thread> workers_;
+
+  mutable std::mutex statistics_mutex_;
+  std::array<StageStatistics, STAGE_COUNT> statistics_;
+};
+
 // each node should be specificed with a string name and a shape
 using NetworkNode = std::pair<std::string, std::vector<int64_t>>;
 typedef struct
@@ -195,7 +463,16 @@ InferenceEngineTVMConfig;
 class InferenceEngineTVM : public InferenceEngine
 {
 public:
-  explicit InferenceEngineTVM(InferenceEngineTVMConfig config) : config_(config)
+  /**
+   * @brief Construct a new InferenceEngineTVM object
+   *
+   * @param config the configuration of the network
+   * @param buffer_sets number of output buffer sets used in turn, see
+   * AsyncPipeline::bufferSets
+   */
+  explicit InferenceEngineTVM(InferenceEngineTVMConfig config,
+                              size_t buffer_sets = 1)
+      : config_(config), outputs_(std::max<size_t>(buffer_sets, 1))
   {
     // load compiled functions
     std::ifstream module(config.network_module_path);
@@ -259,12 +536,15 @@ public:
     // get the function to get output data
     get_output = runtime_mod.GetFunction("get_output");
 
-    for (auto &output_config : config.network_outputs)
+    for (auto &output : outputs_)
     {
-      output_.push_back(
-          TVMArrayContainer(output_config.second, config.tvm_dtype_code,
-                            config.tvm_dtype_bits, config.tvm_dtype_lanes,
-                            config.tvm_device_type, config.tvm_device_id));
+      for (auto &output_config : config.network_outputs)
+      {
+        output.push_back(
+            TVMArrayContainer(output_config.second, config.tvm_dtype_code,
+                              config.tvm_dtype_bits, config.tvm_dtype_lanes,
+                              config.tvm_device_type, config.tvm_device_id));
+      }
     }
   }
 
@@ -284,21 +564,24 @@ public:
     // execute the inference
     execute();
 
-    // get output(s)
-    for (int index = 0; index < output_.size(); ++index)
+    // get output(s), into the buffer set least recently returned
+    TVMArrayContainerVector &output = outputs_[next_output_];
+    next_output_ = (next_output_ + 1) % outputs_.size();
+    for (int index = 0; index < output.size(); ++index)
     {
-      if (output_[index].getArray() == nullptr)
+      if (output[index].getArray() == nullptr)
       {
         throw std::runtime_error("output variable is null");
       }
-      get_output(index, output_[index].getArray());
+      get_output(index, output[index].getArray());
     }
-    return output_;
+    return output;
   }
 
 private:
   InferenceEngineTVMConfig config_;
-  TVMArrayContainerVector output_;
+  std::vector<TVMArrayContainerVector> outputs_;
+  size_t next_output_{0};
   tvm::runtime::PackedFunc set_input;
   tvm::runtime::PackedFunc execute;
   tvm::runtime::PackedFunc get_output;
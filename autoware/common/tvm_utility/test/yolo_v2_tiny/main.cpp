@@ -45,7 +45,8 @@ class PreProcessorYoloV2Tiny
     : public tvm_utility::pipeline::PreProcessor<sensor_msgs::PointCloud2>
 {
 public:
-  explicit PreProcessorYoloV2Tiny(tvm_utility::pipeline::InferenceEngineTVMConfig config)
+  explicit PreProcessorYoloV2Tiny(tvm_utility::pipeline::InferenceEngineTVMConfig config,
+                                  size_t buffer_sets = 1)
       : network_input_width(config.network_inputs[0].second[1]),
         network_input_height(config.network_inputs[0].second[2]),
         network_input_depth(config.network_inputs[0].second[3]),
@@ -69,7 +70,15 @@ public:
       config.tvm_device_id
     };
 
-    output = x;
+    output.push_back(x);
+
+    // an AsyncPipeline needs a buffer per input in flight
+    for (size_t i = 1; i < buffer_sets; ++i)
+    {
+      output.push_back(tvm_utility::pipeline::TVMArrayContainer{
+          shape_x, config.tvm_dtype_code, config.tvm_dtype_bits,
+          config.tvm_dtype_lanes, config.tvm_device_type, config.tvm_device_id});
+    }
   }
 
   tvm_utility::pipeline::TVMArrayContainerVector
@@ -114,11 +123,13 @@ public:
     // data in RGB format
     cv::cvtColor(image_3f, image_3f, CV_BGR2RGB);
 
-    TVMArrayCopyFromBytes(output.getArray(), image_3f.data,
+    auto &x = output[next_output];
+    next_output = (next_output + 1) % output.size();
+    TVMArrayCopyFromBytes(x.getArray(), image_3f.data,
                           network_input_width * network_input_height *
                               network_input_depth * network_datatype_bytes);
 
-    return {output};
+    return {x};
   }
 
 private:
@@ -126,7 +137,8 @@ private:
   int64_t network_input_height;
   int64_t network_input_depth;
   int64_t network_datatype_bytes;
-  tvm_utility::pipeline::TVMArrayContainer output;
+  tvm_utility::pipeline::TVMArrayContainerVector output;
+  size_t next_output{0};
 };
 
 class PostProcessorYoloV2Tiny
@@ -285,9 +297,26 @@ private:
 // bring config into scope
 namespace model_config = model_zoo::perception::camera_obstacle_detection::
     yolo_v2_tiny::tensorflow_fp32_coco;
+using tvm_utility::pipeline::AsyncPipeline;
 using tvm_utility::pipeline::InferenceEngineTVM;
 using tvm_utility::pipeline::Pipeline;
 
+// define reference vector containing expected values
+const std::vector<float> expected_output
+{
+  0.360896,
+  0.763201,
+  0.402838,
+  0.302775,
+  0.612508,
+  0.583656,
+  0.422576,
+  0.452684,
+  0.372608,
+  0.806072,
+  0.572778
+};
+
 TEST(PipelineExamples, SimplePipeline)
 {
   // instantiate the pipeline
@@ -300,22 +329,6 @@ TEST(PipelineExamples, SimplePipeline)
   sensor_msgs::PointCloud2 msg{};
   auto output = pipeline.schedule(msg);
 
-  // define reference vector containing expected values
-  std::vector<float> expected_output
-  {
-    0.360896,
-    0.763201,
-    0.402838,
-    0.302775,
-    0.612508,
-    0.583656,
-    0.422576,
-    0.452684,
-    0.372608,
-    0.806072,
-    0.572778
-  };
-
   // test: check if the generated output is equal to the reference
   EXPECT_EQ(expected_output.size(), output.size()) << "Unexpected output size";
   for (auto i = 0; i < output.size(); ++i)
@@ -324,6 +337,48 @@ TEST(PipelineExamples, SimplePipeline)
   }
 }
 
+TEST(PipelineExamples, AsyncPipeline)
+{
+  using YoloPipeline = AsyncPipeline<PreProcessorYoloV2Tiny, InferenceEngineTVM,
+                                     PostProcessorYoloV2Tiny>;
+  const size_t queue_depth = 2;
+  const size_t buffer_sets = YoloPipeline::bufferSets(queue_depth);
+
+  // instantiate the pipeline, its stages run in their own threads
+  YoloPipeline pipeline(
+      PreProcessorYoloV2Tiny{model_config::config, buffer_sets},
+      InferenceEngineTVM{model_config::config, buffer_sets},
+      PostProcessorYoloV2Tiny{model_config::config}, queue_depth);  // NOLINT
+
+  // push several inputs before waiting for any output
+  const size_t input_count = 5;
+  sensor_msgs::PointCloud2 msg{};
+  std::vector<std::future<std::vector<float>>> outputs;
+  for (size_t i = 0; i < input_count; ++i)
+  {
+    outputs.push_back(pipeline.schedule(msg));
+  }
+
+  // test: every output is equal to the reference
+  for (auto &future : outputs)
+  {
+    auto output = future.get();
+    EXPECT_EQ(expected_output.size(), output.size()) << "Unexpected output size";
+    for (auto i = 0; i < output.size(); ++i)
+    {
+      EXPECT_NEAR(expected_output[i], output[i], 0.0001) << "at index: " << i;
+    }
+  }
+
+  // test: each stage has recorded its latency
+  for (auto stage : {YoloPipeline::PRE_PROCESSOR, YoloPipeline::INFERENCE_ENGINE,
+                     YoloPipeline::POST_PROCESSOR})
+  {
+    EXPECT_EQ(input_count, pipeline.getStatistics(stage).count);
+    EXPECT_GE(pipeline.getStatistics(stage).max_ms, 0.0);
+  }
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VECTOR_MAP_CSV_READER_H
+#define VECTOR_MAP_CSV_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vector_map
+{
+// Read-only view of a whole file. The file is mapped into memory when possible and read into a buffer otherwise.
+class MappedFile
+{
+private:
+  const char* data_;
+  size_t size_;
+  bool mapped_;
+  std::vector<char> buffer_;
+
+public:
+  MappedFile();
+  explicit MappedFile(const std::string& file_path);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  bool open(const std::string& file_path);
+  void close();
+
+  bool isOpen() const
+  {
+    return data_ != nullptr;
+  }
+
+  const char* data() const
+  {
+    return data_;
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+};
+
+// Parse the numeric prefix of [begin, end) like std::stoi/std::stod, but without allocating.
+// Leading blanks are skipped. Return false and leave value untouched if there are no digits.
+bool parseInt(const char* begin, const char* end, int& value);
+bool parseDouble(const char* begin, const char* end, double& value);
+
+// Columns of one csv line, pointing into the buffer of the CsvReader. Valid until the buffer is released.
+// Split like std::getline(is, column, separator): a trailing separator does not start an empty column.
+class CsvRow
+{
+public:
+  static constexpr size_t MAX_COLUMNS = 64;
+
+private:
+  const char* begins_[MAX_COLUMNS];
+  const char* ends_[MAX_COLUMNS];
+  size_t size_;
+
+public:
+  CsvRow() : size_(0)
+  {
+  }
+
+  void split(const char* begin, const char* end, char separator = ',');
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  // Missing or non numeric columns are read as 0.
+  int getInt(size_t i) const;
+  double getDouble(size_t i) const;
+  char getChar(size_t i) const;
+  std::string getString(size_t i) const;
+};
+
+class CsvReader
+{
+private:
+  const char* pos_;
+  const char* end_;
+
+public:
+  CsvReader() : pos_(nullptr), end_(nullptr)
+  {
+  }
+
+  CsvReader(const char* data, size_t size) : pos_(data), end_(data + size)
+  {
+  }
+
+  bool eof() const
+  {
+    return pos_ >= end_;
+  }
+
+  // Next line without the line break ("\n" or "\r\n"). Return false at the end of data.
+  bool nextLine(const char*& begin, const char*& end);
+
+  // Next line split into columns. Empty lines give an empty row.
+  bool nextRow(CsvRow& row, char separator = ',');
+};
+
+// Binary cache written next to a csv file (".<file name>.<cache name>"). It is valid while the csv keeps the same size
+// and modification time and the stored message md5sum matches, so a changed file or message definition is reparsed.
+// Readers storing a different payload for the same csv use their own cache name.
+bool readCsvCache(const std::string& csv_file, const std::string& md5sum, std::vector<uint8_t>& payload,
+                  const std::string& cache_name = "cache");
+bool writeCsvCache(const std::string& csv_file, const std::string& md5sum, const std::vector<uint8_t>& payload,
+                   const std::string& cache_name = "cache");
+}  // namespace vector_map
+
+#endif  // VECTOR_MAP_CSV_READER_H
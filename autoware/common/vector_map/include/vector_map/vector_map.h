@@ -18,6 +18,7 @@
 #define VECTOR_MAP_VECTOR_MAP_H
 
 #include <ros/ros.h>
+#include <ros/serialization.h>
 #include <geometry_msgs/Point.h>
 #include <geometry_msgs/Quaternion.h>
 #include <visualization_msgs/Marker.h>
@@ -54,10 +55,14 @@
 #include <vector_map_msgs/WallArray.h>
 #include <vector_map_msgs/FenceArray.h>
 #include <vector_map_msgs/RailCrossingArray.h>
+#include <vector_map/csv_reader.h>
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace vector_map
@@ -235,6 +240,40 @@ using Callback = std::function<void(const T&)>;
 template <class T>
 using Filter = std::function<bool(const T&)>;
 
+// returns the id referenced by a foreign key column
+template <class T>
+using ForeignKeyGetter = std::function<int(const T&)>;
+
+// returns the shape (points in map frame) of an object, empty if it cannot be resolved
+template <class T>
+using Locator = std::function<std::vector<geometry_msgs::Point>(const T&)>;
+
+// uniform 2D grid over object shapes (points, polylines or closed polygons)
+class SpatialGrid
+{
+private:
+  double cell_size_;
+  bool closed_;
+  std::unordered_map<uint64_t, std::vector<size_t>> cells_;
+  std::vector<int> ids_;
+  std::vector<std::vector<geometry_msgs::Point>> shapes_;
+
+  uint64_t computeCellKey(int ix, int iy) const;
+  double computeDistance(size_t index, double x, double y) const;
+
+public:
+  SpatialGrid();
+
+  void clear(double cell_size, bool closed);
+  void insert(int id, const std::vector<geometry_msgs::Point>& shape);
+  // ids of shapes within radius of (x, y) sorted by distance, polygons containing (x, y) have distance 0
+  std::vector<int> query(double x, double y, double radius) const;
+  bool empty() const
+  {
+    return ids_.empty();
+  }
+};
+
 template <class T, class U>
 class Handle
 {
@@ -242,17 +281,41 @@ private:
   ros::Subscriber sub_;
   Updater<T, U> update_;
   std::vector<Callback<U>> cbs_;
+  std::vector<std::function<void()>> dependents_;
   std::map<Key<T>, T> map_;
 
+  std::map<std::string, std::pair<ForeignKeyGetter<T>, std::multimap<int, Key<T>>>> foreign_keys_;
+  Locator<T> locator_;
+  double cell_size_;
+  bool closed_;
+  SpatialGrid grid_;
+
+  void buildForeignKeyIndex(const ForeignKeyGetter<T>& get, std::multimap<int, Key<T>>& index) const
+  {
+    index.clear();
+    for (const auto& pair : map_)
+    {
+      int id = get(pair.second);
+      if (id != 0)
+        index.insert(index.end(), std::make_pair(id, pair.first));
+    }
+  }
+
   void subscribe(const U& msg)
   {
     update_(map_, msg);
+    for (auto& foreign_key : foreign_keys_)
+      buildForeignKeyIndex(foreign_key.second.first, foreign_key.second.second);
+    rebuildSpatialIndex();
+    for (const auto& dependent : dependents_)
+      dependent();
     for (const auto& cb : cbs_)
       cb(msg);
   }
 
 public:
   Handle()
+    : cell_size_(1.0), closed_(false)
   {
   }
 
@@ -271,6 +334,36 @@ public:
     cbs_.push_back(cb);
   }
 
+  // called after the indexes of this category are rebuilt, before the callbacks
+  void registerDependent(const std::function<void()>& dependent)
+  {
+    dependents_.push_back(dependent);
+  }
+
+  void registerForeignKey(const std::string& field, const ForeignKeyGetter<T>& get)
+  {
+    auto& foreign_key = foreign_keys_[field];
+    foreign_key.first = get;
+    buildForeignKeyIndex(foreign_key.first, foreign_key.second);
+  }
+
+  void registerLocator(const Locator<T>& locator, double cell_size, bool closed)
+  {
+    locator_ = locator;
+    cell_size_ = cell_size;
+    closed_ = closed;
+    rebuildSpatialIndex();
+  }
+
+  void rebuildSpatialIndex()
+  {
+    if (!locator_)
+      return;
+    grid_.clear(cell_size_, closed_);
+    for (const auto& pair : map_)
+      grid_.insert(pair.first.getId(), locator_(pair.second));
+  }
+
   T findByKey(const Key<T>& key) const
   {
     auto it = map_.find(key);
@@ -279,6 +372,42 @@ public:
     return it->second;
   }
 
+  std::vector<T> findByForeignKey(const std::string& field, int id) const
+  {
+    std::vector<T> vector;
+    auto foreign_key = foreign_keys_.find(field);
+    if (foreign_key == foreign_keys_.end())
+    {
+      ROS_ERROR_STREAM("[vector_map] no foreign key index: " << field);
+      return vector;
+    }
+    auto range = foreign_key->second.second.equal_range(id);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      auto item = map_.find(it->second);
+      if (item != map_.end())
+        vector.push_back(item->second);
+    }
+    return vector;
+  }
+
+  std::vector<T> findNear(const geometry_msgs::Point& position, double radius) const
+  {
+    std::vector<T> vector;
+    if (!locator_)
+    {
+      ROS_ERROR("[vector_map] no spatial index");
+      return vector;
+    }
+    for (int id : grid_.query(position.x, position.y, radius))
+    {
+      auto item = map_.find(Key<T>(id));
+      if (item != map_.end())
+        vector.push_back(item->second);
+    }
+    return vector;
+  }
+
   std::vector<T> findByFilter(const Filter<T>& filter) const
   {
     std::vector<T> vector;
@@ -296,20 +425,78 @@ public:
   }
 };
 
+void parseCsvRow(const CsvRow& row, Point& obj);
+void parseCsvRow(const CsvRow& row, Vector& obj);
+void parseCsvRow(const CsvRow& row, Line& obj);
+void parseCsvRow(const CsvRow& row, Area& obj);
+void parseCsvRow(const CsvRow& row, Pole& obj);
+void parseCsvRow(const CsvRow& row, Box& obj);
+void parseCsvRow(const CsvRow& row, DTLane& obj);
+void parseCsvRow(const CsvRow& row, Node& obj);
+void parseCsvRow(const CsvRow& row, Lane& obj);
+void parseCsvRow(const CsvRow& row, WayArea& obj);
+void parseCsvRow(const CsvRow& row, RoadEdge& obj);
+void parseCsvRow(const CsvRow& row, Gutter& obj);
+void parseCsvRow(const CsvRow& row, Curb& obj);
+void parseCsvRow(const CsvRow& row, WhiteLine& obj);
+void parseCsvRow(const CsvRow& row, StopLine& obj);
+void parseCsvRow(const CsvRow& row, ZebraZone& obj);
+void parseCsvRow(const CsvRow& row, CrossWalk& obj);
+void parseCsvRow(const CsvRow& row, RoadMark& obj);
+void parseCsvRow(const CsvRow& row, RoadPole& obj);
+void parseCsvRow(const CsvRow& row, RoadSign& obj);
+void parseCsvRow(const CsvRow& row, Signal& obj);
+void parseCsvRow(const CsvRow& row, StreetLight& obj);
+void parseCsvRow(const CsvRow& row, UtilityPole& obj);
+void parseCsvRow(const CsvRow& row, GuardRail& obj);
+void parseCsvRow(const CsvRow& row, SideWalk& obj);
+void parseCsvRow(const CsvRow& row, DriveOnPortion& obj);
+void parseCsvRow(const CsvRow& row, CrossRoad& obj);
+void parseCsvRow(const CsvRow& row, SideStrip& obj);
+void parseCsvRow(const CsvRow& row, CurveMirror& obj);
+void parseCsvRow(const CsvRow& row, Wall& obj);
+void parseCsvRow(const CsvRow& row, Fence& obj);
+void parseCsvRow(const CsvRow& row, RailCrossing& obj);
+
 template <class T>
-std::vector<T> parse(const std::string& csv_file)
+std::vector<T> parse(const std::string& csv_file, bool use_cache = false)
 {
-  std::ifstream ifs(csv_file.c_str());
-  std::string line;
-  std::getline(ifs, line);  // remove first line
   std::vector<T> objs;
-  while (std::getline(ifs, line))
+  const std::string md5sum = ros::message_traits::MD5Sum<T>::value();
+  std::vector<uint8_t> payload;
+  if (use_cache && readCsvCache(csv_file, md5sum, payload))
   {
+    ros::serialization::IStream stream(payload.data(), static_cast<uint32_t>(payload.size()));
+    ros::serialization::deserialize(stream, objs);
+    return objs;
+  }
+
+  MappedFile file(csv_file);
+  if (!file.isOpen())
+    return objs;
+  CsvReader reader(file.data(), file.size());
+  const char* begin;
+  const char* end;
+  reader.nextLine(begin, end);  // remove first line
+  objs.reserve(std::count(file.data(), file.data() + file.size(), '\n'));
+  CsvRow row;
+  while (reader.nextRow(row))
+  {
+    if (row.empty())
+      continue;
     T obj;
-    std::istringstream iss(line);
-    iss >> obj;
+    parseCsvRow(row, obj);
     objs.push_back(obj);
   }
+
+  if (use_cache && !objs.empty())
+  {
+    payload.resize(ros::serialization::serializationLength(objs));
+    ros::serialization::OStream stream(payload.data(), static_cast<uint32_t>(payload.size()));
+    ros::serialization::serialize(stream, objs);
+    if (!writeCsvCache(csv_file, md5sum, payload))
+      ROS_DEBUG_STREAM("cannot write cache of " << csv_file);
+  }
   return objs;
 }
 
@@ -350,9 +537,20 @@ private:
   Handle<RailCrossing, RailCrossingArray> rail_crossing_;
 
   void registerSubscriber(ros::NodeHandle& nh, category_t category);
+  void registerIndexes();
+  std::vector<geometry_msgs::Point> locatePoint(const Point& point) const;
+  std::vector<geometry_msgs::Point> locateLane(const Lane& lane) const;
+  std::vector<geometry_msgs::Point> locateArea(const Area& area) const;
+  std::vector<geometry_msgs::Point> locateSignal(const Signal& signal) const;
 
 public:
   VectorMap();
+  // The subscribers, spatial index locators and dependents are bound to this instance, so it is neither copied nor
+  // moved.
+  VectorMap(const VectorMap&) = delete;
+  VectorMap& operator=(const VectorMap&) = delete;
+  VectorMap(VectorMap&&) = delete;
+  VectorMap& operator=(VectorMap&&) = delete;
 
   void subscribe(ros::NodeHandle& nh, category_t category);
   void subscribe(ros::NodeHandle& nh, category_t category, const ros::Duration& timeout);
@@ -424,6 +622,17 @@ public:
   std::vector<Fence> findByFilter(const Filter<Fence>& filter) const;
   std::vector<RailCrossing> findByFilter(const Filter<RailCrossing>& filter) const;
 
+  // secondary index lookup, e.g. findByForeignKey<Lane>("bnid", node.nid)
+  // indexed columns: Node pid, Lane bnid/fnid/blid/flid, Line bpid/fpid, WayArea aid, Vector pid,
+  // Signal vid/plid and linkid of every lane attached object
+  template <class T>
+  std::vector<T> findByForeignKey(const std::string& field, int id) const;
+
+  // objects whose shape lies within radius [m] of position (map frame), nearest first
+  // indexed categories: Point, Lane (start to end), Area (polygon, inside counts as 0 m), Signal (vector position)
+  template <class T>
+  std::vector<T> findNear(const geometry_msgs::Point& position, double radius) const;
+
   bool hasSubscribed(category_t category) const;
 
   void registerCallback(const Callback<PointArray>& cb);
@@ -460,6 +669,69 @@ public:
   void registerCallback(const Callback<RailCrossingArray>& cb);
 };
 
+template <>
+std::vector<Node> VectorMap::findByForeignKey<Node>(const std::string& field, int id) const;
+template <>
+std::vector<Lane> VectorMap::findByForeignKey<Lane>(const std::string& field, int id) const;
+template <>
+std::vector<Line> VectorMap::findByForeignKey<Line>(const std::string& field, int id) const;
+template <>
+std::vector<WayArea> VectorMap::findByForeignKey<WayArea>(const std::string& field, int id) const;
+template <>
+std::vector<Vector> VectorMap::findByForeignKey<Vector>(const std::string& field, int id) const;
+template <>
+std::vector<RoadEdge> VectorMap::findByForeignKey<RoadEdge>(const std::string& field, int id) const;
+template <>
+std::vector<Gutter> VectorMap::findByForeignKey<Gutter>(const std::string& field, int id) const;
+template <>
+std::vector<Curb> VectorMap::findByForeignKey<Curb>(const std::string& field, int id) const;
+template <>
+std::vector<WhiteLine> VectorMap::findByForeignKey<WhiteLine>(const std::string& field, int id) const;
+template <>
+std::vector<StopLine> VectorMap::findByForeignKey<StopLine>(const std::string& field, int id) const;
+template <>
+std::vector<ZebraZone> VectorMap::findByForeignKey<ZebraZone>(const std::string& field, int id) const;
+template <>
+std::vector<CrossWalk> VectorMap::findByForeignKey<CrossWalk>(const std::string& field, int id) const;
+template <>
+std::vector<RoadMark> VectorMap::findByForeignKey<RoadMark>(const std::string& field, int id) const;
+template <>
+std::vector<RoadPole> VectorMap::findByForeignKey<RoadPole>(const std::string& field, int id) const;
+template <>
+std::vector<RoadSign> VectorMap::findByForeignKey<RoadSign>(const std::string& field, int id) const;
+template <>
+std::vector<Signal> VectorMap::findByForeignKey<Signal>(const std::string& field, int id) const;
+template <>
+std::vector<StreetLight> VectorMap::findByForeignKey<StreetLight>(const std::string& field, int id) const;
+template <>
+std::vector<UtilityPole> VectorMap::findByForeignKey<UtilityPole>(const std::string& field, int id) const;
+template <>
+std::vector<GuardRail> VectorMap::findByForeignKey<GuardRail>(const std::string& field, int id) const;
+template <>
+std::vector<SideWalk> VectorMap::findByForeignKey<SideWalk>(const std::string& field, int id) const;
+template <>
+std::vector<DriveOnPortion> VectorMap::findByForeignKey<DriveOnPortion>(const std::string& field, int id) const;
+template <>
+std::vector<CrossRoad> VectorMap::findByForeignKey<CrossRoad>(const std::string& field, int id) const;
+template <>
+std::vector<SideStrip> VectorMap::findByForeignKey<SideStrip>(const std::string& field, int id) const;
+template <>
+std::vector<CurveMirror> VectorMap::findByForeignKey<CurveMirror>(const std::string& field, int id) const;
+template <>
+std::vector<Wall> VectorMap::findByForeignKey<Wall>(const std::string& field, int id) const;
+template <>
+std::vector<Fence> VectorMap::findByForeignKey<Fence>(const std::string& field, int id) const;
+template <>
+std::vector<RailCrossing> VectorMap::findByForeignKey<RailCrossing>(const std::string& field, int id) const;
+template <>
+std::vector<Point> VectorMap::findNear<Point>(const geometry_msgs::Point& position, double radius) const;
+template <>
+std::vector<Lane> VectorMap::findNear<Lane>(const geometry_msgs::Point& position, double radius) const;
+template <>
+std::vector<Area> VectorMap::findNear<Area>(const geometry_msgs::Point& position, double radius) const;
+template <>
+std::vector<Signal> VectorMap::findNear<Signal>(const geometry_msgs::Point& position, double radius) const;
+
 extern const double COLOR_VALUE_MIN;
 extern const double COLOR_VALUE_MAX;
 extern const double COLOR_VALUE_MEDIAN;
@@ -0,0 +1,445 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector_map/csv_reader.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+namespace vector_map
+{
+namespace
+{
+const char CACHE_MAGIC[8] = { 'V', 'M', 'C', 'A', 'C', 'H', 'E', '1' };
+
+struct CacheHeader
+{
+  char magic[8];
+  uint64_t csv_size;
+  int64_t csv_mtime_sec;
+  int64_t csv_mtime_nsec;
+  char md5sum[32];
+  uint64_t payload_size;
+  uint64_t payload_hash;
+};
+
+// powers of ten exactly representable by double
+const double POW10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+bool isBlank(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+bool isDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+std::string getCachePath(const std::string& csv_file, const std::string& cache_name)
+{
+  std::string::size_type slash = csv_file.find_last_of('/');
+  if (slash == std::string::npos)
+    return "." + csv_file + "." + cache_name;
+  return csv_file.substr(0, slash + 1) + "." + csv_file.substr(slash + 1) + "." + cache_name;
+}
+
+bool statCsv(const std::string& csv_file, CacheHeader& header)
+{
+  struct stat st;
+  if (stat(csv_file.c_str(), &st) != 0)
+    return false;
+  header.csv_size = static_cast<uint64_t>(st.st_size);
+  header.csv_mtime_sec = static_cast<int64_t>(st.st_mtim.tv_sec);
+  header.csv_mtime_nsec = static_cast<int64_t>(st.st_mtim.tv_nsec);
+  return true;
+}
+
+void copyMd5sum(const std::string& md5sum, char* dst)
+{
+  std::memset(dst, 0, sizeof(CacheHeader::md5sum));
+  std::memcpy(dst, md5sum.data(), std::min(md5sum.size(), sizeof(CacheHeader::md5sum)));
+}
+
+uint64_t hashPayload(const std::vector<uint8_t>& payload)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= payload.size(); i += sizeof(uint64_t))
+  {
+    uint64_t word;
+    std::memcpy(&word, &payload[i], sizeof(word));
+    hash = (hash ^ word) * 1099511628211ULL;
+  }
+  for (; i < payload.size(); ++i)
+    hash = (hash ^ payload[i]) * 1099511628211ULL;
+  return hash;
+}
+
+// Fallback for the inputs the fast path does not handle exactly (long mantissa, large exponent, inf, nan, hex).
+double parseDoubleSlow(const char* begin, const char* end)
+{
+  char buffer[128];
+  size_t length = static_cast<size_t>(end - begin);
+  if (length < sizeof(buffer))
+  {
+    std::memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+    return std::strtod(buffer, nullptr);
+  }
+  return std::strtod(std::string(begin, end).c_str(), nullptr);
+}
+}  // namespace
+
+MappedFile::MappedFile() : data_(nullptr), size_(0), mapped_(false)
+{
+}
+
+MappedFile::MappedFile(const std::string& file_path) : MappedFile()
+{
+  open(file_path);
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+bool MappedFile::open(const std::string& file_path)
+{
+  close();
+
+  int fd = ::open(file_path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+  {
+    if (st.st_size == 0)
+    {
+      ::close(fd);
+      data_ = "";
+      return true;
+    }
+    void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED)
+    {
+      madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+      ::close(fd);
+      data_ = static_cast<const char*>(addr);
+      size_ = static_cast<size_t>(st.st_size);
+      mapped_ = true;
+      return true;
+    }
+  }
+  ::close(fd);
+
+  // pipes, special files or mmap failure
+  std::ifstream ifs(file_path.c_str(), std::ios::binary);
+  if (!ifs)
+    return false;
+  buffer_.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+  buffer_.push_back('\0');
+  data_ = buffer_.data();
+  size_ = buffer_.size() - 1;
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (mapped_)
+    munmap(const_cast<char*>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+  mapped_ = false;
+  std::vector<char>().swap(buffer_);
+}
+
+bool parseInt(const char* begin, const char* end, int& value)
+{
+  const char* p = begin;
+  while (p < end && isBlank(*p))
+    ++p;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
+  if (p == end || !isDigit(*p))
+    return false;
+
+  int64_t result = 0;
+  constexpr int64_t limit = static_cast<int64_t>(std::numeric_limits<int>::max()) + 1;
+  for (; p < end && isDigit(*p); ++p)
+  {
+    result = result * 10 + (*p - '0');
+    if (result > limit)
+      result = limit;
+  }
+  if (negative)
+    result = -result;
+  if (result > std::numeric_limits<int>::max())
+    result = std::numeric_limits<int>::max();
+  value = static_cast<int>(result);
+  return true;
+}
+
+bool parseDouble(const char* begin, const char* end, double& value)
+{
+  const char* p = begin;
+  while (p < end && isBlank(*p))
+    ++p;
+  const char* start = p;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
+
+  // Clinger's fast path: mantissa below 2^53 and |exponent| <= 22 is rounded correctly by a single multiplication
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool any_digit = false;
+  for (; p < end && isDigit(*p); ++p)
+  {
+    any_digit = true;
+    if (mantissa == 0 && *p == '0')
+      continue;
+    if (digits < 19)
+      mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+    else
+      ++exponent;
+    ++digits;
+  }
+  if (p < end && *p == '.')
+  {
+    ++p;
+    for (; p < end && isDigit(*p); ++p)
+    {
+      any_digit = true;
+      if (mantissa == 0 && *p == '0')
+      {
+        --exponent;
+        continue;
+      }
+      if (digits < 19)
+      {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        --exponent;
+      }
+      ++digits;
+    }
+  }
+  if (!any_digit)
+  {
+    // inf, nan, ".e1" and other oddities
+    const char* q = start;
+    if (q < end && (*q == '-' || *q == '+'))
+      ++q;
+    if (q < end && (*q == 'i' || *q == 'I' || *q == 'n' || *q == 'N'))
+    {
+      value = parseDoubleSlow(start, end);
+      return true;
+    }
+    return false;
+  }
+  if (p < end && (*p == 'e' || *p == 'E'))
+  {
+    const char* q = p + 1;
+    bool exponent_negative = false;
+    if (q < end && (*q == '-' || *q == '+'))
+    {
+      exponent_negative = (*q == '-');
+      ++q;
+    }
+    if (q < end && isDigit(*q))
+    {
+      int e = 0;
+      for (; q < end && isDigit(*q); ++q)
+      {
+        if (e < 100000)
+          e = e * 10 + (*q - '0');
+      }
+      exponent += exponent_negative ? -e : e;
+      p = q;
+    }
+  }
+  if (p < end && (*p == 'x' || *p == 'X'))
+  {
+    value = parseDoubleSlow(start, end);
+    return true;
+  }
+
+  if (digits > 19 || mantissa > (uint64_t(1) << 53) || exponent < -22 || exponent > 22)
+  {
+    value = parseDoubleSlow(start, p);
+    return true;
+  }
+  double result = static_cast<double>(mantissa);
+  result = exponent < 0 ? result / POW10[-exponent] : result * POW10[exponent];
+  value = negative ? -result : result;
+  return true;
+}
+
+void CsvRow::split(const char* begin, const char* end, char separator)
+{
+  size_ = 0;
+  const char* column = begin;
+  for (const char* p = begin; p < end; ++p)
+  {
+    if (*p != separator)
+      continue;
+    if (size_ < MAX_COLUMNS)
+    {
+      begins_[size_] = column;
+      ends_[size_] = p;
+      ++size_;
+    }
+    column = p + 1;
+  }
+  if (column < end && size_ < MAX_COLUMNS)
+  {
+    begins_[size_] = column;
+    ends_[size_] = end;
+    ++size_;
+  }
+}
+
+int CsvRow::getInt(size_t i) const
+{
+  int value = 0;
+  if (i < size_)
+    parseInt(begins_[i], ends_[i], value);
+  return value;
+}
+
+double CsvRow::getDouble(size_t i) const
+{
+  double value = 0;
+  if (i < size_)
+    parseDouble(begins_[i], ends_[i], value);
+  return value;
+}
+
+char CsvRow::getChar(size_t i) const
+{
+  if (i >= size_ || begins_[i] == ends_[i])
+    return '\0';
+  return *begins_[i];
+}
+
+std::string CsvRow::getString(size_t i) const
+{
+  if (i >= size_)
+    return std::string();
+  return std::string(begins_[i], ends_[i]);
+}
+
+bool CsvReader::nextLine(const char*& begin, const char*& end)
+{
+  if (pos_ >= end_)
+    return false;
+  begin = pos_;
+  const char* newline = static_cast<const char*>(std::memchr(pos_, '\n', static_cast<size_t>(end_ - pos_)));
+  end = newline ? newline : end_;
+  pos_ = newline ? newline + 1 : end_;
+  if (end > begin && *(end - 1) == '\r')
+    --end;
+  return true;
+}
+
+bool CsvReader::nextRow(CsvRow& row, char separator)
+{
+  const char* begin;
+  const char* end;
+  if (!nextLine(begin, end))
+    return false;
+  row.split(begin, end, separator);
+  return true;
+}
+
+bool readCsvCache(const std::string& csv_file, const std::string& md5sum, std::vector<uint8_t>& payload,
+                  const std::string& cache_name)
+{
+  CacheHeader expected;
+  if (!statCsv(csv_file, expected))
+    return false;
+  copyMd5sum(md5sum, expected.md5sum);
+
+  std::FILE* fp = std::fopen(getCachePath(csv_file, cache_name).c_str(), "rb");
+  if (fp == nullptr)
+    return false;
+  CacheHeader header;
+  bool ok = std::fread(&header, sizeof(header), 1, fp) == 1 &&
+            std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+            header.csv_size == expected.csv_size && header.csv_mtime_sec == expected.csv_mtime_sec &&
+            header.csv_mtime_nsec == expected.csv_mtime_nsec &&
+            std::memcmp(header.md5sum, expected.md5sum, sizeof(header.md5sum)) == 0;
+  if (ok)
+  {
+    payload.resize(header.payload_size);
+    ok = header.payload_size == 0 || std::fread(payload.data(), header.payload_size, 1, fp) == 1;
+    ok = ok && hashPayload(payload) == header.payload_hash;
+  }
+  std::fclose(fp);
+  if (!ok)
+    payload.clear();
+  return ok;
+}
+
+bool writeCsvCache(const std::string& csv_file, const std::string& md5sum, const std::vector<uint8_t>& payload,
+                   const std::string& cache_name)
+{
+  CacheHeader header;
+  if (!statCsv(csv_file, header))
+    return false;
+  std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  copyMd5sum(md5sum, header.md5sum);
+  header.payload_size = payload.size();
+  header.payload_hash = hashPayload(payload);
+
+  // write a temporary file and rename it, so concurrent readers never see a partial cache
+  std::string cache_path = getCachePath(csv_file, cache_name);
+  std::string tmp_path = cache_path + "." + std::to_string(getpid()) + ".tmp";
+  std::FILE* fp = std::fopen(tmp_path.c_str(), "wb");
+  if (fp == nullptr)
+    return false;
+  bool ok = std::fwrite(&header, sizeof(header), 1, fp) == 1 &&
+            (payload.empty() || std::fwrite(payload.data(), payload.size(), 1, fp) == 1);
+  ok = (std::fclose(fp) == 0) && ok;
+  if (!ok || std::rename(tmp_path.c_str(), cache_path.c_str()) != 0)
+  {
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+}  // namespace vector_map
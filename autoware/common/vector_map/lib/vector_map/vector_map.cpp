@@ -17,8 +17,13 @@
 #include <tf/transform_datatypes.h>
 #include <vector_map/vector_map.h>
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iterator>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace vector_map
@@ -378,6 +383,128 @@ void updateRailCrossing(std::map<Key<RailCrossing>, RailCrossing>& map, const Ra
 }
 }  // namespace
 
+SpatialGrid::SpatialGrid()
+  : cell_size_(1.0), closed_(false)
+{
+}
+
+uint64_t SpatialGrid::computeCellKey(int ix, int iy) const
+{
+  return (static_cast<uint64_t>(static_cast<uint32_t>(ix)) << 32) | static_cast<uint32_t>(iy);
+}
+
+double SpatialGrid::computeDistance(size_t index, double x, double y) const
+{
+  const auto& shape = shapes_[index];
+  if (shape.size() == 1)
+    return std::hypot(shape[0].x - x, shape[0].y - y);
+
+  double min_distance = DBL_MAX;
+  bool inside = false;
+  size_t n = closed_ ? shape.size() : shape.size() - 1;
+  for (size_t i = 0; i < n; ++i)
+  {
+    const geometry_msgs::Point& a = shape[i];
+    const geometry_msgs::Point& b = shape[(i + 1) % shape.size()];
+    double dx = b.x - a.x;
+    double dy = b.y - a.y;
+    double length2 = dx * dx + dy * dy;
+    double t = (length2 > 0) ? ((x - a.x) * dx + (y - a.y) * dy) / length2 : 0;
+    t = std::max(0.0, std::min(1.0, t));
+    min_distance = std::min(min_distance, std::hypot(a.x + t * dx - x, a.y + t * dy - y));
+    if (closed_ && ((a.y > y) != (b.y > y)) && (x < a.x + (y - a.y) * dx / dy))
+      inside = !inside;
+  }
+  return inside ? 0 : min_distance;
+}
+
+void SpatialGrid::clear(double cell_size, bool closed)
+{
+  cell_size_ = cell_size;
+  closed_ = closed;
+  cells_.clear();
+  ids_.clear();
+  shapes_.clear();
+}
+
+void SpatialGrid::insert(int id, const std::vector<geometry_msgs::Point>& shape)
+{
+  if (shape.empty())
+    return;
+
+  double min_x = DBL_MAX, min_y = DBL_MAX, max_x = -DBL_MAX, max_y = -DBL_MAX;
+  for (const auto& p : shape)
+  {
+    min_x = std::min(min_x, p.x);
+    min_y = std::min(min_y, p.y);
+    max_x = std::max(max_x, p.x);
+    max_y = std::max(max_y, p.y);
+  }
+
+  size_t index = ids_.size();
+  ids_.push_back(id);
+  shapes_.push_back(shape);
+  for (int ix = std::floor(min_x / cell_size_); ix <= std::floor(max_x / cell_size_); ++ix)
+  {
+    for (int iy = std::floor(min_y / cell_size_); iy <= std::floor(max_y / cell_size_); ++iy)
+      cells_[computeCellKey(ix, iy)].push_back(index);
+  }
+}
+
+std::vector<int> SpatialGrid::query(double x, double y, double radius) const
+{
+  std::vector<std::pair<double, size_t>> candidates;
+  int min_ix = std::floor((x - radius) / cell_size_);
+  int max_ix = std::floor((x + radius) / cell_size_);
+  int min_iy = std::floor((y - radius) / cell_size_);
+  int max_iy = std::floor((y + radius) / cell_size_);
+  double num_cells = static_cast<double>(max_ix - min_ix + 1) * (max_iy - min_iy + 1);
+
+  if (num_cells > cells_.size())  // query covers the whole map
+  {
+    for (size_t i = 0; i < ids_.size(); ++i)
+      candidates.push_back(std::make_pair(0.0, i));
+  }
+  else
+  {
+    for (int ix = min_ix; ix <= max_ix; ++ix)
+    {
+      for (int iy = min_iy; iy <= max_iy; ++iy)
+      {
+        auto cell = cells_.find(computeCellKey(ix, iy));
+        if (cell == cells_.end())
+          continue;
+        for (size_t i : cell->second)
+          candidates.push_back(std::make_pair(0.0, i));
+      }
+    }
+    // objects spanning several cells
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) { return a.second < b.second; });
+    candidates.erase(std::unique(candidates.begin(), candidates.end(),
+                                 [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b)
+                                 { return a.second == b.second; }),
+                     candidates.end());
+  }
+
+  std::vector<std::pair<double, size_t>> near;
+  for (const auto& candidate : candidates)
+  {
+    double distance = computeDistance(candidate.second, x, y);
+    if (distance <= radius)
+      near.push_back(std::make_pair(distance, candidate.second));
+  }
+  std::stable_sort(near.begin(), near.end(),
+                   [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b)
+                   { return a.first < b.first; });
+
+  std::vector<int> ids;
+  ids.reserve(near.size());
+  for (const auto& n : near)
+    ids.push_back(ids_[n.second]);
+  return ids;
+}
+
 bool VectorMap::hasSubscribed(category_t category) const
 {
   if (category & POINT)
@@ -709,6 +836,110 @@ void VectorMap::registerSubscriber(ros::NodeHandle& nh, category_t category)
 
 VectorMap::VectorMap()
 {
+  registerIndexes();
+}
+
+void VectorMap::registerIndexes()
+{
+  node_.registerForeignKey("pid", [](const Node& node) { return node.pid; });
+  lane_.registerForeignKey("bnid", [](const Lane& lane) { return lane.bnid; });
+  lane_.registerForeignKey("fnid", [](const Lane& lane) { return lane.fnid; });
+  lane_.registerForeignKey("blid", [](const Lane& lane) { return lane.blid; });
+  lane_.registerForeignKey("flid", [](const Lane& lane) { return lane.flid; });
+  line_.registerForeignKey("bpid", [](const Line& line) { return line.bpid; });
+  line_.registerForeignKey("fpid", [](const Line& line) { return line.fpid; });
+  way_area_.registerForeignKey("aid", [](const WayArea& way_area) { return way_area.aid; });
+  vector_.registerForeignKey("pid", [](const Vector& vector) { return vector.pid; });
+  signal_.registerForeignKey("vid", [](const Signal& signal) { return signal.vid; });
+  signal_.registerForeignKey("plid", [](const Signal& signal) { return signal.plid; });
+  road_edge_.registerForeignKey("linkid", [](const RoadEdge& item) { return item.linkid; });
+  gutter_.registerForeignKey("linkid", [](const Gutter& item) { return item.linkid; });
+  curb_.registerForeignKey("linkid", [](const Curb& item) { return item.linkid; });
+  white_line_.registerForeignKey("linkid", [](const WhiteLine& item) { return item.linkid; });
+  stop_line_.registerForeignKey("linkid", [](const StopLine& item) { return item.linkid; });
+  zebra_zone_.registerForeignKey("linkid", [](const ZebraZone& item) { return item.linkid; });
+  cross_walk_.registerForeignKey("linkid", [](const CrossWalk& item) { return item.linkid; });
+  road_mark_.registerForeignKey("linkid", [](const RoadMark& item) { return item.linkid; });
+  road_pole_.registerForeignKey("linkid", [](const RoadPole& item) { return item.linkid; });
+  road_sign_.registerForeignKey("linkid", [](const RoadSign& item) { return item.linkid; });
+  signal_.registerForeignKey("linkid", [](const Signal& item) { return item.linkid; });
+  street_light_.registerForeignKey("linkid", [](const StreetLight& item) { return item.linkid; });
+  utility_pole_.registerForeignKey("linkid", [](const UtilityPole& item) { return item.linkid; });
+  guard_rail_.registerForeignKey("linkid", [](const GuardRail& item) { return item.linkid; });
+  side_walk_.registerForeignKey("linkid", [](const SideWalk& item) { return item.linkid; });
+  drive_on_portion_.registerForeignKey("linkid", [](const DriveOnPortion& item) { return item.linkid; });
+  cross_road_.registerForeignKey("linkid", [](const CrossRoad& item) { return item.linkid; });
+  side_strip_.registerForeignKey("linkid", [](const SideStrip& item) { return item.linkid; });
+  curve_mirror_.registerForeignKey("linkid", [](const CurveMirror& item) { return item.linkid; });
+  wall_.registerForeignKey("linkid", [](const Wall& item) { return item.linkid; });
+  fence_.registerForeignKey("linkid", [](const Fence& item) { return item.linkid; });
+  rail_crossing_.registerForeignKey("linkid", [](const RailCrossing& item) { return item.linkid; });
+
+  point_.registerLocator([this](const Point& point) { return locatePoint(point); }, 10.0, false);
+  lane_.registerLocator([this](const Lane& lane) { return locateLane(lane); }, 10.0, false);
+  area_.registerLocator([this](const Area& area) { return locateArea(area); }, 20.0, true);
+  signal_.registerLocator([this](const Signal& signal) { return locateSignal(signal); }, 10.0, false);
+
+  // shapes of lanes, areas and signals are resolved through other categories
+  point_.registerDependent([this]()
+    {
+      lane_.rebuildSpatialIndex();
+      area_.rebuildSpatialIndex();
+      signal_.rebuildSpatialIndex();
+    });
+  node_.registerDependent([this]() { lane_.rebuildSpatialIndex(); });
+  line_.registerDependent([this]() { area_.rebuildSpatialIndex(); });
+  vector_.registerDependent([this]() { signal_.rebuildSpatialIndex(); });
+}
+
+std::vector<geometry_msgs::Point> VectorMap::locatePoint(const Point& point) const
+{
+  return std::vector<geometry_msgs::Point>(1, convertPointToGeomPoint(point));
+}
+
+std::vector<geometry_msgs::Point> VectorMap::locateLane(const Lane& lane) const
+{
+  std::vector<geometry_msgs::Point> shape;
+  Point bp = findByKey(Key<Point>(findByKey(Key<Node>(lane.bnid)).pid));
+  Point fp = findByKey(Key<Point>(findByKey(Key<Node>(lane.fnid)).pid));
+  if (bp.pid == 0 || fp.pid == 0)
+    return shape;
+  shape.push_back(convertPointToGeomPoint(bp));
+  shape.push_back(convertPointToGeomPoint(fp));
+  return shape;
+}
+
+std::vector<geometry_msgs::Point> VectorMap::locateArea(const Area& area) const
+{
+  const size_t line_size_guard = 100000;  // cyclic line list
+  std::vector<geometry_msgs::Point> shape;
+  Line line = findByKey(Key<Line>(area.slid));
+  while (line.lid != 0 && shape.size() <= line_size_guard)
+  {
+    Point bp = findByKey(Key<Point>(line.bpid));
+    if (bp.pid == 0)
+      return std::vector<geometry_msgs::Point>();
+    shape.push_back(convertPointToGeomPoint(bp));
+    if (line.flid == 0)
+    {
+      Point fp = findByKey(Key<Point>(line.fpid));
+      if (fp.pid == 0)
+        return std::vector<geometry_msgs::Point>();
+      shape.push_back(convertPointToGeomPoint(fp));
+      break;
+    }
+    line = findByKey(Key<Line>(line.flid));
+  }
+  return shape;
+}
+
+std::vector<geometry_msgs::Point> VectorMap::locateSignal(const Signal& signal) const
+{
+  std::vector<geometry_msgs::Point> shape;
+  Point point = findByKey(Key<Point>(findByKey(Key<Vector>(signal.vid)).pid));
+  if (point.pid != 0)
+    shape.push_back(convertPointToGeomPoint(point));
+  return shape;
 }
 
 void VectorMap::subscribe(ros::NodeHandle& nh, category_t category)
@@ -1066,6 +1297,192 @@ std::vector<RailCrossing> VectorMap::findByFilter(const Filter<RailCrossing>& fi
   return rail_crossing_.findByFilter(filter);
 }
 
+template <>
+std::vector<Node> VectorMap::findByForeignKey<Node>(const std::string& field, int id) const
+{
+  return node_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<Lane> VectorMap::findByForeignKey<Lane>(const std::string& field, int id) const
+{
+  return lane_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<Line> VectorMap::findByForeignKey<Line>(const std::string& field, int id) const
+{
+  return line_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<WayArea> VectorMap::findByForeignKey<WayArea>(const std::string& field, int id) const
+{
+  return way_area_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<Vector> VectorMap::findByForeignKey<Vector>(const std::string& field, int id) const
+{
+  return vector_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<RoadEdge> VectorMap::findByForeignKey<RoadEdge>(const std::string& field, int id) const
+{
+  return road_edge_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<Gutter> VectorMap::findByForeignKey<Gutter>(const std::string& field, int id) const
+{
+  return gutter_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<Curb> VectorMap::findByForeignKey<Curb>(const std::string& field, int id) const
+{
+  return curb_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<WhiteLine> VectorMap::findByForeignKey<WhiteLine>(const std::string& field, int id) const
+{
+  return white_line_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<StopLine> VectorMap::findByForeignKey<StopLine>(const std::string& field, int id) const
+{
+  return stop_line_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<ZebraZone> VectorMap::findByForeignKey<ZebraZone>(const std::string& field, int id) const
+{
+  return zebra_zone_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<CrossWalk> VectorMap::findByForeignKey<CrossWalk>(const std::string& field, int id) const
+{
+  return cross_walk_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<RoadMark> VectorMap::findByForeignKey<RoadMark>(const std::string& field, int id) const
+{
+  return road_mark_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<RoadPole> VectorMap::findByForeignKey<RoadPole>(const std::string& field, int id) const
+{
+  return road_pole_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<RoadSign> VectorMap::findByForeignKey<RoadSign>(const std::string& field, int id) const
+{
+  return road_sign_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<Signal> VectorMap::findByForeignKey<Signal>(const std::string& field, int id) const
+{
+  return signal_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<StreetLight> VectorMap::findByForeignKey<StreetLight>(const std::string& field, int id) const
+{
+  return street_light_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<UtilityPole> VectorMap::findByForeignKey<UtilityPole>(const std::string& field, int id) const
+{
+  return utility_pole_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<GuardRail> VectorMap::findByForeignKey<GuardRail>(const std::string& field, int id) const
+{
+  return guard_rail_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<SideWalk> VectorMap::findByForeignKey<SideWalk>(const std::string& field, int id) const
+{
+  return side_walk_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<DriveOnPortion> VectorMap::findByForeignKey<DriveOnPortion>(const std::string& field, int id) const
+{
+  return drive_on_portion_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<CrossRoad> VectorMap::findByForeignKey<CrossRoad>(const std::string& field, int id) const
+{
+  return cross_road_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<SideStrip> VectorMap::findByForeignKey<SideStrip>(const std::string& field, int id) const
+{
+  return side_strip_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<CurveMirror> VectorMap::findByForeignKey<CurveMirror>(const std::string& field, int id) const
+{
+  return curve_mirror_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<Wall> VectorMap::findByForeignKey<Wall>(const std::string& field, int id) const
+{
+  return wall_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<Fence> VectorMap::findByForeignKey<Fence>(const std::string& field, int id) const
+{
+  return fence_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<RailCrossing> VectorMap::findByForeignKey<RailCrossing>(const std::string& field, int id) const
+{
+  return rail_crossing_.findByForeignKey(field, id);
+}
+
+template <>
+std::vector<Point> VectorMap::findNear<Point>(const geometry_msgs::Point& position, double radius) const
+{
+  return point_.findNear(position, radius);
+}
+
+template <>
+std::vector<Lane> VectorMap::findNear<Lane>(const geometry_msgs::Point& position, double radius) const
+{
+  return lane_.findNear(position, radius);
+}
+
+template <>
+std::vector<Area> VectorMap::findNear<Area>(const geometry_msgs::Point& position, double radius) const
+{
+  return area_.findNear(position, radius);
+}
+
+template <>
+std::vector<Signal> VectorMap::findNear<Signal>(const geometry_msgs::Point& position, double radius) const
+{
+  return signal_.findNear(position, radius);
+}
+
 void VectorMap::registerCallback(const Callback<PointArray>& cb)
 {
   point_.registerCallback(cb);
@@ -1630,6 +2047,290 @@ Vector convertGeomQuaternionToVector(const geometry_msgs::Quaternion& geom_quate
   vector.hang = -convertRadianToDegree(yaw) + 90;
   return vector;
 }
+
+void parseCsvRow(const CsvRow& row, Point& obj)
+{
+  obj.pid = row.getInt(0);
+  obj.b = row.getDouble(1);
+  obj.l = row.getDouble(2);
+  obj.h = row.getDouble(3);
+  obj.bx = row.getDouble(4);
+  obj.ly = row.getDouble(5);
+  obj.ref = row.getInt(6);
+  obj.mcode1 = row.getInt(7);
+  obj.mcode2 = row.getInt(8);
+  obj.mcode3 = row.getInt(9);
+}
+
+void parseCsvRow(const CsvRow& row, Vector& obj)
+{
+  obj.vid = row.getInt(0);
+  obj.pid = row.getInt(1);
+  obj.hang = row.getDouble(2);
+  obj.vang = row.getDouble(3);
+}
+
+void parseCsvRow(const CsvRow& row, Line& obj)
+{
+  obj.lid = row.getInt(0);
+  obj.bpid = row.getInt(1);
+  obj.fpid = row.getInt(2);
+  obj.blid = row.getInt(3);
+  obj.flid = row.getInt(4);
+}
+
+void parseCsvRow(const CsvRow& row, Area& obj)
+{
+  obj.aid = row.getInt(0);
+  obj.slid = row.getInt(1);
+  obj.elid = row.getInt(2);
+}
+
+void parseCsvRow(const CsvRow& row, Pole& obj)
+{
+  obj.plid = row.getInt(0);
+  obj.vid = row.getInt(1);
+  obj.length = row.getDouble(2);
+  obj.dim = row.getDouble(3);
+}
+
+void parseCsvRow(const CsvRow& row, Box& obj)
+{
+  obj.bid = row.getInt(0);
+  obj.pid1 = row.getInt(1);
+  obj.pid2 = row.getInt(2);
+  obj.pid3 = row.getInt(3);
+  obj.pid4 = row.getInt(4);
+  obj.height = row.getDouble(5);
+}
+
+void parseCsvRow(const CsvRow& row, DTLane& obj)
+{
+  obj.did = row.getInt(0);
+  obj.dist = row.getDouble(1);
+  obj.pid = row.getInt(2);
+  obj.dir = row.getDouble(3);
+  obj.apara = row.getDouble(4);
+  obj.r = row.getDouble(5);
+  obj.slope = row.getDouble(6);
+  obj.cant = row.getDouble(7);
+  obj.lw = row.getDouble(8);
+  obj.rw = row.getDouble(9);
+}
+
+void parseCsvRow(const CsvRow& row, Node& obj)
+{
+  obj.nid = row.getInt(0);
+  obj.pid = row.getInt(1);
+}
+
+void parseCsvRow(const CsvRow& row, Lane& obj)
+{
+  // old format lane.csv has 17 or 22 columns, missing columns are read as 0
+  obj.lnid = row.getInt(0);
+  obj.did = row.getInt(1);
+  obj.blid = row.getInt(2);
+  obj.flid = row.getInt(3);
+  obj.bnid = row.getInt(4);
+  obj.fnid = row.getInt(5);
+  obj.jct = row.getInt(6);
+  obj.blid2 = row.getInt(7);
+  obj.blid3 = row.getInt(8);
+  obj.blid4 = row.getInt(9);
+  obj.flid2 = row.getInt(10);
+  obj.flid3 = row.getInt(11);
+  obj.flid4 = row.getInt(12);
+  obj.clossid = row.getInt(13);
+  obj.span = row.getDouble(14);
+  obj.lcnt = row.getInt(15);
+  obj.lno = row.getInt(16);
+  obj.lanetype = row.getInt(17);
+  obj.limitvel = row.getInt(18);
+  obj.refvel = row.getInt(19);
+  obj.roadsecid = row.getInt(20);
+  obj.lanecfgfg = row.getInt(21);
+  obj.linkwaid = row.getInt(22);
+}
+
+void parseCsvRow(const CsvRow& row, WayArea& obj)
+{
+  obj.waid = row.getInt(0);
+  obj.aid = row.getInt(1);
+}
+
+void parseCsvRow(const CsvRow& row, RoadEdge& obj)
+{
+  obj.id = row.getInt(0);
+  obj.lid = row.getInt(1);
+  obj.linkid = row.getInt(2);
+}
+
+void parseCsvRow(const CsvRow& row, Gutter& obj)
+{
+  obj.id = row.getInt(0);
+  obj.aid = row.getInt(1);
+  obj.type = row.getInt(2);
+  obj.linkid = row.getInt(3);
+}
+
+void parseCsvRow(const CsvRow& row, Curb& obj)
+{
+  obj.id = row.getInt(0);
+  obj.lid = row.getInt(1);
+  obj.height = row.getDouble(2);
+  obj.width = row.getDouble(3);
+  obj.dir = row.getInt(4);
+  obj.linkid = row.getInt(5);
+}
+
+void parseCsvRow(const CsvRow& row, WhiteLine& obj)
+{
+  obj.id = row.getInt(0);
+  obj.lid = row.getInt(1);
+  obj.width = row.getDouble(2);
+  obj.color = row.getChar(3);
+  obj.type = row.getInt(4);
+  obj.linkid = row.getInt(5);
+}
+
+void parseCsvRow(const CsvRow& row, StopLine& obj)
+{
+  obj.id = row.getInt(0);
+  obj.lid = row.getInt(1);
+  obj.tlid = row.getInt(2);
+  obj.signid = row.getInt(3);
+  obj.linkid = row.getInt(4);
+}
+
+void parseCsvRow(const CsvRow& row, ZebraZone& obj)
+{
+  obj.id = row.getInt(0);
+  obj.aid = row.getInt(1);
+  obj.linkid = row.getInt(2);
+}
+
+void parseCsvRow(const CsvRow& row, CrossWalk& obj)
+{
+  obj.id = row.getInt(0);
+  obj.aid = row.getInt(1);
+  obj.type = row.getInt(2);
+  obj.bdid = row.getInt(3);
+  obj.linkid = row.getInt(4);
+}
+
+void parseCsvRow(const CsvRow& row, RoadMark& obj)
+{
+  obj.id = row.getInt(0);
+  obj.aid = row.getInt(1);
+  obj.type = row.getInt(2);
+  obj.linkid = row.getInt(3);
+}
+
+void parseCsvRow(const CsvRow& row, RoadPole& obj)
+{
+  obj.id = row.getInt(0);
+  obj.plid = row.getInt(1);
+  obj.linkid = row.getInt(2);
+}
+
+void parseCsvRow(const CsvRow& row, RoadSign& obj)
+{
+  obj.id = row.getInt(0);
+  obj.vid = row.getInt(1);
+  obj.plid = row.getInt(2);
+  obj.type = row.getInt(3);
+  obj.linkid = row.getInt(4);
+}
+
+void parseCsvRow(const CsvRow& row, Signal& obj)
+{
+  obj.id = row.getInt(0);
+  obj.vid = row.getInt(1);
+  obj.plid = row.getInt(2);
+  obj.type = row.getInt(3);
+  obj.linkid = row.getInt(4);
+}
+
+void parseCsvRow(const CsvRow& row, StreetLight& obj)
+{
+  obj.id = row.getInt(0);
+  obj.lid = row.getInt(1);
+  obj.plid = row.getInt(2);
+  obj.linkid = row.getInt(3);
+}
+
+void parseCsvRow(const CsvRow& row, UtilityPole& obj)
+{
+  obj.id = row.getInt(0);
+  obj.plid = row.getInt(1);
+  obj.linkid = row.getInt(2);
+}
+
+void parseCsvRow(const CsvRow& row, GuardRail& obj)
+{
+  obj.id = row.getInt(0);
+  obj.aid = row.getInt(1);
+  obj.type = row.getInt(2);
+  obj.linkid = row.getInt(3);
+}
+
+void parseCsvRow(const CsvRow& row, SideWalk& obj)
+{
+  obj.id = row.getInt(0);
+  obj.aid = row.getInt(1);
+  obj.linkid = row.getInt(2);
+}
+
+void parseCsvRow(const CsvRow& row, DriveOnPortion& obj)
+{
+  obj.id = row.getInt(0);
+  obj.aid = row.getInt(1);
+  obj.linkid = row.getInt(2);
+}
+
+void parseCsvRow(const CsvRow& row, CrossRoad& obj)
+{
+  obj.id = row.getInt(0);
+  obj.aid = row.getInt(1);
+  obj.linkid = row.getInt(2);
+}
+
+void parseCsvRow(const CsvRow& row, SideStrip& obj)
+{
+  obj.id = row.getInt(0);
+  obj.lid = row.getInt(1);
+  obj.linkid = row.getInt(2);
+}
+
+void parseCsvRow(const CsvRow& row, CurveMirror& obj)
+{
+  obj.id = row.getInt(0);
+  obj.vid = row.getInt(1);
+  obj.plid = row.getInt(2);
+  obj.type = row.getInt(3);
+  obj.linkid = row.getInt(4);
+}
+
+void parseCsvRow(const CsvRow& row, Wall& obj)
+{
+  obj.id = row.getInt(0);
+  obj.aid = row.getInt(1);
+  obj.linkid = row.getInt(2);
+}
+
+void parseCsvRow(const CsvRow& row, Fence& obj)
+{
+  obj.id = row.getInt(0);
+  obj.aid = row.getInt(1);
+  obj.linkid = row.getInt(2);
+}
+
+void parseCsvRow(const CsvRow& row, RailCrossing& obj)
+{
+  obj.id = row.getInt(0);
+  obj.aid = row.getInt(1);
+  obj.linkid = row.getInt(2);
+}
 }  // namespace vector_map
 
 std::ostream& operator<<(std::ostream& os, const vector_map::Point& obj)
@@ -1947,526 +2648,176 @@ std::ostream& operator<<(std::ostream& os, const vector_map::RailCrossing& obj)
   return os;
 }
 
-std::istream& operator>>(std::istream& is, vector_map::Point& obj)
+namespace
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.pid = std::stoi(columns[0]);
-  obj.b = std::stod(columns[1]);
-  obj.l = std::stod(columns[2]);
-  obj.h = std::stod(columns[3]);
-  obj.bx = std::stod(columns[4]);
-  obj.ly = std::stod(columns[5]);
-  obj.ref = std::stoi(columns[6]);
-  obj.mcode1 = std::stoi(columns[7]);
-  obj.mcode2 = std::stoi(columns[8]);
-  obj.mcode3 = std::stoi(columns[9]);
+template <class T>
+std::istream& parseCsvStream(std::istream& is, T& obj)
+{
+  std::string line((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+  is.setstate(std::ios::eofbit);
+  vector_map::CsvRow row;
+  row.split(line.data(), line.data() + line.size());
+  vector_map::parseCsvRow(row, obj);
   return is;
 }
+}  // namespace
+
+std::istream& operator>>(std::istream& is, vector_map::Point& obj)
+{
+  return parseCsvStream(is, obj);
+}
 
 std::istream& operator>>(std::istream& is, vector_map::Vector& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.vid = std::stoi(columns[0]);
-  obj.pid = std::stoi(columns[1]);
-  obj.hang = std::stod(columns[2]);
-  obj.vang = std::stod(columns[3]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Line& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.lid = std::stoi(columns[0]);
-  obj.bpid = std::stoi(columns[1]);
-  obj.fpid = std::stoi(columns[2]);
-  obj.blid = std::stoi(columns[3]);
-  obj.flid = std::stoi(columns[4]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Area& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.aid = std::stoi(columns[0]);
-  obj.slid = std::stoi(columns[1]);
-  obj.elid = std::stoi(columns[2]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Pole& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.plid = std::stoi(columns[0]);
-  obj.vid = std::stoi(columns[1]);
-  obj.length = std::stod(columns[2]);
-  obj.dim = std::stod(columns[3]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Box& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.bid = std::stoi(columns[0]);
-  obj.pid1 = std::stoi(columns[1]);
-  obj.pid2 = std::stoi(columns[2]);
-  obj.pid3 = std::stoi(columns[3]);
-  obj.pid4 = std::stoi(columns[4]);
-  obj.height = std::stod(columns[5]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::DTLane& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.did = std::stoi(columns[0]);
-  obj.dist = std::stod(columns[1]);
-  obj.pid = std::stoi(columns[2]);
-  obj.dir = std::stod(columns[3]);
-  obj.apara = std::stod(columns[4]);
-  obj.r = std::stod(columns[5]);
-  obj.slope = std::stod(columns[6]);
-  obj.cant = std::stod(columns[7]);
-  obj.lw = std::stod(columns[8]);
-  obj.rw = std::stod(columns[9]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Node& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.nid = std::stoi(columns[0]);
-  obj.pid = std::stoi(columns[1]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Lane& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  int n = 0;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-    ++n;
-  }
-  obj.lnid = std::stoi(columns[0]);
-  obj.did = std::stoi(columns[1]);
-  obj.blid = std::stoi(columns[2]);
-  obj.flid = std::stoi(columns[3]);
-  obj.bnid = std::stoi(columns[4]);
-  obj.fnid = std::stoi(columns[5]);
-  obj.jct = std::stoi(columns[6]);
-  obj.blid2 = std::stoi(columns[7]);
-  obj.blid3 = std::stoi(columns[8]);
-  obj.blid4 = std::stoi(columns[9]);
-  obj.flid2 = std::stoi(columns[10]);
-  obj.flid3 = std::stoi(columns[11]);
-  obj.flid4 = std::stoi(columns[12]);
-  obj.clossid = std::stoi(columns[13]);
-  obj.span = std::stod(columns[14]);
-  obj.lcnt = std::stoi(columns[15]);
-  obj.lno = std::stoi(columns[16]);
-  if (n == 17)
-  {
-    obj.lanetype = 0;
-    obj.limitvel = 0;
-    obj.refvel = 0;
-    obj.roadsecid = 0;
-    obj.lanecfgfg = 0;
-    obj.linkwaid = 0;
-    return is;
-  }
-  obj.lanetype = std::stoi(columns[17]);
-  obj.limitvel = std::stoi(columns[18]);
-  obj.refvel = std::stoi(columns[19]);
-  obj.roadsecid = std::stoi(columns[20]);
-  obj.lanecfgfg = std::stoi(columns[21]);
-  if (n == 22)
-  {
-    obj.linkwaid = 0;
-    return is;
-  }
-  obj.linkwaid = std::stoi(columns[22]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::WayArea& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.waid = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::RoadEdge& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.lid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Gutter& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.type = std::stoi(columns[2]);
-  obj.linkid = std::stoi(columns[3]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Curb& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.lid = std::stoi(columns[1]);
-  obj.height = std::stod(columns[2]);
-  obj.width = std::stod(columns[3]);
-  obj.dir = std::stoi(columns[4]);
-  obj.linkid = std::stoi(columns[5]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::WhiteLine& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.lid = std::stoi(columns[1]);
-  obj.width = std::stod(columns[2]);
-  obj.color = columns[3].c_str()[0];
-  obj.type = std::stoi(columns[4]);
-  obj.linkid = std::stoi(columns[5]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::StopLine& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.lid = std::stoi(columns[1]);
-  obj.tlid = std::stoi(columns[2]);
-  obj.signid = std::stoi(columns[3]);
-  obj.linkid = std::stoi(columns[4]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::ZebraZone& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::CrossWalk& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.type = std::stoi(columns[2]);
-  obj.bdid = std::stoi(columns[3]);
-  obj.linkid = std::stoi(columns[4]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::RoadMark& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.type = std::stoi(columns[2]);
-  obj.linkid = std::stoi(columns[3]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::RoadPole& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.plid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::RoadSign& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.vid = std::stoi(columns[1]);
-  obj.plid = std::stoi(columns[2]);
-  obj.type = std::stoi(columns[3]);
-  obj.linkid = std::stoi(columns[4]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Signal& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.vid = std::stoi(columns[1]);
-  obj.plid = std::stoi(columns[2]);
-  obj.type = std::stoi(columns[3]);
-  obj.linkid = std::stoi(columns[4]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::StreetLight& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.lid = std::stoi(columns[1]);
-  obj.plid = std::stoi(columns[2]);
-  obj.linkid = std::stoi(columns[3]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::UtilityPole& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.plid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::GuardRail& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.type = std::stoi(columns[2]);
-  obj.linkid = std::stoi(columns[3]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::SideWalk& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::DriveOnPortion& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::CrossRoad& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::SideStrip& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.lid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::CurveMirror& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.vid = std::stoi(columns[1]);
-  obj.plid = std::stoi(columns[2]);
-  obj.type = std::stoi(columns[3]);
-  obj.linkid = std::stoi(columns[4]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Wall& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Fence& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseCsvStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::RailCrossing& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseCsvStream(is, obj);
 }
@@ -0,0 +1,332 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <vector_map/csv_reader.h>
+
+using vector_map::CsvReader;
+using vector_map::CsvRow;
+using vector_map::parseDouble;
+using vector_map::parseInt;
+using vector_map::readCsvCache;
+using vector_map::writeCsvCache;
+
+namespace
+{
+bool parse(const std::string& text, double& value)
+{
+  return parseDouble(text.data(), text.data() + text.size(), value);
+}
+
+bool parse(const std::string& text, int& value)
+{
+  return parseInt(text.data(), text.data() + text.size(), value);
+}
+
+// parseDouble must give the same bits as strtod
+void expectSameAsStrtod(const std::string& text)
+{
+  double expected = std::strtod(text.c_str(), nullptr);
+  double value = -1;
+  ASSERT_TRUE(parse(text, value)) << text;
+  if (std::isnan(expected))
+  {
+    EXPECT_TRUE(std::isnan(value)) << text;
+    return;
+  }
+  EXPECT_EQ(0, std::memcmp(&expected, &value, sizeof(double))) << text << ": " << value << " != " << expected;
+}
+
+void writeFile(const std::string& path, const std::string& content)
+{
+  std::ofstream ofs(path.c_str(), std::ios::binary | std::ios::trunc);
+  ofs << content;
+}
+
+// the cache compares the csv mtime, so set it explicitly instead of relying on the file system clock resolution
+void setMtime(const std::string& path, time_t sec, long nsec)
+{
+  struct timespec times[2];
+  times[0].tv_sec = sec;
+  times[0].tv_nsec = nsec;
+  times[1] = times[0];
+  utimensat(AT_FDCWD, path.c_str(), times, 0);
+}
+}  // namespace
+
+class CsvCacheTest : public ::testing::Test
+{
+protected:
+  std::string dir_;
+  std::string csv_;
+  std::vector<uint8_t> payload_;
+
+  void SetUp() override
+  {
+    char dir[] = "/tmp/vector_map_test_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(dir));
+    dir_ = dir;
+    csv_ = dir_ + "/point.csv";
+    writeFile(csv_, "PID,B,L,H,Bx,Ly,ReF,MCODE1,MCODE2,MCODE3\n1,0,0,0,0,0,0,0,0,0\n");
+    setMtime(csv_, 1500000000, 0);
+    payload_ = { 1, 2, 3, 4, 5 };
+    ASSERT_TRUE(writeCsvCache(csv_, "0123456789abcdef0123456789abcdef", payload_));
+  }
+
+  void TearDown() override
+  {
+    std::remove(csv_.c_str());
+    std::remove((dir_ + "/.point.csv.cache").c_str());
+    std::remove((dir_ + "/.point.csv.other").c_str());
+    rmdir(dir_.c_str());
+  }
+};
+
+TEST(ParseDoubleTest, FastPathMatchesStrtod)
+{
+  const char* inputs[] = { "0", "-0", "1", "0.1", "0.2", "-0.3", "12.5", "3.14159265358979", "42.0000000001",
+                           "-33.123456789", "139.7454316", "35.6585805", "1e22", "1e-22", "9.999e21", "123e-20",
+                           "4503599627370496.5", "9007199254740991", "9007199254740992", ".5", "5.", "+7.25",
+                           "0000000000000000000000012.5", "0.0000000000000000000000125" };
+  for (const char* input : inputs)
+    expectSameAsStrtod(input);
+}
+
+TEST(ParseDoubleTest, SlowPathMatchesStrtod)
+{
+  // beyond the fast path: mantissa above 2^53, exponent beyond 10^22, more than 19 digits
+  const char* inputs[] = { "9007199254740993", "18446744073709551615", "1e23", "1e-23", "8.5e-23",
+                           "12345678901234567890123", "1.2345678901234567890123", "0.30000000000000000000001",
+                           "1.7976931348623157e308", "1e309", "4.9e-324", "2.2250738585072014e-308", "1e-400",
+                           "123456789012345678901234567890e-10", "1E+5", "7e0100", "0x1p3" };
+  for (const char* input : inputs)
+    expectSameAsStrtod(input);
+}
+
+TEST(ParseDoubleTest, InfNan)
+{
+  const char* inputs[] = { "inf", "-inf", "+INF", "infinity", "nan", "-nan", "NaN" };
+  for (const char* input : inputs)
+    expectSameAsStrtod(input);
+}
+
+TEST(ParseDoubleTest, PrefixAndBlanks)
+{
+  double value = 0;
+  ASSERT_TRUE(parse(" \t12.5abc", value));
+  EXPECT_EQ(12.5, value);
+  ASSERT_TRUE(parse("2e", value));
+  EXPECT_EQ(2.0, value);
+  ASSERT_TRUE(parse("3e+", value));
+  EXPECT_EQ(3.0, value);
+
+  // the end pointer bounds the number, a following column is not read
+  const std::string text = "1.25,7";
+  ASSERT_TRUE(parseDouble(text.data(), text.data() + 3, value));
+  EXPECT_EQ(1.2, value);
+}
+
+TEST(ParseDoubleTest, NoDigitsLeavesValue)
+{
+  const char* inputs[] = { "", " ", "-", "+", ".", "-.", "e5", "abc", ",1" };
+  for (const char* input : inputs)
+  {
+    double value = 7;
+    EXPECT_FALSE(parse(input, value)) << input;
+    EXPECT_EQ(7, value) << input;
+  }
+}
+
+TEST(ParseIntTest, Values)
+{
+  int value = 0;
+  ASSERT_TRUE(parse("42", value));
+  EXPECT_EQ(42, value);
+  ASSERT_TRUE(parse("  -17", value));
+  EXPECT_EQ(-17, value);
+  ASSERT_TRUE(parse("+8", value));
+  EXPECT_EQ(8, value);
+  ASSERT_TRUE(parse("12.9", value));
+  EXPECT_EQ(12, value);
+  ASSERT_TRUE(parse("0005x", value));
+  EXPECT_EQ(5, value);
+
+  value = 3;
+  EXPECT_FALSE(parse("", value));
+  EXPECT_FALSE(parse("-", value));
+  EXPECT_FALSE(parse("x1", value));
+  EXPECT_EQ(3, value);
+}
+
+TEST(ParseIntTest, Clamping)
+{
+  int value = 0;
+  ASSERT_TRUE(parse("2147483647", value));
+  EXPECT_EQ(std::numeric_limits<int>::max(), value);
+  ASSERT_TRUE(parse("2147483648", value));
+  EXPECT_EQ(std::numeric_limits<int>::max(), value);
+  ASSERT_TRUE(parse("99999999999999999999999", value));
+  EXPECT_EQ(std::numeric_limits<int>::max(), value);
+  ASSERT_TRUE(parse("-2147483648", value));
+  EXPECT_EQ(std::numeric_limits<int>::min(), value);
+  ASSERT_TRUE(parse("-2147483649", value));
+  EXPECT_EQ(std::numeric_limits<int>::min(), value);
+  ASSERT_TRUE(parse("-99999999999999999999999", value));
+  EXPECT_EQ(std::numeric_limits<int>::min(), value);
+}
+
+TEST(CsvRowTest, EmptyFields)
+{
+  CsvRow row;
+  std::string line = "1,,3";
+  row.split(line.data(), line.data() + line.size());
+  ASSERT_EQ(3u, row.size());
+  EXPECT_EQ(1, row.getInt(0));
+  EXPECT_EQ("", row.getString(1));
+  EXPECT_EQ(0, row.getInt(1));
+  EXPECT_EQ(0.0, row.getDouble(1));
+  EXPECT_EQ('\0', row.getChar(1));
+  EXPECT_EQ(3, row.getInt(2));
+
+  line = ",a";
+  row.split(line.data(), line.data() + line.size());
+  ASSERT_EQ(2u, row.size());
+  EXPECT_EQ("", row.getString(0));
+  EXPECT_EQ('a', row.getChar(1));
+
+  // like std::getline, a trailing separator does not start a column
+  line = "a,";
+  row.split(line.data(), line.data() + line.size());
+  EXPECT_EQ(1u, row.size());
+  line = "a,,";
+  row.split(line.data(), line.data() + line.size());
+  ASSERT_EQ(2u, row.size());
+  EXPECT_EQ("", row.getString(1));
+
+  line = "";
+  row.split(line.data(), line.data() + line.size());
+  EXPECT_TRUE(row.empty());
+
+  // missing columns read as 0
+  line = "5";
+  row.split(line.data(), line.data() + line.size());
+  EXPECT_EQ(0, row.getInt(3));
+  EXPECT_EQ(0.0, row.getDouble(3));
+  EXPECT_EQ('\0', row.getChar(3));
+  EXPECT_EQ("", row.getString(3));
+}
+
+TEST(CsvRowTest, MaxColumns)
+{
+  const size_t max_columns = CsvRow::MAX_COLUMNS;
+  std::string line;
+  for (size_t i = 0; i < max_columns + 10; ++i)
+    line += std::to_string(i) + ",";
+  CsvRow row;
+  row.split(line.data(), line.data() + line.size());
+  ASSERT_EQ(max_columns, row.size());
+  EXPECT_EQ(static_cast<int>(max_columns) - 1, row.getInt(max_columns - 1));
+}
+
+TEST(CsvReaderTest, Lines)
+{
+  const std::string data = "PID,B\r\n1,2.5\n\n3,4";
+  CsvReader reader(data.data(), data.size());
+  CsvRow row;
+
+  ASSERT_TRUE(reader.nextRow(row));
+  ASSERT_EQ(2u, row.size());
+  EXPECT_EQ("B", row.getString(1));
+  ASSERT_TRUE(reader.nextRow(row));
+  EXPECT_EQ(2.5, row.getDouble(1));
+  ASSERT_TRUE(reader.nextRow(row));
+  EXPECT_TRUE(row.empty());
+  ASSERT_TRUE(reader.nextRow(row));
+  EXPECT_EQ(4, row.getInt(1));
+  EXPECT_TRUE(reader.eof());
+  EXPECT_FALSE(reader.nextRow(row));
+}
+
+TEST_F(CsvCacheTest, ValidCache)
+{
+  std::vector<uint8_t> payload;
+  ASSERT_TRUE(readCsvCache(csv_, "0123456789abcdef0123456789abcdef", payload));
+  EXPECT_EQ(payload_, payload);
+
+  // another cache name is a separate file
+  EXPECT_FALSE(readCsvCache(csv_, "0123456789abcdef0123456789abcdef", payload, "other"));
+}
+
+TEST_F(CsvCacheTest, RejectedAfterMtimeChange)
+{
+  std::vector<uint8_t> payload;
+  setMtime(csv_, 1500000000, 1000);
+  EXPECT_FALSE(readCsvCache(csv_, "0123456789abcdef0123456789abcdef", payload));
+  EXPECT_TRUE(payload.empty());
+}
+
+TEST_F(CsvCacheTest, RejectedAfterSizeChange)
+{
+  std::vector<uint8_t> payload;
+  writeFile(csv_, "PID,B,L,H,Bx,Ly,ReF,MCODE1,MCODE2,MCODE3\n1,0,0,0,0,0,0,0,0,0\n2,0,0,0,0,0,0,0,0,0\n");
+  setMtime(csv_, 1500000000, 0);
+  EXPECT_FALSE(readCsvCache(csv_, "0123456789abcdef0123456789abcdef", payload));
+}
+
+TEST_F(CsvCacheTest, RejectedAfterMd5sumChange)
+{
+  std::vector<uint8_t> payload;
+  EXPECT_FALSE(readCsvCache(csv_, "fedcba9876543210fedcba9876543210", payload));
+  EXPECT_TRUE(payload.empty());
+}
+
+TEST_F(CsvCacheTest, RejectedWhenCorrupted)
+{
+  std::vector<uint8_t> payload;
+  std::FILE* fp = std::fopen((dir_ + "/.point.csv.cache").c_str(), "r+b");
+  ASSERT_NE(nullptr, fp);
+  std::fseek(fp, -1, SEEK_END);
+  std::fputc(0xff, fp);
+  std::fclose(fp);
+  EXPECT_FALSE(readCsvCache(csv_, "0123456789abcdef0123456789abcdef", payload));
+}
+
+TEST_F(CsvCacheTest, RejectedWithoutCsv)
+{
+  std::vector<uint8_t> payload;
+  std::remove(csv_.c_str());
+  EXPECT_FALSE(readCsvCache(csv_, "0123456789abcdef0123456789abcdef", payload));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
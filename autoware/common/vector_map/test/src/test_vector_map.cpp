@@ -0,0 +1,285 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <vector_map/vector_map.h>
+
+using vector_map::Key;
+using vector_map::Lane;
+using vector_map::LaneArray;
+using vector_map::Node;
+using vector_map::NodeArray;
+using vector_map::Point;
+using vector_map::PointArray;
+using vector_map::VectorMap;
+
+namespace
+{
+const size_t MAX_RETRIES = 10;
+const vector_map::category_t LANE_CATEGORIES =
+    vector_map::Category::POINT | vector_map::Category::NODE | vector_map::Category::LANE;
+
+// map frame position (x, y), stored the way vector_map swaps the axes
+Point createPoint(int pid, double x, double y)
+{
+  Point point;
+  point.pid = pid;
+  point.ly = x;
+  point.bx = y;
+  return point;
+}
+
+Node createNode(int nid, int pid)
+{
+  Node node;
+  node.nid = nid;
+  node.pid = pid;
+  return node;
+}
+
+Lane createLane(int lnid, int bnid, int fnid, int blid, int flid)
+{
+  Lane lane;
+  lane.lnid = lnid;
+  lane.bnid = bnid;
+  lane.fnid = fnid;
+  lane.blid = blid;
+  lane.flid = flid;
+  return lane;
+}
+
+double computeDistance(const Point& point, double x, double y)
+{
+  return std::hypot(point.ly - x, point.bx - y);
+}
+
+double computeDistance(const Point& begin, const Point& end, double x, double y)
+{
+  double dx = end.ly - begin.ly;
+  double dy = end.bx - begin.bx;
+  double length2 = dx * dx + dy * dy;
+  double t = length2 > 0 ? ((x - begin.ly) * dx + (y - begin.bx) * dy) / length2 : 0;
+  t = std::max(0.0, std::min(1.0, t));
+  return std::hypot(begin.ly + t * dx - x, begin.bx + t * dy - y);
+}
+
+geometry_msgs::Point createGeomPoint(double x, double y)
+{
+  geometry_msgs::Point point;
+  point.x = x;
+  point.y = y;
+  return point;
+}
+
+template <class T>
+std::vector<int> getLaneIds(const std::vector<T>& lanes)
+{
+  std::vector<int> ids;
+  for (const auto& lane : lanes)
+    ids.push_back(lane.lnid);
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+}  // namespace
+
+class VectorMapTest : public ::testing::Test
+{
+protected:
+  ros::NodeHandle nh_;
+  ros::Publisher point_pub_;
+  ros::Publisher node_pub_;
+  ros::Publisher lane_pub_;
+  PointArray points_;
+  NodeArray nodes_;
+  LaneArray lanes_;
+
+  // Two rows of points 10 m apart along x, one node per point. Lanes 1-9 join the lower row, lanes 11-19 the upper
+  // row and lane 20 branches from node 3 to node 15.
+  void SetUp() override
+  {
+    point_pub_ = nh_.advertise<PointArray>("/vector_map_info/point", 1, true);
+    node_pub_ = nh_.advertise<NodeArray>("/vector_map_info/node", 1, true);
+    lane_pub_ = nh_.advertise<LaneArray>("/vector_map_info/lane", 1, true);
+
+    for (int i = 1; i <= 10; ++i)
+    {
+      points_.data.push_back(createPoint(i, 10.0 * i, 0.0));
+      points_.data.push_back(createPoint(10 + i, 10.0 * i, 5.0));
+      nodes_.data.push_back(createNode(i, i));
+      nodes_.data.push_back(createNode(10 + i, 10 + i));
+    }
+    for (int i = 1; i <= 9; ++i)
+    {
+      lanes_.data.push_back(createLane(i, i, i + 1, i - 1, i < 9 ? i + 1 : 0));
+      lanes_.data.push_back(createLane(10 + i, 10 + i, 11 + i, i > 1 ? 9 + i : 0, i < 9 ? 11 + i : 0));
+    }
+    lanes_.data.push_back(createLane(20, 3, 15, 2, 15));
+  }
+
+  void spinUntil(const std::function<bool()>& done)
+  {
+    ros::Rate rate(10);
+    for (int i = 0; i < 50 && ros::ok() && !done(); ++i)
+    {
+      ros::spinOnce();
+      rate.sleep();
+    }
+  }
+
+  Point findPoint(int pid) const
+  {
+    for (const auto& point : points_.data)
+    {
+      if (point.pid == pid)
+        return point;
+    }
+    return Point();
+  }
+};
+
+TEST_F(VectorMapTest, findByForeignKeyMatchesFindByFilter)
+{
+  point_pub_.publish(points_);
+  node_pub_.publish(nodes_);
+  lane_pub_.publish(lanes_);
+
+  VectorMap vmap;
+  vmap.subscribe(nh_, LANE_CATEGORIES, MAX_RETRIES);
+  ASSERT_TRUE(vmap.hasSubscribed(LANE_CATEGORIES));
+
+  const std::map<std::string, std::function<int(const Lane&)>> lane_fields = {
+    { "bnid", [](const Lane& lane) { return lane.bnid; } },
+    { "fnid", [](const Lane& lane) { return lane.fnid; } },
+    { "blid", [](const Lane& lane) { return lane.blid; } },
+    { "flid", [](const Lane& lane) { return lane.flid; } },
+  };
+  for (const auto& field : lane_fields)
+  {
+    for (int id = 1; id <= 21; ++id)
+    {
+      auto get = field.second;
+      std::vector<int> expected = getLaneIds(vmap.findByFilter([&](const Lane& lane) { return get(lane) == id; }));
+      std::vector<int> actual = getLaneIds(vmap.findByForeignKey<Lane>(field.first, id));
+      EXPECT_EQ(expected, actual) << field.first << " " << id;
+    }
+  }
+  // the branch makes node 3 the start of two lanes
+  EXPECT_EQ(std::vector<int>({ 3, 20 }), getLaneIds(vmap.findByForeignKey<Lane>("bnid", 3)));
+
+  for (int pid = 1; pid <= 21; ++pid)
+  {
+    std::vector<Node> expected = vmap.findByFilter([&](const Node& node) { return node.pid == pid; });
+    std::vector<Node> actual = vmap.findByForeignKey<Node>("pid", pid);
+    ASSERT_EQ(expected.size(), actual.size()) << pid;
+    for (size_t i = 0; i < expected.size(); ++i)
+      EXPECT_EQ(expected[i].nid, actual[i].nid);
+  }
+
+  EXPECT_TRUE(vmap.findByForeignKey<Lane>("bnid", 0).empty());
+  EXPECT_TRUE(vmap.findByForeignKey<Lane>("no_such_field", 1).empty());
+}
+
+TEST_F(VectorMapTest, findNearReturnsNearestFirstWithinRadius)
+{
+  point_pub_.publish(points_);
+  node_pub_.publish(nodes_);
+  lane_pub_.publish(lanes_);
+
+  VectorMap vmap;
+  vmap.subscribe(nh_, LANE_CATEGORIES, MAX_RETRIES);
+  ASSERT_TRUE(vmap.hasSubscribed(LANE_CATEGORIES));
+
+  const double x = 33.0;
+  const double y = 1.0;
+  const double radius = 15.0;
+
+  std::vector<Point> points = vmap.findNear<Point>(createGeomPoint(x, y), radius);
+  std::vector<Point> expected_points =
+      vmap.findByFilter([&](const Point& point) { return computeDistance(point, x, y) <= radius; });
+  ASSERT_FALSE(points.empty());
+  ASSERT_EQ(expected_points.size(), points.size());
+  EXPECT_EQ(3, points.front().pid);
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    EXPECT_LE(computeDistance(points[i], x, y), radius);
+    if (i > 0)
+    {
+      EXPECT_LE(computeDistance(points[i - 1], x, y), computeDistance(points[i], x, y));
+    }
+  }
+
+  auto distance_to_lane = [&](const Lane& lane) {
+    return computeDistance(findPoint(lane.bnid), findPoint(lane.fnid), x, y);
+  };
+  std::vector<Lane> lanes = vmap.findNear<Lane>(createGeomPoint(x, y), radius);
+  std::vector<Lane> expected_lanes =
+      vmap.findByFilter([&](const Lane& lane) { return distance_to_lane(lane) <= radius; });
+  ASSERT_FALSE(lanes.empty());
+  EXPECT_EQ(getLaneIds(expected_lanes), getLaneIds(lanes));
+  // the branch passes closer than lane 3 below it
+  EXPECT_EQ(20, lanes.front().lnid);
+  for (size_t i = 1; i < lanes.size(); ++i)
+    EXPECT_LE(distance_to_lane(lanes[i - 1]), distance_to_lane(lanes[i]));
+
+  EXPECT_TRUE(vmap.findNear<Point>(createGeomPoint(1000.0, 1000.0), radius).empty());
+}
+
+TEST_F(VectorMapTest, lanesReindexedWhenNodesOrPointsArrive)
+{
+  point_pub_.publish(points_);
+  lane_pub_.publish(lanes_);
+
+  VectorMap vmap;
+  vmap.subscribe(nh_, vector_map::Category::POINT | vector_map::Category::LANE, MAX_RETRIES);
+  ASSERT_TRUE(vmap.hasSubscribed(vector_map::Category::POINT | vector_map::Category::LANE));
+
+  // lane shapes are resolved through the nodes, none yet
+  EXPECT_TRUE(vmap.findNear<Lane>(createGeomPoint(25.0, 0.0), 1.0).empty());
+
+  node_pub_.publish(nodes_);
+  vmap.subscribe(nh_, vector_map::Category::NODE, MAX_RETRIES);
+  ASSERT_TRUE(vmap.hasSubscribed(vector_map::Category::NODE));
+  std::vector<Lane> lanes = vmap.findNear<Lane>(createGeomPoint(25.0, 0.0), 1.0);
+  ASSERT_EQ(1u, lanes.size());
+  EXPECT_EQ(2, lanes.front().lnid);
+
+  // moving the points moves the lanes
+  for (auto& point : points_.data)
+    point.ly += 1000.0;
+  point_pub_.publish(points_);
+  spinUntil([&]() { return vmap.findByKey(Key<Point>(1)).ly > 500.0; });
+  ASSERT_GT(vmap.findByKey(Key<Point>(1)).ly, 500.0);
+  EXPECT_TRUE(vmap.findNear<Lane>(createGeomPoint(25.0, 0.0), 1.0).empty());
+  lanes = vmap.findNear<Lane>(createGeomPoint(1025.0, 0.0), 1.0);
+  ASSERT_EQ(1u, lanes.size());
+  EXPECT_EQ(2, lanes.front().lnid);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "test_vector_map");
+  return RUN_ALL_TESTS();
+}
@@ -47,6 +47,7 @@
 #include "vector_map_server/GetRailCrossing.h"
 #include "vector_map_server/PositionState.h"
 
+#include <algorithm>
 #include <vector>
 
 using vector_map::VectorMap;
@@ -152,38 +153,6 @@ Point createMedianPoint(const Point& p1, const Point& p2)
   return point;
 }
 
-std::vector<Point> findStartPoints(const VectorMap& vmap)
-{
-  std::vector<Point> start_points;
-  for (const auto& lane : vmap.findByFilter([](const Lane& lane){return true;}))
-  {
-    Node node = vmap.findByKey(Key<Node>(lane.bnid));
-    if (node.nid == 0)
-      continue;
-    Point point = vmap.findByKey(Key<Point>(node.pid));
-    if (point.pid == 0)
-      continue;
-    start_points.push_back(point);
-  }
-  return start_points;
-}
-
-std::vector<Point> findEndPoints(const VectorMap& vmap)
-{
-  std::vector<Point> end_points;
-  for (const auto& lane : vmap.findByFilter([](const Lane& lane){return true;}))
-  {
-    Node node = vmap.findByKey(Key<Node>(lane.fnid));
-    if (node.nid == 0)
-      continue;
-    Point point = vmap.findByKey(Key<Point>(node.pid));
-    if (point.pid == 0)
-      continue;
-    end_points.push_back(point);
-  }
-  return end_points;
-}
-
 Point findNearestPoint(const std::vector<Point>& points, const Point& base_point)
 {
   Point nearest_point;
@@ -200,23 +169,12 @@ Point findNearestPoint(const std::vector<Point>& points, const Point& base_point
   return nearest_point;
 }
 
-std::vector<Point> findNearPoints(const std::vector<Point>& points, const Point& base_point, double radius)
-{
-  std::vector<Point> near_points;
-  for (const auto& point : points)
-  {
-    if (computeDistance(base_point, point) <= radius)
-      near_points.push_back(point);
-  }
-  return near_points;
-}
-
 std::vector<Lane> findLanesByStartPoint(const VectorMap& vmap, const Point& start_point)
 {
   std::vector<Lane> lanes;
-  for (const auto& node : vmap.findByFilter([&start_point](const Node& node){return node.pid == start_point.pid;}))
+  for (const auto& node : vmap.findByForeignKey<Node>("pid", start_point.pid))
   {
-    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.bnid == node.nid;}))
+    for (const auto& lane : vmap.findByForeignKey<Lane>("bnid", node.nid))
       lanes.push_back(lane);
   }
   return lanes;
@@ -225,9 +183,9 @@ std::vector<Lane> findLanesByStartPoint(const VectorMap& vmap, const Point& star
 std::vector<Lane> findLanesByEndPoint(const VectorMap& vmap, const Point& end_point)
 {
   std::vector<Lane> lanes;
-  for (const auto& node : vmap.findByFilter([&end_point](const Node& node){return node.pid == end_point.pid;}))
+  for (const auto& node : vmap.findByForeignKey<Node>("pid", end_point.pid))
   {
-    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.fnid == node.nid;}))
+    for (const auto& lane : vmap.findByForeignKey<Lane>("fnid", node.nid))
       lanes.push_back(lane);
   }
   return lanes;
@@ -242,8 +200,9 @@ Lane findStartLane(const VectorMap& vmap, const std::vector<Point>& points, doub
   Point bp1 = points[0];
   Point bp2 = points[1];
   double max_score = -DBL_MAX;
-  for (const auto& p1 : findNearPoints(findStartPoints(vmap), bp1, radius))
+  for (const auto& p1 : vmap.findNear<Point>(convertPointToGeomPoint(bp1), radius))
   {
+    // points which are not a lane start point have no lanes
     for (const auto& lane : findLanesByStartPoint(vmap, p1))
     {
       if (lane.lnid == 0)
@@ -271,7 +230,7 @@ Lane findEndLane(const VectorMap& vmap, const std::vector<Point>& points, double
   Point bp1 = points[points.size() - 2];
   Point bp2 = points[points.size() - 1];
   double max_score = -DBL_MAX;
-  for (const auto& p2 : findNearPoints(findEndPoints(vmap), bp2, radius))
+  for (const auto& p2 : vmap.findNear<Point>(convertPointToGeomPoint(bp2), radius))
   {
     for (const auto& lane : findLanesByEndPoint(vmap, p2))
     {
@@ -388,13 +347,16 @@ std::vector<Lane> createFineLanes(const VectorMap& vmap, const autoware_msgs::La
         return null_lanes;
 
       double max_score = -DBL_MAX;
-      Filter<Lane> is_next_lane = [&current_lane](const Lane& lane)
-        {
-          return lane.lnid == current_lane.flid || lane.lnid == current_lane.flid2 ||
-                 lane.lnid == current_lane.flid3 || lane.lnid == current_lane.flid4;
-        };
-      for (const auto& lane : vmap.findByFilter(is_next_lane))
+      std::vector<int> next_lnids = { current_lane.flid, current_lane.flid2, current_lane.flid3, current_lane.flid4 };
+      std::sort(next_lnids.begin(), next_lnids.end());
+      next_lnids.erase(std::unique(next_lnids.begin(), next_lnids.end()), next_lnids.end());
+      for (int next_lnid : next_lnids)
       {
+        if (next_lnid == 0)
+          continue;
+        Lane lane = vmap.findByKey(Key<Lane>(next_lnid));
+        if (lane.lnid == 0)
+          continue;
         Lane next_lane = lane;
         Point next_point = findEndPoint(vmap, next_lane);
         if (next_point.pid == 0)
@@ -525,14 +487,27 @@ private:
     std::vector<Lane> null_lanes;
 
     std::vector<Lane> fine_lanes;
+    Lane nearest_lane;
     if (waypoints.waypoints.empty())
-      fine_lanes = vmap_.findByFilter([](const Lane& lane){return true;});
+    {
+      // the lane with the nearest median point is also within that distance of the pose
+      Point base_point = convertGeomPointToPoint(pose.pose.position);
+      nearest_lane = findNearestLane(vmap_, vmap_.findNear<Lane>(pose.pose.position, radius_), base_point);
+      if (nearest_lane.lnid == 0 ||
+          computeDistance(base_point, createMedianPoint(findStartPoint(vmap_, nearest_lane),
+                                                        findEndPoint(vmap_, nearest_lane))) > radius_)
+      {
+        fine_lanes = vmap_.findByFilter([](const Lane& lane){return true;});
+        nearest_lane = findNearestLane(vmap_, fine_lanes, base_point);
+      }
+    }
     else
+    {
       fine_lanes = createFineLanes(vmap_, waypoints, radius_, loops_);
-    if (fine_lanes.empty())
-      return null_lanes;
-
-    Lane nearest_lane = findNearestLane(vmap_, fine_lanes, convertGeomPointToPoint(pose.pose.position));
+      if (fine_lanes.empty())
+        return null_lanes;
+      nearest_lane = findNearestLane(vmap_, fine_lanes, convertGeomPointToPoint(pose.pose.position));
+    }
     if (nearest_lane.lnid == 0)
       return null_lanes;
 
@@ -673,8 +648,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_edge : vmap_.findByFilter(
-           [&lane](const RoadEdge& road_edge){return road_edge.linkid == lane.lnid;}))
+      for (const auto& road_edge : vmap_.findByForeignKey<RoadEdge>("linkid", lane.lnid))
         response.objects.data.push_back(road_edge);
     }
     return true;
@@ -689,8 +663,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& gutter : vmap_.findByFilter(
-           [&lane](const Gutter& gutter){return gutter.linkid == lane.lnid;}))
+      for (const auto& gutter : vmap_.findByForeignKey<Gutter>("linkid", lane.lnid))
         response.objects.data.push_back(gutter);
     }
     return true;
@@ -705,8 +678,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& curb : vmap_.findByFilter(
-           [&lane](const Curb& curb){return curb.linkid == lane.lnid;}))
+      for (const auto& curb : vmap_.findByForeignKey<Curb>("linkid", lane.lnid))
         response.objects.data.push_back(curb);
     }
     return true;
@@ -721,8 +693,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& white_line : vmap_.findByFilter(
-           [&lane](const WhiteLine& white_line){return white_line.linkid == lane.lnid;}))
+      for (const auto& white_line : vmap_.findByForeignKey<WhiteLine>("linkid", lane.lnid))
         response.objects.data.push_back(white_line);
     }
     return true;
@@ -737,8 +708,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& stop_line : vmap_.findByFilter(
-           [&lane](const StopLine& stop_line){return stop_line.linkid == lane.lnid;}))
+      for (const auto& stop_line : vmap_.findByForeignKey<StopLine>("linkid", lane.lnid))
         response.objects.data.push_back(stop_line);
     }
     return true;
@@ -753,8 +723,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& zebra_zone : vmap_.findByFilter(
-           [&lane](const ZebraZone& zebra_zone){return zebra_zone.linkid == lane.lnid;}))
+      for (const auto& zebra_zone : vmap_.findByForeignKey<ZebraZone>("linkid", lane.lnid))
         response.objects.data.push_back(zebra_zone);
     }
     return true;
@@ -769,8 +738,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& cross_walk : vmap_.findByFilter(
-           [&lane](const CrossWalk& cross_walk){return cross_walk.linkid == lane.lnid;}))
+      for (const auto& cross_walk : vmap_.findByForeignKey<CrossWalk>("linkid", lane.lnid))
         response.objects.data.push_back(cross_walk);
     }
     return true;
@@ -785,8 +753,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_mark : vmap_.findByFilter(
-           [&lane](const RoadMark& road_mark){return road_mark.linkid == lane.lnid;}))
+      for (const auto& road_mark : vmap_.findByForeignKey<RoadMark>("linkid", lane.lnid))
         response.objects.data.push_back(road_mark);
     }
     return true;
@@ -801,8 +768,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_pole : vmap_.findByFilter(
-           [&lane](const RoadPole& road_pole){return road_pole.linkid == lane.lnid;}))
+      for (const auto& road_pole : vmap_.findByForeignKey<RoadPole>("linkid", lane.lnid))
         response.objects.data.push_back(road_pole);
     }
     return true;
@@ -817,8 +783,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_sign : vmap_.findByFilter(
-           [&lane](const RoadSign& road_sign){return road_sign.linkid == lane.lnid;}))
+      for (const auto& road_sign : vmap_.findByForeignKey<RoadSign>("linkid", lane.lnid))
         response.objects.data.push_back(road_sign);
     }
     return true;
@@ -833,8 +798,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& signal : vmap_.findByFilter(
-           [&lane](const Signal& signal){return signal.linkid == lane.lnid;}))
+      for (const auto& signal : vmap_.findByForeignKey<Signal>("linkid", lane.lnid))
         response.objects.data.push_back(signal);
     }
     return true;
@@ -849,8 +813,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& street_light : vmap_.findByFilter(
-           [&lane](const StreetLight& street_light){return street_light.linkid == lane.lnid;}))
+      for (const auto& street_light : vmap_.findByForeignKey<StreetLight>("linkid", lane.lnid))
         response.objects.data.push_back(street_light);
     }
     return true;
@@ -865,8 +828,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& utility_pole : vmap_.findByFilter(
-           [&lane](const UtilityPole& utility_pole){return utility_pole.linkid == lane.lnid;}))
+      for (const auto& utility_pole : vmap_.findByForeignKey<UtilityPole>("linkid", lane.lnid))
         response.objects.data.push_back(utility_pole);
     }
     return true;
@@ -881,8 +843,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& guard_rail : vmap_.findByFilter(
-           [&lane](const GuardRail& guard_rail){return guard_rail.linkid == lane.lnid;}))
+      for (const auto& guard_rail : vmap_.findByForeignKey<GuardRail>("linkid", lane.lnid))
         response.objects.data.push_back(guard_rail);
     }
     return true;
@@ -897,8 +858,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& side_walk : vmap_.findByFilter(
-           [&lane](const SideWalk& side_walk){return side_walk.linkid == lane.lnid;}))
+      for (const auto& side_walk : vmap_.findByForeignKey<SideWalk>("linkid", lane.lnid))
         response.objects.data.push_back(side_walk);
     }
     return true;
@@ -913,8 +873,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& drive_on_portion : vmap_.findByFilter(
-           [&lane](const DriveOnPortion& drive_on_portion){return drive_on_portion.linkid == lane.lnid;}))
+      for (const auto& drive_on_portion : vmap_.findByForeignKey<DriveOnPortion>("linkid", lane.lnid))
         response.objects.data.push_back(drive_on_portion);
     }
     return true;
@@ -929,8 +888,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& cross_road : vmap_.findByFilter(
-           [&lane](const CrossRoad& cross_road){return cross_road.linkid == lane.lnid;}))
+      for (const auto& cross_road : vmap_.findByForeignKey<CrossRoad>("linkid", lane.lnid))
         response.objects.data.push_back(cross_road);
     }
     return true;
@@ -945,8 +903,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& side_strip : vmap_.findByFilter(
-           [&lane](const SideStrip& side_strip){return side_strip.linkid == lane.lnid;}))
+      for (const auto& side_strip : vmap_.findByForeignKey<SideStrip>("linkid", lane.lnid))
         response.objects.data.push_back(side_strip);
     }
     return true;
@@ -961,8 +918,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& curve_mirror : vmap_.findByFilter(
-           [&lane](const CurveMirror& curve_mirror){return curve_mirror.linkid == lane.lnid;}))
+      for (const auto& curve_mirror : vmap_.findByForeignKey<CurveMirror>("linkid", lane.lnid))
         response.objects.data.push_back(curve_mirror);
     }
     return true;
@@ -977,8 +933,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& wall : vmap_.findByFilter(
-           [&lane](const Wall& wall){return wall.linkid == lane.lnid;}))
+      for (const auto& wall : vmap_.findByForeignKey<Wall>("linkid", lane.lnid))
         response.objects.data.push_back(wall);
     }
     return true;
@@ -993,8 +948,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& fence : vmap_.findByFilter(
-           [&lane](const Fence& fence){return fence.linkid == lane.lnid;}))
+      for (const auto& fence : vmap_.findByForeignKey<Fence>("linkid", lane.lnid))
         response.objects.data.push_back(fence);
     }
     return true;
@@ -1009,8 +963,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& rail_crossing : vmap_.findByFilter(
-           [&lane](const RailCrossing& rail_crossing){return rail_crossing.linkid == lane.lnid;}))
+      for (const auto& rail_crossing : vmap_.findByForeignKey<RailCrossing>("linkid", lane.lnid))
         response.objects.data.push_back(rail_crossing);
     }
     return true;
@@ -1020,10 +973,9 @@ public:
                  vector_map_server::PositionState::Response& response)
   {
     response.state = false;
-    for (const auto& way_area : vmap_.findByFilter([](const WayArea& way_area){return true;}))
+    for (const auto& area : vmap_.findNear<Area>(request.position, 0))
     {
-      Area area = vmap_.findByKey(Key<Area>(way_area.aid));
-      if (area.aid == 0)
+      if (vmap_.findByForeignKey<WayArea>("aid", area.aid).empty())
         continue;
       Polygon polygon = createPolygon(vmap_, area);
       if (isInPolygon(polygon, request.position))
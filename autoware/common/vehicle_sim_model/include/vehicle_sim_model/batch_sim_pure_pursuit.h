@@ -0,0 +1,69 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file batch_sim_pure_pursuit.h
+ * @brief adapter running the pure pursuit library of libwaypoint_follower in the batch simulator
+ */
+
+#ifndef VEHICLE_SIM_MODEL_BATCH_SIM_PURE_PURSUIT_H
+#define VEHICLE_SIM_MODEL_BATCH_SIM_PURE_PURSUIT_H
+
+#include "vehicle_sim_model/batch_simulator.h"
+
+#include <geometry_msgs/Pose.h>
+#include <libwaypoint_follower/pure_pursuit.h>
+
+#include <vector>
+
+/**
+ * @class pure pursuit controller for batch simulation
+ * @brief feed the vehicle model state to PurePursuit of libwaypoint_follower and convert its curvature to the model
+ *        input the same way the pure_pursuit node does
+ */
+class BatchSimPurePursuitController : public BatchSimControllerInterface
+{
+public:
+  /**
+   * @brief constructor
+   * @param [in] wheelbase vehicle wheelbase length [m]
+   * @param [in] lookahead_ratio lookahead distance per velocity [s]
+   * @param [in] minimum_lookahead_distance minimum lookahead distance [m]
+   * @param [in] output_steer true if the model input is steering angle, false if angular velocity
+   * @param [in] use_lerp interpolate the target point between waypoints
+   */
+  BatchSimPurePursuitController(double wheelbase, double lookahead_ratio, double minimum_lookahead_distance,
+                                bool output_steer, bool use_lerp = true);
+
+  bool calcInput(const std::vector<BatchSimReferencePoint>& path, const size_t nearest_index,
+                 const VehicleModelInterface& model, Eigen::VectorXd& input) override;
+
+private:
+  PurePursuit pp_;                                   //!< @brief pure pursuit library instance
+  const double wheelbase_;                           //!< @brief vehicle wheelbase length [m]
+  const double lookahead_ratio_;                     //!< @brief lookahead distance per velocity [s]
+  const double minimum_lookahead_distance_;          //!< @brief minimum lookahead distance [m]
+  const bool output_steer_;                          //!< @brief output steering angle instead of angular velocity
+  const std::vector<BatchSimReferencePoint>* path_;  //!< @brief path last given to pp_, to skip the conversion
+
+  /**
+   * @brief lookahead distance as computed by the pure_pursuit node
+   * @param [in] velocity current vehicle velocity [m/s]
+   */
+  double calcLookaheadDistance(const double velocity) const;
+};
+
+#endif  // VEHICLE_SIM_MODEL_BATCH_SIM_PURE_PURSUIT_H
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file batch_simulator.h
+ * @brief ROS-free headless simulator stepping a vehicle model and a controller in lockstep as fast as possible
+ */
+
+#ifndef VEHICLE_SIM_MODEL_BATCH_SIMULATOR_H
+#define VEHICLE_SIM_MODEL_BATCH_SIMULATOR_H
+
+#include "vehicle_sim_model/vehicle_model_interface.h"
+
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <eigen3/Eigen/Core>
+
+/**
+ * @brief point on reference path
+ */
+struct BatchSimReferencePoint
+{
+  double x;    //!< @brief position x [m]
+  double y;    //!< @brief position y [m]
+  double yaw;  //!< @brief path direction [rad]
+  double vx;   //!< @brief reference velocity [m/s]
+};
+
+/**
+ * @class controller interface for batch simulation
+ * @brief calculate vehicle model input from current vehicle state without any middleware
+ */
+class BatchSimControllerInterface
+{
+public:
+  virtual ~BatchSimControllerInterface() = default;
+
+  /**
+   * @brief calculate input for the vehicle model
+   * @param [in] path reference path
+   * @param [in] nearest_index index of the nearest path point to the vehicle
+   * @param [in] model vehicle model with current state
+   * @param [out] input input vector for the vehicle model (vx_des, steer_des or wz_des)
+   * @return false if the controller can not compute an input (simulation is aborted)
+   */
+  virtual bool calcInput(const std::vector<BatchSimReferencePoint>& path, const size_t nearest_index,
+                         const VehicleModelInterface& model, Eigen::VectorXd& input) = 0;
+};
+
+/**
+ * @class simplified pure pursuit controller for batch simulation
+ * @brief geometric path tracking with velocity dependent lookahead distance. This is a dependency free
+ *        approximation to exercise the simulator itself, use BatchSimPurePursuitController to evaluate the
+ *        pure pursuit library of libwaypoint_follower.
+ */
+class BatchSimSimplePurePursuitController : public BatchSimControllerInterface
+{
+public:
+  /**
+   * @brief constructor
+   * @param [in] wheelbase vehicle wheelbase length [m]
+   * @param [in] lookahead_ratio lookahead distance per velocity [s]
+   * @param [in] minimum_lookahead_distance minimum lookahead distance [m]
+   * @param [in] output_steer true if the model input is steering angle, false if angular velocity
+   */
+  BatchSimSimplePurePursuitController(double wheelbase, double lookahead_ratio, double minimum_lookahead_distance,
+                                      bool output_steer);
+
+  bool calcInput(const std::vector<BatchSimReferencePoint>& path, const size_t nearest_index,
+                 const VehicleModelInterface& model, Eigen::VectorXd& input) override;
+
+private:
+  const double wheelbase_;                   //!< @brief vehicle wheelbase length [m]
+  const double lookahead_ratio_;             //!< @brief lookahead distance per velocity [s]
+  const double minimum_lookahead_distance_;  //!< @brief minimum lookahead distance [m]
+  const bool output_steer_;                  //!< @brief output steering angle instead of angular velocity
+};
+
+/**
+ * @brief one simulation scenario. Model and controller are created per run so scenarios can run in parallel.
+ */
+struct BatchSimScenario
+{
+  std::string name;                                                           //!< @brief scenario name
+  std::vector<BatchSimReferencePoint> path;                                   //!< @brief reference path
+  std::function<std::shared_ptr<VehicleModelInterface>()> create_model;        //!< @brief vehicle model factory
+  std::function<std::shared_ptr<BatchSimControllerInterface>()> create_controller;  //!< @brief controller factory
+  Eigen::VectorXd initial_state;                                              //!< @brief initial model state
+  double dt = 0.02;                                                           //!< @brief simulation step [s]
+  double max_time = 60.0;                                                     //!< @brief simulation time limit [s]
+  double goal_tolerance = 1.0;                                                //!< @brief goal reach distance [m]
+  double abort_lateral_error = 5.0;                                           //!< @brief abort if exceeded [m]
+};
+
+/**
+ * @brief tracking metrics of one scenario
+ */
+struct BatchSimResult
+{
+  std::string name;             //!< @brief scenario name
+  bool reached_goal = false;    //!< @brief vehicle reached the end of path
+  bool aborted = false;         //!< @brief controller failed or lateral error exceeded the limit
+  int steps = 0;                //!< @brief number of simulation steps
+  double sim_time = 0.0;        //!< @brief simulated time [s]
+  double wall_time = 0.0;       //!< @brief computation time [s]
+  double max_lat_error = 0.0;   //!< @brief maximum absolute lateral error [m]
+  double rms_lat_error = 0.0;   //!< @brief root mean square of lateral error [m]
+  double max_yaw_error = 0.0;   //!< @brief maximum absolute yaw error [rad]
+  double rms_vel_error = 0.0;   //!< @brief root mean square of velocity error [m/s]
+};
+
+/**
+ * @class batch simulator
+ * @brief run scenarios without wall-clock timers, distributing them over worker threads
+ */
+class BatchSimulator
+{
+public:
+  /**
+   * @brief constructor
+   * @param [in] num_threads number of worker threads (0: hardware concurrency)
+   */
+  explicit BatchSimulator(int num_threads = 0);
+
+  /**
+   * @brief run one scenario on the caller thread
+   * @param [in] scenario scenario to simulate
+   * @return tracking metrics
+   */
+  BatchSimResult run(const BatchSimScenario& scenario) const;
+
+  /**
+   * @brief run all scenarios in parallel
+   * @param [in] scenarios scenarios to simulate
+   * @return tracking metrics in the same order as scenarios
+   */
+  std::vector<BatchSimResult> runAll(const std::vector<BatchSimScenario>& scenarios) const;
+
+  /**
+   * @brief write results as csv with header
+   * @param [in] results simulation results
+   * @param [out] os output stream
+   */
+  static void writeCSV(const std::vector<BatchSimResult>& results, std::ostream& os);
+
+private:
+  int num_threads_;  //!< @brief number of worker threads
+};
+
+#endif  // VEHICLE_SIM_MODEL_BATCH_SIMULATOR_H
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vehicle_sim_model/batch_sim_pure_pursuit.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+geometry_msgs::Pose createPose(const double x, const double y, const double yaw)
+{
+  geometry_msgs::Pose pose;
+  pose.position.x = x;
+  pose.position.y = y;
+  pose.orientation.z = std::sin(0.5 * yaw);
+  pose.orientation.w = std::cos(0.5 * yaw);
+  return pose;
+}
+}  // namespace
+
+BatchSimPurePursuitController::BatchSimPurePursuitController(double wheelbase, double lookahead_ratio,
+                                                             double minimum_lookahead_distance, bool output_steer,
+                                                             bool use_lerp)
+  : wheelbase_(wheelbase)
+  , lookahead_ratio_(lookahead_ratio)
+  , minimum_lookahead_distance_(minimum_lookahead_distance)
+  , output_steer_(output_steer)
+  , path_(nullptr)
+{
+  pp_.setUseLerp(use_lerp);
+}
+
+double BatchSimPurePursuitController::calcLookaheadDistance(const double velocity) const
+{
+  const double maximum_lookahead_distance = velocity * 10;
+  const double ld = velocity * lookahead_ratio_;
+  return std::max(minimum_lookahead_distance_, std::min(maximum_lookahead_distance, ld));
+}
+
+bool BatchSimPurePursuitController::calcInput(const std::vector<BatchSimReferencePoint>& path,
+                                              const size_t nearest_index, const VehicleModelInterface& model,
+                                              Eigen::VectorXd& input)
+{
+  if (path.empty())
+    return false;
+
+  /* the path of a scenario does not change during the run, convert it once */
+  if (path_ != &path)
+  {
+    std::vector<geometry_msgs::Pose> waypoints;
+    waypoints.reserve(path.size());
+    for (const auto& p : path)
+    {
+      waypoints.push_back(createPose(p.x, p.y, p.yaw));
+    }
+    pp_.setWaypoints(waypoints);
+    path_ = &path;
+  }
+
+  pp_.setCurrentPose(createPose(model.getX(), model.getY(), model.getYaw()));
+  pp_.setLookaheadDistance(calcLookaheadDistance(model.getVx()));
+
+  const std::pair<bool, double> curvature = pp_.run();
+  if (!curvature.first)
+    return false;
+
+  const double vx_ref = path[nearest_index].vx;
+  input = Eigen::VectorXd::Zero(2);
+  input(0) = vx_ref;
+  input(1) = output_steer_ ? std::atan(wheelbase_ * curvature.second) : vx_ref * curvature.second;
+  return true;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file batch_sim_sweep.cpp
+ * @brief sweep the lookahead gain of the libwaypoint_follower pure pursuit over vehicle models and paths, and print tracking metrics as csv
+ *
+ * usage: batch_sim_sweep [num_threads]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include "vehicle_sim_model/batch_sim_pure_pursuit.h"
+#include "vehicle_sim_model/batch_simulator.h"
+#include "vehicle_sim_model/vehicle_model_ideal.h"
+#include "vehicle_sim_model/vehicle_model_time_delay.h"
+
+namespace
+{
+std::vector<BatchSimReferencePoint> generateSinePath(const double length, const double amplitude,
+                                                     const double wavelength, const double vx)
+{
+  std::vector<BatchSimReferencePoint> path;
+  constexpr double ds = 0.5;
+  for (double s = 0.0; s <= length; s += ds)
+  {
+    const double k = 2.0 * M_PI / wavelength;
+    BatchSimReferencePoint p;
+    p.x = s;
+    p.y = amplitude * std::sin(k * s);
+    p.yaw = std::atan(amplitude * k * std::cos(k * s));
+    p.vx = vx;
+    path.push_back(p);
+  }
+  return path;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const int num_threads = (argc > 1) ? std::atoi(argv[1]) : 0;
+
+  const double wheelbase = 2.7;
+  const double dt = 0.02;
+
+  std::vector<BatchSimScenario> scenarios;
+  for (const double vx : { 5.0, 10.0, 15.0 })
+  {
+    for (const double amplitude : { 2.0, 5.0 })
+    {
+      for (const double lookahead_ratio : { 0.8, 1.2, 1.6, 2.0, 2.4 })
+      {
+        for (const bool delay : { false, true })
+        {
+          BatchSimScenario sc;
+          std::ostringstream name;
+          name << (delay ? "delay_steer" : "ideal_steer") << "_v" << vx << "_a" << amplitude << "_la"
+               << lookahead_ratio;
+          sc.name = name.str();
+          sc.path = generateSinePath(300.0, amplitude, 60.0, vx);
+          sc.dt = dt;
+          sc.max_time = 300.0 / vx * 2.0;
+          if (delay)
+          {
+            sc.create_model = [=]()
+            {
+              return std::make_shared<VehicleModelTimeDelaySteer>(20.0, 0.6, 3.0, 0.5, wheelbase, dt, 0.25, 0.6,
+                                                                  0.24, 0.27);
+            };
+            sc.initial_state = Eigen::VectorXd::Zero(5);
+          }
+          else
+          {
+            sc.create_model = [=]() { return std::make_shared<VehicleModelIdealSteer>(wheelbase); };
+            sc.initial_state = Eigen::VectorXd::Zero(3);
+          }
+          sc.create_controller = [=]()
+          {
+            return std::make_shared<BatchSimPurePursuitController>(wheelbase, lookahead_ratio, 3.0, true);
+          };
+          scenarios.push_back(sc);
+        }
+      }
+    }
+  }
+
+  BatchSimulator simulator(num_threads);
+  const auto start = std::chrono::steady_clock::now();
+  const std::vector<BatchSimResult> results = simulator.runAll(scenarios);
+  const double elapsed =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() * 1.0e-9;
+
+  BatchSimulator::writeCSV(results, std::cout);
+
+  double sim_time = 0.0;
+  for (const auto& r : results)
+  {
+    sim_time += r.sim_time;
+  }
+  std::cerr << scenarios.size() << " scenarios, simulated " << sim_time << " [s] in " << elapsed
+            << " [s] (x" << sim_time / std::max(elapsed, 1.0e-9) << " real time)" << std::endl;
+  return 0;
+}
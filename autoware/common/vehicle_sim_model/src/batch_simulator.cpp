@@ -0,0 +1,213 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vehicle_sim_model/batch_simulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace
+{
+double normalizeRadian(const double angle)
+{
+  return std::atan2(std::sin(angle), std::cos(angle));
+}
+
+/**
+ * @brief search nearest path point around previous nearest index (vehicle moves monotonically along path)
+ */
+size_t findNearestIndex(const std::vector<BatchSimReferencePoint>& path, const double x, const double y,
+                        const size_t prev_index)
+{
+  constexpr size_t search_window = 50;
+  const size_t begin = prev_index;
+  const size_t end = std::min(path.size(), prev_index + search_window);
+  size_t nearest = begin;
+  double min_dist_sq = std::numeric_limits<double>::max();
+  for (size_t i = begin; i < end; ++i)
+  {
+    const double dx = path[i].x - x;
+    const double dy = path[i].y - y;
+    const double dist_sq = dx * dx + dy * dy;
+    if (dist_sq < min_dist_sq)
+    {
+      min_dist_sq = dist_sq;
+      nearest = i;
+    }
+  }
+  return nearest;
+}
+}  // namespace
+
+BatchSimSimplePurePursuitController::BatchSimSimplePurePursuitController(double wheelbase, double lookahead_ratio,
+                                                                         double minimum_lookahead_distance,
+                                                                         bool output_steer)
+  : wheelbase_(wheelbase)
+  , lookahead_ratio_(lookahead_ratio)
+  , minimum_lookahead_distance_(minimum_lookahead_distance)
+  , output_steer_(output_steer)
+{
+}
+
+bool BatchSimSimplePurePursuitController::calcInput(const std::vector<BatchSimReferencePoint>& path,
+                                                    const size_t nearest_index, const VehicleModelInterface& model,
+                                                    Eigen::VectorXd& input)
+{
+  if (path.empty())
+    return false;
+
+  const double x = model.getX();
+  const double y = model.getY();
+  const double yaw = model.getYaw();
+  const double vx_ref = path[nearest_index].vx;
+  const double lookahead = std::max(minimum_lookahead_distance_, lookahead_ratio_ * std::fabs(model.getVx()));
+
+  size_t target = nearest_index;
+  while (target + 1 < path.size() && std::hypot(path[target].x - x, path[target].y - y) < lookahead)
+  {
+    ++target;
+  }
+
+  /* curvature of the arc passing through the target point */
+  const double dx = path[target].x - x;
+  const double dy = path[target].y - y;
+  const double lateral = -std::sin(yaw) * dx + std::cos(yaw) * dy;
+  const double dist_sq = std::max(dx * dx + dy * dy, 1.0E-6);
+  const double kappa = 2.0 * lateral / dist_sq;
+
+  input = Eigen::VectorXd::Zero(2);
+  input(0) = vx_ref;
+  input(1) = output_steer_ ? std::atan(wheelbase_ * kappa) : vx_ref * kappa;
+  return true;
+}
+
+BatchSimulator::BatchSimulator(int num_threads) : num_threads_(num_threads)
+{
+  if (num_threads_ <= 0)
+  {
+    num_threads_ = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+BatchSimResult BatchSimulator::run(const BatchSimScenario& scenario) const
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  BatchSimResult result;
+  result.name = scenario.name;
+
+  std::shared_ptr<VehicleModelInterface> model = scenario.create_model();
+  std::shared_ptr<BatchSimControllerInterface> controller = scenario.create_controller();
+  if (!model || !controller || scenario.path.empty() || scenario.dt <= 0.0)
+  {
+    result.aborted = true;
+    return result;
+  }
+  if (scenario.initial_state.size() > 0)
+  {
+    model->setState(scenario.initial_state);
+  }
+
+  const BatchSimReferencePoint& goal = scenario.path.back();
+  const int max_steps = static_cast<int>(std::ceil(scenario.max_time / scenario.dt));
+  double sum_sq_lat = 0.0;
+  double sum_sq_vel = 0.0;
+  size_t nearest = 0;
+  Eigen::VectorXd input;
+
+  for (int step = 0; step < max_steps; ++step)
+  {
+    const double x = model->getX();
+    const double y = model->getY();
+    nearest = findNearestIndex(scenario.path, x, y, nearest);
+    const BatchSimReferencePoint& ref = scenario.path[nearest];
+
+    /* tracking errors with respect to the nearest path point */
+    const double lat_error = -std::sin(ref.yaw) * (x - ref.x) + std::cos(ref.yaw) * (y - ref.y);
+    const double yaw_error = normalizeRadian(model->getYaw() - ref.yaw);
+    const double vel_error = model->getVx() - ref.vx;
+    result.max_lat_error = std::max(result.max_lat_error, std::fabs(lat_error));
+    result.max_yaw_error = std::max(result.max_yaw_error, std::fabs(yaw_error));
+    sum_sq_lat += lat_error * lat_error;
+    sum_sq_vel += vel_error * vel_error;
+    ++result.steps;
+
+    if (nearest + 1 == scenario.path.size() && std::hypot(goal.x - x, goal.y - y) < scenario.goal_tolerance)
+    {
+      result.reached_goal = true;
+      break;
+    }
+    if (std::fabs(lat_error) > scenario.abort_lateral_error ||
+        !controller->calcInput(scenario.path, nearest, *model, input))
+    {
+      result.aborted = true;
+      break;
+    }
+
+    model->setInput(input);
+    model->update(scenario.dt);
+    result.sim_time += scenario.dt;
+  }
+
+  result.rms_lat_error = std::sqrt(sum_sq_lat / std::max(1, result.steps));
+  result.rms_vel_error = std::sqrt(sum_sq_vel / std::max(1, result.steps));
+  result.wall_time =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() * 1.0e-9;
+  return result;
+}
+
+std::vector<BatchSimResult> BatchSimulator::runAll(const std::vector<BatchSimScenario>& scenarios) const
+{
+  std::vector<BatchSimResult> results(scenarios.size());
+  std::atomic<size_t> next(0);
+
+  auto worker = [&]()
+  {
+    for (size_t i = next++; i < scenarios.size(); i = next++)
+    {
+      results[i] = run(scenarios[i]);
+    }
+  };
+
+  const size_t num_workers = std::min(static_cast<size_t>(num_threads_), scenarios.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < num_workers; ++i)
+  {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : threads)
+  {
+    t.join();
+  }
+  return results;
+}
+
+void BatchSimulator::writeCSV(const std::vector<BatchSimResult>& results, std::ostream& os)
+{
+  os << "name,reached_goal,aborted,steps,sim_time,wall_time,max_lat_error,rms_lat_error,max_yaw_error,"
+        "rms_vel_error\n";
+  for (const auto& r : results)
+  {
+    os << r.name << "," << r.reached_goal << "," << r.aborted << "," << r.steps << "," << r.sim_time << ","
+       << r.wall_time << "," << r.max_lat_error << "," << r.rms_lat_error << "," << r.max_yaw_error << ","
+       << r.rms_vel_error << "\n";
+  }
+}
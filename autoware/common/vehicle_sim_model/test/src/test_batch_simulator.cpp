@@ -0,0 +1,134 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include "vehicle_sim_model/batch_sim_pure_pursuit.h"
+#include "vehicle_sim_model/batch_simulator.h"
+#include "vehicle_sim_model/vehicle_model_ideal.h"
+#include "vehicle_sim_model/vehicle_model_time_delay.h"
+
+class TestSuite : public ::testing::Test
+{
+public:
+  const double wheelbase_ = 2.7;
+  const double dt_ = 0.02;
+
+  std::vector<BatchSimReferencePoint> generateCirclePath(const double radius, const double vx)
+  {
+    std::vector<BatchSimReferencePoint> path;
+    for (double th = 0.0; th < M_PI; th += 0.5 / radius)
+    {
+      BatchSimReferencePoint p;
+      p.x = radius * std::sin(th);
+      p.y = radius * (1.0 - std::cos(th));
+      p.yaw = th;
+      p.vx = vx;
+      path.push_back(p);
+    }
+    return path;
+  }
+
+  BatchSimScenario createScenario(const double lookahead_ratio, const bool delay, const bool use_library = false)
+  {
+    BatchSimScenario sc;
+    sc.name = delay ? "delay_steer" : "ideal_steer";
+    sc.path = generateCirclePath(30.0, 5.0);
+    sc.dt = dt_;
+    sc.max_time = 60.0;
+    const double wheelbase = wheelbase_;
+    const double dt = dt_;
+    if (delay)
+    {
+      sc.create_model = [=]()
+      {
+        return std::make_shared<VehicleModelTimeDelaySteer>(10.0, 0.6, 3.0, 0.5, wheelbase, dt, 0.25, 0.6, 0.24,
+                                                            0.27);
+      };
+      sc.initial_state = Eigen::VectorXd::Zero(5);
+    }
+    else
+    {
+      sc.create_model = [=]() { return std::make_shared<VehicleModelIdealSteer>(wheelbase); };
+      sc.initial_state = Eigen::VectorXd::Zero(3);
+    }
+    sc.create_controller = [=]() -> std::shared_ptr<BatchSimControllerInterface>
+    {
+      if (use_library)
+      {
+        return std::make_shared<BatchSimPurePursuitController>(wheelbase, lookahead_ratio, 3.0, true);
+      }
+      return std::make_shared<BatchSimSimplePurePursuitController>(wheelbase, lookahead_ratio, 3.0, true);
+    };
+    return sc;
+  }
+};
+
+TEST_F(TestSuite, TestReachGoal)
+{
+  BatchSimulator simulator(1);
+  const BatchSimResult result = simulator.run(createScenario(1.0, false));
+  ASSERT_TRUE(result.reached_goal);
+  ASSERT_FALSE(result.aborted);
+  ASSERT_LT(result.max_lat_error, 0.5) << "ideal steer model should follow the circle closely";
+  ASSERT_GT(result.sim_time, 10.0);
+}
+
+TEST_F(TestSuite, TestLibraryPurePursuitReachGoal)
+{
+  BatchSimulator simulator(1);
+  for (const bool delay : { false, true })
+  {
+    const BatchSimResult result = simulator.run(createScenario(1.0, delay, true));
+    ASSERT_TRUE(result.reached_goal) << result.name;
+    ASSERT_FALSE(result.aborted) << result.name;
+    ASSERT_LT(result.max_lat_error, delay ? 1.0 : 0.5) << result.name;
+  }
+}
+
+TEST_F(TestSuite, TestParallelRunIsDeterministic)
+{
+  std::vector<BatchSimScenario> scenarios;
+  for (const double lookahead_ratio : { 0.8, 1.2, 1.6, 2.0 })
+  {
+    scenarios.push_back(createScenario(lookahead_ratio, false));
+    scenarios.push_back(createScenario(lookahead_ratio, true));
+  }
+
+  BatchSimulator serial(1);
+  BatchSimulator parallel(4);
+  const std::vector<BatchSimResult> results_serial = serial.runAll(scenarios);
+  const std::vector<BatchSimResult> results_parallel = parallel.runAll(scenarios);
+
+  ASSERT_EQ(results_serial.size(), scenarios.size());
+  ASSERT_EQ(results_parallel.size(), scenarios.size());
+  for (size_t i = 0; i < scenarios.size(); ++i)
+  {
+    ASSERT_EQ(results_serial[i].name, scenarios[i].name);
+    ASSERT_EQ(results_serial[i].steps, results_parallel[i].steps);
+    ASSERT_DOUBLE_EQ(results_serial[i].max_lat_error, results_parallel[i].max_lat_error);
+    ASSERT_DOUBLE_EQ(results_serial[i].rms_lat_error, results_parallel[i].rms_lat_error);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
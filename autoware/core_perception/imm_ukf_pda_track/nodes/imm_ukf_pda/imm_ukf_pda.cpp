@@ -268,7 +268,9 @@ bool ImmUkfPda::storeObjectWithNearestLaneDirection(const autoware_msgs::Detecte
   double min_dist = std::numeric_limits<double>::max();
 
   double min_yaw = 0;
-  for (auto const& lane : lanes_)
+  // lanes whose start point is within the threshold are a subset of the lanes near the pose
+  for (auto const& lane : vmap_.findNear<vector_map_msgs::Lane>(lane_frame_pose.position,
+                                                                nearest_lane_distance_threshold_))
   {
     vector_map_msgs::Node node = vmap_.findByKey(vector_map::Key<vector_map_msgs::Node>(lane.bnid));
     vector_map_msgs::Point point = vmap_.findByKey(vector_map::Key<vector_map_msgs::Point>(node.pid));
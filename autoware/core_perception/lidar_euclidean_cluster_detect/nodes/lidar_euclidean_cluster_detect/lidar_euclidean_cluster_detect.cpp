@@ -4,6 +4,7 @@
 #include <sstream>
 #include <limits>
 #include <cmath>
+#include <memory>
 
 #include <ros/ros.h>
 
@@ -51,6 +52,7 @@
 #include "autoware_msgs/DetectedObject.h"
 #include "autoware_msgs/DetectedObjectArray.h"
 
+#include <object_payload_store/object_payload_store.h>
 #include <vector_map/vector_map.h>
 
 #include <tf/tf.h>
@@ -123,6 +125,8 @@ static double _cluster_merge_threshold;
 static double _clustering_distance;
 
 static bool _use_gpu;
+static bool _lean_payloads;
+static std::unique_ptr<object_payload_store::PayloadStore> _payload_store;
 static std::chrono::system_clock::time_point _start, _end;
 
 std::vector<std::vector<geometry_msgs::Point>> _way_area_points;
@@ -210,6 +214,9 @@ void publishDetectedObjects(const autoware_msgs::CloudClusterArray &in_clusters)
     detected_object.pointcloud = in_clusters.clusters[i].cloud;
     detected_object.convex_hull = in_clusters.clusters[i].convex_hull;
     detected_object.valid = true;
+    // lean mode, publish a reference to the cluster cloud instead of the cloud
+    if (_payload_store)
+      _payload_store->store(detected_object);
 
     detected_objects.objects.push_back(detected_object);
   }
@@ -1046,6 +1053,15 @@ int main(int argc, char **argv)
   private_nh.param("use_gpu", _use_gpu, false);
   ROS_INFO("[%s] use_gpu: %d", __APP_NAME__, _use_gpu);
 
+  private_nh.param("lean_payloads", _lean_payloads, false);
+  ROS_INFO("[%s] lean_payloads: %d", __APP_NAME__, _lean_payloads);
+  if (_lean_payloads)
+  {
+    _payload_store.reset(new object_payload_store::PayloadStore());
+    if (!_payload_store->isOpen())
+      _payload_store.reset();
+  }
+
   private_nh.param("use_multiple_thres", _use_multiple_thres, false);
   ROS_INFO("[%s] use_multiple_thres: %d", __APP_NAME__, _use_multiple_thres);
 
@@ -37,6 +37,7 @@
 #include <std_msgs/Bool.h>
 #include <std_msgs/Float32.h>
 #include <std_msgs/String.h>
+#include <std_srvs/Trigger.h>
 #include <velodyne_pointcloud/point_types.h>
 #include <velodyne_pointcloud/rawdata.h>
 
@@ -69,6 +70,8 @@
 //headers in Autoware Health Checker
 #include <autoware_health_checker/health_checker/health_checker.h>
 
+#include "ndt_relocalizer.h"
+
 #define PREDICT_POSE_THRESHOLD 0.5
 
 #define Wa 0.4
@@ -120,8 +123,17 @@ static std::shared_ptr<gpu::GNormalDistributionsTransform> anh_gpu_ndt_ptr =
 #endif
 #ifdef USE_PCL_OPENMP
 static pcl_omp::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ> omp_ndt;
+static pcl_omp::NeighborSearchMethod _omp_neighborhood_search_method = pcl_omp::KDTREE;
 #endif
 
+// Coarse map and parameters of the multi-hypothesis relocalization
+static NdtRelocalizer relocalizer;
+static bool _use_relocalization = false;
+static float _relocalization_resolution = 4.0;
+static NdtRelocalizer::Params _relocalization_params;
+static double _relocalization_fitness = 1.0;  // Fitness score accepted without refining further hypotheses
+static sensor_msgs::PointCloud2::ConstPtr latest_scan_msg;
+
 // Default values
 static int max_iter = 30;        // Maximum iterations
 static float ndt_res = 1.0;      // Resolution
@@ -513,6 +525,7 @@ static void map_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
       new_omp_ndt.setMaximumIterations(max_iter);
       new_omp_ndt.setStepSize(step_size);
       new_omp_ndt.setTransformationEpsilon(trans_eps);
+      new_omp_ndt.setNeighborhoodSearchMethod(_omp_neighborhood_search_method);
 
       new_omp_ndt.align(*output_cloud, Eigen::Matrix4f::Identity());
 
@@ -521,6 +534,16 @@ static void map_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
       pthread_mutex_unlock(&mutex);
     }
 #endif
+
+    if (_use_relocalization == true)
+    {
+      NdtRelocalizer new_relocalizer;
+      new_relocalizer.setMap(map, _relocalization_resolution);
+
+      pthread_mutex_lock(&mutex);
+      relocalizer = std::move(new_relocalizer);
+      pthread_mutex_unlock(&mutex);
+    }
     map_loaded = 1;
   }
 }
@@ -592,54 +615,129 @@ static void gnss_callback(const geometry_msgs::PoseStamped::ConstPtr& input)
   previous_gnss_time = current_gnss_time;
 }
 
-static void initialpose_callback(const geometry_msgs::PoseWithCovarianceStamped::ConstPtr& input)
+// Align scan to the map with the configured method. mutex must be locked.
+static bool align_scan(const pcl::PointCloud<pcl::PointXYZ>::Ptr& scan, const Eigen::Matrix4f& guess,
+                       Eigen::Matrix4f& result, double& fitness)
 {
-  tf2_ros::Buffer tf_buffer;
-  tf2_ros::TransformListener tf_listener(tf_buffer);
-  geometry_msgs::TransformStamped tf_msg;
-  try
+  pcl::PointCloud<pcl::PointXYZ> output_cloud;
+  bool converged = false;
+  if (_method_type == MethodType::PCL_GENERIC)
   {
-    tf_msg = tf_buffer.lookupTransform("map", input->header.frame_id, ros::Time::now(), ros::Duration(3.0));
+    ndt.setInputSource(scan);
+    ndt.align(output_cloud, guess);
+    converged = ndt.hasConverged();
+    result = ndt.getFinalTransformation();
+    fitness = ndt.getFitnessScore();
   }
-  catch (tf2::TransformException& ex)
+  else if (_method_type == MethodType::PCL_ANH)
   {
-    ROS_ERROR("%s", ex.what());
+    anh_ndt.setInputSource(scan);
+    anh_ndt.align(guess);
+    converged = anh_ndt.hasConverged();
+    result = anh_ndt.getFinalTransformation();
+    fitness = anh_ndt.getFitnessScore();
   }
-
-  tf2::Quaternion q(input->pose.pose.orientation.x, input->pose.pose.orientation.y, input->pose.pose.orientation.z,
-                   input->pose.pose.orientation.w);
-  tf2::Matrix3x3 m(q);
-
-  if (_use_local_transform == true)
+#ifdef CUDA_FOUND
+  else if (_method_type == MethodType::PCL_ANH_GPU)
   {
-    current_pose.x = input->pose.pose.position.x;
-    current_pose.y = input->pose.pose.position.y;
-    current_pose.z = input->pose.pose.position.z;
+    anh_gpu_ndt_ptr->setInputSource(scan);
+    anh_gpu_ndt_ptr->align(guess);
+    converged = anh_gpu_ndt_ptr->hasConverged();
+    result = anh_gpu_ndt_ptr->getFinalTransformation();
+    fitness = anh_gpu_ndt_ptr->getFitnessScore();
   }
-  else
+#endif
+#ifdef USE_PCL_OPENMP
+  else if (_method_type == MethodType::PCL_OPENMP)
   {
-    current_pose.x = input->pose.pose.position.x + tf_msg.transform.translation.x;
-    current_pose.y = input->pose.pose.position.y + tf_msg.transform.translation.y;
-    current_pose.z = input->pose.pose.position.z + tf_msg.transform.translation.z;
+    omp_ndt.setInputSource(scan);
+    omp_ndt.align(output_cloud, guess);
+    converged = omp_ndt.hasConverged();
+    result = omp_ndt.getFinalTransformation();
+    fitness = omp_ndt.getFitnessScore();
   }
-  m.getRPY(current_pose.roll, current_pose.pitch, current_pose.yaw);
+#endif
+  return converged;
+}
 
-  if (_get_height == true && map_loaded == 1)
+// Search for the pose of the latest scan around base_pose, and overwrite base_pose with it if found.
+// Hypotheses scored on the coarse map are refined with NDT from the best one, until one fits well enough.
+static bool relocalize(pose& base_pose)
+{
+  if (map_loaded != 1 || !latest_scan_msg)
   {
-    double min_distance = DBL_MAX;
-    double nearest_z = current_pose.z;
-    for (const auto& p : map)
+    ROS_WARN("Relocalization needs a map and a scan.");
+    return false;
+  }
+
+  const std::chrono::time_point<std::chrono::system_clock> relocalization_start = std::chrono::system_clock::now();
+
+  pcl::PointCloud<pcl::PointXYZ>::Ptr scan_ptr(new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::fromROSMsg(*latest_scan_msg, *scan_ptr);
+
+  Eigen::Translation3f prior_translation(base_pose.x, base_pose.y, base_pose.z);
+  Eigen::AngleAxisf prior_rotation_x(base_pose.roll, Eigen::Vector3f::UnitX());
+  Eigen::AngleAxisf prior_rotation_y(base_pose.pitch, Eigen::Vector3f::UnitY());
+  Eigen::AngleAxisf prior_rotation_z(base_pose.yaw, Eigen::Vector3f::UnitZ());
+  const Eigen::Matrix4f prior =
+      (prior_translation * prior_rotation_z * prior_rotation_y * prior_rotation_x) * tf_btol;
+
+  pthread_mutex_lock(&mutex);
+  const NdtRelocalizer::Hypotheses hypotheses =
+      relocalizer.searchHypotheses(*scan_ptr, prior, _relocalization_params);
+
+  bool found = false;
+  double best_fitness = DBL_MAX;
+  Eigen::Matrix4f best_t(Eigen::Matrix4f::Identity());
+  size_t refined_num = 0;
+  for (const auto& hypothesis : hypotheses)
+  {
+    Eigen::Matrix4f t;
+    double hypothesis_fitness;
+    refined_num++;
+    if (align_scan(scan_ptr, hypothesis.pose, t, hypothesis_fitness) && hypothesis_fitness < best_fitness)
     {
-      double distance = hypot(current_pose.x - p.x, current_pose.y - p.y);
-      if (distance < min_distance)
-      {
-        min_distance = distance;
-        nearest_z = p.z;
-      }
+      found = true;
+      best_fitness = hypothesis_fitness;
+      best_t = t;
     }
-    current_pose.z = nearest_z;
+    if (best_fitness <= _relocalization_fitness)
+    {
+      break;
+    }
+  }
+  pthread_mutex_unlock(&mutex);
+
+  const double relocalization_time =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - relocalization_start)
+          .count() / 1000.0;
+  if (!found)
+  {
+    ROS_WARN("Relocalization failed: no hypothesis converged (%.1f ms).", relocalization_time);
+    return false;
   }
 
+  const Eigen::Matrix4f best_t2 = best_t * tf_btol.inverse();
+  tf2::Matrix3x3 mat_b;  // base_link
+  mat_b.setValue(static_cast<double>(best_t2(0, 0)), static_cast<double>(best_t2(0, 1)),
+                 static_cast<double>(best_t2(0, 2)), static_cast<double>(best_t2(1, 0)),
+                 static_cast<double>(best_t2(1, 1)), static_cast<double>(best_t2(1, 2)),
+                 static_cast<double>(best_t2(2, 0)), static_cast<double>(best_t2(2, 1)),
+                 static_cast<double>(best_t2(2, 2)));
+  base_pose.x = best_t2(0, 3);
+  base_pose.y = best_t2(1, 3);
+  base_pose.z = best_t2(2, 3);
+  mat_b.getRPY(base_pose.roll, base_pose.pitch, base_pose.yaw, 1);
+
+  ROS_INFO("Relocalized at (%.2f, %.2f, %.2f) yaw %.3f, fitness %.3f after refining %zu of %zu hypotheses (%.1f ms).",
+           base_pose.x, base_pose.y, base_pose.z, base_pose.yaw, best_fitness, refined_num, hypotheses.size(),
+           relocalization_time);
+  return true;
+}
+
+// Restart the motion estimation from current_pose
+static void reset_motion()
+{
   current_pose_imu = current_pose_odom = current_pose_imu_odom = current_pose;
   previous_pose.x = current_pose.x;
   previous_pose.y = current_pose.y;
@@ -688,6 +786,84 @@ static void initialpose_callback(const geometry_msgs::PoseWithCovarianceStamped:
   init_pos_set = 1;
 }
 
+static bool relocalize_callback(std_srvs::Trigger::Request& req, std_srvs::Trigger::Response& res)
+{
+  if (_use_relocalization == false)
+  {
+    res.success = false;
+    res.message = "use_relocalization is disabled.";
+    return true;
+  }
+
+  res.success = relocalize(current_pose);
+  if (res.success == true)
+  {
+    reset_motion();
+    res.message = "Relocalized.";
+  }
+  else
+  {
+    res.message = "Relocalization failed.";
+  }
+  return true;
+}
+
+static void initialpose_callback(const geometry_msgs::PoseWithCovarianceStamped::ConstPtr& input)
+{
+  tf2_ros::Buffer tf_buffer;
+  tf2_ros::TransformListener tf_listener(tf_buffer);
+  geometry_msgs::TransformStamped tf_msg;
+  try
+  {
+    tf_msg = tf_buffer.lookupTransform("map", input->header.frame_id, ros::Time::now(), ros::Duration(3.0));
+  }
+  catch (tf2::TransformException& ex)
+  {
+    ROS_ERROR("%s", ex.what());
+  }
+
+  tf2::Quaternion q(input->pose.pose.orientation.x, input->pose.pose.orientation.y, input->pose.pose.orientation.z,
+                   input->pose.pose.orientation.w);
+  tf2::Matrix3x3 m(q);
+
+  if (_use_local_transform == true)
+  {
+    current_pose.x = input->pose.pose.position.x;
+    current_pose.y = input->pose.pose.position.y;
+    current_pose.z = input->pose.pose.position.z;
+  }
+  else
+  {
+    current_pose.x = input->pose.pose.position.x + tf_msg.transform.translation.x;
+    current_pose.y = input->pose.pose.position.y + tf_msg.transform.translation.y;
+    current_pose.z = input->pose.pose.position.z + tf_msg.transform.translation.z;
+  }
+  m.getRPY(current_pose.roll, current_pose.pitch, current_pose.yaw);
+
+  if (_get_height == true && map_loaded == 1)
+  {
+    double min_distance = DBL_MAX;
+    double nearest_z = current_pose.z;
+    for (const auto& p : map)
+    {
+      double distance = hypot(current_pose.x - p.x, current_pose.y - p.y);
+      if (distance < min_distance)
+      {
+        min_distance = distance;
+        nearest_z = p.z;
+      }
+    }
+    current_pose.z = nearest_z;
+  }
+
+  if (_use_relocalization == true)
+  {
+    relocalize(current_pose);
+  }
+
+  reset_motion();
+}
+
 static void imu_odom_calc(ros::Time current_time)
 {
   static ros::Time previous_time = current_time;
@@ -919,6 +1095,7 @@ static void imu_callback(const sensor_msgs::Imu::Ptr& input)
 static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
 {
   health_checker_ptr_->CHECK_RATE("topic_rate_filtered_points_slow", 8, 5, 1, "topic filtered_points subscribe rate slow.");
+  latest_scan_msg = input;
   if (map_loaded == 1 && init_pos_set == 1)
   {
     matching_start = std::chrono::system_clock::now();
@@ -1551,6 +1728,24 @@ int main(int argc, char** argv)
   private_nh.getParam("imu_topic", _imu_topic);
   private_nh.param<double>("gnss_reinit_fitness", _gnss_reinit_fitness, 500.0);
   private_nh.getParam("output_tf_frame_id", _output_tf_frame_id);
+  private_nh.getParam("use_relocalization", _use_relocalization);
+  private_nh.getParam("relocalization_resolution", _relocalization_resolution);
+  private_nh.getParam("relocalization_search_radius", _relocalization_params.search_radius);
+  private_nh.getParam("relocalization_search_step", _relocalization_params.search_step);
+  private_nh.getParam("relocalization_yaw_range", _relocalization_params.yaw_range);
+  private_nh.getParam("relocalization_yaw_step", _relocalization_params.yaw_step);
+  private_nh.getParam("relocalization_top_k", _relocalization_params.top_k);
+  private_nh.getParam("relocalization_fitness", _relocalization_fitness);
+#ifdef USE_PCL_OPENMP
+  int omp_neighborhood_search_method_tmp = 0;
+  private_nh.getParam("omp_neighborhood_search_method", omp_neighborhood_search_method_tmp);
+  if (omp_neighborhood_search_method_tmp < pcl_omp::KDTREE || omp_neighborhood_search_method_tmp > pcl_omp::DIRECT1)
+  {
+    ROS_WARN("Unknown omp_neighborhood_search_method %d, using kdtree (0).", omp_neighborhood_search_method_tmp);
+    omp_neighborhood_search_method_tmp = pcl_omp::KDTREE;
+  }
+  _omp_neighborhood_search_method = static_cast<pcl_omp::NeighborSearchMethod>(omp_neighborhood_search_method_tmp);
+#endif
 
   std::string lidar_frame;
   nh.param("localizer", lidar_frame, std::string("lidar"));
@@ -1642,6 +1837,10 @@ int main(int argc, char** argv)
   std::cout << "imu_topic: " << _imu_topic << std::endl;
   std::cout << "localizer: " << lidar_frame << std::endl;
   std::cout << "gnss_reinit_fitness: " << _gnss_reinit_fitness << std::endl;
+  std::cout << "use_relocalization: " << _use_relocalization << std::endl;
+#ifdef USE_PCL_OPENMP
+  std::cout << "omp_neighborhood_search_method: " << static_cast<int>(_omp_neighborhood_search_method) << std::endl;
+#endif
   std::cout << "tf_baselink2primarylidar: \n" << tf_btol << std::endl;
   std::cout << "-----------------------------------------------------------------" << std::endl;
 
@@ -1698,6 +1897,9 @@ int main(int argc, char** argv)
   ros::Subscriber imu_sub = nh.subscribe(_imu_topic.c_str(), _queue_size * 10, imu_callback);
   ros::Subscriber twist_sub = nh.subscribe("vehicle/twist", 10, vehicle_twist_callback);
 
+  // Services
+  ros::ServiceServer relocalize_srv = private_nh.advertiseService("relocalize", relocalize_callback);
+
   pthread_t thread;
   pthread_create(&thread, NULL, thread_func, NULL);
 
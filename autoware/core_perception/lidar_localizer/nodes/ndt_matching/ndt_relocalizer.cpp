@@ -0,0 +1,217 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ndt_relocalizer.h"
+
+#include <algorithm>
+
+#include <Eigen/Eigenvalues>
+#include <Eigen/Geometry>
+
+namespace
+{
+// Voxels with fewer points have no meaningful covariance, as in pcl::VoxelGridCovariance
+constexpr int MIN_POINTS_PER_CELL = 6;
+// Smallest eigenvalue of a covariance relative to the largest one, as in pcl::VoxelGridCovariance
+constexpr double MIN_COVARIANCE_EIGENVALUE_RATIO = 0.01;
+
+struct CellSums
+{
+  Eigen::Vector3d sum = Eigen::Vector3d::Zero();
+  Eigen::Matrix3d squared_sum = Eigen::Matrix3d::Zero();
+  int num_points = 0;
+};
+}  // namespace
+
+NdtRelocalizer::NdtRelocalizer() : resolution_(1.0f)
+{
+}
+
+int64_t NdtRelocalizer::cellKey(const Eigen::Vector3f& point) const
+{
+  const float inverse_resolution = 1.0f / resolution_;
+  const int x = static_cast<int>(std::floor(point.x() * inverse_resolution));
+  const int y = static_cast<int>(std::floor(point.y() * inverse_resolution));
+  const int z = static_cast<int>(std::floor(point.z() * inverse_resolution));
+  // 21 bits per axis
+  return (static_cast<int64_t>(x & 0x1FFFFF) << 42) | (static_cast<int64_t>(y & 0x1FFFFF) << 21) |
+         static_cast<int64_t>(z & 0x1FFFFF);
+}
+
+void NdtRelocalizer::setMap(const pcl::PointCloud<pcl::PointXYZ>& map, float resolution)
+{
+  resolution_ = resolution;
+  cells_.clear();
+
+  std::unordered_map<int64_t, CellSums> sums;
+  for (const auto& p : map)
+  {
+    if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z))
+    {
+      continue;
+    }
+    const Eigen::Vector3f point(p.x, p.y, p.z);
+    const Eigen::Vector3d point_d = point.cast<double>();
+    CellSums& cell_sums = sums[cellKey(point)];
+    cell_sums.sum += point_d;
+    cell_sums.squared_sum += point_d * point_d.transpose();
+    cell_sums.num_points++;
+  }
+
+  cells_.reserve(sums.size());
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigensolver;
+  for (const auto& key_sums : sums)
+  {
+    const CellSums& cell_sums = key_sums.second;
+    if (cell_sums.num_points < MIN_POINTS_PER_CELL)
+    {
+      continue;
+    }
+    const Eigen::Vector3d mean = cell_sums.sum / cell_sums.num_points;
+    const Eigen::Matrix3d cov =
+        (cell_sums.squared_sum - cell_sums.num_points * mean * mean.transpose()) / (cell_sums.num_points - 1);
+
+    // Inflate flat distributions so that their inverse stays bounded
+    eigensolver.compute(cov);
+    Eigen::Vector3d eigenvalues = eigensolver.eigenvalues();
+    const double min_eigenvalue = MIN_COVARIANCE_EIGENVALUE_RATIO * eigenvalues(2);
+    if (!(min_eigenvalue > 0.0))
+    {
+      continue;
+    }
+    eigenvalues = eigenvalues.cwiseMax(min_eigenvalue);
+    const Eigen::Matrix3d& eigenvectors = eigensolver.eigenvectors();
+
+    Cell& cell = cells_[key_sums.first];
+    cell.mean = mean.cast<float>();
+    cell.inverse_cov =
+        (eigenvectors * eigenvalues.cwiseInverse().asDiagonal() * eigenvectors.transpose()).cast<float>();
+  }
+}
+
+bool NdtRelocalizer::hasMap() const
+{
+  return !cells_.empty();
+}
+
+double NdtRelocalizer::score(const std::vector<Eigen::Vector3f>& points, const Eigen::Matrix4f& pose) const
+{
+  if (points.empty())
+  {
+    return 0.0;
+  }
+
+  const Eigen::Matrix3f rotation = pose.topLeftCorner<3, 3>();
+  const Eigen::Vector3f translation = pose.topRightCorner<3, 1>();
+  double likelihood = 0.0;
+  for (const auto& point : points)
+  {
+    const Eigen::Vector3f transformed = rotation * point + translation;
+    const auto cell = cells_.find(cellKey(transformed));
+    if (cell != cells_.end())
+    {
+      const Eigen::Vector3f d = transformed - cell->second.mean;
+      likelihood += std::exp(-0.5f * d.dot(cell->second.inverse_cov * d));
+    }
+  }
+  return likelihood / points.size();
+}
+
+NdtRelocalizer::Hypotheses NdtRelocalizer::searchHypotheses(const pcl::PointCloud<pcl::PointXYZ>& scan,
+                                                            const Eigen::Matrix4f& prior, const Params& params) const
+{
+  Hypotheses hypotheses;
+  if (cells_.empty() || scan.empty() || params.search_step <= 0.0 || params.yaw_step <= 0.0 || params.top_k <= 0)
+  {
+    return hypotheses;
+  }
+
+  // Spread the scored points over the whole scan
+  const size_t stride = std::max<size_t>(1, scan.size() / std::max(1, params.max_scan_points));
+  std::vector<Eigen::Vector3f> points;
+  points.reserve(scan.size() / stride + 1);
+  for (size_t i = 0; i < scan.size(); i += stride)
+  {
+    const pcl::PointXYZ& p = scan[i];
+    if (std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z))
+    {
+      points.emplace_back(p.x, p.y, p.z);
+    }
+  }
+
+  const int num_steps = static_cast<int>(std::floor(params.search_radius / params.search_step));
+  const int num_yaw_steps = static_cast<int>(std::floor(params.yaw_range / params.yaw_step));
+  // Do not score the heading opposite to the prior twice
+  const bool full_turn = 2.0 * num_yaw_steps * params.yaw_step >= 2.0 * M_PI - 1e-6;
+
+  for (int yaw_index = -num_yaw_steps; yaw_index <= num_yaw_steps - (full_turn ? 1 : 0); yaw_index++)
+  {
+    Eigen::Matrix4f rotated = prior;
+    rotated.topLeftCorner<3, 3>() =
+        Eigen::AngleAxisf(yaw_index * params.yaw_step, Eigen::Vector3f::UnitZ()) * prior.topLeftCorner<3, 3>();
+    for (int x_index = -num_steps; x_index <= num_steps; x_index++)
+    {
+      for (int y_index = -num_steps; y_index <= num_steps; y_index++)
+      {
+        Hypothesis hypothesis;
+        hypothesis.pose = rotated;
+        hypothesis.pose(0, 3) += x_index * params.search_step;
+        hypothesis.pose(1, 3) += y_index * params.search_step;
+        hypothesis.score = 0.0;
+        hypotheses.push_back(hypothesis);
+      }
+    }
+  }
+
+#pragma omp parallel for schedule(dynamic, 16)
+  for (size_t i = 0; i < hypotheses.size(); i++)
+  {
+    hypotheses[i].score = score(points, hypotheses[i].pose);
+  }
+
+  std::sort(hypotheses.begin(), hypotheses.end(),
+            [](const Hypothesis& a, const Hypothesis& b) { return a.score > b.score; });
+
+  // Keep the best hypotheses which are not next to a better one, so that the refinement tries distinct poses
+  Hypotheses best;
+  const float distance_threshold = 1.5f * params.search_step;
+  const float yaw_threshold = 1.5f * params.yaw_step;
+  for (const auto& hypothesis : hypotheses)
+  {
+    if (best.size() >= static_cast<size_t>(params.top_k))
+    {
+      break;
+    }
+    bool is_distinct = true;
+    for (const auto& better : best)
+    {
+      const float distance = (hypothesis.pose.topRightCorner<2, 1>() - better.pose.topRightCorner<2, 1>()).norm();
+      const Eigen::Matrix3f relative_rotation =
+          better.pose.topLeftCorner<3, 3>().transpose() * hypothesis.pose.topLeftCorner<3, 3>();
+      const float yaw = std::abs(std::atan2(relative_rotation(1, 0), relative_rotation(0, 0)));
+      if (distance < distance_threshold && yaw < yaw_threshold)
+      {
+        is_distinct = false;
+        break;
+      }
+    }
+    if (is_distinct)
+    {
+      best.push_back(hypothesis);
+    }
+  }
+  return best;
+}
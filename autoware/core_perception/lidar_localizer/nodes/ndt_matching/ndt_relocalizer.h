@@ -0,0 +1,102 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NDT_RELOCALIZER_H
+#define NDT_RELOCALIZER_H
+
+#include <stdint.h>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+/*
+ * Global relocalization against a coarse normal distributions map.
+ *
+ * A grid of (x, y, yaw) hypotheses around a prior sensor pose is scored in parallel by how well the scan
+ * fits the coarse voxels, without any optimization. The best hypotheses are then meant to be refined by
+ * the full resolution NDT of ndt_matching.
+ */
+class NdtRelocalizer
+{
+public:
+  struct Params
+  {
+    // Half width of the square of positions searched around the prior [m]
+    double search_radius = 3.0;
+    // Distance between searched positions [m]
+    double search_step = 1.0;
+    // Half range of the headings searched around the prior [rad]
+    double yaw_range = M_PI;
+    // Angle between searched headings [rad]
+    double yaw_step = M_PI / 18.0;
+    // Number of scan points used to score a hypothesis, spread evenly over the scan
+    int max_scan_points = 1000;
+    // Number of best hypotheses returned
+    int top_k = 5;
+  };
+
+  struct Hypothesis
+  {
+    Eigen::Matrix4f pose;
+    // Mean likelihood of the scan points, between 0 and 1
+    double score;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  typedef std::vector<Hypothesis, Eigen::aligned_allocator<Hypothesis>> Hypotheses;
+
+  NdtRelocalizer();
+
+  // Build the coarse voxels of the map, replacing the previous ones
+  void setMap(const pcl::PointCloud<pcl::PointXYZ>& map, float resolution);
+
+  bool hasMap() const;
+
+  // Score the hypotheses around prior, the pose of the scan in the map, and return the best ones sorted
+  // by descending score. The prior heading is kept and the searched headings are added to it.
+  Hypotheses searchHypotheses(const pcl::PointCloud<pcl::PointXYZ>& scan, const Eigen::Matrix4f& prior,
+                              const Params& params) const;
+
+  // Mean likelihood of points at pose, between 0 and 1
+  double score(const std::vector<Eigen::Vector3f>& points, const Eigen::Matrix4f& pose) const;
+
+private:
+  struct Cell
+  {
+    Eigen::Vector3f mean;
+    Eigen::Matrix3f inverse_cov;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  typedef std::unordered_map<int64_t, Cell, std::hash<int64_t>, std::equal_to<int64_t>,
+                             Eigen::aligned_allocator<std::pair<const int64_t, Cell>>>
+      CellMap;
+
+  int64_t cellKey(const Eigen::Vector3f& point) const;
+
+  CellMap cells_;
+  float resolution_;
+};
+
+#endif  // NDT_RELOCALIZER_H
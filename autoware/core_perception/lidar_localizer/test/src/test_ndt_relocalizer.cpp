@@ -0,0 +1,138 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include <Eigen/Geometry>
+
+#include "../../nodes/ndt_matching/ndt_relocalizer.h"
+
+class TestSuite : public ::testing::Test
+{
+public:
+  TestSuite() = default;
+  ~TestSuite() = default;
+
+  // An asymmetric room: floor, three walls and a pillar, so that a single pose fits
+  static pcl::PointCloud<pcl::PointXYZ> makeRoom()
+  {
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> noise(-0.02f, 0.02f);
+    pcl::PointCloud<pcl::PointXYZ> room;
+    for (float a = -15.0f; a <= 15.0f; a += 0.1f)
+    {
+      for (float b = 0.0f; b <= 3.0f; b += 0.1f)
+      {
+        room.push_back(pcl::PointXYZ(a, 10.0f + noise(rng), b));
+        room.push_back(pcl::PointXYZ(-15.0f + noise(rng), a * 0.66f, b));
+        if (a < 5.0f)
+        {
+          room.push_back(pcl::PointXYZ(a, -10.0f + noise(rng), b));
+        }
+      }
+      for (float b = -10.0f; b <= 10.0f; b += 0.2f)
+      {
+        room.push_back(pcl::PointXYZ(a, b, noise(rng)));
+      }
+    }
+    for (float angle = 0.0f; angle < 2.0f * M_PI; angle += 0.05f)
+    {
+      for (float z = 0.0f; z <= 3.0f; z += 0.1f)
+      {
+        room.push_back(pcl::PointXYZ(6.0f + 0.5f * std::cos(angle), 3.0f + 0.5f * std::sin(angle), z));
+      }
+    }
+    return room;
+  }
+
+  static Eigen::Matrix4f makePose(float x, float y, float yaw)
+  {
+    Eigen::Affine3f pose = Eigen::Translation3f(x, y, 0.0f) * Eigen::AngleAxisf(yaw, Eigen::Vector3f::UnitZ());
+    return pose.matrix();
+  }
+};
+
+TEST_F(TestSuite, CheckScorePeaksAtTruePose)
+{
+  const pcl::PointCloud<pcl::PointXYZ> room = makeRoom();
+  NdtRelocalizer relocalizer;
+  ASSERT_FALSE(relocalizer.hasMap());
+  relocalizer.setMap(room, 2.0f);
+  ASSERT_TRUE(relocalizer.hasMap());
+
+  std::vector<Eigen::Vector3f> points;
+  for (size_t i = 0; i < room.size(); i += 10)
+  {
+    points.emplace_back(room[i].x, room[i].y, room[i].z);
+  }
+  const double true_score = relocalizer.score(points, Eigen::Matrix4f::Identity());
+  EXPECT_GT(true_score, 0.3);
+  EXPECT_LE(true_score, 1.0);
+  EXPECT_LT(relocalizer.score(points, makePose(1.0f, 0.0f, 0.0f)), true_score);
+  EXPECT_LT(relocalizer.score(points, makePose(0.0f, 0.0f, 0.3f)), true_score);
+  EXPECT_EQ(relocalizer.score(std::vector<Eigen::Vector3f>(), Eigen::Matrix4f::Identity()), 0.0);
+}
+
+TEST_F(TestSuite, CheckSearchHypothesesFindsScanPose)
+{
+  NdtRelocalizer relocalizer;
+  relocalizer.setMap(makeRoom(), 2.0f);
+
+  // The scan is the room seen from a sensor at (2, -3) heading 1 rad
+  const Eigen::Matrix4f scan_pose = makePose(2.0f, -3.0f, 1.0f);
+  const pcl::PointCloud<pcl::PointXYZ> room = makeRoom();
+  pcl::PointCloud<pcl::PointXYZ> scan;
+  const Eigen::Matrix4f map_to_scan = scan_pose.inverse();
+  for (size_t i = 0; i < room.size(); i += 5)
+  {
+    const Eigen::Vector4f p = map_to_scan * Eigen::Vector4f(room[i].x, room[i].y, room[i].z, 1.0f);
+    scan.push_back(pcl::PointXYZ(p.x(), p.y(), p.z()));
+  }
+
+  NdtRelocalizer::Params params;
+  params.search_radius = 4.0;
+  params.search_step = 1.0;
+  params.yaw_range = M_PI;
+  params.yaw_step = M_PI / 18.0;
+  params.top_k = 3;
+  const NdtRelocalizer::Hypotheses hypotheses =
+      relocalizer.searchHypotheses(scan, makePose(0.0f, 0.0f, 0.0f), params);
+
+  ASSERT_EQ(hypotheses.size(), 3u);
+  EXPECT_GE(hypotheses[0].score, hypotheses[1].score);
+  EXPECT_GE(hypotheses[1].score, hypotheses[2].score);
+  // The best hypothesis is the grid pose closest to the scan pose
+  EXPECT_NEAR(hypotheses[0].pose(0, 3), 2.0, 0.5);
+  EXPECT_NEAR(hypotheses[0].pose(1, 3), -3.0, 0.5);
+  const float yaw = std::atan2(hypotheses[0].pose(1, 0), hypotheses[0].pose(0, 0));
+  EXPECT_NEAR(yaw, 1.0, params.yaw_step);
+}
+
+TEST_F(TestSuite, CheckSearchHypothesesWithoutMap)
+{
+  NdtRelocalizer relocalizer;
+  pcl::PointCloud<pcl::PointXYZ> scan;
+  scan.push_back(pcl::PointXYZ(1.0f, 0.0f, 0.0f));
+  EXPECT_TRUE(relocalizer.searchHypotheses(scan, Eigen::Matrix4f::Identity(), NdtRelocalizer::Params()).empty());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -17,6 +17,8 @@
 #ifndef OBJECT_TRACKING_BOX_FITTING_H
 #define OBJECT_TRACKING_BOX_FITTING_H
 
+#include <memory>
+
 #include <ros/ros.h>
 
 #include <opencv2/opencv.hpp>
@@ -24,6 +26,7 @@
 
 #include "autoware_msgs/DetectedObject.h"
 #include "autoware_msgs/DetectedObjectArray.h"
+#include "object_payload_store/object_payload_store.h"
 
 class LShapeFilter
 {
@@ -38,6 +41,7 @@ private:
   ros::NodeHandle node_handle_;
   ros::Subscriber sub_object_array_;
   ros::Publisher pub_object_array_;
+  std::unique_ptr<object_payload_store::PayloadStore> payload_store_;
 
   void callback(const autoware_msgs::DetectedObjectArray& input);
   void updateCpFromPoints(const std::vector<cv::Point2f>& pointcloud_frame_points,
@@ -177,7 +177,25 @@ void LShapeFilter::getLShapeBB(const autoware_msgs::DetectedObjectArray& in_obje
     pcl::PointCloud<pcl::PointXYZ> cloud;
 
     // Convert from ros msg to PCL::pic_scalePointCloud data type
-    pcl::fromROSMsg(in_object.pointcloud, cloud);
+    if (object_payload_store::hasPayloadReference(in_object))
+    {
+      // objects published in lean mode keep their pointcloud in the payload store
+      if (!payload_store_)
+        payload_store_.reset(new object_payload_store::PayloadStore());
+      autoware_msgs::DetectedObject payload;
+      payload.payload_id = in_object.payload_id;
+      payload.payload_generation = in_object.payload_generation;
+      if (!payload_store_->resolve(payload))
+      {
+        ROS_WARN_THROTTLE(1, "payload of object %u is no longer in the payload store", in_object.id);
+        continue;
+      }
+      pcl::fromROSMsg(payload.pointcloud, cloud);
+    }
+    else
+    {
+      pcl::fromROSMsg(in_object.pointcloud, cloud);
+    }
 
     // calculating offset so that projecting pointcloud into cv::mat
     cv::Mat m(pic_scale_ * roi_m_, pic_scale_ * roi_m_, CV_8UC1, cv::Scalar(0));
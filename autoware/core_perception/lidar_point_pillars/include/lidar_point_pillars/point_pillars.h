@@ -138,6 +138,21 @@ private:
 
   int host_pillar_count_[1];
 
+  // host buffers of the CPU preprocessing, reused between frames
+  std::vector<int> host_x_coors_;
+  std::vector<int> host_y_coors_;
+  std::vector<float> host_num_points_per_pillar_;
+  std::vector<float> host_pillar_x_;
+  std::vector<float> host_pillar_y_;
+  std::vector<float> host_pillar_z_;
+  std::vector<float> host_pillar_i_;
+  std::vector<float> host_x_coors_for_sub_shaped_;
+  std::vector<float> host_y_coors_for_sub_shaped_;
+  std::vector<float> host_pillar_feature_mask_;
+  std::vector<float> host_sparse_pillar_map_;
+  // number of pillars copied to the device by the previous frame
+  int host_copied_pillar_count_;
+
   float* anchors_px_;
   float* anchors_py_;
   float* anchors_pz_;
@@ -24,6 +24,9 @@
 #ifndef PREPROCESS_POINTS_H
 #define PREPROCESS_POINTS_H
 
+// headers in STL
+#include <vector>
+
 class PreprocessPoints
 {
 private:
@@ -42,6 +45,50 @@ private:
   const int NUM_INDS_FOR_SCAN_;
   const int NUM_BOX_CORNERS_;
 
+  // grid cell to pillar index, -1 for every cell between two calls
+  std::vector<int> coor_to_pillaridx_;
+  // grid cell of each input point, -1 out of range
+  std::vector<int> point_cells_;
+  // index of each input point in the pillar arrays, -1 for dropped points
+  std::vector<int> point_slots_;
+  // number of pillars written by the previous call of preprocessReusingBuffers
+  int last_pillar_count_;
+
+  /**
+  * @brief Bin points into pillars
+  * @param[in] in_points_array Pointcloud array
+  * @param[in] in_num_points The number of points
+  * @param[out] x_coors X-coordinate indexes for corresponding pillars
+  * @param[out] y_coors Y-coordinate indexes for corresponding pillars
+  * @param[out] num_points_per_pillar Number of points in corresponding pillars, zero on input
+  * @param[out] pillar_x X-coordinate values for points in each pillar
+  * @param[out] pillar_y Y-coordinate values for points in each pillar
+  * @param[out] pillar_z Z-coordinate values for points in each pillar
+  * @param[out] pillar_i Intensity values for points in each pillar
+  * @param[out] sparse_pillar_map Grid map representation for pillar-occupancy
+  * @return The number of valid pillars
+  * @details Grid cells are computed and points are copied in parallel. Pillars are numbered in the order of their
+  *          first point, so the output does not depend on the number of threads
+  */
+  int scatterPoints(const float* in_points_array, int in_num_points, int* x_coors, int* y_coors,
+                    float* num_points_per_pillar, float* pillar_x, float* pillar_y, float* pillar_z, float* pillar_i,
+                    float* sparse_pillar_map);
+
+  /**
+  * @brief Fill the per-pillar arrays of the network input
+  * @param[in] pillar_count The number of valid pillars
+  * @param[in] num_rows Number of pillars to write, the ones after pillar_count are set to zero
+  * @param[in] x_coors X-coordinate indexes for corresponding pillars
+  * @param[in] y_coors Y-coordinate indexes for corresponding pillars
+  * @param[in] num_points_per_pillar Number of points in corresponding pillars
+  * @param[out] x_coors_for_sub_shaped Array for x substraction in the network
+  * @param[out] y_coors_for_sub_shaped Array for y substraction in the network
+  * @param[out] pillar_feature_mask Mask to make pillars' feature zero where no points in the pillars
+  */
+  void fillPillarFeatures(int pillar_count, int num_rows, const int* x_coors, const int* y_coors,
+                          const float* num_points_per_pillar, float* x_coors_for_sub_shaped,
+                          float* y_coors_for_sub_shaped, float* pillar_feature_mask);
+
 public:
   /**
   * @brief Constructor
@@ -88,6 +135,31 @@ public:
                   float* x_coors_for_sub_shaped, float* y_coors_for_sub_shaped, float* pillar_feature_mask,
                   float* sparse_pillar_map, int* host_pillar_count);
 
+  /**
+  * @brief CPU preprocessing for input pointcloud into arrays reused between frames
+  * @param[in] in_points_array Pointcloud array
+  * @param[in] in_num_points The number of points
+  * @param[in] x_coors X-coordinate indexes for corresponding pillars
+  * @param[in] y_coors Y-coordinate indexes for corresponding pillars
+  * @param[in] num_points_per_pillar Number of points in corresponding pillars
+  * @param[in] pillar_x X-coordinate values for points in each pillar
+  * @param[in] pillar_y Y-coordinate values for points in each pillar
+  * @param[in] pillar_z Z-coordinate values for points in each pillar
+  * @param[in] pillar_i Intensity values for points in each pillar
+  * @param[in] x_coors_for_sub_shaped Array for x substraction in the network
+  * @param[in] y_coors_for_sub_shaped Array for y substraction in the network
+  * @param[in] pillar_feature_mask Mask to make pillars' feature zero where no points in the pillars
+  * @param[in] sparse_pillar_map Grid map representation for pillar-occupancy
+  * @param[in] host_pillar_count The numnber of valid pillars for the input pointcloud
+  * @details Same output as preprocess. The arrays must be zero before the first call and must be the ones of the
+  *          previous call afterwards: only the pillars written by the previous call are cleared, so the cost follows
+  *          the number of points instead of the size of the arrays
+  */
+  void preprocessReusingBuffers(const float* in_points_array, int in_num_points, int* x_coors, int* y_coors,
+                                float* num_points_per_pillar, float* pillar_x, float* pillar_y, float* pillar_z,
+                                float* pillar_i, float* x_coors_for_sub_shaped, float* y_coors_for_sub_shaped,
+                                float* pillar_feature_mask, float* sparse_pillar_map, int* host_pillar_count);
+
   /**
   * @brief Initializing variables for preprocessing
   * @param[in] coor_to_pillaridx Map for converting one set of coordinate to a pillar
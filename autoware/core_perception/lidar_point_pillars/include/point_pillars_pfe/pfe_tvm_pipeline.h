@@ -36,10 +36,12 @@ public:
   * @brief Constructor
   * @param[in] config The configuration of the TVM network
   * @param[in] Pointer to the cuda stream to be used during operations
+  * @param[in] buffer_sets Number of input buffer sets used in turn, see
+  *            tvm_utility::pipeline::AsyncPipeline::bufferSets
   * @details Constructor for PFE pre-processor stage of the pipeline
   */
   PreProcessorPFE(tvm_utility::pipeline::InferenceEngineTVMConfig config,
-                  cudaStream_t* stream);
+                  cudaStream_t* stream, size_t buffer_sets = 1);
 
   /**
   * @brief Pipeline stage schedule function
@@ -51,9 +53,10 @@ public:
     schedule(const std::vector<float*> &net_input);
 
 private:
-  std::vector<uint64_t>                          net_input_size_byte_;
-  tvm_utility::pipeline::TVMArrayContainerVector pfe_buffers_;
-  cudaStream_t*                                  stream_;
+  std::vector<uint64_t>                                       net_input_size_byte_;
+  std::vector<tvm_utility::pipeline::TVMArrayContainerVector> pfe_buffers_;
+  size_t                                                      next_buffers_;
+  cudaStream_t*                                               stream_;
 };
 
 
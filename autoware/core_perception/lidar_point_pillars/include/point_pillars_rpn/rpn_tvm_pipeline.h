@@ -43,10 +43,12 @@ public:
   * @brief Constructor
   * @param[in] config The configuration of the TVM network
   * @param[in] stream Pointer to the cuda stream to be used during operations
+  * @param[in] buffer_sets Number of input buffers used in turn, see
+  *            tvm_utility::pipeline::AsyncPipeline::bufferSets
   * @details Constructor for RPN pre-processor stage of the pipeline
   */
   PreProcessorRPN(tvm_utility::pipeline::InferenceEngineTVMConfig config,
-  cudaStream_t* stream);
+  cudaStream_t* stream, size_t buffer_sets = 1);
 
   /**
   * @brief Pipeline stage schedule function
@@ -58,9 +60,10 @@ public:
     schedule(const std::vector<float*> &net_input);
 
 private:
-  tvm_utility::pipeline::TVMArrayContainer  rpn_net_input_;
-  uint64_t                                  net_input_size_byte_;
-  cudaStream_t*                             stream_;
+  std::vector<tvm_utility::pipeline::TVMArrayContainer> rpn_net_input_;
+  size_t                                                next_net_input_;
+  uint64_t                                              net_input_size_byte_;
+  cudaStream_t*                                         stream_;
 };
 
 
@@ -26,8 +26,10 @@
 
 PreProcessorPFE::PreProcessorPFE(
   tvm_utility::pipeline::InferenceEngineTVMConfig config,
-  cudaStream_t* stream
-  ) : stream_(stream)
+  cudaStream_t* stream,
+  size_t buffer_sets
+  ) : pfe_buffers_(std::max<size_t>(buffer_sets, 1)), next_buffers_(0),
+      stream_(stream)
 {
   // allocate input variables
   uint64_t net_input_size;
@@ -38,16 +40,18 @@ PreProcessorPFE::PreProcessorPFE(
       net_input_size *= config.network_inputs[i].second[j];
     }
     net_input_size *= (config.tvm_dtype_bits / 8);
-    tvm_utility::pipeline::TVMArrayContainer input_var {
-      config.network_inputs[i].second,
-      config.tvm_dtype_code,
-      config.tvm_dtype_bits,
-      config.tvm_dtype_lanes,
-      config.tvm_device_type,
-      config.tvm_device_id
-    };
+    for (auto &buffers : pfe_buffers_) {
+      tvm_utility::pipeline::TVMArrayContainer input_var {
+        config.network_inputs[i].second,
+        config.tvm_dtype_code,
+        config.tvm_dtype_bits,
+        config.tvm_dtype_lanes,
+        config.tvm_device_type,
+        config.tvm_device_id
+      };
+      buffers.push_back(input_var);
+    }
 
-    pfe_buffers_.push_back(input_var);
     net_input_size_byte_.push_back(net_input_size);
   }
 }
@@ -55,16 +59,21 @@ PreProcessorPFE::PreProcessorPFE(
 tvm_utility::pipeline::TVMArrayContainerVector
   PreProcessorPFE::schedule(const std::vector<float*> &net_input)
 {
+  // the inference stage may still read the previously returned buffers
+  tvm_utility::pipeline::TVMArrayContainerVector &buffers =
+    pfe_buffers_[next_buffers_];
+  next_buffers_ = (next_buffers_ + 1) % pfe_buffers_.size();
+
   for (uint64_t i = 0; i < 8; i++) {
 
-    GPU_CHECK(cudaMemcpyAsync(pfe_buffers_[i].getArray()->data,
+    GPU_CHECK(cudaMemcpyAsync(buffers[i].getArray()->data,
                               net_input[i],
                               net_input_size_byte_[i],
                               cudaMemcpyDeviceToHost,
                               *stream_));
   }
 
-  return pfe_buffers_;
+  return buffers;
 }
 
 PostProcessorPFE::PostProcessorPFE(
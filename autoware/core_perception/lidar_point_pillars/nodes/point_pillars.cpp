@@ -78,6 +78,19 @@ PointPillars::PointPillars(const bool reproduce_result_mode, const float score_t
                                                       GRID_Y_SIZE_, GRID_Z_SIZE_, PILLAR_X_SIZE_, PILLAR_Y_SIZE_,
                                                       PILLAR_Z_SIZE_, MIN_X_RANGE_, MIN_Y_RANGE_, MIN_Z_RANGE_,
                                                       NUM_INDS_FOR_SCAN_, NUM_BOX_CORNERS_));
+    host_x_coors_.resize(MAX_NUM_PILLARS_, 0);
+    host_y_coors_.resize(MAX_NUM_PILLARS_, 0);
+    host_num_points_per_pillar_.resize(MAX_NUM_PILLARS_, 0);
+    host_pillar_x_.resize(MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_, 0);
+    host_pillar_y_.resize(MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_, 0);
+    host_pillar_z_.resize(MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_, 0);
+    host_pillar_i_.resize(MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_, 0);
+    host_x_coors_for_sub_shaped_.resize(MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_, 0);
+    host_y_coors_for_sub_shaped_.resize(MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_, 0);
+    host_pillar_feature_mask_.resize(MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_, 0);
+    host_sparse_pillar_map_.resize(NUM_INDS_FOR_SCAN_ * NUM_INDS_FOR_SCAN_, 0);
+    // the first frame initializes the whole device buffers
+    host_copied_pillar_count_ = MAX_NUM_PILLARS_;
   }
   else
   {
@@ -531,57 +544,29 @@ void PointPillars::onnxToTRTModel(const std::string& model_file,             //
 
 void PointPillars::preprocessCPU(const float* in_points_array, const int in_num_points)
 {
-  int x_coors[MAX_NUM_PILLARS_] = { 0 };
-  int y_coors[MAX_NUM_PILLARS_] = { 0 };
-  float num_points_per_pillar[MAX_NUM_PILLARS_] = { 0 };
-  float* pillar_x = new float[MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_];
-  float* pillar_y = new float[MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_];
-  float* pillar_z = new float[MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_];
-  float* pillar_i = new float[MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_];
+  preprocess_points_ptr_->preprocessReusingBuffers(
+      in_points_array, in_num_points, host_x_coors_.data(), host_y_coors_.data(), host_num_points_per_pillar_.data(),
+      host_pillar_x_.data(), host_pillar_y_.data(), host_pillar_z_.data(), host_pillar_i_.data(),
+      host_x_coors_for_sub_shaped_.data(), host_y_coors_for_sub_shaped_.data(), host_pillar_feature_mask_.data(),
+      host_sparse_pillar_map_.data(), host_pillar_count_);
 
-  float* x_coors_for_sub_shaped = new float[MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_];
-  float* y_coors_for_sub_shaped = new float[MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_];
-  float* pillar_feature_mask = new float[MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_];
-
-  float* sparse_pillar_map = new float[NUM_INDS_FOR_SCAN_ * NUM_INDS_FOR_SCAN_];
-
-  preprocess_points_ptr_->preprocess(in_points_array, in_num_points, x_coors, y_coors, num_points_per_pillar, pillar_x,
-                                     pillar_y, pillar_z, pillar_i, x_coors_for_sub_shaped, y_coors_for_sub_shaped,
-                                     pillar_feature_mask, sparse_pillar_map, host_pillar_count_);
-
-  GPU_CHECK(cudaMemset(dev_x_coors_, 0, MAX_NUM_PILLARS_ * sizeof(int)));
-  GPU_CHECK(cudaMemset(dev_y_coors_, 0, MAX_NUM_PILLARS_ * sizeof(int)));
-  GPU_CHECK(cudaMemset(dev_pillar_x_, 0, MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float)));
-  GPU_CHECK(cudaMemset(dev_pillar_y_, 0, MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float)));
-  GPU_CHECK(cudaMemset(dev_pillar_z_, 0, MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float)));
-  GPU_CHECK(cudaMemset(dev_pillar_i_, 0, MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float)));
-  GPU_CHECK(cudaMemset(dev_x_coors_for_sub_shaped_, 0, MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float)));
-  GPU_CHECK(cudaMemset(dev_y_coors_for_sub_shaped_, 0, MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float)));
-  GPU_CHECK(cudaMemset(dev_num_points_per_pillar_, 0, MAX_NUM_PILLARS_ * sizeof(float)));
-  GPU_CHECK(cudaMemset(dev_sparse_pillar_map_, 0, NUM_INDS_FOR_SCAN_ * NUM_INDS_FOR_SCAN_ * sizeof(int)));
+  // pillars after both this and the previous frame are still zero on the device
+  const int num_pillars = std::max(host_pillar_count_[0], host_copied_pillar_count_);
+  host_copied_pillar_count_ = host_pillar_count_[0];
 
   // clang-format off
-  GPU_CHECK(cudaMemcpy(dev_x_coors_, x_coors, MAX_NUM_PILLARS_ * sizeof(int), cudaMemcpyHostToDevice));
-  GPU_CHECK(cudaMemcpy(dev_y_coors_, y_coors, MAX_NUM_PILLARS_ * sizeof(int), cudaMemcpyHostToDevice));
-  GPU_CHECK(cudaMemcpy(dev_pillar_x_, pillar_x, MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float),cudaMemcpyHostToDevice));
-  GPU_CHECK(cudaMemcpy(dev_pillar_y_, pillar_y, MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float),cudaMemcpyHostToDevice));
-  GPU_CHECK(cudaMemcpy(dev_pillar_z_, pillar_z, MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float),cudaMemcpyHostToDevice));
-  GPU_CHECK(cudaMemcpy(dev_pillar_i_, pillar_i, MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float),cudaMemcpyHostToDevice));
-  GPU_CHECK(cudaMemcpy(dev_x_coors_for_sub_shaped_, x_coors_for_sub_shaped, MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float), cudaMemcpyHostToDevice));
-  GPU_CHECK(cudaMemcpy(dev_y_coors_for_sub_shaped_, y_coors_for_sub_shaped,MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float), cudaMemcpyHostToDevice));
-  GPU_CHECK(cudaMemcpy(dev_num_points_per_pillar_, num_points_per_pillar, MAX_NUM_PILLARS_ * sizeof(float),cudaMemcpyHostToDevice));
-  GPU_CHECK(cudaMemcpy(dev_pillar_feature_mask_, pillar_feature_mask,MAX_NUM_PILLARS_ * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float), cudaMemcpyHostToDevice));
-  GPU_CHECK(cudaMemcpy(dev_sparse_pillar_map_, sparse_pillar_map,NUM_INDS_FOR_SCAN_ * NUM_INDS_FOR_SCAN_ * sizeof(float), cudaMemcpyHostToDevice));
+  GPU_CHECK(cudaMemcpy(dev_x_coors_, host_x_coors_.data(), num_pillars * sizeof(int), cudaMemcpyHostToDevice));
+  GPU_CHECK(cudaMemcpy(dev_y_coors_, host_y_coors_.data(), num_pillars * sizeof(int), cudaMemcpyHostToDevice));
+  GPU_CHECK(cudaMemcpy(dev_pillar_x_, host_pillar_x_.data(), num_pillars * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float),cudaMemcpyHostToDevice));
+  GPU_CHECK(cudaMemcpy(dev_pillar_y_, host_pillar_y_.data(), num_pillars * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float),cudaMemcpyHostToDevice));
+  GPU_CHECK(cudaMemcpy(dev_pillar_z_, host_pillar_z_.data(), num_pillars * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float),cudaMemcpyHostToDevice));
+  GPU_CHECK(cudaMemcpy(dev_pillar_i_, host_pillar_i_.data(), num_pillars * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float),cudaMemcpyHostToDevice));
+  GPU_CHECK(cudaMemcpy(dev_x_coors_for_sub_shaped_, host_x_coors_for_sub_shaped_.data(), num_pillars * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float), cudaMemcpyHostToDevice));
+  GPU_CHECK(cudaMemcpy(dev_y_coors_for_sub_shaped_, host_y_coors_for_sub_shaped_.data(), num_pillars * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float), cudaMemcpyHostToDevice));
+  GPU_CHECK(cudaMemcpy(dev_num_points_per_pillar_, host_num_points_per_pillar_.data(), num_pillars * sizeof(float),cudaMemcpyHostToDevice));
+  GPU_CHECK(cudaMemcpy(dev_pillar_feature_mask_, host_pillar_feature_mask_.data(), num_pillars * MAX_NUM_POINTS_PER_PILLAR_ * sizeof(float), cudaMemcpyHostToDevice));
+  GPU_CHECK(cudaMemcpy(dev_sparse_pillar_map_, host_sparse_pillar_map_.data(), NUM_INDS_FOR_SCAN_ * NUM_INDS_FOR_SCAN_ * sizeof(float), cudaMemcpyHostToDevice));
   // clang-format on
-
-  delete[] pillar_x;
-  delete[] pillar_y;
-  delete[] pillar_z;
-  delete[] pillar_i;
-  delete[] x_coors_for_sub_shaped;
-  delete[] y_coors_for_sub_shaped;
-  delete[] pillar_feature_mask;
-  delete[] sparse_pillar_map;
 }
 
 void PointPillars::preprocessGPU(const float* in_points_array, const int in_num_points)
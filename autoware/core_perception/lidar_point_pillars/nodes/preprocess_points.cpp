@@ -15,6 +15,7 @@
  */
 
 // headers in STL
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -39,6 +40,8 @@ PreprocessPoints::PreprocessPoints(const int MAX_NUM_PILLARS, const int MAX_POIN
   , MIN_Z_RANGE_(MIN_Z_RANGE)
   , NUM_INDS_FOR_SCAN_(NUM_INDS_FOR_SCAN)
   , NUM_BOX_CORNERS_(NUM_BOX_CORNERS)
+  , coor_to_pillaridx_(GRID_Y_SIZE * GRID_X_SIZE, -1)
+  , last_pillar_count_(0)
 {
 }
 
@@ -73,18 +76,18 @@ void PreprocessPoints::initializeVariables(int* coor_to_pillaridx, float* sparse
   }
 }
 
-void PreprocessPoints::preprocess(const float* in_points_array, int in_num_points, int* x_coors, int* y_coors,
-                                  float* num_points_per_pillar, float* pillar_x, float* pillar_y, float* pillar_z,
-                                  float* pillar_i, float* x_coors_for_sub_shaped, float* y_coors_for_sub_shaped,
-                                  float* pillar_feature_mask, float* sparse_pillar_map, int* host_pillar_count)
+int PreprocessPoints::scatterPoints(const float* in_points_array, int in_num_points, int* x_coors, int* y_coors,
+                                    float* num_points_per_pillar, float* pillar_x, float* pillar_y, float* pillar_z,
+                                    float* pillar_i, float* sparse_pillar_map)
 {
-  int pillar_count = 0;
-  float x_coors_for_sub[MAX_NUM_PILLARS_] = { 0 };
-  float y_coors_for_sub[MAX_NUM_PILLARS_] = { 0 };
-  // init variables
-  int coor_to_pillaridx[GRID_Y_SIZE_ * GRID_X_SIZE_];
-  initializeVariables(coor_to_pillaridx, sparse_pillar_map, pillar_x, pillar_y, pillar_z, pillar_i,
-                      x_coors_for_sub_shaped, y_coors_for_sub_shaped);
+  if (static_cast<int>(point_cells_.size()) < in_num_points)
+  {
+    point_cells_.resize(in_num_points);
+    point_slots_.resize(in_num_points);
+  }
+
+  // grid cell of each point
+#pragma omp parallel for
   for (int i = 0; i < in_num_points; i++)
   {
     int x_coor = std::floor((in_points_array[i * NUM_BOX_CORNERS_ + 0] - MIN_X_RANGE_) / PILLAR_X_SIZE_);
@@ -92,11 +95,29 @@ void PreprocessPoints::preprocess(const float* in_points_array, int in_num_point
     int z_coor = std::floor((in_points_array[i * NUM_BOX_CORNERS_ + 2] - MIN_Z_RANGE_) / PILLAR_Z_SIZE_);
     if (x_coor < 0 || x_coor >= GRID_X_SIZE_ || y_coor < 0 || y_coor >= GRID_Y_SIZE_ || z_coor < 0 ||
         z_coor >= GRID_Z_SIZE_)
+    {
+      point_cells_[i] = -1;
+    }
+    else
+    {
+      point_cells_[i] = y_coor * GRID_X_SIZE_ + x_coor;
+    }
+  }
+
+  // pillar index and slot of each point, in order of the input points
+  int pillar_count = 0;
+  int num_scanned_points = 0;
+  for (; num_scanned_points < in_num_points; num_scanned_points++)
+  {
+    const int i = num_scanned_points;
+    point_slots_[i] = -1;
+    const int cell = point_cells_[i];
+    if (cell == -1)
     {
       continue;
     }
     // reverse index
-    int pillar_index = coor_to_pillaridx[y_coor * GRID_X_SIZE_ + x_coor];
+    int pillar_index = coor_to_pillaridx_[cell];
     if (pillar_index == -1)
     {
       pillar_index = pillar_count;
@@ -105,35 +126,65 @@ void PreprocessPoints::preprocess(const float* in_points_array, int in_num_point
         break;
       }
       pillar_count += 1;
-      coor_to_pillaridx[y_coor * GRID_X_SIZE_ + x_coor] = pillar_index;
-
-      y_coors[pillar_index] = std::floor(y_coor);
-      x_coors[pillar_index] = std::floor(x_coor);
-
-      // float y_offset = PILLAR_Y_SIZE_/ 2 + MIN_Y_RANGE_;
-      // float x_offset = PILLAR_X_SIZE_/ 2 + MIN_X_RANGE_;
-      // TODO Need to be modified after proper trining code
-      // Will be modified in ver 1.1
-      y_coors_for_sub[pillar_index] = std::floor(y_coor) * PILLAR_Y_SIZE_ + -39.9f;
-      x_coors_for_sub[pillar_index] = std::floor(x_coor) * PILLAR_X_SIZE_ + 0.1f;
+      coor_to_pillaridx_[cell] = pillar_index;
 
+      const int y_coor = cell / GRID_X_SIZE_;
+      const int x_coor = cell % GRID_X_SIZE_;
+      y_coors[pillar_index] = y_coor;
+      x_coors[pillar_index] = x_coor;
       sparse_pillar_map[y_coor * NUM_INDS_FOR_SCAN_ + x_coor] = 1;
     }
     int num = num_points_per_pillar[pillar_index];
     if (num < MAX_NUM_POINTS_PER_PILLAR_)
     {
-      pillar_x[pillar_index * MAX_NUM_POINTS_PER_PILLAR_ + num] = in_points_array[i * NUM_BOX_CORNERS_ + 0];
-      pillar_y[pillar_index * MAX_NUM_POINTS_PER_PILLAR_ + num] = in_points_array[i * NUM_BOX_CORNERS_ + 1];
-      pillar_z[pillar_index * MAX_NUM_POINTS_PER_PILLAR_ + num] = in_points_array[i * NUM_BOX_CORNERS_ + 2];
-      pillar_i[pillar_index * MAX_NUM_POINTS_PER_PILLAR_ + num] = in_points_array[i * NUM_BOX_CORNERS_ + 3];
+      point_slots_[i] = pillar_index * MAX_NUM_POINTS_PER_PILLAR_ + num;
       num_points_per_pillar[pillar_index] += 1;
     }
   }
 
-  for (int i = 0; i < MAX_NUM_PILLARS_; i++)
+  // copy points into their slots, the points after the last pillar are dropped
+#pragma omp parallel for
+  for (int i = 0; i < num_scanned_points; i++)
   {
-    float x = x_coors_for_sub[i];
-    float y = y_coors_for_sub[i];
+    const int slot = point_slots_[i];
+    if (slot == -1)
+    {
+      continue;
+    }
+    pillar_x[slot] = in_points_array[i * NUM_BOX_CORNERS_ + 0];
+    pillar_y[slot] = in_points_array[i * NUM_BOX_CORNERS_ + 1];
+    pillar_z[slot] = in_points_array[i * NUM_BOX_CORNERS_ + 2];
+    pillar_i[slot] = in_points_array[i * NUM_BOX_CORNERS_ + 3];
+  }
+
+  // reset only the cells used by this call
+#pragma omp parallel for
+  for (int i = 0; i < pillar_count; i++)
+  {
+    coor_to_pillaridx_[y_coors[i] * GRID_X_SIZE_ + x_coors[i]] = -1;
+  }
+
+  return pillar_count;
+}
+
+void PreprocessPoints::fillPillarFeatures(int pillar_count, int num_rows, const int* x_coors, const int* y_coors,
+                                          const float* num_points_per_pillar, float* x_coors_for_sub_shaped,
+                                          float* y_coors_for_sub_shaped, float* pillar_feature_mask)
+{
+#pragma omp parallel for
+  for (int i = 0; i < num_rows; i++)
+  {
+    float x = 0;
+    float y = 0;
+    if (i < pillar_count)
+    {
+      // float y_offset = PILLAR_Y_SIZE_/ 2 + MIN_Y_RANGE_;
+      // float x_offset = PILLAR_X_SIZE_/ 2 + MIN_X_RANGE_;
+      // TODO Need to be modified after proper trining code
+      // Will be modified in ver 1.1
+      y = std::floor(y_coors[i]) * PILLAR_Y_SIZE_ + -39.9f;
+      x = std::floor(x_coors[i]) * PILLAR_X_SIZE_ + 0.1f;
+    }
     int num_points_for_a_pillar = num_points_per_pillar[i];
     for (int j = 0; j < MAX_NUM_POINTS_PER_PILLAR_; j++)
     {
@@ -149,5 +200,53 @@ void PreprocessPoints::preprocess(const float* in_points_array, int in_num_point
       }
     }
   }
+}
+
+void PreprocessPoints::preprocess(const float* in_points_array, int in_num_points, int* x_coors, int* y_coors,
+                                  float* num_points_per_pillar, float* pillar_x, float* pillar_y, float* pillar_z,
+                                  float* pillar_i, float* x_coors_for_sub_shaped, float* y_coors_for_sub_shaped,
+                                  float* pillar_feature_mask, float* sparse_pillar_map, int* host_pillar_count)
+{
+  // init variables
+  initializeVariables(coor_to_pillaridx_.data(), sparse_pillar_map, pillar_x, pillar_y, pillar_z, pillar_i,
+                      x_coors_for_sub_shaped, y_coors_for_sub_shaped);
+  int pillar_count = scatterPoints(in_points_array, in_num_points, x_coors, y_coors, num_points_per_pillar, pillar_x,
+                                   pillar_y, pillar_z, pillar_i, sparse_pillar_map);
+  fillPillarFeatures(pillar_count, MAX_NUM_PILLARS_, x_coors, y_coors, num_points_per_pillar, x_coors_for_sub_shaped,
+                     y_coors_for_sub_shaped, pillar_feature_mask);
+  host_pillar_count[0] = pillar_count;
+}
+
+void PreprocessPoints::preprocessReusingBuffers(const float* in_points_array, int in_num_points, int* x_coors,
+                                                int* y_coors, float* num_points_per_pillar, float* pillar_x,
+                                                float* pillar_y, float* pillar_z, float* pillar_i,
+                                                float* x_coors_for_sub_shaped, float* y_coors_for_sub_shaped,
+                                                float* pillar_feature_mask, float* sparse_pillar_map,
+                                                int* host_pillar_count)
+{
+  // clear the pillars written by the previous call, the rest of the arrays is still zero
+#pragma omp parallel for
+  for (int i = 0; i < last_pillar_count_; i++)
+  {
+    sparse_pillar_map[y_coors[i] * NUM_INDS_FOR_SCAN_ + x_coors[i]] = 0;
+    int num_points_for_a_pillar = num_points_per_pillar[i];
+    for (int j = 0; j < num_points_for_a_pillar; j++)
+    {
+      pillar_x[i * MAX_NUM_POINTS_PER_PILLAR_ + j] = 0;
+      pillar_y[i * MAX_NUM_POINTS_PER_PILLAR_ + j] = 0;
+      pillar_z[i * MAX_NUM_POINTS_PER_PILLAR_ + j] = 0;
+      pillar_i[i * MAX_NUM_POINTS_PER_PILLAR_ + j] = 0;
+    }
+    num_points_per_pillar[i] = 0;
+    x_coors[i] = 0;
+    y_coors[i] = 0;
+  }
+
+  int pillar_count = scatterPoints(in_points_array, in_num_points, x_coors, y_coors, num_points_per_pillar, pillar_x,
+                                   pillar_y, pillar_z, pillar_i, sparse_pillar_map);
+  // rows of the previous call beyond the new pillars are set back to zero
+  fillPillarFeatures(pillar_count, std::max(pillar_count, last_pillar_count_), x_coors, y_coors,
+                     num_points_per_pillar, x_coors_for_sub_shaped, y_coors_for_sub_shaped, pillar_feature_mask);
+  last_pillar_count_ = pillar_count;
   host_pillar_count[0] = pillar_count;
 }
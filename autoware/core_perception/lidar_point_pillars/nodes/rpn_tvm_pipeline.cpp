@@ -26,37 +26,44 @@
 
 PreProcessorRPN::PreProcessorRPN(
   tvm_utility::pipeline::InferenceEngineTVMConfig config,
-  cudaStream_t* stream
-  ) : stream_(stream)
+  cudaStream_t* stream,
+  size_t buffer_sets
+  ) : next_net_input_(0), stream_(stream)
 {
-  // allocate input variable
-  tvm_utility::pipeline::TVMArrayContainer input_var {
-      config.network_inputs[0].second,
-      config.tvm_dtype_code,
-      config.tvm_dtype_bits,
-      config.tvm_dtype_lanes,
-      config.tvm_device_type,
-      config.tvm_device_id
-  };
+  // allocate input variable(s)
+  for (size_t i = 0; i < std::max<size_t>(buffer_sets, 1); i++) {
+    tvm_utility::pipeline::TVMArrayContainer input_var {
+        config.network_inputs[0].second,
+        config.tvm_dtype_code,
+        config.tvm_dtype_bits,
+        config.tvm_dtype_lanes,
+        config.tvm_device_type,
+        config.tvm_device_id
+    };
+    rpn_net_input_.push_back(input_var);
+  }
 
   net_input_size_byte_ = config.network_inputs[0].second[1] *
                          config.network_inputs[0].second[2] *
                          config.network_inputs[0].second[3] *
                          (config.tvm_dtype_bits / 8);
-
-  rpn_net_input_ = input_var;
 }
 
 tvm_utility::pipeline::TVMArrayContainerVector
   PreProcessorRPN::schedule(const std::vector<float*> &net_input)
 {
-  GPU_CHECK(cudaMemcpyAsync(rpn_net_input_.getArray()->data,
+  // the inference stage may still read the previously returned buffer
+  tvm_utility::pipeline::TVMArrayContainer &input =
+    rpn_net_input_[next_net_input_];
+  next_net_input_ = (next_net_input_ + 1) % rpn_net_input_.size();
+
+  GPU_CHECK(cudaMemcpyAsync(input.getArray()->data,
                             net_input[0],
                             net_input_size_byte_,
                             cudaMemcpyDeviceToHost,
                             *stream_));
 
-  return {rpn_net_input_};
+  return {input};
 }
 
 PostProcessorRPN::PostProcessorRPN(
@@ -75,6 +75,10 @@ public:
                   float* num_points_per_pillar, float* pillar_x, float* pillar_y, float* pillar_z, float* pillar_i,
                   float* x_coors_for_sub_shaped, float* y_coors_for_sub_shaped, float* pillar_feature_mask,
                   float* sparse_pillar_map, int* host_pillar_count);
+  void preprocessReusingBuffers(const float* in_points_array, int in_num_points, int* x_coors, int* y_coors,
+                                float* num_points_per_pillar, float* pillar_x, float* pillar_y, float* pillar_z,
+                                float* pillar_i, float* x_coors_for_sub_shaped, float* y_coors_for_sub_shaped,
+                                float* pillar_feature_mask, float* sparse_pillar_map, int* host_pillar_count);
   void generateAnchors(float* anchors_px, float* anchors_py, float* anchors_pz, float* anchors_dx,
                        float* anchors_dy, float* anchors_dz, float* anchors_ro);
   void convertAnchors2BoxAnchors(float* anchors_px, float* anchors_py, float* anchors_dx, float* anchors_dy,
@@ -135,6 +139,19 @@ void TestClass::preprocess(const float* in_points_array, int in_num_points, int*
                                      pillar_feature_mask, sparse_pillar_map, host_pillar_count);
 }
 
+void TestClass::preprocessReusingBuffers(const float* in_points_array, int in_num_points, int* x_coors,
+                                         int* y_coors, float* num_points_per_pillar, float* pillar_x,
+                                         float* pillar_y, float* pillar_z, float* pillar_i,
+                                         float* x_coors_for_sub_shaped, float* y_coors_for_sub_shaped,
+                                         float* pillar_feature_mask, float* sparse_pillar_map,
+                                         int* host_pillar_count)
+{
+  preprocess_points_ptr_->preprocessReusingBuffers(in_points_array, in_num_points, x_coors, y_coors,
+                                                   num_points_per_pillar, pillar_x, pillar_y, pillar_z, pillar_i,
+                                                   x_coors_for_sub_shaped, y_coors_for_sub_shaped,
+                                                   pillar_feature_mask, sparse_pillar_map, host_pillar_count);
+}
+
 void TestClass::pclToArray(const pcl::PointCloud<pcl::PointXYZI>::Ptr& in_pcl_pc_ptr, float* out_points_array)
 {
   for (size_t i = 0; i < in_pcl_pc_ptr->size(); i++)
@@ -278,6 +295,95 @@ TEST(TestSuite, CheckPreprocessPointsCPU)
   delete[] sparse_pillar_map;
 }
 
+TEST(TestSuite, CheckPreprocessPointsCPUReusingBuffers)
+{
+  const int MAX_NUM_PILLARS = 12000;
+  const int MAX_NUM_POINTS_PER_PILLAR = 100;
+  const int GRID_X_SIZE = 432;
+  const int GRID_Y_SIZE = 496;
+  const int GRID_Z_SIZE = 1;
+  const float PILLAR_X_SIZE = 0.16;
+  const float PILLAR_Y_SIZE = 0.16;
+  const float PILLAR_Z_SIZE = 4.0;
+  const float MIN_X_RANGE = 0;
+  const float MIN_Y_RANGE = -39.68;
+  const float MIN_Z_RANGE = -3.0;
+  const int NUM_INDS_FOR_SCAN = 512;
+  const int NUM_BOX_CORNERS = 4;
+  TestClass test_obj(MAX_NUM_PILLARS,
+                     MAX_NUM_POINTS_PER_PILLAR,
+                     GRID_X_SIZE,
+                     GRID_Y_SIZE,
+                     GRID_Z_SIZE,
+                     PILLAR_X_SIZE,
+                     PILLAR_Y_SIZE,
+                     PILLAR_Z_SIZE,
+                     MIN_X_RANGE,
+                     MIN_Y_RANGE,
+                     MIN_Z_RANGE,
+                     NUM_INDS_FOR_SCAN,
+                     NUM_BOX_CORNERS);
+
+  pcl::PointCloud<pcl::PointXYZI>::Ptr pcl_pc_ptr(new pcl::PointCloud<pcl::PointXYZI>);
+  test_obj.makePointsForTest(pcl_pc_ptr);
+
+  float* points_array = new float[pcl_pc_ptr->size() * 4];
+  test_obj.pclToArray(pcl_pc_ptr, points_array);
+
+  // buffers are zero before the first call only
+  const int NUM_PILLAR_POINTS = test_obj.MAX_NUM_PILLARS_ * test_obj.MAX_NUM_POINTS_PER_PILLAR_;
+  std::vector<int> x_coors(test_obj.MAX_NUM_PILLARS_, 0);
+  std::vector<int> y_coors(test_obj.MAX_NUM_PILLARS_, 0);
+  std::vector<float> num_points_per_pillar(test_obj.MAX_NUM_PILLARS_, 0);
+  std::vector<float> pillar_x(NUM_PILLAR_POINTS, 0);
+  std::vector<float> pillar_y(NUM_PILLAR_POINTS, 0);
+  std::vector<float> pillar_z(NUM_PILLAR_POINTS, 0);
+  std::vector<float> pillar_i(NUM_PILLAR_POINTS, 0);
+  std::vector<float> x_coors_for_sub_shaped(NUM_PILLAR_POINTS, 0);
+  std::vector<float> y_coors_for_sub_shaped(NUM_PILLAR_POINTS, 0);
+  std::vector<float> pillar_feature_mask(NUM_PILLAR_POINTS, 0);
+  std::vector<float> sparse_pillar_map(512 * 512, 0);
+  int host_pillar_count[1] = { 0 };
+
+  test_obj.preprocessReusingBuffers(points_array, pcl_pc_ptr->size(), x_coors.data(), y_coors.data(),
+                                    num_points_per_pillar.data(), pillar_x.data(), pillar_y.data(), pillar_z.data(),
+                                    pillar_i.data(), x_coors_for_sub_shaped.data(), y_coors_for_sub_shaped.data(),
+                                    pillar_feature_mask.data(), sparse_pillar_map.data(), host_pillar_count);
+  EXPECT_EQ(1, num_points_per_pillar[0]);
+  EXPECT_FLOAT_EQ(12.9892, pillar_x[0]);
+  EXPECT_EQ(74, x_coors[1]);
+  EXPECT_EQ(178, y_coors[1]);
+  EXPECT_EQ(1, sparse_pillar_map[178 * 512 + 74]);
+  EXPECT_EQ(8, host_pillar_count[0]);
+  const std::vector<float> first_pillar_x = pillar_x;
+  const std::vector<float> first_x_coors_for_sub_shaped = x_coors_for_sub_shaped;
+  const std::vector<float> first_pillar_feature_mask = pillar_feature_mask;
+
+  // an empty frame clears everything written by the previous one
+  test_obj.preprocessReusingBuffers(points_array, 0, x_coors.data(), y_coors.data(), num_points_per_pillar.data(),
+                                    pillar_x.data(), pillar_y.data(), pillar_z.data(), pillar_i.data(),
+                                    x_coors_for_sub_shaped.data(), y_coors_for_sub_shaped.data(),
+                                    pillar_feature_mask.data(), sparse_pillar_map.data(), host_pillar_count);
+  EXPECT_EQ(0, host_pillar_count[0]);
+  EXPECT_EQ(std::vector<float>(test_obj.MAX_NUM_PILLARS_, 0), num_points_per_pillar);
+  EXPECT_EQ(0, x_coors[1]);
+  EXPECT_EQ(0, y_coors[1]);
+  EXPECT_EQ(0, sparse_pillar_map[178 * 512 + 74]);
+  EXPECT_EQ(std::vector<float>(NUM_PILLAR_POINTS, 0), pillar_x);
+  EXPECT_EQ(std::vector<float>(NUM_PILLAR_POINTS, 0), x_coors_for_sub_shaped);
+  EXPECT_EQ(std::vector<float>(NUM_PILLAR_POINTS, 0), pillar_feature_mask);
+
+  test_obj.preprocessReusingBuffers(points_array, pcl_pc_ptr->size(), x_coors.data(), y_coors.data(),
+                                    num_points_per_pillar.data(), pillar_x.data(), pillar_y.data(), pillar_z.data(),
+                                    pillar_i.data(), x_coors_for_sub_shaped.data(), y_coors_for_sub_shaped.data(),
+                                    pillar_feature_mask.data(), sparse_pillar_map.data(), host_pillar_count);
+  EXPECT_EQ(8, host_pillar_count[0]);
+  EXPECT_EQ(first_pillar_x, pillar_x);
+  EXPECT_EQ(first_x_coors_for_sub_shaped, x_coors_for_sub_shaped);
+  EXPECT_EQ(first_pillar_feature_mask, pillar_feature_mask);
+  delete[] points_array;
+}
+
 TEST(TestSuite, CheckGenerateAnchors)
 {
   const int MAX_NUM_PILLARS = 12000;
@@ -18,12 +18,14 @@
 
 #pragma once
 
+#include <memory>
 #include <ros/ros.h>
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
 #include <pcl_conversions/pcl_conversions.h>
 #include "lidar_shape_estimation/shape_estimator.hpp"
 #include "autoware_msgs/DetectedObjectArray.h"
+#include "object_payload_store/object_payload_store.h"
 
 class ShapeEstimationNode
 {
@@ -37,6 +39,7 @@ private:  // ros
 
 private:
   ShapeEstimator estimator_;
+  std::unique_ptr<object_payload_store::PayloadStore> payload_store_;  // opened when a lean object arrives
 
 public:
   ShapeEstimationNode();
@@ -17,14 +17,12 @@
  */
 
 #include <cmath>
+#include <limits>
 #include <vector>
 #include <utility>
 #include <algorithm>
 
 #include "bounding_box.hpp"
-#include <opencv2/core/core.hpp>
-#include <opencv2/highgui/highgui.hpp>
-#include <opencv2/imgproc/imgproc.hpp>
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
 #include <pcl_conversions/pcl_conversions.h>
@@ -35,6 +33,25 @@
 
 #include <Eigen/Core>
 
+namespace
+{
+// projection buffers reused between calls, one set per thread so that clusters can be estimated in parallel
+thread_local std::vector<double> g_x;
+thread_local std::vector<double> g_y;
+thread_local std::vector<double> g_C_1;
+thread_local std::vector<double> g_C_2;
+}  // namespace
+
+BoundingBoxModel::BoundingBoxModel()
+  : angle_resolutions_({ 10.0 * M_PI / 180.0, 1.0 * M_PI / 180.0, 0.1 * M_PI / 180.0 }), num_refined_seeds_(3)
+{
+}
+
+BoundingBoxModel::BoundingBoxModel(const std::vector<double>& angle_resolutions, const int num_refined_seeds)
+  : angle_resolutions_(angle_resolutions), num_refined_seeds_(num_refined_seeds)
+{
+}
+
 bool BoundingBoxModel::estimate(const pcl::PointCloud<pcl::PointXYZ>& cluster, autoware_msgs::DetectedObject& output)
 {
   // calc centroid point for cylinder height(z)
@@ -63,12 +80,15 @@ bool BoundingBoxModel::estimate(const pcl::PointCloud<pcl::PointXYZ>& cluster, a
       max_z = cluster.at(i).z;
   }
 
-  // calc circumscribed circle on x-y plane
-  cv::Mat_<float> cv_points(static_cast<int>(cluster.size()), 2);
+  // x-y plane coordinates as contiguous arrays for the projection
+  g_x.resize(cluster.size());
+  g_y.resize(cluster.size());
+  g_C_1.resize(cluster.size());
+  g_C_2.resize(cluster.size());
   for (size_t i = 0; i < cluster.size(); ++i)
   {
-    cv_points(i, 0) = cluster.at(i).x;  // x
-    cv_points(i, 1) = cluster.at(i).y;  // y
+    g_x[i] = cluster.at(i).x;
+    g_y[i] = cluster.at(i).y;
   }
 
   /*
@@ -77,54 +97,19 @@ bool BoundingBoxModel::estimate(const pcl::PointCloud<pcl::PointXYZ>& cluster, a
    */
 
   // Paper : Algo.2 Search-Based Rectangle Fitting
-  std::vector<std::pair<double /*theta*/, double /*q*/>> Q;
-  const double max_angle = M_PI / 2.0;
-  const double angle_reso = M_PI / 180.0;
-  for (double theta = 0; theta < max_angle; theta += angle_reso)
-  {
-    Eigen::Vector2d e_1;
-    e_1 << std::cos(theta), std::sin(theta);  // col.3, Algo.2
-    Eigen::Vector2d e_2;
-    e_2 << -std::sin(theta), std::cos(theta);  // col.4, Algo.2
-    std::vector<double> C_1;                   // col.5, Algo.2
-    std::vector<double> C_2;                   // col.6, Algo.2
-    for (const auto& point : cluster)
-    {
-      C_1.push_back(point.x * e_1.x() + point.y * e_1.y());
-      C_2.push_back(point.x * e_2.x() + point.y * e_2.y());
-    }
-    double q = calcClosenessCriterion(C_1, C_2);  // col.7, Algo.2
-    Q.push_back(std::make_pair(theta, q));        // col.8, Algo.2
-  }
-
-  double theta_star;  // col.10, Algo.2
-  double max_q;
-  for (size_t i = 0; i < Q.size(); ++i)
-  {
-    if (max_q < Q.at(i).second || i == 0)
-    {
-      max_q = Q.at(i).second;
-      theta_star = Q.at(i).first;
-    }
-  }
+  const double theta_star = searchTheta(g_x, g_y, g_C_1, g_C_2);  // col.10, Algo.2
 
   Eigen::Vector2d e_1_star;  // col.11, Algo.2
   Eigen::Vector2d e_2_star;
   e_1_star << std::cos(theta_star), std::sin(theta_star);
   e_2_star << -std::sin(theta_star), std::cos(theta_star);
-  std::vector<double> C_1_star;  // col.11, Algo.2
-  std::vector<double> C_2_star;  // col.11, Algo.2
-  for (const auto& point : cluster)
-  {
-    C_1_star.push_back(point.x * e_1_star.x() + point.y * e_1_star.y());
-    C_2_star.push_back(point.x * e_2_star.x() + point.y * e_2_star.y());
-  }
+  calcClosenessCriterion(g_x, g_y, theta_star, g_C_1, g_C_2);  // col.11, Algo.2
 
   // col.12, Algo.2
-  const double min_C_1_star = *std::min_element(C_1_star.begin(), C_1_star.end());
-  const double max_C_1_star = *std::max_element(C_1_star.begin(), C_1_star.end());
-  const double min_C_2_star = *std::min_element(C_2_star.begin(), C_2_star.end());
-  const double max_C_2_star = *std::max_element(C_2_star.begin(), C_2_star.end());
+  const double min_C_1_star = *std::min_element(g_C_1.begin(), g_C_1.end());
+  const double max_C_1_star = *std::max_element(g_C_1.begin(), g_C_1.end());
+  const double min_C_2_star = *std::min_element(g_C_2.begin(), g_C_2.end());
+  const double max_C_2_star = *std::max_element(g_C_2.begin(), g_C_2.end());
 
   const double a_1 = std::cos(theta_star);
   const double b_1 = std::sin(theta_star);
@@ -292,34 +277,119 @@ bool BoundingBoxModel::estimate(const pcl::PointCloud<pcl::PointXYZ>& cluster, a
 //     return max_beta;
 // }
 
-double BoundingBoxModel::calcClosenessCriterion(const std::vector<double>& C_1, const std::vector<double>& C_2)
+double BoundingBoxModel::searchTheta(const std::vector<double>& x, const std::vector<double>& y,
+                                     std::vector<double>& C_1, std::vector<double>& C_2)
 {
-  // Paper : Algo.4 Closeness Criterion
-  const double min_c_1 = *std::min_element(C_1.begin(), C_1.end());  // col.2, Algo.4
-  const double max_c_1 = *std::max_element(C_1.begin(), C_1.end());  // col.2, Algo.4
-  const double min_c_2 = *std::min_element(C_2.begin(), C_2.end());  // col.3, Algo.4
-  const double max_c_2 = *std::max_element(C_2.begin(), C_2.end());  // col.3, Algo.4
+  const double max_angle = M_PI / 2.0;
+  if (angle_resolutions_.empty())
+    return 0;
 
-  std::vector<double> D_1;  // col.4, Algo.4
-  for (const auto& c_1_element : C_1)
+  // first stage: sweep the whole range
+  std::vector<std::pair<double /*q*/, double /*theta*/>> Q;
+  const double coarse_reso = angle_resolutions_.front();
+  for (double theta = 0; theta < max_angle; theta += coarse_reso)
+  {
+    double q = calcClosenessCriterion(x, y, theta, C_1, C_2);  // col.3-7, Algo.2
+    Q.push_back(std::make_pair(q, theta));                      // col.8, Algo.2
+  }
+
+  double theta_star = Q.front().second;  // col.10, Algo.2
+  double max_q = Q.front().first;
+  for (const auto& q : Q)
+  {
+    if (max_q < q.first)
+    {
+      max_q = q.first;
+      theta_star = q.second;
+    }
+  }
+  if (angle_resolutions_.size() == 1)
+    return theta_star;
+
+  // the criterion has several peaks, so the best few angles of the coarse sweep are refined at the second stage and
+  // the best of them at the later stages
+  const size_t num_seeds = std::min(Q.size(), static_cast<size_t>(std::max(num_refined_seeds_, 1)));
+  std::partial_sort(Q.begin(), Q.begin() + num_seeds, Q.end(),
+                    [](const std::pair<double, double>& a, const std::pair<double, double>& b) {
+                      return a.first > b.first;
+                    });
+  Q.resize(num_seeds);
+
+  for (size_t stage = 1; stage < angle_resolutions_.size(); ++stage)
   {
-    const double v = std::min(max_c_1 - c_1_element, c_1_element - min_c_1);
-    D_1.push_back(std::fabs(v));
+    const double angle_reso = angle_resolutions_.at(stage);
+    const double range = angle_resolutions_.at(stage - 1);
+    for (const auto& seed : Q)
+    {
+      const double lower = std::max(0.0, seed.second - range);
+      const double upper = std::min(max_angle, seed.second + range + angle_reso / 2.0);
+      for (double theta = lower; theta < upper; theta += angle_reso)
+      {
+        if (std::fabs(theta - seed.second) < angle_reso / 2.0)
+          continue;  // already evaluated
+        double q = calcClosenessCriterion(x, y, theta, C_1, C_2);
+        if (max_q < q)
+        {
+          max_q = q;
+          theta_star = theta;
+        }
+      }
+    }
+    Q.assign(1, std::make_pair(max_q, theta_star));
   }
+  return theta_star;
+}
 
-  std::vector<double> D_2;  // col.5, Algo.4
-  for (const auto& c_2_element : C_2)
+/*
+ * Projects the points on e_1 = (cos, sin) and e_2 = (-sin, cos) into C_1 and C_2 (col.3-6, Algo.2)
+ * and returns the closeness criterion of them.
+ */
+double BoundingBoxModel::calcClosenessCriterion(const std::vector<double>& x, const std::vector<double>& y,
+                                                const double theta, std::vector<double>& C_1,
+                                                std::vector<double>& C_2)
+{
+  const int size = static_cast<int>(x.size());
+  const double cos_theta = std::cos(theta);
+  const double sin_theta = std::sin(theta);
+  const double* px = x.data();
+  const double* py = y.data();
+  double* c_1 = C_1.data();
+  double* c_2 = C_2.data();
+
+  // Paper : Algo.4 Closeness Criterion
+  double min_c_1 = std::numeric_limits<double>::max();   // col.2, Algo.4
+  double max_c_1 = std::numeric_limits<double>::lowest();  // col.2, Algo.4
+  double min_c_2 = std::numeric_limits<double>::max();   // col.3, Algo.4
+  double max_c_2 = std::numeric_limits<double>::lowest();  // col.3, Algo.4
+#pragma omp simd reduction(min : min_c_1, min_c_2) reduction(max : max_c_1, max_c_2)
+  for (int i = 0; i < size; ++i)
   {
-    const double v = std::min(max_c_2 - c_2_element, c_2_element - min_c_2);
-    D_2.push_back(v * v);
+    const double c_1_element = px[i] * cos_theta + py[i] * sin_theta;
+    const double c_2_element = -px[i] * sin_theta + py[i] * cos_theta;
+    c_1[i] = c_1_element;
+    c_2[i] = c_2_element;
+    min_c_1 = (c_1_element < min_c_1) ? c_1_element : min_c_1;
+    max_c_1 = (max_c_1 < c_1_element) ? c_1_element : max_c_1;
+    min_c_2 = (c_2_element < min_c_2) ? c_2_element : min_c_2;
+    max_c_2 = (max_c_2 < c_2_element) ? c_2_element : max_c_2;
   }
 
   const double d_min = 0.05;
   const double d_max = 0.50;
   double beta = 0;  // col.6, Algo.4
-  for (size_t i = 0; i < D_1.size(); ++i)
+#pragma omp simd reduction(+ : beta)
+  for (int i = 0; i < size; ++i)
   {
-    const double d = std::min(std::max(std::min(D_1.at(i), D_2.at(i)), d_min), d_max);
+    const double v_1 = max_c_1 - c_1[i];
+    const double w_1 = c_1[i] - min_c_1;
+    const double d_1 = std::fabs((v_1 < w_1) ? v_1 : w_1);  // col.4, Algo.4
+    const double v_2 = max_c_2 - c_2[i];
+    const double w_2 = c_2[i] - min_c_2;
+    const double v = (v_2 < w_2) ? v_2 : w_2;
+    const double d_2 = v * v;  // col.5, Algo.4
+    double d = (d_1 < d_2) ? d_1 : d_2;
+    d = (d < d_min) ? d_min : d;
+    d = (d_max < d) ? d_max : d;
     beta += 1.0 / d;
   }
   return beta;
@@ -19,15 +19,29 @@
 
 #pragma once
 
+#include <vector>
 #include "lidar_shape_estimation/model_interface.hpp"
 
 class BoundingBoxModel : public ShapeEstimationModelInterface
 {
 private:
-  double calcClosenessCriterion(const std::vector<double>& C_1, const std::vector<double>& C_2);
+  std::vector<double> angle_resolutions_;
+  int num_refined_seeds_;
+
+  double calcClosenessCriterion(const std::vector<double>& x, const std::vector<double>& y, const double theta,
+                                std::vector<double>& C_1, std::vector<double>& C_2);
+  double searchTheta(const std::vector<double>& x, const std::vector<double>& y, std::vector<double>& C_1,
+                     std::vector<double>& C_2);
 
 public:
-  BoundingBoxModel(){};
+  /*
+   * theta is searched over [0, 90) deg with angle_resolutions[0], then each next resolution
+   * refines the num_refined_seeds best coarse angles (+- the previous resolution).
+   * {1 deg} is the exhaustive search of the paper. Default is {10, 1, 0.1} deg with 3 seeds.
+   */
+  BoundingBoxModel();
+
+  BoundingBoxModel(const std::vector<double>& angle_resolutions, const int num_refined_seeds);
 
   ~BoundingBoxModel(){};
 
@@ -35,14 +35,33 @@ void ShapeEstimationNode::callback(const autoware_msgs::DetectedObjectArray::Con
   // Create output msg
   auto output_msg = *input_msg;
 
-  // Estimate shape for each object and pack msg
-  for (auto& object : output_msg.objects)
+  // Objects published in lean mode carry a reference to their pointcloud
+  for (const auto& object : output_msg.objects)
   {
+    if (!payload_store_ && object_payload_store::hasPayloadReference(object))
+    {
+      payload_store_.reset(new object_payload_store::PayloadStore());
+      break;
+    }
+  }
+
+  // Estimate shape for each object and pack msg, objects are independent so they are estimated in parallel
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < static_cast<int>(output_msg.objects.size()); ++i)
+  {
+    auto& object = output_msg.objects.at(i);
+    if (object_payload_store::hasPayloadReference(object) && !payload_store_->resolve(object))
+    {
+      ROS_WARN_THROTTLE(1, "payload of object %u is no longer in the payload store", object.id);
+      continue;
+    }
     // convert ros to pcl
     pcl::PointCloud<pcl::PointXYZ>::Ptr cluster(new pcl::PointCloud<pcl::PointXYZ>);
     pcl::fromROSMsg(object.pointcloud, *cluster);
     // estimate shape and pose
     estimator_.getShapeAndPose(object.label, *cluster, object);
+    // keep publishing the reference only
+    object_payload_store::PayloadStore::strip(object);
   }
 
   // Publish
@@ -17,6 +17,10 @@
  * v1.0 Yukihiro Saito
  */
 
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
 #include <string>
 
 #include <ros/ros.h>
@@ -26,6 +30,9 @@
 #include <pcl_conversions/pcl_conversions.h>
 #include "autoware_msgs/DetectedObject.h"
 #include "lidar_shape_estimation/shape_estimator.hpp"
+#include "model/bounding_box.hpp"
+#include <tf2/utils.h>
+#include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 
 class ShapeEstimationTestSuite : public ::testing::Test
 {
@@ -132,6 +139,70 @@ TEST(TestSuite, CheckEmptyPoint)
                          << "false";
 }
 
+TEST(TestSuite, CheckCoarseToFineBoundingBox)
+{
+  // L-shaped clusters as seen from the sensor, with gaussian noise on both sides
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  std::normal_distribution<double> noise(0, 0.03);
+
+  BoundingBoxModel coarse_to_fine;
+  BoundingBoxModel exhaustive({ M_PI / 180.0 }, 1);  // 1 deg sweep as in the original search
+
+  const int num_objects = 100;
+  double coarse_to_fine_time = 0, exhaustive_time = 0;
+  for (int k = 0; k < num_objects; ++k)
+  {
+    const double yaw = uniform(rng) * M_PI;
+    const double length = 2.0 + 3.0 * uniform(rng), width = 1.5 + uniform(rng);
+    const double center_x = 5.0 + 30.0 * uniform(rng), center_y = -10.0 + 20.0 * uniform(rng);
+    const int num_points = 50 + (k % 10) * 300;
+
+    pcl::PointCloud<pcl::PointXYZ> cluster;
+    for (int i = 0; i < num_points; ++i)
+    {
+      double u, v;
+      if (uniform(rng) < length / (length + width))
+      {
+        u = -length / 2.0 + length * uniform(rng);
+        v = -width / 2.0;
+      }
+      else
+      {
+        u = -length / 2.0;
+        v = -width / 2.0 + width * uniform(rng);
+      }
+      u += noise(rng);
+      v += noise(rng);
+      pcl::PointXYZ p;
+      p.x = center_x + u * std::cos(yaw) - v * std::sin(yaw);
+      p.y = center_y + u * std::sin(yaw) + v * std::cos(yaw);
+      p.z = uniform(rng);
+      cluster.push_back(p);
+    }
+
+    autoware_msgs::DetectedObject output, reference;
+    const auto t0 = std::chrono::steady_clock::now();
+    ASSERT_TRUE(coarse_to_fine.estimate(cluster, output));
+    const auto t1 = std::chrono::steady_clock::now();
+    ASSERT_TRUE(exhaustive.estimate(cluster, reference));
+    const auto t2 = std::chrono::steady_clock::now();
+    coarse_to_fine_time += std::chrono::duration<double, std::micro>(t1 - t0).count();
+    exhaustive_time += std::chrono::duration<double, std::micro>(t2 - t1).count();
+
+    // a box is symmetric every 90 deg
+    const double yaw_diff =
+        std::remainder(tf2::getYaw(output.pose.orientation) - tf2::getYaw(reference.pose.orientation), M_PI / 2.0);
+    ASSERT_LT(std::fabs(yaw_diff), M_PI / 180.0) << "object " << k;
+    const double area = output.dimensions.x * output.dimensions.y;
+    const double reference_area = reference.dimensions.x * reference.dimensions.y;
+    ASSERT_NEAR(area, reference_area, 0.05 * reference_area) << "object " << k;
+  }
+
+  std::cout << "coarse to fine: " << coarse_to_fine_time / num_objects << " us/object, 1 deg sweep: "
+            << exhaustive_time / num_objects << " us/object" << std::endl;
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
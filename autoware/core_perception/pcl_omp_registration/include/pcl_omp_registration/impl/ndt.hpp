@@ -46,6 +46,9 @@ template<typename PointSource, typename PointTarget>
 pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::NormalDistributionsTransform ()
   : target_cells_ ()
   , resolution_ (1.0f)
+  , search_method_ (KDTREE)
+  , leaf_index_ ()
+  , leaf_index_cells_ (NULL)
   , step_size_ (0.1)
   , outlier_ratio_ (0.55)
   , gauss_d1_ ()
@@ -97,6 +100,9 @@ pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::computeTransfor
     transformPointCloud (output, output, guess);
   }
 
+  if (search_method_ != KDTREE && leaf_index_cells_ != &target_cells_)
+    buildLeafIndex ();
+
   // Initialize Point Gradient and Hessian
   point_gradient_.setZero ();
   point_gradient_.block<3, 3>(0, 0).setIdentity ();
@@ -173,6 +179,66 @@ pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::computeTransfor
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointSource, typename PointTarget> void
+pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::buildLeafIndex ()
+{
+  leaf_index_.clear ();
+  leaf_index_cells_ = &target_cells_;
+
+  // Leaves are keyed by their index in the bounding box of the target, recover their grid coordinates from it
+  const Eigen::Vector3i min_b = target_cells_.getMinBoxCoordinates ();
+  const Eigen::Vector3i div_b = target_cells_.getNrDivisions ();
+  const int min_points = target_cells_.getMinPointPerVoxel ();
+
+  typename std::map<size_t, typename TargetGrid::Leaf> &leaves = target_cells_.getLeaves ();
+  leaf_index_.reserve (leaves.size ());
+  for (typename std::map<size_t, typename TargetGrid::Leaf>::const_iterator it = leaves.begin (); it != leaves.end (); ++it)
+  {
+    // Same condition as the voxels with a covariance, which are the ones searchable by radius
+    if (it->second.nr_points < min_points)
+      continue;
+
+    const size_t index = it->first;
+    const int i = static_cast<int> (index % div_b[0]);
+    const int j = static_cast<int> ((index / div_b[0]) % div_b[1]);
+    const int k = static_cast<int> (index / (static_cast<size_t> (div_b[0]) * div_b[1]));
+    leaf_index_[leafKey (i + min_b[0], j + min_b[1], k + min_b[2])] = &(it->second);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointSource, typename PointTarget> void
+pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::getNeighborhood (const PointSource &x_trans_pt,
+                                                                              std::vector<TargetGridLeafConstPtr> &neighborhood,
+                                                                              std::vector<float> &distances)
+{
+  if (search_method_ == KDTREE)
+  {
+    target_cells_.radiusSearch (x_trans_pt, resolution_, neighborhood, distances);
+    return;
+  }
+
+  neighborhood.clear ();
+
+  // Grid coordinates of the voxel containing the point, computed as the voxel grid filter does
+  const float inverse_resolution = 1.0f / resolution_;
+  const int x = static_cast<int> (floor (x_trans_pt.x * inverse_resolution));
+  const int y = static_cast<int> (floor (x_trans_pt.y * inverse_resolution));
+  const int z = static_cast<int> (floor (x_trans_pt.z * inverse_resolution));
+
+  static const int offsets[7][3] = { { 0, 0, 0 }, { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 },
+                                     { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+  const int num_offsets = (search_method_ == DIRECT1) ? 1 : 7;
+  for (int i = 0; i < num_offsets; ++i)
+  {
+    typename std::unordered_map<int64_t, TargetGridLeafConstPtr>::const_iterator leaf =
+      leaf_index_.find (leafKey (x + offsets[i][0], y + offsets[i][1], z + offsets[i][2]));
+    if (leaf != leaf_index_.end ())
+      neighborhood.push_back (leaf->second);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointSource, typename PointTarget> double
 pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::computeDerivatives (Eigen::Matrix<double, 6, 1> &score_gradient,
@@ -213,7 +279,14 @@ pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::computeDerivati
 
   omp_set_nested(1);
   omp_set_dynamic(1);
-#pragma omp parallel for num_threads(num_threads) reduction(+:score) private(x_pt, x_trans_pt, x, x_trans, cell, c_inv)
+#endif
+
+  // Neighbourhoods are reused between the points of a thread
+  std::vector<TargetGridLeafConstPtr> neighborhood;
+  std::vector<float> distances;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads) reduction(+:score) private(x_pt, x_trans_pt, x, x_trans, cell, c_inv, neighborhood, distances)
 #endif
 
   // Update gradient and hessian for each point, line 17 in Algorithm 2 [Magnusson 2009]
@@ -221,10 +294,8 @@ pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::computeDerivati
   {
     x_trans_pt = trans_cloud.points[idx];
 
-    // Find nieghbors (Radius search has been experimentally faster than direct neighbor checking.
-    std::vector<TargetGridLeafConstPtr> neighborhood;
-    std::vector<float> distances;
-    target_cells_.radiusSearch (x_trans_pt, resolution_, neighborhood, distances);
+    // Find nieghbors
+    getNeighborhood (x_trans_pt, neighborhood, distances);
 
     for (typename std::vector<TargetGridLeafConstPtr>::iterator neighborhood_it = neighborhood.begin (); neighborhood_it != neighborhood.end (); neighborhood_it++)
     {
@@ -418,18 +489,21 @@ pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::computeAngleDer
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointSource, typename PointTarget> void
-pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivatives (Eigen::Vector3d &x, bool compute_hessian)
+pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivatives (Eigen::Vector3d &x,
+                                                                                      Eigen::Matrix<double, 3, 6> &point_gradient,
+                                                                                      Eigen::Matrix<double, 18, 6> &point_hessian,
+                                                                                      bool compute_hessian)
 {
   // Calculate first derivative of Transformation Equation 6.17 w.r.t. transform vector p.
   // Derivative w.r.t. ith element of transform vector corresponds to column i, Equation 6.18 and 6.19 [Magnusson 2009]
-  point_gradient_ (1, 3) = x.dot (j_ang_a_);
-  point_gradient_ (2, 3) = x.dot (j_ang_b_);
-  point_gradient_ (0, 4) = x.dot (j_ang_c_);
-  point_gradient_ (1, 4) = x.dot (j_ang_d_);
-  point_gradient_ (2, 4) = x.dot (j_ang_e_);
-  point_gradient_ (0, 5) = x.dot (j_ang_f_);
-  point_gradient_ (1, 5) = x.dot (j_ang_g_);
-  point_gradient_ (2, 5) = x.dot (j_ang_h_);
+  point_gradient (1, 3) = x.dot (j_ang_a_);
+  point_gradient (2, 3) = x.dot (j_ang_b_);
+  point_gradient (0, 4) = x.dot (j_ang_c_);
+  point_gradient (1, 4) = x.dot (j_ang_d_);
+  point_gradient (2, 4) = x.dot (j_ang_e_);
+  point_gradient (0, 5) = x.dot (j_ang_f_);
+  point_gradient (1, 5) = x.dot (j_ang_g_);
+  point_gradient (2, 5) = x.dot (j_ang_h_);
 
   if (compute_hessian)
   {
@@ -445,15 +519,15 @@ pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::computePointDer
 
     // Calculate second derivative of Transformation Equation 6.17 w.r.t. transform vector p.
     // Derivative w.r.t. ith and jth elements of transform vector corresponds to the 3x1 block matrix starting at (3i,j), Equation 6.20 and 6.21 [Magnusson 2009]
-    point_hessian_.block<3, 1>(9, 3) = a;
-    point_hessian_.block<3, 1>(12, 3) = b;
-    point_hessian_.block<3, 1>(15, 3) = c;
-    point_hessian_.block<3, 1>(9, 4) = b;
-    point_hessian_.block<3, 1>(12, 4) = d;
-    point_hessian_.block<3, 1>(15, 4) = e;
-    point_hessian_.block<3, 1>(9, 5) = c;
-    point_hessian_.block<3, 1>(12, 5) = e;
-    point_hessian_.block<3, 1>(15, 5) = f;
+    point_hessian.block<3, 1>(9, 3) = a;
+    point_hessian.block<3, 1>(12, 3) = b;
+    point_hessian.block<3, 1>(15, 3) = c;
+    point_hessian.block<3, 1>(9, 4) = b;
+    point_hessian.block<3, 1>(12, 4) = d;
+    point_hessian.block<3, 1>(15, 4) = e;
+    point_hessian.block<3, 1>(9, 5) = c;
+    point_hessian.block<3, 1>(12, 5) = e;
+    point_hessian.block<3, 1>(15, 5) = f;
   }
 }
 
@@ -521,15 +595,37 @@ pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::computeHessian
 
   // Precompute Angular Derivatives unessisary because only used after regular derivative calculation
 
+#ifdef _OPENMP
+  int num_threads = omp_get_max_threads() * 2;
+  std::vector<Eigen::Matrix<double,6,6>, Eigen::aligned_allocator<Eigen::Matrix<double,6,6> > > hessian_i(num_threads);
+  std::vector<Eigen::Matrix<double,3,6>> point_gradient_i(num_threads);
+  std::vector<Eigen::Matrix<double,18,6>> point_hessian_i(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    hessian_i[i].setZero ();
+    point_gradient_i[i].setZero ();
+    point_gradient_i[i].block<3, 3>(0, 0).setIdentity ();
+    point_hessian_i[i].setZero ();
+  }
+
+  omp_set_nested(1);
+  omp_set_dynamic(1);
+#endif
+
+  // Neighbourhoods are reused between the points of a thread
+  std::vector<TargetGridLeafConstPtr> neighborhood;
+  std::vector<float> distances;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads) private(x_pt, x_trans_pt, x, x_trans, cell, c_inv, neighborhood, distances)
+#endif
+
   // Update hessian for each point, line 17 in Algorithm 2 [Magnusson 2009]
   for (size_t idx = 0; idx < input_->points.size (); idx++)
   {
     x_trans_pt = trans_cloud.points[idx];
 
-    // Find nieghbors (Radius search has been experimentally faster than direct neighbor checking.
-    std::vector<TargetGridLeafConstPtr> neighborhood;
-    std::vector<float> distances;
-    target_cells_.radiusSearch (x_trans_pt, resolution_, neighborhood, distances);
+    // Find nieghbors
+    getNeighborhood (x_trans_pt, neighborhood, distances);
 
     for (typename std::vector<TargetGridLeafConstPtr>::iterator neighborhood_it = neighborhood.begin (); neighborhood_it != neighborhood.end (); neighborhood_it++)
     {
@@ -546,18 +642,31 @@ pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::computeHessian
         // Uses precomputed covariance for speed.
         c_inv = cell->getInverseCov ();
 
+#ifndef _OPENMP
         // Compute derivative of transform function w.r.t. transform vector, J_E and H_E in Equations 6.18 and 6.20 [Magnusson 2009]
         computePointDerivatives (x);
         // Update hessian, lines 21 in Algorithm 2, according to Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
         updateHessian (hessian, x_trans, c_inv);
+#else
+        const int thread_num = omp_get_thread_num();
+        computePointDerivatives (x, point_gradient_i[thread_num], point_hessian_i[thread_num]);
+        updateHessian (hessian_i[thread_num], x_trans, c_inv, point_gradient_i[thread_num], point_hessian_i[thread_num]);
+#endif
       }
     }
   }
+#ifdef _OPENMP
+  for (int i = 0; i < num_threads; ++i) {
+    hessian += hessian_i[i];
+  }
+#endif
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointSource, typename PointTarget> void
-pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::updateHessian (Eigen::Matrix<double, 6, 6> &hessian, Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv)
+pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::updateHessian (Eigen::Matrix<double, 6, 6> &hessian, Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv,
+                                                                            const Eigen::Matrix<double, 3, 6> &point_gradient,
+                                                                            const Eigen::Matrix<double, 18, 6> &point_hessian)
 {
   Eigen::Vector3d cov_dxd_pi;
   // e^(-d_2/2 * (x_k - mu_k)^T Sigma_k^-1 (x_k - mu_k)) Equation 6.9 [Magnusson 2009]
@@ -573,14 +682,14 @@ pcl_omp::NormalDistributionsTransform<PointSource, PointTarget>::updateHessian (
   for (int i = 0; i < 6; i++)
   {
     // Sigma_k^-1 d(T(x,p))/dpi, Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
-    cov_dxd_pi = c_inv * point_gradient_.col (i);
+    cov_dxd_pi = c_inv * point_gradient.col (i);
 
     for (int j = 0; j < hessian.cols (); j++)
     {
       // Update hessian, Equation 6.13 [Magnusson 2009]
-      hessian (i, j) += e_x_cov_x * (-gauss_d2_ * x_trans.dot (cov_dxd_pi) * x_trans.dot (c_inv * point_gradient_.col (j)) +
-                                  x_trans.dot (c_inv * point_hessian_.block<3, 1>(3 * i, j)) +
-                                  point_gradient_.col (j).dot (cov_dxd_pi) );
+      hessian (i, j) += e_x_cov_x * (-gauss_d2_ * x_trans.dot (cov_dxd_pi) * x_trans.dot (c_inv * point_gradient.col (j)) +
+                                  x_trans.dot (c_inv * point_hessian.block<3, 1>(3 * i, j)) +
+                                  point_gradient.col (j).dot (cov_dxd_pi) );
     }
   }
 
@@ -48,8 +48,27 @@
 
 #include <unsupported/Eigen/NonLinearOptimization>
 
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace pcl_omp
 {
+  /** \brief Methods to find the voxels a transformed source point is scored against.
+    * KDTREE searches all voxel centroids within the resolution of the point, DIRECT7 looks up the voxel
+    * containing the point and its 6 face neighbours, and DIRECT1 only the voxel containing the point.
+    */
+  enum NeighborSearchMethod
+  {
+    KDTREE,
+    DIRECT7,
+    DIRECT1
+  };
+
   /** \brief A 3D Normal Distribution Transform registration implementation for point cloud data.
     * \note For more information please see
     * <b>Magnusson, M. (2009). The Three-Dimensional Normal-Distributions Transform —
@@ -135,6 +154,24 @@ namespace pcl_omp
         return (resolution_);
       }
 
+      /** \brief Set/change the method to find the voxels neighbouring a transformed source point.
+        * \param[in] method neighbour search method, KDTREE by default
+        */
+      inline void
+      setNeighborhoodSearchMethod (NeighborSearchMethod method)
+      {
+        search_method_ = method;
+      }
+
+      /** \brief Get the method to find the voxels neighbouring a transformed source point.
+        * \return neighbour search method
+        */
+      inline NeighborSearchMethod
+      getNeighborhoodSearchMethod () const
+      {
+        return (search_method_);
+      }
+
       /** \brief Get the newton line search maximum step length.
         * \return maximum step length
         */
@@ -257,6 +294,31 @@ namespace pcl_omp
         target_cells_.setInputCloud ( target_ );
         // Initiate voxel structure.
         target_cells_.filter (true);
+        // The direct neighbour index is rebuilt on the next alignment.
+        leaf_index_.clear ();
+        leaf_index_cells_ = NULL;
+      }
+
+      /** \brief Index the voxels of \ref target_cells_ with enough points by their integer grid coordinates. */
+      void
+      buildLeafIndex ();
+
+      /** \brief Find the voxels a transformed source point is scored against, according to \ref search_method_.
+        * \param[in] x_trans_pt transformed source point
+        * \param[out] neighborhood voxels neighbouring the point
+        * \param[out] distances squared distances to the voxel centroids, only filled by KDTREE
+        */
+      void
+      getNeighborhood (const PointSource &x_trans_pt,
+                       std::vector<TargetGridLeafConstPtr> &neighborhood,
+                       std::vector<float> &distances);
+
+      /** \brief Pack integer grid coordinates into a key of \ref leaf_index_, 21 bits per axis. */
+      static inline int64_t
+      leafKey (int x, int y, int z)
+      {
+        return ((static_cast<int64_t> (x & 0x1FFFFF) << 42) | (static_cast<int64_t> (y & 0x1FFFFF) << 21) |
+                static_cast<int64_t> (z & 0x1FFFFF));
       }
 
       /** \brief Compute derivatives of probability function w.r.t. the transformation vector.
@@ -302,7 +364,23 @@ namespace pcl_omp
         * \param[in] compute_hessian flag to calculate hessian, unnessissary for step calculation.
         */
       void
-      computePointDerivatives (Eigen::Vector3d &x, bool compute_hessian = true);
+      computePointDerivatives (Eigen::Vector3d &x, bool compute_hessian = true)
+      {
+        computePointDerivatives (x, point_gradient_, point_hessian_, compute_hessian);
+      }
+
+      /** \brief Compute point derivatives into the given matrices, so that threads do not share them.
+        * \note Equation 6.18-21 [Magnusson 2009].
+        * \param[in] x point from the input cloud
+        * \param[in,out] point_gradient first order derivative of the point, \f$ J_E \f$ in Equation 6.18 [Magnusson 2009]
+        * \param[in,out] point_hessian second order derivative of the point, \f$ H_E \f$ in Equation 6.20 [Magnusson 2009]
+        * \param[in] compute_hessian flag to calculate hessian, unnessissary for step calculation.
+        */
+      void
+      computePointDerivatives (Eigen::Vector3d &x,
+                               Eigen::Matrix<double, 3, 6> &point_gradient,
+                               Eigen::Matrix<double, 18, 6> &point_hessian,
+                               bool compute_hessian = true);
 
       /** \brief Compute hessian of probability function w.r.t. the transformation vector.
         * \note Equation 6.13 [Magnusson 2009].
@@ -323,7 +401,24 @@ namespace pcl_omp
         */
       void
       updateHessian (Eigen::Matrix<double, 6, 6> &hessian,
-                     Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv);
+                     Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv)
+      {
+        updateHessian (hessian, x_trans, c_inv, point_gradient_, point_hessian_);
+      }
+
+      /** \brief Compute individual point contirbutions to hessian from the given point derivatives.
+        * \note Equation 6.13 [Magnusson 2009].
+        * \param[in,out] hessian the hessian matrix of the probability function w.r.t. the transformation vector
+        * \param[in] x_trans transformed point minus mean of occupied covariance voxel
+        * \param[in] c_inv covariance of occupied covariance voxel
+        * \param[in] point_gradient first order derivative of the point, \f$ J_E \f$ in Equation 6.18 [Magnusson 2009]
+        * \param[in] point_hessian second order derivative of the point, \f$ H_E \f$ in Equation 6.20 [Magnusson 2009]
+        */
+      void
+      updateHessian (Eigen::Matrix<double, 6, 6> &hessian,
+                     Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv,
+                     const Eigen::Matrix<double, 3, 6> &point_gradient,
+                     const Eigen::Matrix<double, 18, 6> &point_hessian);
 
       /** \brief Compute line search step length and update transform and probability derivatives using More-Thuente method.
         * \note Search Algorithm [More, Thuente 1994]
@@ -424,6 +519,17 @@ namespace pcl_omp
       /** \brief The side length of voxels. */
       float resolution_;
 
+      /** \brief The method to find the voxels neighbouring a transformed source point. */
+      NeighborSearchMethod search_method_;
+
+      /** \brief Voxels with enough points by their packed integer grid coordinates, used by DIRECT7 and DIRECT1. */
+      std::unordered_map<int64_t, TargetGridLeafConstPtr> leaf_index_;
+
+      /** \brief The voxel grid \ref leaf_index_ points into. It differs from \ref target_cells_ after
+        * the registration is copied, in which case the index is rebuilt.
+        */
+      const TargetGrid* leaf_index_cells_;
+
       /** \brief The maximum step length. */
       double step_size_;
 
@@ -36,7 +36,9 @@
 #include <sensor_msgs/CameraInfo.h>
 #include <visualization_msgs/MarkerArray.h>
 
+#include <future>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 static constexpr double DEFAULT_SIGNAL_LAMP_RADIUS = 0.3;
@@ -81,6 +83,27 @@ private:
 
   autoware_msgs::LaneArray waypoints_;
 
+  // traffic light linestrings bucketed on a 2D grid, built once per map
+  struct TrafficLightBase
+  {
+    lanelet::AutowareTrafficLightConstPtr tl;
+    lanelet::BasicPoint2d base_0;
+    lanelet::BasicPoint2d base_1;
+    double facing_dir;
+  };
+  double tl_grid_cell_size_ = 50.0;
+  std::vector<TrafficLightBase> tl_bases_;
+  std::unordered_map<uint64_t, std::vector<size_t>> tl_grid_;
+
+  // traffic lights on the path, matched in the background whenever the path moved more than route_refresh_distance_
+  double route_refresh_distance_ = 10.0;
+  bool route_changed_ = false;
+  bool route_requested_ = false;
+  lanelet::BasicPoint2d route_requested_front_;
+  lanelet::BasicPoint2d route_requested_back_;
+  std::vector<lanelet::AutowareTrafficLightConstPtr> route_aw_tl_;
+  std::future<std::vector<lanelet::AutowareTrafficLightConstPtr>> route_aw_tl_future_;
+
   Eigen::Vector3f position_;
   Eigen::Quaternionf orientation_;
   float fx_;
@@ -108,9 +131,13 @@ private:
   bool inView(const lanelet::BasicPoint2d& p, const lanelet::BasicPoint2d& cam, double heading, const double max_a,
               const double max_r);
   bool isAttributeValue(const lanelet::ConstPoint3d& p, const std::string& attr_str, const std::string& value_str);
-  void trafficLightVisibilityCheck(const std::vector<lanelet::AutowareTrafficLightConstPtr>& aw_tl_reg_elems,
-                                   std::vector<lanelet::AutowareTrafficLightConstPtr>* visible_aw_tl);
-  void findVisibleTrafficLightFromLanes(std::vector<lanelet::AutowareTrafficLightConstPtr>* visible_aw_tl);
+  uint64_t computeCellKey(const int ix, const int iy) const;
+  void buildTrafficLightIndex(const std::vector<lanelet::AutowareTrafficLightConstPtr>& aw_tl_reg_elems);
+  void trafficLightVisibilityCheck(std::vector<lanelet::AutowareTrafficLightConstPtr>* visible_aw_tl);
+  std::vector<lanelet::AutowareTrafficLightConstPtr>
+  findTrafficLightsOnPath(const lanelet::LaneletMapPtr lanelet_map, const lanelet::routing::RoutingGraphPtr routing_graph,
+                          const autoware_msgs::LaneArray waypoints);
+  void updateRouteTrafficLights();
   void findSignalsInCameraFrame(const std::vector<lanelet::AutowareTrafficLightConstPtr>& visible_aw_tl,
                                 autoware_msgs::Signals* signalsInFrame);
   lanelet::ConstLineString3d createDummyLightBulbString(const lanelet::ConstLineString3d& base_string);
@@ -44,6 +44,15 @@ double getBrightnessRatioInCircle(const cv::Mat& input, const cv::Point center,
 int getCurrentLightsCode(bool display_red, bool display_yellow, bool display_green);
 LightState determineState(LightState previousState, int currentLightsCode, int* stateJudgeCount);
 
+/* per context images reused between frames */
+struct ROIBuffer
+{
+  cv::Mat hsv;
+  cv::Mat blurred;
+  cv::Mat binarized;
+  cv::Mat signalMask;
+};
+
 class TrafficLightDetector
 {
 public:
@@ -51,6 +60,11 @@ public:
   void brightnessDetect(const cv::Mat& input);
   void colorDetect(const cv::Mat& input, cv::Mat* output, const cv::Rect coords, int Hmin, int Hmax);
   std::vector<Context> contexts;
+  bool roiOnly;  // process only the projected regions instead of the whole image
+
+private:
+  std::vector<ROIBuffer> roiBuffers;
+  void brightnessDetect_inROIs(const cv::Mat& input);
 };
 
 enum daytime_Hue_threshold
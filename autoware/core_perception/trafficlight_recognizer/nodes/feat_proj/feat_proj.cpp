@@ -19,11 +19,17 @@
 #include "libvectormap/Math.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <future>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <signal.h>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include <Eigen/Eigen>
 
@@ -66,21 +72,52 @@ static float fx, fy, imageWidth, imageHeight, cx, cy;
 static tf::StampedTransform trf;
 
 static bool g_use_vector_map_server;  // Switch flag whether vecter-map-server function will be used
-static ros::ServiceClient g_ros_client;
 
 #define SignalLampRadius 0.3
+#define SignalGridCellSize 50.0
+
+/* Signal with its lamp position and direction resolved once when the vector map is loaded */
+typedef struct
+{
+  Signal signal;
+  Point3 center;
+  double hang;
+  double vang;
+}
+SignalLamp;
+
+static std::vector<SignalLamp> signal_lamps;
+static vector_map::SpatialGrid signal_grid;  // ids are indices into signal_lamps
+static size_t signal_index_signature = 0;
 
 /* Define utility class to use vector map server */
 namespace
 {
+typedef std::shared_ptr<const std::unordered_set<int>> SignalIdSet;
+
 class VectorMapClient
 {
 private:
   geometry_msgs::PoseStamped pose_;
   autoware_msgs::Lane waypoints_;
+  ros::ServiceClient client_;
+  double refresh_distance_;
+
+  /* ids of the signals on the route, null until the server answered once */
+  SignalIdSet route_signals_;
+  std::future<SignalIdSet> request_;
+  bool route_changed_;
+  bool requested_;
+  geometry_msgs::Point requested_front_;
+  geometry_msgs::Point requested_back_;
+
+  static double distance2D(const geometry_msgs::Point& a, const geometry_msgs::Point& b)
+  {
+    return std::hypot(a.x - b.x, a.y - b.y);
+  }
 
 public:
-  VectorMapClient()
+  VectorMapClient() : refresh_distance_(10.0), route_changed_(false), requested_(false)
   {
   }
 
@@ -88,14 +125,15 @@ public:
   {
   }
 
-  geometry_msgs::PoseStamped pose() const
+  void init(const ros::ServiceClient& client, double refresh_distance)
   {
-    return pose_;
+    client_ = client;
+    refresh_distance_ = refresh_distance;
   }
 
-  autoware_msgs::Lane waypoints() const
+  SignalIdSet route_signals() const
   {
-    return waypoints_;
+    return route_signals_;
   }
 
   void set_pose(const geometry_msgs::PoseStamped& pose)
@@ -103,9 +141,67 @@ public:
     pose_ = pose;
   }
 
+  /* final_waypoints slides with the vehicle, so the route is considered changed once either end moved enough */
   void set_waypoints(const autoware_msgs::Lane& waypoints)
   {
     waypoints_ = waypoints;
+    if (waypoints_.waypoints.empty())
+    {
+      return;
+    }
+
+    const geometry_msgs::Point& front = waypoints_.waypoints.front().pose.pose.position;
+    const geometry_msgs::Point& back = waypoints_.waypoints.back().pose.pose.position;
+    if (!requested_ || distance2D(front, requested_front_) > refresh_distance_ ||
+        distance2D(back, requested_back_) > refresh_distance_)
+    {
+      route_changed_ = true;
+    }
+  }
+
+  /* Collect the answer of a finished request and start a new one if the route changed. Never blocks. */
+  void update()
+  {
+    if (request_.valid() && request_.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+      SignalIdSet signals = request_.get();
+      if (signals)
+      {
+        route_signals_ = signals;
+        ROS_INFO("[feat_proj] VectorMapServer available. %lu TrafficSignals on the current lane", signals->size());
+      }
+    }
+
+    if (!route_changed_ || request_.valid())
+    {
+      return;
+    }
+
+    vector_map_server::GetSignal service;
+    service.request.pose = pose_;
+    service.request.waypoints = waypoints_;
+    requested_front_ = waypoints_.waypoints.front().pose.pose.position;
+    requested_back_ = waypoints_.waypoints.back().pose.pose.position;
+    requested_ = true;
+    route_changed_ = false;
+
+    ros::ServiceClient client = client_;
+    request_ = std::async(std::launch::async, [client, service]() mutable {
+      if (!client.call(service))
+      {
+        return SignalIdSet();
+      }
+
+      std::shared_ptr<std::unordered_set<int>> signals = std::make_shared<std::unordered_set<int>>();
+      for (const auto& response : service.response.objects.data)
+      {
+        if (response.id != 0)
+        {
+          signals->insert(response.id);
+        }
+      }
+      return SignalIdSet(signals);
+    });
   }
 };  // Class VectorMapClient
 }  // namespace
@@ -270,50 +366,81 @@ double GetSignalAngleInCameraSystem(double hang, double vang)
   return ConvertRadianToDegree(signal_pitch_in_cam);  // holizontal angle of camera is represented by pitch
 }  // double GetSignalAngleInCameraSystem()
 
-void echoSignals2(const ros::Publisher& pub, bool useOpenGLCoord = false)
+/*
+ * Resolve every signal to its lamp position and bucket it on a 2D grid. Only rebuilt when the vector map changes.
+ */
+void buildSignalIndex()
 {
-  int countPoint = 0;
-  autoware_msgs::Signals signalsInFrame;
-
-  /* Get signals on the path if vecter_map_server is enabled */
-  if (g_use_vector_map_server)
+  size_t signature = vmap.signals.size() + vmap.vectors.size() + vmap.points.size();
+  if (signature == signal_index_signature)
   {
-    vector_map_server::GetSignal service;
-    /* Set server's request */
-    service.request.pose = g_vector_map_client.pose();
-    service.request.waypoints = g_vector_map_client.waypoints();
+    return;
+  }
+  signal_index_signature = signature;
 
-    /* Get server's response*/
-    if (g_ros_client.call(service))
+  signal_lamps.clear();
+  signal_grid.clear(SignalGridCellSize, false);
+  for (const auto& signal_map : vmap.signals)
+  {
+    const Signal& signal = signal_map.second;
+    auto vector = vmap.vectors.find(signal.vid);
+    if (vector == vmap.vectors.end() || vmap.points.find(vector->second.pid) == vmap.points.end())
     {
-      /* Reset signal data container */
-      vmap.signals.clear();
+      ROS_WARN("[feat_proj] Signal %d has no lamp position, ignored", signal.id);
+      continue;
+    }
 
-      /* Newle insert signal data on the path */
-      for (const auto& response : service.response.objects.data)
-      {
-        if (response.id == 0)
-          continue;
+    SignalLamp lamp;
+    lamp.signal = signal;
+    lamp.center = vmap.getPoint(vector->second.pid);
+    lamp.hang = vector->second.hang;
+    lamp.vang = vector->second.vang;
+
+    geometry_msgs::Point p;
+    p.x = lamp.center.x();
+    p.y = lamp.center.y();
+    p.z = lamp.center.z();
+    signal_grid.insert(static_cast<int>(signal_lamps.size()), std::vector<geometry_msgs::Point>(1, p));
+    signal_lamps.push_back(lamp);
+  }
 
-        Signal signal;
-        signal.id = response.id;
-        signal.vid = response.vid;
-        signal.plid = response.plid;
-        signal.type = response.type;
-        signal.linkid = response.linkid;
+  ROS_INFO("[feat_proj] Indexed %lu signals", signal_lamps.size());
+}
 
-        vmap.signals.insert(std::map<int, Signal>::value_type(signal.id, signal));
-      }
-      ROS_INFO("[feat_proj] VectorMapServer available. Publishing only TrafficSignals on the current lane");
-    }
+void echoSignals2(const ros::Publisher& pub, bool useOpenGLCoord = false)
+{
+  int countPoint = 0;
+  autoware_msgs::Signals signalsInFrame;
+
+  /* Only signals on the path if vecter_map_server is enabled and has answered */
+  SignalIdSet route_signals;
+  if (g_use_vector_map_server)
+  {
+    g_vector_map_client.update();
+    route_signals = g_vector_map_client.route_signals();
   }
 
-  for (const auto& signal_map : vmap.signals)
+  /*
+   * Query the grid with the bounding circle of the view frustum: centered half way to the far plane on the optical
+   * axis, large enough to hold the corners of the far plane.
+   */
+  tf::Transform camera_in_map = trf.inverse();
+  tf::Vector3 optical_axis = camera_in_map.getBasis() * tf::Vector3(0, 0, 1);
+  tf::Vector3 frustum_center = camera_in_map.getOrigin() + optical_axis * (far_plane_ / 2);
+  double tan_x = (fx > 0) ? std::max(cx, imageWidth - cx) / fx : 0;
+  double tan_y = (fy > 0) ? std::max(cy, imageHeight - cy) / fy : 0;
+  double frustum_radius = far_plane_ * std::sqrt(0.25 + tan_x * tan_x + tan_y * tan_y) + SignalLampRadius;
+
+  for (int index : signal_grid.query(frustum_center.x(), frustum_center.y(), frustum_radius))
   {
-    const Signal signal = signal_map.second;
-    int pid = vmap.vectors[signal.vid].pid;
+    const SignalLamp& lamp = signal_lamps[index];
+    const Signal& signal = lamp.signal;
+    if (route_signals && route_signals->count(signal.id) == 0)
+    {
+      continue;
+    }
 
-    Point3 signalcenter = vmap.getPoint(pid);
+    const Point3& signalcenter = lamp.center;
     Point3 signalcenterx(signalcenter.x(), signalcenter.y(), signalcenter.z() + SignalLampRadius);
 
     int u, v;
@@ -334,13 +461,12 @@ void echoSignals2(const ros::Publisher& pub, bool useOpenGLCoord = false)
 
       sign.radius = radius;
       sign.x = signalcenter.x(), sign.y = signalcenter.y(), sign.z = signalcenter.z();
-      sign.hang = vmap.vectors[signal.vid].hang;  // hang is expressed in [0, 360] degree
+      sign.hang = lamp.hang;  // hang is expressed in [0, 360] degree
       sign.type = signal.type, sign.linkId = signal.linkid;
       sign.plId = signal.plid;
 
       // Get holizontal angle of signal in camera corrdinate system
-      double signal_angle =
-          GetSignalAngleInCameraSystem(vmap.vectors[signal.vid].hang + 180.0f, vmap.vectors[signal.vid].vang + 180.0f);
+      double signal_angle = GetSignalAngleInCameraSystem(lamp.hang + 180.0f, lamp.vang + 180.0f);
 
       // signal_angle will be zero if signal faces to x-axis
       // Target signal should be face to -50 <= z-axis (= 90 degree) <= +50
@@ -350,6 +476,11 @@ void echoSignals2(const ros::Publisher& pub, bool useOpenGLCoord = false)
       }
     }
   }
+
+  std::sort(signalsInFrame.Signals.begin(), signalsInFrame.Signals.end(),
+            [](const autoware_msgs::ExtractedPosition& a, const autoware_msgs::ExtractedPosition& b) {
+              return a.signalId < b.signalId;
+            });
   signalsInFrame.header.stamp = ros::Time::now();
   pub.publish(signalsInFrame);
 
@@ -407,6 +538,7 @@ int main(int argc, char* argv[])
 
   vmap.loaded = true;
   ROS_INFO("Vector Map loaded.");
+  buildSignalIndex();
 
   ros::Subscriber cameraInfoSubscriber = rosnode.subscribe(cameraInfo_topic_name, 100, cameraInfoCallback);
   ros::Subscriber cameraImage = rosnode.subscribe(cameraInfo_topic_name, 100, cameraInfoCallback);
@@ -420,8 +552,11 @@ int main(int argc, char* argv[])
     waypoint_subscriber =
         rosnode.subscribe("/final_waypoints", 1, &VectorMapClient::set_waypoints, &g_vector_map_client);
 
-    /* Create ros client to use Server-Client communication */
-    g_ros_client = rosnode.serviceClient<vector_map_server::GetSignal>("vector_map_server/get_signal");
+    /* Create ros client to use Server-Client communication, requests are sent in the background on route change */
+    double route_refresh_distance;
+    private_nh.param<double>("route_refresh_distance", route_refresh_distance, 10.0);
+    g_vector_map_client.init(rosnode.serviceClient<vector_map_server::GetSignal>("vector_map_server/get_signal"),
+                             route_refresh_distance);
   }
 
   ros::Publisher signalPublisher = rosnode.advertise<autoware_msgs::Signals>("roi_signal", 100);
@@ -444,6 +579,7 @@ int main(int argc, char* argv[])
 
     if (prev_orientation.vec() != orientation.vec() && prev_position != position)
     {
+      buildSignalIndex();
       echoSignals2(signalPublisher, false);
     }
     prev_orientation = orientation;
@@ -38,6 +38,7 @@
 #include <visualization_msgs/MarkerArray.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <map>
 #include <set>
@@ -112,6 +113,20 @@ void FeatProjLanelet2::waypointsCallback(const autoware_msgs::Lane::ConstPtr& wa
       }
     }
   }
+
+  // final_waypoints slides with the vehicle, so the path is considered changed once either end moved enough
+  const auto& path = waypoints_.lanes.front().waypoints;
+  if (path.empty())
+  {
+    return;
+  }
+  lanelet::BasicPoint2d front(path.front().pose.pose.position.x, path.front().pose.pose.position.y);
+  lanelet::BasicPoint2d back(path.back().pose.pose.position.x, path.back().pose.pose.position.y);
+  if (!route_requested_ || !inRange(front, route_requested_front_, route_refresh_distance_) ||
+      !inRange(back, route_requested_back_, route_refresh_distance_))
+  {
+    route_changed_ = true;
+  }
 }
 
 // @brief get transformation between given frames
@@ -230,10 +245,59 @@ bool FeatProjLanelet2::isAttributeValue(const lanelet::ConstPoint3d& p, const st
   return false;
 }
 
-// @brief find visible traffic lights
-void FeatProjLanelet2::trafficLightVisibilityCheck(
-    const std::vector<lanelet::AutowareTrafficLightConstPtr>& aw_tl_reg_elems,
-    std::vector<lanelet::AutowareTrafficLightConstPtr>* visible_aw_tl)
+uint64_t FeatProjLanelet2::computeCellKey(const int ix, const int iy) const
+{
+  return (static_cast<uint64_t>(static_cast<uint32_t>(ix)) << 32) | static_cast<uint32_t>(iy);
+}
+
+// @brief bucket traffic light linestrings on a 2D grid, facing direction is precomputed
+void FeatProjLanelet2::buildTrafficLightIndex(
+    const std::vector<lanelet::AutowareTrafficLightConstPtr>& aw_tl_reg_elems)
+{
+  tl_bases_.clear();
+  tl_grid_.clear();
+
+  for (const auto& tl : aw_tl_reg_elems)
+  {
+    for (const auto& lsp : tl->trafficLights())
+    {
+      if (!lsp.isLineString())  // traffic ligths must be linestrings
+      {
+        continue;
+      }
+      lanelet::ConstLineString3d ls = static_cast<lanelet::ConstLineString3d>(lsp);
+
+      TrafficLightBase base;
+      base.tl = tl;
+      base.base_0 = lanelet::utils::to2D(ls.front()).basicPoint();
+      base.base_1 = lanelet::utils::to2D(ls.back()).basicPoint();
+
+      double dx = base.base_1.x() - base.base_0.x();
+      double dy = base.base_1.y() - base.base_0.y();
+      double nx = -dy;  // 90 rotation for cos sin = 1's and 0's -> normal is -dy, dx
+      double ny = dx;
+      base.facing_dir = normalise(std::atan2(ny, nx), -M_PI, M_PI);
+
+      size_t index = tl_bases_.size();
+      tl_bases_.push_back(base);
+
+      int min_ix = std::floor(std::min(base.base_0.x(), base.base_1.x()) / tl_grid_cell_size_);
+      int max_ix = std::floor(std::max(base.base_0.x(), base.base_1.x()) / tl_grid_cell_size_);
+      int min_iy = std::floor(std::min(base.base_0.y(), base.base_1.y()) / tl_grid_cell_size_);
+      int max_iy = std::floor(std::max(base.base_0.y(), base.base_1.y()) / tl_grid_cell_size_);
+      for (int ix = min_ix; ix <= max_ix; ++ix)
+      {
+        for (int iy = min_iy; iy <= max_iy; ++iy)
+        {
+          tl_grid_[computeCellKey(ix, iy)].push_back(index);
+        }
+      }
+    }
+  }
+}
+
+// @brief find visible traffic lights, only the grid cells around the camera are visited
+void FeatProjLanelet2::trafficLightVisibilityCheck(std::vector<lanelet::AutowareTrafficLightConstPtr>* visible_aw_tl)
 {
   if (visible_aw_tl == nullptr)
   {
@@ -243,78 +307,109 @@ void FeatProjLanelet2::trafficLightVisibilityCheck(
 
   lanelet::BasicPoint2d camera_position_2d(position_.x(), position_.y());
   double cam_yaw = tf::getYaw(map_to_camera_tf_.getRotation()) + M_PI / 2;
+  lanelet::BasicPoint2d cam_dir(std::cos(cam_yaw), std::sin(cam_yaw));
 
-  // for each traffic light in map check if in range and in view angle of camera
-  for (auto tli = aw_tl_reg_elems.begin(); tli != aw_tl_reg_elems.end(); tli++)
-  {
-    lanelet::AutowareTrafficLightConstPtr tl = *tli;
-
-    lanelet::LineString3d ls;
+  const double max_r = 200.0;
+  int min_ix = std::floor((camera_position_2d.x() - max_r) / tl_grid_cell_size_);
+  int max_ix = std::floor((camera_position_2d.x() + max_r) / tl_grid_cell_size_);
+  int min_iy = std::floor((camera_position_2d.y() - max_r) / tl_grid_cell_size_);
+  int max_iy = std::floor((camera_position_2d.y() + max_r) / tl_grid_cell_size_);
 
-    auto lights = tl->trafficLights();
-    for (auto lsp : lights)
+  std::set<size_t> candidates;
+  for (int ix = min_ix; ix <= max_ix; ++ix)
+  {
+    for (int iy = min_iy; iy <= max_iy; ++iy)
     {
-      if (lsp.isLineString())  // traffic ligths must be linestrings
+      // cells entirely behind the camera cannot be projected into the image
+      double x0 = ix * tl_grid_cell_size_ - camera_position_2d.x();
+      double y0 = iy * tl_grid_cell_size_ - camera_position_2d.y();
+      double x1 = x0 + tl_grid_cell_size_;
+      double y1 = y0 + tl_grid_cell_size_;
+      if (std::max(x0 * cam_dir.x(), x1 * cam_dir.x()) + std::max(y0 * cam_dir.y(), y1 * cam_dir.y()) < 0)
       {
-        lanelet::ConstLineString3d ls = static_cast<lanelet::ConstLineString3d>(lsp);
-
-        lanelet::BasicPoint2d tl_base_0 = lanelet::utils::to2D(ls.front()).basicPoint();
-        lanelet::BasicPoint2d tl_base_1 = lanelet::utils::to2D(ls.back()).basicPoint();
+        continue;
+      }
 
-        double max_r = 200.0;
+      auto cell = tl_grid_.find(computeCellKey(ix, iy));
+      if (cell != tl_grid_.end())
+      {
+        candidates.insert(cell->second.begin(), cell->second.end());
+      }
+    }
+  }
 
-        if (inRange(tl_base_0, camera_position_2d, max_r) && inRange(tl_base_1, camera_position_2d, max_r))
-        {
-          double dx = tl_base_1.x() - tl_base_0.x();
-          double dy = tl_base_1.y() - tl_base_0.y();
-          double nx = -dy;  // 90 rotation for cos sin = 1's and 0's -> normal is -dy, dx
-          double ny = dx;
-          double dir = normalise(std::atan2(ny, nx), -M_PI, M_PI);
+  // for each traffic light near the camera check if in range and in view angle of camera
+  std::set<lanelet::Id> already_added;
+  for (size_t index : candidates)
+  {
+    const TrafficLightBase& base = tl_bases_[index];
+    if (already_added.find(base.tl->id()) != already_added.end())
+    {
+      continue;
+    }
 
-          double diff = getAbsoluteDiff2Angles(dir, cam_yaw, M_PI);
+    if (inRange(base.base_0, camera_position_2d, max_r) && inRange(base.base_1, camera_position_2d, max_r))
+    {
+      double diff = getAbsoluteDiff2Angles(base.facing_dir, cam_yaw, M_PI);
 
-          // traffic light must be facing to the vehicle
-          if (std::abs(diff) < 50.0 / 180.0 * M_PI)
-          {
-            // testing range twice (above inRange) for each base point at the moment
-            if (inView(tl_base_0, camera_position_2d, cam_yaw, M_PI, max_r) &&
-                inView(tl_base_1, camera_position_2d, cam_yaw, M_PI, max_r))
-            {
-              visible_aw_tl->push_back(tl);
-            }
-          }
-        }
+      // traffic light must be facing to the vehicle
+      if (std::abs(diff) < 50.0 / 180.0 * M_PI)
+      {
+        visible_aw_tl->push_back(base.tl);
+        already_added.insert(base.tl->id());
       }
     }
   }
 }
 
-void FeatProjLanelet2::findVisibleTrafficLightFromLanes(
-    std::vector<lanelet::AutowareTrafficLightConstPtr>* visible_aw_tl)
+// @brief find traffic lights referenced by the lanelets matched with the waypoints, runs off the main loop so it
+// works on its own references of the map and the routing graph
+std::vector<lanelet::AutowareTrafficLightConstPtr>
+FeatProjLanelet2::findTrafficLightsOnPath(const lanelet::LaneletMapPtr lanelet_map,
+                                          const lanelet::routing::RoutingGraphPtr routing_graph,
+                                          const autoware_msgs::LaneArray waypoints)
 {
-  if (visible_aw_tl == nullptr)
-  {
-    ROS_ERROR_STREAM(__FUNCTION__ << ": visible_aw_tl is null pointer!");
-    return;
-  }
-
   std::map<int, lanelet::Id> waypoint2laneletid;
   std::set<lanelet::Id> already_added;
   lanelet::ConstLanelets relevant_lanelets;
 
   // find lanelets that matches with waypoint
-  lanelet::utils::matchWaypointAndLanelet(lanelet_map_, routing_graph_ptr_, waypoints_, &waypoint2laneletid);
+  lanelet::utils::matchWaypointAndLanelet(lanelet_map, routing_graph, waypoints, &waypoint2laneletid);
   for (const auto& wp2llt : waypoint2laneletid)
   {
     if (already_added.find(wp2llt.second) == already_added.end())
     {
-      lanelet::ConstLanelet lanelet = lanelet_map_->laneletLayer.get(wp2llt.second);
+      lanelet::ConstLanelet lanelet = lanelet_map->laneletLayer.get(wp2llt.second);
       relevant_lanelets.push_back(lanelet);
       already_added.insert(wp2llt.second);
     }
   }
 
-  *visible_aw_tl = lanelet::utils::query::autowareTrafficLights(relevant_lanelets);
+  return lanelet::utils::query::autowareTrafficLights(relevant_lanelets);
+}
+
+// @brief collect a finished path matching and start a new one if the path changed, never blocks
+void FeatProjLanelet2::updateRouteTrafficLights()
+{
+  if (route_aw_tl_future_.valid() &&
+      route_aw_tl_future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+  {
+    route_aw_tl_ = route_aw_tl_future_.get();
+  }
+
+  if (!route_changed_ || route_aw_tl_future_.valid())
+  {
+    return;
+  }
+
+  const auto& path = waypoints_.lanes.front().waypoints;
+  route_requested_front_ = lanelet::BasicPoint2d(path.front().pose.pose.position.x, path.front().pose.pose.position.y);
+  route_requested_back_ = lanelet::BasicPoint2d(path.back().pose.pose.position.x, path.back().pose.pose.position.y);
+  route_requested_ = true;
+  route_changed_ = false;
+
+  route_aw_tl_future_ = std::async(std::launch::async, &FeatProjLanelet2::findTrafficLightsOnPath, this, lanelet_map_,
+                                   routing_graph_ptr_, waypoints_);
 }
 
 // @brief create dummy light_bulbs linestring from traffic_light linestring
@@ -467,6 +562,7 @@ void FeatProjLanelet2::init()
   private_nh_.param<bool>("use_path_info", use_path_info_, false);
   private_nh_.param<float>("roi_search_min_distance", near_plane_, 1.0);
   private_nh_.param<float>("roi_search_max_distance", far_plane_, 200.0);
+  private_nh_.param<double>("route_refresh_distance", route_refresh_distance_, 10.0);
 
   waypoint_subscriber_ = rosnode_.subscribe("final_waypoints", 1, &FeatProjLanelet2::waypointsCallback, this);
 
@@ -491,6 +587,7 @@ void FeatProjLanelet2::run()
   lanelet::ConstLanelets all_lanelets = lanelet::utils::query::laneletLayer(lanelet_map_);
   std::vector<lanelet::AutowareTrafficLightConstPtr> aw_tl_reg_elems =
       lanelet::utils::query::autowareTrafficLights(all_lanelets);
+  buildTrafficLightIndex(aw_tl_reg_elems);
 
   std_msgs::ColorRGBA cl;
   cl.r = 0.9;
@@ -520,14 +617,14 @@ void FeatProjLanelet2::run()
 
       if (use_path_info_)
       {
-        // match waypoints and lanelets, then find relevant traffic lights to matched lanelet
-        findVisibleTrafficLightFromLanes(&visible_aw_tl);
+        // traffic lights of the lanelets matched with the waypoints, refreshed in the background
+        updateRouteTrafficLights();
+        visible_aw_tl = route_aw_tl_;
       }
       else
       {
         // check if traffic light regulatory elements are potentially in camera view field
-        // Future: should pre select candidates by lanelets on current waypoint path
-        trafficLightVisibilityCheck(aw_tl_reg_elems, &visible_aw_tl);
+        trafficLightVisibilityCheck(&visible_aw_tl);
       }
 
       // int tl_count = 0;
@@ -484,6 +484,7 @@ int main(int argc, char* argv[])
   std::string camera_light_color_topic_name;
   private_nh.param<std::string>("image_raw_topic", image_topic_name, "/image_raw");
   private_nh.param<std::string>("camera_light_color_topic", camera_light_color_topic_name, "/camera_light_color");
+  private_nh.param<bool>("roi_only", detector.roiOnly, false);
 
   ros::Subscriber image_sub = n.subscribe(image_topic_name, 1, image_raw_cb);
   ros::Subscriber position_sub = n.subscribe("/roi_signal", 1, extractedPos_cb);
@@ -159,6 +159,9 @@ static bool checkExtinctionLight(const cv::Mat& src_img, const cv::Point top_lef
   return isThere_dark;
 } /* static bool checkExtinctionLight() */
 
+static void filterSignalRegions(cv::Mat* binarized, cv::Mat* bright_mask, const cv::Mat& src_img,
+                                const double estimatedRadius, const cv::Point roi_topLeft, bool in_turn_signal);
+
 static cv::Mat signalDetect_inROI(const cv::Mat& roi, const cv::Mat& src_img, const double estimatedRadius,
                                   const cv::Point roi_topLeft,
                                   bool in_turn_signal  // if true it will not try to mask by using "circularity""
@@ -187,12 +190,25 @@ static cv::Mat signalDetect_inROI(const cv::Mat& roi, const cv::Mat& src_img, co
   bitwise_or(binarized, green_mask, binarized);
   threshold(binarized, binarized, 0, 255, CV_THRESH_BINARY | CV_THRESH_OTSU);
 
+  cv::Mat bright_mask;
+  filterSignalRegions(&binarized, &bright_mask, src_img, estimatedRadius, roi_topLeft, in_turn_signal);
+
+  return bright_mask;
+} /* static void signalDetect_inROI() */
+
+static void filterSignalRegions(cv::Mat* binarized,   // bright region candidates, modified by findContours
+                                cv::Mat* bright_mask,  // regions which seem to be lit lamps
+                                const cv::Mat& src_img, const double estimatedRadius, const cv::Point roi_topLeft,
+                                bool in_turn_signal  // if true it will not try to mask by using "circularity""
+)
+{
   /* filter by its shape and index each bright region */
   std::vector<std::vector<cv::Point> > bright_contours;
   std::vector<cv::Vec4i> bright_hierarchy;
-  findContours(binarized, bright_contours, bright_hierarchy, CV_RETR_CCOMP, CV_CHAIN_APPROX_NONE);
+  findContours(*binarized, bright_contours, bright_hierarchy, CV_RETR_CCOMP, CV_CHAIN_APPROX_NONE);
 
-  cv::Mat bright_mask = cv::Mat::zeros(roi.rows, roi.cols, CV_8UC1);
+  bright_mask->create(binarized->rows, binarized->cols, CV_8UC1);
+  bright_mask->setTo(cv::Scalar(0));
 
   int contours_idx = 0;
   std::vector<regionCandidate> candidates;
@@ -222,7 +238,7 @@ static cv::Mat signalDetect_inROI(const cv::Mat& roi, const cv::Mat& src_img, co
       candidates.push_back(cnd);
     }
 
-    drawContours(bright_mask, bright_contours, contours_idx, rangeColor, CV_FILLED, 8, bright_hierarchy, 0);
+    drawContours(*bright_mask, bright_contours, contours_idx, rangeColor, CV_FILLED, 8, bright_hierarchy, 0);
 
     /* only contours on toplevel are considered */
     contours_idx = bright_hierarchy[contours_idx][0];
@@ -231,7 +247,7 @@ static cv::Mat signalDetect_inROI(const cv::Mat& roi, const cv::Mat& src_img, co
   }
 
 #ifdef SHOW_DEBUG_INFO
-  imshow("bright_mask", bright_mask);
+  imshow("bright_mask", *bright_mask);
   cv::waitKey(10);
 #endif
 
@@ -268,7 +284,7 @@ static cv::Mat signalDetect_inROI(const cv::Mat& roi, const cv::Mat& src_img, co
       if (!likeGreen && !likeYellow && !likeRed) /* this region may not be traffic light */
       {
         candidates_num--;
-        drawContours(bright_mask, bright_contours, candidates.at(i).idx, BLACK, CV_FILLED, 8, bright_hierarchy, 0);
+        drawContours(*bright_mask, bright_contours, candidates.at(i).idx, BLACK, CV_FILLED, 8, bright_hierarchy, 0);
         candidates.at(i).isBlacked = true;
       }
     }
@@ -310,20 +326,150 @@ static cv::Mat signalDetect_inROI(const cv::Mat& roi, const cv::Mat& src_img, co
         candidates.at(i).isBlacked = false;
       }
 
-      drawContours(bright_mask, bright_contours, candidates.at(i).idx, regionColor, CV_FILLED, 8, bright_hierarchy, 0);
+      drawContours(*bright_mask, bright_contours, candidates.at(i).idx, regionColor, CV_FILLED, 8, bright_hierarchy,
+                   0);
     }
   }
+} /* static void filterSignalRegions() */
 
-  return bright_mask;
-} /* static void signalDetect_inROI() */
+/*
+  Set of 8 bit channel values accepted by a threshold:
+  lower <= value <= upper, or the complement of it if inverted
+*/
+struct ChannelRange
+{
+  int lower;
+  int upper;
+  bool inverted;
+};
+
+struct ColorRange
+{
+  ChannelRange hue;
+  ChannelRange sat;
+  ChannelRange val;
+};
+
+static inline bool IsInChannelRange(const ChannelRange& range, const int value)
+{
+  return ((range.lower <= value) & (value <= range.upper)) != range.inverted;
+} /* static inline bool IsInChannelRange() */
+
+/*
+  A threshold on a monotonic conversion of the channel accepts one interval of values,
+  or the complement of one interval when the threshold circulates (hue)
+*/
+static ChannelRange toChannelRange(const bool accepted[256])
+{
+  ChannelRange range = { 1, 0, false };  // accepts nothing
+  int first = 0;
+  while (first < 256 && !accepted[first])
+    first++;
+  if (first == 256)
+    return range;
+
+  int last = 255;
+  while (!accepted[last])
+    last--;
+
+  range.lower = first;
+  range.upper = last;
+  for (int i = first; i <= last; i++)
+  {
+    if (!accepted[i])
+    {
+      /* complement of the rejected interval */
+      int rejected_last = last;
+      while (accepted[rejected_last])
+        rejected_last--;
+      range.lower = i;
+      range.upper = rejected_last;
+      range.inverted = true;
+      break;
+    }
+  }
+  return range;
+} /* static ChannelRange toChannelRange() */
+
+/* sigmoid contrast correction applied to V channel */
+static const uchar* getBrightnessLUT()
+{
+  struct BrightnessLUT
+  {
+    uchar data[256];
+    BrightnessLUT()
+    {
+      float correction_factor = 10.0;
+      for (int i = 0; i < 256; i++)
+      {
+        data[i] = 255.0 / (1 + exp(-correction_factor * (i - 128) / 255));
+      }
+    }
+  };
+  static const BrightnessLUT lut;
+  return lut.data;
+} /* static const uchar* getBrightnessLUT() */
+
+/* thresholds of thSet on raw HSV values, the value threshold includes the brightness correction */
+static ColorRange toColorRange(const hsvSet& threshold)
+{
+  const uchar* lut = getBrightnessLUT();
+  bool hue[256], sat[256], val[256];
+  for (int i = 0; i < 256; i++)
+  {
+    hue[i] = IsRange(threshold.Hue.lower, threshold.Hue.upper, Actual_Hue(i));
+    sat[i] = IsRange(threshold.Sat.lower, threshold.Sat.upper, Actual_Sat(i));
+    val[i] = IsRange(threshold.Val.lower, threshold.Val.upper, Actual_Val(lut[i]));
+  }
+
+  ColorRange range;
+  range.hue = toChannelRange(hue);
+  range.sat = toChannelRange(sat);
+  range.val = toChannelRange(val);
+  return range;
+} /* static ColorRange toColorRange() */
+
+/*
+  Binarize HSV image in one pass: a pixel is set if it is in range of any of red, yellow or green.
+  It is what colorExtraction does three times followed by bitwise_or.
+*/
+static void colorExtraction_fused(const cv::Mat& src, cv::Mat* dst, const ColorRange& red, const ColorRange& yellow,
+                                  const ColorRange& green)
+{
+  dst->create(src.rows, src.cols, CV_8UC1);
+  for (int y = 0; y < src.rows; y++)
+  {
+    const uchar* hsv = src.ptr<uchar>(y);
+    uchar* mask = dst->ptr<uchar>(y);
+#pragma omp simd
+    for (int x = 0; x < src.cols; x++)
+    {
+      int h = hsv[3 * x];
+      int s = hsv[3 * x + 1];
+      int v = hsv[3 * x + 2];
+      bool is_red = IsInChannelRange(red.hue, h) & IsInChannelRange(red.sat, s) & IsInChannelRange(red.val, v);
+      bool is_yellow =
+          IsInChannelRange(yellow.hue, h) & IsInChannelRange(yellow.sat, s) & IsInChannelRange(yellow.val, v);
+      bool is_green =
+          IsInChannelRange(green.hue, h) & IsInChannelRange(green.sat, s) & IsInChannelRange(green.val, v);
+      mask[x] = (is_red | is_yellow | is_green) ? 255 : 0;
+    }
+  }
+} /* static void colorExtraction_fused() */
 
 /* constructor for non initialize value */
-TrafficLightDetector::TrafficLightDetector()
+TrafficLightDetector::TrafficLightDetector() : roiOnly(false)
 {
 }
 
 void TrafficLightDetector::brightnessDetect(const cv::Mat& input)
 {
+  if (roiOnly)
+  {
+    brightnessDetect_inROIs(input);
+    return;
+  }
+
   cv::Mat tmpImage;
   input.copyTo(tmpImage);
 
@@ -333,14 +479,7 @@ void TrafficLightDetector::brightnessDetect(const cv::Mat& input)
   std::vector<cv::Mat> hsv_channel;
   split(tmp, hsv_channel);
 
-  float correction_factor = 10.0;
-  uchar lut[256];
-  for (int i = 0; i < 256; i++)
-  {
-    lut[i] = 255.0 / (1 + exp(-correction_factor * (i - 128) / 255));
-  }
-
-  LUT(hsv_channel[2], cv::Mat(cv::Size(256, 1), CV_8U, lut), hsv_channel[2]);
+  LUT(hsv_channel[2], cv::Mat(cv::Size(256, 1), CV_8U, const_cast<uchar*>(getBrightnessLUT())), hsv_channel[2]);
   merge(hsv_channel, tmp);
   cvtColor(tmp, tmpImage, CV_HSV2BGR);
 
@@ -438,6 +577,84 @@ void TrafficLightDetector::brightnessDetect(const cv::Mat& input)
   }
 }
 
+/*
+  Same recognition as brightnessDetect, but only the projected regions are converted and corrected.
+  Brightness correction is folded into the value thresholds, so each region needs one color conversion,
+  one blur and one thresholding pass. Regions are processed in parallel with buffers kept between frames.
+*/
+void TrafficLightDetector::brightnessDetect_inROIs(const cv::Mat& input)
+{
+  const uchar* lut = getBrightnessLUT();
+  const ColorRange red = toColorRange(thSet.Red);
+  const ColorRange yellow = toColorRange(thSet.Yellow);
+  const ColorRange green = toColorRange(thSet.Green);
+
+  if (roiBuffers.size() < contexts.size())
+  {
+    roiBuffers.resize(contexts.size());
+  }
+
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < static_cast<int>(contexts.size()); i++)
+  {
+    Context& context = contexts.at(i);
+    ROIBuffer& buffer = roiBuffers.at(i);
+
+    if (context.topLeft.x > context.botRight.x)
+      continue;
+
+    /* extract region of interest from input image and convert color space (BGR -> HSV) */
+    cv::Mat roi = input(cv::Rect(context.topLeft, context.botRight));
+    cvtColor(roi, buffer.hsv, CV_BGR2HSV);
+
+    /* reduce noise and extract color information */
+    GaussianBlur(buffer.hsv, buffer.blurred, cv::Size(3, 3), 0, 0);
+    colorExtraction_fused(buffer.blurred, &buffer.binarized, red, yellow, green);
+
+    /* the mask is already binary, so Otsu thresholding of signalDetect_inROI would not change it */
+    filterSignalRegions(&buffer.binarized, &buffer.signalMask, input, context.lampRadius, context.topLeft,
+                        context.leftTurnSignal || context.rightTurnSignal);
+
+    /* detect which color is dominant */
+    int red_pixNum = 0;
+    int yellow_pixNum = 0;
+    int green_pixNum = 0;
+    int valid_pixNum = 0;
+    for (int y = 0; y < buffer.hsv.rows; y++)
+    {
+      const uchar* hsv = buffer.hsv.ptr<uchar>(y);
+      const uchar* mask = buffer.signalMask.ptr<uchar>(y);
+      for (int x = 0; x < buffer.hsv.cols; x++)
+      {
+        if (mask[x] == 0 || lut[hsv[3 * x + 2]] == 0)
+        {
+          continue;  // this is masked pixel
+        }
+        valid_pixNum++;
+
+        /* search which color is actually bright */
+        int hue = hsv[3 * x];
+        red_pixNum += IsInChannelRange(red.hue, hue);
+        yellow_pixNum += IsInChannelRange(yellow.hue, hue);
+        green_pixNum += IsInChannelRange(green.hue, hue);
+      }
+    }
+
+    bool isRed_bright = false;
+    bool isYellow_bright = false;
+    bool isGreen_bright = false;
+    if (valid_pixNum > 0)
+    {
+      isRed_bright = (static_cast<double>(red_pixNum) / valid_pixNum) > 0.5;
+      isYellow_bright = (static_cast<double>(yellow_pixNum) / valid_pixNum) > 0.5;
+      isGreen_bright = (static_cast<double>(green_pixNum) / valid_pixNum) > 0.5;
+    }
+
+    int currentLightsCode = getCurrentLightsCode(isRed_bright, isYellow_bright, isGreen_bright);
+    context.lightState = determineState(context.lightState, currentLightsCode, &(context.stateJudgeCount));
+  }
+}
+
 double getBrightnessRatioInCircle(const cv::Mat& input, const cv::Point center, const int radius)
 {
   int whitePoints = 0;
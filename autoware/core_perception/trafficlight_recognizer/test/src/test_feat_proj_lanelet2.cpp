@@ -161,14 +161,41 @@ TEST_F(FeatProjLanelet2TestSuite, test_inView)
 
 TEST_F(FeatProjLanelet2TestSuite, test_trafficLightVisibilityCheck)
 {
-  std::vector<lanelet::TrafficLight::Ptr> tl;
-  std::vector<lanelet::autoware::AutowareTrafficLight::Ptr> atl;
-  std::vector<lanelet::TrafficLight::Ptr> vis_tl;
-  std::vector<lanelet::autoware::AutowareTrafficLight::Ptr> vis_at;
+  // traffic light whose base linestring goes from (x, y0) to (x, y1)
+  auto make_tl = [](lanelet::Id id, double x, double y0, double y1) {
+    lanelet::LineString3d ls(lanelet::utils::getId(), { lanelet::Point3d(lanelet::utils::getId(), x, y0, 5),
+                                                         lanelet::Point3d(lanelet::utils::getId(), x, y1, 5) });
+    lanelet::AutowareTrafficLightConstPtr tl =
+        lanelet::autoware::AutowareTrafficLight::make(id, lanelet::AttributeMap(), { ls });
+    return tl;
+  };
+
+  std::vector<lanelet::AutowareTrafficLightConstPtr> aw_tl_reg_elems;
+  aw_tl_reg_elems.push_back(make_tl(1, 50, 1, -1));    // in front, facing
+  aw_tl_reg_elems.push_back(make_tl(2, 50, -1, 1));    // in front, facing away
+  aw_tl_reg_elems.push_back(make_tl(3, 300, 1, -1));   // out of range
+  aw_tl_reg_elems.push_back(make_tl(4, -80, 1, -1));   // behind the camera
+  aw_tl_reg_elems.push_back(make_tl(5, 120, 31, 29));  // in front left, facing
+  test_obj.buildTrafficLightIndex(aw_tl_reg_elems);
+
+  // camera at origin looking along +x
+  tf::StampedTransform stf;
+  tf::Transform tf = tf::Transform::getIdentity();
+  tf.setRotation(tf::createQuaternionFromRPY(0, 0, -M_PI / 2));
+  stf.setData(tf);
+  test_obj.setCameraPose(Eigen::Vector3f(0, 0, 0), stf);
 
-  // construct tl objects for test
+  std::vector<lanelet::AutowareTrafficLightConstPtr> visible_aw_tl;
+  test_obj.trafficLightVisibilityCheck(&visible_aw_tl);
 
-  EXPECT_EQ(true, true) << "dummy test";
+  std::vector<lanelet::Id> visible_ids;
+  for (const auto& tl : visible_aw_tl)
+  {
+    visible_ids.push_back(tl->id());
+  }
+  std::sort(visible_ids.begin(), visible_ids.end());
+  EXPECT_EQ(std::vector<lanelet::Id>({ 1, 5 }), visible_ids) << "only traffic lights in range and facing the camera "
+                                                               "should be visible";
 }
 
 }  // namespace trafficlight_recognizer
@@ -74,6 +74,22 @@ public:
   {
     return fpll2->inView(p, cam, heading, max_a, max_r);
   }
+
+  void setCameraPose(const Eigen::Vector3f& position, tf::StampedTransform map_to_camera_tf)
+  {
+    fpll2->position_ = position;
+    fpll2->map_to_camera_tf_ = map_to_camera_tf;
+  }
+
+  void buildTrafficLightIndex(const std::vector<lanelet::AutowareTrafficLightConstPtr>& aw_tl_reg_elems)
+  {
+    fpll2->buildTrafficLightIndex(aw_tl_reg_elems);
+  }
+
+  void trafficLightVisibilityCheck(std::vector<lanelet::AutowareTrafficLightConstPtr>* visible_aw_tl)
+  {
+    fpll2->trafficLightVisibilityCheck(visible_aw_tl);
+  }
 };
 
 }  // namespace trafficlight_recognizer
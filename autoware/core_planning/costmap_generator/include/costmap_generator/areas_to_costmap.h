@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ********************/
+
+#ifndef AREAS_TO_COSTMAP_H
+#define AREAS_TO_COSTMAP_H
+
+#include <string>
+#include <vector>
+
+// headers in ROS
+#include <ros/ros.h>
+#include <tf/transform_datatypes.h>
+#include <geometry_msgs/Point.h>
+#include <grid_map_ros/grid_map_ros.hpp>
+
+class AreasToCostmap
+{
+public:
+  AreasToCostmap();
+  ~AreasToCostmap();
+
+  /// \brief set areas such as wayarea, replacing previous ones
+  /// \param[in] area_points: polygons of areas in map frame
+  void setAreas(const std::vector<std::vector<geometry_msgs::Point>>& area_points);
+
+  /// \brief check if any area is set
+  bool hasAreas() const;
+
+  /// \brief calculate cost from areas in place. Areas are rasterized in map frame into a window around costmap,
+  ///        which is moved as a circular buffer so that only newly covered cells are rasterized
+  /// \param[in] costmap_to_map: transform from costmap frame to map frame
+  /// \param[in] gridmap_layer_name: target gridmap layer name for calculated cost
+  /// \param[in] inside_value: cost inside areas
+  /// \param[in] outside_value: cost outside areas
+  /// \param[out] costmap: gridmap whose gridmap_layer_name layer is updated with calculated cost
+  void makeCostmapFromAreas(const tf::Transform& costmap_to_map, const std::string& gridmap_layer_name,
+                            const double inside_value, const double outside_value, grid_map::GridMap& costmap);
+
+private:
+  friend class TestClass;
+
+  struct Area
+  {
+    std::vector<grid_map::Position> vertices;
+    grid_map::Position lower;
+    grid_map::Position upper;
+  };
+
+  const std::string AREAS_LAYER_;
+
+  std::vector<Area> areas_;
+
+  // rasterized areas in map frame, 1 inside and 0 outside
+  grid_map::GridMap areas_window_;
+  bool is_window_initialized_;
+
+  /// \brief move window to center, or initialize it if it does not cover costmap, and rasterize new cells
+  /// \param[in] center: center of costmap in map frame
+  /// \param[in] costmap: costmap to be covered
+  void moveWindow(const grid_map::Position& center, const grid_map::GridMap& costmap);
+
+  /// \brief rasterize areas into a region of window
+  /// \param[in] region: region in buffer index of window
+  void rasterizeRegion(const grid_map::BufferRegion& region);
+};
+
+#endif  // AREAS_TO_COSTMAP_H
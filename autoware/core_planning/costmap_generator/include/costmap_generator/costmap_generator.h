@@ -44,6 +44,7 @@
 #include "vector_map/vector_map.h"
 #include "autoware_msgs/DetectedObjectArray.h"
 #include "points_to_costmap.h"
+#include "areas_to_costmap.h"
 #include "objects_to_costmap.h"
 
 // headers in STL
@@ -101,6 +102,7 @@ private:
 
   PointsToCostmap points2costmap_;
   ObjectsToCostmap objects2costmap_;
+  AreasToCostmap areas2costmap_;
 
   const std::string OBJECTS_BOX_COSTMAP_LAYER_;
   const std::string OBJECTS_CONVEX_HULL_COSTMAP_LAYER_;
@@ -129,16 +131,18 @@ private:
   /// \param[in] in_sensor_points: subscribed pointcloud data
   grid_map::Matrix generateSensorPointsCostmap(const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points);
 
-  /// \brief calculate cost from DetectedObjectArray
+  /// \brief calculate cost from DetectedObjectArray into a layer of costmap_
   /// \param[in] in_objects: subscribed DetectedObjectArray
-  grid_map::Matrix generateObjectsCostmap(const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
-                                          const bool use_objects_convex_hull);
+  /// \param[in] use_objects_convex_hull: use convex hull instead of box for object's shape
+  /// \param[in] gridmap_layer_name: target layer name
+  void generateObjectsCostmap(const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
+                              const bool use_objects_convex_hull, const std::string& gridmap_layer_name);
 
-  /// \brief calculate cost from vectormap
-  grid_map::Matrix generateVectormapCostmap();
+  /// \brief calculate cost from vectormap into its layer of costmap_, if wayarea is available
+  void generateVectormapCostmap();
 
-  /// \brief calculate cost for final output
-  grid_map::Matrix generateCombinedCostmap();
+  /// \brief calculate cost for final output into its layer of costmap_
+  void generateCombinedCostmap();
 };
 
 #endif  // COSTMAP_GENERATOR_H
@@ -44,6 +44,7 @@
 // headers in Autoware
 #include <autoware_lanelet2_msgs/MapBin.h>
 #include <autoware_msgs/DetectedObjectArray.h>
+#include <costmap_generator/areas_to_costmap.h>
 #include <costmap_generator/objects_to_costmap.h>
 #include <costmap_generator/points_to_costmap.h>
 #include <lanelet2_extension/utility/message_conversion.h>
@@ -106,6 +107,7 @@ private:
 
   PointsToCostmap points2costmap_;
   ObjectsToCostmap objects2costmap_;
+  AreasToCostmap areas2costmap_;
 
   const std::string OBJECTS_BOX_COSTMAP_LAYER_;
   const std::string OBJECTS_CONVEX_HULL_COSTMAP_LAYER_;
@@ -147,16 +149,18 @@ private:
   /// \param[in] in_sensor_points: subscribed pointcloud data
   grid_map::Matrix generateSensorPointsCostmap(const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points);
 
-  /// \brief calculate cost from DetectedObjectArray
+  /// \brief calculate cost from DetectedObjectArray into a layer of costmap_
   /// \param[in] in_objects: subscribed DetectedObjectArray
-  grid_map::Matrix generateObjectsCostmap(const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
-                                          const bool use_objects_convex_hull);
+  /// \param[in] use_objects_convex_hull: use convex hull instead of box for object's shape
+  /// \param[in] gridmap_layer_name: target layer name
+  void generateObjectsCostmap(const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
+                              const bool use_objects_convex_hull, const std::string& gridmap_layer_name);
 
-  /// \brief calculate cost from lanelet2 map
-  grid_map::Matrix generateLanelet2Costmap();
+  /// \brief calculate cost from lanelet2 map into its layer of costmap_, if wayarea is available
+  void generateLanelet2Costmap();
 
-  /// \brief calculate cost for final output
-  grid_map::Matrix generateCombinedCostmap();
+  /// \brief calculate cost for final output into its layer of costmap_
+  void generateCombinedCostmap();
 };
 
 #endif  // COSTMAP_GENERATOR_H
@@ -31,6 +31,10 @@
 #ifndef OBJECTS_TO_COSTMAP_H
 #define OBJECTS_TO_COSTMAP_H
 
+// headers in STL
+#include <map>
+#include <string>
+
 // headers in ROS
 #include <ros/ros.h>
 #include <grid_map_ros/grid_map_ros.hpp>
@@ -44,24 +48,41 @@ public:
   ObjectsToCostmap();
   ~ObjectsToCostmap();
 
-  /// \brief calculate cost from DetectedObjectArray
-  /// \param[in] costmap: initialized gridmap
+  /// \brief calculate cost from DetectedObjectArray in place. Only the cells around the objects of this and
+  ///        the previous call for the same layer are written, the rest of the layer is kept at zero
+  /// \param[in] gridmap_layer_name: target gridmap layer name for calculated cost
   /// \param[in] expand_polygon_size: expand object's costmap polygon
   /// \param[in] size_of_expansion_kernel: kernel size for blurring cost
   /// \param[in] in_objects: subscribed DetectedObjectArray
-  /// \param[out] calculated cost in grid_map::Matrix format
-  grid_map::Matrix makeCostmapFromObjects(const grid_map::GridMap& costmap,
-                                          const double expand_polygon_size, const double size_of_expansion_kernel,
-                                          const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
-                                          const bool use_objects_convex_hull);
+  /// \param[in] use_objects_convex_hull: use convex hull instead of box for object's shape
+  /// \param[out] costmap: gridmap whose gridmap_layer_name layer is updated with calculated cost
+  void makeCostmapFromObjects(const std::string& gridmap_layer_name, const double expand_polygon_size,
+                              const double size_of_expansion_kernel,
+                              const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
+                              const bool use_objects_convex_hull, grid_map::GridMap& costmap);
 
 private:
   friend class TestClass;
 
+  /// \brief inclusive range of cells in a layer, empty if min is larger than max
+  struct CellRange
+  {
+    grid_map::Index min;
+    grid_map::Index max;
+    bool empty() const
+    {
+      return (min > max).any();
+    }
+  };
+
   const int NUMBER_OF_POINTS;
   const int NUMBER_OF_DIMENSIONS;
-  const std::string OBJECTS_COSTMAP_LAYER_;
-  const std::string BLURRED_OBJECTS_COSTMAP_LAYER_;
+
+  // cells written by the previous call, per layer
+  std::map<std::string, CellRange> dirty_ranges_;
+  // buffers for the blur, reused between calls
+  Eigen::ArrayXXd prefix_sums_;
+  Eigen::ArrayXXd window_sums_;
 
   /// \brief make 4 rectangle points from centroid position and orientation
   /// \param[in] in_object: subscribed one of DetectedObjectArray
@@ -100,6 +121,20 @@ private:
   /// \param[in] objects_costmap: update cost in this objects_costmap[gridmap_layer_name]
   void setCostInPolygon(const grid_map::Polygon& polygon, const std::string& gridmap_layer_name, const float score,
                         grid_map::GridMap& objects_costmap);
+
+  /// \brief calculate cells which may be covered by polygon
+  /// \param[in] polygon: polygon in costmap frame
+  /// \param[in] costmap: gridmap with default start index
+  /// \param[out] bounding cells of polygon, clipped to costmap
+  CellRange makeCellRangeFromPolygon(const grid_map::Polygon& polygon, const grid_map::GridMap& costmap) const;
+
+  /// \brief blur cost by mean filter, cropped at the edges of costmap, and keep the larger of original and blurred
+  ///        cost. Cost outside of drawn_range must be zero
+  /// \param[in] drawn_range: cells which may have non zero cost
+  /// \param[in] kernel_margin: half of kernel size, excluding the center cell
+  /// \param[in] costmap: layer to be blurred in place
+  /// \param[out] cells which may have been changed
+  CellRange blurCost(const CellRange& drawn_range, const int kernel_margin, grid_map::Matrix& costmap);
 };
 
 #endif  // OBJECTS_TO_COSTMAP_H
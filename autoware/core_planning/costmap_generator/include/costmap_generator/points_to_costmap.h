@@ -31,6 +31,10 @@
 #ifndef POINTS_TO_COSTMAP_H
 #define POINTS_TO_COSTMAP_H
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 // headers in ROS
 #include <ros/ros.h>
 #include <grid_map_ros/grid_map_ros.hpp>
@@ -66,8 +70,6 @@ private:
   double grid_resolution_;
   double grid_position_x_;
   double grid_position_y_;
-  double y_cell_size_;
-  double x_cell_size_;
 
   /// \brief initialize gridmap parameters
   /// \param[in] gridmap: gridmap object to be initialized
@@ -83,27 +85,33 @@ private:
   /// \param[out] index in gridmap
   grid_map::Index fetchGridIndexFromPoint(const pcl::PointXYZ& point);
 
-  /// \brief Assign pointcloud to appropriate cell in gridmap
-  /// \param[in] gridmap: costmap based on gridmap
-  /// \param[in] in_sensor_points: subscribed pointcloud
-  /// \param[out] grid-x-length x grid-y-length size grid stuffed with point's height in corresponding grid cell
-  std::vector<std::vector<std::vector<double>>>
-  assignPoints2GridCell(const grid_map::GridMap& gridmap, const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points);
-
-  /// \brief calculate costmap from subscribed pointcloud
+  /// \brief Classify every point against the height band and mark the cell it falls into
   /// \param[in] maximum_height_thres: Maximum height threshold for pointcloud data
   /// \param[in] minimum_height_thres: Minimum height threshold for pointcloud data
+  /// \param[in] in_sensor_points: subscribed pointcloud
+  /// \param[in] x_cell_size: number of cells along x of the costmap
+  /// \param[in] y_cell_size: number of cells along y of the costmap
+  void rasterizePoints(const double maximum_height_thres, const double minimum_height_thres,
+                       const pcl::PointCloud<pcl::PointXYZ>& in_sensor_points, const int x_cell_size,
+                       const int y_cell_size);
+
+  /// \brief Write the cost of the cells marked by rasterizePoints. Cells without points get grid_min_value, cells
+  /// with a point in the height band grid_max_value, and cells with points outside the band keep their value
   /// \param[in] grid_min_value: Minimum cost for costmap
   /// \param[in] grid_max_value: Maximum cost fot costmap
-  /// \param[in] gridmap: costmap based on gridmap
-  /// \param[in] gridmap_layer_name: gridmap layer name for gridmap
-  /// \param[in] grid_vec: grid-x-length x grid-y-length size grid stuffed with point's height in corresponding grid
-  /// cell
-  /// \param[out] caculated costmap in grid_map::Matrix format
-  grid_map::Matrix calculateCostmap(const double maximum_height_thres, const double minimum_lidar_height_thres,
-                                    const double grid_min_value, const double grid_max_value,
-                                    const grid_map::GridMap& gridmap, const std::string& gridmap_layer_name,
-                                    const std::vector<std::vector<std::vector<double>>> grid_vec);
+  /// \param[in,out] costmap: costmap layer, x_cell_size x y_cell_size
+  void fillCostmap(const double grid_min_value, const double grid_max_value, grid_map::Matrix& costmap) const;
+
+  enum CellState : uint8_t
+  {
+    CELL_EMPTY = 0,
+    CELL_OCCUPIED = 1,
+    CELL_IN_HEIGHT_BAND = 2,
+  };
+
+  // reused between frames, so rasterizing does not allocate once the costmap size is fixed
+  std::vector<int32_t> point_cells_;
+  std::vector<uint8_t> cell_states_;
 };
 
 #endif  // POINTS_TO_COSTMAP_H
@@ -0,0 +1,218 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ********************/
+
+// headers in standard library
+#include <algorithm>
+#include <cmath>
+
+// headers in local directory
+#include "costmap_generator/areas_to_costmap.h"
+
+// Constructor
+AreasToCostmap::AreasToCostmap() : AREAS_LAYER_("areas"), areas_window_({ AREAS_LAYER_ }), is_window_initialized_(false)
+{
+}
+
+AreasToCostmap::~AreasToCostmap()
+{
+}
+
+void AreasToCostmap::setAreas(const std::vector<std::vector<geometry_msgs::Point>>& area_points)
+{
+  areas_.clear();
+  for (const auto& points : area_points)
+  {
+    if (points.size() < 3)
+    {
+      continue;
+    }
+    Area area;
+    area.vertices.reserve(points.size());
+    for (const auto& point : points)
+    {
+      area.vertices.emplace_back(point.x, point.y);
+    }
+    area.lower = area.vertices.front();
+    area.upper = area.vertices.front();
+    for (const auto& vertex : area.vertices)
+    {
+      area.lower = area.lower.cwiseMin(vertex);
+      area.upper = area.upper.cwiseMax(vertex);
+    }
+    areas_.push_back(area);
+  }
+  is_window_initialized_ = false;
+}
+
+bool AreasToCostmap::hasAreas() const
+{
+  return !areas_.empty();
+}
+
+void AreasToCostmap::rasterizeRegion(const grid_map::BufferRegion& region)
+{
+  const grid_map::Index start = region.getStartIndex();
+  const grid_map::Size size = region.getSize();
+  if ((size <= 0).any())
+  {
+    return;
+  }
+
+  // x of a cell only depends on its row and y only on its column, even if the window has been moved
+  std::vector<double> cell_x(size.x());
+  std::vector<double> cell_y(size.y());
+  grid_map::Position position;
+  for (int i = 0; i < size.x(); i++)
+  {
+    areas_window_.getPosition(grid_map::Index(start.x() + i, start.y()), position);
+    cell_x[i] = position.x();
+  }
+  for (int j = 0; j < size.y(); j++)
+  {
+    areas_window_.getPosition(grid_map::Index(start.x(), start.y() + j), position);
+    cell_y[j] = position.y();
+  }
+  const auto x_range = std::minmax_element(cell_x.begin(), cell_x.end());
+  const auto y_range = std::minmax_element(cell_y.begin(), cell_y.end());
+
+  std::vector<const Area*> candidates;
+  for (const auto& area : areas_)
+  {
+    if (area.upper.x() >= *x_range.first && area.lower.x() <= *x_range.second && area.upper.y() >= *y_range.first &&
+        area.lower.y() <= *y_range.second)
+    {
+      candidates.push_back(&area);
+    }
+  }
+
+  grid_map::Matrix& window = areas_window_[AREAS_LAYER_];
+  window.block(start.x(), start.y(), size.x(), size.y()).setZero();
+  std::vector<double> crossings;
+  for (int i = 0; i < size.x(); i++)
+  {
+    const double x = cell_x[i];
+    for (const Area* area : candidates)
+    {
+      if (x < area->lower.x() || x > area->upper.x())
+      {
+        continue;
+      }
+      // y where the edges cross the line through the cell centers, cells between each pair of crossings are inside
+      crossings.clear();
+      const std::vector<grid_map::Position>& vertices = area->vertices;
+      for (size_t k = 0, prev = vertices.size() - 1; k < vertices.size(); prev = k++)
+      {
+        const grid_map::Position& p = vertices[prev];
+        const grid_map::Position& q = vertices[k];
+        if ((p.x() <= x) != (q.x() <= x))
+        {
+          crossings.push_back(p.y() + (x - p.x()) * (q.y() - p.y()) / (q.x() - p.x()));
+        }
+      }
+      std::sort(crossings.begin(), crossings.end());
+      for (size_t k = 0; k + 1 < crossings.size(); k += 2)
+      {
+        for (int j = 0; j < size.y(); j++)
+        {
+          if (cell_y[j] >= crossings[k] && cell_y[j] <= crossings[k + 1])
+          {
+            window(start.x() + i, start.y() + j) = 1.0;
+          }
+        }
+      }
+    }
+  }
+}
+
+void AreasToCostmap::moveWindow(const grid_map::Position& center, const grid_map::GridMap& costmap)
+{
+  // the window covers costmap in any orientation around its center
+  const double resolution = costmap.getResolution();
+  const double window_length = costmap.getLength().matrix().norm() + 4 * resolution;
+  if (!is_window_initialized_ || areas_window_.getResolution() != resolution ||
+      std::abs(areas_window_.getLength().x() - window_length) > resolution)
+  {
+    areas_window_.setGeometry(grid_map::Length(window_length, window_length), resolution, center);
+    is_window_initialized_ = true;
+    rasterizeRegion(grid_map::BufferRegion(grid_map::Index(0, 0), areas_window_.getSize(),
+                                           grid_map::BufferRegion::Quadrant::Undefined));
+    return;
+  }
+
+  std::vector<grid_map::BufferRegion> new_regions;
+  areas_window_.move(center, new_regions);
+  for (const auto& region : new_regions)
+  {
+    rasterizeRegion(region);
+  }
+}
+
+void AreasToCostmap::makeCostmapFromAreas(const tf::Transform& costmap_to_map, const std::string& gridmap_layer_name,
+                                          const double inside_value, const double outside_value,
+                                          grid_map::GridMap& costmap)
+{
+  grid_map::Matrix& areas_costmap = costmap[gridmap_layer_name];
+  const grid_map::Position costmap_position = costmap.getPosition();
+  const tf::Vector3 center = costmap_to_map * tf::Vector3(costmap_position.x(), costmap_position.y(), 0.0);
+  moveWindow(grid_map::Position(center.x(), center.y()), costmap);
+
+  // cells are transformed on the plane z = 0 of costmap frame, so the position in map frame is
+  // the sum of a term from the row and a term from the column
+  const tf::Matrix3x3& rotation = costmap_to_map.getBasis();
+  const grid_map::Size size = costmap.getSize();
+  std::vector<grid_map::Position> row_terms(size.x());
+  std::vector<grid_map::Position> col_terms(size.y());
+  grid_map::Position position;
+  for (int i = 0; i < size.x(); i++)
+  {
+    costmap.getPosition(grid_map::Index(i, 0), position);
+    row_terms[i] = grid_map::Position(rotation[0][0] * position.x() + costmap_to_map.getOrigin().x(),
+                                      rotation[1][0] * position.x() + costmap_to_map.getOrigin().y());
+  }
+  for (int j = 0; j < size.y(); j++)
+  {
+    costmap.getPosition(grid_map::Index(0, j), position);
+    col_terms[j] = grid_map::Position(rotation[0][1] * position.y(), rotation[1][1] * position.y());
+  }
+
+  const grid_map::Matrix& window = areas_window_[AREAS_LAYER_];
+  const float inside_cost = inside_value;
+  const float outside_cost = outside_value;
+  grid_map::Index window_index;
+  for (int j = 0; j < size.y(); j++)
+  {
+    for (int i = 0; i < size.x(); i++)
+    {
+      const bool is_inside = areas_window_.getIndex(row_terms[i] + col_terms[j], window_index) &&
+                             window(window_index.x(), window_index.y()) > 0.5;
+      areas_costmap(i, j) = is_inside ? inside_cost : outside_cost;
+    }
+  }
+}
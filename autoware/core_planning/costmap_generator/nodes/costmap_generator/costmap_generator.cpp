@@ -92,15 +92,15 @@ void CostmapGenerator::objectsCallback(const autoware_msgs::DetectedObjectArray:
   if(use_objects_box_)
   {
     const bool use_convex_hull = !use_objects_box_;
-    costmap_[OBJECTS_BOX_COSTMAP_LAYER_] = generateObjectsCostmap(in_objects, use_convex_hull);
+    generateObjectsCostmap(in_objects, use_convex_hull, OBJECTS_BOX_COSTMAP_LAYER_);
   }
 
   if(use_objects_convex_hull_)
   {
-    costmap_[OBJECTS_CONVEX_HULL_COSTMAP_LAYER_] = generateObjectsCostmap(in_objects, use_objects_convex_hull_);
+    generateObjectsCostmap(in_objects, use_objects_convex_hull_, OBJECTS_CONVEX_HULL_COSTMAP_LAYER_);
   }
-  costmap_[VECTORMAP_COSTMAP_LAYER_] = generateVectormapCostmap();
-  costmap_[COMBINED_COSTMAP_LAYER_] = generateCombinedCostmap();
+  generateVectormapCostmap();
+  generateCombinedCostmap();
 
   std_msgs::Header in_header = in_objects->header;
   publishRosMsg(costmap_, in_header);
@@ -111,8 +111,8 @@ void CostmapGenerator::sensorPointsCallback(const sensor_msgs::PointCloud2::Cons
   pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points(new pcl::PointCloud<pcl::PointXYZ>);
   pcl::fromROSMsg(*in_sensor_points_msg, *in_sensor_points);
   costmap_[SENSOR_POINTS_COSTMAP_LAYER_] = generateSensorPointsCostmap(in_sensor_points);
-  costmap_[VECTORMAP_COSTMAP_LAYER_] = generateVectormapCostmap();
-  costmap_[COMBINED_COSTMAP_LAYER_] = generateCombinedCostmap();
+  generateVectormapCostmap();
+  generateCombinedCostmap();
 
   std_msgs::Header in_header = in_sensor_points_msg->header;
   publishRosMsg(costmap_, in_header);
@@ -140,50 +140,53 @@ CostmapGenerator::generateSensorPointsCostmap(const pcl::PointCloud<pcl::PointXY
   return sensor_points_costmap;
 }
 
-grid_map::Matrix
-CostmapGenerator::generateObjectsCostmap(const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
-                                         const bool use_convex_hull)
+void CostmapGenerator::generateObjectsCostmap(const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
+                                              const bool use_convex_hull, const std::string& gridmap_layer_name)
 {
-  grid_map::Matrix objects_costmap = objects2costmap_.makeCostmapFromObjects(
-    costmap_, expand_polygon_size_, size_of_expansion_kernel_, in_objects, use_convex_hull);
-  return objects_costmap;
+  objects2costmap_.makeCostmapFromObjects(gridmap_layer_name, expand_polygon_size_, size_of_expansion_kernel_,
+                                          in_objects, use_convex_hull, costmap_);
 }
 
 // Only this funstion depends on object_map_utils
-grid_map::Matrix CostmapGenerator::generateVectormapCostmap()
+void CostmapGenerator::generateVectormapCostmap()
 {
-  grid_map::GridMap vectormap_costmap = costmap_;
-  if (use_wayarea_)
+  if (!use_wayarea_)
   {
-    if (!has_subscribed_wayarea_)
-    {
-      object_map::LoadRoadAreasFromVectorMap(private_nh_, area_points_);
-    }
-    if (!area_points_.empty())
+    return;
+  }
+  if (!has_subscribed_wayarea_)
+  {
+    object_map::LoadRoadAreasFromVectorMap(private_nh_, area_points_);
+    if (area_points_.empty())
     {
-      has_subscribed_wayarea_ = true;
-      object_map::FillPolygonAreas(vectormap_costmap, area_points_, VECTORMAP_COSTMAP_LAYER_, grid_max_value_,
-                                   grid_min_value_, grid_min_value_, grid_max_value_, lidar_frame_, map_frame_,
-                                   tf_listener_);
+      return;
     }
+    has_subscribed_wayarea_ = true;
+    areas2costmap_.setAreas(area_points_);
+  }
+
+  tf::StampedTransform costmap_to_map;
+  try
+  {
+    tf_listener_.lookupTransform(map_frame_, lidar_frame_, ros::Time(0), costmap_to_map);
+  }
+  catch (tf::TransformException& ex)
+  {
+    ROS_ERROR("%s", ex.what());
+    return;
   }
-  return vectormap_costmap[VECTORMAP_COSTMAP_LAYER_];
+  areas2costmap_.makeCostmapFromAreas(costmap_to_map, VECTORMAP_COSTMAP_LAYER_, grid_min_value_, grid_max_value_,
+                                      costmap_);
 }
 
-grid_map::Matrix CostmapGenerator::generateCombinedCostmap()
+void CostmapGenerator::generateCombinedCostmap()
 {
   // assuming combined_costmap is calculated by element wise max operation
-  grid_map::GridMap combined_costmap = costmap_;
-  combined_costmap[COMBINED_COSTMAP_LAYER_].setConstant(grid_min_value_);
-  combined_costmap[COMBINED_COSTMAP_LAYER_] =
-      combined_costmap[COMBINED_COSTMAP_LAYER_].cwiseMax(combined_costmap[SENSOR_POINTS_COSTMAP_LAYER_]);
-  combined_costmap[COMBINED_COSTMAP_LAYER_] =
-      combined_costmap[COMBINED_COSTMAP_LAYER_].cwiseMax(combined_costmap[VECTORMAP_COSTMAP_LAYER_]);
-  combined_costmap[COMBINED_COSTMAP_LAYER_] =
-      combined_costmap[COMBINED_COSTMAP_LAYER_].cwiseMax(combined_costmap[OBJECTS_BOX_COSTMAP_LAYER_]);
-  combined_costmap[COMBINED_COSTMAP_LAYER_] =
-      combined_costmap[COMBINED_COSTMAP_LAYER_].cwiseMax(combined_costmap[OBJECTS_CONVEX_HULL_COSTMAP_LAYER_]);
-  return combined_costmap[COMBINED_COSTMAP_LAYER_];
+  costmap_[COMBINED_COSTMAP_LAYER_] = costmap_[SENSOR_POINTS_COSTMAP_LAYER_]
+                                          .cwiseMax(costmap_[VECTORMAP_COSTMAP_LAYER_])
+                                          .cwiseMax(costmap_[OBJECTS_BOX_COSTMAP_LAYER_])
+                                          .cwiseMax(costmap_[OBJECTS_CONVEX_HULL_COSTMAP_LAYER_])
+                                          .cwiseMax(static_cast<float>(grid_min_value_));
 }
 
 void CostmapGenerator::publishRosMsg(const grid_map::GridMap& costmap, const std_msgs::Header& in_header)
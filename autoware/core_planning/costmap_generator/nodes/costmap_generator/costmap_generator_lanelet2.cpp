@@ -118,7 +118,9 @@ void CostmapGeneratorLanelet2::laneletBinMapCallback(const autoware_lanelet2_msg
   lanelet_map_ = std::make_shared<lanelet::LaneletMap>();
   lanelet::utils::conversion::fromBinMsg(msg, lanelet_map_);
   loaded_lanelet_map_ = true;
+  area_points_.clear();
   loadRoadAreasFromLaneletMap(lanelet_map_, &area_points_);
+  areas2costmap_.setAreas(area_points_);
 }
 
 void CostmapGeneratorLanelet2::objectsCallback(const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects)
@@ -131,15 +133,15 @@ void CostmapGeneratorLanelet2::objectsCallback(const autoware_msgs::DetectedObje
   if (use_objects_box_)
   {
     const bool use_convex_hull = false;
-    costmap_[OBJECTS_BOX_COSTMAP_LAYER_] = generateObjectsCostmap(in_objects, use_convex_hull);
+    generateObjectsCostmap(in_objects, use_convex_hull, OBJECTS_BOX_COSTMAP_LAYER_);
   }
 
   if (use_objects_convex_hull_)
   {
-    costmap_[OBJECTS_CONVEX_HULL_COSTMAP_LAYER_] = generateObjectsCostmap(in_objects, use_objects_convex_hull_);
+    generateObjectsCostmap(in_objects, use_objects_convex_hull_, OBJECTS_CONVEX_HULL_COSTMAP_LAYER_);
   }
-  costmap_[LANELET2_COSTMAP_LAYER_] = generateLanelet2Costmap();
-  costmap_[COMBINED_COSTMAP_LAYER_] = generateCombinedCostmap();
+  generateLanelet2Costmap();
+  generateCombinedCostmap();
 
   std_msgs::Header in_header = in_objects->header;
   publishRosMsg(costmap_, in_header);
@@ -155,8 +157,8 @@ void CostmapGeneratorLanelet2::sensorPointsCallback(const sensor_msgs::PointClou
   pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points(new pcl::PointCloud<pcl::PointXYZ>);
   pcl::fromROSMsg(*in_sensor_points_msg, *in_sensor_points);
   costmap_[SENSOR_POINTS_COSTMAP_LAYER_] = generateSensorPointsCostmap(in_sensor_points);
-  costmap_[LANELET2_COSTMAP_LAYER_] = generateLanelet2Costmap();
-  costmap_[COMBINED_COSTMAP_LAYER_] = generateCombinedCostmap();
+  generateLanelet2Costmap();
+  generateCombinedCostmap();
 
   std_msgs::Header in_header = in_sensor_points_msg->header;
   publishRosMsg(costmap_, in_header);
@@ -184,41 +186,43 @@ CostmapGeneratorLanelet2::generateSensorPointsCostmap(const pcl::PointCloud<pcl:
   return sensor_points_costmap;
 }
 
-grid_map::Matrix CostmapGeneratorLanelet2::generateObjectsCostmap(
-    const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects, const bool use_convex_hull)
+void CostmapGeneratorLanelet2::generateObjectsCostmap(const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
+                                                      const bool use_convex_hull,
+                                                      const std::string& gridmap_layer_name)
 {
-  grid_map::Matrix objects_costmap = objects2costmap_.makeCostmapFromObjects(
-      costmap_, expand_polygon_size_, size_of_expansion_kernel_, in_objects, use_convex_hull);
-  return objects_costmap;
+  objects2costmap_.makeCostmapFromObjects(gridmap_layer_name, expand_polygon_size_, size_of_expansion_kernel_,
+                                          in_objects, use_convex_hull, costmap_);
 }
 
-grid_map::Matrix CostmapGeneratorLanelet2::generateLanelet2Costmap()
+void CostmapGeneratorLanelet2::generateLanelet2Costmap()
 {
-  grid_map::GridMap lanelet2_costmap = costmap_;
-  if (use_wayarea_ && !area_points_.empty())
+  if (!use_wayarea_ || !areas2costmap_.hasAreas())
   {
-    has_subscribed_wayarea_ = true;
-    object_map::FillPolygonAreas(lanelet2_costmap, area_points_, LANELET2_COSTMAP_LAYER_, grid_max_value_,
-                                 grid_min_value_, grid_min_value_, grid_max_value_, lidar_frame_, map_frame_,
-                                 tf_listener_);
+    return;
+  }
+
+  tf::StampedTransform costmap_to_map;
+  try
+  {
+    tf_listener_.lookupTransform(map_frame_, lidar_frame_, ros::Time(0), costmap_to_map);
+  }
+  catch (tf::TransformException& ex)
+  {
+    ROS_ERROR("%s", ex.what());
+    return;
   }
-  return lanelet2_costmap[LANELET2_COSTMAP_LAYER_];
+  areas2costmap_.makeCostmapFromAreas(costmap_to_map, LANELET2_COSTMAP_LAYER_, grid_min_value_, grid_max_value_,
+                                      costmap_);
 }
 
-grid_map::Matrix CostmapGeneratorLanelet2::generateCombinedCostmap()
+void CostmapGeneratorLanelet2::generateCombinedCostmap()
 {
   // assuming combined_costmap is calculated by element wise max operation
-  grid_map::GridMap combined_costmap = costmap_;
-  combined_costmap[COMBINED_COSTMAP_LAYER_].setConstant(grid_min_value_);
-  combined_costmap[COMBINED_COSTMAP_LAYER_] =
-      combined_costmap[COMBINED_COSTMAP_LAYER_].cwiseMax(combined_costmap[SENSOR_POINTS_COSTMAP_LAYER_]);
-  combined_costmap[COMBINED_COSTMAP_LAYER_] =
-      combined_costmap[COMBINED_COSTMAP_LAYER_].cwiseMax(combined_costmap[LANELET2_COSTMAP_LAYER_]);
-  combined_costmap[COMBINED_COSTMAP_LAYER_] =
-      combined_costmap[COMBINED_COSTMAP_LAYER_].cwiseMax(combined_costmap[OBJECTS_BOX_COSTMAP_LAYER_]);
-  combined_costmap[COMBINED_COSTMAP_LAYER_] =
-      combined_costmap[COMBINED_COSTMAP_LAYER_].cwiseMax(combined_costmap[OBJECTS_CONVEX_HULL_COSTMAP_LAYER_]);
-  return combined_costmap[COMBINED_COSTMAP_LAYER_];
+  costmap_[COMBINED_COSTMAP_LAYER_] = costmap_[SENSOR_POINTS_COSTMAP_LAYER_]
+                                          .cwiseMax(costmap_[LANELET2_COSTMAP_LAYER_])
+                                          .cwiseMax(costmap_[OBJECTS_BOX_COSTMAP_LAYER_])
+                                          .cwiseMax(costmap_[OBJECTS_CONVEX_HULL_COSTMAP_LAYER_])
+                                          .cwiseMax(static_cast<float>(grid_min_value_));
 }
 
 void CostmapGeneratorLanelet2::publishRosMsg(const grid_map::GridMap& costmap, const std_msgs::Header& in_header)
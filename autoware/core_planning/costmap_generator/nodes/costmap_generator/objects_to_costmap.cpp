@@ -29,6 +29,7 @@
  ********************/
 
 // headers in standard library
+#include <algorithm>
 #include <cmath>
 
 // headers in ROS
@@ -40,9 +41,7 @@
 // Constructor
 ObjectsToCostmap::ObjectsToCostmap() :
 NUMBER_OF_POINTS(4),
-NUMBER_OF_DIMENSIONS(2),
-OBJECTS_COSTMAP_LAYER_("objects_costmap"),
-BLURRED_OBJECTS_COSTMAP_LAYER_("blurred_objects_costmap")
+NUMBER_OF_DIMENSIONS(2)
 {
 }
 
@@ -128,30 +127,134 @@ grid_map::Polygon ObjectsToCostmap::makePolygonFromObjectConvexHull(const autowa
 void ObjectsToCostmap::setCostInPolygon(const grid_map::Polygon& polygon, const std::string& gridmap_layer_name,
                                        const float score, grid_map::GridMap& objects_costmap)
 {
-  grid_map::PolygonIterator iterators(objects_costmap, polygon);
+  grid_map::Matrix& layer = objects_costmap[gridmap_layer_name];
   for (grid_map::PolygonIterator iterator(objects_costmap, polygon); !iterator.isPastEnd(); ++iterator)
   {
-    const float current_score = objects_costmap.at(gridmap_layer_name, *iterator);
+    const grid_map::Index index = *iterator;
+    float& current_score = layer(index.x(), index.y());
     if (score > current_score)
     {
-      objects_costmap.at(gridmap_layer_name, *iterator) = score;
+      current_score = score;
     }
   }
 }
 
-grid_map::Matrix ObjectsToCostmap::makeCostmapFromObjects(const grid_map::GridMap& costmap,
-                                                         const double expand_polygon_size,
-                                                         const double size_of_expansion_kernel,
-                                                         const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
-                                                         const bool use_objects_convex_hull)
+ObjectsToCostmap::CellRange ObjectsToCostmap::makeCellRangeFromPolygon(const grid_map::Polygon& polygon,
+                                                                     const grid_map::GridMap& costmap) const
 {
-  grid_map::GridMap objects_costmap = costmap;
-  objects_costmap.add(OBJECTS_COSTMAP_LAYER_, 0);
-  objects_costmap.add(BLURRED_OBJECTS_COSTMAP_LAYER_, 0);
+  const grid_map::Index last_index = costmap.getSize() - 1;
+  CellRange range;
+  range.min = last_index + 1;
+  range.max = grid_map::Index(-1, -1);
+  if (polygon.nVertices() == 0)
+  {
+    return range;
+  }
+
+  grid_map::Position lower = polygon.getVertex(0);
+  grid_map::Position upper = lower;
+  for (const auto& vertex : polygon.getVertices())
+  {
+    lower = lower.cwiseMin(vertex);
+    upper = upper.cwiseMax(vertex);
+  }
+  // index increases from the corner at maximum x and y towards minimum x and y,
+  // one cell of margin is added so that cells on the edge of polygon are not missed
+  const grid_map::Position corner = costmap.getPosition() + 0.5 * costmap.getLength().matrix();
+  const Eigen::Array2d min_index = ((corner - upper).array() / costmap.getResolution()).floor() - 1;
+  const Eigen::Array2d max_index = ((corner - lower).array() / costmap.getResolution()).floor() + 1;
+  if ((max_index < 0.0).any() || (min_index > last_index.cast<double>()).any())
+  {
+    return range;
+  }
+  range.min = min_index.max(0.0).cast<int>();
+  range.max = max_index.min(last_index.cast<double>()).cast<int>();
+  return range;
+}
 
+ObjectsToCostmap::CellRange ObjectsToCostmap::blurCost(const CellRange& drawn_range, const int kernel_margin,
+                                                       grid_map::Matrix& costmap)
+{
+  if (drawn_range.empty() || kernel_margin <= 0)
+  {
+    return drawn_range;
+  }
+
+  const grid_map::Index last_index(costmap.rows() - 1, costmap.cols() - 1);
+  CellRange blurred_range;
+  blurred_range.min = (drawn_range.min - kernel_margin).max(0);
+  blurred_range.max = (drawn_range.max + kernel_margin).min(last_index);
+  const grid_map::Index drawn_size = drawn_range.max - drawn_range.min + 1;
+  const grid_map::Index blurred_size = blurred_range.max - blurred_range.min + 1;
+
+  // mean filter is separable, so the window sums are taken along rows and then along columns by prefix sums.
+  // Cells out of drawn_range are zero and skipped
+  prefix_sums_.setZero(drawn_size.x() + 1, drawn_size.y());
+  for (int i = 0; i < drawn_size.x(); i++)
+  {
+    prefix_sums_.row(i + 1) =
+        prefix_sums_.row(i) +
+        costmap.row(drawn_range.min.x() + i).segment(drawn_range.min.y(), drawn_size.y()).cast<double>().array();
+  }
+  window_sums_.resize(blurred_size.x(), drawn_size.y());
+  Eigen::ArrayXd row_counts(blurred_size.x());
+  for (int i = 0; i < blurred_size.x(); i++)
+  {
+    const int row = blurred_range.min.x() + i;
+    const int lower = std::max(row - kernel_margin, drawn_range.min.x()) - drawn_range.min.x();
+    const int upper = std::min(row + kernel_margin, drawn_range.max.x()) - drawn_range.min.x();
+    window_sums_.row(i) = prefix_sums_.row(upper + 1) - prefix_sums_.row(lower);
+    // the window is cropped at the edges of costmap
+    row_counts(i) = std::min(row + kernel_margin, last_index.x()) - std::max(row - kernel_margin, 0) + 1;
+  }
+
+  prefix_sums_.setZero(blurred_size.x(), drawn_size.y() + 1);
+  for (int j = 0; j < drawn_size.y(); j++)
+  {
+    prefix_sums_.col(j + 1) = prefix_sums_.col(j) + window_sums_.col(j);
+  }
+  for (int j = 0; j < blurred_size.y(); j++)
+  {
+    const int col = blurred_range.min.y() + j;
+    const int lower = std::max(col - kernel_margin, drawn_range.min.y()) - drawn_range.min.y();
+    const int upper = std::min(col + kernel_margin, drawn_range.max.y()) - drawn_range.min.y();
+    const double col_count = std::min(col + kernel_margin, last_index.y()) - std::max(col - kernel_margin, 0) + 1;
+    auto target = costmap.col(col).segment(blurred_range.min.x(), blurred_size.x()).array();
+    target = target.max(((prefix_sums_.col(upper + 1) - prefix_sums_.col(lower)) / (row_counts * col_count))
+                            .cast<float>());
+  }
+  return blurred_range;
+}
+
+void ObjectsToCostmap::makeCostmapFromObjects(const std::string& gridmap_layer_name, const double expand_polygon_size,
+                                              const double size_of_expansion_kernel,
+                                              const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
+                                              const bool use_objects_convex_hull, grid_map::GridMap& costmap)
+{
+  grid_map::Matrix& objects_costmap = costmap[gridmap_layer_name];
+  const grid_map::Index last_index = costmap.getSize() - 1;
+  // ranges are in buffer order, which is the same as matrix order only if the map has not been moved
+  const bool use_ranges = costmap.isDefaultStartIndex();
+
+  // clear the cells written by the previous call
+  const auto dirty_range = dirty_ranges_.find(gridmap_layer_name);
+  if (!use_ranges || dirty_range == dirty_ranges_.end() || (dirty_range->second.max > last_index).any())
+  {
+    objects_costmap.setZero();
+  }
+  else if (!dirty_range->second.empty())
+  {
+    const grid_map::Index dirty_size = dirty_range->second.max - dirty_range->second.min + 1;
+    objects_costmap.block(dirty_range->second.min.x(), dirty_range->second.min.y(), dirty_size.x(), dirty_size.y())
+        .setZero();
+  }
+
+  CellRange drawn_range;
+  drawn_range.min = last_index + 1;
+  drawn_range.max = grid_map::Index(-1, -1);
   for (const auto& object : in_objects->objects)
   {
-    grid_map::Polygon polygon, expanded_polygon;
+    grid_map::Polygon expanded_polygon;
     if(use_objects_convex_hull)
     {
       expanded_polygon = makePolygonFromObjectConvexHull(object, expand_polygon_size);
@@ -160,22 +263,22 @@ grid_map::Matrix ObjectsToCostmap::makeCostmapFromObjects(const grid_map::GridMa
     {
       expanded_polygon = makePolygonFromObjectBox(object, expand_polygon_size);
     }
-    setCostInPolygon(expanded_polygon, OBJECTS_COSTMAP_LAYER_, object.score, objects_costmap);
-    setCostInPolygon(expanded_polygon, BLURRED_OBJECTS_COSTMAP_LAYER_, object.score, objects_costmap);
+    setCostInPolygon(expanded_polygon, gridmap_layer_name, object.score, costmap);
+
+    const CellRange polygon_range = makeCellRangeFromPolygon(expanded_polygon, costmap);
+    if (!polygon_range.empty())
+    {
+      drawn_range.min = drawn_range.min.min(polygon_range.min);
+      drawn_range.max = drawn_range.max.max(polygon_range.max);
+    }
   }
-  // Applying mean filter to expanded gridmap
-  const grid_map::SlidingWindowIterator::EdgeHandling edge_handling =
-      grid_map::SlidingWindowIterator::EdgeHandling::CROP;
-  for (grid_map::SlidingWindowIterator iterator(objects_costmap, BLURRED_OBJECTS_COSTMAP_LAYER_, edge_handling,
-                                                size_of_expansion_kernel);
-       !iterator.isPastEnd(); ++iterator)
+  if (!use_ranges)
   {
-    objects_costmap.at(BLURRED_OBJECTS_COSTMAP_LAYER_, *iterator) =
-        iterator.getData().meanOfFinites();  // Blurring.
+    drawn_range.min = grid_map::Index(0, 0);
+    drawn_range.max = last_index;
   }
 
-  objects_costmap[OBJECTS_COSTMAP_LAYER_] =
-      objects_costmap[OBJECTS_COSTMAP_LAYER_].cwiseMax(objects_costmap[BLURRED_OBJECTS_COSTMAP_LAYER_]);
-
-  return objects_costmap[OBJECTS_COSTMAP_LAYER_];
+  // Applying mean filter to expanded gridmap
+  const int kernel_margin = (static_cast<int>(size_of_expansion_kernel) - 1) / 2;
+  dirty_ranges_[gridmap_layer_name] = blurCost(drawn_range, kernel_margin, objects_costmap);
 }
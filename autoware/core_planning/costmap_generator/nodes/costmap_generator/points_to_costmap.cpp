@@ -28,6 +28,9 @@
  *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ********************/
 
+#include <algorithm>
+#include <cmath>
+
 #include "costmap_generator/points_to_costmap.h"
 
 // Constructor
@@ -76,54 +79,64 @@ grid_map::Index PointsToCostmap::fetchGridIndexFromPoint(const pcl::PointXYZ& po
   return index;
 }
 
-std::vector<std::vector<std::vector<double>>> PointsToCostmap::assignPoints2GridCell(
-    const grid_map::GridMap& gridmap, const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points)
+void PointsToCostmap::rasterizePoints(const double maximum_height_thres, const double minimum_height_thres,
+                                      const pcl::PointCloud<pcl::PointXYZ>& in_sensor_points, const int x_cell_size,
+                                      const int y_cell_size)
 {
-  double y_cell_size = std::ceil(grid_length_y_ * (1 / grid_resolution_));
-  double x_cell_size = std::ceil(grid_length_x_ * (1 / grid_resolution_));
-  std::vector<double> z_vec;
-  std::vector<std::vector<double>> vec_y_z(y_cell_size, z_vec);
-  std::vector<std::vector<std::vector<double>>> vec_x_y_z(x_cell_size, vec_y_z);
+  cell_states_.assign(static_cast<size_t>(x_cell_size) * y_cell_size, CELL_EMPTY);
+  const size_t num_points = in_sensor_points.size();
+  point_cells_.resize(num_points);
+
+  // same mapping as fetchGridIndexFromPoint, hoisted out of the loop
+  const double mapped_x_offset = grid_length_x_ - (grid_length_x_ / 2.0 - grid_position_x_);
+  const double mapped_y_offset = grid_length_y_ - (grid_length_y_ / 2.0 - grid_position_y_);
+  const double grid_resolution = grid_resolution_;
+  const pcl::PointXYZ* points = in_sensor_points.points.data();
+  int32_t* point_cells = point_cells_.data();
 
-  for (const auto& point : *in_sensor_points)
+  // classify all points first, this loop has no dependencies and is vectorized and split between threads
+#pragma omp parallel for simd if (num_points > 100000)
+  for (size_t i = 0; i < num_points; i++)
   {
-    grid_map::Index grid_ind = fetchGridIndexFromPoint(point);
-    if (isValidInd(grid_ind))
+    const double mapped_x = (mapped_x_offset - points[i].x) / grid_resolution;
+    const double mapped_y = (mapped_y_offset - points[i].y) / grid_resolution;
+    // ceil(mapped) is in [0, cell_size - 1], written without ceil so that NaN points are rejected as well
+    const bool is_valid =
+        mapped_x > -1.0 && mapped_x <= x_cell_size - 1 && mapped_y > -1.0 && mapped_y <= y_cell_size - 1;
+    const int x_ind = is_valid ? static_cast<int>(std::ceil(mapped_x)) : 0;
+    const int y_ind = is_valid ? static_cast<int>(std::ceil(mapped_y)) : 0;
+    const bool in_height_band = points[i].z <= maximum_height_thres && points[i].z >= minimum_height_thres;
+    // column major cell index of grid_map::Matrix, with the height band in the lowest bit
+    point_cells[i] = is_valid ? (((x_ind + y_ind * x_cell_size) << 1) | (in_height_band ? 1 : 0)) : -1;
+  }
+
+  uint8_t* cell_states = cell_states_.data();
+  for (size_t i = 0; i < num_points; i++)
+  {
+    const int32_t point_cell = point_cells[i];
+    if (point_cell >= 0)
     {
-      vec_x_y_z[grid_ind.x()][grid_ind.y()].push_back(point.z);
+      cell_states[point_cell >> 1] |= CELL_OCCUPIED | ((point_cell & 1) ? CELL_IN_HEIGHT_BAND : 0);
     }
   }
-  return vec_x_y_z;
 }
 
-grid_map::Matrix PointsToCostmap::calculateCostmap(const double maximum_height_thres,
-                                                  const double minimum_lidar_height_thres, const double grid_min_value,
-                                                  const double grid_max_value, const grid_map::GridMap& gridmap,
-                                                  const std::string& gridmap_layer_name,
-                                                  const std::vector<std::vector<std::vector<double>>> grid_vec)
+void PointsToCostmap::fillCostmap(const double grid_min_value, const double grid_max_value,
+                                  grid_map::Matrix& costmap) const
 {
-  grid_map::Matrix gridmap_data = gridmap[gridmap_layer_name];
-  for (size_t x_ind = 0; x_ind < grid_vec.size(); x_ind++)
+  const float min_value = grid_min_value;
+  const float max_value = grid_max_value;
+  const uint8_t* cell_states = cell_states_.data();
+  float* costmap_data = costmap.data();
+  const size_t num_cells = std::min<size_t>(cell_states_.size(), costmap.size());
+#pragma omp parallel for simd if (num_cells > 1000000)
+  for (size_t i = 0; i < num_cells; i++)
   {
-    for (size_t y_ind = 0; y_ind < grid_vec[0].size(); y_ind++)
-    {
-      if (grid_vec[x_ind][y_ind].size() == 0)
-      {
-        gridmap_data(x_ind, y_ind) = grid_min_value;
-        continue;
-      }
-      for (const auto& z : grid_vec[x_ind][y_ind])
-      {
-        if (z > maximum_height_thres || z < minimum_lidar_height_thres)
-        {
-          continue;
-        }
-        gridmap_data(x_ind, y_ind) = grid_max_value;
-        break;
-      }
-    }
+    // the current value is loaded unconditionally, so the select is branch free
+    const uint8_t state = cell_states[i];
+    const float current_value = costmap_data[i];
+    costmap_data[i] = (state == CELL_EMPTY) ? min_value : ((state >= CELL_IN_HEIGHT_BAND) ? max_value : current_value);
   }
-  return gridmap_data;
 }
 
 grid_map::Matrix PointsToCostmap::makeCostmapFromSensorPoints(
@@ -132,8 +145,8 @@ grid_map::Matrix PointsToCostmap::makeCostmapFromSensorPoints(
     const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points)
 {
   initGridmapParam(gridmap);
-  std::vector<std::vector<std::vector<double>>> grid_vec = assignPoints2GridCell(gridmap, in_sensor_points);
-  grid_map::Matrix costmap = calculateCostmap(maximum_height_thres, minimum_lidar_height_thres, grid_min_value,
-                                              grid_max_value, gridmap, gridmap_layer_name, grid_vec);
+  grid_map::Matrix costmap = gridmap[gridmap_layer_name];
+  rasterizePoints(maximum_height_thres, minimum_lidar_height_thres, *in_sensor_points, costmap.rows(), costmap.cols());
+  fillCostmap(grid_min_value, grid_max_value, costmap);
   return costmap;
 }
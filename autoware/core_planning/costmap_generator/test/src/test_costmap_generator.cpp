@@ -51,6 +51,7 @@ protected:
   {
     test_obj_.objects2costmap_ = new ObjectsToCostmap();
     test_obj_.points2costmap_ = new PointsToCostmap();
+    test_obj_.areas2costmap_ = new AreasToCostmap();
     test_obj_.dummy_point_ = new geometry_msgs::Point;
     test_obj_.dummy_pcl_point_ = new pcl::PointXYZ;
     test_obj_.dummy_object_ = new autoware_msgs::DetectedObject;
@@ -60,13 +61,13 @@ protected:
     test_obj_.fillDummyObjectParam(test_obj_.dummy_object_);
     test_obj_.fillDummyCostmapParam(test_obj_.dummy_costmap_);
     test_obj_.fillDummyObjectsArrayParam(test_obj_.dummy_objects_array_);
-    test_obj_.initDummy3DVecParam();
 
   };
   void TearDown()
   {
     delete test_obj_.objects2costmap_;
     delete test_obj_.points2costmap_;
+    delete test_obj_.areas2costmap_;
     delete test_obj_.dummy_point_;
     delete test_obj_.dummy_pcl_point_;
     delete test_obj_.dummy_object_;
@@ -101,7 +102,7 @@ TEST_F(TestSuite, CheckMakeRectanglePoints)
   EXPECT_DOUBLE_EQ(expected_y, rectangle_points(1, 0));
 }
 
-TEST_F(TestSuite, CheckAssignPoints2GridCell)
+TEST_F(TestSuite, CheckRasterizePoints)
 {
 
   pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points(new pcl::PointCloud<pcl::PointXYZ>);
@@ -109,14 +110,15 @@ TEST_F(TestSuite, CheckAssignPoints2GridCell)
   test_obj_.dummy_pcl_point_->y = 0.5;
   test_obj_.dummy_pcl_point_->z = 100;
   in_sensor_points->push_back(*test_obj_.dummy_pcl_point_);
+  test_obj_.dummy_pcl_point_->x = 3.5;
+  test_obj_.dummy_pcl_point_->z = 0;
+  in_sensor_points->push_back(*test_obj_.dummy_pcl_point_);
 
-
-  std::vector<std::vector<std::vector<double>>> grid_vec =
-    test_obj_.assignPoints2GridCell(*test_obj_.dummy_costmap_,
-                                    in_sensor_points);
-
-  const double expected_value = 100;
-  EXPECT_EQ(expected_value, grid_vec[5][5][0]);
+  // occupied, but above the height threshold
+  EXPECT_EQ(1, test_obj_.rasterizePoints(*test_obj_.dummy_costmap_, in_sensor_points, grid_map::Index(5, 5)));
+  // occupied and in the height band
+  EXPECT_EQ(3, test_obj_.rasterizePoints(*test_obj_.dummy_costmap_, in_sensor_points, grid_map::Index(2, 5)));
+  EXPECT_EQ(0, test_obj_.rasterizePoints(*test_obj_.dummy_costmap_, in_sensor_points, grid_map::Index(5, 2)));
 }
 
 TEST_F(TestSuite, CheckFetchGridIndexFromPoint)
@@ -157,32 +159,26 @@ TEST_F(TestSuite, CheckNonValidIndex)
 
 TEST_F(TestSuite, CheckCalculationPointsCostmap)
 {
-  test_obj_.dummy_3d_vec_->at(5)[5].push_back(2.2);
-
-  grid_map::Matrix costmap_mat = test_obj_.calculateCostmap(
-    test_obj_.dummy_maximum_lidar_height_thres_,
-    test_obj_.dummy_minimum_lidar_height_thres_,
-    test_obj_.dummy_grid_min_value_,
-    test_obj_.dummy_grid_max_value_,
-    *test_obj_.dummy_costmap_,
-    test_obj_.dummy_layer_name_,
-    *test_obj_.dummy_3d_vec_);
+  pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points(new pcl::PointCloud<pcl::PointXYZ>);
+  test_obj_.dummy_pcl_point_->x = 0.5;
+  test_obj_.dummy_pcl_point_->y = 0.5;
+  test_obj_.dummy_pcl_point_->z = 2.2;
+  in_sensor_points->push_back(*test_obj_.dummy_pcl_point_);
+
+  grid_map::Matrix costmap_mat = test_obj_.makeCostmapFromSensorPoints(*test_obj_.dummy_costmap_, in_sensor_points);
   double expected_cost = 1.0;
   EXPECT_DOUBLE_EQ(expected_cost, costmap_mat(5,5));
 }
 
 TEST_F(TestSuite, CheckHeightThresholdForCost)
 {
-  test_obj_.dummy_3d_vec_->at(5)[5].push_back(3.2);
-
-  grid_map::Matrix costmap_mat = test_obj_.calculateCostmap(
-    test_obj_.dummy_maximum_lidar_height_thres_,
-    test_obj_.dummy_minimum_lidar_height_thres_,
-    test_obj_.dummy_grid_min_value_,
-    test_obj_.dummy_grid_max_value_,
-    *test_obj_.dummy_costmap_,
-    test_obj_.dummy_layer_name_,
-    *test_obj_.dummy_3d_vec_);
+  pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points(new pcl::PointCloud<pcl::PointXYZ>);
+  test_obj_.dummy_pcl_point_->x = 0.5;
+  test_obj_.dummy_pcl_point_->y = 0.5;
+  test_obj_.dummy_pcl_point_->z = 3.2;
+  in_sensor_points->push_back(*test_obj_.dummy_pcl_point_);
+
+  grid_map::Matrix costmap_mat = test_obj_.makeCostmapFromSensorPoints(*test_obj_.dummy_costmap_, in_sensor_points);
   double expected_cost = 0.0;
   EXPECT_DOUBLE_EQ(expected_cost, costmap_mat(5,5));
 }
@@ -369,18 +365,18 @@ TEST_F(TestSuite, CheckMakeCostmapFromObjectsBlur)
                                           test_obj_.dummy_objects_array_,
                                           use_objects_convex_hull);
   /*
-  0  0  0           0           0           0 0.000228624 0.000635066 0.000683101 0.000629966
-  0  0  0           0           0  0.00137174  0.00358177  0.00346354  0.00183676  0.00128529
-  0  0  0           0   0.0123457   0.0306356   0.0267264   0.0117492  0.00456194  0.00264567
-  0  0  0    0.111111    0.262003    0.204948   0.0719709    0.024008  0.00819001   0.0043936
-  0  0  0    0.234568           1           1    0.105625    0.033391    0.010964  0.00580402
-  0  0  0    0.248285           1           1   0.0989154   0.0330867   0.0112765  0.00618194
-  0  0  0    0.138698    0.207193    0.110906   0.0598489    0.024047  0.00904712  0.00537396
-  0  0  0   0.0154109    0.040335   0.0405389    0.024572   0.0130139  0.00573816  0.00386448
-  0  0  0  0.00171233  0.00641596  0.00985468  0.00865679  0.00553543  0.00302765  0.00242517
-  0  0  0 0.000285388  0.00140228  0.00294549  0.00357616   0.0029614  0.00192074  0.00184339
+  0 0 0        0        0        0        0 0 0 0
+  0 0 0        0        0        0        0 0 0 0
+  0 0 0        0        0        0        0 0 0 0
+  0 0 0 0.111111 0.222222 0.222222 0.111111 0 0 0
+  0 0 0 0.222222        1        1 0.222222 0 0 0
+  0 0 0 0.222222        1        1 0.222222 0 0 0
+  0 0 0 0.111111 0.222222 0.222222 0.111111 0 0 0
+  0 0 0        0        0        0        0 0 0 0
+  0 0 0        0        0        0        0 0 0 0
+  0 0 0        0        0        0        0 0 0 0
   */
-  double expected_score = 0.0598489;
+  double expected_score = 0.111111;
   double buffer = 0.001;
   EXPECT_NEAR(expected_score,gridmap_mat(6,6), buffer);
 }
@@ -433,22 +429,74 @@ TEST_F(TestSuite, CheckMakeCostmapFromObjectsBoxBlur)
                                           dummy_objects,
                                           use_objects_convex_hull);
   /*
-  0 0 0 0 0 0           0           0           0           0
-  0 0 0 0 0 0           0           0           0           0
-  0 0 0 0 0 0           0           0           0           0
-  0 0 0 0 0 0           0           0           0           0
-  0 0 0 0 0 0           0           0           0 0.000228624
-  0 0 0 0 0 0           0           0  0.00137174  0.00537266
-  0 0 0 0 0 0           0   0.0123457   0.0306356   0.0406435
-  0 0 0 0 0 0    0.111111    0.262003    0.206481    0.115094
-  0 0 0 0 0 0    0.234568           1           1    0.196272
-  0 0 0 0 0 0    0.372428           1           1    0.263083
+  0 0 0 0 0 0        0        0        0        0
+  0 0 0 0 0 0        0        0        0        0
+  0 0 0 0 0 0        0        0        0        0
+  0 0 0 0 0 0        0        0        0        0
+  0 0 0 0 0 0        0        0        0        0
+  0 0 0 0 0 0        0        0        0        0
+  0 0 0 0 0 0        0        0        0        0
+  0 0 0 0 0 0 0.111111 0.222222 0.222222 0.166667
+  0 0 0 0 0 0 0.222222        1        1 0.333333
+  0 0 0 0 0 0 0.333333        1        1      0.5
   */
   float expected_score = 0.11111;
   float buffer = 0.00001;
   EXPECT_NEAR(expected_score, gridmap_mat(7,6), buffer);
 }
 
+TEST_F(TestSuite, CheckMakeCostmapFromObjectsClearsPreviousObjects)
+{
+  double expand_polygon_size = 0;
+  double size_of_expansion_kernel = 3;
+  bool use_objects_convex_hull = true;
+  test_obj_.makeCostmapFromObjects(*test_obj_.dummy_costmap_,
+                                   expand_polygon_size,
+                                   size_of_expansion_kernel,
+                                   test_obj_.dummy_objects_array_,
+                                   use_objects_convex_hull);
+  autoware_msgs::DetectedObjectArray::Ptr no_objects(new autoware_msgs::DetectedObjectArray);
+  grid_map::Matrix gridmap_mat = test_obj_.makeCostmapFromObjects(
+                                          *test_obj_.dummy_costmap_,
+                                          expand_polygon_size,
+                                          size_of_expansion_kernel,
+                                          no_objects,
+                                          use_objects_convex_hull);
+  float expected_max_score = 0;
+  EXPECT_EQ(expected_max_score, gridmap_mat.maxCoeff());
+}
+
+TEST_F(TestSuite, CheckMakeCostmapFromAreas)
+{
+  std::vector<std::vector<geometry_msgs::Point>> area_points(1);
+  geometry_msgs::Point point;
+  point.x = -2;
+  point.y = -2;
+  area_points[0].push_back(point);
+  point.x = 2;
+  area_points[0].push_back(point);
+  point.y = 2;
+  area_points[0].push_back(point);
+  point.x = -2;
+  area_points[0].push_back(point);
+  test_obj_.areas2costmap_->setAreas(area_points);
+
+  tf::Transform costmap_to_map(tf::createQuaternionFromYaw(0), tf::Vector3(0, 0, 0));
+  test_obj_.makeCostmapFromAreas(*test_obj_.dummy_costmap_, costmap_to_map);
+  EXPECT_EQ(test_obj_.dummy_grid_min_value_,
+    test_obj_.dummy_costmap_->atPosition(test_obj_.dummy_layer_name_, grid_map::Position(0.5, 0.5)));
+  EXPECT_EQ(test_obj_.dummy_grid_max_value_,
+    test_obj_.dummy_costmap_->atPosition(test_obj_.dummy_layer_name_, grid_map::Position(3.5, 0.5)));
+
+  // the cached areas follow the costmap when it moves in map frame
+  costmap_to_map.setOrigin(tf::Vector3(3, 0, 0));
+  test_obj_.makeCostmapFromAreas(*test_obj_.dummy_costmap_, costmap_to_map);
+  EXPECT_EQ(test_obj_.dummy_grid_min_value_,
+    test_obj_.dummy_costmap_->atPosition(test_obj_.dummy_layer_name_, grid_map::Position(-3.5, 0.5)));
+  EXPECT_EQ(test_obj_.dummy_grid_max_value_,
+    test_obj_.dummy_costmap_->atPosition(test_obj_.dummy_layer_name_, grid_map::Position(0.5, 0.5)));
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
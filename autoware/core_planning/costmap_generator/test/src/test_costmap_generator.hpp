@@ -61,29 +61,21 @@ public:
 
   PointsToCostmap *points2costmap_;
 
-  std::unique_ptr<std::vector<std::vector<std::vector<double>>>> dummy_3d_vec_;
-
   void fillDummyObjectParam(autoware_msgs::DetectedObject* dummy_object);
 
   void fillDummyObjectsArrayParam(autoware_msgs::DetectedObjectArray::Ptr dummy_objects_array);
 
   void fillDummyCostmapParam(grid_map::GridMap* dummy_costmap);
 
-  void initDummy3DVecParam();
-
-
-  std::vector<std::vector<std::vector<double>>>
-  assignPoints2GridCell(const grid_map::GridMap& gridmap, const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points);
+  uint8_t rasterizePoints(const grid_map::GridMap& gridmap, const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points,
+                          const grid_map::Index& grid_ind);
 
   grid_map::Index fetchGridIndexFromPoint(const grid_map::GridMap& gridmap, const pcl::PointXYZ& point);
 
   bool isValidInd(const grid_map::GridMap& gridmap, const grid_map::Index& grid_ind);
 
-  grid_map::Matrix calculateCostmap(const double maximum_height_thres,
-                                    const double minimum_lidar_height_thres, const double grid_min_value,
-                                    const double grid_max_value, const grid_map::GridMap& gridmap,
-                                    const std::string& gridmap_layer_name,
-                                    const std::vector<std::vector<std::vector<double>>> grid_vec);
+  grid_map::Matrix makeCostmapFromSensorPoints(const grid_map::GridMap& gridmap,
+                                               const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points);
 
 
   ObjectsToCostmap *objects2costmap_;
@@ -99,11 +91,14 @@ public:
   void setCostInPolygon(const grid_map::Polygon& polygon, const std::string& gridmap_layer_name,
                                        const float score, grid_map::GridMap& objects_costmap);
 
-  grid_map::Matrix makeCostmapFromObjects(const grid_map::GridMap& costmap,
+  grid_map::Matrix makeCostmapFromObjects(grid_map::GridMap& costmap,
                                           const double expand_polygon_size,
                                           const double size_of_expansion_kernel,
                                           const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
                                           const bool use_objects_convex_hull);
+
+  AreasToCostmap *areas2costmap_;
+  grid_map::Matrix makeCostmapFromAreas(grid_map::GridMap& costmap, const tf::Transform& costmap_to_map);
 };
 
 TestClass::TestClass():
@@ -174,16 +169,6 @@ void TestClass::fillDummyObjectsArrayParam(autoware_msgs::DetectedObjectArray::P
   dummy_objects_array->objects.push_back(object);
 }
 
-void TestClass::initDummy3DVecParam()
-{
-  double y_cell_size = std::ceil(dummy_grid_length_y_ * (1 / dummy_grid_resolution_));
-  double x_cell_size = std::ceil(dummy_grid_length_x_ * (1 / dummy_grid_resolution_));
-  std::vector<double> z_vec;
-  std::vector<std::vector<double>> vec_y_z(y_cell_size, z_vec);
-  dummy_3d_vec_.reset(new
-    std::vector<std::vector<std::vector<double>>>(x_cell_size, vec_y_z));
-}
-
 
 Eigen::MatrixXd TestClass::makeRectanglePoints(const autoware_msgs::DetectedObject& in_object,
                                                const double expanded_rectangle_size)
@@ -191,15 +176,15 @@ Eigen::MatrixXd TestClass::makeRectanglePoints(const autoware_msgs::DetectedObje
   return objects2costmap_->makeRectanglePoints(in_object, expanded_rectangle_size);
 }
 
-std::vector<std::vector<std::vector<double>>> TestClass::assignPoints2GridCell(
-    const grid_map::GridMap& gridmap, const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points)
+uint8_t TestClass::rasterizePoints(const grid_map::GridMap& gridmap,
+                                   const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points,
+                                   const grid_map::Index& grid_ind)
 {
-  points2costmap_->grid_length_x_ = gridmap.getLength()[0];
-  points2costmap_->grid_length_y_ = gridmap.getLength()[1];
-  points2costmap_->grid_resolution_ = gridmap.getResolution();
-  points2costmap_->grid_position_x_ = gridmap.getPosition()[0];
-  points2costmap_->grid_position_y_ = gridmap.getPosition()[1];
-  return points2costmap_->assignPoints2GridCell(gridmap, in_sensor_points);
+  points2costmap_->initGridmapParam(gridmap);
+  const grid_map::Size size = gridmap.getSize();
+  points2costmap_->rasterizePoints(dummy_maximum_lidar_height_thres_, dummy_minimum_lidar_height_thres_,
+                                   *in_sensor_points, size.x(), size.y());
+  return points2costmap_->cell_states_[grid_ind.x() + grid_ind.y() * size.x()];
 }
 
 grid_map::Index TestClass::fetchGridIndexFromPoint(const grid_map::GridMap& gridmap, const pcl::PointXYZ& point)
@@ -222,15 +207,13 @@ bool TestClass::isValidInd(const grid_map::GridMap& gridmap, const grid_map::Ind
   return points2costmap_->isValidInd(grid_ind);
 }
 
-grid_map::Matrix TestClass::calculateCostmap(const double maximum_height_thres,
-                                                  const double minimum_lidar_height_thres, const double grid_min_value,
-                                                  const double grid_max_value, const grid_map::GridMap& gridmap,
-                                                  const std::string& gridmap_layer_name,
-                                                  const std::vector<std::vector<std::vector<double>>> grid_vec)
+grid_map::Matrix TestClass::makeCostmapFromSensorPoints(const grid_map::GridMap& gridmap,
+                                                        const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points)
 {
-  return points2costmap_->calculateCostmap(maximum_height_thres, minimum_lidar_height_thres,
-                                          grid_min_value, grid_max_value,
-                                          gridmap, gridmap_layer_name, grid_vec);
+  return points2costmap_->makeCostmapFromSensorPoints(dummy_maximum_lidar_height_thres_,
+                                                      dummy_minimum_lidar_height_thres_, dummy_grid_min_value_,
+                                                      dummy_grid_max_value_, gridmap, dummy_layer_name_,
+                                                      in_sensor_points);
 }
 
 geometry_msgs::Point TestClass::makeExpandedPoint(const geometry_msgs::Point& in_centroid,
@@ -252,15 +235,24 @@ void TestClass::setCostInPolygon(const grid_map::Polygon& polygon, const std::st
   objects2costmap_->setCostInPolygon(polygon, gridmap_layer_name, score, objects_costmap);
 }
 
-grid_map::Matrix TestClass::makeCostmapFromObjects(const grid_map::GridMap& costmap,
+grid_map::Matrix TestClass::makeCostmapFromObjects(grid_map::GridMap& costmap,
                                        const double expand_polygon_size,
                                        const double size_of_expansion_kernel,
                                        const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
                                        const bool use_objects_convex_hull)
 {
-  return objects2costmap_->makeCostmapFromObjects(costmap,
-                                                  expand_polygon_size,
-                                                  size_of_expansion_kernel,
-                                                  in_objects,
-                                                  use_objects_convex_hull);
+  objects2costmap_->makeCostmapFromObjects(dummy_layer_name_,
+                                           expand_polygon_size,
+                                           size_of_expansion_kernel,
+                                           in_objects,
+                                           use_objects_convex_hull,
+                                           costmap);
+  return costmap[dummy_layer_name_];
+}
+
+grid_map::Matrix TestClass::makeCostmapFromAreas(grid_map::GridMap& costmap, const tf::Transform& costmap_to_map)
+{
+  areas2costmap_->makeCostmapFromAreas(costmap_to_map, dummy_layer_name_, dummy_grid_min_value_,
+                                       dummy_grid_max_value_, costmap);
+  return costmap[dummy_layer_name_];
 }
@@ -39,6 +39,8 @@
 #ifndef TRAJECTORYGENERATOR_H
 #define TRAJECTORYGENERATOR_H
 
+#include <vector>
+
 // ---------DEFINE MODE---------//
 //#define GEN_PLOT_FILES
 //#define DEBUG_OUTPUT
@@ -191,6 +193,35 @@ union Command
     double cmd_index[2];
 };
 
+// ------------SPLINE LOOKUP TABLE----------//
+// Number of axes of the table: dx, dy, dtheta, v and the initial kappa
+#define SPLINE_TABLE_AXES 5
+
+// Converged spline parameters over a grid of goal states relative to the vehicle,
+// generated offline and interpolated to warm start the solver
+struct SplineTable
+{
+    // Number of samples and first and last sample of each axis
+    int size[SPLINE_TABLE_AXES];
+    double min[SPLINE_TABLE_AXES];
+    double max[SPLINE_TABLE_AXES];
+
+    // One spline per sample, the first axis varying fastest, success is FALSE where the solver failed
+    std::vector<union Spline> splines;
+};
+
+// Convergence statistics of a batch of goal states
+struct BatchStats
+{
+    int goals;
+    int converged;
+    // Goals whose initial guess came from the lookup table
+    int warm_started;
+    // Corrections over all goals and the largest number for a single goal
+    int iterations;
+    int max_iterations;
+};
+
 
 // ------------FUNCTION DECLARATIONS----------//
 
@@ -228,6 +259,26 @@ union State nextState(union State veh, union Spline curvature, double vdes, doub
 // trajectoryGenerator is like a "main function" used to iterate through a series of goal states
 union Spline trajectoryGenerator(double sx, double sy, double theta, double v, double kappa);
 
+// solveSpline refines an initial guess until the goal is reached, success is FALSE if it did not converge
+union Spline solveSpline(union State veh, union State goal, union Spline curvature, int max_iterations, int *iterations);
+
+// initSplineTable sets the axes of the table and clears its splines
+void initSplineTable(struct SplineTable *table, const int size[], const double min[], const double max[]);
+
+// buildSplineTable solves every goal state of the table, in parallel
+void buildSplineTable(struct SplineTable *table, int max_iterations);
+
+// saveSplineTable and loadSplineTable store the table in a binary file
+bool saveSplineTable(const struct SplineTable &table, const char *path);
+bool loadSplineTable(struct SplineTable *table, const char *path);
+
+// lookupSpline interpolates an initial guess from the table, it returns FALSE if the goal is outside of it
+bool lookupSpline(const struct SplineTable &table, union State veh, union State goal, union Spline *curvature);
+
+// generateTrajectories solves a batch of goal states in parallel, warm started from table if it is not NULL,
+// goals the table misses start from seed if it is not NULL (e.g. the spline of a nearby goal) and from initParams otherwise
+struct BatchStats generateTrajectories(union State veh, const std::vector<union State> &goals, const struct SplineTable *table, int max_iterations, std::vector<union Spline> *splines, const union Spline *seed = NULL);
+
 // plotTraj is used by rViz to compute points for line strip, it is a lighter weight version of nextState
 union State genLineStrip(union State veh, union Spline curvature, double vdes, double t);
 
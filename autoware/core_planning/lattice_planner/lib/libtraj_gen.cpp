@@ -724,6 +724,377 @@ union State genLineStrip(union State veh, union Spline curvature, double vdes, d
     return veh_next;
 }
 
+// ------------SOLVE SPLINE----------//
+// Newton iterations on the spline parameters, as in trajectoryGenerator
+// INPUT: Current vehicle state, goal state, initial guess, iteration limit
+// OUTPUT: Refined spline and the number of corrections
+
+union Spline solveSpline(union State veh, union State goal, union Spline curvature, int max_iterations, int *iterations)
+{
+    bool convergence = FALSE;
+    int iteration = 0;
+    double dt = step_size;
+    union State veh_next;
+
+    // The spline is followed at the goal velocity
+    veh.v = goal.v;
+    curvature.success = TRUE;
+
+    while(convergence == FALSE && iteration < max_iterations)
+    {
+        // Set time horizon
+        double horizon = curvature.s/goal.v;
+
+        // Run motion model
+        veh_next = motionModel(veh, goal, curvature, dt, horizon, 0);
+
+        // Determine convergence criteria
+        convergence = checkConvergence(veh_next, goal);
+
+        // If the motion model doesn't get us to the goal compute new parameters
+        if(convergence == FALSE)
+        {
+            curvature = generateCorrection(veh, veh_next, goal, curvature, dt, horizon);
+            iteration++;
+
+            // Escape route for poorly conditioned Jacobian
+            if(curvature.success == FALSE)
+            {
+                break;
+            }
+        }
+    }
+
+    // The last correction is only kept if it reaches the goal
+    if(convergence == FALSE && curvature.success == TRUE)
+    {
+        veh_next = motionModel(veh, goal, curvature, dt, curvature.s/goal.v, 0);
+        convergence = checkConvergence(veh_next, goal);
+    }
+
+    curvature.success = convergence;
+
+    if(iterations != NULL)
+    {
+        *iterations = iteration;
+    }
+
+    return curvature;
+}
+
+// ------------SPLINE LOOKUP TABLE----------//
+// Grid of converged splines over (dx, dy, dtheta, v, kappa) of the goal
+// relative to the vehicle, interpolated to get an initial guess that
+// converges in one or two corrections instead of the heuristic of initParams
+
+// Value of sample i of an axis
+static double tableSample(const struct SplineTable &table, int axis, int i)
+{
+    if(table.size[axis] < 2)
+    {
+        return table.min[axis];
+    }
+    return table.min[axis] + (table.max[axis] - table.min[axis]) * i / (table.size[axis] - 1);
+}
+
+// Goal state and vehicle state of entry index of the table
+static void tableStates(const struct SplineTable &table, size_t index, union State *veh, union State *goal)
+{
+    double value[SPLINE_TABLE_AXES];
+    for(int axis = 0; axis < SPLINE_TABLE_AXES; axis++)
+    {
+        value[axis] = tableSample(table, axis, index % table.size[axis]);
+        index /= table.size[axis];
+    }
+
+    veh->sx = 0.0;
+    veh->sy = 0.0;
+    veh->theta = 0.0;
+    veh->kappa = value[4];
+    veh->v = value[3];
+    veh->vdes = value[3];
+    veh->timestamp = 0.0;
+
+    goal->sx = value[0];
+    goal->sy = value[1];
+    goal->theta = value[2];
+    goal->kappa = 0.0;
+    goal->v = value[3];
+    goal->vdes = value[3];
+    goal->timestamp = 0.0;
+}
+
+void initSplineTable(struct SplineTable *table, const int size[], const double min[], const double max[])
+{
+    size_t entries = 1;
+    for(int axis = 0; axis < SPLINE_TABLE_AXES; axis++)
+    {
+        table->size[axis] = std::max(size[axis], 1);
+        table->min[axis] = min[axis];
+        table->max[axis] = max[axis];
+        entries *= table->size[axis];
+    }
+
+    union Spline failed;
+    failed.s = 0.0;
+    failed.kappa_0 = 0.0;
+    failed.kappa_1 = 0.0;
+    failed.kappa_2 = 0.0;
+    failed.kappa_3 = 0.0;
+    failed.success = FALSE;
+    table->splines.assign(entries, failed);
+}
+
+void buildSplineTable(struct SplineTable *table, int max_iterations)
+{
+    // The entries along dy are solved in order, each one warm started from the previous
+    // converged one, and the lines of the other axes are split between threads
+    const int line_size = table->size[1];
+    const int lines = table->splines.size() / line_size;
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int line = 0; line < lines; line++)
+    {
+        // Index of the first entry of the line
+        size_t first = (line % table->size[0]) + (size_t)(line / table->size[0]) * table->size[0] * line_size;
+        union Spline previous;
+        previous.success = FALSE;
+
+        for(int j = 0; j < line_size; j++)
+        {
+            size_t index = first + (size_t)j * table->size[0];
+            union State veh;
+            union State goal;
+            tableStates(*table, index, &veh, &goal);
+
+            union Spline curvature;
+            curvature.success = FALSE;
+            if(previous.success == TRUE)
+            {
+                union Spline guess = previous;
+                guess.kappa_0 = veh.kappa;
+                guess.kappa_3 = goal.kappa;
+                curvature = solveSpline(veh, goal, guess, max_iterations, NULL);
+            }
+            if(curvature.success == FALSE)
+            {
+                curvature = solveSpline(veh, goal, initParams(veh, goal), max_iterations, NULL);
+            }
+
+            table->splines[index] = curvature;
+            if(curvature.success == TRUE)
+            {
+                previous = curvature;
+            }
+        }
+    }
+}
+
+// File header, followed by the axes and by s, kappa_1, kappa_2 and success of every entry
+static const char spline_table_magic[8] = {'L', 'T', 'S', 'P', 'L', 'U', 'T', '1'};
+
+bool saveSplineTable(const struct SplineTable &table, const char *path)
+{
+    ofstream file(path, ios::out | ios::binary);
+    if(!file)
+    {
+        return FALSE;
+    }
+
+    file.write(spline_table_magic, sizeof(spline_table_magic));
+    file.write((const char *)table.size, sizeof(table.size));
+    file.write((const char *)table.min, sizeof(table.min));
+    file.write((const char *)table.max, sizeof(table.max));
+    for(size_t i = 0; i < table.splines.size(); i++)
+    {
+        double entry[4];
+        entry[0] = table.splines[i].s;
+        entry[1] = table.splines[i].kappa_1;
+        entry[2] = table.splines[i].kappa_2;
+        entry[3] = table.splines[i].success ? 1.0 : 0.0;
+        file.write((const char *)entry, sizeof(entry));
+    }
+
+    return file.good();
+}
+
+bool loadSplineTable(struct SplineTable *table, const char *path)
+{
+    ifstream file(path, ios::in | ios::binary);
+    if(!file)
+    {
+        return FALSE;
+    }
+
+    char magic[sizeof(spline_table_magic)];
+    int size[SPLINE_TABLE_AXES];
+    double min[SPLINE_TABLE_AXES];
+    double max[SPLINE_TABLE_AXES];
+    file.read(magic, sizeof(magic));
+    file.read((char *)size, sizeof(size));
+    file.read((char *)min, sizeof(min));
+    file.read((char *)max, sizeof(max));
+    if(!file || !std::equal(magic, magic + sizeof(magic), spline_table_magic))
+    {
+        return FALSE;
+    }
+    for(int axis = 0; axis < SPLINE_TABLE_AXES; axis++)
+    {
+        if(size[axis] < 1)
+        {
+            return FALSE;
+        }
+    }
+
+    struct SplineTable loaded;
+    initSplineTable(&loaded, size, min, max);
+    for(size_t i = 0; i < loaded.splines.size(); i++)
+    {
+        double entry[4];
+        file.read((char *)entry, sizeof(entry));
+        loaded.splines[i].s = entry[0];
+        loaded.splines[i].kappa_1 = entry[1];
+        loaded.splines[i].kappa_2 = entry[2];
+        loaded.splines[i].success = entry[3] != 0.0;
+    }
+    if(!file)
+    {
+        return FALSE;
+    }
+
+    *table = loaded;
+    return TRUE;
+}
+
+bool lookupSpline(const struct SplineTable &table, union State veh, union State goal, union Spline *curvature)
+{
+    if(table.splines.empty())
+    {
+        return FALSE;
+    }
+
+    // Goal relative to the vehicle
+    double dx = goal.sx - veh.sx;
+    double dy = goal.sy - veh.sy;
+    double value[SPLINE_TABLE_AXES];
+    value[0] = cos(veh.theta)*dx + sin(veh.theta)*dy;
+    value[1] = -sin(veh.theta)*dx + cos(veh.theta)*dy;
+    value[2] = goal.theta - veh.theta;
+    value[3] = goal.v;
+    value[4] = veh.kappa;
+
+    // Lower sample and interpolation weight of the upper sample on each axis
+    int lower[SPLINE_TABLE_AXES];
+    double weight[SPLINE_TABLE_AXES];
+    for(int axis = 0; axis < SPLINE_TABLE_AXES; axis++)
+    {
+        lower[axis] = 0;
+        weight[axis] = 0.0;
+        if(table.size[axis] < 2)
+        {
+            continue;
+        }
+
+        double u = (value[axis] - table.min[axis]) / (table.max[axis] - table.min[axis]) * (table.size[axis] - 1);
+        if(!(u >= 0.0 && u <= table.size[axis] - 1))
+        {
+            return FALSE;
+        }
+        lower[axis] = min((int)u, table.size[axis] - 2);
+        weight[axis] = u - lower[axis];
+    }
+
+    // Multilinear interpolation over the corners which converged
+    double sum[3] = {0.0, 0.0, 0.0};
+    double total_weight = 0.0;
+    for(int corner = 0; corner < (1 << SPLINE_TABLE_AXES); corner++)
+    {
+        double w = 1.0;
+        size_t index = 0;
+        size_t stride = 1;
+        for(int axis = 0; axis < SPLINE_TABLE_AXES; axis++)
+        {
+            int upper = (corner >> axis) & 1;
+            if(upper && table.size[axis] < 2)
+            {
+                w = 0.0;
+                break;
+            }
+            w *= upper ? weight[axis] : 1.0 - weight[axis];
+            index += (lower[axis] + upper) * stride;
+            stride *= table.size[axis];
+        }
+
+        if(w > 0.0 && table.splines[index].success == TRUE)
+        {
+            sum[0] += w * table.splines[index].s;
+            sum[1] += w * table.splines[index].kappa_1;
+            sum[2] += w * table.splines[index].kappa_2;
+            total_weight += w;
+        }
+    }
+
+    // Too close to entries where the solver failed
+    if(total_weight < 0.5)
+    {
+        return FALSE;
+    }
+
+    curvature->s = sum[0] / total_weight;
+    curvature->kappa_1 = sum[1] / total_weight;
+    curvature->kappa_2 = sum[2] / total_weight;
+    curvature->kappa_0 = veh.kappa;
+    curvature->kappa_3 = goal.kappa;
+    curvature->success = TRUE;
+    return TRUE;
+}
+
+// ------------BATCH GENERATION----------//
+// Solves a lattice of goal states in parallel
+// INPUT: Current vehicle state, goal states, optional lookup table, iteration limit, optional fallback seed
+// OUTPUT: One spline per goal state and convergence statistics
+
+struct BatchStats generateTrajectories(union State veh, const std::vector<union State> &goals, const struct SplineTable *table, int max_iterations, std::vector<union Spline> *splines, const union Spline *seed)
+{
+    const int count = goals.size();
+    splines->resize(count);
+
+    int converged = 0;
+    int warm_started = 0;
+    int iterations = 0;
+    int max_iteration = 0;
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:converged, warm_started, iterations) reduction(max:max_iteration)
+    for(int i = 0; i < count; i++)
+    {
+        union Spline curvature;
+        if(table != NULL && lookupSpline(*table, veh, goals[i], &curvature))
+        {
+            warm_started++;
+        }
+        else
+        {
+            curvature = seed != NULL ? *seed : initParams(veh, goals[i]);
+        }
+
+        int iteration = 0;
+        curvature = solveSpline(veh, goals[i], curvature, max_iterations, &iteration);
+        (*splines)[i] = curvature;
+
+        converged += curvature.success ? 1 : 0;
+        iterations += iteration;
+        max_iteration = max(max_iteration, iteration);
+    }
+
+    struct BatchStats stats;
+    stats.goals = count;
+    stats.converged = converged;
+    stats.warm_started = warm_started;
+    stats.iterations = iterations;
+    stats.max_iterations = max_iteration;
+    return stats;
+}
+
 //------------------MAIN FUNCTION AND HELPER FOR STANDALONE OPERATION------------------------//
 
 #ifdef STANDALONE
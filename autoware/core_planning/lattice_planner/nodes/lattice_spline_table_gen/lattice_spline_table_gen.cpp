@@ -0,0 +1,87 @@
+/*
+ *  lattice_spline_table_gen.cpp
+ *  Offline generation of the spline lookup table used by lattice_trajectory_gen
+ *
+ */
+
+/*
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+*/
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+#include "libtraj_gen.h"
+
+// Iteration limit of the offline solver, much larger than the online one
+static const int MAX_ITERATIONS = 20;
+
+// Default grid: dx, dy, dtheta, v and the initial kappa.
+// dx covers the lookahead distances of lattice_trajectory_gen.
+static const int TABLE_SIZE[SPLINE_TABLE_AXES] = {8, 11, 7, 5, 5};
+static const double TABLE_MIN[SPLINE_TABLE_AXES] = {5.0, -8.0, -0.4, 2.0, kmin};
+static const double TABLE_MAX[SPLINE_TABLE_AXES] = {40.0, 8.0, 0.4, 14.0, kmax};
+
+int main(int argc, char **argv)
+{
+    if(argc != 2 && argc != 7)
+    {
+        std::cout << "Usage: rosrun lattice_planner lattice_spline_table_gen output.bin"
+                  << " [size_dx size_dy size_dtheta size_v size_kappa]" << std::endl;
+        return 1;
+    }
+
+    int size[SPLINE_TABLE_AXES];
+    for(int axis = 0; axis < SPLINE_TABLE_AXES; axis++)
+    {
+        size[axis] = (argc == 7) ? atoi(argv[axis + 2]) : TABLE_SIZE[axis];
+    }
+
+    struct SplineTable table;
+    initSplineTable(&table, size, TABLE_MIN, TABLE_MAX);
+    std::cout << "Solving " << table.splines.size() << " goal states..." << std::endl;
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    buildSplineTable(&table, MAX_ITERATIONS);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    size_t converged = 0;
+    for(size_t i = 0; i < table.splines.size(); i++)
+    {
+        converged += table.splines[i].success ? 1 : 0;
+    }
+    std::cout << "Converged: " << converged << " / " << table.splines.size() << " in " << seconds << " s" << std::endl;
+
+    if(!saveSplineTable(table, argv[1]))
+    {
+        std::cout << "Couldn't write " << argv[1] << "." << std::endl;
+        return 1;
+    }
+    std::cout << "Output: " << argv[1] << std::endl;
+    return 0;
+}
@@ -93,6 +93,13 @@ static double g_mkz_info_curvature;
 
 static int SPLINE_INDEX=0;
 
+// Iteration limit of the solver, kept low because the guess is usually close
+static const int MAX_ITERATIONS = 4;
+
+// Lookup table used to warm start the solver, see lattice_spline_table_gen
+static struct SplineTable g_spline_table;
+static bool g_use_spline_table = false;
+
 //config topic
 static int g_param_flag = 0; //0 = waypoint, 1 = Dialog
 static double g_lookahead_threshold = 4.0; //meter
@@ -365,50 +372,15 @@ static union State computeVeh(int old_time, double old_theta, int next_waypoint)
 /////////////////////////////////////////////////////////////////
 static union Spline waypointTrajectory(union State veh, union State goal, union Spline curvature, int next_waypoint)
 {
-    curvature.success=TRUE;  
-    bool convergence=FALSE;
     int iteration = 0;
-    union State veh_next;
-    double dt = step_size;
-    veh.v=goal.v;
-
-    // While loop for computing trajectory parameters
-    while(convergence == FALSE && iteration<4)
-    {
-        // Set time horizon
-        double horizon = curvature.s/veh.vdes;
-        ROS_INFO_STREAM("vdes: " << veh.vdes);
-        ROS_INFO_STREAM("horizon: " << horizon);
 
-        // Run motion model
-        veh_next = motionModel(veh, goal, curvature, dt, horizon, 0);
-        
-        // Determine convergence criteria
-        convergence = checkConvergence(veh_next, goal);
+    // Refine the initial guess until the motion model gets us to the goal
+    curvature = solveSpline(veh, goal, curvature, MAX_ITERATIONS, &iteration);
 
-        // If the motion model doesn't get us to the goal compute new parameters
-        if(convergence==FALSE)
-        {
-            // Update parameters
-            curvature = generateCorrection(veh, veh_next, goal, curvature, dt, horizon);
-            iteration++;
-
-            // Escape route for poorly conditioned Jacobian
-            if(curvature.success==FALSE)
-            {
-                ROS_INFO_STREAM("Init State: sx "<<veh.sx<<" sy " <<veh.sy<<" theta "<<veh.theta<<" kappa "<<veh.kappa<<" v "<<veh.v);
-                ROS_INFO_STREAM("Goal State: sx "<<goal.sx<<" sy " <<goal.sy<<" theta "<<goal.theta<<" kappa "<<goal.kappa<<" v"<<goal.v);
-                break;
-            }
-        }    
-    }
-
-    if(convergence==FALSE)
+    if(curvature.success==FALSE)
     {
-      ROS_INFO_STREAM("Next State: sx "<<veh_next.sx<<" sy " <<veh_next.sy<<" theta "<<veh_next.theta<<" kappa "<<veh_next.kappa<<" v "<<veh_next.v);
       ROS_INFO_STREAM("Init State: sx "<<veh.sx<<" sy " <<veh.sy<<" theta "<<veh.theta<<" kappa "<<veh.kappa);
       ROS_INFO_STREAM("Goal State: sx "<<goal.sx<<" sy " <<goal.sy<<" theta "<<goal.theta<<" kappa "<<goal.kappa);
-      curvature.success= FALSE;
     }
 
     else
@@ -419,7 +391,7 @@ static union Spline waypointTrajectory(union State veh, union State goal, union
         // Set time horizon
          double horizon = curvature.s/v_0;
         // Run motion model and log data for plotting
-        veh_next = motionModel(veh, goal, curvature, 0.1, horizon, 1);
+        union State veh_next = motionModel(veh, goal, curvature, 0.1, horizon, 1);
         fmm_sx<<"0.0 \n";
         fmm_sy<<"0.0 \n";
         #endif
@@ -528,6 +500,17 @@ int main(int argc, char **argv)
   ROS_INFO_STREAM("prius_mode : " << g_prius_mode);
   ROS_INFO_STREAM("mkz_mode : " << g_mkz_mode);
 
+  std::string spline_table;
+  private_nh.param<std::string>("spline_table", spline_table, "");
+  if (!spline_table.empty())
+  {
+    g_use_spline_table = loadSplineTable(&g_spline_table, spline_table.c_str());
+    if (g_use_spline_table)
+      ROS_INFO_STREAM("spline_table : " << spline_table << " (" << g_spline_table.splines.size() << " entries)");
+    else
+      ROS_WARN_STREAM("Couldn't load spline_table " << spline_table << ", using the heuristic initial guess");
+  }
+
   // Publish the following topics: 
   g_vis_pub = nh.advertise<visualization_msgs::Marker>("next_waypoint_mark", 1);
   g_stat_pub = nh.advertise<std_msgs::Bool>("wf_stat", 0);
@@ -626,8 +609,12 @@ int main(int argc, char **argv)
             ROS_INFO_STREAM("est kappa: " <<veh_fmm.kappa);
           }
         
-          // Initialize the estimate for the curvature
+          // Initialize the estimate for the curvature, from the lookup table if the goal is in it
           union Spline curvature = initParams(veh, goal);
+          if(g_use_spline_table && lookupSpline(g_spline_table, veh, goal, &curvature))
+          {
+            ROS_INFO_STREAM("Initial guess from spline_table");
+          }
 
           // Generate a cubic spline (trajectory) for the vehicle to follow
           curvature = waypointTrajectory(veh, goal, curvature, next_waypoint);
@@ -674,31 +661,29 @@ int main(int argc, char **argv)
                 ROS_INFO_STREAM("Spline published to RVIZ");
               }
               
-                // This is a messy for loop which generates extra trajectories for visualization
+                // Generates extra trajectories for visualization
                 // Likely will change when valid cost map arrives.
-                // Note: pragma indicates parallelization for OpenMP
-
-                // Setup variables
-                union State tempGoal= goal;
-                int i;
-                union Spline extra;
-                
-                // Tell OpenMP how to parallelize (keep i private because it is a counter)
-                #pragma omp parallel for private(i)
-
-                // Index through all the predefined perturbations from waypoint
-                for(i=1; i<31; i++)
+
+                // Shift the y-coordinate of the goal by the predefined perturbations
+                std::vector<union State> extra_goals(30, goal);
+                for(int i=0; i<30; i++)
                 {
-                  // Shift the y-coordinate of the goal
-                  tempGoal.sy = tempGoal.sy + perturb[i-1];
+                  extra_goals[i].sy = goal.sy + perturb[i];
+                }
 
-                  // Compute new spline 
-                  extra= waypointTrajectory(veh, tempGoal, curvature, next_waypoint);
+                // Compute the new splines in parallel, goals outside of the table start from the converged spline
+                std::vector<union Spline> extra;
+                struct BatchStats stats = generateTrajectories(veh, extra_goals, g_use_spline_table ? &g_spline_table : NULL, MAX_ITERATIONS, &extra, &curvature);
+                ROS_INFO_STREAM("Extra splines converged: " << stats.converged << " / " << stats.goals
+                                << ", warm started: " << stats.warm_started
+                                << ", iterations: " << stats.iterations << " (max " << stats.max_iterations << ")");
 
-                  // Display trajectory
-                  if(veh.v>5.00)
+                // Display trajectories
+                if(veh.v>5.00)
+                {
+                  for(int i=0; i<30; i++)
                   {
-                    drawSpline(extra, veh, i,1);
+                    drawSpline(extra[i], veh, i+1, 1);
                   }
                 }
           }
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <vector>
+#include "libtraj_gen.h"
+
+class TestSuite : public ::testing::Test
+{
+public:
+  TestSuite()
+  {
+  }
+  ~TestSuite()
+  {
+  }
+
+  // Small table around the goals of the tests, dx, dy, dtheta, v and the initial kappa
+  static void buildTable(struct SplineTable *table)
+  {
+    const int size[SPLINE_TABLE_AXES] = {4, 5, 3, 2, 1};
+    const double min[SPLINE_TABLE_AXES] = {10.0, -4.0, -0.2, 5.0, 0.0};
+    const double max[SPLINE_TABLE_AXES] = {25.0, 4.0, 0.2, 10.0, 0.0};
+    initSplineTable(table, size, min, max);
+    buildSplineTable(table, 20);
+  }
+
+  static union State createState(double sx, double sy, double theta, double v)
+  {
+    union State state = {};
+    state.sx = sx;
+    state.sy = sy;
+    state.theta = theta;
+    state.v = v;
+    state.vdes = v;
+    return state;
+  }
+};
+
+TEST_F(TestSuite, solveSpline_table_seed_needs_fewer_iterations)
+{
+  struct SplineTable table;
+  buildTable(&table);
+
+  union State veh = createState(0.0, 0.0, 0.0, 7.0);
+  int table_iterations = 0;
+  int init_iterations = 0;
+  for (double sx = 12.0; sx < 24.0; sx += 3.0)
+  {
+    for (double sy = -3.0; sy <= 3.0; sy += 1.5)
+    {
+      union State goal = createState(sx, sy, 0.1 * sy / 3.0, 7.0);
+
+      union Spline seed;
+      ASSERT_TRUE(lookupSpline(table, veh, goal, &seed));
+      int iterations = 0;
+      union Spline from_table = solveSpline(veh, goal, seed, 10, &iterations);
+      ASSERT_TRUE(from_table.success);
+      table_iterations += iterations;
+
+      union Spline from_init = solveSpline(veh, goal, initParams(veh, goal), 10, &iterations);
+      ASSERT_TRUE(from_init.success);
+      init_iterations += iterations;
+    }
+  }
+  ASSERT_LT(table_iterations, init_iterations);
+}
+
+TEST_F(TestSuite, generateTrajectories_uses_seed_when_table_misses)
+{
+  union State veh = createState(0.0, 0.0, 0.0, 7.0);
+  union State goal = createState(18.0, 1.0, 0.05, 7.0);
+  int iterations = 0;
+  union Spline curvature = solveSpline(veh, goal, initParams(veh, goal), 20, &iterations);
+  ASSERT_TRUE(curvature.success);
+
+  // The goal shifted sideways as for the visualization splines, there is no table
+  std::vector<union State> goals(10, goal);
+  for (int i = 0; i < 10; i++)
+  {
+    goals[i].sy = goal.sy + 0.1 * (i - 5);
+  }
+
+  std::vector<union Spline> splines;
+  struct BatchStats cold = generateTrajectories(veh, goals, NULL, 10, &splines);
+  struct BatchStats seeded = generateTrajectories(veh, goals, NULL, 10, &splines, &curvature);
+  ASSERT_EQ(0, seeded.warm_started);
+  ASSERT_EQ(seeded.goals, seeded.converged);
+  ASSERT_LT(seeded.iterations, cold.iterations);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file mpc_condensed_matrix.h
+ * @brief condensed MPC matrix generation exploiting the stage-wise block structure
+ */
+
+/*
+ *    Stage-wise model (i = 0, ..., N-1)
+ * x_i = Ad_i * x_i-1 + Bd_i * u_i + Wd_i,  (x_-1 = x0)
+ * y_i = Cd_i * x_i
+ *
+ *    Cost function
+ * J = sum_i { y_i' * Q_i * y_i + (u_i - uref_i)' * R_i * (u_i - uref_i) } + lateral jerk term
+ *
+ *    Condensed QP
+ * J = 1/2 * U' * H * U + f' * U
+ *
+ * The dense formulation (H = Bex' * Cex' * Qex * Cex * Bex + Rex) costs O(N^3).
+ * Here each column of H is built with one forward recursion of the input response
+ * G_i,k = Ad_i * G_i-1,k and one backward (adjoint) recursion
+ * L_i,k = Cd_i' * Q_i * Cd_i * G_i,k + Ad_i+1' * L_i+1,k, giving H(i,k) = Bd_i' * L_i,k in O(N^2).
+ * All workspace is allocated once in resize() and reused for every control cycle.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <eigen3/Eigen/Core>
+
+/**
+ * @class condensed MPC matrix
+ * @brief hold per-stage model matrices and build the condensed QP matrices H and f
+ */
+class MPCCondensedMatrix
+{
+public:
+  /**
+   * @brief constructor
+   */
+  MPCCondensedMatrix();
+
+  /**
+   * @brief allocate all workspace for given horizon and model dimensions (no-op if unchanged)
+   * @param [in] horizon prediction horizon step
+   * @param [in] dimx dimension of state x
+   * @param [in] dimu dimension of input u
+   * @param [in] dimy dimension of output y
+   */
+  void resize(const int horizon, const int dimx, const int dimu, const int dimy);
+
+  /**
+   * @brief reset lateral jerk weight to zero (stage matrices are overwritten every cycle)
+   */
+  void clearJerkWeight();
+
+  /**
+   * @brief build condensed hessian H and gradient f from stage matrices
+   * @param [in] x0 initial state
+   */
+  void build(const Eigen::VectorXd &x0);
+
+  /**
+   * @brief predict state sequence Xex = Aex * x0 + Bex * Uex + Wex by forward recursion
+   * @param [in] x0 initial state
+   * @param [in] Uex input sequence
+   * @param [out] Xex predicted state sequence
+   */
+  void predict(const Eigen::VectorXd &x0, const Eigen::VectorXd &Uex, Eigen::VectorXd &Xex) const;
+
+  /**
+   * @brief check if stage model matrices include NaN
+   * @return true if NaN is found
+   */
+  bool hasNaN() const;
+
+  int N;                                 //!< @brief prediction horizon step
+  int dim_x;                             //!< @brief dimension of state x
+  int dim_u;                             //!< @brief dimension of input u
+  int dim_y;                             //!< @brief dimension of output y
+  std::vector<Eigen::MatrixXd> Ad;       //!< @brief discrete state matrix for each stage
+  std::vector<Eigen::MatrixXd> Bd;       //!< @brief discrete input matrix for each stage
+  std::vector<Eigen::MatrixXd> Cd;       //!< @brief output matrix for each stage
+  std::vector<Eigen::MatrixXd> Wd;       //!< @brief discrete disturbance vector for each stage
+  std::vector<Eigen::MatrixXd> Q;        //!< @brief output weight for each stage
+  std::vector<Eigen::MatrixXd> R;        //!< @brief input weight for each stage
+  std::vector<Eigen::MatrixXd> Uref;     //!< @brief reference (feed-forward) input for each stage
+  std::vector<double> jerk_weight;       //!< @brief lateral jerk weight between input i and i+1
+
+  Eigen::MatrixXd H;                     //!< @brief condensed hessian (DIM_U*N x DIM_U*N)
+  Eigen::MatrixXd f;                     //!< @brief condensed gradient (DIM_U*N x 1)
+
+private:
+  std::vector<Eigen::MatrixXd> Qx_;      //!< @brief state weight Cd' * Q * Cd for each stage
+  std::vector<Eigen::MatrixXd> G_;       //!< @brief input response of one column for each stage
+  Eigen::MatrixXd L_;                    //!< @brief adjoint of input response
+  Eigen::MatrixXd L_tmp_;                //!< @brief buffer for adjoint update
+  Eigen::MatrixXd QC_;                   //!< @brief buffer for Q * Cd
+  Eigen::VectorXd xf_;                   //!< @brief free response (zero input) state
+  Eigen::VectorXd xf_tmp_;               //!< @brief buffer for free response update
+  Eigen::VectorXd lam_;                  //!< @brief adjoint of free response
+  Eigen::VectorXd lam_tmp_;              //!< @brief buffer for adjoint update
+  std::vector<Eigen::VectorXd> xfree_;   //!< @brief free response for each stage
+};
@@ -49,11 +49,13 @@
 #include "mpc_follower/mpc_utils.h"
 #include "mpc_follower/mpc_trajectory.h"
 #include "mpc_follower/lowpass_filter.h"
+#include "mpc_follower/mpc_condensed_matrix.h"
 #include "mpc_follower/vehicle_model/vehicle_model_bicycle_kinematics.h"
 #include "mpc_follower/vehicle_model/vehicle_model_bicycle_dynamics.h"
 #include "mpc_follower/vehicle_model/vehicle_model_bicycle_kinematics_no_delay.h"
 #include "mpc_follower/qp_solver/qp_solver_unconstr.h"
 #include "mpc_follower/qp_solver/qp_solver_unconstr_fast.h"
+#include "mpc_follower/qp_solver/qp_solver_unconstr_condensed.h"
 #include "mpc_follower/qp_solver/qp_solver_qpoases.h"
 
 /** 
@@ -93,6 +95,15 @@ private:
   std::shared_ptr<QPSolverInterface> qpsolver_ptr_;          //!< @brief qp solver for MPC
   std::string output_interface_;                             //!< @brief output command type
   std::deque<double> input_buffer_;                          //!< @brief control input (mpc_output) buffer for delay time conpemsation
+  MPCCondensedMatrix mpc_matrix_;                            //!< @brief preallocated stage matrices and condensed QP matrices
+
+  /* preallocated QP constraint matrices and solution, reused every control cycle */
+  Eigen::MatrixXd qp_A_;   //!< @brief constraint matrix for lbA < A*U < ubA
+  Eigen::MatrixXd qp_lbA_; //!< @brief lower bound for lbA < A*U < ubA
+  Eigen::MatrixXd qp_ubA_; //!< @brief upper bound for lbA < A*U < ubA
+  Eigen::VectorXd qp_lb_;  //!< @brief lower bound for lb < U < ub
+  Eigen::VectorXd qp_ub_;  //!< @brief upper bound for lb < U < ub
+  Eigen::VectorXd qp_U_;   //!< @brief optimal input sequence
 
   /* parameters for control*/
   double ctrl_period_;              //!< @brief control frequency [s]
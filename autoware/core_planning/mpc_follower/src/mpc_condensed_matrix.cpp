@@ -0,0 +1,151 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mpc_follower/mpc_condensed_matrix.h"
+
+MPCCondensedMatrix::MPCCondensedMatrix() : N(0), dim_x(0), dim_u(0), dim_y(0){};
+
+void MPCCondensedMatrix::resize(const int horizon, const int dimx, const int dimu, const int dimy)
+{
+  if (N == horizon && dim_x == dimx && dim_u == dimu && dim_y == dimy)
+    return;
+
+  N = horizon;
+  dim_x = dimx;
+  dim_u = dimu;
+  dim_y = dimy;
+
+  Ad.assign(N, Eigen::MatrixXd::Zero(dim_x, dim_x));
+  Bd.assign(N, Eigen::MatrixXd::Zero(dim_x, dim_u));
+  Cd.assign(N, Eigen::MatrixXd::Zero(dim_y, dim_x));
+  Wd.assign(N, Eigen::MatrixXd::Zero(dim_x, 1));
+  Q.assign(N, Eigen::MatrixXd::Zero(dim_y, dim_y));
+  R.assign(N, Eigen::MatrixXd::Zero(dim_u, dim_u));
+  Uref.assign(N, Eigen::MatrixXd::Zero(dim_u, 1));
+  jerk_weight.assign(N, 0.0);
+
+  H = Eigen::MatrixXd::Zero(dim_u * N, dim_u * N);
+  f = Eigen::MatrixXd::Zero(dim_u * N, 1);
+
+  Qx_.assign(N, Eigen::MatrixXd::Zero(dim_x, dim_x));
+  G_.assign(N, Eigen::MatrixXd::Zero(dim_x, dim_u));
+  L_ = Eigen::MatrixXd::Zero(dim_x, dim_u);
+  L_tmp_ = Eigen::MatrixXd::Zero(dim_x, dim_u);
+  QC_ = Eigen::MatrixXd::Zero(dim_y, dim_x);
+  xf_ = Eigen::VectorXd::Zero(dim_x);
+  xf_tmp_ = Eigen::VectorXd::Zero(dim_x);
+  lam_ = Eigen::VectorXd::Zero(dim_x);
+  lam_tmp_ = Eigen::VectorXd::Zero(dim_x);
+  xfree_.assign(N, Eigen::VectorXd::Zero(dim_x));
+}
+
+void MPCCondensedMatrix::clearJerkWeight()
+{
+  std::fill(jerk_weight.begin(), jerk_weight.end(), 0.0);
+}
+
+void MPCCondensedMatrix::build(const Eigen::VectorXd &x0)
+{
+  /* state weight and free response: xf_i = Ad_i * xf_i-1 + Wd_i */
+  xf_ = x0;
+  for (int i = 0; i < N; ++i)
+  {
+    QC_.noalias() = Q[i] * Cd[i];
+    Qx_[i].noalias() = Cd[i].transpose() * QC_;
+
+    xf_tmp_.noalias() = Ad[i] * xf_;
+    xf_tmp_ += Wd[i];
+    xf_.swap(xf_tmp_);
+    xfree_[i] = xf_;
+  }
+
+  /* hessian : one forward and one backward recursion per column k (lower triangle) */
+  for (int k = 0; k < N; ++k)
+  {
+    G_[k] = Bd[k];
+    for (int i = k + 1; i < N; ++i)
+    {
+      G_[i].noalias() = Ad[i] * G_[i - 1];
+    }
+
+    L_.noalias() = Qx_[N - 1] * G_[N - 1];
+    for (int i = N - 1; i >= k; --i)
+    {
+      if (i < N - 1)
+      {
+        L_tmp_.noalias() = Qx_[i] * G_[i];
+        L_tmp_.noalias() += Ad[i + 1].transpose() * L_;
+        L_.swap(L_tmp_);
+      }
+      H.block(i * dim_u, k * dim_u, dim_u, dim_u).noalias() = Bd[i].transpose() * L_;
+    }
+  }
+  for (int k = 0; k < N; ++k)
+  {
+    H.block(k * dim_u, k * dim_u, dim_u, dim_u) += R[k];
+  }
+
+  /* gradient : f = Bex' * Cex' * Qex * Cex * (Aex * x0 + Wex) - Rex * Urefex */
+  lam_.noalias() = Qx_[N - 1] * xfree_[N - 1];
+  for (int i = N - 1; i >= 0; --i)
+  {
+    if (i < N - 1)
+    {
+      lam_tmp_.noalias() = Qx_[i] * xfree_[i];
+      lam_tmp_.noalias() += Ad[i + 1].transpose() * lam_;
+      lam_.swap(lam_tmp_);
+    }
+    f.block(i * dim_u, 0, dim_u, 1).noalias() = Bd[i].transpose() * lam_;
+    f.block(i * dim_u, 0, dim_u, 1).noalias() -= R[i] * Uref[i];
+  }
+
+  /* lateral jerk : weight for {u(i) - u(i+1)}^2, applied on the same indices as the dense Rex */
+  for (int i = 0; i < N - 1; ++i)
+  {
+    const double w = jerk_weight[i];
+    H(i, i) += w;
+    H(i + 1, i) -= w;
+    H(i + 1, i + 1) += w;
+    f(i, 0) -= w * (Uref[i / dim_u](i % dim_u, 0) - Uref[(i + 1) / dim_u]((i + 1) % dim_u, 0));
+    f(i + 1, 0) -= w * (Uref[(i + 1) / dim_u]((i + 1) % dim_u, 0) - Uref[i / dim_u](i % dim_u, 0));
+  }
+
+  H.triangularView<Eigen::StrictlyUpper>() = H.transpose();
+}
+
+void MPCCondensedMatrix::predict(const Eigen::VectorXd &x0, const Eigen::VectorXd &Uex, Eigen::VectorXd &Xex) const
+{
+  Xex.resize(dim_x * N);
+  Xex.segment(0, dim_x).noalias() = Ad[0] * x0 + Bd[0] * Uex.segment(0, dim_u);
+  Xex.segment(0, dim_x) += Wd[0];
+  for (int i = 1; i < N; ++i)
+  {
+    Xex.segment(i * dim_x, dim_x).noalias() =
+        Ad[i] * Xex.segment((i - 1) * dim_x, dim_x) + Bd[i] * Uex.segment(i * dim_u, dim_u);
+    Xex.segment(i * dim_x, dim_x) += Wd[i];
+  }
+}
+
+bool MPCCondensedMatrix::hasNaN() const
+{
+  for (int i = 0; i < N; ++i)
+  {
+    if (Ad[i].array().isNaN().any() || Bd[i].array().isNaN().any() ||
+        Cd[i].array().isNaN().any() || Wd[i].array().isNaN().any())
+      return true;
+  }
+  return false;
+}
@@ -96,6 +96,11 @@ MPCFollower::MPCFollower()
     qpsolver_ptr_ = std::make_shared<QPSolverEigenLeastSquareLLT>();
     ROS_INFO("[MPC] set qp solver = unconstraint_fast");
   }
+  else if (qp_solver_type_ == "unconstraint_condensed")
+  {
+    qpsolver_ptr_ = std::make_shared<QPSolverEigenCondensedLLT>();
+    ROS_INFO("[MPC] set qp solver = unconstraint_condensed");
+  }
   else if (qp_solver_type_ == "qpoases_hotstart")
   {
     int max_iter;
@@ -282,7 +287,6 @@ bool MPCFollower::calculateMPC(double &vel_cmd, double &acc_cmd, double &steer_c
   Eigen::MatrixXd Bd(DIM_X, DIM_U);
   Eigen::MatrixXd Wd(DIM_X, 1);
   Eigen::MatrixXd Cd(DIM_Y, DIM_X);
-  Eigen::MatrixXd Uref(DIM_U, 1);
 
   Eigen::MatrixXd x_curr = x0;
   double mpc_curr_time = mpc_start_time;
@@ -314,21 +318,16 @@ bool MPCFollower::calculateMPC(double &vel_cmd, double &acc_cmd, double &steer_c
    * predict equation: Xec = Aex * x0 + Bex * Uex + Wex
    * cost function: J = Xex' * Qex * Xex + (Uex - Uref)' * Rex * (Uex - Urefex)
    * Qex = diag([Q,Q,...]), Rex = diag([R,R,...])
+   *
+   * The extended matrices are not formed explicitly. Stage matrices are stored in the preallocated
+   * mpc_matrix_ and the condensed hessian is built recursively with the block structure (see mpc_condensed_matrix.h).
    */
-
-  Eigen::MatrixXd Aex = Eigen::MatrixXd::Zero(DIM_X * N, DIM_X);
-  Eigen::MatrixXd Bex = Eigen::MatrixXd::Zero(DIM_X * N, DIM_U * N);
-  Eigen::MatrixXd Wex = Eigen::MatrixXd::Zero(DIM_X * N, 1);
-  Eigen::MatrixXd Cex = Eigen::MatrixXd::Zero(DIM_Y * N, DIM_X * N);
-  Eigen::MatrixXd Qex = Eigen::MatrixXd::Zero(DIM_Y * N, DIM_Y * N);
-  Eigen::MatrixXd Rex = Eigen::MatrixXd::Zero(DIM_U * N, DIM_U * N);
-  Eigen::MatrixXd Urefex = Eigen::MatrixXd::Zero(DIM_U * N, 1);
+  mpc_matrix_.resize(N, DIM_X, DIM_U, DIM_Y);
+  mpc_matrix_.clearJerkWeight();
 
   /* weight matrix depends on the vehicle model */
   Eigen::MatrixXd Q = Eigen::MatrixXd::Zero(DIM_Y, DIM_Y);
   Eigen::MatrixXd R = Eigen::MatrixXd::Zero(DIM_U, DIM_U);
-  Eigen::MatrixXd Q_adaptive = Eigen::MatrixXd::Zero(DIM_Y, DIM_Y);
-  Eigen::MatrixXd R_adaptive = Eigen::MatrixXd::Zero(DIM_U, DIM_U);
   Q(0, 0) = mpc_param_.weight_lat_error;
   Q(1, 1) = mpc_param_.weight_heading_error;
   R(0, 0) = mpc_param_.weight_steering_input;
@@ -356,8 +355,11 @@ bool MPCFollower::calculateMPC(double &vel_cmd, double &acc_cmd, double &steer_c
     /* get discrete state matrix A, B, C, W */
     vehicle_model_ptr_->setVelocity(ref_vx);
     vehicle_model_ptr_->setCurvature(ref_k);
-    vehicle_model_ptr_->calculateDiscreteMatrix(Ad, Bd, Cd, Wd, DT);
+    vehicle_model_ptr_->calculateDiscreteMatrix(mpc_matrix_.Ad[i], mpc_matrix_.Bd[i], mpc_matrix_.Cd[i],
+                                                mpc_matrix_.Wd[i], DT);
 
+    Eigen::MatrixXd &Q_adaptive = mpc_matrix_.Q[i];
+    Eigen::MatrixXd &R_adaptive = mpc_matrix_.R[i];
     Q_adaptive = Q;
     R_adaptive = R;
     if (i == N - 1)
@@ -368,41 +370,14 @@ bool MPCFollower::calculateMPC(double &vel_cmd, double &acc_cmd, double &steer_c
     Q_adaptive(1, 1) += ref_vx_squared * mpc_param_.weight_heading_error_squared_vel_coeff;
     R_adaptive(0, 0) += ref_vx_squared * mpc_param_.weight_steering_input_squared_vel_coeff;
 
-    /* update mpc matrix */
-    int idx_x_i = i * DIM_X;
-    int idx_x_i_prev = (i - 1) * DIM_X;
-    int idx_u_i = i * DIM_U;
-    int idx_y_i = i * DIM_Y;
-    if (i == 0)
-    {
-      Aex.block(0, 0, DIM_X, DIM_X) = Ad;
-      Bex.block(0, 0, DIM_X, DIM_U) = Bd;
-      Wex.block(0, 0, DIM_X, 1) = Wd;
-    }
-    else
-    {
-      Aex.block(idx_x_i, 0, DIM_X, DIM_X) = Ad * Aex.block(idx_x_i_prev, 0, DIM_X, DIM_X);
-      for (int j = 0; j < i; ++j)
-      {
-        int idx_u_j = j * DIM_U;
-        Bex.block(idx_x_i, idx_u_j, DIM_X, DIM_U) = Ad * Bex.block(idx_x_i_prev, idx_u_j, DIM_X, DIM_U);
-      }
-      Wex.block(idx_x_i, 0, DIM_X, 1) = Ad * Wex.block(idx_x_i_prev, 0, DIM_X, 1) + Wd;
-    }
-    Bex.block(idx_x_i, idx_u_i, DIM_X, DIM_U) = Bd;
-    Cex.block(idx_y_i, idx_x_i, DIM_Y, DIM_X) = Cd;
-    Qex.block(idx_y_i, idx_y_i, DIM_Y, DIM_Y) = Q_adaptive;
-    Rex.block(idx_u_i, idx_u_i, DIM_U, DIM_U) = R_adaptive;
-
     /* get reference input (feed-forward) */
-    vehicle_model_ptr_->calculateReferenceInput(Uref);
-    if (std::fabs(Uref(0, 0)) < amathutils::deg2rad(mpc_param_.zero_ff_steer_deg))
+    Eigen::MatrixXd &Uref_i = mpc_matrix_.Uref[i];
+    vehicle_model_ptr_->calculateReferenceInput(Uref_i);
+    if (std::fabs(Uref_i(0, 0)) < amathutils::deg2rad(mpc_param_.zero_ff_steer_deg))
     {
-      Uref(0, 0) = 0.0; // ignore curvature noise
+      Uref_i(0, 0) = 0.0; // ignore curvature noise
     }
 
-    Urefex.block(i * DIM_U, 0, DIM_U, 1) = Uref;
-
     mpc_curr_time += DT;
   }
 
@@ -410,15 +385,10 @@ bool MPCFollower::calculateMPC(double &vel_cmd, double &acc_cmd, double &steer_c
   for (int i = 0; i < N - 1; ++i)
   {
     const double v = mpc_resampled_ref_traj.vx[i];
-    const double lateral_jerk_weight = v * v * mpc_param_.weight_lat_jerk;
-    Rex(i, i) += lateral_jerk_weight;
-    Rex(i + 1, i) -= lateral_jerk_weight;
-    Rex(i, i + 1) -= lateral_jerk_weight;
-    Rex(i + 1, i + 1) += lateral_jerk_weight;
+    mpc_matrix_.jerk_weight[i] = v * v * mpc_param_.weight_lat_jerk;
   }
 
-  if (Aex.array().isNaN().any() || Bex.array().isNaN().any() ||
-      Cex.array().isNaN().any() || Wex.array().isNaN().any())
+  if (mpc_matrix_.hasNaN())
   {
     ROS_WARN("[MPC] calculateMPC: model matrix includes NaN, stop MPC.");
     return false;
@@ -429,25 +399,22 @@ bool MPCFollower::calculateMPC(double &vel_cmd, double &acc_cmd, double &steer_c
    * solve quadratic optimization.
    * cost function: 1/2 * Uex' * H * Uex + f' * Uex
    */
-  const Eigen::MatrixXd CB = Cex * Bex;
-  const Eigen::MatrixXd QCB = Qex * CB;
-  Eigen::MatrixXd H = Eigen::MatrixXd::Zero(DIM_U * N, DIM_U * N);
-  H.triangularView<Eigen::Upper>() = CB.transpose() * QCB; // NOTE: This calculation is very heavy. searching for a good way...
-  H.triangularView<Eigen::Upper>() += Rex;
-  H.triangularView<Eigen::Lower>() = H.transpose();
-  Eigen::MatrixXd f = (Cex * (Aex * x0 + Wex)).transpose() * QCB - Urefex.transpose() * Rex;
+  mpc_matrix_.build(x0);
 
   /* constraint matrix : lb < U < ub, lbA < A*U < ubA */
   const double u_lim = amathutils::deg2rad(steer_lim_deg_);
-  Eigen::MatrixXd A = Eigen::MatrixXd::Zero(DIM_U * N, DIM_U * N);
-  Eigen::MatrixXd lbA = Eigen::MatrixXd::Zero(DIM_U * N, 1);
-  Eigen::MatrixXd ubA = Eigen::MatrixXd::Zero(DIM_U * N, 1);
-  Eigen::VectorXd lb = Eigen::VectorXd::Constant(DIM_U * N, -u_lim); // min steering angle
-  Eigen::VectorXd ub = Eigen::VectorXd::Constant(DIM_U * N, u_lim);  // max steering angle
+  if (qp_A_.rows() != DIM_U * N)
+  {
+    qp_A_ = Eigen::MatrixXd::Zero(DIM_U * N, DIM_U * N);
+    qp_lbA_ = Eigen::MatrixXd::Zero(DIM_U * N, 1);
+    qp_ubA_ = Eigen::MatrixXd::Zero(DIM_U * N, 1);
+  }
+  qp_lb_.setConstant(DIM_U * N, -u_lim); // min steering angle
+  qp_ub_.setConstant(DIM_U * N, u_lim);  // max steering angle
 
   auto start = std::chrono::system_clock::now();
-  Eigen::VectorXd Uex;
-  if (!qpsolver_ptr_->solve(H, f.transpose(), A, lb, ub, lbA, ubA, Uex))
+  Eigen::VectorXd &Uex = qp_U_;
+  if (!qpsolver_ptr_->solve(mpc_matrix_.H, mpc_matrix_.f, qp_A_, qp_lb_, qp_ub_, qp_lbA_, qp_ubA_, Uex))
   {
     ROS_WARN("[MPC] qp solver error");
     return false;
@@ -487,7 +454,8 @@ bool MPCFollower::calculateMPC(double &vel_cmd, double &acc_cmd, double &steer_c
   ////////////////// DEBUG ///////////////////
 
   /* calculate predicted trajectory */
-  Eigen::VectorXd Xex = Aex * x0 + Bex * Uex + Wex;
+  Eigen::VectorXd Xex;
+  mpc_matrix_.predict(x0, Uex, Xex);
   MPCTrajectory debug_mpc_predicted_traj;
   for (int i = 0; i < N; ++i)
   {
@@ -513,7 +481,7 @@ bool MPCFollower::calculateMPC(double &vel_cmd, double &acc_cmd, double &steer_c
     std_msgs::Float64MultiArray debug_values;
     debug_values.data.push_back(steer_cmd);                                      // [0] final steering command (MPC + LPF)
     debug_values.data.push_back(u_sat);                                          // [1] mpc calculation result
-    debug_values.data.push_back(Urefex(0));                                      // [2] feedforward steering value
+    debug_values.data.push_back(mpc_matrix_.Uref[0](0, 0));                     // [2] feedforward steering value
     debug_values.data.push_back(std::atan(nearest_k * wheelbase_));              // [3] feedforward steering value raw
     debug_values.data.push_back(steer);                                          // [4] current steering angle
     debug_values.data.push_back(err_lat);                                        // [5] lateral error
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "mpc_follower/mpc_condensed_matrix.h"
+#include "mpc_follower/vehicle_model/vehicle_model_bicycle_kinematics.h"
+#include "mpc_follower/vehicle_model/vehicle_model_bicycle_dynamics.h"
+#include "mpc_follower/qp_solver/qp_solver_unconstr_fast.h"
+#include "mpc_follower/qp_solver/qp_solver_unconstr_condensed.h"
+
+class TestSuite : public ::testing::Test
+{
+public:
+  TestSuite() {}
+  ~TestSuite() {}
+};
+
+/* fill stage matrices along a curved path with varying velocity */
+void setStageMatrices(VehicleModelInterface &model, MPCCondensedMatrix &m, const double dt)
+{
+  for (int i = 0; i < m.N; ++i)
+  {
+    const double v = 3.0 + 0.1 * i;
+    model.setVelocity(v);
+    model.setCurvature(0.05 * std::sin(0.1 * i));
+    model.calculateDiscreteMatrix(m.Ad[i], m.Bd[i], m.Cd[i], m.Wd[i], dt);
+    model.calculateReferenceInput(m.Uref[i]);
+    m.Q[i] = Eigen::MatrixXd::Identity(m.dim_y, m.dim_y) * (1.0 + 0.01 * i);
+    m.R[i] = Eigen::MatrixXd::Identity(m.dim_u, m.dim_u) * (1.0 + 0.25 * v * v);
+    m.jerk_weight[i] = (i < m.N - 1) ? 0.1 * v * v : 0.0;
+  }
+}
+
+/* reference : dense extended matrices as formed by the original implementation */
+void buildDense(const MPCCondensedMatrix &m, const Eigen::VectorXd &x0, Eigen::MatrixXd &H, Eigen::MatrixXd &f,
+                Eigen::MatrixXd &Aex, Eigen::MatrixXd &Bex, Eigen::MatrixXd &Wex)
+{
+  const int N = m.N, DIM_X = m.dim_x, DIM_U = m.dim_u, DIM_Y = m.dim_y;
+  Aex = Eigen::MatrixXd::Zero(DIM_X * N, DIM_X);
+  Bex = Eigen::MatrixXd::Zero(DIM_X * N, DIM_U * N);
+  Wex = Eigen::MatrixXd::Zero(DIM_X * N, 1);
+  Eigen::MatrixXd Cex = Eigen::MatrixXd::Zero(DIM_Y * N, DIM_X * N);
+  Eigen::MatrixXd Qex = Eigen::MatrixXd::Zero(DIM_Y * N, DIM_Y * N);
+  Eigen::MatrixXd Rex = Eigen::MatrixXd::Zero(DIM_U * N, DIM_U * N);
+  Eigen::MatrixXd Urefex = Eigen::MatrixXd::Zero(DIM_U * N, 1);
+  for (int i = 0; i < N; ++i)
+  {
+    const int idx_x_i = i * DIM_X;
+    const int idx_x_i_prev = (i - 1) * DIM_X;
+    const int idx_u_i = i * DIM_U;
+    const int idx_y_i = i * DIM_Y;
+    if (i == 0)
+    {
+      Aex.block(0, 0, DIM_X, DIM_X) = m.Ad[i];
+      Wex.block(0, 0, DIM_X, 1) = m.Wd[i];
+    }
+    else
+    {
+      Aex.block(idx_x_i, 0, DIM_X, DIM_X) = m.Ad[i] * Aex.block(idx_x_i_prev, 0, DIM_X, DIM_X);
+      for (int j = 0; j < i; ++j)
+      {
+        const int idx_u_j = j * DIM_U;
+        Bex.block(idx_x_i, idx_u_j, DIM_X, DIM_U) = m.Ad[i] * Bex.block(idx_x_i_prev, idx_u_j, DIM_X, DIM_U);
+      }
+      Wex.block(idx_x_i, 0, DIM_X, 1) = m.Ad[i] * Wex.block(idx_x_i_prev, 0, DIM_X, 1) + m.Wd[i];
+    }
+    Bex.block(idx_x_i, idx_u_i, DIM_X, DIM_U) = m.Bd[i];
+    Cex.block(idx_y_i, idx_x_i, DIM_Y, DIM_X) = m.Cd[i];
+    Qex.block(idx_y_i, idx_y_i, DIM_Y, DIM_Y) = m.Q[i];
+    Rex.block(idx_u_i, idx_u_i, DIM_U, DIM_U) = m.R[i];
+    Urefex.block(idx_u_i, 0, DIM_U, 1) = m.Uref[i];
+  }
+  for (int i = 0; i < N - 1; ++i)
+  {
+    Rex(i, i) += m.jerk_weight[i];
+    Rex(i + 1, i) -= m.jerk_weight[i];
+    Rex(i, i + 1) -= m.jerk_weight[i];
+    Rex(i + 1, i + 1) += m.jerk_weight[i];
+  }
+  const Eigen::MatrixXd CB = Cex * Bex;
+  const Eigen::MatrixXd QCB = Qex * CB;
+  H = CB.transpose() * QCB + Rex;
+  f = ((Cex * (Aex * x0 + Wex)).transpose() * QCB - Urefex.transpose() * Rex).transpose();
+}
+
+void compareWithDense(VehicleModelInterface &model, const int N)
+{
+  const double dt = 0.1;
+  MPCCondensedMatrix m;
+  m.resize(N, model.getDimX(), model.getDimU(), model.getDimY());
+  setStageMatrices(model, m, dt);
+
+  Eigen::VectorXd x0 = Eigen::VectorXd::LinSpaced(model.getDimX(), 0.1, 0.3);
+
+  Eigen::MatrixXd H, f, Aex, Bex, Wex;
+  auto start = std::chrono::system_clock::now();
+  buildDense(m, x0, H, f, Aex, Bex, Wex);
+  const double dense_ms =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now() - start).count() * 1.0e-6;
+
+  start = std::chrono::system_clock::now();
+  m.build(x0);
+  const double condensed_ms =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now() - start).count() * 1.0e-6;
+
+  std::cout << "[MPC] dim_x = " << model.getDimX() << ", N = " << N << " : dense = " << dense_ms
+            << " [ms], condensed = " << condensed_ms << " [ms]" << std::endl;
+
+  const double tol = 1.0E-8 * std::max(1.0, H.cwiseAbs().maxCoeff());
+  ASSERT_LT((m.H - H).cwiseAbs().maxCoeff(), tol) << "hessian differs from dense formulation, N = " << N;
+  ASSERT_LT((m.f - f).cwiseAbs().maxCoeff(), tol) << "gradient differs from dense formulation, N = " << N;
+
+  /* solution and predicted state */
+  QPSolverEigenLeastSquareLLT solver_ref;
+  QPSolverEigenCondensedLLT solver;
+  Eigen::MatrixXd A;
+  Eigen::VectorXd lb, ub, U_ref, U;
+  ASSERT_TRUE(solver.solve(m.H, m.f, A, lb, ub, A, A, U));
+  if (solver_ref.solve(H, f, A, lb, ub, A, A, U_ref))
+  {
+    ASSERT_LT((U - U_ref).cwiseAbs().maxCoeff(), 1.0E-6);
+  }
+
+  Eigen::VectorXd Xex;
+  m.predict(x0, U, Xex);
+  const Eigen::VectorXd Xex_ref = Aex * x0 + Bex * U + Wex;
+  ASSERT_LT((Xex - Xex_ref).cwiseAbs().maxCoeff(), 1.0E-8);
+}
+
+TEST_F(TestSuite, TestCondensedMatrixKinematics)
+{
+  KinematicsBicycleModel model(2.9, 35.0 * M_PI / 180.0, 0.3);
+  for (const int N : {10, 30, 70, 100, 150})
+  {
+    compareWithDense(model, N);
+  }
+}
+
+TEST_F(TestSuite, TestCondensedMatrixDynamics)
+{
+  double wheelbase = 2.9, mass_fl = 600.0, mass_fr = 600.0, mass_rl = 600.0, mass_rr = 600.0;
+  double cf = 155494.663, cr = 155494.663;
+  DynamicsBicycleModel model(wheelbase, mass_fl, mass_fr, mass_rl, mass_rr, cf, cr);
+  for (const int N : {10, 30, 70, 100, 150})
+  {
+    compareWithDense(model, N);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
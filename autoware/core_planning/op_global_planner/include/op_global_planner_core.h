@@ -71,7 +71,8 @@ public:
   double pathDensity;
   PlannerHNS::MAP_SOURCE_TYPE  mapSource;
   bool bEnableDynamicMapUpdate;
-
+  bool bEnableLaneGraphSearch;
+  int nLaneGraphLandmarks;
 
   WayPlannerParams()
   {
@@ -83,6 +84,8 @@ public:
     bEnableRvizInput = true;
     pathDensity = 0.5;
     mapSource = PlannerHNS::MAP_KML_FILE;
+    bEnableLaneGraphSearch = false;
+    nLaneGraphLandmarks = 0;
   }
 };
 
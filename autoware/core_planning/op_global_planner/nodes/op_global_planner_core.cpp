@@ -36,6 +36,9 @@ GlobalPlanner::GlobalPlanner()
   nh.getParam("/op_global_planner/enableReplan" , m_params.bEnableReplanning);
   nh.getParam("/op_global_planner/enableDynamicMapUpdate" , m_params.bEnableDynamicMapUpdate);
   nh.getParam("/op_global_planner/mapFileName" , m_params.KmlMapPath);
+  nh.getParam("/op_global_planner/enableLaneGraphSearch" , m_params.bEnableLaneGraphSearch);
+  nh.getParam("/op_global_planner/laneGraphLandmarks" , m_params.nLaneGraphLandmarks);
+  m_PlannerH.SetLaneGraphSearch(m_params.bEnableLaneGraphSearch, m_params.nLaneGraphLandmarks);
 
   int iSource = 0;
   nh.getParam("/op_global_planner/mapSource", iSource);
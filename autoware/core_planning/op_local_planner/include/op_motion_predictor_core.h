@@ -49,6 +49,29 @@
 namespace MotionPredictorNS
 {
 
+/// Uniform grid over the first points of the map curbs, built once after the map is loaded.
+class CurbsIndex
+{
+public:
+  CurbsIndex();
+  void Build(const std::vector<PlannerHNS::GPSPoint>& points, const double& cell_size);
+  void Clear();
+
+  /// Indices of the points within radius from center, in increasing order.
+  void Query(const PlannerHNS::GPSPoint& center, const double& radius, std::vector<unsigned int>& indices) const;
+
+private:
+  std::vector<PlannerHNS::GPSPoint> m_Points;
+  double m_CellSize;
+  double m_MinX;
+  double m_MinY;
+  int m_nCols;
+  int m_nRows;
+  // points of cell i are m_CellPoints[m_CellStart[i] .. m_CellStart[i+1]-1]
+  std::vector<unsigned int> m_CellStart;
+  std::vector<unsigned int> m_CellPoints;
+};
+
 class MotionPrediction
 {
 protected:
@@ -74,6 +97,14 @@ protected:
 
   bool m_bEnableCurbObstacles;
   std::vector<PlannerHNS::DetectedObject> curr_curbs_obstacles;
+  std::vector<unsigned int> curr_curbs_indices;
+
+  // curbs of the map converted once, selected around the vehicle with m_CurbsIndex each cycle
+  bool m_bCurbsIndexed;
+  CurbsIndex m_CurbsIndex;
+  std::vector<PlannerHNS::DetectedObject> m_CurbsObstacles;
+  std::vector<autoware_msgs::DetectedObject> m_CurbsMessages;
+  std::vector<unsigned int> m_CurbsCandidates;
 
   PlannerHNS::BehaviorPrediction m_PredictBeh;
   autoware_msgs::DetectedObjectArray m_PredictedResultsResults;
@@ -122,7 +153,8 @@ protected:
   //Helper functions
   void VisualizePrediction();
   void UpdatePlanningParams(ros::NodeHandle& _nh);
-  void GenerateCurbsObstacles(std::vector<PlannerHNS::DetectedObject>& curb_obstacles);
+  void IndexCurbsObstacles();
+  void GenerateCurbsObstacles(std::vector<unsigned int>& curbs_indices);
 
 public:
   MotionPrediction();
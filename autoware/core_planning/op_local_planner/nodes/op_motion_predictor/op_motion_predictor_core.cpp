@@ -18,9 +18,100 @@
 #include "op_planner/MappingHelpers.h"
 #include "op_ros_helpers/op_ROSHelpers.h"
 
+#include <algorithm>
+
 namespace MotionPredictorNS
 {
 
+// edge length of the curbs index cells in meters, small compared with the planning horizon
+#define CURBS_INDEX_CELL_SIZE 20.0
+
+CurbsIndex::CurbsIndex()
+{
+  Clear();
+}
+
+void CurbsIndex::Clear()
+{
+  m_Points.clear();
+  m_CellSize = CURBS_INDEX_CELL_SIZE;
+  m_MinX = 0;
+  m_MinY = 0;
+  m_nCols = 0;
+  m_nRows = 0;
+  m_CellStart.clear();
+  m_CellPoints.clear();
+}
+
+void CurbsIndex::Build(const std::vector<PlannerHNS::GPSPoint>& points, const double& cell_size)
+{
+  Clear();
+  if(points.size() == 0 || cell_size <= 0) return;
+
+  m_Points = points;
+  m_CellSize = cell_size;
+  double max_x = points.at(0).x;
+  double max_y = points.at(0).y;
+  m_MinX = points.at(0).x;
+  m_MinY = points.at(0).y;
+  for(unsigned int i = 1; i < points.size(); i++)
+  {
+    m_MinX = std::min(m_MinX, points.at(i).x);
+    m_MinY = std::min(m_MinY, points.at(i).y);
+    max_x = std::max(max_x, points.at(i).x);
+    max_y = std::max(max_y, points.at(i).y);
+  }
+
+  m_nCols = floor((max_x - m_MinX) / m_CellSize) + 1;
+  m_nRows = floor((max_y - m_MinY) / m_CellSize) + 1;
+
+  // counting sort of the points by cell, each cell keeps the points in increasing order
+  std::vector<unsigned int> points_cell(points.size());
+  m_CellStart.assign(m_nCols * m_nRows + 1, 0);
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    int col = floor((points.at(i).x - m_MinX) / m_CellSize);
+    int row = floor((points.at(i).y - m_MinY) / m_CellSize);
+    points_cell.at(i) = row * m_nCols + col;
+    m_CellStart.at(points_cell.at(i) + 1)++;
+  }
+
+  for(unsigned int c = 1; c < m_CellStart.size(); c++)
+    m_CellStart.at(c) += m_CellStart.at(c-1);
+
+  std::vector<unsigned int> cell_fill(m_CellStart.begin(), m_CellStart.end()-1);
+  m_CellPoints.resize(points.size());
+  for(unsigned int i = 0; i < points.size(); i++)
+    m_CellPoints.at(cell_fill.at(points_cell.at(i))++) = i;
+}
+
+void CurbsIndex::Query(const PlannerHNS::GPSPoint& center, const double& radius, std::vector<unsigned int>& indices) const
+{
+  indices.clear();
+  if(m_Points.size() == 0 || radius < 0) return;
+
+  int min_col = std::max(0, (int)floor((center.x - radius - m_MinX) / m_CellSize));
+  int max_col = std::min(m_nCols - 1, (int)floor((center.x + radius - m_MinX) / m_CellSize));
+  int min_row = std::max(0, (int)floor((center.y - radius - m_MinY) / m_CellSize));
+  int max_row = std::min(m_nRows - 1, (int)floor((center.y + radius - m_MinY) / m_CellSize));
+
+  for(int row = min_row; row <= max_row; row++)
+  {
+    for(int col = min_col; col <= max_col; col++)
+    {
+      int cell = row * m_nCols + col;
+      for(unsigned int k = m_CellStart.at(cell); k < m_CellStart.at(cell+1); k++)
+      {
+        unsigned int i = m_CellPoints.at(k);
+        if(hypot(center.y - m_Points.at(i).y, center.x - m_Points.at(i).x) <= radius)
+          indices.push_back(i);
+      }
+    }
+  }
+
+  std::sort(indices.begin(), indices.end());
+}
+
 MotionPrediction::MotionPrediction()
 {
   bMap = false;
@@ -28,6 +119,7 @@ MotionPrediction::MotionPrediction()
   bVehicleStatus = false;
   bTrackedObjects = false;
   m_bEnableCurbObstacles = false;
+  m_bCurbsIndexed = false;
   m_DistanceBetweenCurbs = 1.0;
   m_VisualizationTime = 0.25;
   m_bGoNextStep = false;
@@ -152,6 +244,9 @@ void MotionPrediction::UpdatePlanningParams(ros::NodeHandle& _nh)
   _nh.getParam("/op_motion_predictor/visualizationTime", m_VisualizationTime);
   _nh.getParam("/op_motion_predictor/enableStepByStepSignal",   m_PredictBeh.m_bStepByStep );
   _nh.getParam("/op_motion_predictor/enableParticleFilterPrediction",   m_PredictBeh.m_bParticleFilter);
+  int particles_random_seed = 0;
+  _nh.getParam("/op_motion_predictor/particlesRandomSeed", particles_random_seed);
+  m_PredictBeh.m_RandomSeed = particles_random_seed;
 
 
   UtilityHNS::UtilityH::GetTickCount(m_SensingTimer);
@@ -244,13 +339,14 @@ void MotionPrediction::callbackGetTrackedObjects(const autoware_msgs::DetectedOb
 
     if(m_bEnableCurbObstacles)
     {
+      curr_curbs_indices.clear();
+      GenerateCurbsObstacles(curr_curbs_indices);
       curr_curbs_obstacles.clear();
-      GenerateCurbsObstacles(curr_curbs_obstacles);
-      //std::cout << "Curbs No: " << curr_curbs_obstacles.size() << endl;
-      for(unsigned int i = 0 ; i <curr_curbs_obstacles.size(); i++)
+      //std::cout << "Curbs No: " << curr_curbs_indices.size() << endl;
+      for(unsigned int i = 0 ; i <curr_curbs_indices.size(); i++)
       {
-        PlannerHNS::ROSHelpers::ConvertFromOpenPlannerDetectedObjectToAutowareDetectedObject(curr_curbs_obstacles.at(i), false, pred_obj);
-        m_PredictedResultsResults.objects.push_back(pred_obj);
+        curr_curbs_obstacles.push_back(m_CurbsObstacles.at(curr_curbs_indices.at(i)));
+        m_PredictedResultsResults.objects.push_back(m_CurbsMessages.at(curr_curbs_indices.at(i)));
       }
     }
 
@@ -259,43 +355,62 @@ void MotionPrediction::callbackGetTrackedObjects(const autoware_msgs::DetectedOb
   }
 }
 
-void MotionPrediction::GenerateCurbsObstacles(std::vector<PlannerHNS::DetectedObject>& curb_obstacles)
+void MotionPrediction::IndexCurbsObstacles()
 {
-  if(!bNewCurrentPos) return;
+  m_CurbsObstacles.clear();
+  m_CurbsMessages.clear();
 
+  std::vector<PlannerHNS::GPSPoint> first_points;
   for(unsigned int ic = 0; ic < m_Map.curbs.size(); ic++)
   {
-
     if(m_Map.curbs.at(ic).points.size() > 0)
     {
       PlannerHNS::DetectedObject obj;
       obj.center.pos = m_Map.curbs.at(ic).points.at(0);
-
-      if(curb_obstacles.size()>0)
-      {
-        double distance_to_prev = hypot(curb_obstacles.at(curb_obstacles.size()-1).center.pos.y-obj.center.pos.y, curb_obstacles.at(curb_obstacles.size()-1).center.pos.x-obj.center.pos.x);
-        if(distance_to_prev < m_DistanceBetweenCurbs)
-          continue;
-      }
-
-      double longitudinalDist = hypot(m_CurrentPos.pos.y -obj.center.pos.y, m_CurrentPos.pos.x-obj.center.pos.x);
-
-      if(longitudinalDist > m_PlanningParams.horizonDistance)
-        continue;
-
       obj.bDirection = false;
       obj.bVelocity = false;
       obj.id = -1;
       obj.t  = PlannerHNS::SIDEWALK;
       obj.label = "curb";
-      for(unsigned int icp=0; icp< m_Map.curbs.at(ic).points.size(); icp++)
-      {
-        obj.contour.push_back(m_Map.curbs.at(ic).points.at(icp));
-      }
+      obj.contour = m_Map.curbs.at(ic).points;
+
+      autoware_msgs::DetectedObject curb_msg;
+      PlannerHNS::ROSHelpers::ConvertFromOpenPlannerDetectedObjectToAutowareDetectedObject(obj, false, curb_msg);
 
-      curb_obstacles.push_back(obj);
+      first_points.push_back(obj.center.pos);
+      m_CurbsObstacles.push_back(obj);
+      m_CurbsMessages.push_back(curb_msg);
     }
   }
+
+  m_CurbsIndex.Build(first_points, CURBS_INDEX_CELL_SIZE);
+  m_bCurbsIndexed = true;
+}
+
+void MotionPrediction::GenerateCurbsObstacles(std::vector<unsigned int>& curbs_indices)
+{
+  if(!bNewCurrentPos) return;
+
+  if(!m_bCurbsIndexed)
+    IndexCurbsObstacles();
+
+  // curbs beyond the horizon are never kept, so only the ones within it are visited, in map order
+  m_CurbsIndex.Query(m_CurrentPos.pos, m_PlanningParams.horizonDistance, m_CurbsCandidates);
+
+  for(unsigned int i = 0; i < m_CurbsCandidates.size(); i++)
+  {
+    const PlannerHNS::DetectedObject& obj = m_CurbsObstacles.at(m_CurbsCandidates.at(i));
+
+    if(curbs_indices.size()>0)
+    {
+      const PlannerHNS::DetectedObject& prev_obj = m_CurbsObstacles.at(curbs_indices.at(curbs_indices.size()-1));
+      double distance_to_prev = hypot(prev_obj.center.pos.y-obj.center.pos.y, prev_obj.center.pos.x-obj.center.pos.x);
+      if(distance_to_prev < m_DistanceBetweenCurbs)
+        continue;
+    }
+
+    curbs_indices.push_back(m_CurbsCandidates.at(i));
+  }
 }
 
 void MotionPrediction::VisualizePrediction()
@@ -19,11 +19,17 @@
 // ###############################################################################################
 // ###############################################################################################
 
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
 #include <iostream>
 #include <fstream>
 #include <limits>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 #include <ros/ros.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/format.hpp>
@@ -79,54 +85,187 @@ struct kitti_player_options
     bool    stereoDisp;       // use precalculated stereoDisparities
     bool    viewDisparities;  // view use precalculated stereoDisparities
     unsigned int startFrame;  // start the replay at frame ...
+    unsigned int prefetch;    // frames decoded ahead of the replay, 0 decodes in the replay loop
+    unsigned int threads;     // decoder threads filling the prefetch queue
+    bool    maxRate;          // ignore the frequency and publish as fast as the decoders allow
 
     /// Extra parameters
     bool    laneDetections;   // send laneDetections;
 };
 
 /**
- * @brief publish_velodyne
- * @param pub The ROS publisher as reference
- * @param infile file with data to publish
- * @param header Header to use to publish the message
+ * @brief read_velodyne
+ * @param infile file with data to read
+ * @param points point cloud filled with the scan
  * @return 1 if file is correctly readed, 0 otherwise
  */
-int publish_velodyne(ros::Publisher &pub, string infile, std_msgs::Header *header)
+int read_velodyne(string infile, pcl::PointCloud<pcl::PointXYZI>::Ptr points)
 {
-    fstream input(infile.c_str(), ios::in | ios::binary);
+    ifstream input(infile.c_str(), ios::in | ios::binary | ios::ate);
     if(!input.good())
     {
         ROS_ERROR_STREAM ( "Could not read file: " << infile );
         return 0;
     }
-    else
+
+    ROS_DEBUG_STREAM ("reading " << infile);
+
+    // The whole scan is read at once, each point is x, y, z, reflectance as float
+    size_t n_points = (size_t)input.tellg() / (4*sizeof(float));
+    vector<float> buffer(4*n_points);
+    input.seekg(0, ios::beg);
+    input.read((char *) buffer.data(), buffer.size()*sizeof(float));
+    if(!input.good())
     {
-        ROS_DEBUG_STREAM ("reading " << infile);
-        input.seekg(0, ios::beg);
+        ROS_ERROR_STREAM ( "Could not read file: " << infile );
+        return 0;
+    }
 
-        pcl::PointCloud<pcl::PointXYZI>::Ptr points (new pcl::PointCloud<pcl::PointXYZI>);
+    points->resize(n_points);
+    for (size_t i=0; i<n_points; i++)
+    {
+        pcl::PointXYZI &point = points->points[i];
+        point.x         = buffer[4*i];
+        point.y         = buffer[4*i+1];
+        point.z         = buffer[4*i+2];
+        point.intensity = buffer[4*i+3];
+    }
+    return 1;
+}
 
-        int i;
-        for (i=0; input.good() && !input.eof(); i++) {
-            pcl::PointXYZI point;
-            input.read((char *) &point.x, 3*sizeof(float));
-            input.read((char *) &point.intensity, sizeof(float));
-            points->push_back(point);
+/**
+ * @brief publish_velodyne
+ * @param pub The ROS publisher as reference
+ * @param points scan read by read_velodyne
+ * @param header Header to use to publish the message
+ */
+void publish_velodyne(ros::Publisher &pub, pcl::PointCloud<pcl::PointXYZI>::Ptr points, std_msgs::Header *header)
+{
+    //workaround for the PCL headers... http://wiki.ros.org/hydro/Migration#PCL
+    sensor_msgs::PointCloud2 pc2;
+
+    pc2.header.frame_id= "velodyne"; //ros::this_node::getName();
+    pc2.header.stamp=header->stamp;
+    pc2.header.seq=header->seq;
+    points->header = pcl_conversions::toPCL(pc2.header);
+    pub.publish(points);
+}
+
+/**
+ * @brief kitti_frame, the images and the scan of one entry, decoded before being published
+ */
+struct kitti_frame
+{
+    cv::Mat image00;                                    // grayscale left
+    cv::Mat image01;                                    // grayscale right
+    cv::Mat image02;                                    // color left
+    cv::Mat image03;                                    // color right
+    cv::Mat image04;                                    // pre-calculated disparities
+    pcl::PointCloud<pcl::PointXYZI>::Ptr velodyne;      // velodyne scan, NULL if not readed
+};
+
+/**
+ * @brief kitti_prefetcher, decodes the entries with a pool of threads into a bounded ring of frames,
+ *        so that PNG decoding and file reading overlap the replay. Frames are handed out in entry order.
+ */
+class kitti_prefetcher
+{
+public:
+    typedef std::function<void (unsigned int, kitti_frame *)> decoder;
+
+    /**
+     * @brief kitti_prefetcher
+     * @param decode function decoding one entry, called concurrently by the threads
+     * @param first first entry to decode
+     * @param end entry after the last one
+     * @param depth maximum number of frames decoded ahead of the replay, 0 decodes in pop
+     * @param threads number of decoder threads
+     */
+    kitti_prefetcher(decoder decode, unsigned int first, unsigned int end, unsigned int depth, unsigned int threads)
+        : decode_(decode), next_decode_(first), next_pop_(first), end_(end),
+          ring_(std::max(depth, 1u)), ready_(std::max(depth, 1u), false), stop_(false)
+    {
+        if (depth > 0)
+            for (unsigned int i = 0; i < threads; i++)
+                workers_.push_back(std::thread(&kitti_prefetcher::work, this));
+    }
+
+    ~kitti_prefetcher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
         }
-        input.close();
+        consumed_.notify_all();
+        for (std::thread &worker : workers_)
+            worker.join();
+    }
 
-        //workaround for the PCL headers... http://wiki.ros.org/hydro/Migration#PCL
-        sensor_msgs::PointCloud2 pc2;
+    /**
+     * @brief pop, waits for the next entry to be decoded
+     * @param frame decoded entry
+     * @return 1 if an entry is returned, 0 once all the entries have been handed out
+     */
+    int pop(kitti_frame *frame)
+    {
+        if (next_pop_ >= end_)
+            return 0;
 
-        pc2.header.frame_id= "velodyne"; //ros::this_node::getName();
-        pc2.header.stamp=header->stamp;
-        pc2.header.seq=header->seq;
-        points->header = pcl_conversions::toPCL(pc2.header);
-        pub.publish(points);
+        if (workers_.empty())
+        {
+            *frame = kitti_frame();
+            decode_(next_pop_++, frame);
+            return 1;
+        }
 
+        std::unique_lock<std::mutex> lock(mutex_);
+        size_t slot = next_pop_ % ring_.size();
+        decoded_.wait(lock, [&]{ return (bool)ready_[slot]; });
+        *frame = ring_[slot];
+        ring_[slot] = kitti_frame();
+        ready_[slot] = false;
+        next_pop_++;
+        lock.unlock();
+        consumed_.notify_all();
         return 1;
     }
-}
+
+private:
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            // an entry is decoded once its slot has been handed out, this bounds the memory in use
+            consumed_.wait(lock, [&]{ return stop_ || next_decode_ >= end_ || next_decode_ < next_pop_ + ring_.size(); });
+            if (stop_ || next_decode_ >= end_)
+                return;
+
+            unsigned int entry = next_decode_++;
+            lock.unlock();
+
+            kitti_frame frame;
+            decode_(entry, &frame);
+
+            lock.lock();
+            ring_[entry % ring_.size()] = frame;
+            ready_[entry % ring_.size()] = true;
+            decoded_.notify_all();
+        }
+    }
+
+    decoder                     decode_;
+    unsigned int                next_decode_;   // next entry to be claimed by a decoder thread
+    unsigned int                next_pop_;      // next entry to be handed out
+    unsigned int                end_;
+    vector<kitti_frame>         ring_;          // entry i is decoded into ring_[i % size]
+    vector<bool>                ready_;
+    bool                        stop_;
+    vector<std::thread>         workers_;
+    std::mutex                  mutex_;
+    std::condition_variable     decoded_;
+    std::condition_variable     consumed_;
+};
 
 /**
  * @brief getCalibration
@@ -354,6 +493,25 @@ std_msgs::Header parseTime(string timestamp)
     return header;
 }
 
+/**
+ * @brief loadTimestamps, reads a timestamps.txt once instead of seeking it at every entry
+ * @param filename timestamps.txt to read
+ * @param timestamps one line per entry
+ * @return 1 if file is correctly readed, 0 otherwise
+ */
+int loadTimestamps(string filename, vector<string> *timestamps)
+{
+    ifstream file(filename.c_str());
+    if (!file.is_open())
+        return 0;
+
+    string line;
+    while (getline(file, line))
+        if (!line.empty())
+            timestamps->push_back(line);
+    return 1;
+}
+
 /**
  * @brief getLaneDetection
  * @param infile
@@ -480,6 +638,9 @@ int getLaneDetection(string infile, road_layout_estimation::msg_lines *msg_lines
  *   -D [ --viewDisp   ] [=arg(=1)] (=0) view loaded disparity images
  *   -l [ --laneDetect ] [=arg(=1)] (=0) send extra lanes message
  *   -F [ --frame      ] [=arg(=0)] (=0) start playing at frame ...
+ *   -p [ --prefetch   ] arg (=4)        frames decoded ahead of the replay, 0 disables the prefetch
+ *   -t [ --threads    ] arg (=2)        decoder threads
+ *   -M [ --maxRate    ] [=arg(=1)] (=0) ignore the frequency and publish as fast as the decoders allow
  *
  * Datasets can be downloaded from: http://www.cvlibs.net/datasets/kitti/raw_data.php
  */
@@ -505,6 +666,9 @@ int main(int argc, char **argv)
         ("viewDisp  ,D ", po::value<bool>         (&options.viewDisparities)->default_value(0) ->implicit_value(1)   ,  "view loaded disparity images")
         ("laneDetect,l",  po::value<bool>         (&options.laneDetections) ->default_value(0) ->implicit_value(1)   ,  "send extra lanes message")
         ("frame     ,F",  po::value<unsigned int> (&options.startFrame)     ->default_value(0) ->implicit_value(0)   ,  "start playing at frame...")
+        ("prefetch  ,p",  po::value<unsigned int> (&options.prefetch)       ->default_value(4)                       ,  "frames decoded ahead of the replay, 0 disables the prefetch")
+        ("threads   ,t",  po::value<unsigned int> (&options.threads)        ->default_value(2)                       ,  "decoder threads")
+        ("maxRate   ,M",  po::value<bool>         (&options.maxRate)        ->default_value(0) ->implicit_value(1)   ,  "ignore the frequency and publish as fast as the decoders allow")
     ;
 
     try // parse options
@@ -587,11 +751,15 @@ int main(int argc, char **argv)
     cv::Mat cv_laneProjected;
     std_msgs::Header header_support;
 
+    // At max rate the publishers queue as many frames as the prefetcher, so that slow subscribers do not
+    // lose the frames published in a burst
+    uint32_t queue_size = options.maxRate ? std::max(options.prefetch, 1u) : 1;
+
     image_transport::ImageTransport it(node);
-    image_transport::CameraPublisher pub00 = it.advertiseCamera("grayscale/left/image_rect", 1);
-    image_transport::CameraPublisher pub01 = it.advertiseCamera("grayscale/right/image_rect", 1);
-    image_transport::CameraPublisher pub02 = it.advertiseCamera("color/left/image_rect", 1);
-    image_transport::CameraPublisher pub03 = it.advertiseCamera("color/right/image_rect", 1);
+    image_transport::CameraPublisher pub00 = it.advertiseCamera("grayscale/left/image_rect", queue_size);
+    image_transport::CameraPublisher pub01 = it.advertiseCamera("grayscale/right/image_rect", queue_size);
+    image_transport::CameraPublisher pub02 = it.advertiseCamera("color/left/image_rect", queue_size);
+    image_transport::CameraPublisher pub03 = it.advertiseCamera("color/right/image_rect", queue_size);
 
     sensor_msgs::Image ros_msg00;
     sensor_msgs::Image ros_msg01;
@@ -607,11 +775,11 @@ int main(int argc, char **argv)
 
     cv_bridge::CvImage cv_bridge_img;
 
-    ros::Publisher map_pub           = node.advertise<pcl::PointCloud<pcl::PointXYZ> >  ("hdl64e", 1, true);
-    ros::Publisher gps_pub           = node.advertise<sensor_msgs::NavSatFix>           ("oxts/gps", 1, true);
+    ros::Publisher map_pub           = node.advertise<pcl::PointCloud<pcl::PointXYZ> >  ("hdl64e", queue_size, true);
+    ros::Publisher gps_pub           = node.advertise<sensor_msgs::NavSatFix>           ("oxts/gps", queue_size, true);
     ros::Publisher gps_pub_initial   = node.advertise<sensor_msgs::NavSatFix>           ("oxts/gps_initial", 1, true);
-    ros::Publisher imu_pub           = node.advertise<sensor_msgs::Imu>                 ("oxts/imu", 1, true);
-    ros::Publisher disp_pub          = node.advertise<stereo_msgs::DisparityImage>      ("preprocessed_disparity",1,true);
+    ros::Publisher imu_pub           = node.advertise<sensor_msgs::Imu>                 ("oxts/imu", queue_size, true);
+    ros::Publisher disp_pub          = node.advertise<stereo_msgs::DisparityImage>      ("preprocessed_disparity",queue_size,true);
     //ros::Publisher lanes_pub         = node.advertise<road_layout_estimation::msg_lines>("lanes",1,true);
 
     sensor_msgs::NavSatFix  ros_msgGpsFix;
@@ -968,12 +1136,95 @@ int main(int argc, char **argv)
         ros_cameraInfoMsg_camera01.width  = ros_cameraInfoMsg_camera00.width  = cv_image00.cols;// -1;
     }
 
+    // TIMESTAMPS SECTION: read one for all, the entries are indexed in the loop
+
+    vector<string> timestamps_image02;
+    vector<string> timestamps_image03;
+    vector<string> timestamps_velodyne;
+    vector<string> timestamps_oxts;
+
+    if (options.timestamps)
+    {
+        auto load = [&](string dir_timestamp, vector<string> *timestamps)
+        {
+            str_support = dir_timestamp + "timestamps.txt";
+            if (!loadTimestamps(str_support, timestamps) || timestamps->size() < total_entries)
+            {
+                ROS_ERROR_STREAM("Fail to read " << total_entries << " timestamps from " << str_support);
+                return false;
+            }
+            return true;
+        };
+
+        if (
+            ((options.color || options.grayscale || options.all_data) && !load(dir_timestamp_image02, &timestamps_image02)) ||
+            ((options.color || options.all_data)                      && !load(dir_timestamp_image03, &timestamps_image03)) ||
+            ((options.velodyne || options.all_data)                   && !load(dir_timestamp_velodyne, &timestamps_velodyne)) ||
+            ((options.gps || options.imu || options.all_data)         && !load(dir_timestamp_oxts, &timestamps_oxts))
+           )
+        {
+            node.shutdown();
+            return -1;
+        }
+    }
+
+    // DECODING SECTION: PNG and velodyne files are decoded by the prefetcher threads ahead of the replay
+
+    auto decode = [&](unsigned int entry, kitti_frame *frame)
+    {
+        string entry_name = boost::str(boost::format("%010d") % entry );
+
+        if(options.stereoDisp)
+            frame->image04 = cv::imread(dir_image04 + entry_name + ".png", CV_LOAD_IMAGE_GRAYSCALE);
+
+        if(options.color || options.all_data)
+        {
+            frame->image02 = cv::imread(dir_image02 + entry_name + ".png", CV_LOAD_IMAGE_UNCHANGED);
+            frame->image03 = cv::imread(dir_image03 + entry_name + ".png", CV_LOAD_IMAGE_UNCHANGED);
+        }
+
+        if(options.grayscale || options.all_data)
+        {
+            frame->image00 = cv::imread(dir_image00 + entry_name + ".png", CV_LOAD_IMAGE_UNCHANGED);
+            frame->image01 = cv::imread(dir_image01 + entry_name + ".png", CV_LOAD_IMAGE_UNCHANGED);
+        }
+
+        if(options.velodyne || options.all_data)
+        {
+            frame->velodyne.reset(new pcl::PointCloud<pcl::PointXYZI>);
+            if (!read_velodyne(dir_velodyne_points + entry_name + ".bin", frame->velodyne))
+                frame->velodyne.reset();
+        }
+    };
+
+    kitti_prefetcher prefetcher(decode, entries_played, total_entries, options.prefetch, options.threads);
+    kitti_frame frame;
+
+    if (options.maxRate)
+    {
+        // Nobody would receive the first frames otherwise
+        ROS_INFO_STREAM("Max rate replay, waiting for a subscriber...");
+        while (ros::ok() &&
+               pub00.getNumSubscribers() + pub01.getNumSubscribers() + pub02.getNumSubscribers() + pub03.getNumSubscribers() +
+               map_pub.getNumSubscribers() + gps_pub.getNumSubscribers() + imu_pub.getNumSubscribers() + disp_pub.getNumSubscribers() == 0)
+            ros::WallDuration(0.1).sleep();
+    }
+
     boost::progress_display progress(total_entries) ;
     double cv_min, cv_max=0.0f;
 
+    unsigned int frames_played = 0;
+    ros::WallDuration decoder_wait(0);
+    ros::WallTime replay_start = ros::WallTime::now();
+
     // This is the main KITTI_PLAYER Loop
     do
     {
+        ros::WallTime wait_start = ros::WallTime::now();
+        if (!prefetcher.pop(&frame))
+            break;
+        decoder_wait += ros::WallTime::now() - wait_start;
+
         // single timestamp for all published stuff
         Time current_timestamp=ros::Time::now();
 
@@ -982,8 +1233,7 @@ int main(int argc, char **argv)
             // Allocate new disparity image message
             stereo_msgs::DisparityImagePtr disp_msg = boost::make_shared<stereo_msgs::DisparityImage>();
 
-            full_filename_image04 = dir_image04 + boost::str(boost::format("%010d") % entries_played ) + ".png";
-            cv_image04 = cv::imread(full_filename_image04, CV_LOAD_IMAGE_GRAYSCALE);
+            cv_image04 = frame.image04;
 
             cv::minMaxLoc(cv_image04,&cv_min,&cv_max);
 
@@ -1042,8 +1292,8 @@ int main(int argc, char **argv)
             full_filename_image03 = dir_image03 + boost::str(boost::format("%010d") % entries_played ) + ".png";
             ROS_DEBUG_STREAM ( full_filename_image02 << endl << full_filename_image03 << endl << endl);
 
-            cv_image02 = cv::imread(full_filename_image02, CV_LOAD_IMAGE_UNCHANGED);
-            cv_image03 = cv::imread(full_filename_image03, CV_LOAD_IMAGE_UNCHANGED);
+            cv_image02 = frame.image02;
+            cv_image03 = frame.image03;
 
             if ( (cv_image02.data == NULL) || (cv_image03.data == NULL) ){
                 ROS_ERROR_STREAM("Error reading color images (02 & 03)");
@@ -1070,20 +1320,7 @@ int main(int argc, char **argv)
             }
             else
             {
-
-                str_support = dir_timestamp_image02 + "timestamps.txt";
-                ifstream timestamps(str_support.c_str());
-                if (!timestamps.is_open())
-                {
-                    string timestamps_string;
-                    timestamps >> timestamps_string;
-                    ROS_ERROR_STREAM("Fail to open " << timestamps_string);
-                    node.shutdown();
-                    return -1;
-                }
-                timestamps.seekg(30*entries_played);
-                getline(timestamps,str_support);
-                cv_bridge_img.header.stamp = parseTime(str_support).stamp;
+                cv_bridge_img.header.stamp = parseTime(timestamps_image02[entries_played]).stamp;
                 ros_msg02.header.stamp = ros_cameraInfoMsg_camera02.header.stamp = cv_bridge_img.header.stamp;
             }
             cv_bridge_img.image = cv_image02;
@@ -1096,20 +1333,7 @@ int main(int argc, char **argv)
             }
             else
             {
-
-                str_support = dir_timestamp_image03 + "timestamps.txt";
-                ifstream timestamps(str_support.c_str());
-                if (!timestamps.is_open())
-                {
-                    string timestamps_string;
-                    timestamps >> timestamps_string;
-                    ROS_ERROR_STREAM("Fail to open " << timestamps_string);
-                    node.shutdown();
-                    return -1;
-                }
-                timestamps.seekg(30*entries_played);
-                getline(timestamps,str_support);
-                cv_bridge_img.header.stamp = parseTime(str_support).stamp;
+                cv_bridge_img.header.stamp = parseTime(timestamps_image03[entries_played]).stamp;
                 ros_msg03.header.stamp = ros_cameraInfoMsg_camera03.header.stamp = cv_bridge_img.header.stamp;
             }
 
@@ -1127,8 +1351,8 @@ int main(int argc, char **argv)
             full_filename_image01 = dir_image01 + boost::str(boost::format("%010d") % entries_played ) + ".png";
             ROS_DEBUG_STREAM ( full_filename_image00 << endl << full_filename_image01 << endl << endl);
 
-            cv_image00 = cv::imread(full_filename_image00, CV_LOAD_IMAGE_UNCHANGED);
-            cv_image01 = cv::imread(full_filename_image01, CV_LOAD_IMAGE_UNCHANGED);
+            cv_image00 = frame.image00;
+            cv_image01 = frame.image01;
 
             if ( (cv_image00.data == NULL) || (cv_image01.data == NULL) ){
                 ROS_ERROR_STREAM("Error reading color images (00 & 01)");
@@ -1155,20 +1379,7 @@ int main(int argc, char **argv)
             }
             else
             {
-
-                str_support = dir_timestamp_image02 + "timestamps.txt";
-                ifstream timestamps(str_support.c_str());
-                if (!timestamps.is_open())
-                {
-                    string timestamps_string;
-                    timestamps >> timestamps_string;
-                    ROS_ERROR_STREAM("Fail to open " << timestamps_string);
-                    node.shutdown();
-                    return -1;
-                }
-                timestamps.seekg(30*entries_played);
-                getline(timestamps,str_support);
-                cv_bridge_img.header.stamp = parseTime(str_support).stamp;
+                cv_bridge_img.header.stamp = parseTime(timestamps_image02[entries_played]).stamp;
                 ros_msg00.header.stamp = ros_cameraInfoMsg_camera00.header.stamp = cv_bridge_img.header.stamp;
             }
             cv_bridge_img.image = cv_image00;
@@ -1181,20 +1392,7 @@ int main(int argc, char **argv)
             }
             else
             {
-
-                str_support = dir_timestamp_image02 + "timestamps.txt";
-                ifstream timestamps(str_support.c_str());
-                if (!timestamps.is_open())
-                {
-                    string timestamps_string;
-                    timestamps >> timestamps_string;
-                    ROS_ERROR_STREAM("Fail to open " << timestamps_string);
-                    node.shutdown();
-                    return -1;
-                }
-                timestamps.seekg(30*entries_played);
-                getline(timestamps,str_support);
-                cv_bridge_img.header.stamp = parseTime(str_support).stamp;
+                cv_bridge_img.header.stamp = parseTime(timestamps_image02[entries_played]).stamp;
                 ros_msg01.header.stamp = ros_cameraInfoMsg_camera01.header.stamp = cv_bridge_img.header.stamp;
             }
             cv_bridge_img.image = cv_image01;
@@ -1208,51 +1406,24 @@ int main(int argc, char **argv)
         if(options.velodyne || options.all_data)
         {            
             header_support.stamp = current_timestamp;
-            full_filename_velodyne = dir_velodyne_points + boost::str(boost::format("%010d") % entries_played ) + ".bin";
 
-            if (!options.timestamps)
-                publish_velodyne(map_pub, full_filename_velodyne,&header_support);
-            else
+            // NULL if the file could not be read, read_velodyne has already reported it
+            if (frame.velodyne)
             {
-                str_support = dir_timestamp_velodyne + "timestamps.txt";
-                ifstream timestamps(str_support.c_str());
-                if (!timestamps.is_open())
+                if (options.timestamps)
                 {
-                    string timestamps_string;
-                    timestamps >> timestamps_string;
-                    ROS_ERROR_STREAM("Fail to open " << timestamps_string);
-                    node.shutdown();
-                    return -1;
+                    header_support.stamp = parseTime(timestamps_velodyne[entries_played]).stamp;
+                    header_support.seq = progress.count();
                 }
-                timestamps.seekg(30*entries_played);
-                getline(timestamps,str_support);
-                header_support.stamp = parseTime(str_support).stamp;
-                header_support.seq = progress.count();
-                publish_velodyne(map_pub, full_filename_velodyne,&header_support);
+                publish_velodyne(map_pub, frame.velodyne,&header_support);
             }
-
-
         }
 
         if(options.gps || options.all_data)
         {
             header_support.stamp = current_timestamp; //ros::Time::now();
             if (options.timestamps)
-            {
-                str_support = dir_timestamp_oxts + "timestamps.txt";
-                ifstream timestamps(str_support.c_str());
-                if (!timestamps.is_open())
-                {
-                    string timestamps_string;
-                    timestamps >> timestamps_string;
-                    ROS_ERROR_STREAM("Fail to open " << timestamps_string);
-                    node.shutdown();
-                    return -1;
-                }
-                timestamps.seekg(30*entries_played);
-                getline(timestamps,str_support);
-                header_support.stamp = parseTime(str_support).stamp;
-            }
+                header_support.stamp = parseTime(timestamps_oxts[entries_played]).stamp;
 
             full_filename_oxts = dir_oxts + boost::str(boost::format("%010d") % entries_played ) + ".txt";
             if (!getGPS(full_filename_oxts,&ros_msgGpsFix,&header_support))
@@ -1279,21 +1450,7 @@ int main(int argc, char **argv)
         {
             header_support.stamp = current_timestamp; //ros::Time::now();
             if (options.timestamps)
-            {
-                str_support = dir_timestamp_oxts + "timestamps.txt";
-                ifstream timestamps(str_support.c_str());
-                if (!timestamps.is_open())
-                {
-                    string timestamps_string;
-                    timestamps >> timestamps_string;
-                     ROS_ERROR_STREAM("Fail to open " << timestamps_string);
-                    node.shutdown();
-                    return -1;
-                }
-                timestamps.seekg(30*entries_played);
-                getline(timestamps,str_support);
-                header_support.stamp = parseTime(str_support).stamp;
-            }
+                header_support.stamp = parseTime(timestamps_oxts[entries_played]).stamp;
 
 
             full_filename_oxts = dir_oxts + boost::str(boost::format("%010d") % entries_played ) + ".txt";
@@ -1309,10 +1466,18 @@ int main(int argc, char **argv)
 
         ++progress;
         entries_played++;
-        loop_rate.sleep();
+        frames_played++;
+        if (!options.maxRate)
+            loop_rate.sleep();
     }
     while(entries_played<=total_entries-1 && ros::ok());
 
+    // Throughput of the replay, the time waiting for the decoders tells whether the replay is decode bound
+    double replay_time = (ros::WallTime::now() - replay_start).toSec();
+    ROS_INFO_STREAM(boost::format("Played %d frames in %.3f s (%.2f frames/s), %.3f s waiting for the decoders")
+                    % frames_played % replay_time % (replay_time > 0.0 ? frames_played / replay_time : 0.0)
+                    % decoder_wait.toSec());
+
 
     if(options.viewer)
     {
@@ -0,0 +1,447 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAP_TOOLS_PCD_TILING_H
+#define MAP_TOOLS_PCD_TILING_H
+
+// Out-of-core building blocks for map preparation. Input PCDs are read in chunks, points are spilled to one
+// temporary file per tile, and tiles are then processed independently, so memory use is bounded by the chunk size,
+// the spill buffer and the largest tile instead of by the size of the map.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <pcl/PCLPointCloud2.h>
+#include <pcl/common/io.h>
+#include <pcl/conversions.h>
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+namespace map_tools
+{
+// Reads the points of a PCD in chunks. Binary PCDs are streamed from disk, ASCII and compressed PCDs can not be
+// split and are loaded as a whole, so only one such file is in memory at a time.
+template <class PointT>
+class PcdChunkReader
+{
+public:
+  PcdChunkReader() : fp_(nullptr), remaining_(0), loaded_offset_(0)
+  {
+  }
+
+  ~PcdChunkReader()
+  {
+    close();
+  }
+
+  bool open(const std::string& path)
+  {
+    close();
+    Eigen::Vector4f origin;
+    Eigen::Quaternionf orientation;
+    int version, data_type;
+    unsigned int data_idx;
+    pcl::PCDReader reader;
+    if (reader.readHeader(path, header_, origin, orientation, version, data_type, data_idx) != 0)
+      return false;
+
+    if (data_type == 1)
+    {
+      fp_ = fopen(path.c_str(), "rb");
+      if (fp_ == nullptr || fseek(fp_, data_idx, SEEK_SET) != 0)
+      {
+        close();
+        return false;
+      }
+      remaining_ = static_cast<size_t>(header_.width) * header_.height;
+      pcl::createMapping<PointT>(header_.fields, field_map_);
+      return true;
+    }
+
+    loaded_.reset(new pcl::PointCloud<PointT>);
+    loaded_offset_ = 0;
+    if (pcl::io::loadPCDFile<PointT>(path, *loaded_) == -1)
+    {
+      loaded_.reset();
+      return false;
+    }
+    remaining_ = loaded_->size();
+    return true;
+  }
+
+  void close()
+  {
+    if (fp_ != nullptr)
+      fclose(fp_);
+    fp_ = nullptr;
+    loaded_.reset();
+    remaining_ = 0;
+  }
+
+  // Points which have not been read yet.
+  size_t remaining() const
+  {
+    return remaining_;
+  }
+
+  // Replace chunk with the next max_points points, return the number of points read, 0 at the end of the file.
+  size_t read(pcl::PointCloud<PointT>& chunk, size_t max_points)
+  {
+    chunk.clear();
+    const size_t count = std::min(max_points, remaining_);
+    if (count == 0)
+      return 0;
+
+    if (loaded_)
+    {
+      chunk.points.assign(loaded_->points.begin() + loaded_offset_, loaded_->points.begin() + loaded_offset_ + count);
+      loaded_offset_ += count;
+    }
+    else
+    {
+      blob_.fields = header_.fields;
+      blob_.point_step = header_.point_step;
+      blob_.is_bigendian = header_.is_bigendian;
+      blob_.is_dense = header_.is_dense;
+      blob_.height = 1;
+      blob_.width = static_cast<uint32_t>(count);
+      blob_.row_step = blob_.width * blob_.point_step;
+      blob_.data.resize(blob_.row_step);
+      if (fread(blob_.data.data(), blob_.point_step, count, fp_) != count)
+      {
+        remaining_ = 0;
+        return 0;
+      }
+      pcl::fromPCLPointCloud2(blob_, chunk, field_map_);
+    }
+    chunk.width = static_cast<uint32_t>(chunk.points.size());
+    chunk.height = 1;
+    remaining_ -= count;
+    return count;
+  }
+
+private:
+  FILE* fp_;
+  pcl::PCLPointCloud2 header_;
+  pcl::PCLPointCloud2 blob_;
+  pcl::MsgFieldMap field_map_;
+  size_t remaining_;
+  std::unique_ptr<pcl::PointCloud<PointT>> loaded_;
+  size_t loaded_offset_;
+};
+
+struct Tile
+{
+  int index_x;
+  int index_y;
+  std::string spill_path;
+  size_t num_points;
+};
+
+// Sorts points into square tiles of tile_size meters, aligned to multiples of tile_size. Points are buffered in
+// memory and appended to the spill file of their tile whenever the buffers exceed buffer_bytes.
+template <class PointT>
+class TileSpiller
+{
+public:
+  TileSpiller(const std::string& spill_dir, double tile_size, size_t buffer_bytes)
+    : spill_dir_(spill_dir)
+    , tile_size_(tile_size)
+    , max_buffered_points_(std::max<size_t>(buffer_bytes / sizeof(PointT), 1))
+    , buffered_points_(0)
+    , last_key_(0)
+    , last_buffer_(nullptr)
+    , good_(true)
+  {
+  }
+
+  void add(const pcl::PointCloud<PointT>& cloud)
+  {
+    for (const auto& point : cloud.points)
+    {
+      if (!std::isfinite(point.x) || !std::isfinite(point.y) || !std::isfinite(point.z))
+        continue;
+      const int index_x = static_cast<int>(std::floor(point.x / tile_size_));
+      const int index_y = static_cast<int>(std::floor(point.y / tile_size_));
+      const int64_t key = (static_cast<int64_t>(index_x) << 32) | static_cast<uint32_t>(index_y);
+      // consecutive points of a scan are mostly in the same tile
+      if (last_buffer_ == nullptr || key != last_key_)
+      {
+        auto it = tiles_.find(key);
+        if (it == tiles_.end())
+        {
+          Tile tile;
+          tile.index_x = index_x;
+          tile.index_y = index_y;
+          tile.spill_path = spill_dir_ + "/" + std::to_string(index_x) + "_" + std::to_string(index_y) + ".bin";
+          tile.num_points = 0;
+          it = tiles_.emplace(key, TileBuffer{ tile, {} }).first;
+          std::remove(tile.spill_path.c_str());
+        }
+        last_key_ = key;
+        last_buffer_ = &it->second;
+      }
+      last_buffer_->points.push_back(point);
+      last_buffer_->tile.num_points++;
+      if (++buffered_points_ >= max_buffered_points_)
+        flush();
+    }
+  }
+
+  // Append all buffered points to the spill files.
+  void flush()
+  {
+    for (auto& entry : tiles_)
+    {
+      TileBuffer& buffer = entry.second;
+      if (buffer.points.empty())
+        continue;
+      FILE* fp = fopen(buffer.tile.spill_path.c_str(), "ab");
+      good_ &= fp != nullptr &&
+                 fwrite(buffer.points.data(), sizeof(PointT), buffer.points.size(), fp) == buffer.points.size();
+      if (fp != nullptr)
+        fclose(fp);
+      buffer.points.clear();
+      buffer.points.shrink_to_fit();
+    }
+    buffered_points_ = 0;
+  }
+
+  // Whether all spill files were written completely.
+  bool good() const
+  {
+    return good_;
+  }
+
+  // Flush and return the tiles in a stable order.
+  std::vector<Tile> finish()
+  {
+    flush();
+    std::vector<Tile> tiles;
+    tiles.reserve(tiles_.size());
+    for (const auto& entry : tiles_)
+      tiles.push_back(entry.second.tile);
+    std::sort(tiles.begin(), tiles.end(), [](const Tile& a, const Tile& b) {
+      return a.index_y != b.index_y ? a.index_y < b.index_y : a.index_x < b.index_x;
+    });
+    return tiles;
+  }
+
+private:
+  struct TileBuffer
+  {
+    Tile tile;
+    std::vector<PointT, Eigen::aligned_allocator<PointT>> points;
+  };
+
+  std::string spill_dir_;
+  double tile_size_;
+  size_t max_buffered_points_;
+  size_t buffered_points_;
+  std::unordered_map<int64_t, TileBuffer> tiles_;
+  int64_t last_key_;
+  TileBuffer* last_buffer_;
+  bool good_;
+};
+
+template <class PointT>
+bool loadSpilledTile(const Tile& tile, pcl::PointCloud<PointT>& cloud)
+{
+  cloud.points.resize(tile.num_points);
+  FILE* fp = fopen(tile.spill_path.c_str(), "rb");
+  if (fp == nullptr)
+    return false;
+  const bool complete = fread(cloud.points.data(), sizeof(PointT), tile.num_points, fp) == tile.num_points;
+  fclose(fp);
+  cloud.width = static_cast<uint32_t>(cloud.points.size());
+  cloud.height = 1;
+  cloud.is_dense = true;
+  return complete;
+}
+
+// VoxelGrid filter in a frame local to origin, so the float coordinates of the map keep their precision.
+template <class PointT>
+void voxelFilter(const pcl::PointCloud<PointT>& input, pcl::PointCloud<PointT>& output, double leaf_size,
+                 const pcl::PointXYZ& origin)
+{
+  typename pcl::PointCloud<PointT>::Ptr local(new pcl::PointCloud<PointT>(input));
+  for (auto& point : local->points)
+  {
+    point.x -= origin.x;
+    point.y -= origin.y;
+    point.z -= origin.z;
+  }
+  pcl::VoxelGrid<PointT> voxel_grid_filter;
+  voxel_grid_filter.setLeafSize(leaf_size, leaf_size, leaf_size);
+  voxel_grid_filter.setInputCloud(local);
+  voxel_grid_filter.filter(output);
+  for (auto& point : output.points)
+  {
+    point.x += origin.x;
+    point.y += origin.y;
+    point.z += origin.z;
+  }
+}
+
+// Writes a binary PCD incrementally. The point count is patched into the header on close, so the points never
+// have to be in memory at once.
+template <class PointT>
+class PcdStreamWriter
+{
+public:
+  PcdStreamWriter() : fp_(nullptr), num_points_(0), point_size_(0)
+  {
+  }
+
+  ~PcdStreamWriter()
+  {
+    close();
+  }
+
+  bool open(const std::string& path)
+  {
+    close();
+    fp_ = fopen(path.c_str(), "wb");
+    if (fp_ == nullptr)
+      return false;
+
+    std::vector<pcl::PCLPointField> fields;
+    pcl::getFields<PointT>(fields);
+    fields_.clear();
+    point_size_ = 0;
+    for (const auto& field : fields)
+    {
+      if (field.name == "_")
+        continue;
+      fields_.push_back(field);
+      point_size_ += pcl::getFieldSize(field.datatype) * field.count;
+    }
+    num_points_ = 0;
+    writeHeader();
+    return true;
+  }
+
+  void append(const pcl::PointCloud<PointT>& cloud)
+  {
+    // pack the fields without the padding of PointT, as PCDWriter::writeBinary does
+    row_buffer_.resize(cloud.points.size() * point_size_);
+    uint8_t* out = row_buffer_.data();
+    for (const auto& point : cloud.points)
+    {
+      const uint8_t* in = reinterpret_cast<const uint8_t*>(&point);
+      for (const auto& field : fields_)
+      {
+        const size_t size = pcl::getFieldSize(field.datatype) * field.count;
+        memcpy(out, in + field.offset, size);
+        out += size;
+      }
+    }
+    fwrite(row_buffer_.data(), 1, row_buffer_.size(), fp_);
+    num_points_ += cloud.points.size();
+  }
+
+  size_t size() const
+  {
+    return num_points_;
+  }
+
+  void close()
+  {
+    if (fp_ == nullptr)
+      return;
+    fseek(fp_, 0, SEEK_SET);
+    writeHeader();
+    fclose(fp_);
+    fp_ = nullptr;
+  }
+
+private:
+  FILE* fp_;
+  std::vector<pcl::PCLPointField> fields_;
+  size_t num_points_;
+  size_t point_size_;
+  std::vector<uint8_t> row_buffer_;
+
+  void writeHeader()
+  {
+    std::string names, sizes, types, counts;
+    for (const auto& field : fields_)
+    {
+      names += " " + field.name;
+      sizes += " " + std::to_string(pcl::getFieldSize(field.datatype));
+      types += std::string(" ") + pcl::getFieldType(field.datatype);
+      counts += " " + std::to_string(field.count);
+    }
+    // fixed width counts, so the header has the same length when it is rewritten
+    fprintf(fp_,
+            "# .PCD v0.7 - Point Cloud Data file format\nVERSION 0.7\nFIELDS%s\nSIZE%s\nTYPE%s\nCOUNT%s\n"
+            "WIDTH %012zu\nHEIGHT 1\nVIEWPOINT 0 0 0 1 0 0 0\nPOINTS %012zu\nDATA binary\n",
+            names.c_str(), sizes.c_str(), types.c_str(), counts.c_str(), num_points_, num_points_);
+  }
+};
+
+struct Area
+{
+  std::string path;
+  double x_min;
+  double y_min;
+  double z_min;
+  double x_max;
+  double y_max;
+  double z_max;
+};
+
+template <class PointT>
+Area calcArea(const std::string& path, const pcl::PointCloud<PointT>& cloud)
+{
+  Area area;
+  area.path = path;
+  area.x_min = area.y_min = area.z_min = std::numeric_limits<double>::max();
+  area.x_max = area.y_max = area.z_max = -std::numeric_limits<double>::max();
+  for (const auto& point : cloud.points)
+  {
+    area.x_min = std::min<double>(area.x_min, point.x);
+    area.y_min = std::min<double>(area.y_min, point.y);
+    area.z_min = std::min<double>(area.z_min, point.z);
+    area.x_max = std::max<double>(area.x_max, point.x);
+    area.y_max = std::max<double>(area.y_max, point.y);
+    area.z_max = std::max<double>(area.z_max, point.z);
+  }
+  return area;
+}
+
+// Write areas in the format of pcd_arealist, which points_map_loader reads.
+bool writeAreaList(const std::string& path, const std::vector<Area>& areas);
+
+// Create a unique directory for spill files below parent, and remove it with its files.
+std::string createSpillDirectory(const std::string& parent, const std::string& name);
+void removeSpillDirectory(const std::string& path);
+
+// Throughput report of one stage, e.g. "tiling: 123456789 points in 12.3 s (10.0 M points/s)".
+void printThroughput(const std::string& stage, size_t num_points, double seconds);
+}  // namespace map_tools
+
+#endif  // MAP_TOOLS_PCD_TILING_H
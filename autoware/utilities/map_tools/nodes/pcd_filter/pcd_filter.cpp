@@ -3,43 +3,94 @@ PCD downsampling program using VoxelGrid filter.
 Yuki Kitsukawa
 */
 
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include <pcl/io/pcd_io.h>
 #include <pcl/point_types.h>
-#include <pcl/filters/voxel_grid.h>
-
-template <class T>
-pcl::PointXYZ getReferencePoint(const T input_cloud){
-    pcl::PointXYZ ref_point;
-    for(auto pt: input_cloud->points){
-        //make sure the point is a valid point
-        if(std::isfinite(pt.x) && std::isfinite(pt.y) && std::isfinite(pt.z)){
-            ref_point.x = pt.x;
-            ref_point.y = pt.y;
-            ref_point.z = pt.z;
-            break;
-        }
-    }
-    return ref_point;
+
+#include "map_tools/pcd_tiling.h"
+
+// Edge length of the tiles the input is split into, rounded up to a multiple of the leaf size
+// so that no voxel is split between two tiles.
+const double TILE_SIZE = 100.0;
+const size_t CHUNK_POINTS = 1000000;
+const size_t BUFFER_BYTES = 1024UL * 1024 * 1024;
+
+double secondsSince(const std::chrono::steady_clock::time_point& begin){
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
 }
 
-template <class T>
-void translatePointCloud(const T input_cloud, T& output_cloud,const pcl::PointXYZ origin){
-    output_cloud->points.clear();
-    for(auto in_pt: input_cloud->points){
-        auto out_pt = in_pt;
-        out_pt.x -= origin.x;
-        out_pt.y -= origin.y;
-        out_pt.z -= origin.z;
-        output_cloud->push_back(out_pt);
+// Downsample input to output without holding the map in memory. The input is streamed into tiles,
+// and tiles are filtered in parallel, each in a frame local to its corner so the float coordinates
+// keep their precision, and appended to the output in order.
+template <class PointT>
+bool filterPCD(const std::string& input, const std::string& output, double leaf_size){
+  map_tools::PcdChunkReader<PointT> reader;
+  if (!reader.open(input)){
+    std::cout << "Couldn't find " << input << "." << std::endl;
+    return false;
+  }
+  std::cout << "Input: " << input << " (" << reader.remaining() << " points) " << std::endl;
+
+  const std::string parent = output.substr(0, output.find_last_of('/') + 1);
+  const std::string spill_dir = map_tools::createSpillDirectory(parent, "pcd_filter");
+  if (spill_dir.empty()){
+    std::cout << "Couldn't create a temporary directory in " << (parent.empty() ? "." : parent) << "." << std::endl;
+    return false;
+  }
+
+  auto begin = std::chrono::steady_clock::now();
+  const double tile_size = leaf_size * std::ceil(TILE_SIZE / leaf_size);
+  map_tools::TileSpiller<PointT> spiller(spill_dir, tile_size, BUFFER_BYTES);
+  pcl::PointCloud<PointT> chunk;
+  size_t input_num = 0;
+  while (reader.read(chunk, CHUNK_POINTS) > 0){
+    spiller.add(chunk);
+    input_num += chunk.size();
+  }
+  const std::vector<map_tools::Tile> tiles = spiller.finish();
+  map_tools::printThroughput("Tiling", input_num, secondsSince(begin));
+
+  map_tools::PcdStreamWriter<PointT> writer;
+  if (!spiller.good() || !writer.open(output)){
+    std::cout << "Couldn't write " << output << "." << std::endl;
+    map_tools::removeSpillDirectory(spill_dir);
+    return false;
+  }
+
+  begin = std::chrono::steady_clock::now();
+  bool complete = true;
+#pragma omp parallel for schedule(dynamic) ordered
+  for (size_t i = 0; i < tiles.size(); i++){
+    const map_tools::Tile& tile = tiles[i];
+    pcl::PointCloud<PointT> cloud, filtered_cloud;
+    const bool loaded = map_tools::loadSpilledTile(tile, cloud);
+    unlink(tile.spill_path.c_str());
+    if (loaded){
+      pcl::PointXYZ origin(tile.index_x * tile_size, tile.index_y * tile_size, 0.0f);
+      map_tools::voxelFilter(cloud, filtered_cloud, leaf_size, origin);
     }
-    output_cloud->height = input_cloud->height;
-    output_cloud->width = input_cloud->width;
-}
+#pragma omp ordered
+    {
+      complete &= loaded;
+      writer.append(filtered_cloud);
+    }
+  }
+  writer.close();
+  map_tools::removeSpillDirectory(spill_dir);
+  map_tools::printThroughput("Filtering", input_num, secondsSince(begin));
 
+  std::cout << "Output: " << output << " (" << writer.size() << " points) " << std::endl;
+  std::cout << "Voxel Leaf Size: " << leaf_size << std::endl << std::endl;
+  return complete;
+}
 
 int main (int argc, char** argv)
 {
@@ -54,124 +105,27 @@ int main (int argc, char** argv)
   double leaf_size = std::stod(argv[2]);
 
   for(i = 3; i < argc; i++){
-    // Loading input_cloud.
     std::string input = argv[i];
 
+    int tmp = input.find_last_of("/");
+    std::string prefix = std::to_string(leaf_size);
+    prefix = prefix.substr(0, 4);
+    prefix += "_";
+    std::string output = input;
+    output.insert(tmp+1, prefix);
+
+    bool filtered = false;
     if(point_type == "PointXYZ"){
-      pcl::PointCloud<pcl::PointXYZ>::Ptr input_cloud (new pcl::PointCloud<pcl::PointXYZ>);
-      if (pcl::io::loadPCDFile<pcl::PointXYZ> (input, *input_cloud) == -1){
-        std::cout << "Couldn't find " << input << "." << std::endl;
-        break;
-      }
-      std::cout << "Input: " << input << " (" << input_cloud->size () << " points) " << std::endl;
-
-      //translate pointcloud to local frame to avoid losing precision
-      pcl::PointCloud<pcl::PointXYZ>::Ptr translated_input_cloud (new pcl::PointCloud<pcl::PointXYZ>);
-      pcl::PointXYZ origin = getReferencePoint(input_cloud);
-      translatePointCloud(input_cloud, translated_input_cloud, origin);
-
-      // Filtering input scan
-      pcl::PointCloud<pcl::PointXYZ>::Ptr filtered_cloud (new pcl::PointCloud<pcl::PointXYZ>);
-      pcl::VoxelGrid<pcl::PointXYZ> voxel_grid_filter;
-      voxel_grid_filter.setLeafSize (leaf_size, leaf_size, leaf_size);
-      voxel_grid_filter.setInputCloud (translated_input_cloud);
-      voxel_grid_filter.filter (*filtered_cloud);
-
-      //translate pointcloud back to original frame
-      pcl::PointCloud<pcl::PointXYZ>::Ptr translated_filtered_cloud (new pcl::PointCloud<pcl::PointXYZ>);
-      pcl::PointXYZ inverse_origin;
-      inverse_origin.x = -origin.x;
-      inverse_origin.y = -origin.y;
-      inverse_origin.z = -origin.z;
-      translatePointCloud(filtered_cloud, translated_filtered_cloud, inverse_origin);
-
-      int tmp = input.find_last_of("/");
-      std::string prefix = std::to_string(leaf_size);
-      prefix = prefix.substr(0, 4);
-      prefix += "_";
-      std::string output = input.insert(tmp+1, prefix);
-
-      pcl::io::savePCDFileBinary(output, *translated_filtered_cloud);
-      std::cout << "Output: " << output << " (" << translated_filtered_cloud->size () << " points) " << std::endl;
-      std::cout << "Voxel Leaf Size: " << leaf_size << std::endl << std::endl;
+      filtered = filterPCD<pcl::PointXYZ>(input, output, leaf_size);
     }
-
     else if(point_type == "PointXYZI"){
-      pcl::PointCloud<pcl::PointXYZI>::Ptr input_cloud (new pcl::PointCloud<pcl::PointXYZI>);
-      if (pcl::io::loadPCDFile<pcl::PointXYZI> (input, *input_cloud) == -1){
-        std::cout << "Couldn't find " << input << "." << std::endl;
-        break;
-      }
-      std::cout << "Input: " << input << " (" << input_cloud->size () << " points) " << std::endl;
-
-      //translate pointcloud to local frame to avoid losing precision
-      pcl::PointCloud<pcl::PointXYZI>::Ptr translated_input_cloud (new pcl::PointCloud<pcl::PointXYZI>);
-      pcl::PointXYZ origin = getReferencePoint(input_cloud);
-      translatePointCloud(input_cloud, translated_input_cloud, origin);
-
-      // Filtering input scan
-      pcl::PointCloud<pcl::PointXYZI>::Ptr filtered_cloud (new pcl::PointCloud<pcl::PointXYZI>);
-      pcl::VoxelGrid<pcl::PointXYZI> voxel_grid_filter;
-      voxel_grid_filter.setLeafSize (leaf_size, leaf_size, leaf_size);
-      voxel_grid_filter.setInputCloud (translated_input_cloud);
-      voxel_grid_filter.filter (*filtered_cloud);
-
-      //translate pointcloud back to original frame
-      pcl::PointCloud<pcl::PointXYZI>::Ptr translated_filtered_cloud (new pcl::PointCloud<pcl::PointXYZI>);
-      pcl::PointXYZ inverse_origin;
-      inverse_origin.x = -origin.x;
-      inverse_origin.y = -origin.y;
-      inverse_origin.z = -origin.z;
-      translatePointCloud(filtered_cloud, translated_filtered_cloud, inverse_origin);
-
-      int tmp = input.find_last_of("/");
-      std::string prefix = std::to_string(leaf_size);
-      prefix = prefix.substr(0, 4);
-      prefix += "_";
-      std::string output = input.insert(tmp+1, prefix);
-
-      pcl::io::savePCDFileBinary(output, *translated_filtered_cloud);
-      std::cout << "Output: " << output << " (" << translated_filtered_cloud->size () << " points) " << std::endl;
-      std::cout << "Voxel Leaf Size: " << leaf_size << std::endl << std::endl;
+      filtered = filterPCD<pcl::PointXYZI>(input, output, leaf_size);
     }
-
     else if(point_type == "PointXYZRGB"){
-      pcl::PointCloud<pcl::PointXYZRGB>::Ptr input_cloud (new pcl::PointCloud<pcl::PointXYZRGB>);
-      if (pcl::io::loadPCDFile<pcl::PointXYZRGB> (input, *input_cloud) == -1){
-        std::cout << "Couldn't find " << input << "." << std::endl;
-        break;
-      }
-      std::cout << "Input: " << input << " (" << input_cloud->size () << " points) " << std::endl;
-
-      //translate pointcloud to local frame to avoid losing precision
-      pcl::PointCloud<pcl::PointXYZRGB>::Ptr translated_input_cloud (new pcl::PointCloud<pcl::PointXYZRGB>);
-      pcl::PointXYZ origin = getReferencePoint(input_cloud);
-      translatePointCloud(input_cloud, translated_input_cloud, origin);
-
-      // Filtering input scan
-      pcl::PointCloud<pcl::PointXYZRGB>::Ptr filtered_cloud (new pcl::PointCloud<pcl::PointXYZRGB>);
-      pcl::VoxelGrid<pcl::PointXYZRGB> voxel_grid_filter;
-      voxel_grid_filter.setLeafSize (leaf_size, leaf_size, leaf_size);
-      voxel_grid_filter.setInputCloud (translated_input_cloud);
-      voxel_grid_filter.filter (*filtered_cloud);
-
-      //translate pointcloud back to original frame
-      pcl::PointCloud<pcl::PointXYZRGB>::Ptr translated_filtered_cloud (new pcl::PointCloud<pcl::PointXYZRGB>);
-      pcl::PointXYZ inverse_origin;
-      inverse_origin.x = -origin.x;
-      inverse_origin.y = -origin.y;
-      inverse_origin.z = -origin.z;
-      translatePointCloud(filtered_cloud, translated_filtered_cloud, inverse_origin);
-
-      int tmp = input.find_last_of("/");
-      std::string prefix = std::to_string(leaf_size);
-      prefix = prefix.substr(0, 4);
-      prefix += "_";
-      std::string output = input.insert(tmp+1, prefix);
-
-      pcl::io::savePCDFileBinary(output, *translated_filtered_cloud);
-      std::cout << "Output: " << output << " (" << translated_filtered_cloud->size () << " points) " << std::endl;
-      std::cout << "Voxel Leaf Size: " << leaf_size << std::endl << std::endl;
+      filtered = filterPCD<pcl::PointXYZRGB>(input, output, leaf_size);
+    }
+    if(!filtered){
+      break;
     }
   }
 
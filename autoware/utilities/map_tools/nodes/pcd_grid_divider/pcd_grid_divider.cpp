@@ -20,6 +20,11 @@
  *  Created on: May 15, 2018
  */
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <pcl/io/pcd_io.h>
 #include <pcl/point_types.h>
@@ -27,333 +32,165 @@
 #include <string>
 #include <vector>
 
-struct pcd_xyz_grid {
-  std::string filename;
-  int grid_id;
-  int grid_id_x;
-  int grid_id_y;
-  int lower_bound_x;
-  int lower_bound_y;
-  int upper_bound_x;
-  int upper_bound_y;
-  pcl::PointCloud<pcl::PointXYZ> cloud;
-};
+#include "map_tools/pcd_tiling.h"
 
-struct pcd_xyzi_grid {
-  std::string filename;
-  int grid_id;
-  int grid_id_x;
-  int grid_id_y;
-  int lower_bound_x;
-  int lower_bound_y;
-  int upper_bound_x;
-  int upper_bound_y;
-  pcl::PointCloud<pcl::PointXYZI> cloud;
+struct Options {
+  int grid_size = 0;
+  std::string output_dir;
+  double leaf_size = 0.0;
+  bool write_arealist = false;
+  size_t buffer_bytes = 1024UL * 1024 * 1024;
+  size_t chunk_points = 1000000;
+  std::vector<std::string> inputs;
 };
 
-struct pcd_xyzrgb_grid {
-  std::string filename;
-  int grid_id;
-  int grid_id_x;
-  int grid_id_y;
-  int lower_bound_x;
-  int lower_bound_y;
-  int upper_bound_x;
-  int upper_bound_y;
-  pcl::PointCloud<pcl::PointXYZRGB> cloud;
-};
-
-int main(int argc, char **argv) {
+double secondsSince(const std::chrono::steady_clock::time_point &begin) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       begin)
+      .count();
+}
 
-  if (argc < 4) {
-    std::cout << "Usage: rosrun map_tools pcd_grid_divider \"point_type "
-                 "[PointXYZ|PointXYZI|PointXYZRGB]\" \"grid_size\" \"output "
-                 "directory\" \"***.pcd\" "
-              << std::endl;
+// Stream all input PCDs into per-grid spill files, then filter and write the
+// grids in parallel. Only one chunk, the spill buffer and one grid per thread
+// are in memory at a time, however large the map is.
+template <class PointT> int divide(const Options &options) {
+  const std::string parent =
+      options.output_dir.substr(0, options.output_dir.find_last_of('/') + 1);
+  const std::string spill_dir =
+      map_tools::createSpillDirectory(parent, "pcd_grid_divider");
+  if (spill_dir.empty()) {
+    std::cout << "Failed to create a temporary directory in "
+              << (parent.empty() ? "." : parent) << "." << std::endl;
+    return 1;
   }
 
-  std::string point_type = argv[1];
-  int grid_size = std::stoi(argv[2]);
-  std::string output_dir = argv[3];
-
-  if (point_type == "PointXYZ") {
-    pcl::PointCloud<pcl::PointXYZ> map;
-
-    // Load all PCDs
-    pcl::PointCloud<pcl::PointXYZ> tmp;
-    for (int i = 4; i < argc; i++) {
-      if (pcl::io::loadPCDFile<pcl::PointXYZ>(argv[i], tmp) == -1) {
-        std::cout << "Failed to load " << argv[i] << "." << std::endl;
-      }
-      map += tmp;
-      std::cout << "Finished to load " << argv[i] << "." << std::endl;
+  // Assign all points to appropriate grid according to their x/y value
+  auto begin = std::chrono::steady_clock::now();
+  map_tools::TileSpiller<PointT> spiller(spill_dir, options.grid_size,
+                                         options.buffer_bytes);
+  map_tools::PcdChunkReader<PointT> reader;
+  pcl::PointCloud<PointT> chunk;
+  size_t input_num = 0;
+  for (const auto &input : options.inputs) {
+    if (!reader.open(input)) {
+      std::cout << "Failed to load " << input << "." << std::endl;
+      continue;
     }
-
-    std::cout << "Finished to load all PCDs: " << map.size() << " points."
-              << std::endl;
-
-    double min_x = 10000000000.0;
-    double max_x = -10000000000.0;
-    double min_y = 10000000000.0;
-    double max_y = -10000000000.0;
-
-    // Search minimum and maximum points along x and y axis.
-    for (pcl::PointCloud<pcl::PointXYZ>::const_iterator p = map.begin();
-         p != map.end(); p++) {
-      if (p->x < min_x) {
-        min_x = p->x;
-      }
-      if (p->x > max_x) {
-        max_x = p->x;
-      }
-      if (p->y < min_y) {
-        min_y = p->y;
-      }
-      if (p->y > max_y) {
-        max_y = p->y;
-      }
-    }
-
-    // Find minimum and maximum boundary
-    int min_x_b = grid_size * static_cast<int>(floor(min_x / grid_size));
-    int max_x_b = grid_size * static_cast<int>(floor(max_x / grid_size) + 1);
-    int min_y_b = grid_size * static_cast<int>(floor(min_y / grid_size));
-    int max_y_b = grid_size * static_cast<int>(floor(max_y / grid_size) + 1);
-
-    // Number of grid along x and y axis
-    int div_x = (max_x_b - min_x_b) / grid_size;
-    int div_y = (max_y_b - min_y_b) / grid_size;
-    int grid_num = div_x * div_y;
-
-    // Define filename, lower/upper bound of every grid
-    std::vector<pcd_xyz_grid> grids(grid_num);
-    for (int y = 0; y < div_y; y++) {
-      for (int x = 0; x < div_x; x++) {
-        int id = div_x * y + x;
-        grids[id].grid_id = id;
-        grids[id].grid_id_x = x;
-        grids[id].grid_id_y = y;
-        grids[id].lower_bound_x = min_x_b + grid_size * x;
-        grids[id].lower_bound_y = min_y_b + grid_size * y;
-        grids[id].upper_bound_x = min_x_b + grid_size * (x + 1);
-        grids[id].upper_bound_y = min_y_b + grid_size * (y + 1);
-        grids[id].filename = output_dir + std::to_string(grid_size) + "_" +
-                             std::to_string(grids[id].lower_bound_x) + "_" +
-                             std::to_string(grids[id].lower_bound_y) + ".pcd";
-      }
-    }
-
-    // Assign all points to appropriate grid according to their x/y value
-    for (pcl::PointCloud<pcl::PointXYZ>::const_iterator p = map.begin();
-         p != map.end(); p++) {
-      int idx = static_cast<int>(
-          floor((p->x - static_cast<float>(min_x_b)) / grid_size));
-      int idy = static_cast<int>(
-          floor((p->y - static_cast<float>(min_y_b)) / grid_size));
-
-      int id = idy * div_x + idx;
-
-      const pcl::PointXYZ &tmp = *p;
-      grids[id].cloud.points.push_back(tmp);
-    }
-
-    int points_num = 0;
-    for (int i = 0; i < grid_num; i++) {
-      if (grids[i].cloud.points.size() > 0) {
-        pcl::io::savePCDFileBinary(grids[i].filename, grids[i].cloud);
-        std::cout << "Wrote " << grids[i].cloud.points.size() << " points to "
-                  << grids[i].filename << "." << std::endl;
-        points_num += grids[i].cloud.points.size();
-      }
+    while (reader.read(chunk, options.chunk_points) > 0) {
+      spiller.add(chunk);
+      input_num += chunk.size();
     }
-    std::cout << "Total points num: " << points_num << " points." << std::endl;
+    std::cout << "Finished to load " << input << "." << std::endl;
   }
-
-  else if (point_type == "PointXYZI") {
-    pcl::PointCloud<pcl::PointXYZI> map;
-
-    // Load all PCDs
-    pcl::PointCloud<pcl::PointXYZI> tmp;
-    for (int i = 4; i < argc; i++) {
-      if (pcl::io::loadPCDFile<pcl::PointXYZI>(argv[i], tmp) == -1) {
-        std::cout << "Failed to load " << argv[i] << "." << std::endl;
-      }
-      map += tmp;
-      std::cout << "Finished to load " << argv[i] << "." << std::endl;
-    }
-
-    std::cout << "Finished to load all PCDs: " << map.size() << " points."
+  const std::vector<map_tools::Tile> tiles = spiller.finish();
+  if (!spiller.good()) {
+    std::cout << "Failed to write temporary files to " << spill_dir << "."
               << std::endl;
-
-    double min_x = 10000000000.0;
-    double max_x = -10000000000.0;
-    double min_y = 10000000000.0;
-    double max_y = -10000000000.0;
-
-    // Search minimum and maximum points along x and y axis.
-    for (pcl::PointCloud<pcl::PointXYZI>::const_iterator p = map.begin();
-         p != map.end(); p++) {
-      if (p->x < min_x) {
-        min_x = p->x;
-      }
-      if (p->x > max_x) {
-        max_x = p->x;
-      }
-      if (p->y < min_y) {
-        min_y = p->y;
-      }
-      if (p->y > max_y) {
-        max_y = p->y;
-      }
-    }
-
-    // Find minimum and maximum boundary
-    int min_x_b = grid_size * static_cast<int>(floor(min_x / grid_size));
-    int max_x_b = grid_size * static_cast<int>(floor(max_x / grid_size) + 1);
-    int min_y_b = grid_size * static_cast<int>(floor(min_y / grid_size));
-    int max_y_b = grid_size * static_cast<int>(floor(max_y / grid_size) + 1);
-
-    // Number of grid along x and y axis
-    int div_x = (max_x_b - min_x_b) / grid_size;
-    int div_y = (max_y_b - min_y_b) / grid_size;
-    int grid_num = div_x * div_y;
-
-    // Define filename, lower/upper bound of every grid
-    std::vector<pcd_xyzi_grid> grids(grid_num);
-    for (int y = 0; y < div_y; y++) {
-      for (int x = 0; x < div_x; x++) {
-        int id = div_x * y + x;
-        grids[id].grid_id = id;
-        grids[id].grid_id_x = x;
-        grids[id].grid_id_y = y;
-        grids[id].lower_bound_x = min_x_b + grid_size * x;
-        grids[id].lower_bound_y = min_y_b + grid_size * y;
-        grids[id].upper_bound_x = min_x_b + grid_size * (x + 1);
-        grids[id].upper_bound_y = min_y_b + grid_size * (y + 1);
-        grids[id].filename = output_dir + std::to_string(grid_size) + "_" +
-                             std::to_string(grids[id].lower_bound_x) + "_" +
-                             std::to_string(grids[id].lower_bound_y) + ".pcd";
-      }
+    map_tools::removeSpillDirectory(spill_dir);
+    return 1;
+  }
+  std::cout << "Finished to load all PCDs: " << input_num << " points."
+            << std::endl;
+  map_tools::printThroughput("Tiling", input_num, secondsSince(begin));
+
+  begin = std::chrono::steady_clock::now();
+  std::vector<map_tools::Area> areas(tiles.size());
+  size_t points_num = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+ : points_num)
+  for (size_t i = 0; i < tiles.size(); i++) {
+    const map_tools::Tile &tile = tiles[i];
+    const int lower_bound_x = options.grid_size * tile.index_x;
+    const int lower_bound_y = options.grid_size * tile.index_y;
+    const std::string filename =
+        options.output_dir + std::to_string(options.grid_size) + "_" +
+        std::to_string(lower_bound_x) + "_" + std::to_string(lower_bound_y) +
+        ".pcd";
+
+    pcl::PointCloud<PointT> cloud;
+    if (!map_tools::loadSpilledTile(tile, cloud)) {
+#pragma omp critical
+      std::cout << "Failed to read " << tile.spill_path << "." << std::endl;
+      continue;
     }
+    unlink(tile.spill_path.c_str());
 
-    // Assign all points to appropriate grid according to their x/y value
-    for (pcl::PointCloud<pcl::PointXYZI>::const_iterator p = map.begin();
-         p != map.end(); p++) {
-      int idx = static_cast<int>(
-          floor((p->x - static_cast<float>(min_x_b)) / grid_size));
-      int idy = static_cast<int>(
-          floor((p->y - static_cast<float>(min_y_b)) / grid_size));
-
-      int id = idy * div_x + idx;
-
-      const pcl::PointXYZI &tmp = *p;
-      grids[id].cloud.points.push_back(tmp);
+    if (options.leaf_size > 0.0) {
+      pcl::PointXYZ origin(lower_bound_x, lower_bound_y, 0.0f);
+      pcl::PointCloud<PointT> filtered;
+      map_tools::voxelFilter(cloud, filtered, options.leaf_size, origin);
+      cloud.swap(filtered);
     }
 
-    int points_num = 0;
-    for (int i = 0; i < grid_num; i++) {
-      if (grids[i].cloud.points.size() > 0) {
-        pcl::io::savePCDFileBinary(grids[i].filename, grids[i].cloud);
-        std::cout << "Wrote " << grids[i].cloud.points.size() << " points to "
-                  << grids[i].filename << "." << std::endl;
-        points_num += grids[i].cloud.points.size();
-      }
-    }
-    std::cout << "Total points num: " << points_num << " points." << std::endl;
+    pcl::io::savePCDFileBinary(filename, cloud);
+    areas[i] = map_tools::calcArea(filename, cloud);
+    points_num += cloud.size();
+#pragma omp critical
+    std::cout << "Wrote " << cloud.size() << " points to " << filename << "."
+              << std::endl;
   }
-
-  else if (point_type == "PointXYZRGB") {
-    pcl::PointCloud<pcl::PointXYZRGB> map;
-
-    // Load all PCDs
-    pcl::PointCloud<pcl::PointXYZRGB> tmp;
-    for (int i = 4; i < argc; i++) {
-      if (pcl::io::loadPCDFile<pcl::PointXYZRGB>(argv[i], tmp) == -1) {
-        std::cout << "Failed to load " << argv[i] << "." << std::endl;
-      }
-      map += tmp;
-      std::cout << "Finished to load " << argv[i] << "." << std::endl;
+  map_tools::removeSpillDirectory(spill_dir);
+  std::cout << "Total points num: " << points_num << " points." << std::endl;
+  map_tools::printThroughput("Writing grids", input_num, secondsSince(begin));
+
+  if (options.write_arealist) {
+    // grids which failed to be written have no path
+    areas.erase(std::remove_if(areas.begin(), areas.end(),
+                               [](const map_tools::Area &area) {
+                                 return area.path.empty();
+                               }),
+                areas.end());
+    const std::string arealist = options.output_dir + "arealist.txt";
+    if (!map_tools::writeAreaList(arealist, areas)) {
+      std::cout << "Failed to write " << arealist << "." << std::endl;
+      return 1;
     }
-
-    std::cout << "Finished to load all PCDs: " << map.size() << " points."
+    std::cout << "Wrote " << areas.size() << " areas to " << arealist << "."
               << std::endl;
+  }
+  return 0;
+}
 
-    double min_x = 10000000000.0;
-    double max_x = -10000000000.0;
-    double min_y = 10000000000.0;
-    double max_y = -10000000000.0;
-
-    // Search minimum and maximum points along x and y axis.
-    for (pcl::PointCloud<pcl::PointXYZRGB>::const_iterator p = map.begin();
-         p != map.end(); p++) {
-      if (p->x < min_x) {
-        min_x = p->x;
-      }
-      if (p->x > max_x) {
-        max_x = p->x;
-      }
-      if (p->y < min_y) {
-        min_y = p->y;
-      }
-      if (p->y > max_y) {
-        max_y = p->y;
-      }
-    }
-
-    // Find minimum and maximum boundary
-    int min_x_b = grid_size * static_cast<int>(floor(min_x / grid_size));
-    int max_x_b = grid_size * static_cast<int>(floor(max_x / grid_size) + 1);
-    int min_y_b = grid_size * static_cast<int>(floor(min_y / grid_size));
-    int max_y_b = grid_size * static_cast<int>(floor(max_y / grid_size) + 1);
-
-    // Number of grid along x and y axis
-    int div_x = (max_x_b - min_x_b) / grid_size;
-    int div_y = (max_y_b - min_y_b) / grid_size;
-    int grid_num = div_x * div_y;
-
-    // Define filename, lower/upper bound of every grid
-    std::vector<pcd_xyzrgb_grid> grids(grid_num);
-    for (int y = 0; y < div_y; y++) {
-      for (int x = 0; x < div_x; x++) {
-        int id = div_x * y + x;
-        grids[id].grid_id = id;
-        grids[id].grid_id_x = x;
-        grids[id].grid_id_y = y;
-        grids[id].lower_bound_x = min_x_b + grid_size * x;
-        grids[id].lower_bound_y = min_y_b + grid_size * y;
-        grids[id].upper_bound_x = min_x_b + grid_size * (x + 1);
-        grids[id].upper_bound_y = min_y_b + grid_size * (y + 1);
-        grids[id].filename = output_dir + std::to_string(grid_size) + "_" +
-                             std::to_string(grids[id].lower_bound_x) + "_" +
-                             std::to_string(grids[id].lower_bound_y) + ".pcd";
-      }
-    }
-
-    // Assign all points to appropriate grid according to their x/y value
-    for (pcl::PointCloud<pcl::PointXYZRGB>::const_iterator p = map.begin();
-         p != map.end(); p++) {
-      int idx = static_cast<int>(
-          floor((p->x - static_cast<float>(min_x_b)) / grid_size));
-      int idy = static_cast<int>(
-          floor((p->y - static_cast<float>(min_y_b)) / grid_size));
+int main(int argc, char **argv) {
 
-      int id = idy * div_x + idx;
+  if (argc < 4) {
+    std::cout << "Usage: rosrun map_tools pcd_grid_divider \"point_type "
+                 "[PointXYZ|PointXYZI|PointXYZRGB]\" \"grid_size\" \"output "
+                 "directory\" [options] \"***.pcd\" "
+              << std::endl
+              << "Options:" << std::endl
+              << "  -l leaf_size   downsample every grid by voxel grid filter"
+              << std::endl
+              << "  -a             write arealist.txt to the output directory"
+              << std::endl
+              << "  -m megabytes   memory for buffered points (default 1024)"
+              << std::endl;
+    return 1;
+  }
 
-      const pcl::PointXYZRGB &tmp = *p;
-      grids[id].cloud.points.push_back(tmp);
+  std::string point_type = argv[1];
+  Options options;
+  options.grid_size = std::stoi(argv[2]);
+  options.output_dir = argv[3];
+  for (int i = 4; i < argc; i++) {
+    if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+      options.leaf_size = std::stod(argv[++i]);
+    } else if (strcmp(argv[i], "-a") == 0) {
+      options.write_arealist = true;
+    } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+      options.buffer_bytes = std::stoul(argv[++i]) * 1024 * 1024;
+    } else {
+      options.inputs.push_back(argv[i]);
     }
+  }
 
-    int points_num = 0;
-    for (int i = 0; i < grid_num; i++) {
-      if (grids[i].cloud.points.size() > 0) {
-        pcl::io::savePCDFileBinary(grids[i].filename, grids[i].cloud);
-        std::cout << "Wrote " << grids[i].cloud.points.size() << " points to "
-                  << grids[i].filename << "." << std::endl;
-        points_num += grids[i].cloud.points.size();
-      }
-    }
-    std::cout << "Total points num: " << points_num << " points." << std::endl;
+  if (point_type == "PointXYZ") {
+    return divide<pcl::PointXYZ>(options);
+  } else if (point_type == "PointXYZI") {
+    return divide<pcl::PointXYZI>(options);
+  } else if (point_type == "PointXYZRGB") {
+    return divide<pcl::PointXYZRGB>(options);
   }
 
-  return (0);
+  std::cout << "Unknown point type " << point_type << "." << std::endl;
+  return 1;
 }
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "map_tools/pcd_tiling.h"
+
+namespace map_tools
+{
+bool writeAreaList(const std::string& path, const std::vector<Area>& areas)
+{
+  FILE* fp = fopen(path.c_str(), "w");
+  if (fp == nullptr)
+    return false;
+  for (const Area& area : areas)
+  {
+    fprintf(fp, "%s,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", area.path.c_str(), area.x_min, area.y_min, area.z_min,
+            area.x_max, area.y_max, area.z_max);
+  }
+  fclose(fp);
+  return true;
+}
+
+std::string createSpillDirectory(const std::string& parent, const std::string& name)
+{
+  std::string path = (parent.empty() ? std::string(".") : parent) + "/." + name + "_XXXXXX";
+  std::vector<char> buffer(path.begin(), path.end());
+  buffer.push_back('\0');
+  if (mkdtemp(buffer.data()) == nullptr)
+    return std::string();
+  return std::string(buffer.data());
+}
+
+void removeSpillDirectory(const std::string& path)
+{
+  DIR* dir = opendir(path.c_str());
+  if (dir == nullptr)
+    return;
+  while (struct dirent* entry = readdir(dir))
+  {
+    const std::string file = entry->d_name;
+    if (file != "." && file != "..")
+      unlink((path + "/" + file).c_str());
+  }
+  closedir(dir);
+  rmdir(path.c_str());
+}
+
+void printThroughput(const std::string& stage, size_t num_points, double seconds)
+{
+  std::cout << stage << ": " << num_points << " points in " << seconds << " s ("
+            << (seconds > 0 ? num_points / seconds / 1e6 : 0.0) << " M points/s)" << std::endl;
+}
+}  // namespace map_tools
@@ -25,6 +25,7 @@
 #include <string>
 #include <vector>
 #include <diagnostic_updater/diagnostic_updater.h>
+#include <system_monitor/proc_sampler/proc_sampler.h>
 
 /**
  * @brief CPU temperature information
@@ -126,7 +127,7 @@ protected:
   int num_cores_;                         //!< @brief number of cores
   std::vector<cpu_temp_info> temps_;      //!< @brief CPU list for temperature
   std::vector<cpu_freq_info> freqs_;      //!< @brief CPU list for frequency
-  bool mpstat_exists_;                    //!< @brief flag if mpstat exists
+  ProcSampler sampler_;                   //!< @brief procfs sampler for CPU usage
 
   float temp_warn_;                       //!< @brief CPU temperature(DegC) to generate warning
   float temp_error_;                      //!< @brief CPU temperature(DegC) to generate error
@@ -24,6 +24,7 @@
 #include <map>
 #include <string>
 #include <diagnostic_updater/diagnostic_updater.h>
+#include <system_monitor/proc_sampler/proc_sampler.h>
 
 /**
  * @brief error and warning temperature levels
@@ -85,6 +86,7 @@ protected:
   float usage_error_;                             //!< @brief HDD usage(%) to generate error
   int hdd_reader_port_;                           //!< @brief port number to connect to hdd_reader
   std::map<std::string, TempParam> temp_params_;  //!< @brief list of error and warning levels
+  ProcSampler sampler_;                           //!< @brief procfs sampler for mounted file systems
 
   /**
    * @brief HDD temperature status messages
@@ -24,6 +24,7 @@
 #include <map>
 #include <string>
 #include <diagnostic_updater/diagnostic_updater.h>
+#include <system_monitor/proc_sampler/proc_sampler.h>
 
 class MemMonitor
 {
@@ -51,13 +52,6 @@ protected:
    */
   void checkUsage(diagnostic_updater::DiagnosticStatusWrapper &stat);   // NOLINT(runtime/references)
 
-  /**
-   * @brief get human-readable output for memory size
-   * @param [in] str size with bytes
-   * @return human-readable output
-   */
-  std::string toHumanReadable(const std::string &str);
-
   ros::NodeHandle nh_;                    //!< @brief ros node handle
   ros::NodeHandle pnh_;                   //!< @brief private ros node handle
   diagnostic_updater::Updater updater_;   //!< @brief Updater class which advertises to /diagnostics
@@ -66,6 +60,7 @@ protected:
 
   float usage_warn_;                      //!< @brief Memory usage(%) to generate warning
   float usage_error_;                     //!< @brief Memory usage(%) to generate error
+  ProcSampler sampler_;                   //!< @brief procfs sampler for memory statistics
 
   /**
    * @brief Memory usage status messages
@@ -0,0 +1,247 @@
+#ifndef SYSTEM_MONITOR_PROC_SAMPLER_PROC_SAMPLER_H
+#define SYSTEM_MONITOR_PROC_SAMPLER_PROC_SAMPLER_H
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file proc_sampler.h
+ * @brief Sampler of the procfs statistics used by the monitors
+ */
+
+#include <sys/types.h>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief CPU usage of one sampling interval, same columns as mpstat
+ */
+typedef struct cpu_usage_info
+{
+  std::string name_;    //!< @brief all or cpu index
+  float usr_;           //!< @brief user time excluding guest time(%)
+  float nice_;          //!< @brief niced user time excluding guest time(%)
+  float sys_;           //!< @brief system time(%)
+  float idle_;          //!< @brief idle time(%)
+
+  cpu_usage_info() : name_(), usr_(0), nice_(0), sys_(0), idle_(0) {}
+}
+cpu_usage_info;
+
+/**
+ * @brief memory statistics from /proc/meminfo in bytes
+ */
+typedef struct mem_info
+{
+  uint64_t total_;        //!< @brief MemTotal
+  uint64_t free_;         //!< @brief MemFree
+  uint64_t buffers_;      //!< @brief Buffers
+  uint64_t cached_;       //!< @brief Cached + SReclaimable
+  uint64_t swap_total_;   //!< @brief SwapTotal
+  uint64_t swap_free_;    //!< @brief SwapFree
+
+  mem_info() : total_(0), free_(0), buffers_(0), cached_(0), swap_total_(0), swap_free_(0) {}
+
+  /**
+   * @brief used physical memory, computed as free of procps does
+   */
+  uint64_t used(void) const
+  {
+    const uint64_t unused = free_ + buffers_ + cached_;
+    return (total_ > unused) ? total_ - unused : total_ - std::min(total_, free_);
+  }
+}
+mem_info;
+
+/**
+ * @brief usage of a mounted file system in bytes
+ */
+typedef struct fs_usage_info
+{
+  std::string filesystem_;    //!< @brief mounted device
+  std::string mounted_on_;    //!< @brief mount point
+  uint64_t size_;             //!< @brief size
+  uint64_t used_;             //!< @brief used size
+  uint64_t avail_;            //!< @brief size available to unprivileged users
+
+  fs_usage_info() : filesystem_(), mounted_on_(), size_(0), used_(0), avail_(0) {}
+
+  /**
+   * @brief used ratio rounded up to a percent, as df does
+   */
+  int usePercent(void) const
+  {
+    const uint64_t u = used_ + avail_;
+    return (u == 0) ? 0 : static_cast<int>((used_ * 100 + u - 1) / u);
+  }
+}
+fs_usage_info;
+
+/**
+ * @brief process statistics, same columns as top
+ */
+typedef struct process_info
+{
+  pid_t pid_;             //!< @brief process id
+  std::string user_;      //!< @brief effective user name
+  std::string priority_;  //!< @brief scheduling priority, rt for real time processes
+  int nice_;              //!< @brief nice value
+  uint64_t virt_;         //!< @brief virtual memory size(KiB)
+  uint64_t res_;          //!< @brief resident memory size(KiB)
+  uint64_t shr_;          //!< @brief shared memory size(KiB)
+  char state_;            //!< @brief process state
+  float cpu_usage_;       //!< @brief CPU usage since the previous sample(%)
+  float mem_usage_;       //!< @brief resident size per physical memory(%)
+  uint64_t cpu_ticks_;    //!< @brief user and system time(clock ticks)
+  std::string command_;   //!< @brief command name
+
+  process_info()
+  : pid_(0), user_(), priority_(), nice_(0), virt_(0), res_(0), shr_(0), state_(' '),
+    cpu_usage_(0), mem_usage_(0), cpu_ticks_(0), command_() {}
+}
+process_info;
+
+/**
+ * @brief task counts, same as the summary of top
+ */
+typedef struct tasks_summary
+{
+  int total_;       //!< @brief all processes
+  int running_;     //!< @brief processes in R state
+  int sleeping_;    //!< @brief processes in S, D or I state
+  int stopped_;     //!< @brief processes in T or t state
+  int zombie_;      //!< @brief processes in Z state
+
+  tasks_summary() : total_(0), running_(0), sleeping_(0), stopped_(0), zombie_(0) {}
+}
+tasks_summary;
+
+/**
+ * @brief Reads the statistics directly from procfs instead of running mpstat, free, df or top.
+ * Rates are computed from the difference with the previous sample of the same sampler, so the monitors
+ * do not wait for a sampling interval. The first sample gives the averages since boot or process start.
+ */
+class ProcSampler
+{
+public:
+  /**
+   * @brief constructor
+   * @param [in] root procfs mount point
+   */
+  explicit ProcSampler(const std::string &root = "/proc");
+
+  /**
+   * @brief read CPU usage since the previous call from stat
+   * @param [out] usages usage of all CPUs followed by each CPU
+   * @param [out] error error message on failure
+   * @return true on success
+   */
+  bool sampleCPUUsage(std::vector<cpu_usage_info> *usages, std::string *error);
+
+  /**
+   * @brief read memory statistics from meminfo
+   * @param [out] info memory statistics
+   * @param [out] error error message on failure
+   * @return true on success
+   */
+  bool sampleMemInfo(mem_info *info, std::string *error);
+
+  /**
+   * @brief read usage of the mounted file systems of a type
+   * @param [in] type file system type
+   * @param [out] usages usage of each mounted device, the shortest mount point is kept for a device
+   * @param [out] error error message on failure
+   * @return true on success
+   */
+  bool sampleFileSystems(const std::string &type, std::vector<fs_usage_info> *usages, std::string *error);
+
+  /**
+   * @brief read statistics of all processes, CPU usage is since the previous call
+   * @param [out] summary task counts
+   * @param [out] processes statistics of each process
+   * @param [out] error error message on failure
+   * @return true on success
+   */
+  bool sampleProcesses(tasks_summary *summary, std::vector<process_info> *processes, std::string *error);
+
+  /**
+   * @brief get human-readable output for size, as df -h does
+   * @param [in] size size in bytes
+   * @return human-readable output
+   */
+  static std::string toHumanReadable(uint64_t size);
+
+  /**
+   * @brief get CPU time output, as the TIME+ column of top
+   * @param [in] ticks CPU time in clock ticks
+   * @return CPU time output
+   */
+  static std::string toCPUTime(uint64_t ticks);
+
+protected:
+  /**
+   * @brief CPU times of a line of stat in clock ticks
+   */
+  typedef struct cpu_times
+  {
+    uint64_t user_;
+    uint64_t nice_;
+    uint64_t system_;
+    uint64_t idle_;
+    uint64_t iowait_;
+    uint64_t irq_;
+    uint64_t softirq_;
+    uint64_t steal_;
+    uint64_t guest_;
+    uint64_t guest_nice_;
+
+    cpu_times()
+    : user_(0), nice_(0), system_(0), idle_(0), iowait_(0), irq_(0), softirq_(0), steal_(0), guest_(0),
+      guest_nice_(0) {}
+  }
+  cpu_times;
+
+  /**
+   * @brief read uptime in seconds
+   */
+  bool readUptime(double *uptime, std::string *error);
+
+  /**
+   * @brief read one process
+   * @return false if the process exited while reading it
+   */
+  bool readProcess(pid_t pid, process_info *info, uint64_t *start_time);
+
+  /**
+   * @brief get user name of uid, names are cached
+   */
+  const std::string &getUserName(uid_t uid);
+
+  std::string root_;                                    //!< @brief procfs mount point
+  long ticks_per_second_;                               //!< @brief clock ticks per second
+  long page_kib_;                                       //!< @brief page size(KiB)
+
+  std::map<std::string, cpu_times> prev_cpu_times_;     //!< @brief CPU times of the previous sample
+  std::map<pid_t, std::pair<uint64_t, uint64_t>> prev_process_ticks_;  //!< @brief CPU ticks and start time
+  double prev_uptime_;                                  //!< @brief uptime of the previous process sample
+  std::map<uid_t, std::string> user_names_;             //!< @brief cached user names
+  std::string line_;                                    //!< @brief line buffer reused between samples
+};
+
+#endif  // SYSTEM_MONITOR_PROC_SAMPLER_PROC_SAMPLER_H
@@ -33,7 +33,7 @@ public:
    * @brief constructor
    * @param [in] name diagnostics status name
    */
-  explicit DiagTask(const std::string &name) : DiagnosticTask(name) {}
+  explicit DiagTask(const std::string &name) : DiagnosticTask(name), level_(DiagStatus::OK) {}
 
   /**
    * @brief main loop
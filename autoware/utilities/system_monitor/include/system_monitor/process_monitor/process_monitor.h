@@ -23,11 +23,9 @@
 
 #include <string>
 #include <vector>
-#include <boost/process.hpp>
 #include <diagnostic_updater/diagnostic_updater.h>
 #include <system_monitor/process_monitor/diag_task.h>
-
-namespace bp = boost::process;
+#include <system_monitor/proc_sampler/proc_sampler.h>
 
 class ProcessMonitor
 {
@@ -55,44 +53,25 @@ protected:
    */
   void monitorProcesses(diagnostic_updater::DiagnosticStatusWrapper &stat);   // NOLINT(runtime/references)
 
-  /**
-   * @brief get task summary
-   * @param [out] stat diagnostic message passed directly to diagnostic publish calls
-   * @param [in] output top command output
-   * @note NOLINT syntax is needed since diagnostic_updater asks for a non-const reference
-   * to pass diagnostic message updated in this function to diagnostic publish calls.
-   */
-  void getTasksSummary
-    (diagnostic_updater::DiagnosticStatusWrapper &stat, const std::string &output);   // NOLINT(runtime/references)
-
-  /**
-   * @brief remove header
-   * @param [out] stat diagnostic message passed directly to diagnostic publish calls
-   * @param [in] output top command output
-   * @note NOLINT syntax is needed since diagnostic_updater asks for a non-const reference
-   * to pass diagnostic message updated in this function to diagnostic publish calls.
-   */
-  void removeHeader
-    (diagnostic_updater::DiagnosticStatusWrapper &stat, std::string &output);  // NOLINT(runtime/references)
-
   /**
    * @brief get high load processes
-   * @param [in] output top command output
+   * @param [in] processes processes of the current sample, reordered in place
    */
-  void getHighLoadProcesses(const std::string &output);
+  void getHighLoadProcesses(std::vector<process_info> *processes);
 
   /**
    * @brief get high memory processes
-   * @param [in] output top command output
+   * @param [in] processes processes of the current sample, reordered in place
    */
-  void getHighMemoryProcesses(const std::string &output);
+  void getHighMemoryProcesses(std::vector<process_info> *processes);
 
   /**
    * @brief get top-rated processes
    * @param [in] tasks list of diagnostics tasks for high load procs
-   * @param [in] output top command output
+   * @param [in] processes processes sorted in descending order
    */
-  void getTopratedProcesses(std::vector<std::shared_ptr<DiagTask>> *tasks, bp::pipe *p);
+  void getTopratedProcesses(std::vector<std::shared_ptr<DiagTask>> *tasks,
+                            const std::vector<process_info> &processes);
 
   /**
    * @brief get top-rated processes
@@ -113,6 +92,7 @@ protected:
   int num_of_procs_;                                      //!< @brief number of processes to show
   std::vector<std::shared_ptr<DiagTask>> load_tasks_;     //!< @brief list of diagnostics tasks for high load procs
   std::vector<std::shared_ptr<DiagTask>> memory_tasks_;   //!< @brief list of diagnostics tasks for high memory procs
+  ProcSampler sampler_;                                   //!< @brief procfs sampler for processes
 };
 
 #endif  // SYSTEM_MONITOR_PROCESS_MONITOR_PROCESS_MONITOR_H
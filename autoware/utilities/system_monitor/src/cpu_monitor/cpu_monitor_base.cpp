@@ -21,16 +21,14 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 #include <boost/filesystem.hpp>
-#include <boost/process.hpp>
-#include <boost/property_tree/json_parser.hpp>
-#include <boost/property_tree/ptree.hpp>
+#include <boost/format.hpp>
+#include <boost/range/iterator_range.hpp>
 #include <boost/regex.hpp>
 #include <system_monitor/cpu_monitor/cpu_monitor_base.h>
 
-namespace bp = boost::process;
 namespace fs = boost::filesystem;
-namespace pt = boost::property_tree;
 
 CPUMonitorBase::CPUMonitorBase(const ros::NodeHandle &nh, const ros::NodeHandle &pnh)
   : nh_(nh)
@@ -40,7 +38,7 @@ CPUMonitorBase::CPUMonitorBase(const ros::NodeHandle &nh, const ros::NodeHandle
   , num_cores_(0)
   , temps_()
   , freqs_()
-  , mpstat_exists_(false)
+  , sampler_()
   , temp_warn_(90.0)
   , temp_error_(95.0)
   , usage_warn_(0.90)
@@ -51,10 +49,6 @@ CPUMonitorBase::CPUMonitorBase(const ros::NodeHandle &nh, const ros::NodeHandle
   gethostname(hostname_, sizeof(hostname_));
   num_cores_ = boost::thread::hardware_concurrency();
 
-  // Check if command exists
-  fs::path p = bp::search_path("mpstat");
-  mpstat_exists_ = (p.empty()) ? false : true;
-
   pnh_.param<float>("temp_warn", temp_warn_, 90.0);
   pnh_.param<float>("temp_error", temp_error_, 95.0);
   pnh_.param<float>("usage_warn", usage_warn_, 0.90);
@@ -124,85 +118,35 @@ void CPUMonitorBase::checkTemp(diagnostic_updater::DiagnosticStatusWrapper &stat
 
 void CPUMonitorBase::checkUsage(diagnostic_updater::DiagnosticStatusWrapper &stat)
 {
-  if (!mpstat_exists_)
+  // Get CPU Usage since previous update
+  std::vector<cpu_usage_info> usages;
+  std::string error;
+  if (!sampler_.sampleCPUUsage(&usages, &error))
   {
-    stat.summary(DiagStatus::ERROR, "mpstat error");
-    stat.add("mpstat", "Command 'mpstat' not found, but can be installed with: sudo apt install sysstat");
+    stat.summary(DiagStatus::ERROR, "stat error");
+    stat.add("stat", error);
     return;
   }
 
-  // Get CPU Usage
-  bp::ipstream is_out;
-  bp::ipstream is_err;
-  bp::child c("mpstat -P ALL 1 1 -o JSON", bp::std_out > is_out, bp::std_err > is_err);
-  c.wait();
-
-  if (c.exit_code() != 0)
-  {
-    std::ostringstream os;
-    is_err >> os.rdbuf();
-    stat.summary(DiagStatus::ERROR, "mpstat error");
-    stat.add("mpstat", os.str().c_str());
-    return;
-  }
-
-  std::string cpu_name;
-  float usr;
-  float nice;
-  float sys;
-  float idle;
-  float all_usage;
   float usage;
   int level = DiagStatus::OK;
   int whole_level = DiagStatus::OK;
 
-  pt::ptree pt;
-  try
+  for (const auto &cpu : usages)
   {
-    // Analyze JSON output
-    read_json(is_out, pt);
+    usage = (cpu.usr_ + cpu.nice_) * 1e-2;
 
-    for (const pt::ptree::value_type& child1 : pt.get_child("sysstat.hosts"))
-    {
-      const pt::ptree& hosts = child1.second;
-
-      for (const pt::ptree::value_type& child2 : hosts.get_child("statistics"))
-      {
-        const pt::ptree& statistics = child2.second;
-
-        for (const pt::ptree::value_type& child3 : statistics.get_child("cpu-load"))
-        {
-          const pt::ptree& cpu_load = child3.second;
-
-          if (boost::optional<std::string> v = cpu_load.get_optional<std::string>("cpu")) cpu_name = v.get();
-          if (boost::optional<float> v = cpu_load.get_optional<float>("usr")) usr = v.get();
-          if (boost::optional<float> v = cpu_load.get_optional<float>("nice")) nice = v.get();
-          if (boost::optional<float> v = cpu_load.get_optional<float>("sys")) sys = v.get();
-          if (boost::optional<float> v = cpu_load.get_optional<float>("idle")) idle = v.get();
-
-          usage = (usr+nice)*1e-2;
-          if (cpu_name =="all") all_usage = usage;
-
-          level = DiagStatus::OK;
-          if (usage >= usage_error_) level = DiagStatus::ERROR;
-          else if (usage >= usage_warn_) level = DiagStatus::WARN;
-
-          stat.add((boost::format("CPU %1%: status") % cpu_name).str(), load_dict_.at(level));
-          stat.addf((boost::format("CPU %1%: usr") % cpu_name).str(), "%.2f%%", usr);
-          stat.addf((boost::format("CPU %1%: nice") % cpu_name).str(), "%.2f%%", nice);
-          stat.addf((boost::format("CPU %1%: sys") % cpu_name).str(), "%.2f%%", sys);
-          stat.addf((boost::format("CPU %1%: idle") % cpu_name).str(), "%.2f%%", idle);
-
-          whole_level = std::max(whole_level, level);
-        }
-      }
-    }
-  }
-  catch (const std::exception& e)
-  {
-    stat.summary(DiagStatus::ERROR, "mpstat exception");
-    stat.add("mpstat", e.what());
-    return;
+    level = DiagStatus::OK;
+    if (usage >= usage_error_) level = DiagStatus::ERROR;
+    else if (usage >= usage_warn_) level = DiagStatus::WARN;
+
+    stat.add((boost::format("CPU %1%: status") % cpu.name_).str(), load_dict_.at(level));
+    stat.addf((boost::format("CPU %1%: usr") % cpu.name_).str(), "%.2f%%", cpu.usr_);
+    stat.addf((boost::format("CPU %1%: nice") % cpu.name_).str(), "%.2f%%", cpu.nice_);
+    stat.addf((boost::format("CPU %1%: sys") % cpu.name_).str(), "%.2f%%", cpu.sys_);
+    stat.addf((boost::format("CPU %1%: idle") % cpu.name_).str(), "%.2f%%", cpu.idle_);
+
+    whole_level = std::max(whole_level, level);
   }
 
   stat.summary(whole_level, load_dict_.at(whole_level));
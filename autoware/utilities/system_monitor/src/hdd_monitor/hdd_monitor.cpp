@@ -22,15 +22,14 @@
 #include <algorithm>
 #include <string>
 #include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/format.hpp>
-#include <boost/process.hpp>
 #include <hdd_reader/hdd_reader.h>
 #include <system_monitor/hdd_monitor/hdd_monitor.h>
 
-namespace bp = boost::process;
-
 HDDMonitor::HDDMonitor(const ros::NodeHandle &nh, const ros::NodeHandle &pnh)
   : nh_(nh), pnh_(pnh)
 {
@@ -198,51 +197,37 @@ void HDDMonitor::checkTemp(diagnostic_updater::DiagnosticStatusWrapper &stat)
 void HDDMonitor::checkUsage(diagnostic_updater::DiagnosticStatusWrapper &stat)
 {
   // Get summary of disk space usage of ext4
-  bp::ipstream is_out;
-  bp::ipstream is_err;
-  bp::child c("df -Pht ext4", bp::std_out > is_out, bp::std_err > is_err);
-  c.wait();
-  if (c.exit_code() != 0)
+  std::vector<fs_usage_info> usages;
+  std::string error;
+  if (!sampler_.sampleFileSystems("ext4", &usages, &error))
   {
-    std::ostringstream os;
-    is_err >> os.rdbuf();
-    stat.summary(DiagStatus::ERROR, "df error");
-    stat.add("df", os.str().c_str());
+    stat.summary(DiagStatus::ERROR, "statvfs error");
+    stat.add("statvfs", error);
     return;
   }
 
   int level = DiagStatus::OK;
   int whole_level = DiagStatus::OK;
 
-  std::string line;
   int index = 0;
-  std::vector<std::string> list;
   float usage;
 
-  while (std::getline(is_out, line) && !line.empty())
+  for (const auto &fs : usages)
   {
-    // Skip header
-    if ( index <= 0 )
-    {
-      ++index;
-      continue;
-    }
-
-    boost::split(list, line, boost::is_space(), boost::token_compress_on);
-
-    usage = std::atof(boost::trim_copy_if(list[4], boost::is_any_of("%")).c_str())*1e-2;
+    const int use = fs.usePercent();
+    usage = use * 1e-2;
 
     level = DiagStatus::OK;
     if (usage >= usage_error_) level = DiagStatus::ERROR;
     else if (usage >= usage_warn_) level = DiagStatus::WARN;
 
-    stat.add((boost::format("HDD %1%: status") % (index-1)).str(), usage_dict_.at(level));
-    stat.add((boost::format("HDD %1%: filesystem") % (index-1)).str(), list[0].c_str());
-    stat.add((boost::format("HDD %1%: size") % (index-1)).str(), list[1].c_str());
-    stat.add((boost::format("HDD %1%: used") % (index-1)).str(), list[2].c_str());
-    stat.add((boost::format("HDD %1%: avail") % (index-1)).str(), list[3].c_str());
-    stat.add((boost::format("HDD %1%: use") % (index-1)).str(), list[4].c_str());
-    stat.add((boost::format("HDD %1%: mounted on") % (index-1)).str(), list[5].c_str());
+    stat.add((boost::format("HDD %1%: status") % index).str(), usage_dict_.at(level));
+    stat.add((boost::format("HDD %1%: filesystem") % index).str(), fs.filesystem_);
+    stat.add((boost::format("HDD %1%: size") % index).str(), ProcSampler::toHumanReadable(fs.size_));
+    stat.add((boost::format("HDD %1%: used") % index).str(), ProcSampler::toHumanReadable(fs.used_));
+    stat.add((boost::format("HDD %1%: avail") % index).str(), ProcSampler::toHumanReadable(fs.avail_));
+    stat.add((boost::format("HDD %1%: use") % index).str(), (boost::format("%1%%%") % use).str());
+    stat.add((boost::format("HDD %1%: mounted on") % index).str(), fs.mounted_on_);
 
     whole_level = std::max(whole_level, level);
     ++index;
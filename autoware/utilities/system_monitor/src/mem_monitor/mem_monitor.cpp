@@ -19,14 +19,11 @@
  * @brief Memory monitor class
  */
 
+#include <algorithm>
 #include <string>
-#include <vector>
 #include <boost/format.hpp>
-#include <boost/process.hpp>
 #include <system_monitor/mem_monitor/mem_monitor.h>
 
-namespace bp = boost::process;
-
 MemMonitor::MemMonitor(const ros::NodeHandle &nh, const ros::NodeHandle &pnh)
   : nh_(nh), pnh_(pnh)
 {
@@ -54,69 +51,37 @@ void MemMonitor::run(void)
 void MemMonitor::checkUsage(diagnostic_updater::DiagnosticStatusWrapper &stat)
 {
   // Get total amount of free and used memory
-  bp::ipstream is_out;
-  bp::ipstream is_err;
-  bp::child c("free -tb", bp::std_out > is_out, bp::std_err > is_err);
-  c.wait();
-  if (c.exit_code() != 0)
+  mem_info mem;
+  std::string error;
+  if (!sampler_.sampleMemInfo(&mem, &error))
   {
-    std::ostringstream os;
-    is_err >> os.rdbuf();
-    stat.summary(DiagStatus::ERROR, "free error");
-    stat.add("free", os.str().c_str());
+    stat.summary(DiagStatus::ERROR, "meminfo error");
+    stat.add("meminfo", error);
     return;
   }
 
   int level = DiagStatus::OK;
-  std::string line;
-  int index = 0;
-  std::vector<std::string> list;
-  float usage;
-
-  while (std::getline(is_out, line) && !line.empty())
-  {
-    // Skip header
-    if ( index <= 0 )
-    {
-      ++index;
-      continue;
-    }
 
-    boost::split(list, line, boost::is_space(), boost::token_compress_on);
+  // Physical memory, used divided by total is usage
+  const uint64_t used = mem.used();
+  const float usage = (mem.total_ > 0) ? static_cast<float>(used) / mem.total_ : 0.0;
 
-    // Physical memory
-    if (index == 1)
-    {
-      // used divided by total is usage
-      usage = std::atof(list[2].c_str()) / std::atof(list[1].c_str());
+  if (usage >= usage_error_) level = DiagStatus::ERROR;
+  else if (usage >= usage_warn_) level = DiagStatus::WARN;
 
-      if (usage >= usage_error_) level = DiagStatus::ERROR;
-      else if (usage >= usage_warn_) level = DiagStatus::WARN;
+  stat.addf("Mem: usage", "%.2f%%", usage*1e+2);
+  stat.add("Mem: total", ProcSampler::toHumanReadable(mem.total_));
+  stat.add("Mem: used", ProcSampler::toHumanReadable(used));
+  stat.add("Mem: free", ProcSampler::toHumanReadable(mem.free_));
 
-      stat.addf((boost::format("%1% usage") % list[0]).str(), "%.2f%%", usage*1e+2);
-    }
+  const uint64_t swap_used = mem.swap_total_ - std::min(mem.swap_total_, mem.swap_free_);
+  stat.add("Swap: total", ProcSampler::toHumanReadable(mem.swap_total_));
+  stat.add("Swap: used", ProcSampler::toHumanReadable(swap_used));
+  stat.add("Swap: free", ProcSampler::toHumanReadable(mem.swap_free_));
 
-    stat.add((boost::format("%1% total") % list[0]).str(), toHumanReadable(list[1]));
-    stat.add((boost::format("%1% used") % list[0]).str(), toHumanReadable(list[2]));
-    stat.add((boost::format("%1% free") % list[0]).str(), toHumanReadable(list[3]));
-
-    ++index;
-  }
+  stat.add("Total: total", ProcSampler::toHumanReadable(mem.total_ + mem.swap_total_));
+  stat.add("Total: used", ProcSampler::toHumanReadable(used + swap_used));
+  stat.add("Total: free", ProcSampler::toHumanReadable(mem.free_ + mem.swap_free_));
 
   stat.summary(level, usage_dict_.at(level));
 }
-
-std::string MemMonitor::toHumanReadable(const std::string &str)
-{
-  const char* units[] = {"B", "K", "M", "G", "T"};
-  int count = 0;
-  double size = std::atol(str.c_str());
-
-  while (size > 1024)
-  {
-      size /= 1024;
-      ++count;
-  }
-  const char* format = (size > 0 && size < 10) ? "%.1f%s" : "%.0f%s";
-  return (boost::format(format) % size % units[count]).str();
-}
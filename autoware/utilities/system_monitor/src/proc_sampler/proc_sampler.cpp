@@ -0,0 +1,433 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file proc_sampler.cpp
+ * @brief Sampler of the procfs statistics used by the monitors
+ */
+
+#include <dirent.h>
+#include <pwd.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/format.hpp>
+#include <system_monitor/proc_sampler/proc_sampler.h>
+
+namespace
+{
+/**
+ * @brief read whole file into buffer, procfs files report zero size so they are read by chunk
+ */
+bool readFile(const std::string &path, std::string *buffer)
+{
+  std::ifstream ifs(path, std::ios::in | std::ios::binary);
+  if (!ifs) return false;
+  buffer->clear();
+  char chunk[4096];
+  while (ifs.read(chunk, sizeof(chunk)) || ifs.gcount() > 0) buffer->append(chunk, ifs.gcount());
+  return true;
+}
+
+/**
+ * @brief parse next unsigned integer and advance position
+ */
+uint64_t nextULL(const char **pos)
+{
+  char *end;
+  uint64_t value = std::strtoull(*pos, &end, 10);
+  *pos = end;
+  return value;
+}
+
+/**
+ * @brief parse next signed integer and advance position
+ */
+int64_t nextLL(const char **pos)
+{
+  char *end;
+  int64_t value = std::strtoll(*pos, &end, 10);
+  *pos = end;
+  return value;
+}
+
+/**
+ * @brief decode octal escapes of mounts such as \040 for space
+ */
+std::string unescapeMount(const std::string &str)
+{
+  std::string out;
+  out.reserve(str.size());
+  for (size_t i = 0; i < str.size(); ++i)
+  {
+    if (str[i] == '\\' && i + 3 < str.size() &&
+        str[i + 1] >= '0' && str[i + 1] <= '7' && str[i + 2] >= '0' && str[i + 2] <= '7' &&
+        str[i + 3] >= '0' && str[i + 3] <= '7')
+    {
+      out += static_cast<char>(((str[i + 1] - '0') << 6) | ((str[i + 2] - '0') << 3) | (str[i + 3] - '0'));
+      i += 3;
+    }
+    else
+    {
+      out += str[i];
+    }
+  }
+  return out;
+}
+}  // namespace
+
+ProcSampler::ProcSampler(const std::string &root)
+  : root_(root), ticks_per_second_(sysconf(_SC_CLK_TCK)), page_kib_(sysconf(_SC_PAGESIZE) / 1024),
+    prev_uptime_(0)
+{
+  if (ticks_per_second_ <= 0) ticks_per_second_ = 100;
+  if (page_kib_ <= 0) page_kib_ = 4;
+}
+
+bool ProcSampler::sampleCPUUsage(std::vector<cpu_usage_info> *usages, std::string *error)
+{
+  usages->clear();
+
+  if (!readFile(root_ + "/stat", &line_))
+  {
+    *error = (boost::format("%1%/stat: %2%") % root_ % strerror(errno)).str();
+    return false;
+  }
+
+  const char *pos = line_.c_str();
+  while (std::strncmp(pos, "cpu", 3) == 0)
+  {
+    pos += 3;
+    const char *name = pos;
+    while (*pos && *pos != ' ') ++pos;
+
+    cpu_usage_info usage;
+    usage.name_ = (pos == name) ? "all" : std::string(name, pos - name);
+
+    cpu_times curr;
+    curr.user_ = nextULL(&pos);
+    curr.nice_ = nextULL(&pos);
+    curr.system_ = nextULL(&pos);
+    curr.idle_ = nextULL(&pos);
+    curr.iowait_ = nextULL(&pos);
+    curr.irq_ = nextULL(&pos);
+    curr.softirq_ = nextULL(&pos);
+    curr.steal_ = nextULL(&pos);
+    curr.guest_ = nextULL(&pos);
+    curr.guest_nice_ = nextULL(&pos);
+
+    // Difference with previous sample, or since boot on first sample
+    cpu_times &prev = prev_cpu_times_[usage.name_];
+    auto delta = [](uint64_t c, uint64_t p) { return (c > p) ? static_cast<double>(c - p) : 0.0; };
+    const double user = delta(curr.user_ - std::min(curr.user_, curr.guest_),
+                              prev.user_ - std::min(prev.user_, prev.guest_));
+    const double nice = delta(curr.nice_ - std::min(curr.nice_, curr.guest_nice_),
+                              prev.nice_ - std::min(prev.nice_, prev.guest_nice_));
+    const double system = delta(curr.system_, prev.system_);
+    const double idle = delta(curr.idle_, prev.idle_);
+    const double total = delta(curr.user_, prev.user_) + delta(curr.nice_, prev.nice_) + system + idle +
+                         delta(curr.iowait_, prev.iowait_) + delta(curr.irq_, prev.irq_) +
+                         delta(curr.softirq_, prev.softirq_) + delta(curr.steal_, prev.steal_);
+    prev = curr;
+
+    if (total > 0)
+    {
+      usage.usr_ = user * 1e+2 / total;
+      usage.nice_ = nice * 1e+2 / total;
+      usage.sys_ = system * 1e+2 / total;
+      usage.idle_ = idle * 1e+2 / total;
+    }
+    else
+    {
+      usage.idle_ = 1e+2;
+    }
+    usages->push_back(usage);
+
+    // Next line
+    pos = std::strchr(pos, '\n');
+    if (!pos) break;
+    ++pos;
+  }
+
+  if (usages->empty())
+  {
+    *error = (boost::format("%1%/stat: cpu statistics not found") % root_).str();
+    return false;
+  }
+  return true;
+}
+
+bool ProcSampler::sampleMemInfo(mem_info *info, std::string *error)
+{
+  *info = mem_info();
+
+  if (!readFile(root_ + "/meminfo", &line_))
+  {
+    *error = (boost::format("%1%/meminfo: %2%") % root_ % strerror(errno)).str();
+    return false;
+  }
+
+  int found = 0;
+  const char *pos = line_.c_str();
+  while (*pos)
+  {
+    const char *colon = std::strchr(pos, ':');
+    if (!colon) break;
+    const std::string key(pos, colon - pos);
+    pos = colon + 1;
+    const uint64_t value = nextULL(&pos) * 1024;
+
+    if (key == "MemTotal") { info->total_ = value; ++found; }
+    else if (key == "MemFree") { info->free_ = value; ++found; }
+    else if (key == "Buffers") info->buffers_ = value;
+    else if (key == "Cached" || key == "SReclaimable") info->cached_ += value;
+    else if (key == "SwapTotal") info->swap_total_ = value;
+    else if (key == "SwapFree") info->swap_free_ = value;
+
+    pos = std::strchr(pos, '\n');
+    if (!pos) break;
+    ++pos;
+  }
+
+  if (found < 2)
+  {
+    *error = (boost::format("%1%/meminfo: MemTotal or MemFree not found") % root_).str();
+    return false;
+  }
+  return true;
+}
+
+bool ProcSampler::sampleFileSystems(const std::string &type, std::vector<fs_usage_info> *usages,
+                                    std::string *error)
+{
+  usages->clear();
+
+  if (!readFile(root_ + "/self/mounts", &line_))
+  {
+    *error = (boost::format("%1%/self/mounts: %2%") % root_ % strerror(errno)).str();
+    return false;
+  }
+
+  std::istringstream iss(line_);
+  std::string device, mount_point, fs_type, options;
+  while (iss >> device >> mount_point >> fs_type >> options)
+  {
+    iss.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    if (fs_type != type) continue;
+
+    device = unescapeMount(device);
+    mount_point = unescapeMount(mount_point);
+
+    // Same device mounted more than once is listed once as df does
+    auto itr = std::find_if(usages->begin(), usages->end(),
+                            [&device](const fs_usage_info &u) { return u.filesystem_ == device; });
+    if (itr != usages->end())
+    {
+      if (mount_point.size() < itr->mounted_on_.size()) itr->mounted_on_ = mount_point;
+      continue;
+    }
+    fs_usage_info usage;
+    usage.filesystem_ = device;
+    usage.mounted_on_ = mount_point;
+    usages->push_back(usage);
+  }
+
+  for (auto &usage : *usages)
+  {
+    struct statvfs buf;
+    if (statvfs(usage.mounted_on_.c_str(), &buf) != 0)
+    {
+      *error = (boost::format("%1%: %2%") % usage.mounted_on_ % strerror(errno)).str();
+      return false;
+    }
+    usage.size_ = static_cast<uint64_t>(buf.f_blocks) * buf.f_frsize;
+    usage.used_ = static_cast<uint64_t>(buf.f_blocks - buf.f_bfree) * buf.f_frsize;
+    usage.avail_ = static_cast<uint64_t>(buf.f_bavail) * buf.f_frsize;
+  }
+  return true;
+}
+
+bool ProcSampler::sampleProcesses(tasks_summary *summary, std::vector<process_info> *processes,
+                                  std::string *error)
+{
+  *summary = tasks_summary();
+  processes->clear();
+
+  double uptime;
+  if (!readUptime(&uptime, error)) return false;
+
+  mem_info mem;
+  if (!sampleMemInfo(&mem, error)) return false;
+  const double mem_total_kib = static_cast<double>(mem.total_) / 1024;
+
+  DIR *dir = opendir(root_.c_str());
+  if (!dir)
+  {
+    *error = (boost::format("%1%: %2%") % root_ % strerror(errno)).str();
+    return false;
+  }
+
+  const double elapsed = uptime - prev_uptime_;
+  std::map<pid_t, std::pair<uint64_t, uint64_t>> curr_process_ticks;
+
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != nullptr)
+  {
+    char *end;
+    const long pid = std::strtol(entry->d_name, &end, 10);
+    if (*end != '\0' || pid <= 0) continue;
+
+    process_info info;
+    uint64_t start_time;
+    // Skip processes exited while reading
+    if (!readProcess(static_cast<pid_t>(pid), &info, &start_time)) continue;
+
+    // CPU usage since previous sample, or since process start for new processes
+    auto prev = prev_process_ticks_.find(info.pid_);
+    if (prev != prev_process_ticks_.end() && prev->second.second == start_time && elapsed > 0)
+    {
+      const uint64_t ticks = (info.cpu_ticks_ > prev->second.first) ? info.cpu_ticks_ - prev->second.first : 0;
+      info.cpu_usage_ = ticks * 1e+2 / (elapsed * ticks_per_second_);
+    }
+    else
+    {
+      const double lifetime = uptime - static_cast<double>(start_time) / ticks_per_second_;
+      if (lifetime > 0) info.cpu_usage_ = info.cpu_ticks_ * 1e+2 / (lifetime * ticks_per_second_);
+    }
+    if (mem_total_kib > 0) info.mem_usage_ = info.res_ * 1e+2 / mem_total_kib;
+    curr_process_ticks[info.pid_] = std::make_pair(info.cpu_ticks_, start_time);
+
+    ++summary->total_;
+    switch (info.state_)
+    {
+      case 'R': ++summary->running_; break;
+      case 'S': case 'D': case 'I': ++summary->sleeping_; break;
+      case 'T': case 't': ++summary->stopped_; break;
+      case 'Z': ++summary->zombie_; break;
+      default: break;
+    }
+    processes->push_back(std::move(info));
+  }
+  closedir(dir);
+
+  prev_process_ticks_.swap(curr_process_ticks);
+  prev_uptime_ = uptime;
+  return true;
+}
+
+std::string ProcSampler::toHumanReadable(uint64_t size)
+{
+  const char* units[] = {"B", "K", "M", "G", "T", "P"};
+  int count = 0;
+  double value = static_cast<double>(size);
+
+  while (value > 1024 && count < 5)
+  {
+    value /= 1024;
+    ++count;
+  }
+  const char* format = (value > 0 && value < 10) ? "%.1f%s" : "%.0f%s";
+  return (boost::format(format) % value % units[count]).str();
+}
+
+std::string ProcSampler::toCPUTime(uint64_t ticks)
+{
+  const long ticks_per_second = sysconf(_SC_CLK_TCK);
+  const uint64_t hundredths = ticks * 100 / ((ticks_per_second > 0) ? ticks_per_second : 100);
+  return (boost::format("%1%:%2$02d.%3$02d") % (hundredths / 6000) % (hundredths / 100 % 60) %
+          (hundredths % 100)).str();
+}
+
+bool ProcSampler::readUptime(double *uptime, std::string *error)
+{
+  if (!readFile(root_ + "/uptime", &line_))
+  {
+    *error = (boost::format("%1%/uptime: %2%") % root_ % strerror(errno)).str();
+    return false;
+  }
+  *uptime = std::strtod(line_.c_str(), nullptr);
+  return true;
+}
+
+bool ProcSampler::readProcess(pid_t pid, process_info *info, uint64_t *start_time)
+{
+  const std::string dir = (boost::format("%1%/%2%") % root_ % pid).str();
+
+  struct stat st;
+  if (stat(dir.c_str(), &st) != 0) return false;
+  if (!readFile(dir + "/stat", &line_)) return false;
+
+  // Command name may contain spaces and parentheses, so fields are parsed after the last one
+  const size_t open = line_.find('(');
+  const size_t close = line_.rfind(')');
+  if (open == std::string::npos || close == std::string::npos || close < open) return false;
+
+  info->pid_ = pid;
+  info->command_ = line_.substr(open + 1, close - open - 1);
+  info->user_ = getUserName(st.st_uid);
+
+  const char *pos = line_.c_str() + close + 1;
+  while (*pos == ' ') ++pos;
+  info->state_ = *pos++;
+  // Skip ppid, pgrp, session, tty_nr, tpgid, flags, minflt, cminflt, majflt and cmajflt
+  for (int i = 0; i < 10; ++i) nextLL(&pos);
+  const uint64_t utime = nextULL(&pos);
+  const uint64_t stime = nextULL(&pos);
+  info->cpu_ticks_ = utime + stime;
+  nextLL(&pos);   // cutime
+  nextLL(&pos);   // cstime
+  const int64_t priority = nextLL(&pos);
+  info->priority_ = (priority <= -100) ? "rt" : std::to_string(priority);
+  info->nice_ = static_cast<int>(nextLL(&pos));
+  nextLL(&pos);   // num_threads
+  nextLL(&pos);   // itrealvalue
+  *start_time = nextULL(&pos);
+  info->virt_ = nextULL(&pos) / 1024;
+  info->res_ = nextULL(&pos) * page_kib_;
+
+  // Shared pages are only in statm
+  if (readFile(dir + "/statm", &line_))
+  {
+    pos = line_.c_str();
+    nextULL(&pos);  // size
+    nextULL(&pos);  // resident
+    info->shr_ = nextULL(&pos) * page_kib_;
+  }
+  return true;
+}
+
+const std::string &ProcSampler::getUserName(uid_t uid)
+{
+  auto itr = user_names_.find(uid);
+  if (itr != user_names_.end()) return itr->second;
+
+  struct passwd pwd;
+  struct passwd *result = nullptr;
+  std::vector<char> buf(16384);
+  std::string name;
+  if (getpwuid_r(uid, &pwd, buf.data(), buf.size(), &result) == 0 && result) name = pwd.pw_name;
+  else name = std::to_string(uid);
+  return user_names_.emplace(uid, name).first->second;
+}
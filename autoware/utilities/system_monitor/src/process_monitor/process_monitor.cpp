@@ -19,10 +19,10 @@
  * @brief Process monitor class
  */
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <boost/format.hpp>
-#include <boost/regex.hpp>
 #include <system_monitor/process_monitor/process_monitor.h>
 
 ProcessMonitor::ProcessMonitor(const ros::NodeHandle &nh, const ros::NodeHandle &pnh)
@@ -65,244 +65,86 @@ void ProcessMonitor::run(void)
 
 void ProcessMonitor::monitorProcesses(diagnostic_updater::DiagnosticStatusWrapper &stat)
 {
-  bp::ipstream is_err;
-  bp::ipstream is_out;
-  std::ostringstream os;
-
-  // Get processes
-  bp::child c("top -bn1 -o %CPU -w 128", bp::std_out > is_out, bp::std_err > is_err);
-  c.wait();
-  if (c.exit_code() != 0)
+  // Get processes, one sample serves the summary and both rankings
+  tasks_summary summary;
+  std::vector<process_info> processes;
+  std::string error;
+  if (!sampler_.sampleProcesses(&summary, &processes, &error))
   {
-    is_err >> os.rdbuf();
-    stat.summary(DiagStatus::ERROR, "top error");
-    stat.add("top", os.str().c_str());
-    setErrorContent(&load_tasks_, "top error", "top", os.str().c_str());
-    setErrorContent(&memory_tasks_, "top error", "top", os.str().c_str());
+    stat.summary(DiagStatus::ERROR, "proc error");
+    stat.add("proc", error);
+    setErrorContent(&load_tasks_, "proc error", "proc", error);
+    setErrorContent(&memory_tasks_, "proc error", "proc", error);
     return;
   }
 
-  is_out >> os.rdbuf();
-  std::string str = os.str();
-
   // Get task summary
-  getTasksSummary(stat, str);
-  // Remove header
-  removeHeader(stat, str);
+  stat.add("total", summary.total_);
+  stat.add("running", summary.running_);
+  stat.add("sleeping", summary.sleeping_);
+  stat.add("stopped", summary.stopped_);
+  stat.add("zombie", summary.zombie_);
+  stat.summary(DiagStatus::OK, "OK");
 
   // Get high load processes
-  getHighLoadProcesses(str);
+  getHighLoadProcesses(&processes);
 
   // Get high memory processes
-  getHighMemoryProcesses(str);
+  getHighMemoryProcesses(&processes);
 }
 
-void ProcessMonitor::getTasksSummary(diagnostic_updater::DiagnosticStatusWrapper &stat, const std::string &output)
+void ProcessMonitor::getHighLoadProcesses(std::vector<process_info> *processes)
 {
-  bp::pipe p;
-  std::string line;
-
-  // Echo output for grep
-  {
-    bp::ipstream is_out;
-    bp::ipstream is_err;
-    bp::child c((boost::format("echo %1%") % output).str(), bp::std_out > p, bp::std_err > is_err);
-    c.wait();
-    if (c.exit_code() != 0)
-    {
-      std::ostringstream os;
-      is_err >> os.rdbuf();
-      stat.summary(DiagStatus::ERROR, "echo error");
-      stat.add("echo", os.str().c_str());
-      return;
-    }
-  }
-  // Find matching pattern of summary
-  {
-    bp::ipstream is_out;
-    bp::child c("grep Tasks:", bp::std_out > is_out, bp::std_in < p);
-    c.wait();
-    // no matching line
-    if (c.exit_code() != 0)
+  // Sort by CPU usage, only the top-rated ones are ordered
+  const size_t num = std::min(processes->size(), static_cast<size_t>(num_of_procs_));
+  std::partial_sort(processes->begin(), processes->begin() + num, processes->end(),
+    [](const process_info &a, const process_info &b)
     {
-      stat.summary(DiagStatus::ERROR, "matching pattern not found");
-      stat.add("name", "Tasks:");
-      return;
-    }
-
-    std::getline(is_out, line);
-    boost::smatch match;
-    boost::regex
-      filter("^Tasks: (\\d+) total,\\s+(\\d+) running,\\s+(\\d+) sleeping,\\s+(\\d+) stopped,\\s+(\\d+) zombie");
-
-    if (boost::regex_match(line, match, filter))
-    {
-      stat.add("total", match[1].str());
-      stat.add("running", match[2].str());
-      stat.add("sleeping", match[3].str());
-      stat.add("stopped", match[4].str());
-      stat.add("zombie", match[5].str());
-      stat.summary(DiagStatus::OK, "OK");
-    }
-    else
-    {
-      stat.summary(DiagStatus::ERROR, "invalid format");
-    }
-  }
-}
-
-void ProcessMonitor::removeHeader(diagnostic_updater::DiagnosticStatusWrapper &stat, std::string &output)
-{
-  bp::pipe p1;
-  bp::pipe p2;
-  std::ostringstream os;
-
-  // Echo output for sed
-  {
-    bp::ipstream is_err;
-    bp::child c((boost::format("echo %1%") % output).str(), bp::std_out > p1, bp::std_err > is_err);
-    c.wait();
-    if (c.exit_code() != 0)
-    {
-      is_err >> os.rdbuf();
-      stat.summary(DiagStatus::ERROR, "echo error");
-      stat.add("echo", os.str().c_str());
-      return;
-    }
-  }
-  // Remove %Cpu section
-  {
-    bp::ipstream is_err;
-    bp::child c("sed \"/^%Cpu/d\"", bp::std_out > p2, bp::std_err > is_err, bp::std_in < p1);
-    c.wait();
-    // no matching line
-    if (c.exit_code() != 0)
-    {
-      stat.summary(DiagStatus::ERROR, "sed error");
-      stat.add("sed", "Failed to remove header");
-      return;
-    }
-  }
-  // Remove header
-  {
-    bp::ipstream is_out;
-    bp::ipstream is_err;
-    bp::child c("sed \"1,6d\"", bp::std_out > is_out, bp::std_err > is_err, bp::std_in < p2);
-    c.wait();
-    // no matching line
-    if (c.exit_code() != 0)
-    {
-      stat.summary(DiagStatus::ERROR, "sed error");
-      stat.add("sed", "Failed to remove header");
-      return;
-    }
-    // overwrite
-    is_out >> os.rdbuf();
-    output = os.str();
-  }
-}
-
-void ProcessMonitor::getHighLoadProcesses(const std::string &output)
-{
-  bp::pipe p;
-  std::ostringstream os;
-
-  // Echo output for sed
-  bp::ipstream is_out;
-  bp::ipstream is_err;
-  bp::child c((boost::format("echo %1%") % output).str(), bp::std_out > p, bp::std_err > is_err);
-  c.wait();
-  if (c.exit_code() != 0)
-  {
-    is_err >> os.rdbuf();
-    setErrorContent(&load_tasks_, "echo error", "echo", os.str().c_str());
-    return;
-  }
+      return (a.cpu_usage_ != b.cpu_usage_) ? a.cpu_usage_ > b.cpu_usage_ : a.pid_ < b.pid_;
+    });
 
   // Get top-rated
-  getTopratedProcesses(&load_tasks_, &p);
+  getTopratedProcesses(&load_tasks_, *processes);
 }
 
-void ProcessMonitor::getHighMemoryProcesses(const std::string &output)
+void ProcessMonitor::getHighMemoryProcesses(std::vector<process_info> *processes)
 {
-  bp::pipe p1;
-  bp::pipe p2;
-  std::ostringstream os;
-
-  // Echo output for sed
-  {
-    bp::ipstream is_out;
-    bp::ipstream is_err;
-    bp::child c((boost::format("echo %1%") % output).str(), bp::std_out > p1, bp::std_err > is_err);
-    c.wait();
-    if (c.exit_code() != 0)
+  // Sort by resident size, only the top-rated ones are ordered
+  const size_t num = std::min(processes->size(), static_cast<size_t>(num_of_procs_));
+  std::partial_sort(processes->begin(), processes->begin() + num, processes->end(),
+    [](const process_info &a, const process_info &b)
     {
-      is_err >> os.rdbuf();
-      setErrorContent(&memory_tasks_, "echo error", "echo", os.str().c_str());
-      return;
-    }
-  }
-  // Sort by memory usage
-  {
-    bp::ipstream is_out;
-    bp::ipstream is_err;
-    bp::child c("sort -r -k 10", bp::std_out > p2, bp::std_err > is_err, bp::std_in < p1);
-    c.wait();
-    if (c.exit_code() != 0)
-    {
-      is_err >> os.rdbuf();
-      setErrorContent(&memory_tasks_, "sort error", "sort", os.str().c_str());
-      return;
-    }
-  }
+      return (a.res_ != b.res_) ? a.res_ > b.res_ : a.pid_ < b.pid_;
+    });
 
   // Get top-rated
-  getTopratedProcesses(&memory_tasks_, &p2);
+  getTopratedProcesses(&memory_tasks_, *processes);
 }
 
-void ProcessMonitor::getTopratedProcesses(std::vector<std::shared_ptr<DiagTask>> *tasks, bp::pipe *p)
+void ProcessMonitor::getTopratedProcesses(std::vector<std::shared_ptr<DiagTask>> *tasks,
+                                          const std::vector<process_info> &processes)
 {
-  if (tasks == nullptr || p == nullptr) return;
-
-  bp::ipstream is_out;
-  bp::ipstream is_err;
-  std::ostringstream os;
-
-  bp::child c((boost::format("sed -n \"1,%1% p\"") % num_of_procs_).str(),
-    bp::std_out > is_out, bp::std_err > is_err, bp::std_in < *p);
-
-  c.wait();
-  // Failed to modify line
-  if (c.exit_code() != 0)
-  {
-    is_err >> os.rdbuf();
-    setErrorContent(tasks, "sed error", "sed", os.str().c_str());
-    return;
-  }
+  if (tasks == nullptr) return;
 
-  std::vector<std::string> list;
-  std::string line;
-  int index = 0;
+  const size_t num = std::min(processes.size(), tasks->size());
 
-  while (std::getline(is_out, line) && !line.empty())
+  for (size_t index = 0; index < num; ++index)
   {
-    boost::trim_left(line);
-    boost::split(list, line, boost::is_space(), boost::token_compress_on);
+    const process_info &proc = processes[index];
 
     tasks->at(index)->setDiagnosticsStatus(DiagStatus::OK, "OK");
-    tasks->at(index)->setProcessId(list[0]);
-    tasks->at(index)->setUserName(list[1]);
-    tasks->at(index)->setPriority(list[2]);
-    tasks->at(index)->setNiceValue(list[3]);
-    tasks->at(index)->setVirtualImage(list[4]);
-    tasks->at(index)->setResidentSize(list[5]);
-    tasks->at(index)->setSharedMemSize(list[6]);
-    tasks->at(index)->setProcessStatus(list[7]);
-    tasks->at(index)->setCPUUsage(list[8]);
-    tasks->at(index)->setMemoryUsage(list[9]);
-    tasks->at(index)->setCPUTime(list[10]);
-    tasks->at(index)->setCommandName(list[11]);
-    ++index;
+    tasks->at(index)->setProcessId(std::to_string(proc.pid_));
+    tasks->at(index)->setUserName(proc.user_);
+    tasks->at(index)->setPriority(proc.priority_);
+    tasks->at(index)->setNiceValue(std::to_string(proc.nice_));
+    tasks->at(index)->setVirtualImage(std::to_string(proc.virt_));
+    tasks->at(index)->setResidentSize(std::to_string(proc.res_));
+    tasks->at(index)->setSharedMemSize(std::to_string(proc.shr_));
+    tasks->at(index)->setProcessStatus(std::string(1, proc.state_));
+    tasks->at(index)->setCPUUsage((boost::format("%.1f") % proc.cpu_usage_).str());
+    tasks->at(index)->setMemoryUsage((boost::format("%.1f") % proc.mem_usage_).str());
+    tasks->at(index)->setCPUTime(ProcSampler::toCPUTime(proc.cpu_ticks_));
+    tasks->at(index)->setCommandName(proc.command_);
   }
 }
 
@@ -20,12 +20,12 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
-#include <boost/process.hpp>
 #include <gtest/gtest.h>
 #include <ros/ros.h>
 #include <system_monitor/cpu_monitor/arm_cpu_monitor.h>
 
 static constexpr const char* TEST_FILE = "test";
+static constexpr const char* TEST_PROC_DIR = "test_proc";
 
 namespace fs = boost::filesystem;
 using DiagStatus = diagnostic_msgs::DiagnosticStatus;
@@ -47,7 +47,7 @@ public:
   void addFreqName(int index, const std::string &path) { freqs_.emplace_back(index, path); }
   void clearFreqNames(void) { freqs_.clear(); }
 
-  void setMpstatExists(bool mpstat_exists) { mpstat_exists_ = mpstat_exists; }
+  void setProcRoot(const std::string &root) { sampler_ = ProcSampler(root); }
 
   void changeUsageWarn(float usage_warn) { usage_warn_ = usage_warn; }
   void changeUsageError(float usage_error) { usage_error_ = usage_error; }
@@ -85,8 +85,6 @@ public:
     // Get directory of executable
     const fs::path exe_path(argv_[0]);
     exe_dir_ = exe_path.parent_path().generic_string();
-    // Get dummy executable path
-    mpstat_ = exe_dir_ + "/mpstat";
   }
 
 protected:
@@ -94,7 +92,6 @@ protected:
   std::unique_ptr<TestCPUMonitor> monitor_;
   ros::Subscriber sub_;
   std::string exe_dir_;
-  std::string mpstat_;
 
   void SetUp(void)
   {
@@ -105,16 +102,16 @@ protected:
 
     // Remove test file if exists
     if (fs::exists(TEST_FILE)) fs::remove(TEST_FILE);
-    // Remove dummy executable if exists
-    if (fs::exists(mpstat_)) fs::remove(mpstat_);
+    // Remove test procfs if exists
+    if (fs::exists(TEST_PROC_DIR)) fs::remove_all(TEST_PROC_DIR);
   }
 
   void TearDown(void)
   {
     // Remove test file if exists
     if (fs::exists(TEST_FILE)) fs::remove(TEST_FILE);
-    // Remove dummy executable if exists
-    if (fs::exists(mpstat_)) fs::remove(mpstat_);
+    // Remove test procfs if exists
+    if (fs::exists(TEST_PROC_DIR)) fs::remove_all(TEST_PROC_DIR);
   }
 
   bool findValue(const DiagStatus status, const std::string &key, std::string &value)   // NOLINT
@@ -130,13 +127,12 @@ protected:
     return false;
   }
 
-  void modifyPath(void)
+  void writeProcStat(const std::string &content)
   {
-    // Modify PATH temporarily
-    auto env = boost::this_process::environment();
-    std::string new_path = env["PATH"].to_string();
-    new_path.insert(0, (boost::format("%1%:") % exe_dir_).str());
-    env["PATH"] = new_path;
+    // Write test procfs
+    fs::create_directories(TEST_PROC_DIR);
+    std::ofstream ofs((boost::format("%1%/stat") % TEST_PROC_DIR).str());
+    ofs << content;
   }
 };
 
@@ -409,10 +405,10 @@ TEST_F(CPUMonitorTestSuite, usageErrorTest)
   }
 }
 
-TEST_F(CPUMonitorTestSuite, usageMpstatNotFoundTest)
+TEST_F(CPUMonitorTestSuite, usageStatNotFoundTest)
 {
-  // Set flag false
-  monitor_->setMpstatExists(false);
+  // Set procfs not to exist
+  monitor_->setProcRoot(TEST_PROC_DIR);
 
   // Publish topic
   monitor_->update();
@@ -426,9 +422,8 @@ TEST_F(CPUMonitorTestSuite, usageMpstatNotFoundTest)
   std::string value;
   ASSERT_TRUE(monitor_->findDiagStatus("CPU Usage", status));
   ASSERT_EQ(status.level, DiagStatus::ERROR);
-  ASSERT_STREQ(status.message.c_str(), "mpstat error");
-  ASSERT_TRUE(findValue(status, "mpstat", value));
-  ASSERT_STREQ(value.c_str(), "Command 'mpstat' not found, but can be installed with: sudo apt install sysstat");
+  ASSERT_STREQ(status.message.c_str(), "stat error");
+  ASSERT_TRUE(findValue(status, "stat", value));
 }
 
 TEST_F(CPUMonitorTestSuite, load1WarnTest)
@@ -591,13 +586,11 @@ TEST_F(CPUMonitorTestSuite, freqFrequencyFilesNotFoundTest)
   ASSERT_STREQ(status.message.c_str(), "frequency files not found");
 }
 
-TEST_F(CPUMonitorTestSuite, usageMpstatErrorTest)
+TEST_F(CPUMonitorTestSuite, usageStatInvalidFormatTest)
 {
-  // Symlink mpstat1 to mpstat
-  fs::create_symlink(exe_dir_ + "/mpstat1", mpstat_);
-
-  // Modify PATH temporarily
-  modifyPath();
+  // Write stat without cpu statistics
+  writeProcStat("intr 0\n");
+  monitor_->setProcRoot(TEST_PROC_DIR);
 
   // Publish topic
   monitor_->update();
@@ -612,17 +605,36 @@ TEST_F(CPUMonitorTestSuite, usageMpstatErrorTest)
 
   ASSERT_TRUE(monitor_->findDiagStatus("CPU Usage", status));
   ASSERT_EQ(status.level, DiagStatus::ERROR);
-  ASSERT_STREQ(status.message.c_str(), "mpstat error");
-  ASSERT_TRUE(findValue(status, "mpstat", value));
+  ASSERT_STREQ(status.message.c_str(), "stat error");
+  ASSERT_TRUE(findValue(status, "stat", value));
 }
 
-TEST_F(CPUMonitorTestSuite, usageMpstatExceptionTest)
+TEST_F(CPUMonitorTestSuite, usageStatDifferenceTest)
 {
-  // Symlink mpstat2 to mpstat
-  fs::create_symlink(exe_dir_ + "/mpstat2", mpstat_);
+  // Write first sample
+  writeProcStat("cpu  10 0 0 90 0 0 0 0 0 0\ncpu0 10 0 0 90 0 0 0 0 0 0\n");
+  monitor_->setProcRoot(TEST_PROC_DIR);
+
+  // Publish topic
+  monitor_->update();
+
+  // Give time to publish
+  ros::WallDuration(0.5).sleep();
+  ros::spinOnce();
 
-  // Modify PATH temporarily
-  modifyPath();
+  // Verify usage since boot
+  {
+    DiagStatus status;
+    std::string value;
+
+    ASSERT_TRUE(monitor_->findDiagStatus("CPU Usage", status));
+    ASSERT_EQ(status.level, DiagStatus::OK);
+    ASSERT_TRUE(findValue(status, "CPU all: usr", value));
+    ASSERT_STREQ(value.c_str(), "10.00%");
+  }
+
+  // Write second sample
+  writeProcStat("cpu  100 0 0 100 0 0 0 0 0 0\ncpu0 100 0 0 100 0 0 0 0 0 0\n");
 
   // Publish topic
   monitor_->update();
@@ -631,13 +643,18 @@ TEST_F(CPUMonitorTestSuite, usageMpstatExceptionTest)
   ros::WallDuration(0.5).sleep();
   ros::spinOnce();
 
-  // Verify
-  DiagStatus status;
-  std::string value;
+  // Verify usage since previous sample
+  {
+    DiagStatus status;
+    std::string value;
 
-  ASSERT_TRUE(monitor_->findDiagStatus("CPU Usage", status));
-  ASSERT_EQ(status.level, DiagStatus::ERROR);
-  ASSERT_STREQ(status.message.c_str(), "mpstat exception");
+    ASSERT_TRUE(monitor_->findDiagStatus("CPU Usage", status));
+    ASSERT_EQ(status.level, DiagStatus::WARN);
+    ASSERT_TRUE(findValue(status, "CPU 0: usr", value));
+    ASSERT_STREQ(value.c_str(), "90.00%");
+    ASSERT_TRUE(findValue(status, "CPU 0: idle", value));
+    ASSERT_STREQ(value.c_str(), "10.00%");
+  }
 }
 
 // for coverage
@@ -14,12 +14,12 @@
  * limitations under the License.
  */
 
+#include <fstream>
 #include <string>
 #include <boost/algorithm/string.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
-#include <boost/process.hpp>
 #include <gtest/gtest.h>
 #include <ros/ros.h>
 #include <hdd_reader/hdd_reader.h>
@@ -28,6 +28,8 @@
 namespace fs = boost::filesystem;
 using DiagStatus = diagnostic_msgs::DiagnosticStatus;
 
+static constexpr const char* TEST_PROC_DIR = "test_proc";
+
 char** argv_;
 
 class TestHDDMonitor : public HDDMonitor
@@ -58,6 +60,7 @@ public:
 
   void changeUsageWarn(float usage_warn) { usage_warn_ = usage_warn; }
   void changeUsageError(float usage_error) { usage_error_ = usage_error; }
+  void setProcRoot(const std::string &root) { sampler_ = ProcSampler(root); }
 
   void update(void) { updater_.force_update(); }
 
@@ -89,8 +92,6 @@ public:
     // Get directory of executable
     const fs::path exe_path(argv_[0]);
     exe_dir_ = exe_path.parent_path().generic_string();
-    // Get dummy executable path
-    df_ = exe_dir_ + "/df";
   }
 
 protected:
@@ -98,21 +99,20 @@ protected:
   std::unique_ptr<TestHDDMonitor> monitor_;
   ros::Subscriber sub_;
   std::string exe_dir_;
-  std::string df_;
 
   void SetUp(void)
   {
     monitor_ = std::make_unique<TestHDDMonitor>(nh_, pnh_);
     sub_ = nh_.subscribe("/diagnostics", 1000, &TestHDDMonitor::diagCallback, monitor_.get());
 
-    // Remove dummy executable if exists
-    if (fs::exists(df_)) fs::remove(df_);
+    // Remove test procfs if exists
+    if (fs::exists(TEST_PROC_DIR)) fs::remove_all(TEST_PROC_DIR);
   }
 
   void TearDown(void)
   {
-    // Remove dummy executable if exists
-    if (fs::exists(df_)) fs::remove(df_);
+    // Remove test procfs if exists
+    if (fs::exists(TEST_PROC_DIR)) fs::remove_all(TEST_PROC_DIR);
   }
 
   bool findValue(const DiagStatus status, const std::string &key, std::string &value)   // NOLINT
@@ -128,13 +128,12 @@ protected:
     return false;
   }
 
-  void modifyPath(void)
+  void writeProcMounts(const std::string &content)
   {
-    // Modify PATH temporarily
-    auto env = boost::this_process::environment();
-    std::string new_path = env["PATH"].to_string();
-    new_path.insert(0, (boost::format("%1%:") % exe_dir_).str());
-    env["PATH"] = new_path;
+    // Write test procfs
+    fs::create_directories((boost::format("%1%/self") % TEST_PROC_DIR).str());
+    std::ofstream ofs((boost::format("%1%/self/mounts") % TEST_PROC_DIR).str());
+    ofs << content;
   }
 };
 
@@ -619,13 +618,33 @@ TEST_F(HDDMonitorTestSuite, usageErrorTest)
   }
 }
 
-TEST_F(HDDMonitorTestSuite, usageDfErrorTest)
+TEST_F(HDDMonitorTestSuite, usageMountsErrorTest)
 {
-  // Symlink df1 to df
-  fs::create_symlink(exe_dir_ + "/df1", df_);
+  // Set procfs not to exist
+  monitor_->setProcRoot(TEST_PROC_DIR);
 
-  // Modify PATH temporarily
-  modifyPath();
+  // Publish topic
+  monitor_->update();
+
+  // Give time to publish
+  ros::WallDuration(0.5).sleep();
+  ros::spinOnce();
+
+  // Verify
+  DiagStatus status;
+  std::string value;
+
+  ASSERT_TRUE(monitor_->findDiagStatus("HDD Usage", status));
+  ASSERT_EQ(status.level, DiagStatus::ERROR);
+  ASSERT_STREQ(status.message.c_str(), "statvfs error");
+  ASSERT_TRUE(findValue(status, "statvfs", value));
+}
+
+TEST_F(HDDMonitorTestSuite, usageStatvfsErrorTest)
+{
+  // Write mounts with mount point not to exist
+  writeProcMounts("/dev/sdz1 /no\\040such\\040dir ext4 rw,relatime 0 0\n");
+  monitor_->setProcRoot(TEST_PROC_DIR);
 
   // Publish topic
   monitor_->update();
@@ -640,8 +659,9 @@ TEST_F(HDDMonitorTestSuite, usageDfErrorTest)
 
   ASSERT_TRUE(monitor_->findDiagStatus("HDD Usage", status));
   ASSERT_EQ(status.level, DiagStatus::ERROR);
-  ASSERT_STREQ(status.message.c_str(), "df error");
-  ASSERT_TRUE(findValue(status, "df", value));
+  ASSERT_STREQ(status.message.c_str(), "statvfs error");
+  ASSERT_TRUE(findValue(status, "statvfs", value));
+  ASSERT_TRUE(value.find("/no such dir") != std::string::npos);
 }
 
 int main(int argc, char **argv)
@@ -14,11 +14,11 @@
  * limitations under the License.
  */
 
+#include <fstream>
 #include <string>
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
-#include <boost/process.hpp>
 #include <gtest/gtest.h>
 #include <ros/ros.h>
 #include <system_monitor/mem_monitor/mem_monitor.h>
@@ -26,6 +26,8 @@
 namespace fs = boost::filesystem;
 using DiagStatus = diagnostic_msgs::DiagnosticStatus;
 
+static constexpr const char* TEST_PROC_DIR = "test_proc";
+
 char** argv_;
 
 class TestMemMonitor : public MemMonitor
@@ -39,6 +41,7 @@ public:
 
   void changeUsageWarn(float usage_warn) { usage_warn_ = usage_warn; }
   void changeUsageError(float usage_error) { usage_error_ = usage_error; }
+  void setProcRoot(const std::string &root) { sampler_ = ProcSampler(root); }
 
   void update(void) { updater_.force_update(); }
 
@@ -70,8 +73,6 @@ public:
     // Get directory of executable
     const fs::path exe_path(argv_[0]);
     exe_dir_ = exe_path.parent_path().generic_string();
-    // Get dummy executable path
-    free_ = exe_dir_ + "/free";
   }
 
 protected:
@@ -79,21 +80,20 @@ protected:
   std::unique_ptr<TestMemMonitor> monitor_;
   ros::Subscriber sub_;
   std::string exe_dir_;
-  std::string free_;
 
   void SetUp(void)
   {
     monitor_ = std::make_unique<TestMemMonitor>(nh_, pnh_);
     sub_ = nh_.subscribe("/diagnostics", 1000, &TestMemMonitor::diagCallback, monitor_.get());
 
-    // Remove dummy executable if exists
-    if (fs::exists(free_)) fs::remove(free_);
+    // Remove test procfs if exists
+    if (fs::exists(TEST_PROC_DIR)) fs::remove_all(TEST_PROC_DIR);
   }
 
   void TearDown(void)
   {
-    // Remove dummy executable if exists
-    if (fs::exists(free_)) fs::remove(free_);
+    // Remove test procfs if exists
+    if (fs::exists(TEST_PROC_DIR)) fs::remove_all(TEST_PROC_DIR);
   }
 
   bool findValue(const DiagStatus status, const std::string &key, std::string &value)   // NOLINT
@@ -109,13 +109,12 @@ protected:
     return false;
   }
 
-  void modifyPath(void)
+  void writeProcMeminfo(const std::string &content)
   {
-    // Modify PATH temporarily
-    auto env = boost::this_process::environment();
-    std::string new_path = env["PATH"].to_string();
-    new_path.insert(0, (boost::format("%1%:") % exe_dir_).str());
-    env["PATH"] = new_path;
+    // Write test procfs
+    fs::create_directories(TEST_PROC_DIR);
+    std::ofstream ofs((boost::format("%1%/meminfo") % TEST_PROC_DIR).str());
+    ofs << content;
   }
 };
 
@@ -229,13 +228,10 @@ TEST_F(MemMonitorTestSuite, usageErrorTest)
   }
 }
 
-TEST_F(MemMonitorTestSuite, usageFreeErrorTest)
+TEST_F(MemMonitorTestSuite, usageMeminfoErrorTest)
 {
-  // Symlink free1 to free
-  fs::create_symlink(exe_dir_ + "/free1", free_);
-
-  // Modify PATH temporarily
-  modifyPath();
+  // Set procfs not to exist
+  monitor_->setProcRoot(TEST_PROC_DIR);
 
   // Publish topic
   monitor_->update();
@@ -250,8 +246,45 @@ TEST_F(MemMonitorTestSuite, usageFreeErrorTest)
 
   ASSERT_TRUE(monitor_->findDiagStatus("Memory Usage", status));
   ASSERT_EQ(status.level, DiagStatus::ERROR);
-  ASSERT_STREQ(status.message.c_str(), "free error");
-  ASSERT_TRUE(findValue(status, "free", value));
+  ASSERT_STREQ(status.message.c_str(), "meminfo error");
+  ASSERT_TRUE(findValue(status, "meminfo", value));
+}
+
+TEST_F(MemMonitorTestSuite, usageMeminfoTest)
+{
+  // Write meminfo, used is total minus free, buffers and cache
+  writeProcMeminfo(
+    "MemTotal:        1048576 kB\n"
+    "MemFree:          262144 kB\n"
+    "Buffers:          131072 kB\n"
+    "Cached:            65536 kB\n"
+    "SwapCached:            0 kB\n"
+    "SReclaimable:      65536 kB\n"
+    "SwapTotal:       2097152 kB\n"
+    "SwapFree:        2097152 kB\n");
+  monitor_->setProcRoot(TEST_PROC_DIR);
+
+  // Publish topic
+  monitor_->update();
+
+  // Give time to publish
+  ros::WallDuration(0.5).sleep();
+  ros::spinOnce();
+
+  // Verify
+  DiagStatus status;
+  std::string value;
+
+  ASSERT_TRUE(monitor_->findDiagStatus("Memory Usage", status));
+  ASSERT_EQ(status.level, DiagStatus::OK);
+  ASSERT_TRUE(findValue(status, "Mem: usage", value));
+  ASSERT_STREQ(value.c_str(), "50.00%");
+  ASSERT_TRUE(findValue(status, "Mem: used", value));
+  ASSERT_STREQ(value.c_str(), "512M");
+  ASSERT_TRUE(findValue(status, "Swap: used", value));
+  ASSERT_STREQ(value.c_str(), "0B");
+  ASSERT_TRUE(findValue(status, "Total: total", value));
+  ASSERT_STREQ(value.c_str(), "3.0G");
 }
 
 int main(int argc, char **argv)
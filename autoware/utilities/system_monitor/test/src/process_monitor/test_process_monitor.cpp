@@ -14,19 +14,20 @@
  * limitations under the License.
  */
 
+#include <fstream>
 #include <string>
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
-#include <boost/process.hpp>
 #include <gtest/gtest.h>
 #include <ros/ros.h>
 #include <system_monitor/process_monitor/process_monitor.h>
 
-namespace bp = boost::process;
 namespace fs = boost::filesystem;
 using DiagStatus = diagnostic_msgs::DiagnosticStatus;
 
+static constexpr const char* TEST_PROC_DIR = "test_proc";
+
 char** argv_;
 
 class TestProcessMonitor : public ProcessMonitor
@@ -40,6 +41,8 @@ public:
 
   int getNumOfProcs(void) const { return num_of_procs_; }
 
+  void setProcRoot(const std::string &root) { sampler_ = ProcSampler(root); }
+
   void update(void) { updater_.force_update(); }
 
   const std::string removePrefix(const std::string &name) { return boost::algorithm::erase_all_copy(name, prefix_); }
@@ -70,11 +73,6 @@ public:
     // Get directory of executable
     const fs::path exe_path(argv_[0]);
     exe_dir_ = exe_path.parent_path().generic_string();
-    // Get dummy executable path
-    top_ = exe_dir_ + "/top";
-    echo_ = exe_dir_ + "/echo";
-    sed_ = exe_dir_ + "/sed";
-    sort_ = exe_dir_ + "/sort";
   }
 
 protected:
@@ -82,30 +80,20 @@ protected:
   std::unique_ptr<TestProcessMonitor> monitor_;
   ros::Subscriber sub_;
   std::string exe_dir_;
-  std::string top_;
-  std::string echo_;
-  std::string sed_;
-  std::string sort_;
 
   void SetUp(void)
   {
     monitor_ = std::make_unique<TestProcessMonitor>(nh_, pnh_);
     sub_ = nh_.subscribe("/diagnostics", 1000, &TestProcessMonitor::diagCallback, monitor_.get());
 
-    // Remove dummy executable if exists
-    if (fs::exists(top_)) fs::remove(top_);
-    if (fs::exists(echo_)) fs::remove(echo_);
-    if (fs::exists(sed_)) fs::remove(sed_);
-    if (fs::exists(sort_)) fs::remove(sort_);
+    // Remove test procfs if exists
+    if (fs::exists(TEST_PROC_DIR)) fs::remove_all(TEST_PROC_DIR);
   }
 
   void TearDown(void)
   {
-    // Remove dummy executable if exists
-    if (fs::exists(top_)) fs::remove(top_);
-    if (fs::exists(echo_)) fs::remove(echo_);
-    if (fs::exists(sed_)) fs::remove(sed_);
-    if (fs::exists(sort_)) fs::remove(sort_);
+    // Remove test procfs if exists
+    if (fs::exists(TEST_PROC_DIR)) fs::remove_all(TEST_PROC_DIR);
   }
 
   bool findValue(const DiagStatus status, const std::string &key, std::string &value)   // NOLINT
@@ -121,13 +109,13 @@ protected:
     return false;
   }
 
-  void modifyPath(void)
+  void writeProcFile(const std::string &name, const std::string &content)
   {
-    // Modify PATH temporarily
-    auto env = boost::this_process::environment();
-    std::string new_path = env["PATH"].to_string();
-    new_path.insert(0, (boost::format("%1%:") % exe_dir_).str());
-    env["PATH"] = new_path;
+    // Write test procfs
+    const fs::path path = fs::path(TEST_PROC_DIR) / name;
+    fs::create_directories(path.parent_path());
+    std::ofstream ofs(path.generic_string());
+    ofs << content;
   }
 };
 
@@ -186,13 +174,10 @@ TEST_F(ProcessMonitorTestSuite, highMemProcTest)
   }
 }
 
-TEST_F(ProcessMonitorTestSuite, topErrorTest)
+TEST_F(ProcessMonitorTestSuite, procErrorTest)
 {
-  // Symlink top1 to top
-  fs::create_symlink(exe_dir_ + "/top1", top_);
-
-  // Modify PATH temporarily
-  modifyPath();
+  // Set procfs not to exist
+  monitor_->setProcRoot(TEST_PROC_DIR);
 
   // Publish topic
   monitor_->update();
@@ -207,53 +192,33 @@ TEST_F(ProcessMonitorTestSuite, topErrorTest)
 
   ASSERT_TRUE(monitor_->findDiagStatus("Tasks Summary", status));
   ASSERT_EQ(status.level, DiagStatus::ERROR);
-  ASSERT_STREQ(status.message.c_str(), "top error");
-  ASSERT_TRUE(findValue(status, "top", value));
-  ASSERT_STREQ(value.c_str(), "");
+  ASSERT_STREQ(status.message.c_str(), "proc error");
+  ASSERT_TRUE(findValue(status, "proc", value));
 
   for (int i = 0; i < monitor_->getNumOfProcs(); ++i)
   {
     ASSERT_TRUE(monitor_->findDiagStatus((boost::format("High-load Proc[%1%]") % i).str(), status));
     ASSERT_EQ(status.level, DiagStatus::ERROR);
-    ASSERT_STREQ(status.message.c_str(), "top error");
+    ASSERT_STREQ(status.message.c_str(), "proc error");
 
     ASSERT_TRUE(monitor_->findDiagStatus((boost::format("High-mem Proc[%1%]") % i).str(), status));
     ASSERT_EQ(status.level, DiagStatus::ERROR);
-    ASSERT_STREQ(status.message.c_str(), "top error");
+    ASSERT_STREQ(status.message.c_str(), "proc error");
   }
 }
 
-TEST_F(ProcessMonitorTestSuite, matchingPatternNotFoundTest)
-{
-  // Symlink top2 to top
-  fs::create_symlink(exe_dir_ + "/top2", top_);
-
-  // Modify PATH temporarily
-  modifyPath();
-
-  // Publish topic
-  monitor_->update();
-
-  // Give time to publish
-  ros::WallDuration(0.5).sleep();
-  ros::spinOnce();
-
-  // Verify
-  DiagStatus status;
-  std::string value;
-
-  ASSERT_TRUE(monitor_->findDiagStatus("Tasks Summary", status));
-  ASSERT_EQ(status.level, DiagStatus::ERROR);
-  ASSERT_STREQ(status.message.c_str(), "matching pattern not found");
-}
-
-TEST_F(ProcessMonitorTestSuite, invalidFormatTest)
+TEST_F(ProcessMonitorTestSuite, procRankingTest)
 {
-  // Symlink top3 to top
-  fs::create_symlink(exe_dir_ + "/top3", top_);
-
-  // Modify PATH temporarily
-  modifyPath();
+  // Write procfs with a busy process and a large process
+  writeProcFile("uptime", "100.00 50.00\n");
+  writeProcFile("meminfo", "MemTotal:        1048576 kB\nMemFree:          524288 kB\n");
+  writeProcFile("100/stat",
+    "100 (busy (proc)) R 1 100 100 0 -1 4194304 0 0 0 0 500 100 0 0 20 0 1 0 1000 104857600 2560\n");
+  writeProcFile("100/statm", "25600 2560 256 0 0 0 0\n");
+  writeProcFile("200/stat",
+    "200 (large) S 1 200 200 0 -1 4194304 0 0 0 0 5 5 0 0 30 10 1 0 2000 1073741824 65536\n");
+  writeProcFile("200/statm", "262144 65536 1024 0 0 0 0\n");
+  monitor_->setProcRoot(TEST_PROC_DIR);
 
   // Publish topic
   monitor_->update();
@@ -267,83 +232,31 @@ TEST_F(ProcessMonitorTestSuite, invalidFormatTest)
   std::string value;
 
   ASSERT_TRUE(monitor_->findDiagStatus("Tasks Summary", status));
-  ASSERT_EQ(status.level, DiagStatus::ERROR);
-  ASSERT_STREQ(status.message.c_str(), "invalid format");
-}
-
-TEST_F(ProcessMonitorTestSuite, echoErrorTest)
-{
-  // Symlink sed1 to sed
-  fs::create_symlink(exe_dir_ + "/echo1", echo_);
-
-  // Modify PATH temporarily
-  modifyPath();
-
-  // Publish topic
-  monitor_->update();
-
-  // Give time to publish
-  ros::WallDuration(0.5).sleep();
-  ros::spinOnce();
-
-  // Verify
-  DiagStatus status;
-  std::string value;
-
-  ASSERT_TRUE(monitor_->findDiagStatus("Tasks Summary", status));
-  ASSERT_EQ(status.level, DiagStatus::ERROR);
-  ASSERT_STREQ(status.message.c_str(), "echo error");
-}
-
-TEST_F(ProcessMonitorTestSuite, sedErrorTest)
-{
-  // Symlink sed1 to sed
-  fs::create_symlink(exe_dir_ + "/sed1", sed_);
-
-  // Modify PATH temporarily
-  modifyPath();
-
-  // Publish topic
-  monitor_->update();
-
-  // Give time to publish
-  ros::WallDuration(0.5).sleep();
-  ros::spinOnce();
-
-  // Verify
-  DiagStatus status;
-  std::string value;
-
-  ASSERT_TRUE(monitor_->findDiagStatus("Tasks Summary", status));
-  ASSERT_EQ(status.level, DiagStatus::ERROR);
-  ASSERT_STREQ(status.message.c_str(), "sed error");
-}
-
-TEST_F(ProcessMonitorTestSuite, sortErrorTest)
-{
-  // Symlink sort1 to sort
-  fs::create_symlink(exe_dir_ + "/sort1", sort_);
-
-  // Modify PATH temporarily
-  modifyPath();
-
-  // Publish topic
-  monitor_->update();
-
-  // Give time to publish
-  ros::WallDuration(0.5).sleep();
-  ros::spinOnce();
-
-  // Verify
-  DiagStatus status;
-  std::string value;
-
-  for (int i = 0; i < monitor_->getNumOfProcs(); ++i)
-  {
-    ASSERT_TRUE(monitor_->findDiagStatus((boost::format("High-mem Proc[%1%]") % i).str(), status));
-    ASSERT_EQ(status.level, DiagStatus::ERROR);
-    ASSERT_STREQ(status.message.c_str(), "sort error");
-  }
+  ASSERT_EQ(status.level, DiagStatus::OK);
+  ASSERT_TRUE(findValue(status, "total", value));
+  ASSERT_STREQ(value.c_str(), "2");
+  ASSERT_TRUE(findValue(status, "running", value));
+  ASSERT_STREQ(value.c_str(), "1");
+  ASSERT_TRUE(findValue(status, "sleeping", value));
+  ASSERT_STREQ(value.c_str(), "1");
+
+  ASSERT_TRUE(monitor_->findDiagStatus("High-load Proc[0]", status));
+  ASSERT_EQ(status.level, DiagStatus::OK);
+  ASSERT_TRUE(findValue(status, "PID", value));
+  ASSERT_STREQ(value.c_str(), "100");
+  ASSERT_TRUE(findValue(status, "COMMAND", value));
+  ASSERT_STREQ(value.c_str(), "busy (proc)");
+  ASSERT_TRUE(findValue(status, "S", value));
+  ASSERT_STREQ(value.c_str(), "R");
+
+  ASSERT_TRUE(monitor_->findDiagStatus("High-mem Proc[0]", status));
+  ASSERT_EQ(status.level, DiagStatus::OK);
+  ASSERT_TRUE(findValue(status, "PID", value));
+  ASSERT_STREQ(value.c_str(), "200");
+  ASSERT_TRUE(findValue(status, "NI", value));
+  ASSERT_STREQ(value.c_str(), "10");
+  ASSERT_TRUE(findValue(status, "VIRT", value));
+  ASSERT_STREQ(value.c_str(), "1048576");
 }
 
 int main(int argc, char **argv)
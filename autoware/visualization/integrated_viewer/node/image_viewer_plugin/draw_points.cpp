@@ -44,31 +44,75 @@ namespace integrated_viewer
           continue;
         }
 
-        // Specify which color will be use for this point
-        int color_id = distance_range ? ((distance - min_distance) * 255 / distance_range) : 128;
-
-        // Divide color into each element
-        cv::Vec3b color = color_map_.at<cv::Vec3b>(color_id);
-        int red   = color[0];
-        int green = color[1];
-        int blue  = color[2];
-
-        // Draw a point
-        int minus_offset = 0;
-        int plus_offset = static_cast<int>(drawn_size/2);
-        if (drawn_size % 2 == 0) {
-          minus_offset = static_cast<int>(drawn_size/2) - 1;
-        } else {
-          minus_offset = static_cast<int>(drawn_size/2);
-        }
-        cv::rectangle(image,
-                      cv::Point(x - minus_offset, y - minus_offset),
-                      cv::Point(x + plus_offset, y + plus_offset),
-                      CV_RGB(red, green, blue),
-                      CV_FILLED);
+        DrawPoint(image, x, y, distance, min_distance, distance_range, drawn_size);
       }
     }
 
   } // DrawPoints::Draw()
 
+
+  void DrawPoints::Draw(const autoware_msgs::SparsePointsImage::ConstPtr& points,
+                        cv::Mat &image, int drawn_size) {
+    if (points == NULL || points->index.empty()) {
+      return;
+    }
+
+    int width = image.size().width;
+    int height = image.size().height;
+    if (points->image_width != width || points->image_height != height) {
+      return;
+    }
+
+    // Same color range as the dense image, where empty pixels count as distance 0
+    float min_distance, max_distance;
+    min_distance = max_distance = points->distance[0];
+    if (points->index.size() < static_cast<size_t>(width) * height) {
+      min_distance = (0 < min_distance) ? 0 : min_distance;
+    }
+    for (size_t i = 1; i < points->distance.size(); i++) {
+      float distance = points->distance[i];
+      max_distance = (distance > max_distance) ? distance : max_distance;
+      min_distance = (distance < min_distance) ? distance : min_distance;
+    }
+    float distance_range = max_distance - min_distance;
+
+    for (size_t i = 0; i < points->index.size(); i++) {
+      float distance = points->distance[i];
+      if (distance == 0) {
+        continue;
+      }
+      int x = points->index[i] % width;
+      int y = points->index[i] / width;
+      DrawPoint(image, x, y, distance, min_distance, distance_range, drawn_size);
+    }
+
+  } // DrawPoints::Draw()
+
+
+  void DrawPoints::DrawPoint(cv::Mat &image, int x, int y, float distance, float min_distance,
+                             float distance_range, int drawn_size) {
+    // Specify which color will be use for this point
+    int color_id = distance_range ? ((distance - min_distance) * 255 / distance_range) : 128;
+
+    // Divide color into each element
+    cv::Vec3b color = color_map_.at<cv::Vec3b>(color_id);
+    int red   = color[0];
+    int green = color[1];
+    int blue  = color[2];
+
+    // Draw a point
+    int minus_offset = 0;
+    int plus_offset = static_cast<int>(drawn_size/2);
+    if (drawn_size % 2 == 0) {
+      minus_offset = static_cast<int>(drawn_size/2) - 1;
+    } else {
+      minus_offset = static_cast<int>(drawn_size/2);
+    }
+    cv::rectangle(image,
+                  cv::Point(x - minus_offset, y - minus_offset),
+                  cv::Point(x + plus_offset, y + plus_offset),
+                  CV_RGB(red, green, blue),
+                  CV_FILLED);
+  } // DrawPoints::DrawPoint()
+
 } // end namespace integrated_viewer
@@ -3,6 +3,7 @@
 
 #include <opencv/cv.h>
 #include "autoware_msgs/PointsImage.h"
+#include "autoware_msgs/SparsePointsImage.h"
 
 namespace integrated_viewer {
   // helper class to draw points image
@@ -10,10 +11,13 @@ namespace integrated_viewer {
   public:
     explicit DrawPoints(void);
     void Draw(const autoware_msgs::PointsImage::ConstPtr& points, cv::Mat& image, int drawn_size);
+    void Draw(const autoware_msgs::SparsePointsImage::ConstPtr& points, cv::Mat& image, int drawn_size);
 
   private:
     cv::Mat color_map_;
 
+    void DrawPoint(cv::Mat& image, int x, int y, float distance, float min_distance, float distance_range, int drawn_size);
+
   };
 
 } // end namespace integrated_viewer
@@ -17,6 +17,7 @@ namespace integrated_viewer {
     const QString     ImageViewerPlugin::kImageDataType                 = "sensor_msgs/Image";
     const QString     ImageViewerPlugin::kDetectedObjectDataTypeBase    = "autoware_msgs/DetectedObjectArray";
     const QString     ImageViewerPlugin::kPointDataType                 = "autoware_msgs/PointsImage";
+    const QString     ImageViewerPlugin::kSparsePointDataType           = "autoware_msgs/SparsePointsImage";
     const QString     ImageViewerPlugin::kLaneDataType                  = "autoware_msgs/ImageLaneObjects";
     const QString     ImageViewerPlugin::kBlankTopic                    = "-----";
 
@@ -35,6 +36,7 @@ namespace integrated_viewer {
         default_image_ = cv::imread( DEFAULT_PATH + "autoware_logo.png");
 
         points_msg_ = NULL;
+        sparse_points_msg_ = NULL;
         detected_objects_msg_ = NULL;
         lane_msg_ = NULL;
 
@@ -113,7 +115,7 @@ namespace integrated_viewer {
             }
 
             // Check whether this topic is point cloud
-            if (topic_type.contains(kPointDataType) == true) {
+            if (topic_type.contains(kPointDataType) == true || topic_type.contains(kSparsePointDataType) == true) {
                 point_topic_list << topic_name;
                 point_topic_list.sort();
                 continue;
@@ -178,6 +180,7 @@ namespace integrated_viewer {
           ui_.point_topic_combo_box_->setCurrentIndex(ui_.point_topic_combo_box_->findText(kBlankTopic));
           point_sub_.shutdown();
           points_msg_ = NULL;
+          sparse_points_msg_ = NULL;
         }
 
         if (lane_topic_index != -1) {
@@ -258,23 +261,55 @@ namespace integrated_viewer {
         if (selected_topic == kBlankTopic.toStdString() || selected_topic == "") {
             point_sub_.shutdown();
             points_msg_ = NULL;
+            sparse_points_msg_ = NULL;
             return;
         }
 
         // if selected topic is not blank or empty , start callback function
-        point_sub_ = node_handle_.subscribe<autoware_msgs::PointsImage>(selected_topic,
-                                                                        1,
-                                                                        &ImageViewerPlugin::PointCallback,
-                                                                        this);
+        SubscribePointTopic(selected_topic);
 
     } // ImageViewerPlugin::on_point_topic_combo_box__activated()
 
 
+    void ImageViewerPlugin::SubscribePointTopic(const std::string& topic) {
+        points_msg_ = NULL;
+        sparse_points_msg_ = NULL;
+
+        // Topics which are not advertised yet are handled as dense points image
+        bool is_sparse = false;
+        ros::master::V_TopicInfo master_topics;
+        ros::master::getTopics(master_topics);
+        for (ros::master::V_TopicInfo::iterator it = master_topics.begin(); it != master_topics.end(); it++) {
+            if (it->name == topic) {
+                is_sparse = QString::fromStdString(it->datatype).contains(kSparsePointDataType);
+                break;
+            }
+        }
+
+        if (is_sparse) {
+            point_sub_ = node_handle_.subscribe<autoware_msgs::SparsePointsImage>(topic,
+                                                                                  1,
+                                                                                  &ImageViewerPlugin::SparsePointCallback,
+                                                                                  this);
+        } else {
+            point_sub_ = node_handle_.subscribe<autoware_msgs::PointsImage>(topic,
+                                                                            1,
+                                                                            &ImageViewerPlugin::PointCallback,
+                                                                            this);
+        }
+    } // ImageViewerPlugin::SubscribePointTopic()
+
+
     void ImageViewerPlugin::PointCallback(const autoware_msgs::PointsImage::ConstPtr &msg) {
         points_msg_ = msg;
     } // ImageViewerPlugin::PointCallback()
 
 
+    void ImageViewerPlugin::SparsePointCallback(const autoware_msgs::SparsePointsImage::ConstPtr &msg) {
+        sparse_points_msg_ = msg;
+    } // ImageViewerPlugin::SparsePointCallback()
+
+
     // The behavior of combo box for detected lane
     void ImageViewerPlugin::on_lane_topic_combo_box__activated(int index) {
         // Extract selected topic name from combo box
@@ -306,6 +341,7 @@ namespace integrated_viewer {
             // Draw points on the image
             int point_size = ui_.point_size_spin_box_->value();
             points_drawer_.Draw(points_msg_, viewed_image_, point_size);
+            points_drawer_.Draw(sparse_points_msg_, viewed_image_, point_size);
 
             // Draw lane on the image
             lane_drawer_.Draw(lane_msg_, viewed_image_);
@@ -416,10 +452,7 @@ namespace integrated_viewer {
             topic_index = ui_.point_topic_combo_box_->findText(point_topic);
           }
           ui_.point_topic_combo_box_->setCurrentIndex(topic_index);
-          point_sub_ = node_handle_.subscribe<autoware_msgs::PointsImage>(selected_topic,
-                                                                          1,
-                                                                          &ImageViewerPlugin::PointCallback,
-                                                                          this);
+          SubscribePointTopic(selected_topic);
         }
       }
 
@@ -10,6 +10,7 @@
 #include "autoware_msgs/ImageObjRanged.h"
 #include "autoware_msgs/ImageObjTracked.h"
 #include "autoware_msgs/PointsImage.h"
+#include "autoware_msgs/SparsePointsImage.h"
 
 #include <string>
 #include <map>
@@ -51,6 +52,10 @@ namespace integrated_viewer
     void ImageCallback(const sensor_msgs::Image::ConstPtr& msg);
     void DetectedObjCallback(const autoware_msgs::DetectedObjectArray::ConstPtr &msg);
     void PointCallback(const autoware_msgs::PointsImage::ConstPtr &msg);
+    void SparsePointCallback(const autoware_msgs::SparsePointsImage::ConstPtr &msg);
+
+    // Subscribe points image topic with the callback of its data type
+    void SubscribePointTopic(const std::string& topic);
     void LaneCallback(const autoware_msgs::ImageLaneObjects::ConstPtr& msg);
 
    // The function to refrect modified image on UI
@@ -60,6 +65,7 @@ namespace integrated_viewer
     static const QString kImageDataType;
     static const QString kDetectedObjectDataTypeBase;
     static const QString kPointDataType;
+    static const QString kSparsePointDataType;
     static const QString kLaneDataType;
 
     // The blank topic name
@@ -88,6 +94,7 @@ namespace integrated_viewer
 
     // Data pointer to hold subscribed data
     autoware_msgs::PointsImage::ConstPtr points_msg_;
+    autoware_msgs::SparsePointsImage::ConstPtr sparse_points_msg_;
     autoware_msgs::DetectedObjectArray::ConstPtr detected_objects_msg_;
     autoware_msgs::ImageLaneObjects::ConstPtr lane_msg_;
 
@@ -20,8 +20,24 @@
 #include <opencv2/opencv.hpp>
 #include <sensor_msgs/PointCloud2.h>
 #include "autoware_msgs/PointsImage.h"
+#include "autoware_msgs/SparsePointsImage.h"
 
 void resetMatrix();
+
+/*
+ * Project the points on the image, only pixels hit by a point are stored.
+ * Points are projected in blocks by a vectorized kernel, then written to the pixels in point order.
+ */
+autoware_msgs::SparsePointsImage pointcloud2_to_sparse_image(const sensor_msgs::PointCloud2ConstPtr& pointclound2,
+                                                             const cv::Mat& cameraExtrinsicMat,
+                                                             const cv::Mat& cameraMat, const cv::Mat& distCoeff,
+                                                             const cv::Size& imageSize);
+
+/*
+ * Expand a sparse image to the dense w * h arrays of autoware_msgs::PointsImage.
+ */
+autoware_msgs::PointsImage sparse_image_to_points_image(const autoware_msgs::SparsePointsImage& sparse);
+
 autoware_msgs::PointsImage pointcloud2_to_image(const sensor_msgs::PointCloud2ConstPtr& pointclound2,
                                                 const cv::Mat& cameraExtrinsicMat, const cv::Mat& cameraMat,
                                                 const cv::Mat& distCoeff, const cv::Size& imageSize);
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <vector>
 #include <include/points_image/points_image.hpp>
 #include <stdint.h>
@@ -35,22 +36,84 @@ void initMatrix(const cv::Mat& cameraExtrinsicMat)
   init_matrix = true;
 }
 
-autoware_msgs::PointsImage pointcloud2_to_image(const sensor_msgs::PointCloud2ConstPtr& pointcloud2,
-                                                const cv::Mat& cameraExtrinsicMat, const cv::Mat& cameraMat,
-                                                const cv::Mat& distCoeff, const cv::Size& imageSize)
+namespace
+{
+// number of points projected together, small enough for the block to stay in L1 cache
+constexpr int PROJECTION_BLOCK_SIZE = 256;
+
+struct ProjectionParams
+{
+  double r[9];  // invRt, row major
+  double t[3];  // invTt
+  double k1, k2, p1, p2, k3;
+  double fx, fy, cx, cy;
+};
+
+struct ProjectionBlock
+{
+  double x[PROJECTION_BLOCK_SIZE];
+  double y[PROJECTION_BLOCK_SIZE];
+  double z[PROJECTION_BLOCK_SIZE];
+  double depth[PROJECTION_BLOCK_SIZE];
+  int px[PROJECTION_BLOCK_SIZE];
+  int py[PROJECTION_BLOCK_SIZE];
+};
+
+// pixel index -> entry of the sparse image, -1 if the pixel is empty. Reset after each frame.
+std::vector<int> pixel_entry;
+
+/*
+ * Project n points of the block without branches so the loop is vectorized.
+ * px and py are -1 for points behind the camera (depth <= 1), coordinates are clamped to [-2, size + 1].
+ */
+void projectBlock(const ProjectionParams& p, const int n, const int w, const int h, ProjectionBlock& b)
+{
+  const double u_max = w + 1.0;
+  const double v_max = h + 1.0;
+#pragma omp simd
+  for (int i = 0; i < n; i++)
+  {
+    const double cam_x = p.t[0] + b.x[i] * p.r[0] + b.y[i] * p.r[3] + b.z[i] * p.r[6];
+    const double cam_y = p.t[1] + b.x[i] * p.r[1] + b.y[i] * p.r[4] + b.z[i] * p.r[7];
+    const double cam_z = p.t[2] + b.x[i] * p.r[2] + b.y[i] * p.r[5] + b.z[i] * p.r[8];
+    const bool valid = cam_z > 1;
+    const double inv_z = 1.0 / (valid ? cam_z : 1.0);
+
+    const double tmpx = cam_x * inv_z;
+    const double tmpy = cam_y * inv_z;
+    const double r2 = tmpx * tmpx + tmpy * tmpy;
+    const double tmpdist = 1 + p.k1 * r2 + p.k2 * r2 * r2 + p.k3 * r2 * r2 * r2;
+    double u = tmpx * tmpdist + 2 * p.p1 * tmpx * tmpy + p.p2 * (r2 + 2 * tmpx * tmpx);
+    double v = tmpy * tmpdist + p.p1 * (r2 + 2 * tmpy * tmpy) + 2 * p.p2 * tmpx * tmpy;
+    u = p.fx * u + p.cx;
+    v = p.fy * v + p.cy;
+    // clamp (NaN to -2 as well) before the conversion to int
+    u = u > -2.0 ? u : -2.0;
+    v = v > -2.0 ? v : -2.0;
+    u = u < u_max ? u : u_max;
+    v = v < v_max ? v : v_max;
+    const int ix = int(u + 0.5);
+    const int iy = int(v + 0.5);
+
+    b.depth[i] = cam_z;
+    b.px[i] = valid ? ix : -1;
+    b.py[i] = valid ? iy : -1;
+  }
+}
+}  // namespace
+
+autoware_msgs::SparsePointsImage pointcloud2_to_sparse_image(const sensor_msgs::PointCloud2ConstPtr& pointcloud2,
+                                                             const cv::Mat& cameraExtrinsicMat,
+                                                             const cv::Mat& cameraMat, const cv::Mat& distCoeff,
+                                                             const cv::Size& imageSize)
 {
   int w = imageSize.width;
   int h = imageSize.height;
 
-  autoware_msgs::PointsImage msg;
+  autoware_msgs::SparsePointsImage msg;
 
   msg.header = pointcloud2->header;
 
-  msg.intensity.assign(w * h, 0);
-  msg.distance.assign(w * h, 0);
-  msg.min_height.assign(w * h, 0);
-  msg.max_height.assign(w * h, 0);
-
   uintptr_t cp = (uintptr_t)pointcloud2->data.data();
 
   msg.max_y = -1;
@@ -63,72 +126,136 @@ autoware_msgs::PointsImage pointcloud2_to_image(const sensor_msgs::PointCloud2Co
     initMatrix(cameraExtrinsicMat);
   }
 
-  cv::Mat point(1, 3, CV_64F);
-  cv::Point2d imagepoint;
-  for (uint32_t y = 0; y < pointcloud2->height; ++y)
+  ProjectionParams params;
+  for (int i = 0; i < 3; i++)
   {
-    for (uint32_t x = 0; x < pointcloud2->width; ++x)
+    params.t[i] = invTt.at<double>(i);
+    for (int j = 0; j < 3; j++)
     {
-      float* fp = (float*)(cp + (x + y * pointcloud2->width) * pointcloud2->point_step);
-      double intensity = fp[4];
-      for (int i = 0; i < 3; i++)
+      params.r[i * 3 + j] = invRt.at<double>(i, j);
+    }
+  }
+  params.k1 = distCoeff.at<double>(0);
+  params.k2 = distCoeff.at<double>(1);
+  params.p1 = distCoeff.at<double>(2);
+  params.p2 = distCoeff.at<double>(3);
+  params.k3 = distCoeff.at<double>(4);
+  params.fx = cameraMat.at<double>(0, 0);
+  params.fy = cameraMat.at<double>(1, 1);
+  params.cx = cameraMat.at<double>(0, 2);
+  params.cy = cameraMat.at<double>(1, 2);
+
+  if (pixel_entry.size() != size_t(w) * h)
+  {
+    pixel_entry.assign(size_t(w) * h, -1);
+  }
+
+  const uint32_t n_points = pointcloud2->width * pointcloud2->height;
+  const bool two_layers = pointcloud2->height == 2;
+  ProjectionBlock block;
+  for (uint32_t begin = 0; begin < n_points; begin += PROJECTION_BLOCK_SIZE)
+  {
+    const int n = std::min<uint32_t>(PROJECTION_BLOCK_SIZE, n_points - begin);
+    for (int i = 0; i < n; i++)
+    {
+      const float* fp = (const float*)(cp + (begin + i) * pointcloud2->point_step);
+      block.x[i] = fp[0];
+      block.y[i] = fp[1];
+      block.z[i] = fp[2];
+    }
+
+    projectBlock(params, n, w, h, block);
+
+    // scatter in point order, same result as projecting point by point
+    for (int i = 0; i < n; i++)
+    {
+      int px = block.px[i];
+      int py = block.py[i];
+      if (!(0 <= px && px < w && 0 <= py && py < h))
       {
-        point.at<double>(i) = invTt.at<double>(i);
-        for (int j = 0; j < 3; j++)
-        {
-          point.at<double>(i) += double(fp[j]) * invRt.at<double>(j, i);
-        }
+        continue;
       }
 
-      if (point.at<double>(2) <= 1)
+      const uint32_t index = begin + i;
+      const float* fp = (const float*)(cp + index * pointcloud2->point_step);
+      int pid = py * w + px;
+      int entry = pixel_entry[pid];
+      if (entry < 0)
       {
-        continue;
+        entry = msg.index.size();
+        pixel_entry[pid] = entry;
+        msg.index.push_back(pid);
+        msg.distance.push_back(0);
+        msg.intensity.push_back(0);
+        msg.min_height.push_back(0);
+        msg.max_height.push_back(0);
       }
 
-      double tmpx = point.at<double>(0) / point.at<double>(2);
-      double tmpy = point.at<double>(1) / point.at<double>(2);
-      double r2 = tmpx * tmpx + tmpy * tmpy;
-      double tmpdist =
-          1 + distCoeff.at<double>(0) * r2 + distCoeff.at<double>(1) * r2 * r2 + distCoeff.at<double>(4) * r2 * r2 * r2;
-
-      imagepoint.x =
-          tmpx * tmpdist + 2 * distCoeff.at<double>(2) * tmpx * tmpy + distCoeff.at<double>(3) * (r2 + 2 * tmpx * tmpx);
-      imagepoint.y =
-          tmpy * tmpdist + distCoeff.at<double>(2) * (r2 + 2 * tmpy * tmpy) + 2 * distCoeff.at<double>(3) * tmpx * tmpy;
-      imagepoint.x = cameraMat.at<double>(0, 0) * imagepoint.x + cameraMat.at<double>(0, 2);
-      imagepoint.y = cameraMat.at<double>(1, 1) * imagepoint.y + cameraMat.at<double>(1, 2);
-
-      int px = int(imagepoint.x + 0.5);
-      int py = int(imagepoint.y + 0.5);
-      if (0 <= px && px < w && 0 <= py && py < h)
+      if (msg.distance[entry] == 0 || msg.distance[entry] > block.depth[i])
+      {
+        msg.distance[entry] = float(block.depth[i] * 100);
+        msg.intensity[entry] = fp[4];
+
+        msg.max_y = py > msg.max_y ? py : msg.max_y;
+        msg.min_y = py < msg.min_y ? py : msg.min_y;
+      }
+      if (index < pointcloud2->width && two_layers)  // process simultaneously min and max during the first layer
       {
-        int pid = py * w + px;
-        if (msg.distance[pid] == 0 || msg.distance[pid] > point.at<double>(2))
-        {
-          msg.distance[pid] = float(point.at<double>(2) * 100);
-          msg.intensity[pid] = float(intensity);
-
-          msg.max_y = py > msg.max_y ? py : msg.max_y;
-          msg.min_y = py < msg.min_y ? py : msg.min_y;
-        }
-        if (0 == y && pointcloud2->height == 2)  // process simultaneously min and max during the first layer
-        {
-          float* fp2 = (float*)(cp + (x + (y + 1) * pointcloud2->width) * pointcloud2->point_step);
-          msg.min_height[pid] = fp[2];
-          msg.max_height[pid] = fp2[2];
-        }
-        else
-        {
-          msg.min_height[pid] = -1.25;
-          msg.max_height[pid] = 0;
-        }
+        const float* fp2 = (const float*)(cp + (index + pointcloud2->width) * pointcloud2->point_step);
+        msg.min_height[entry] = fp[2];
+        msg.max_height[entry] = fp2[2];
+      }
+      else
+      {
+        msg.min_height[entry] = -1.25;
+        msg.max_height[entry] = 0;
       }
     }
   }
 
+  for (size_t i = 0; i < msg.index.size(); i++)
+  {
+    pixel_entry[msg.index[i]] = -1;
+  }
+
   return msg;
 }
 
+autoware_msgs::PointsImage sparse_image_to_points_image(const autoware_msgs::SparsePointsImage& sparse)
+{
+  const size_t size = size_t(sparse.image_width) * sparse.image_height;
+
+  autoware_msgs::PointsImage msg;
+  msg.header = sparse.header;
+  msg.intensity.assign(size, 0);
+  msg.distance.assign(size, 0);
+  msg.min_height.assign(size, 0);
+  msg.max_height.assign(size, 0);
+  msg.max_y = sparse.max_y;
+  msg.min_y = sparse.min_y;
+  msg.image_height = sparse.image_height;
+  msg.image_width = sparse.image_width;
+
+  for (size_t i = 0; i < sparse.index.size(); i++)
+  {
+    const uint32_t pid = sparse.index[i];
+    msg.distance[pid] = sparse.distance[i];
+    msg.intensity[pid] = sparse.intensity[i];
+    msg.min_height[pid] = sparse.min_height[i];
+    msg.max_height[pid] = sparse.max_height[i];
+  }
+
+  return msg;
+}
+
+autoware_msgs::PointsImage pointcloud2_to_image(const sensor_msgs::PointCloud2ConstPtr& pointcloud2,
+                                                const cv::Mat& cameraExtrinsicMat, const cv::Mat& cameraMat,
+                                                const cv::Mat& distCoeff, const cv::Size& imageSize)
+{
+  return sparse_image_to_points_image(
+      pointcloud2_to_sparse_image(pointcloud2, cameraExtrinsicMat, cameraMat, distCoeff, imageSize));
+}
+
 /*autoware_msgs::CameraExtrinsic
 pointcloud2_to_3d_calibration(const sensor_msgs::PointCloud2ConstPtr& pointcloud2,
             const cv::Mat& cameraExtrinsicMat)
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "can_log_writer.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace kvaser
+{
+namespace
+{
+constexpr char LOG_MAGIC[8] = { 'A', 'W', 'C', 'A', 'N', 'L', 'O', 'G' };
+constexpr uint32_t LOG_VERSION = 1;
+}  // namespace
+
+CanLogWriter::CanLogWriter(size_t records_per_buffer)
+  : fp_(nullptr)
+  , records_per_buffer_(records_per_buffer)
+  , write_pending_(false)
+  , stop_(false)
+  , dropped_(0)
+{
+  filling_.reserve(records_per_buffer_);
+  writing_.reserve(records_per_buffer_);
+}
+
+CanLogWriter::~CanLogWriter()
+{
+  close();
+}
+
+bool CanLogWriter::open(const std::string& path)
+{
+  close();
+  fp_ = fopen(path.c_str(), "wb");
+  if (fp_ == nullptr)
+    return false;
+
+  CanLogHeader header;
+  memcpy(header.magic, LOG_MAGIC, sizeof(header.magic));
+  header.version = LOG_VERSION;
+  header.num_fields = NUM_FIELDS;
+  fwrite(&header, sizeof(header), 1, fp_);
+
+  stop_ = false;
+  dropped_ = 0;
+  thread_ = std::thread(&CanLogWriter::run, this);
+  return true;
+}
+
+void CanLogWriter::close()
+{
+  if (fp_ == nullptr)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  condition_.notify_one();
+  thread_.join();
+  fclose(fp_);
+  fp_ = nullptr;
+}
+
+void CanLogWriter::append(const CanLogRecord& record)
+{
+  bool notify = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (filling_.size() >= records_per_buffer_)
+    {
+      if (write_pending_)
+      {
+        // both buffers are in use, drop instead of blocking the caller on the disk
+        dropped_++;
+        return;
+      }
+      filling_.swap(writing_);
+      write_pending_ = true;
+      notify = true;
+    }
+    filling_.push_back(record);
+  }
+  if (notify)
+    condition_.notify_one();
+}
+
+size_t CanLogWriter::dropped() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
+
+void CanLogWriter::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    condition_.wait_for(lock, std::chrono::seconds(1), [this] { return write_pending_ || stop_; });
+    // write partially filled buffers once a second, and everything on close
+    if (!write_pending_ && !filling_.empty())
+    {
+      filling_.swap(writing_);
+      write_pending_ = true;
+    }
+    if (write_pending_)
+    {
+      lock.unlock();
+      fwrite(writing_.data(), sizeof(CanLogRecord), writing_.size(), fp_);
+      fflush(fp_);
+      writing_.clear();
+      lock.lock();
+      write_pending_ = false;
+      // records appended while writing are flushed in the same pass on close
+      if (stop_ && !filling_.empty())
+        continue;
+    }
+    if (stop_)
+      break;
+  }
+}
+
+bool CanLogWriter::read(const std::string& path, std::vector<CanLogRecord>& records)
+{
+  records.clear();
+  FILE* fp = fopen(path.c_str(), "rb");
+  if (fp == nullptr)
+    return false;
+
+  CanLogHeader header;
+  const bool valid = fread(&header, sizeof(header), 1, fp) == 1 &&
+                     memcmp(header.magic, LOG_MAGIC, sizeof(header.magic)) == 0 && header.version == LOG_VERSION &&
+                     header.num_fields == NUM_FIELDS;
+  if (valid)
+  {
+    CanLogRecord record;
+    while (fread(&record, sizeof(record), 1, fp) == 1)
+      records.push_back(record);
+  }
+  fclose(fp);
+  return valid;
+}
+}  // namespace kvaser
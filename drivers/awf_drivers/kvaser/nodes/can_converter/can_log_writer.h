@@ -0,0 +1,92 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KVASER_CAN_LOG_WRITER_H
+#define KVASER_CAN_LOG_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "can_signal_table.h"
+
+namespace kvaser
+{
+// Binary log format: a CanLogHeader followed by CanLogRecords, all little endian as written by the host.
+// Each record holds the signal values after a decoded frame, in the column order of the former text log.
+struct CanLogHeader
+{
+  char magic[8];  // "AWCANLOG"
+  uint32_t version;
+  uint32_t num_fields;
+};
+
+struct CanLogRecord
+{
+  double stamp;  // header.stamp of the frame in seconds
+  uint32_t time;  // time field of the frame
+  uint32_t id;
+  int32_t values[NUM_FIELDS];
+};
+
+static_assert(sizeof(CanLogRecord) == 16 + 4 * NUM_FIELDS, "CanLogRecord must not be padded");
+
+// Log writer which keeps file I/O off the receive path. Records are appended to a buffer in memory, and a
+// background thread writes the full buffer to the file while the next one is filled.
+class CanLogWriter
+{
+public:
+  explicit CanLogWriter(size_t records_per_buffer = 4096);
+  ~CanLogWriter();
+  CanLogWriter(const CanLogWriter&) = delete;
+  CanLogWriter& operator=(const CanLogWriter&) = delete;
+
+  bool open(const std::string& path);
+  // Write what is buffered and close the file.
+  void close();
+  bool isOpen() const
+  {
+    return fp_ != nullptr;
+  }
+
+  void append(const CanLogRecord& record);
+
+  // Number of records dropped because the writer thread could not keep up.
+  size_t dropped() const;
+
+  static bool read(const std::string& path, std::vector<CanLogRecord>& records);
+
+private:
+  FILE* fp_;
+  size_t records_per_buffer_;
+  std::vector<CanLogRecord> filling_;
+  std::vector<CanLogRecord> writing_;
+  bool write_pending_;
+  bool stop_;
+  size_t dropped_;
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  std::thread thread_;
+
+  void run();
+};
+}  // namespace kvaser
+
+#endif  // KVASER_CAN_LOG_WRITER_H
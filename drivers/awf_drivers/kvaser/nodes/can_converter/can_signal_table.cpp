@@ -0,0 +1,132 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "can_signal_table.h"
+
+#include <algorithm>
+
+namespace kvaser
+{
+namespace
+{
+constexpr uint32_t EXTENDED_FLAG = 0x80000000U;
+}
+
+const std::vector<CanSignal>& defaultCanSignals()
+{
+  static const std::vector<CanSignal> signals = {
+    { 0x24, FIELD_GYRO, 0, 16, true, SIGNAL_VALUE },
+    { 0x24, FIELD_ACCX, 24, 8, true, SIGNAL_VALUE },
+    { 0x24, FIELD_ACCY, 32, 16, true, SIGNAL_VALUE },
+    { 0x24, FIELD_ACCZ, 56, 8, false, SIGNAL_VALUE },
+    { 0x25, FIELD_STEER, 4, 12, true, SIGNAL_VALUE },
+    { 0xaa, FIELD_WHEEL1, 0, 16, true, SIGNAL_VALUE },
+    { 0xaa, FIELD_WHEEL2, 16, 16, true, SIGNAL_VALUE },
+    { 0xaa, FIELD_WHEEL3, 32, 16, true, SIGNAL_VALUE },
+    { 0xaa, FIELD_WHEEL4, 48, 16, true, SIGNAL_VALUE },
+    { 0xb4, FIELD_SPEED3, 40, 16, true, SIGNAL_VALUE },
+    { 0x127, FIELD_SHIFT, 24, 8, false, SIGNAL_VALUE },
+    { 0x127, FIELD_SPEED, 32, 8, true, SIGNAL_VALUE },
+    { 0x224, FIELD_BRAKE, 32, 16, true, SIGNAL_VALUE },
+    { 0x230, FIELD_ENC_SUM, 0, 16, true, SIGNAL_COUNTER },
+  };
+  return signals;
+}
+
+CanSignalTable::CanSignalTable(const std::vector<CanSignal>& signals)
+  : signals_(signals), first_signal_(NUM_STANDARD_IDS + 1, 0)
+{
+  std::stable_sort(signals_.begin(), signals_.end(),
+                   [](const CanSignal& a, const CanSignal& b) { return a.id < b.id; });
+  counters_.assign(signals_.size(), 0);
+
+  // standard ids sort before extended ids, so the offsets of the standard ids are a prefix of signals_
+  for (const auto& signal : signals_)
+  {
+    if (signal.id < NUM_STANDARD_IDS)
+      first_signal_[signal.id + 1]++;
+  }
+  for (uint32_t id = 0; id < NUM_STANDARD_IDS; ++id)
+    first_signal_[id + 1] += first_signal_[id];
+}
+
+int32_t CanSignalTable::extract(uint64_t payload, const CanSignal& signal)
+{
+  const uint64_t mask = (signal.length >= 64) ? ~0ULL : ((1ULL << signal.length) - 1);
+  const uint64_t raw = (payload >> (64 - signal.start_bit - signal.length)) & mask;
+  if (signal.is_signed && signal.length < 64 && (raw >> (signal.length - 1)) & 1)
+    return static_cast<int32_t>(raw | ~mask);
+  return static_cast<int32_t>(raw);
+}
+
+bool CanSignalTable::contains(uint32_t id, bool extended) const
+{
+  if (!extended)
+    return id < NUM_STANDARD_IDS && first_signal_[id] != first_signal_[id + 1];
+  const uint32_t key = id | EXTENDED_FLAG;
+  return std::binary_search(signals_.begin() + first_signal_[NUM_STANDARD_IDS], signals_.end(),
+                            CanSignal{ key, NUM_FIELDS, 0, 0, false, SIGNAL_VALUE },
+                            [](const CanSignal& a, const CanSignal& b) { return a.id < b.id; });
+}
+
+bool CanSignalTable::decode(uint32_t id, bool extended, const uint8_t* data, uint8_t len, int32_t* values)
+{
+  size_t begin, end;
+  if (!extended)
+  {
+    if (id >= NUM_STANDARD_IDS)
+      return false;
+    begin = first_signal_[id];
+    end = first_signal_[id + 1];
+  }
+  else
+  {
+    const uint32_t key = id | EXTENDED_FLAG;
+    const auto range = std::equal_range(signals_.begin() + first_signal_[NUM_STANDARD_IDS], signals_.end(),
+                                        CanSignal{ key, NUM_FIELDS, 0, 0, false, SIGNAL_VALUE },
+                                        [](const CanSignal& a, const CanSignal& b) { return a.id < b.id; });
+    begin = range.first - signals_.begin();
+    end = range.second - signals_.begin();
+  }
+  if (begin == end)
+    return false;
+
+  // bytes beyond len read as 0
+  uint64_t payload = 0;
+  for (uint8_t i = 0; i < 8; ++i)
+    payload = (payload << 8) | (i < len ? data[i] : 0);
+
+  for (size_t i = begin; i < end; ++i)
+  {
+    const CanSignal& signal = signals_[i];
+    const int32_t value = extract(payload, signal);
+    if (signal.kind == SIGNAL_VALUE)
+    {
+      values[signal.field] = value;
+      continue;
+    }
+
+    // difference in the width of the counter, so a wrap around is a small step
+    CanSignal delta = signal;
+    delta.start_bit = 64 - signal.length;
+    const int32_t diff = extract(static_cast<uint64_t>(value) - counters_[i], delta);
+    counters_[i] = static_cast<uint32_t>(value);
+    values[signal.field] += diff;
+    values[signal.field + 1] = diff;
+  }
+  return true;
+}
+}  // namespace kvaser
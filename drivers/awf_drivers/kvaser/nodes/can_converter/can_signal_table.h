@@ -0,0 +1,94 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KVASER_CAN_SIGNAL_TABLE_H
+#define KVASER_CAN_SIGNAL_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace kvaser
+{
+// Vehicle signals decoded by can_converter, in the column order of the log.
+enum CanField
+{
+  FIELD_STEER,
+  FIELD_SHIFT,
+  FIELD_SPEED,
+  FIELD_SPEED2,
+  FIELD_SPEED3,
+  FIELD_ENC_SUM,
+  FIELD_ENC_DIFF,
+  FIELD_BRAKE,
+  FIELD_WHEEL1,
+  FIELD_WHEEL2,
+  FIELD_WHEEL3,
+  FIELD_WHEEL4,
+  FIELD_ACCX,
+  FIELD_ACCY,
+  FIELD_ACCZ,
+  FIELD_GYRO,
+  NUM_FIELDS
+};
+
+enum CanSignalKind
+{
+  SIGNAL_VALUE,    // the field is set to the decoded value
+  SIGNAL_COUNTER,  // wrapping counter, the field accumulates the differences and field + 1 is set to the last one
+};
+
+// One signal of a frame in Motorola (big endian) byte order. start_bit counts from the most significant bit of
+// data[0], so e.g. a 16 bit value in data[4..5] has start_bit 32 and length 16. Extended ids are given with
+// CAN_EFF_FLAG (bit 31) set.
+struct CanSignal
+{
+  uint32_t id;
+  CanField field;
+  uint8_t start_bit;
+  uint8_t length;
+  bool is_signed;
+  CanSignalKind kind;
+};
+
+// The signals of the vehicle the converter was written for.
+const std::vector<CanSignal>& defaultCanSignals();
+
+// Decoder for a fixed set of signals. The signals are compiled into a table indexed by the standard 11 bit id, so a
+// frame is decoded with one lookup and a shift and mask per signal, and frames of other ids are rejected at once.
+class CanSignalTable
+{
+public:
+  explicit CanSignalTable(const std::vector<CanSignal>& signals = defaultCanSignals());
+
+  // Update values (NUM_FIELDS entries) with the signals of the frame. Return false if no signal has this id.
+  bool decode(uint32_t id, bool extended, const uint8_t* data, uint8_t len, int32_t* values);
+
+  // Whether any signal is decoded from frames of this id.
+  bool contains(uint32_t id, bool extended) const;
+
+private:
+  static constexpr uint32_t NUM_STANDARD_IDS = 2048;
+
+  std::vector<CanSignal> signals_;  // sorted by id
+  std::vector<uint32_t> first_signal_;  // CSR offsets into signals_, NUM_STANDARD_IDS + 1 entries
+  std::vector<uint32_t> counters_;  // previous raw value of each signal of kind SIGNAL_COUNTER
+
+  static int32_t extract(uint64_t payload, const CanSignal& signal);
+};
+}  // namespace kvaser
+
+#endif  // KVASER_CAN_SIGNAL_TABLE_H
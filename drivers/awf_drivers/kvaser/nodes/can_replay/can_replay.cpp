@@ -0,0 +1,49 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Replay generated vehicle frames on a SocketCAN interface, e.g. to run
+ * socketcan_listener and can_converter against vcan0 without a vehicle:
+ *
+ *   ip link add dev vcan0 type vcan && ip link set up vcan0
+ *   rosrun kvaser can_replay vcan0 8000 100000
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "can_replay_generator.h"
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2 || argc > 4)
+  {
+    printf("usage %s interface [rate_hz] [count]\n", argv[0]);
+    return 1;
+  }
+  const double rate_hz = argc > 2 ? atof(argv[2]) : 1000.0;
+  const size_t count = argc > 3 ? strtoul(argv[3], nullptr, 10) : 100000;
+
+  kvaser::SocketCan socket_can;
+  if (!socket_can.open(argv[1]))
+  {
+    printf("%s\n", socket_can.error().c_str());
+    return 1;
+  }
+  const size_t sent = kvaser::replayFrames(socket_can, kvaser::generateVehicleFrames(count), rate_hz);
+  printf("sent %zu frames on %s\n", sent, argv[1]);
+  return sent == count ? 0 : 1;
+}
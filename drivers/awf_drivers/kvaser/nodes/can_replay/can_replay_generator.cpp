@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "can_replay_generator.h"
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+namespace kvaser
+{
+std::vector<CanFrame> generateVehicleFrames(size_t count, uint32_t seed)
+{
+  // ids of can_converter and a few which are not decoded
+  static const uint32_t ids[] = { 0x24, 0x25, 0xaa, 0xb4, 0x127, 0x224, 0x230, 0x3e8, 0x610, 0x7df };
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::uniform_int_distribution<size_t> index(0, sizeof(ids) / sizeof(ids[0]) - 1);
+
+  std::vector<CanFrame> frames(count);
+  uint16_t encoder = 0;
+  for (auto& frame : frames)
+  {
+    frame.id = ids[index(rng)];
+    frame.extended = false;
+    frame.rtr = false;
+    frame.len = 8;
+    frame.stamp_ns = 0;
+    frame.hardware_stamp = false;
+    for (auto& data : frame.data)
+      data = static_cast<uint8_t>(byte(rng));
+    if (frame.id == 0x230)
+    {
+      // the encoder counts up in small steps and wraps around
+      encoder += static_cast<uint16_t>(byte(rng) % 64);
+      frame.data[0] = static_cast<uint8_t>(encoder >> 8);
+      frame.data[1] = static_cast<uint8_t>(encoder & 0xff);
+    }
+  }
+  return frames;
+}
+
+size_t replayFrames(SocketCan& socket_can, const std::vector<CanFrame>& frames, double rate_hz)
+{
+  const auto begin = std::chrono::steady_clock::now();
+  size_t sent = 0;
+  for (const auto& frame : frames)
+  {
+    if (rate_hz > 0)
+      std::this_thread::sleep_until(begin + std::chrono::duration<double>(sent / rate_hz));
+    if (!socket_can.send(frame))
+      break;
+    ++sent;
+  }
+  return sent;
+}
+}  // namespace kvaser
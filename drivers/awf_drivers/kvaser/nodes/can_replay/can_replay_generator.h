@@ -0,0 +1,36 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KVASER_CAN_REPLAY_GENERATOR_H
+#define KVASER_CAN_REPLAY_GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../socketcan_listener/socketcan.h"
+
+namespace kvaser
+{
+// Deterministic frame sequence with the ids decoded by can_converter, interleaved with frames of other ids as on
+// a real bus. The same seed always gives the same sequence.
+std::vector<CanFrame> generateVehicleFrames(size_t count, uint32_t seed = 1);
+
+// Send frames at rate_hz, or as fast as the interface accepts them if rate_hz is 0. Return the number sent.
+size_t replayFrames(SocketCan& socket_can, const std::vector<CanFrame>& frames, double rate_hz);
+}  // namespace kvaser
+
+#endif  // KVASER_CAN_REPLAY_GENERATOR_H
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "socketcan.h"
+
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+namespace kvaser
+{
+SocketCan::SocketCan() : fd_(-1), use_hardware_stamp_(false), timestamping_(false)
+{
+  for (size_t i = 0; i < MAX_BATCH; ++i)
+  {
+    iovecs_[i].iov_base = &raw_frames_[i];
+    iovecs_[i].iov_len = sizeof(raw_frames_[i]);
+  }
+}
+
+SocketCan::~SocketCan()
+{
+  close();
+}
+
+void SocketCan::setError(const std::string& what)
+{
+  error_ = what + ": " + strerror(errno);
+}
+
+bool SocketCan::open(const std::string& interface, bool use_hardware_stamp)
+{
+  close();
+  use_hardware_stamp_ = use_hardware_stamp;
+
+  fd_ = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+  if (fd_ < 0)
+  {
+    setError("socket");
+    return false;
+  }
+
+  struct ifreq ifr;
+  memset(&ifr, 0, sizeof(ifr));
+  strncpy(ifr.ifr_name, interface.c_str(), IFNAMSIZ - 1);
+  if (ioctl(fd_, SIOCGIFINDEX, &ifr) < 0)
+  {
+    setError("SIOCGIFINDEX " + interface);
+    close();
+    return false;
+  }
+
+  // a large receive buffer absorbs bursts while the node is publishing the previous batch
+  const int rcvbuf = 4 * 1024 * 1024;
+  setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+  // prefer SO_TIMESTAMPING, which also reports hardware timestamps, and fall back to nanosecond kernel timestamps
+  const int timestamping_flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE |
+                                 SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+  timestamping_ = setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPING, &timestamping_flags, sizeof(timestamping_flags)) == 0;
+  if (!timestamping_)
+  {
+    const int enable = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+  }
+
+  struct sockaddr_can addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.can_family = AF_CAN;
+  addr.can_ifindex = ifr.ifr_ifindex;
+  if (bind(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+  {
+    setError("bind " + interface);
+    close();
+    return false;
+  }
+  return true;
+}
+
+void SocketCan::close()
+{
+  if (fd_ >= 0)
+    ::close(fd_);
+  fd_ = -1;
+}
+
+uint64_t SocketCan::frameStamp(struct msghdr& header, bool& hardware_stamp) const
+{
+  hardware_stamp = false;
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr; cmsg = CMSG_NXTHDR(&header, cmsg))
+  {
+    if (cmsg->cmsg_level != SOL_SOCKET)
+      continue;
+    if (cmsg->cmsg_type == SO_TIMESTAMPING)
+    {
+      // ts[0] is the software timestamp, ts[2] the raw hardware timestamp
+      struct timespec ts[3];
+      memcpy(ts, CMSG_DATA(cmsg), sizeof(ts));
+      if (use_hardware_stamp_ && (ts[2].tv_sec != 0 || ts[2].tv_nsec != 0))
+      {
+        hardware_stamp = true;
+        return ts[2].tv_sec * 1000000000ULL + ts[2].tv_nsec;
+      }
+      return ts[0].tv_sec * 1000000000ULL + ts[0].tv_nsec;
+    }
+    if (cmsg->cmsg_type == SO_TIMESTAMPNS)
+    {
+      struct timespec ts;
+      memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+      return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    }
+  }
+
+  // no timestamp attached, e.g. the option was rejected by the kernel
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+int SocketCan::receive(std::vector<CanFrame>& frames, int timeout_ms)
+{
+  if (fd_ < 0)
+    return -1;
+
+  struct pollfd pfd;
+  pfd.fd = fd_;
+  pfd.events = POLLIN;
+  const int ready = poll(&pfd, 1, timeout_ms);
+  if (ready < 0)
+  {
+    if (errno == EINTR)
+      return 0;
+    setError("poll");
+    return -1;
+  }
+  if (ready == 0)
+    return 0;
+
+  for (size_t i = 0; i < MAX_BATCH; ++i)
+  {
+    struct msghdr& header = headers_[i].msg_hdr;
+    memset(&header, 0, sizeof(header));
+    header.msg_iov = &iovecs_[i];
+    header.msg_iovlen = 1;
+    header.msg_control = controls_[i];
+    header.msg_controllen = sizeof(controls_[i]);
+    headers_[i].msg_len = 0;
+  }
+
+  // everything which is already queued is taken with a single system call
+  const int received = recvmmsg(fd_, headers_, MAX_BATCH, MSG_DONTWAIT, nullptr);
+  if (received < 0)
+  {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+      return 0;
+    setError("recvmmsg");
+    return -1;
+  }
+
+  int count = 0;
+  for (int i = 0; i < received; ++i)
+  {
+    if (headers_[i].msg_len < sizeof(struct can_frame))
+      continue;
+    const struct can_frame& raw = raw_frames_[i];
+    if (raw.can_id & CAN_ERR_FLAG)
+      continue;
+
+    CanFrame frame;
+    frame.extended = (raw.can_id & CAN_EFF_FLAG) != 0;
+    frame.rtr = (raw.can_id & CAN_RTR_FLAG) != 0;
+    frame.id = raw.can_id & (frame.extended ? CAN_EFF_MASK : CAN_SFF_MASK);
+    frame.len = raw.can_dlc > 8 ? 8 : raw.can_dlc;
+    memcpy(frame.data, raw.data, sizeof(frame.data));
+    frame.stamp_ns = frameStamp(headers_[i].msg_hdr, frame.hardware_stamp);
+    frames.push_back(frame);
+    ++count;
+  }
+  return count;
+}
+
+bool SocketCan::send(const CanFrame& frame)
+{
+  if (fd_ < 0)
+    return false;
+
+  struct can_frame raw;
+  memset(&raw, 0, sizeof(raw));
+  raw.can_id = frame.id;
+  if (frame.extended)
+    raw.can_id |= CAN_EFF_FLAG;
+  if (frame.rtr)
+    raw.can_id |= CAN_RTR_FLAG;
+  raw.can_dlc = frame.len > 8 ? 8 : frame.len;
+  memcpy(raw.data, frame.data, raw.can_dlc);
+
+  // the transmit queue of a virtual interface is short, retry while it is full
+  while (write(fd_, &raw, sizeof(raw)) != sizeof(raw))
+  {
+    if (errno != ENOBUFS && errno != EAGAIN && errno != EINTR)
+    {
+      setError("write");
+      return false;
+    }
+    struct pollfd pfd;
+    pfd.fd = fd_;
+    pfd.events = POLLOUT;
+    poll(&pfd, 1, 10);
+  }
+  return true;
+}
+}  // namespace kvaser
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KVASER_SOCKETCAN_H
+#define KVASER_SOCKETCAN_H
+
+#include <linux/can.h>
+#include <sys/socket.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace kvaser
+{
+struct CanFrame
+{
+  uint32_t id;  // without the EFF/RTR/ERR flag bits
+  bool extended;
+  bool rtr;
+  uint8_t len;
+  uint8_t data[8];
+  uint64_t stamp_ns;  // receive time, 0 for frames which are sent
+  bool hardware_stamp;
+};
+
+// Raw SocketCAN socket bound to one interface (can0, vcan0, ...).
+// Frames are received in batches with recvmmsg, each with the kernel (or hardware) receive timestamp.
+class SocketCan
+{
+public:
+  static constexpr size_t MAX_BATCH = 64;
+
+  SocketCan();
+  ~SocketCan();
+  SocketCan(const SocketCan&) = delete;
+  SocketCan& operator=(const SocketCan&) = delete;
+
+  // Open and bind the interface. With use_hardware_stamp the timestamp of the controller is preferred when the
+  // driver provides one, it is only comparable to the system time if the controller clock is synchronized.
+  bool open(const std::string& interface, bool use_hardware_stamp = false);
+  void close();
+  bool isOpen() const
+  {
+    return fd_ >= 0;
+  }
+  const std::string& error() const
+  {
+    return error_;
+  }
+
+  // Wait up to timeout_ms for frames and append everything which is queued, up to MAX_BATCH, to frames.
+  // Return the number of frames received, 0 on timeout or -1 on error.
+  int receive(std::vector<CanFrame>& frames, int timeout_ms);
+
+  bool send(const CanFrame& frame);
+
+private:
+  int fd_;
+  bool use_hardware_stamp_;
+  bool timestamping_;
+  std::string error_;
+
+  struct can_frame raw_frames_[MAX_BATCH];
+  struct iovec iovecs_[MAX_BATCH];
+  struct mmsghdr headers_[MAX_BATCH];
+  char controls_[MAX_BATCH][CMSG_SPACE(3 * sizeof(struct timespec))];
+
+  void setError(const std::string& what);
+  uint64_t frameStamp(struct msghdr& header, bool& hardware_stamp) const;
+};
+}  // namespace kvaser
+
+#endif  // KVASER_SOCKETCAN_H
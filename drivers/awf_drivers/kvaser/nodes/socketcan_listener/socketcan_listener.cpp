@@ -0,0 +1,110 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Read CAN frames from a SocketCAN interface and publish them on can_raw,
+ * in the same format as can_listener does for Kvaser canlib.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include "autoware_can_msgs/CANPacket.h"
+
+#include "socketcan.h"
+
+namespace
+{
+// flag bits of canlib, so can_raw looks the same for both listeners
+constexpr uint16_t CAN_MSG_RTR = 0x0001;
+constexpr uint16_t CAN_MSG_STD = 0x0002;
+constexpr uint16_t CAN_MSG_EXT = 0x0004;
+
+// receive errors (e.g. ENETDOWN while the interface is down) are retried with a growing delay,
+// and the socket is opened again after a number of consecutive failures
+constexpr double MIN_RETRY_DELAY = 0.01;  // [s]
+constexpr double MAX_RETRY_DELAY = 1.0;   // [s]
+constexpr int REOPEN_FAILURES = 10;
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  ros::init(argc, argv, "socketcan_listener");
+  ros::NodeHandle n;
+  ros::NodeHandle private_nh("~");
+
+  std::string interface;
+  bool hardware_timestamp;
+  private_nh.param<std::string>("interface", interface, "can0");
+  private_nh.param<bool>("hardware_timestamp", hardware_timestamp, false);
+
+  ros::Publisher can_pub = n.advertise<autoware_can_msgs::CANPacket>("can_raw", 1000);
+
+  kvaser::SocketCan socket_can;
+  if (!socket_can.open(interface, hardware_timestamp))
+  {
+    ROS_ERROR("socketcan_listener: %s", socket_can.error().c_str());
+    return -1;
+  }
+  ROS_INFO("socketcan_listener: reading messages on %s", interface.c_str());
+
+  std::vector<kvaser::CanFrame> frames;
+  frames.reserve(kvaser::SocketCan::MAX_BATCH);
+  autoware_can_msgs::CANPacket candat;
+  uint32_t count = 0;
+  int failures = 0;
+  double retry_delay = MIN_RETRY_DELAY;
+  while (ros::ok())
+  {
+    frames.clear();
+    if (socket_can.receive(frames, 100) < 0)
+    {
+      ROS_ERROR_THROTTLE(1, "socketcan_listener: %s", socket_can.error().c_str());
+      if (++failures % REOPEN_FAILURES == 0)
+      {
+        ROS_WARN("socketcan_listener: %d receive errors in a row, reopening %s", failures, interface.c_str());
+        socket_can.open(interface, hardware_timestamp);
+      }
+      ros::Duration(retry_delay).sleep();
+      retry_delay = std::min(2.0 * retry_delay, MAX_RETRY_DELAY);
+      ros::spinOnce();
+      continue;
+    }
+    if (failures > 0)
+    {
+      ROS_INFO("socketcan_listener: receiving again on %s after %d errors", interface.c_str(), failures);
+      failures = 0;
+      retry_delay = MIN_RETRY_DELAY;
+    }
+
+    for (const auto& frame : frames)
+    {
+      candat.header.stamp.fromNSec(frame.stamp_ns);
+      candat.count = count++;
+      candat.id = frame.id;
+      candat.len = frame.len;
+      std::copy(frame.data, frame.data + 8, candat.dat.begin());
+      candat.flag = (frame.extended ? CAN_MSG_EXT : CAN_MSG_STD) | (frame.rtr ? CAN_MSG_RTR : 0);
+      // canlib reports the time in milliseconds
+      candat.time = static_cast<uint32_t>(frame.stamp_ns / 1000000ULL);
+      can_pub.publish(candat);
+    }
+    ros::spinOnce();
+  }
+  return 0;
+}
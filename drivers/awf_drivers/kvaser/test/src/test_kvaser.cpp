@@ -0,0 +1,253 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "can_converter/can_log_writer.h"
+#include "can_converter/can_signal_table.h"
+#include "can_replay/can_replay_generator.h"
+#include "socketcan_listener/socketcan.h"
+
+using kvaser::CanFrame;
+using kvaser::CanLogRecord;
+using kvaser::CanLogWriter;
+using kvaser::CanSignalTable;
+using kvaser::NUM_FIELDS;
+using kvaser::SocketCan;
+
+namespace
+{
+// Decoding of can_converter before the signal table, as reference.
+class LegacyDecoder
+{
+public:
+  LegacyDecoder()
+  {
+    memset(values_, 0, sizeof(values_));
+  }
+
+  bool decode(uint32_t id, const uint8_t* dat)
+  {
+    unsigned short w;
+    short diff;
+    int changed = 0;
+    if (id == 0x24)
+    {
+      w = dat[0] * 256 + dat[1];
+      gyro_ = w;
+      w = dat[2] * 256 + dat[3];
+      accx_ = w;
+      w = dat[4] * 256 + dat[5];
+      accy_ = w;
+      w = dat[7];
+      accz_ = w;
+      changed = 1;
+    }
+    if (id == 0x25)
+    {
+      w = dat[0] * 4096 + dat[1] * 16;
+      steer_ = w;
+      steer_ = steer_ / 16;
+      changed = 1;
+    }
+    if (id == 0xaa)
+    {
+      w = dat[0] * 256 + dat[1];
+      wheel1_ = w;
+      w = dat[2] * 256 + dat[3];
+      wheel2_ = w;
+      w = dat[4] * 256 + dat[5];
+      wheel3_ = w;
+      w = dat[6] * 256 + dat[7];
+      wheel4_ = w;
+      changed = 1;
+    }
+    if (id == 0xb4)
+    {
+      w = dat[5] * 256 + dat[6];
+      speed3_ = w;
+      changed = 1;
+    }
+    if (id == 0x224)
+    {
+      w = dat[4] * 256 + dat[5];
+      brake_ = w;
+      changed = 1;
+    }
+    if (id == 0x127)
+    {
+      shift_ = dat[3];
+      speed_ = dat[4];
+      changed = 1;
+    }
+    if (id == 0x230)
+    {
+      w = dat[0] * 256 + dat[1];
+      enc_p_ = enc_;
+      enc_ = w;
+      diff = enc_ - enc_p_;
+      enc_diff_ = diff;
+      enc_sum_ += diff;
+      changed = 1;
+    }
+    const int32_t values[NUM_FIELDS] = { steer_,  shift_,  speed_,  0,      speed3_, enc_sum_, enc_diff_, brake_,
+                                         wheel1_, wheel2_, wheel3_, wheel4_, accx_,  accy_,    accz_,     gyro_ };
+    memcpy(values_, values, sizeof(values_));
+    return changed != 0;
+  }
+
+  const int32_t* values() const
+  {
+    return values_;
+  }
+
+private:
+  int32_t values_[NUM_FIELDS];
+  int enc_sum_ = 0;
+  short steer_ = 0, shift_ = 0, speed3_ = 0, brake_ = 0;
+  signed char speed_ = 0;
+  short enc_ = 0, enc_p_ = 0, enc_diff_ = 0;
+  short wheel1_ = 0, wheel2_ = 0, wheel3_ = 0, wheel4_ = 0;
+  short gyro_ = 0, accy_ = 0, accz_ = 0;
+  signed char accx_ = 0;
+};
+}  // namespace
+
+TEST(TestKvaser, SignalTableMatchesLegacyDecoding)
+{
+  const auto frames = kvaser::generateVehicleFrames(100000);
+  CanSignalTable table;
+  LegacyDecoder legacy;
+  int32_t values[NUM_FIELDS] = {};
+
+  for (const auto& frame : frames)
+  {
+    const bool decoded = table.decode(frame.id, frame.extended, frame.data, frame.len, values);
+    ASSERT_EQ(decoded, legacy.decode(frame.id, frame.data));
+    ASSERT_EQ(decoded, table.contains(frame.id, frame.extended));
+    for (int field = 0; field < NUM_FIELDS; ++field)
+      ASSERT_EQ(values[field], legacy.values()[field]) << "field " << field << " of id " << frame.id;
+  }
+
+  // extended ids are kept apart from the standard ids
+  const uint8_t data[8] = { 0x12, 0x34, 0, 0, 0, 0, 0, 0 };
+  ASSERT_FALSE(table.decode(0x24, true, data, 8, values));
+  CanSignalTable extended_table({ { 0x18ff0024 | 0x80000000U, kvaser::FIELD_GYRO, 0, 16, true, kvaser::SIGNAL_VALUE } });
+  ASSERT_TRUE(extended_table.decode(0x18ff0024, true, data, 8, values));
+  ASSERT_EQ(values[kvaser::FIELD_GYRO], 0x1234);
+  ASSERT_FALSE(extended_table.contains(0x24, false));
+}
+
+TEST(TestKvaser, BinaryLogRoundTrip)
+{
+  const std::string path = "/tmp/test_kvaser_can_log.bin";
+  {
+    CanLogWriter writer(64);  // small buffers, so the writer thread swaps many times
+    ASSERT_TRUE(writer.open(path));
+    for (uint32_t i = 0; i < 10000; ++i)
+    {
+      CanLogRecord record;
+      record.stamp = i * 0.001;
+      record.time = i;
+      record.id = 0x24;
+      for (int field = 0; field < NUM_FIELDS; ++field)
+        record.values[field] = static_cast<int32_t>(i * NUM_FIELDS + field);
+      writer.append(record);
+      if (i % 64 == 0)
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    writer.close();
+    ASSERT_EQ(writer.dropped(), 0u);
+  }
+
+  std::vector<CanLogRecord> records;
+  ASSERT_TRUE(CanLogWriter::read(path, records));
+  ASSERT_EQ(records.size(), 10000u);
+  for (uint32_t i = 0; i < records.size(); ++i)
+  {
+    ASSERT_EQ(records[i].time, i);
+    ASSERT_EQ(records[i].values[NUM_FIELDS - 1], static_cast<int32_t>(i * NUM_FIELDS + NUM_FIELDS - 1));
+  }
+  unlink(path.c_str());
+}
+
+// Needs a virtual CAN interface, which is skipped if it does not exist:
+//   ip link add dev vcan0 type vcan && ip link set up vcan0
+TEST(TestKvaser, ReplayOnVirtualInterface)
+{
+  const char* env_interface = getenv("KVASER_TEST_INTERFACE");
+  const std::string interface = env_interface != nullptr ? env_interface : "vcan0";
+
+  SocketCan receiver;
+  SocketCan sender;
+  if (!receiver.open(interface) || !sender.open(interface))
+  {
+    std::cout << "skipped, " << interface << " is not available: " << receiver.error() << std::endl;
+    return;
+  }
+
+  const auto frames = kvaser::generateVehicleFrames(20000);
+  std::vector<CanFrame> received;
+  received.reserve(frames.size());
+  std::thread receive_thread([&]() {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (received.size() < frames.size() && std::chrono::steady_clock::now() < deadline)
+      receiver.receive(received, 100);
+  });
+
+  const auto begin = std::chrono::steady_clock::now();
+  ASSERT_EQ(kvaser::replayFrames(sender, frames, 0), frames.size());
+  receive_thread.join();
+  const auto end = std::chrono::steady_clock::now();
+  std::cout << received.size() << " frames received in " << std::chrono::duration<double, std::milli>(end - begin).count()
+            << " ms" << std::endl;
+
+  ASSERT_EQ(received.size(), frames.size());
+  CanSignalTable table;
+  LegacyDecoder legacy;
+  int32_t values[NUM_FIELDS] = {};
+  uint64_t previous_stamp = 0;
+  for (size_t i = 0; i < frames.size(); ++i)
+  {
+    ASSERT_EQ(received[i].id, frames[i].id);
+    ASSERT_EQ(received[i].len, frames[i].len);
+    ASSERT_EQ(memcmp(received[i].data, frames[i].data, 8), 0);
+    ASSERT_GE(received[i].stamp_ns, previous_stamp);
+    previous_stamp = received[i].stamp_ns;
+
+    ASSERT_EQ(table.decode(received[i].id, received[i].extended, received[i].data, received[i].len, values),
+              legacy.decode(frames[i].id, frames[i].data));
+    for (int field = 0; field < NUM_FIELDS; ++field)
+      ASSERT_EQ(values[field], legacy.values()[field]);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -18,7 +18,10 @@
 
 /* Dependencies */
 #include <iostream>
+#include <vector>
 #include <pthread.h>
+#include <string.h>
+#include <sys/select.h>
 #include "SickException.hh"
 #include <unistd.h>
 
@@ -65,8 +68,23 @@ namespace SickToolbox {
     /** Sick data stream file descriptor */
     unsigned int _sick_fd;   
     
+    /** Receive buffer holding the bytes read from the stream but not consumed yet */
+    std::vector< uint8_t > _recv_buffer;
+
+    /** Offset of the first unconsumed byte in the receive buffer */
+    size_t _recv_begin;
+
+    /** Offset one past the last buffered byte in the receive buffer */
+    size_t _recv_end;
+
     /** Reads n bytes into the destination buffer */
-    void _readBytes( uint8_t * const dest_buffer, const int num_bytes_to_read, const unsigned int timeout_value = 0 ) const throw ( SickTimeoutException, SickIOException );       
+    void _readBytes( uint8_t * const dest_buffer, const int num_bytes_to_read, const unsigned int timeout_value = 0 ) throw ( SickTimeoutException, SickIOException );
+
+    /** Reads whatever is waiting on the stream (at least one byte) into the receive buffer */
+    void _fillRecvBuffer( const unsigned int timeout_value = 0 ) throw ( SickTimeoutException, SickIOException );
+
+    /** Drops the buffered bytes */
+    void _clearRecvBuffer( ) { _recv_begin = _recv_end = 0; }
     
   private:
 
@@ -105,6 +123,7 @@ namespace SickToolbox {
    */
   template < class SICK_MONITOR_CLASS, class SICK_MSG_CLASS >
   SickBufferMonitor< SICK_MONITOR_CLASS, SICK_MSG_CLASS >::SickBufferMonitor( SICK_MONITOR_CLASS * const monitor_instance ) throw( SickThreadException ) :
+    _recv_buffer(2*SICK_MSG_CLASS::MESSAGE_MAX_LENGTH), _recv_begin(0), _recv_end(0),
     _sick_monitor_instance(monitor_instance), _continue_grabbing(true), _monitor_thread_id(0) {
     
     /* Initialize the shared message buffer mutex */
@@ -131,8 +150,9 @@ namespace SickToolbox {
       /* Attempt to acquire the data stream */
       AcquireDataStream();
       
-      /* Assign the data stream fd */
+      /* Assign the data stream fd, bytes buffered from the old stream are stale */
       _sick_fd = sick_fd;
+      _clearRecvBuffer();
       
       /* Attempt to release the data stream */
       ReleaseDataStream();
@@ -161,6 +181,7 @@ namespace SickToolbox {
 
     /* Assign the fd associated with the data stream */
     _sick_fd = sick_fd;
+    _clearRecvBuffer();
     
     /* Start the buffer monitor */
     if (pthread_create(&_monitor_thread_id,NULL,SickBufferMonitor< SICK_MONITOR_CLASS, SICK_MSG_CLASS >::_bufferMonitorThread,_sick_monitor_instance) != 0) {
@@ -330,76 +351,108 @@ namespace SickToolbox {
    * \brief Attempt to read a certain number of bytes from the stream
    * \param *dest_buffer A pointer to the destination buffer
    * \param num_bytes_to_read The number of bytes to read into the buffer
-   * \param timeout_value The number of microseconds allowed between subsequent bytes in a message
+   * \param timeout_value The number of microseconds allowed between subsequent reads from the stream
    * \return True if the number of requested bytes were successfully read
    */
   template< class SICK_MONITOR_CLASS, class SICK_MSG_CLASS >
-  void SickBufferMonitor< SICK_MONITOR_CLASS, SICK_MSG_CLASS >::_readBytes( uint8_t * const dest_buffer, const int num_bytes_to_read, const unsigned int timeout_value ) const
+  void SickBufferMonitor< SICK_MONITOR_CLASS, SICK_MSG_CLASS >::_readBytes( uint8_t * const dest_buffer, const int num_bytes_to_read, const unsigned int timeout_value )
     throw ( SickTimeoutException, SickIOException ) {
-    
-    /* Some helpful variables */
-    int num_bytes_read = 0;
+
     int total_num_bytes_read = 0;
-    int num_active_files = 0;
-    
-    struct timeval timeout_val;                     // This structure will be used for setting our timeout values
-    fd_set file_desc_set;                           // File descriptor set for monitoring I/O    
-    
-    /* Attempt to fetch the bytes */
+
+    /* Serve the bytes from the receive buffer, refilling it as needed */
     while ( total_num_bytes_read < num_bytes_to_read ) {
-      
-      /* Initialize and set the file descriptor set for select */
-      FD_ZERO(&file_desc_set);
-      FD_SET(_sick_fd,&file_desc_set);
-      
-      /* Setup the timeout structure */
-      memset(&timeout_val,0,sizeof(timeout_val));   // Initialize the buffer
-      timeout_val.tv_usec = timeout_value;          // Wait for specified time before throwing a timeout
 
-      /* Wait for the OS to tell us that data is waiting! */
-      num_active_files = select(getdtablesize(),&file_desc_set,0,0,(timeout_value > 0) ? &timeout_val : 0);
-      
-      /* Figure out what to do based on the output of select */
-      if (num_active_files > 0) {
-	
-  	/* A file is ready for reading!
-  	 *
-  	 * NOTE: The following conditional is just a sanity check. Since
-  	 *       the file descriptor set only contains the sick device fd,
-  	 *       it likely unnecessary to use FD_ISSET
-  	 */
-  	if (FD_ISSET(_sick_fd,&file_desc_set)) {
-	  
-  	  /* Read a single byte from the stream! */
-  	  num_bytes_read = read(_sick_fd,&dest_buffer[total_num_bytes_read],1);
-
-  	  /* Decide what to do based on the output of read */
-  	  if (num_bytes_read > 0) { //Update the number of bytes read so far
-  	    total_num_bytes_read += num_bytes_read;
-  	  }
-  	  else {
-  	    /* If this happens, something is wrong */
-  	    throw SickIOException("SickBufferMonitor::_readBytes: read() failed!");
-  	  }	  
-	  
-  	}
-	
+      if (_recv_begin == _recv_end) {
+        _fillRecvBuffer(timeout_value);
       }
-      else if (num_active_files == 0) {
-	
-	/* A timeout has occurred! */
-	throw SickTimeoutException("SickBufferMonitor::_readBytes: select() timeout!");	
 
+      size_t num_bytes = _recv_end - _recv_begin;
+      if (num_bytes > (size_t)(num_bytes_to_read - total_num_bytes_read)) {
+        num_bytes = num_bytes_to_read - total_num_bytes_read;
       }
-      else {
-	
-	/* An error has occurred! */
-	throw SickIOException("SickBufferMonitor::_readBytes: select() failed!");	
 
+      memcpy(&dest_buffer[total_num_bytes_read],&_recv_buffer[_recv_begin],num_bytes);
+      _recv_begin += num_bytes;
+      total_num_bytes_read += num_bytes;
+
+    }
+
+  }
+
+  /**
+   * \brief Read all bytes waiting on the stream with a single read() call
+   * \param timeout_value The number of microseconds to wait for data
+   *
+   * NOTE: Blocks until at least one byte arrived, so a single select()/read() pair
+   *       pulls a whole burst of the stream instead of one byte per system call.
+   */
+  template< class SICK_MONITOR_CLASS, class SICK_MSG_CLASS >
+  void SickBufferMonitor< SICK_MONITOR_CLASS, SICK_MSG_CLASS >::_fillRecvBuffer( const unsigned int timeout_value )
+    throw ( SickTimeoutException, SickIOException ) {
+
+    /* Make room at the back of the buffer */
+    if (_recv_begin == _recv_end) {
+      _clearRecvBuffer();
+    }
+    else if (_recv_end == _recv_buffer.size()) {
+
+      /* Nothing was consumed, the caller asked for more than fits in the buffer */
+      if (_recv_begin == 0) {
+        throw SickIOException("SickBufferMonitor::_fillRecvBuffer: receive buffer overflow!");
       }
-      
+
+      /* Move the unconsumed bytes to the front */
+      memmove(&_recv_buffer[0],&_recv_buffer[_recv_begin],_recv_end - _recv_begin);
+      _recv_end -= _recv_begin;
+      _recv_begin = 0;
+
     }
-    
+
+    struct timeval timeout_val;                     // This structure will be used for setting our timeout values
+    fd_set file_desc_set;                           // File descriptor set for monitoring I/O
+
+    /* Initialize and set the file descriptor set for select */
+    FD_ZERO(&file_desc_set);
+    FD_SET(_sick_fd,&file_desc_set);
+
+    /* Setup the timeout structure */
+    memset(&timeout_val,0,sizeof(timeout_val));   // Initialize the buffer
+    timeout_val.tv_sec = timeout_value / 1000000;
+    timeout_val.tv_usec = timeout_value % 1000000;  // Wait for specified time before throwing a timeout
+
+    /* Wait for the OS to tell us that data is waiting! */
+    int num_active_files = select(_sick_fd + 1,&file_desc_set,0,0,(timeout_value > 0) ? &timeout_val : 0);
+
+    /* Figure out what to do based on the output of select */
+    if (num_active_files > 0) {
+
+      /* Read everything that is waiting, up to the free space in the buffer */
+      ssize_t num_bytes_read = read(_sick_fd,&_recv_buffer[_recv_end],_recv_buffer.size() - _recv_end);
+
+      /* Decide what to do based on the output of read */
+      if (num_bytes_read > 0) {
+        _recv_end += num_bytes_read;
+      }
+      else {
+        /* If this happens, something is wrong */
+        throw SickIOException("SickBufferMonitor::_fillRecvBuffer: read() failed!");
+      }
+
+    }
+    else if (num_active_files == 0) {
+
+      /* A timeout has occurred! */
+      throw SickTimeoutException("SickBufferMonitor::_fillRecvBuffer: select() timeout!");
+
+    }
+    else {
+
+      /* An error has occurred! */
+      throw SickIOException("SickBufferMonitor::_fillRecvBuffer: select() failed!");
+
+    }
+
   }
   
   /**
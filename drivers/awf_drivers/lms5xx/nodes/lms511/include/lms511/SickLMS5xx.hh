@@ -172,6 +172,11 @@ namespace SickToolbox {
                               unsigned int & num_measurements,
                               unsigned int * const dev_status = NULL ) throw ( SickIOException, SickConfigException, SickTimeoutException );
 
+    /** Parses the status and the DIST/RSSI channels of a scan data payload */
+    static unsigned int ParseScanData( const char * const payload, const unsigned int payload_length,
+                                       unsigned int * const range_vals[5], unsigned int * const reflect_vals[5],
+                                       unsigned int * const dev_status = NULL ) throw ( SickIOException );
+
     /** Uninitializes the Sick LD unit */
     void Uninitialize( const bool disp_banner = true ) throw( SickIOException, SickTimeoutException, SickErrorException, SickThreadException );
 
@@ -329,9 +334,7 @@ namespace SickToolbox {
 
     /** Utility function for extracting next integer from tokenized string */
     char * _convertNextTokenToUInt( char * const str_buffer, unsigned int & num_val, const char * const delimeter = " " ) const;
-    
-    /** Utility function for extracting DIST1/DIST2/... and RSSI1/RSSI2/... measurements */
-    int _readDistancesOrRSSI(char * payload_buffer, int payload_sz, const char * label, unsigned int * const range_vals);
+
   };
 
   /*!
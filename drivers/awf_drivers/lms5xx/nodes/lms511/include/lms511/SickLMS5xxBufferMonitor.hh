@@ -48,7 +48,7 @@ namespace SickToolbox {
   private:
 
     /* A utility function for flushing the receive buffer */
-    void _flushTCPRecvBuffer( ) const throw ( SickIOException );
+    void _flushTCPRecvBuffer( ) throw ( SickIOException );
     
   };
     
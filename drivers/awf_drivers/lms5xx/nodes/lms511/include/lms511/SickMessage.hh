@@ -59,6 +59,9 @@ namespace SickToolbox {
 
     /** Returns a copy of the payload as a C String */
     void GetPayloadAsCStr( char * const payload_str ) const;
+
+    /** Returns a pointer to the payload, valid while the message is unchanged */
+    const uint8_t * GetPayloadPtr( ) const { return &_message_buffer[MESSAGE_HEADER_LENGTH]; }
     
     /** Returns a subregion of the payload specified by indices */
     void GetPayloadSubregion( uint8_t * const payload_sub_buffer, const unsigned int start_idx,
@@ -429,93 +429,166 @@ namespace SickToolbox {
       throw;
     }
     
-    /* Allocate a single buffer for payload contents */
-    uint8_t payload_buffer[SickLMS5xxMessage::MESSAGE_PAYLOAD_MAX_LENGTH+1] = {0};
+    /* Parse status, DIST and RSSI sections in a single pass over the payload */
+    unsigned int * const range_vals[5] = { range_1_vals, range_2_vals, range_3_vals, range_4_vals, range_5_vals };
+    unsigned int * const reflect_vals[5] = { reflect_1_vals, reflect_2_vals, reflect_3_vals, reflect_4_vals, reflect_5_vals };
+
+    unsigned int num_dist_vals = ParseScanData((const char *)recv_message.GetPayloadPtr(),recv_message.GetPayloadLength(),
+                                               range_vals,reflect_vals,dev_status);
+    if (range_1_vals != NULL) {
+      num_measurements = num_dist_vals;
+    }
+
+    /* Success! */
     
-    recv_message.GetPayloadAsCStr((char *)payload_buffer);
+  }
 
-    unsigned int null_int = 0;
-    char * payload_str = NULL;
+  /**
+   * \brief Returns the next space separated token of [pos, end) and advances pos past it
+   */
+  static bool _nextToken( const char * &pos, const char * const end, const char * &token, const char * &token_end ) {
 
-    /*
-     * Acquire status
-     */
-    if (dev_status != NULL) {
+    while (pos < end && *pos == ' ') {
+      pos++;
+    }
+    if (pos >= end) {
+      return false;
+    }
 
-      payload_str = (char *)&payload_buffer[16];      
-      for (unsigned int i = 0; i < 3; i++) {
-        payload_str = _convertNextTokenToUInt(payload_str,null_int);
-      }
+    token = pos;
+    while (pos < end && *pos != ' ') {
+      pos++;
+    }
+    token_end = pos;
+    return true;
 
-      /* Grab the contamination value */
-      _convertNextTokenToUInt(payload_str,*dev_status);
-
-    }
-
-    /* Process DIST sections */
-    if(range_1_vals != NULL)
-      num_measurements = _readDistancesOrRSSI(
-                           (char *)payload_buffer, recv_message.GetPayloadLength()+1, "DIST1", range_1_vals);
-    if(range_2_vals != NULL)
-      _readDistancesOrRSSI((char *)payload_buffer, recv_message.GetPayloadLength()+1, "DIST2", range_2_vals);
-    if(range_3_vals != NULL)
-      _readDistancesOrRSSI((char *)payload_buffer, recv_message.GetPayloadLength()+1, "DIST3", range_3_vals);
-    if(range_4_vals != NULL)
-      _readDistancesOrRSSI((char *)payload_buffer, recv_message.GetPayloadLength()+1, "DIST4", range_4_vals);
-    if(range_5_vals != NULL)
-      _readDistancesOrRSSI((char *)payload_buffer, recv_message.GetPayloadLength()+1, "DIST5", range_5_vals);
-
-//    std::cerr << "SickLMS5xx::GetSickMeasurements: WARNING! It seems you are expecting double-pulse range values, which are not being streamed! ";
-//    std::cerr << "Use SetSickScanDataFormat to configure the LMS 5xx to stream these values - or - set the corresponding buffer input to NULL to avoid this warning." << std::endl;
-
-
-    /* Process RSSI sections */
-    if(reflect_1_vals != NULL)
-      _readDistancesOrRSSI((char *)payload_buffer, recv_message.GetPayloadLength()+1, "RSSI1", reflect_1_vals);
-    if(reflect_2_vals != NULL)
-      _readDistancesOrRSSI((char *)payload_buffer, recv_message.GetPayloadLength()+1, "RSSI2", reflect_2_vals);
-    if(reflect_3_vals != NULL)
-      _readDistancesOrRSSI((char *)payload_buffer, recv_message.GetPayloadLength()+1, "RSSI3", reflect_3_vals);
-    if(reflect_4_vals != NULL)
-      _readDistancesOrRSSI((char *)payload_buffer, recv_message.GetPayloadLength()+1, "RSSI4", reflect_4_vals);
-    if(reflect_5_vals != NULL)
-      _readDistancesOrRSSI((char *)payload_buffer, recv_message.GetPayloadLength()+1, "RSSI5", reflect_5_vals);
-//      std::cerr << "SickLMS5xx::GetSickMeasurements: WARNING! It seems you are expecting single-pulse reflectivity values, which are not being streamed! ";
-//      std::cerr << "Use SetSickScanDataFormat to configure the LMS 5xx to stream these values - or - set the corresponding buffer input to NULL to avoid this warning." << std::endl;
+  }
+
+  /**
+   * \brief Converts a hex token like sscanf("%x") does, stopping at the first non hex digit
+   */
+  static unsigned int _hexTokenToUInt( const char * token, const char * const token_end ) {
+
+    uint32_t curr_val = 0;
+    for (; token < token_end; token++) {
+      const char c = *token;
+      if (c >= '0' && c <= '9') {
+        curr_val = (curr_val << 4) | (c - '0');
+      }
+      else if (c >= 'A' && c <= 'F') {
+        curr_val = (curr_val << 4) | (c - 'A' + 10);
+      }
+      else if (c >= 'a' && c <= 'f') {
+        curr_val = (curr_val << 4) | (c - 'a' + 10);
+      }
+      else {
+        break;
+      }
+    }
+    return (unsigned int)sick_lms_5xx_to_host_byte_order(curr_val);
 
-    /* Success! */
-    
   }
-  
-  int SickLMS5xx::_readDistancesOrRSSI(char * payload_buffer, int payload_sz, const char * label, unsigned int * const range_vals)
-  {
-    unsigned int substr_dist_pos = 0;
-    if (!_findSubString((char *)payload_buffer,label,payload_sz,strlen(label),substr_dist_pos))
-      throw SickIOException("SickLMS5xx::_readDistances: _findSubString() failed!");
 
-    char * payload_str = (char *)&payload_buffer[substr_dist_pos+strlen(label)+1];
+  /**
+   * \brief Parses an LMDscandata payload in a single pass
+   * \param payload The CoLa-A payload (without STX/ETX)
+   * \param payload_length The length of the payload in bytes
+   * \param range_vals Buffers for DIST1..DIST5, NULL for the channels which are not needed
+   * \param reflect_vals Buffers for RSSI1..RSSI5, NULL for the channels which are not needed
+   * \param dev_status Buffer for the device status, may be NULL
+   * \return The number of DIST1 values, 0 if the payload has no DIST1 section
+   *
+   * NOTE: Every channel is tokenized exactly once, instead of searching the
+   *       payload again for each requested DIST/RSSI label.
+   */
+  unsigned int SickLMS5xx::ParseScanData( const char * const payload, const unsigned int payload_length,
+                                          unsigned int * const range_vals[5], unsigned int * const reflect_vals[5],
+                                          unsigned int * const dev_status ) throw ( SickIOException ) {
+
+    const char * pos = payload;
+    const char * const end = payload + payload_length;
+    const char * token = NULL;
+    const char * token_end = NULL;
+
+    unsigned int num_dist_vals = 0;
+    unsigned int channels_found = 0;
 
-    /* Extract scaling and angle parameters */
-    float scaling, scaling_offset;
-    int starting_angle, angular_step_width;
+    /* Token 5 is the first status byte ("sSN LMDscandata <version> <device> <serial> <status>") */
+    for (unsigned int token_index = 0; _nextToken(pos,end,token,token_end); token_index++) {
 
-    payload_str = _convertNextTokenToUInt(payload_str,*(unsigned int *)&scaling);
-    payload_str = _convertNextTokenToUInt(payload_str,*(unsigned int *)&scaling_offset);
-    payload_str = _convertNextTokenToUInt(payload_str,*(unsigned int *)&starting_angle);
-    payload_str = _convertNextTokenToUInt(payload_str,*(unsigned int *)&angular_step_width);
-    /*printf("Scaling: %f, Offset: %f, Starting angle: %d, angular step: %d\n",
-           scaling, scaling_offset, starting_angle, angular_step_width);*/
+      if (token_index == 5 && dev_status != NULL) {
+        *dev_status = _hexTokenToUInt(token,token_end);
+        continue;
+      }
 
-    /* Extract value count */
-    unsigned int num_dist_vals;
-    payload_str = _convertNextTokenToUInt(payload_str,num_dist_vals);
+      /* Only DIST1..DIST5 and RSSI1..RSSI5 start a channel */
+      if (token_end - token != 5 || token[4] < '1' || token[4] > '5') {
+        continue;
+      }
+
+      unsigned int * const * channel_vals = NULL;
+      unsigned int channel_bit = 0;
+      if (strncmp(token,"DIST",4) == 0) {
+        channel_vals = range_vals;
+        channel_bit = 1 << (token[4] - '1');
+      }
+      else if (strncmp(token,"RSSI",4) == 0) {
+        channel_vals = reflect_vals;
+        channel_bit = 1 << (5 + token[4] - '1');
+      }
+      else {
+        continue;
+      }
+      const int channel = token[4] - '1';
+      const bool is_dist_1 = (channel_vals == range_vals && channel == 0);
+      unsigned int * const vals = channel_vals[channel];
+
+      /* Extract scaling and angle parameters, then the value count */
+      unsigned int params[5];
+      for (unsigned int i = 0; i < 5; i++) {
+        if (!_nextToken(pos,end,token,token_end)) {
+          throw SickIOException("SickLMS5xx::ParseScanData: truncated channel header!");
+        }
+        params[i] = _hexTokenToUInt(token,token_end);
+      }
+      float scaling;
+      memcpy(&scaling,&params[0],sizeof(scaling));
+      const unsigned int num_vals = params[4];
+
+      if (num_vals > (unsigned int)SICK_LMS_5XX_MAX_NUM_MEASUREMENTS) {
+        throw SickIOException("SickLMS5xx::ParseScanData: too many values in channel!");
+      }
+
+      /* Grab the values, or skip them if the channel is not needed */
+      for (unsigned int i = 0; i < num_vals; i++) {
+        if (!_nextToken(pos,end,token,token_end)) {
+          throw SickIOException("SickLMS5xx::ParseScanData: truncated channel values!");
+        }
+        if (vals != NULL) {
+          vals[i] = _hexTokenToUInt(token,token_end);
+          vals[i] *= scaling;
+        }
+      }
+
+      if (is_dist_1) {
+        num_dist_vals = num_vals;
+      }
+      channels_found |= channel_bit;
 
-    /* Grab the DIST values */
-    for (unsigned int i = 0; i < num_dist_vals; i++) {
-      payload_str = _convertNextTokenToUInt(payload_str,range_vals[i]);
-      range_vals[i] *= scaling;
     }
+
+    /* Every requested channel must be in the payload */
+    for (unsigned int channel = 0; channel < 5; channel++) {
+      if (range_vals[channel] != NULL && !(channels_found & (1 << channel))) {
+        throw SickIOException("SickLMS5xx::ParseScanData: DIST" + int_to_str(channel + 1) + " not found!");
+      }
+      if (reflect_vals[channel] != NULL && !(channels_found & (1 << (5 + channel)))) {
+        throw SickIOException("SickLMS5xx::ParseScanData: RSSI" + int_to_str(channel + 1) + " not found!");
+      }
+    }
+
     return num_dist_vals;
+
   }
 
 
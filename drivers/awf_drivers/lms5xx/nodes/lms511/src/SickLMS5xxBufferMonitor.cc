@@ -19,6 +19,7 @@
 
 /* Implementation dependencies */
 #include <iostream>
+#include <string.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
 
@@ -38,48 +39,61 @@ namespace SickToolbox {
   /**
    * \brief Acquires the next message from the SickLMS5xx byte stream
    * \param &sick_message The returned message object
+   *
+   * NOTE: The stream is read in bulk into the receive buffer and the message is
+   *       framed (STX ... ETX) in place, so a whole scan costs a handful of
+   *       system calls instead of one select()/read() pair per byte.
    */
   void SickLMS5xxBufferMonitor::GetNextMessageFromDataStream( SickLMS5xxMessage &sick_message ) throw( SickIOException ) {
 
-    /* Flush the input buffer */
-    uint8_t byte_buffer = 0;
-    uint8_t payload_buffer[SickLMS5xxMessage::MESSAGE_PAYLOAD_MAX_LENGTH] = {0};
-    
     try {
 
       /* Flush the TCP receive buffer */
       // Don't flush! This is stupid. It causes races and makes the driver unreliable.
       //_flushTCPRecvBuffer();
 
-      /* Search for STX in the byte stream */
-      do {
-	
-         /* Grab the next byte from the stream */
-         _readBytes(&byte_buffer,1,DEFAULT_SICK_LMS_5XX_BYTE_TIMEOUT);
+      for (;;) {
 
-      }
-      while (byte_buffer != 0x02);
-      
-      /* Ok, now acquire the payload! (until ETX) */
-      int payload_length = 0;
-      do {
+        uint8_t * const buffer_begin = &_recv_buffer[0];
+        uint8_t * const recv_begin = buffer_begin + _recv_begin;
+        uint8_t * const recv_end = buffer_begin + _recv_end;
+
+        /* Search for STX in the buffered bytes, everything before it is garbage */
+        uint8_t * const stx = (uint8_t *)memchr(recv_begin,0x02,recv_end - recv_begin);
+        if (stx == NULL) {
+          _clearRecvBuffer();
+          _fillRecvBuffer(DEFAULT_SICK_LMS_5XX_BYTE_TIMEOUT);
+          continue;
+        }
+        _recv_begin = stx - buffer_begin;
+
+        /* Ok, now search for the ETX closing the payload */
+        uint8_t * const etx = (uint8_t *)memchr(stx + 1,0x03,recv_end - stx - 1);
+        if (etx == NULL) {
+
+          /* A payload that can not fit in a message means we missed the ETX, resync on the next STX */
+          if (recv_end - stx - 1 > (long)SickLMS5xxMessage::MESSAGE_PAYLOAD_MAX_LENGTH) {
+            _recv_begin++;
+            continue;
+          }
 
-        payload_length++;
-         _readBytes(&payload_buffer[payload_length-1],1,DEFAULT_SICK_LMS_5XX_BYTE_TIMEOUT);
+          _fillRecvBuffer(DEFAULT_SICK_LMS_5XX_BYTE_TIMEOUT);
+          continue;
+        }
+
+        /* Build the return message object based upon the received payload
+         * NOTE: In constructing this message we ignore the header bytes
+         *       buffered since the BuildMessage routine will insert the
+         *       correct header automatically and verify the message size
+         */
+        sick_message.BuildMessage(stx + 1,etx - stx - 1);
+        _recv_begin = etx + 1 - buffer_begin;
+
+        /* Success */
+        break;
 
       }
-      while (payload_buffer[payload_length-1] != 0x03);
-      payload_length--;
-      
-      /* Build the return message object based upon the received payload
-       * NOTE: In constructing this message we ignore the header bytes
-       *       buffered since the BuildMessage routine will insert the
-       *       correct header automatically and verify the message size
-       */
-      sick_message.BuildMessage(payload_buffer,payload_length);
-
-      /* Success */
-      
+
     }
     
     catch(SickTimeoutException &sick_timeout) { /* This is ok! */ }
@@ -99,11 +113,14 @@ namespace SickToolbox {
   /**
    * \brief Flushes TCP receive buffer contents
    */
-  void SickLMS5xxBufferMonitor::_flushTCPRecvBuffer( ) const throw (SickIOException) {
+  void SickLMS5xxBufferMonitor::_flushTCPRecvBuffer( ) throw (SickIOException) {
     
-    char null_byte;
+    uint8_t null_bytes[1024];
     int num_bytes_waiting = 0;    
 
+    /* Drop what is already buffered */
+    _clearRecvBuffer();
+
     /* Acquire number of awaiting bytes */
     if (ioctl(_sick_fd,FIONREAD,&num_bytes_waiting)) {
       throw SickIOException("SickLMS5xxBufferMonitor::_flushTCPRecvBuffer: ioctl() failed!");
@@ -112,12 +129,15 @@ namespace SickToolbox {
     /* Flush awaiting bytes */
     if(num_bytes_waiting)
       std::cerr << "FIXME: eating your data" << std::endl;
-    for (int i = 0; i < num_bytes_waiting; i++) {
+    while (num_bytes_waiting > 0) {
       
-      /* Capture a single byte from the stream! */
-      if (read(_sick_fd,&null_byte,1) != 1) {
-        throw SickIOException("SickLMS5xxBufferMonitor::_flushTCPRecvBuffer: ioctl() failed!");
+      /* Capture as many bytes as are waiting */
+      int num_bytes = (num_bytes_waiting < (int)sizeof(null_bytes)) ? num_bytes_waiting : (int)sizeof(null_bytes);
+      int num_bytes_read = read(_sick_fd,null_bytes,num_bytes);
+      if (num_bytes_read <= 0) {
+        throw SickIOException("SickLMS5xxBufferMonitor::_flushTCPRecvBuffer: read() failed!");
       }
+      num_bytes_waiting -= num_bytes_read;
       
     }
     
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2020 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SickLMS5xx.hh"
+#include "SickLMS5xxBufferMonitor.hh"
+#include "SickLMS5xxMessage.hh"
+
+using SickToolbox::SickIOException;
+using SickToolbox::SickLMS5xx;
+using SickToolbox::SickLMS5xxBufferMonitor;
+using SickToolbox::SickLMS5xxMessage;
+
+namespace
+{
+std::string toHex(unsigned int value)
+{
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%X", value);
+  return buffer;
+}
+
+std::string channel(const std::string& label, float scaling, const std::vector<unsigned int>& values)
+{
+  unsigned int scaling_bits;
+  memcpy(&scaling_bits, &scaling, sizeof(scaling_bits));
+  std::string str = " " + label + " " + toHex(scaling_bits) + " 0 FFF92230 D05 " + toHex(values.size());
+  for (const auto value : values)
+    str += " " + toHex(value);
+  return str;
+}
+
+// LMDscandata telegram payload as streamed by the scanner (CoLa-A, without STX/ETX)
+std::string scanData(unsigned int status, const std::vector<unsigned int>& dist1, const std::vector<unsigned int>& dist2,
+                     const std::vector<unsigned int>& rssi1)
+{
+  std::string payload = "sSN LMDscandata 1 1 89A27F " + toHex(status) + " 0 8E9C 8EA0 5A1 5A5 0 0 7 0 0 1388 168 0 1";
+  payload += channel("DIST1", 1.0f, dist1);
+  if (!dist2.empty())
+    payload += channel("DIST2", 2.0f, dist2);
+  payload += " 1";
+  payload += channel("RSSI1", 1.0f, rssi1);
+  payload += " 0 0 0 0 0 0";
+  return payload;
+}
+
+// Local TCP emulator replaying a recorded scanner stream in chunks of random size
+class ScannerEmulator
+{
+public:
+  explicit ScannerEmulator(const std::string& stream) : stream_(stream), server_fd_(-1), client_fd_(-1)
+  {
+    server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    bind(server_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    listen(server_fd_, 1);
+    socklen_t addr_length = sizeof(addr);
+    getsockname(server_fd_, reinterpret_cast<sockaddr*>(&addr), &addr_length);
+
+    client_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    connect(client_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    replay_thread_ = std::thread(&ScannerEmulator::replay, this);
+  }
+
+  ~ScannerEmulator()
+  {
+    replay_thread_.join();
+    close(client_fd_);
+    close(server_fd_);
+  }
+
+  int fd() const
+  {
+    return client_fd_;
+  }
+
+private:
+  std::string stream_;
+  int server_fd_;
+  int client_fd_;
+  std::thread replay_thread_;
+
+  void replay()
+  {
+    const int connection_fd = accept(server_fd_, nullptr, nullptr);
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<size_t> chunk_size(1, 4000);
+    for (size_t sent = 0; sent < stream_.size();)
+    {
+      const size_t chunk = std::min(chunk_size(rng), stream_.size() - sent);
+      const ssize_t written = write(connection_fd, &stream_[sent], chunk);
+      if (written <= 0)
+        break;
+      sent += written;
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    close(connection_fd);
+  }
+};
+}  // namespace
+
+TEST(TestLMS5xx, ParseScanData)
+{
+  std::vector<unsigned int> dist1, dist2, rssi1;
+  for (unsigned int i = 0; i < 1141; ++i)
+  {
+    dist1.push_back(1000 + i);
+    dist2.push_back(2000 + i);
+    rssi1.push_back(i % 256);
+  }
+  const std::string payload = scanData(3, dist1, dist2, rssi1);
+
+  std::vector<unsigned int> range_1(SickLMS5xx::SICK_LMS_5XX_MAX_NUM_MEASUREMENTS);
+  std::vector<unsigned int> range_2(SickLMS5xx::SICK_LMS_5XX_MAX_NUM_MEASUREMENTS);
+  std::vector<unsigned int> reflect_1(SickLMS5xx::SICK_LMS_5XX_MAX_NUM_MEASUREMENTS);
+  unsigned int* const range_vals[5] = { range_1.data(), range_2.data(), NULL, NULL, NULL };
+  unsigned int* const reflect_vals[5] = { reflect_1.data(), NULL, NULL, NULL, NULL };
+  unsigned int status = 0;
+
+  const unsigned int num_measurements =
+      SickLMS5xx::ParseScanData(payload.c_str(), payload.size(), range_vals, reflect_vals, &status);
+  ASSERT_EQ(num_measurements, 1141u);
+  ASSERT_EQ(status, 3u);
+  for (unsigned int i = 0; i < num_measurements; ++i)
+  {
+    ASSERT_EQ(range_1[i], dist1[i]);
+    ASSERT_EQ(range_2[i], 2 * dist2[i]);  // DIST2 is scaled by 2
+    ASSERT_EQ(reflect_1[i], rssi1[i]);
+  }
+
+  // channels which are requested but not streamed are an error
+  const std::string single_echo = scanData(0, dist1, std::vector<unsigned int>(), rssi1);
+  ASSERT_THROW(SickLMS5xx::ParseScanData(single_echo.c_str(), single_echo.size(), range_vals, reflect_vals),
+               SickIOException);
+
+  // truncated telegrams are an error
+  ASSERT_THROW(SickLMS5xx::ParseScanData(payload.c_str(), payload.size() / 2, range_vals, reflect_vals),
+               SickIOException);
+}
+
+TEST(TestLMS5xx, FrameRecordedStream)
+{
+  // garbage before the first telegram, telegrams back to back and split across reads
+  std::vector<std::string> payloads;
+  std::string stream = "\x03garbage";
+  for (unsigned int scan = 0; scan < 50; ++scan)
+  {
+    std::vector<unsigned int> dist1, rssi1;
+    for (unsigned int i = 0; i < 1141; ++i)
+    {
+      dist1.push_back((scan * 31 + i * 7) % 40000);
+      rssi1.push_back(i % 256);
+    }
+    payloads.push_back(scanData(scan % 4, dist1, std::vector<unsigned int>(), rssi1));
+    stream += "\x02" + payloads.back() + "\x03";
+  }
+
+  ScannerEmulator emulator(stream);
+  SickLMS5xxBufferMonitor monitor;
+  monitor.SetDataStream(emulator.fd());
+
+  const auto begin = std::chrono::steady_clock::now();
+  for (const auto& payload : payloads)
+  {
+    SickLMS5xxMessage message;
+    while (!message.IsPopulated())
+      monitor.GetNextMessageFromDataStream(message);
+
+    ASSERT_EQ(message.GetPayloadLength(), payload.size());
+    ASSERT_EQ(std::string(reinterpret_cast<const char*>(message.GetPayloadPtr()), message.GetPayloadLength()),
+              payload);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  std::cout << payloads.size() << " telegrams framed in " << std::chrono::duration<double, std::milli>(end - begin).count()
+            << " ms" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}